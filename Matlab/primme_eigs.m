@@ -62,7 +62,17 @@ function [varargout] = primme_eigs(varargin)
 %     OPTS.convTestFun: function handler with an alternative convergence criterion.
 %          If FUN(EVAL,EVEC,RNORM) returns a nonzero value, the pair (EVAL,EVEC)
 %          with residual norm RNORM is considered converged.
+%     OPTS.convTestFunBlock: like convTestFun but called once per iteration
+%          with all candidate pairs: EVAL and RNORM are column vectors and
+%          EVEC has a column per pair; FUN returns a vector with a nonzero
+%          value for every converged pair. It replaces convTestFun.
 %     OPTS.iseed: random seed
+%     OPTS.gpu: whether AFUN and PFUN take gpuArrays; the vectors are copied
+%          to and from the device directly {true if A is a gpuArray}
+%     OPTS.nLocal: inside an SPMD block, number of rows of A owned by this
+%          worker; AFUN, PFUN, OPTS.v0 and OPTS.orthoConst, and the returned
+%          X, have only the local rows, and the workers add their partial
+%          inner products with gplus. AFUN should be a function handle.
 %
 %   For detailed descriptions of the above options, visit:
 %   http://www.cs.wm.edu/~andreas/software/doc/primmec.html#parameters-guide
@@ -184,11 +194,21 @@ function [varargout] = primme_eigs(varargin)
          error('Input matrix must be real symmetric or complex Hermitian');
       end
       opts.n = n;
-      opts.matrixMatvec = @(x)A*x;
+      if issparse(A) && isa(A, 'double')
+         % primme_mex applies sparse matrices without calling MATLAB
+         opts.matrixMatvec = A;
+      else
+         opts.matrixMatvec = @(x)A*x;
+      end
 
       % Get type and complexity
       Acomplex = ~isreal(A);
-      Adouble = strcmp(class(A), 'double');
+      if isa(A, 'gpuArray')
+         opts.gpu = true;
+         Adouble = strcmp(classUnderlying(A), 'double');
+      else
+         Adouble = strcmp(class(A), 'double');
+      end
    else
       opts.matrixMatvec = fcnchk_gen(A); % get the function handle of user's function
       n = round(varargin{nextArg});
@@ -265,7 +285,10 @@ function [varargout] = primme_eigs(varargin)
 
    if nargin >= nextArg
       P = varargin{nextArg};
-      if isnumeric(P)
+      if isnumeric(P) && isdiag(P)
+         % primme_mex applies diagonal matrices without calling MATLAB
+         P = sparse(double(P));
+      elseif isnumeric(P)
          P = @(x)P\x;
       else
          P = fcnchk_gen(P); % get the function handle of user's function
@@ -282,6 +305,10 @@ function [varargout] = primme_eigs(varargin)
       else
          P2 = fcnchk_gen(P2); % get the function handle of user's function
       end
+      if isnumeric(P)
+         P1 = P;
+         P = @(x)P1\x;
+      end
       P = @(x)P2(P(x));
    end
    if ~isempty(P)
@@ -306,13 +333,39 @@ function [varargout] = primme_eigs(varargin)
       Aclass = 'single';
    end
 
+   % Process 'gpu' in opts
+   useGPU = false;
+   if isfield(opts, 'gpu')
+      useGPU = logical(opts.gpu);
+      opts = rmfield(opts, 'gpu');
+   end
+
+   % Process 'nLocal' in opts; the vectors are distributed by rows among
+   % the workers of the SPMD block
+   if isfield(opts, 'nLocal')
+      if isnumeric(opts.matrixMatvec)
+         error('A should be a function handle if opts.nLocal is given');
+      end
+      nLocal = opts.nLocal;
+      opts.numProcs = numlabs;
+      opts.procID = labindex - 1;
+   else
+      nLocal = opts.n;
+   end
+
    % Test whether the given matrix and preconditioner are valid
    try
-      x = opts.matrixMatvec(ones(opts.n, 1, Aclass));
-      if isfield(opts, 'applyPreconditioner')
-         x = opts.applyPreconditioner(ones(opts.n, 1, Aclass));
+      x0 = ones(nLocal, 1, Aclass);
+      if useGPU
+         x0 = gpuArray(x0);
+      end
+      if ~isnumeric(opts.matrixMatvec)
+         x = opts.matrixMatvec(x0);
       end
-      clear x;
+      if isfield(opts, 'applyPreconditioner') && ~isnumeric(opts.applyPreconditioner)
+         x = opts.applyPreconditioner(x0);
+      end
+      clear x x0;
    catch ME
       rethrow(ME);
    end
@@ -358,7 +411,7 @@ function [varargout] = primme_eigs(varargin)
    % Prepare numOrthoConst and initSize
    if isfield(opts, 'orthoConst')
       init = opts.orthoConst;
-      if size(init, 1) ~= opts.n
+      if size(init, 1) ~= nLocal
          error('Invalid matrix dimensions in opts.orthoConst');
       end
       opts = rmfield(opts, 'orthoConst');
@@ -369,7 +422,7 @@ function [varargout] = primme_eigs(varargin)
 
    if isfield(opts, 'v0')
       init0 = opts.v0;
-      if size(init0, 1) ~= opts.n
+      if size(init0, 1) ~= nLocal
          error('Invalid matrix dimensions in opts.v0');
       end
       opts = rmfield(opts, 'v0');
@@ -428,7 +481,10 @@ function [varargout] = primme_eigs(varargin)
    xprimme = [type 'primme'];
 
    % Call xprimme
-   [ierr, evals, norms, evecs] = primme_mex(xprimme, init, primme); 
+   if useGPU
+      init = gather(init);
+   end
+   [ierr, evals, norms, evecs] = primme_mex(xprimme, init, primme, useGPU); 
 
    % Process error code and return the required arguments
    if ierr == -3
@@ -49,6 +49,10 @@
 #include <cassert>
 #include "mex.h"
 #include "primme.h"
+#ifdef PRIMME_MEX_WITH_GPU
+#include "gpu/mxGPUArray.h"
+#include <cuda_runtime.h>
+#endif
 
 // Attempt to capture ctrl+c
 #if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__)) || defined (__FreeBSD__)
@@ -300,6 +304,233 @@ static mxArray* create_mxArray(std::complex<T> *y, I m, I n, I ldy,
    return x;
 }
 
+// Input mxArray of a callback kept between calls, so that the callback
+// doesn't allocate a new mxArray every time it is invoked
+// - a: persistent mxArray, or NULL
+// - m: number of rows of a
+// - n: number of columns allocated in a
+
+struct CallbackArray {
+   mxArray *a;
+   PRIMME_INT m, n;
+};
+
+// Auxiliary functions for reuse_mxArray; copy y into the data of x
+
+template <typename T, typename I>
+static void copy_to_mxArray(T *y, mxArray *x, I m, I n, I ldy) {
+   T *px = (T*)mxGetData(x);
+   for (I i=0; i<n; i++) for (I j=0; j<m; j++) px[m*i+j] = y[ldy*i+j];
+}
+
+template <typename T, typename I>
+static void copy_to_mxArray(std::complex<T> *y, mxArray *x, I m, I n, I ldy) {
+   T *pxr = (T*)mxGetData(x), *pxi = (T*)mxGetImagData(x);
+   for (I i=0; i<n; i++) for (I j=0; j<m; j++) {
+      pxr[m*i+j] = std::real(y[ldy*i+j]);
+      pxi[m*i+j] = std::imag(y[ldy*i+j]);
+   }
+}
+
+// Return the mxArray of c with the content of a C array; the mxArray is
+// created the first time or when it has not enough columns
+// Arguments:
+// - c: mxArray to reuse
+// - y: C type array from to get the values
+// - m: number of rows of matrix y and output mxArray
+// - n: number of columns of matrix y and output mxArray
+// - ldy: leading dimension of y
+
+template <typename T>
+static mxArray* reuse_mxArray(CallbackArray &c, T *y, PRIMME_INT m,
+      PRIMME_INT n, PRIMME_INT ldy) {
+
+   if (!c.a || c.m != m || c.n < n) {
+      if (c.a) mxDestroyArray(c.a);
+      c.a = mxCreateNumericMatrix((mwSize)m, (mwSize)n,
+            toClassID<T>(), isComplex<T>() ? mxCOMPLEX : mxREAL);
+      mexMakeArrayPersistent(c.a);
+      c.m = m;
+      c.n = n;
+   }
+
+   // NOTE: mxSetN doesn't reallocate the data, and c.a has room for c.n
+   // columns
+
+   mxSetN(c.a, (mwSize)n);
+   copy_to_mxArray(y, c.a, m, n, ldy);
+   return c.a;
+}
+
+static void destroy_callbackArray(CallbackArray &c) {
+   if (c.a) mxDestroyArray(c.a);
+   c.a = NULL;
+   c.m = c.n = 0;
+}
+
+// Whether the callbacks take gpuArrays; set by xprimme and xprimme_svds
+
+static bool callbackOnGPU = false;
+
+#ifdef PRIMME_MEX_WITH_GPU
+
+// Input gpuArray of a callback kept between calls, as CallbackArray
+// - a: device array, or NULL
+// - m: number of rows of a
+// - n: number of columns of a
+
+struct CallbackGPUArray {
+   mxGPUArray *a;
+   PRIMME_INT m, n;
+};
+
+// Return a gpuArray with the content of a C array; the vectors are copied
+// from y to the device memory of c, which is created the first time or when
+// the dimensions change, without staging through a host mxArray
+// Arguments:
+// - c: device array to reuse
+// - y: C type array from to get the values
+// - m: number of rows of matrix y and output gpuArray
+// - n: number of columns of matrix y and output gpuArray
+// - ldy: leading dimension of y
+
+template <typename T>
+static mxArray* reuse_gpuArray(CallbackGPUArray &c, T *y, PRIMME_INT m,
+      PRIMME_INT n, PRIMME_INT ldy) {
+
+   if (!c.a || c.m != m || c.n != n) {
+      if (c.a) mxGPUDestroyGPUArray(c.a);
+      mwSize dims[2] = {(mwSize)m, (mwSize)n};
+      c.a = mxGPUCreateGPUArray(2, dims, toClassID<T>(),
+            isComplex<T>() ? mxCOMPLEX : mxREAL, MX_GPU_DO_NOT_INITIALIZE);
+      c.m = m;
+      c.n = n;
+   }
+
+   // NOTE: complex gpuArrays are interleaved, as std::complex arrays
+
+   cudaMemcpy2D(mxGPUGetData(c.a), sizeof(T)*m, y, sizeof(T)*ldy,
+         sizeof(T)*m, n, cudaMemcpyHostToDevice);
+   return mxGPUCreateMxArrayOnGPU(c.a);
+}
+
+static void destroy_callbackGPUArray(CallbackGPUArray &c) {
+   if (c.a) mxGPUDestroyGPUArray(c.a);
+   c.a = NULL;
+   c.m = c.n = 0;
+}
+
+#endif
+
+// Copy the content of the mxArray returned by a callback into a C array,
+// as copy_mxArray; a gpuArray is copied from the device straight into y, or
+// gathered first if the module is built without gpuArray support.
+// Return nonzero if gathering fails.
+
+template <typename TY, typename I>
+static int copy_callback_mxArray(const mxArray *x, TY *y, I m, I n, I ldy) {
+#ifdef PRIMME_MEX_WITH_GPU
+   if (mxIsGPUArray(x)) {
+      const mxGPUArray *gx = mxGPUCreateFromMxArray(x);
+      bool done = false;
+      if (mxGPUGetClassID(gx) == toClassID<TY>()
+            && (mxGPUGetComplexity(gx) == mxCOMPLEX) == isComplex<TY>()
+            && mxGPUGetNumberOfElements(gx) == (mwSize)(m*n)) {
+         cudaMemcpy2D(y, sizeof(TY)*ldy, mxGPUGetDataReadOnly(gx),
+               sizeof(TY)*m, sizeof(TY)*m, n, cudaMemcpyDeviceToHost);
+         done = true;
+      }
+      mxGPUDestroyGPUArray(gx);
+      if (done) return 0;
+   }
+#endif
+   if (mxIsClass(x, "gpuArray")) {
+      mxArray *hx;
+      int ierr = mexCallMATLAB(1, &hx, 1, (mxArray**)&x, "gather");
+      if (ierr != 0) return ierr;
+      copy_mxArray(hx, y, m, n, ldy);
+      mxDestroyArray(hx);
+      return 0;
+   }
+   copy_mxArray(x, y, m, n, ldy);
+   return 0;
+}
+
+// Auxiliary function for the globalSumReal wrappers; sum sendBuf among the
+// workers of the SPMD block with gplus and store the result in recvBuf
+
+template <typename T>
+static int globalSum_gplus(void *sendBuf, void *recvBuf, int count) {
+   mxArray *prhs[1], *plhs[1];
+
+   if (count <= 0) return 0;
+   prhs[0] = create_mxArray<T,int>((T*)sendBuf, count, 1, count);
+   int ierr = mexCallMATLAB(1, plhs, 1, prhs, "gplus");
+   mxDestroyArray(prhs[0]);
+   if (ierr == 0) {
+      copy_mxArray(plhs[0], (T*)recvBuf, count, 1, count);
+      mxDestroyArray(plhs[0]);
+   }
+   return ierr;
+}
+
+// Auxiliary function for sparse_matmat; return the (conjugate of) the p-th
+// value of a MATLAB sparse matrix with values pr and imaginary values pi
+
+template <typename T>
+static inline void sparse_value(const double *pr, const double *pi, mwIndex p,
+      bool conjugate, T &a) {
+   (void)pi; (void)conjugate;
+   a = (T)pr[p];
+}
+
+template <typename T>
+static inline void sparse_value(const double *pr, const double *pi, mwIndex p,
+      bool conjugate, std::complex<T> &a) {
+   T ai = pi ? (T)pi[p] : (T)0;
+   a = std::complex<T>((T)pr[p], conjugate ? -ai : ai);
+}
+
+// Compute y = A*x or y = A\x for a MATLAB sparse matrix A without calling
+// MATLAB. A is Hermitian, so the row i of A is the conjugate of the column
+// i, which is stored contiguously and can be computed independently.
+// Arguments:
+// - A: sparse matrix of size n x n
+// - inverse: if true, compute y = A\x, considering only the diagonal of A
+// - n: number of rows of x and y
+// - m: number of columns of x and y
+// - x, ldx: input matrix and its leading dimension
+// - y, ldy: output matrix and its leading dimension
+
+template <typename T>
+static void sparse_matmat(const mxArray *A, bool inverse, PRIMME_INT n,
+      PRIMME_INT m, const T *x, PRIMME_INT ldx, T *y, PRIMME_INT ldy) {
+
+   const mwIndex *jc = mxGetJc(A), *ir = mxGetIr(A);
+   const double *pr = mxGetPr(A), *pi = mxGetPi(A);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+   for (PRIMME_INT i=0; i<n; i++) {
+      if (inverse) {
+         T d = (T)0;
+         for (mwIndex p=jc[i]; p<jc[i+1]; p++) {
+            if (ir[p] == (mwIndex)i) sparse_value(pr, pi, p, false, d);
+         }
+         for (PRIMME_INT j=0; j<m; j++) y[ldy*j+i] = x[ldx*j+i]/d;
+      }
+      else {
+         for (PRIMME_INT j=0; j<m; j++) y[ldy*j+i] = (T)0;
+         for (mwIndex p=jc[i]; p<jc[i+1]; p++) {
+            T a;
+            sparse_value(pr, pi, p, true, a);
+            for (PRIMME_INT j=0; j<m; j++) y[ldy*j+i] += a*x[ldx*j+ir[p]];
+         }
+      }
+   }
+}
+
 // Template version of sprimme, cprimme, dprimme and zprimme
 
 static int tprimme(float *evals, float *evecs, float *resNorms, primme_params *primme) {
@@ -379,6 +610,14 @@ static int tprimme_svds(double *svals, std::complex<double> *svecs, double *resN
       mexErrMsgTxtPrintf1("Argument %d should be function handler", (NARG)+2); \
    }
 
+// Check that argument NARG is a function handler or a double sparse matrix
+
+#define ASSERT_FUNCTION_OR_SPARSE(NARG) \
+   if (mxGetClassID(prhs[(NARG)]) != mxFUNCTION_CLASS && \
+         !(mxIsSparse(prhs[(NARG)]) && mxIsDouble(prhs[(NARG)]))) { \
+      mexErrMsgTxtPrintf1("Argument %d should be function handler or sparse matrix", (NARG)+2); \
+   }
+
 // Check that argument NARG is compatible with a number/string in a MATLAB function
 
 #define ASSERT_NUMERIC_OR_CHAR(NARG) \
@@ -519,6 +758,11 @@ static void mexFunction_primme_set_method(int nlhs, mxArray *plhs[], int nrhs,
    CHKERR(primme_set_method(method, primme));
 }
 
+template <typename T>
+static void convTestFunBlockEigs(void *evals, void *evecs, PRIMME_INT *ldevecs,
+      void *rNorms, int *isConv, int *blockSize, struct primme_params *primme,
+      int *ierr);
+
 // Wrapper around primme_free; prototype:
 // mexFunction_primme_free(primme)
 
@@ -576,11 +820,13 @@ static void mexFunction_primme_set_member(int nlhs, mxArray *plhs[], int nrhs,
 
       // The function handlers are stored in the user data fields in
       // primme_params, e.g., in matrix for matrixMatvec and preconditioner
-      // for applyPreconditioner
+      // for applyPreconditioner. A sparse matrix may be given instead of
+      // a function handler for matrixMatvec, and a diagonal sparse matrix
+      // for applyPreconditioner; they are applied as A*x and P\x.
 
       case PRIMME_matrixMatvec:
       {
-         ASSERT_FUNCTION(2);
+         ASSERT_FUNCTION_OR_SPARSE(2);
          if (primme->matrix) mxDestroyArray((mxArray*)primme->matrix);
          mxArray *a = mxDuplicateArray(prhs[2]);
          mexMakeArrayPersistent(a);
@@ -589,7 +835,7 @@ static void mexFunction_primme_set_member(int nlhs, mxArray *plhs[], int nrhs,
       }
       case PRIMME_applyPreconditioner:
       {
-         ASSERT_FUNCTION(2);
+         ASSERT_FUNCTION_OR_SPARSE(2);
          if (primme->preconditioner) mxDestroyArray((mxArray*)primme->preconditioner);
          mxArray *a = mxDuplicateArray(prhs[2]);
          mexMakeArrayPersistent(a);
@@ -603,6 +849,18 @@ static void mexFunction_primme_set_member(int nlhs, mxArray *plhs[], int nrhs,
          mxArray *a = mxDuplicateArray(prhs[2]);
          mexMakeArrayPersistent(a);
          primme->convtest = (void*)a;
+         primme->convTestFunBlock = NULL;
+         break;
+      }
+      case PRIMME_convTestFunBlock:
+      {
+         ASSERT_FUNCTION(2);
+         if (primme->convtest) mxDestroyArray((mxArray*)primme->convtest);
+         mxArray *a = mxDuplicateArray(prhs[2]);
+         mexMakeArrayPersistent(a);
+         primme->convtest = (void*)a;
+         // Mark the handle as a block test; the proper type is set in xprimme
+         primme->convTestFunBlock = convTestFunBlockEigs<double>;
          break;
       }
       case PRIMME_monitorFun:
@@ -618,10 +876,7 @@ static void mexFunction_primme_set_member(int nlhs, mxArray *plhs[], int nrhs,
 
       // Forbidden members
  
-      case PRIMME_numProcs:
-      case PRIMME_procID:
       case PRIMME_commInfo:
-      case PRIMME_nLocal:
       case PRIMME_globalSumReal:
       case PRIMME_numTargetShifts:
       case PRIMME_intWorkSize:
@@ -724,6 +979,12 @@ static void mexFunction_primme_get_member(int nlhs, mxArray *plhs[], int nrhs,
          plhs[0] = (mxArray*)primme->convtest;
          break;
       }
+      case PRIMME_convTestFunBlock:
+      {
+         plhs[0] = primme->convTestFunBlock ? (mxArray*)primme->convtest :
+            mxCreateDoubleMatrix(0, 0, mxREAL);
+         break;
+      }
       case PRIMME_monitorFun:
       {
          plhs[0] = (mxArray*)primme->monitor;
@@ -796,18 +1057,30 @@ struct getMatrixField {
    static void *get(primme_params *primme) {
       return primme->matrix;
    }
+   enum { inverse = 0, slot = 0 };
 };
 
 struct getPreconditinerField {
    static void* get(primme_params *primme) {
       return primme->preconditioner;
    }
+   enum { inverse = 1, slot = 1 };
 };
 
+// Input mxArrays of matrixMatvecEigs, indexed by F::slot
+
+static CallbackArray callbackArraysEigs[2];
+#ifdef PRIMME_MEX_WITH_GPU
+static CallbackGPUArray callbackGPUArraysEigs[2];
+#endif
+
 // Auxiliary function for mexFunction_xprimme; PRIMME wrapper around
-// matrixMatvec, massMatrixMatvec and applyPreconditioner. Create a mxArray
-// from input vector x, call the function handler returned by F(primme) and
-// copy the content of its returned mxArray into the output vector y.
+// matrixMatvec, massMatrixMatvec and applyPreconditioner. If F(primme) is a
+// sparse matrix, apply it directly. Otherwise copy the input vector x into
+// a mxArray (reused between calls), call the function handler returned by
+// F(primme) and copy the content of its returned mxArray into the output
+// vector y. If callbackOnGPU, x is passed as a gpuArray instead. The vectors
+// have the nLocal rows of this worker.
 
 template <typename T, typename F>
 static void matrixMatvecEigs(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
@@ -825,27 +1098,68 @@ static void matrixMatvecEigs(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
 
    if (*blockSize <= 0) {*ierr = 0; return;}
 
-   // Create input vector x (avoid copy if possible)
+   // Apply sparse matrices without calling MATLAB
 
-   prhs[1] = create_mxArray<typename Real<T>::type,PRIMME_INT>((T*)x, primme->n,
-         (PRIMME_INT)*blockSize, *ldx, true);
+   prhs[0] = (mxArray*)F::get(primme);
+   if (mxIsSparse(prhs[0])) {
+      if (mxIsComplex(prhs[0]) && !isComplex<T>()) {
+         *ierr = 1;
+         return;
+      }
+      sparse_matmat(prhs[0], F::inverse, primme->nLocal,
+            (PRIMME_INT)*blockSize, (T*)x, *ldx, (T*)y, *ldy);
+      *ierr = 0;
+      return;
+   }
+
+   // Create input vector x (avoid copy if possible, otherwise reuse the
+   // mxArray of the previous call)
+
+   bool reuse = true, onGPU = false;
+#ifdef HAVE_OCTAVE
+   reuse = isComplex<T>() || *ldx != primme->nLocal;
+#endif
+#ifdef PRIMME_MEX_WITH_GPU
+   if (callbackOnGPU) {
+      prhs[1] = reuse_gpuArray(callbackGPUArraysEigs[F::slot], (T*)x,
+            primme->nLocal, (PRIMME_INT)*blockSize, *ldx);
+      reuse = false;
+      onGPU = true;
+   }
+   else
+#endif
+   if (reuse) {
+      prhs[1] = reuse_mxArray(callbackArraysEigs[F::slot], (T*)x,
+            primme->nLocal, (PRIMME_INT)*blockSize, *ldx);
+   }
+   else {
+      prhs[1] = create_mxArray<typename Real<T>::type,PRIMME_INT>((T*)x,
+            primme->nLocal, (PRIMME_INT)*blockSize, *ldx, true);
+   }
 
    // Call the callback
 
-   prhs[0] = (mxArray*)F::get(primme);
    *ierr = mexCallMATLAB(1, plhs, 2, prhs, "feval");
 
    // Copy lhs[0] to y and destroy it
 
    if (plhs[0]) {
-      copy_mxArray(plhs[0], (T*)y, primme->n, (PRIMME_INT)*blockSize, *ldy);
+      if (*ierr == 0) {
+         *ierr = copy_callback_mxArray(plhs[0], (T*)y, primme->nLocal,
+               (PRIMME_INT)*blockSize, *ldy);
+      }
       mxDestroyArray(plhs[0]);
    }
 
-   // Destroy prhs[1]
+   // Destroy prhs[1] if it isn't reused
 
-   if (mxGetData(prhs[1]) == x) mxSetData(prhs[1], NULL);
-   mxDestroyArray(prhs[1]); 
+   if (onGPU) {
+      mxDestroyArray(prhs[1]);
+   }
+   else if (!reuse) {
+      if (mxGetData(prhs[1]) == x) mxSetData(prhs[1], NULL);
+      mxDestroyArray(prhs[1]); 
+   }
 }
 
 template <typename T>
@@ -879,6 +1193,71 @@ static void convTestFunEigs(double *eval, void *evec, double *rNorm, int *isConv
    for (int i=1; i<4; i++) mxDestroyArray(prhs[i]); 
 }
 
+// Call the function handle in primme->convtest once with the candidate pairs
+// (the ones with isConv[i] == 0) packed as a vector of values, a matrix of
+// vectors and a vector of residual norms; the handle returns a vector with
+// a nonzero value for every converged pair.
+
+template <typename T>
+static void convTestFunBlockEigs(void *evals, void *evecs, PRIMME_INT *ldevecs,
+      void *rNorms, int *isConv, int *blockSize, struct primme_params *primme,
+      int *ierr)
+{  
+   mxArray *prhs[4], *plhs[1];
+   double *eval = (double*)evals, *rNorm = (double*)rNorms;
+   T *evec = (T*)evecs;
+
+   // Pack the candidates
+
+   int *map = new int[*blockSize], n = 0;
+   for (int i=0; i<*blockSize; i++) if (!isConv[i]) map[n++] = i;
+   *ierr = 0;
+   if (n == 0) {
+      delete [] map;
+      return;
+   }
+   double *ev = new double[n], *rn = new double[n];
+   T *X = evec ? new T[(size_t)primme->nLocal*n] : NULL;
+   for (int i=0; i<n; i++) {
+      ev[i] = eval[map[i]];
+      rn[i] = rNorm[map[i]];
+      if (X) {
+         std::memcpy(&X[(size_t)primme->nLocal*i],
+               &evec[(size_t)*ldevecs*map[i]], sizeof(T)*primme->nLocal);
+      }
+   }
+
+   // Create input vectors
+
+   prhs[1] = create_mxArray<double,int>(ev, n, 1, n);
+   prhs[2] = create_mxArray<typename Real<T>::type,int>(X,
+         X?primme->nLocal:0, X?n:0, X?primme->nLocal:0);
+   prhs[3] = create_mxArray<double,int>(rn, n, 1, n);
+
+   // Call the callback
+
+   prhs[0] = (mxArray*)primme->convtest;
+   *ierr = mexCallMATLAB(1, plhs, 4, prhs, "feval");
+
+   // Copy plhs[0] to the candidates in isConv and destroy it
+
+   if (plhs[0]) {
+      int *conv = new int[n];
+      copy_mxArray(plhs[0], conv, n, 1, n);
+      for (int i=0; i<n; i++) isConv[map[i]] = conv[i] ? 1 : 0;
+      delete [] conv;
+      mxDestroyArray(plhs[0]);
+   }
+
+   // Destroy prhs[1..3] and the packed copies
+
+   for (int i=1; i<4; i++) mxDestroyArray(prhs[i]); 
+   delete [] map;
+   delete [] ev;
+   delete [] rn;
+   if (X) delete [] X;
+}
+
 template <typename T>
 static void monitorFunEigs(void *basisEvals, int *basisSize, int *basisFlags,
       int *iblock, int *blockSize, void *basisNorms, int *numConverged,
@@ -935,18 +1314,42 @@ static void monitorFunEigs(void *basisEvals, int *basisSize, int *basisFlags,
 }
 
 
+// Auxiliary function for mexFunction_xprimme; PRIMME wrapper around
+// globalSumReal when called in an SPMD block
+
+template <typename T>
+static void globalSumEigs(void *sendBuf, void *recvBuf, int *count,
+      struct primme_params *primme, int *ierr)
+{
+   *ierr = globalSum_gplus<typename Real<T>::type>(sendBuf, recvBuf, *count);
+}
+
 // Wrapper around xprimme; prototype:
-// [ret, evals, rnorms, evecs] = mexFunction_xprimme(init_guesses, primme)
+// [ret, evals, rnorms, evecs] = mexFunction_xprimme(init_guesses, primme, [gpu])
+// If gpu is true, the function handles take and may return gpuArrays. In an
+// SPMD block (numProcs > 1) the vectors have the nLocal rows of the worker.
 
 template<typename T>
 static void mexFunction_xprimme(int nlhs, mxArray *plhs[], int nrhs,
       const mxArray *prhs[])
 {
-   ASSERT_NUMARGSIN(2);
+   if (nrhs != 3) ASSERT_NUMARGSIN(2);
    ASSERT_NUMARGSOUTGE(1);
    ASSERT_POINTER(1);
 
    primme_params *primme = (primme_params*)mxArrayToPointer(prhs[1]);
+   bool onGPU = nrhs >= 3 && mxIsLogicalScalarTrue(prhs[2]);
+#ifdef PRIMME_MEX_WITH_GPU
+   if (onGPU && mxInitGPU() != MX_GPU_SUCCESS) {
+      mexErrMsgTxt("Failed to initialize the GPU");
+   }
+#else
+   if (onGPU) {
+      mexErrMsgTxt("primme_mex was built without gpuArray support; "
+            "rebuild it with 'make matlab_gpu'");
+   }
+#endif
+   if (primme->numProcs <= 1) primme->nLocal = primme->n;
 
    // Allocate evals, rnorms and evecs; if possible create the mxArray and use
    // its data
@@ -976,11 +1379,11 @@ static void mexFunction_xprimme(int nlhs, mxArray *plhs[], int nrhs,
    }
 
    if (nlhs <= 2 || isComplex<T>() || primme->numOrthoConst > 0) {
-      evecs = new T[(primme->numOrthoConst+primme->numEvals)*primme->n];
+      evecs = new T[(primme->numOrthoConst+primme->numEvals)*primme->nLocal];
       mxEvecs = NULL;
    }
    else {
-      mxEvecs = mxCreateNumericMatrix(primme->n, primme->numEvals,
+      mxEvecs = mxCreateNumericMatrix(primme->nLocal, primme->numEvals,
             toClassID<T>(), mxREAL);
       evecs = (T*)mxGetData(mxEvecs);
    }
@@ -989,21 +1392,29 @@ static void mexFunction_xprimme(int nlhs, mxArray *plhs[], int nrhs,
 
    if (primme->numOrthoConst + primme->initSize > 0) {
       ASSERT_NUMERIC(0);
-      copy_mxArray(prhs[0], evecs, primme->n,
-            (PRIMME_INT)primme->numOrthoConst+primme->initSize, primme->n);
+      copy_mxArray(prhs[0], evecs, primme->nLocal,
+            (PRIMME_INT)primme->numOrthoConst+primme->initSize,
+            primme->nLocal);
    }
 
-   // Set matvec and preconditioner and monitorFun and convTestFun
+   // Set matvec and preconditioner and monitorFun and convTestFun, and
+   // the reduction with gplus in SPMD blocks
 
    primme->matrixMatvec = matrixMatvecEigs<T, getMatrixField>;
    if (primme->correctionParams.precondition) {
       primme->applyPreconditioner = matrixMatvecEigs<T, getPreconditinerField>;
    }
+   if (primme->numProcs > 1) {
+      primme->globalSumReal = globalSumEigs<T>;
+   }
    if (primme->monitor) {
       primme->monitorFun = monitorFunEigs<T>;
    }
    if (primme->convtest) {
       primme->convTestFun = convTestFunEigs<T>;
+      if (primme->convTestFunBlock) {
+         primme->convTestFunBlock = convTestFunBlockEigs<T>;
+      }
    }
 
 
@@ -1015,10 +1426,31 @@ static void mexFunction_xprimme(int nlhs, mxArray *plhs[], int nrhs,
    if (prev_handler == interrumptHandler) prev_handler = NULL;
 #endif
 
-   // Call xprimme
+   // Call xprimme; keep the callback mxArrays of an outer call, in case
+   // xprimme is called from a callback
+
+   CallbackArray outerArrays[2] = {callbackArraysEigs[0], callbackArraysEigs[1]};
+   callbackArraysEigs[0].a = callbackArraysEigs[1].a = NULL;
+#ifdef PRIMME_MEX_WITH_GPU
+   CallbackGPUArray outerGPUArrays[2] = {callbackGPUArraysEigs[0],
+      callbackGPUArraysEigs[1]};
+   callbackGPUArraysEigs[0].a = callbackGPUArraysEigs[1].a = NULL;
+#endif
+   bool outerOnGPU = callbackOnGPU;
+   callbackOnGPU = onGPU;
 
    int ret = tprimme(evals, evecs, rnorms, primme);
 
+   callbackOnGPU = outerOnGPU;
+   for (int i=0; i<2; i++) {
+      destroy_callbackArray(callbackArraysEigs[i]);
+      callbackArraysEigs[i] = outerArrays[i];
+#ifdef PRIMME_MEX_WITH_GPU
+      destroy_callbackGPUArray(callbackGPUArraysEigs[i]);
+      callbackGPUArraysEigs[i] = outerGPUArrays[i];
+#endif
+   }
+
 #if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__)) || defined (__FreeBSD__)
    // Unset ctrl+c handler
 
@@ -1054,8 +1486,8 @@ static void mexFunction_xprimme(int nlhs, mxArray *plhs[], int nrhs,
    if (nlhs >= 4) {
       if (!mxEvecs) {
          mxEvecs = create_mxArray<typename Real<T>::type,PRIMME_INT>(
-               &evecs[primme->n*primme->numOrthoConst], primme->n,
-               (PRIMME_INT)primme->initSize, primme->n);
+               &evecs[primme->nLocal*primme->numOrthoConst], primme->nLocal,
+               (PRIMME_INT)primme->initSize, primme->nLocal);
          delete [] evecs;
       }
       else {
@@ -1206,10 +1638,6 @@ static void mexFunction_primme_svds_set_member(int nlhs, mxArray *plhs[],
  
       case PRIMME_SVDS_primme: 
       case PRIMME_SVDS_primmeStage2:
-      case PRIMME_SVDS_numProcs: 
-      case PRIMME_SVDS_procID: 
-      case PRIMME_SVDS_mLocal: 
-      case PRIMME_SVDS_nLocal: 
       case PRIMME_SVDS_commInfo:
       case PRIMME_SVDS_globalSumReal:
       case PRIMME_SVDS_numTargetShifts:
@@ -1391,45 +1819,51 @@ static void mexFunction_primme_svds_get_member(int nlhs, mxArray *plhs[],
 // - mode: the corresponding input value in primme_svds.matrixMatvec and
 //         primme_svds.applyPreconditioner.
 // - primme_svds: primme_svds_params
-// - mx: return the number of rows of input vectors x
-// - my: return the number of rows of output vectors y
+// - mx: return the number of local rows of input vectors x
+// - my: return the number of local rows of output vectors y
 // - str: return the corresponding string for mode (notransp/transp or
 //        AHA/AAH/aug).
+// - slot: return the index of the input gpuArray kept between calls
 
 struct getSvdsForMatrix {
    static void get(int transpose, primme_svds_params *primme_svds,
-         PRIMME_INT *mx, PRIMME_INT *my, mxArray **AFUN, const char **str) {
+         PRIMME_INT *mx, PRIMME_INT *my, mxArray **AFUN, const char **str,
+         int *slot) {
       *AFUN = (mxArray*)primme_svds->matrix;
       if (transpose == 0) { /* Doing y <- A * x */
-         *mx = primme_svds->n;
-         *my = primme_svds->m;
+         *mx = primme_svds->nLocal;
+         *my = primme_svds->mLocal;
          *str = "notransp";
+         *slot = 0;
       }
       else { /* Doing y <- A' * x */
-         *mx = primme_svds->m;
-         *my = primme_svds->n;
+         *mx = primme_svds->mLocal;
+         *my = primme_svds->nLocal;
          *str = "transp";
+         *slot = 1;
       }
    }
 };
 
 struct getSvdsForPreconditioner {
    static void get(int mode, primme_svds_params *primme_svds,
-         PRIMME_INT *mx, PRIMME_INT *my, mxArray **AFUN, const char **str) {
+         PRIMME_INT *mx, PRIMME_INT *my, mxArray **AFUN, const char **str,
+         int *slot) {
       *AFUN = (mxArray*)primme_svds->preconditioner;
+      *slot = 2;
       if (mode == primme_svds_op_AtA) {
          /* Preconditioner for A^t*A */
-         *mx = *my = primme_svds->n;
+         *mx = *my = primme_svds->nLocal;
          *str = "AHA";
       }
       else if (mode == primme_svds_op_AAt) {
          /* Preconditioner for A*A^t */
-         *mx = *my = primme_svds->m;
+         *mx = *my = primme_svds->mLocal;
          *str = "AAH";
       }
       else if (mode == primme_svds_op_augmented) {
          /* Preconditioner for [0 A^t; A 0] */
-         *mx = *my = primme_svds->m + primme_svds->n;
+         *mx = *my = primme_svds->mLocal + primme_svds->nLocal;
          *str = "aug";
       }
       else {
@@ -1441,11 +1875,18 @@ struct getSvdsForPreconditioner {
 };
 
 
+#ifdef PRIMME_MEX_WITH_GPU
+// Input gpuArrays of matrixMatvecSvds, indexed by the slot returned by F
+// (A*x, A'*x and the preconditioner)
+
+static CallbackGPUArray callbackGPUArraysSvds[3];
+#endif
+
 // Auxiliary function for mexFunction_xprimme_svds; PRIMME wrapper around
-// matrixMatvec and applyPreconditioner. Create a mxArray
-// from input vector x, call the function handler returned by F and
-// copy the content of its returned mxArray into the output vector y. The
-// functor F returns also the number of rows in x and y and the string
+// matrixMatvec and applyPreconditioner. Create a mxArray (or a gpuArray if
+// callbackOnGPU) from input vector x, call the function handler returned
+// by F and copy the content of its returned mxArray into the output vector
+// y. The functor F returns also the number of rows in x and y and the string
 // passed in callback depending on mode.
 
 template <typename T, typename F>
@@ -1468,11 +1909,21 @@ static void matrixMatvecSvds(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
    // Get numbers of rows of x and y
    PRIMME_INT mx, my;
    const char *str;
-   F::get(*mode, primme_svds, &mx, &my, &prhs[0], &str);
+   int slot;
+   F::get(*mode, primme_svds, &mx, &my, &prhs[0], &str, &slot);
    assert(mx > 0);
 
    // Create input vector x (avoid copy if possible)
 
+   bool onGPU = false;
+#ifdef PRIMME_MEX_WITH_GPU
+   if (callbackOnGPU) {
+      prhs[1] = reuse_gpuArray(callbackGPUArraysSvds[slot], (T*)x, mx,
+            (PRIMME_INT)*blockSize, *ldx);
+      onGPU = true;
+   }
+   else
+#endif
    prhs[1] = create_mxArray<typename Real<T>::type,PRIMME_INT>((T*)x, mx,
          (PRIMME_INT)*blockSize, *ldx, true);
    prhs[2] = mxCreateString(str);
@@ -1484,13 +1935,16 @@ static void matrixMatvecSvds(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
    // Copy lhs[0] to y and destroy it
 
    if (plhs[0]) {
-      copy_mxArray(plhs[0], (T*)y, my, (PRIMME_INT)*blockSize, *ldy);
+      if (*ierr == 0) {
+         *ierr = copy_callback_mxArray(plhs[0], (T*)y, my,
+               (PRIMME_INT)*blockSize, *ldy);
+      }
       mxDestroyArray(plhs[0]);
    }
 
    // Destroy prhs[*]
 
-   if (mxGetData(prhs[1]) == x) mxSetData(prhs[1], NULL);
+   if (!onGPU && mxGetData(prhs[1]) == x) mxSetData(prhs[1], NULL);
    mxDestroyArray(prhs[1]); 
    mxDestroyArray(prhs[2]); 
 }
@@ -1590,19 +2044,46 @@ static void monitorFunSvds(void *basisSvals, int *basisSize, int *basisFlags,
 }
 
 
+// Auxiliary function for mexFunction_xprimme_svds; PRIMME wrapper around
+// globalSumReal when called in an SPMD block
+
+template <typename T>
+static void globalSumSvds(void *sendBuf, void *recvBuf, int *count,
+      struct primme_svds_params *primme_svds, int *ierr)
+{
+   *ierr = globalSum_gplus<typename Real<T>::type>(sendBuf, recvBuf, *count);
+}
+
 // Wrapper around xprimme_svds; prototype:
 // [ret, evals, rnorms, evecs] = mexFunction_xprimme_svds(...
-//                            init_guesses_left, init_guesses_right, primme_svds)
+//                     init_guesses_left, init_guesses_right, primme_svds, [gpu])
+// See mexFunction_xprimme for gpu and SPMD blocks.
 
 template<typename T>
 static void mexFunction_xprimme_svds(int nlhs, mxArray *plhs[], int nrhs,
       const mxArray *prhs[])
 {
-   ASSERT_NUMARGSIN(3);
+   if (nrhs != 4) ASSERT_NUMARGSIN(3);
    ASSERT_NUMARGSOUTGE(1);
    ASSERT_POINTER(2);
 
    primme_svds_params *primme_svds = (primme_svds_params*)mxArrayToPointer(prhs[2]);
+   bool onGPU = nrhs >= 4 && mxIsLogicalScalarTrue(prhs[3]);
+#ifdef PRIMME_MEX_WITH_GPU
+   if (onGPU && mxInitGPU() != MX_GPU_SUCCESS) {
+      mexErrMsgTxt("Failed to initialize the GPU");
+   }
+#else
+   if (onGPU) {
+      mexErrMsgTxt("primme_mex was built without gpuArray support; "
+            "rebuild it with 'make matlab_gpu'");
+   }
+#endif
+   if (primme_svds->numProcs <= 1) {
+      primme_svds->mLocal = primme_svds->m;
+      primme_svds->nLocal = primme_svds->n;
+   }
+   PRIMME_INT mLocal = primme_svds->mLocal, nLocal = primme_svds->nLocal;
 
    // Allocate svals, rnorms and svecs; if possible create the mxArray and use
    // its data
@@ -1633,26 +2114,29 @@ static void mexFunction_xprimme_svds(int nlhs, mxArray *plhs[], int nrhs,
 
    int n = primme_svds->numOrthoConst
       + macro_max(primme_svds->initSize, primme_svds->numSvals);
-   svecs = new T[n*(primme_svds->m+primme_svds->n)];
+   svecs = new T[n*(mLocal+nLocal)];
 
    // Copy initial vectors
 
    if (primme_svds->numOrthoConst + primme_svds->initSize > 0) {
       ASSERT_NUMERIC(0);
       int ninit = primme_svds->numOrthoConst+primme_svds->initSize;
-      copy_mxArray(prhs[0], svecs, primme_svds->m, (PRIMME_INT)ninit,
-            primme_svds->m);
-      copy_mxArray(prhs[1], &svecs[primme_svds->m*ninit], primme_svds->n,
-            (PRIMME_INT)ninit, primme_svds->n);
+      copy_mxArray(prhs[0], svecs, mLocal, (PRIMME_INT)ninit, mLocal);
+      copy_mxArray(prhs[1], &svecs[mLocal*ninit], nLocal, (PRIMME_INT)ninit,
+            nLocal);
    }
 
-   // Set matvec and preconditioner and monitorFun and convTestFun
+   // Set matvec and preconditioner and monitorFun and convTestFun, and
+   // the reduction with gplus in SPMD blocks
 
    primme_svds->matrixMatvec = matrixMatvecSvds<T, getSvdsForMatrix>;
    if (primme_svds->preconditioner) {
       primme_svds->applyPreconditioner =
          matrixMatvecSvds<T, getSvdsForPreconditioner>;
    }
+   if (primme_svds->numProcs > 1) {
+      primme_svds->globalSumReal = globalSumSvds<T>;
+   }
    if (primme_svds->monitor) {
       primme_svds->monitorFun = monitorFunSvds<T>;
    }
@@ -1668,10 +2152,28 @@ static void mexFunction_xprimme_svds(int nlhs, mxArray *plhs[], int nrhs,
    if (prev_handler == interrumptHandler) prev_handler = NULL;
 #endif
 
-   // Call xprimme_svds
+   // Call xprimme_svds; keep the callback gpuArrays of an outer call
+
+#ifdef PRIMME_MEX_WITH_GPU
+   CallbackGPUArray outerGPUArrays[3];
+   for (int i=0; i<3; i++) {
+      outerGPUArrays[i] = callbackGPUArraysSvds[i];
+      callbackGPUArraysSvds[i].a = NULL;
+   }
+#endif
+   bool outerOnGPU = callbackOnGPU;
+   callbackOnGPU = onGPU;
 
    int ret = tprimme_svds(svals, svecs, rnorms, primme_svds);
 
+   callbackOnGPU = outerOnGPU;
+#ifdef PRIMME_MEX_WITH_GPU
+   for (int i=0; i<3; i++) {
+      destroy_callbackGPUArray(callbackGPUArraysSvds[i]);
+      callbackGPUArraysSvds[i] = outerGPUArrays[i];
+   }
+#endif
+
 #if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__)) || defined (__FreeBSD__)
    // Unset ctrl+c handler
 
@@ -1706,15 +2208,15 @@ static void mexFunction_xprimme_svds(int nlhs, mxArray *plhs[], int nrhs,
 
    if (nlhs >= 4) {
       plhs[3] = create_mxArray<typename Real<T>::type,PRIMME_INT>(
-            &svecs[primme_svds->m*primme_svds->numOrthoConst], primme_svds->m,
-            (PRIMME_INT)primme_svds->initSize, primme_svds->m);
+            &svecs[mLocal*primme_svds->numOrthoConst], mLocal,
+            (PRIMME_INT)primme_svds->initSize, mLocal);
    }
 
    if (nlhs >= 5) {
       plhs[4] = create_mxArray<typename Real<T>::type,PRIMME_INT>(
-            &svecs[primme_svds->m*(primme_svds->numOrthoConst+primme_svds->initSize)
-            + primme_svds->n*primme_svds->numOrthoConst], primme_svds->n,
-            (PRIMME_INT)primme_svds->initSize, primme_svds->n);
+            &svecs[mLocal*(primme_svds->numOrthoConst+primme_svds->initSize)
+            + nLocal*primme_svds->numOrthoConst], nLocal,
+            (PRIMME_INT)primme_svds->initSize, nLocal);
    }
 
    delete [] svecs;
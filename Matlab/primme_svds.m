@@ -43,11 +43,25 @@ function [varargout] = primme_svds(varargin)
 %   OPTIONS.primme   options for first stage solver                -
 %   OPTIONS.primmeStage2 options for second stage solver           -
 %   OPTIONS.convTestFun  alternative convergence criterion         -
+%   OPTIONS.gpu      AFUN and PFUN take gpuArrays                  true if A
+%                                                                  is gpuArray
+%   OPTIONS.mLocal   in an SPMD block, rows of A in this worker    -
+%   OPTIONS.nLocal   in an SPMD block, columns of A in this worker -
 %
 %   If OPTIONS.convTestFun(SVAL,LSVEC,RSVEC,RNORM) returns a nonzero
 %   value, the triplet (SVAL,LSVEC,RSVEC) with residual norm RNORM
 %   is considered converged.
 %
+%   If OPTIONS.gpu is true, the vectors are copied to the device and passed to
+%   AFUN and PFUN as gpuArrays, and gpuArrays returned by them are copied back
+%   directly.
+%
+%   Inside an SPMD block, every worker passes the number of local rows of the
+%   left and right singular vectors in OPTIONS.mLocal and OPTIONS.nLocal; AFUN,
+%   PFUN, OPTIONS.u0, OPTIONS.v0 and OPTIONS.orthoConst, and the returned U and
+%   V, have only the local rows, and the workers add their partial inner
+%   products with gplus. A should be given as a function handle.
+%
 %   The available options for OPTIONS.primme and primmeStage2 are
 %   the same as PRIMME_EIGS, plus the option 'method'. For detailed
 %   descriptions of the above options, visit:
@@ -173,7 +187,12 @@ function [varargout] = primme_svds(varargin)
 
       % Get type and complexity
       Acomplex = ~isreal(A);
-      Adouble = strcmp(class(A), 'double');
+      if isa(A, 'gpuArray')
+         opts.gpu = true;
+         Adouble = strcmp(classUnderlying(A), 'double');
+      else
+         Adouble = strcmp(class(A), 'double');
+      end
    else
       opts.matrixMatvec = fcnchk_gen(A); % get the function handle of user's function
       m = round(varargin{nextArg});
@@ -278,14 +297,44 @@ function [varargout] = primme_svds(varargin)
       Aclass = 'single';
    end
 
+   % Process 'gpu' in opts
+   useGPU = false;
+   if isfield(opts, 'gpu')
+      useGPU = logical(opts.gpu);
+      opts = rmfield(opts, 'gpu');
+   end
+   if useGPU
+      onDevice = @(x)gpuArray(x);
+   else
+      onDevice = @(x)x;
+   end
+
+   % Process 'mLocal' and 'nLocal' in opts; the vectors are distributed by
+   % rows among the workers of the SPMD block
+   if isfield(opts, 'mLocal') || isfield(opts, 'nLocal')
+      if ~isfield(opts, 'mLocal') || ~isfield(opts, 'nLocal')
+         error('opts.mLocal and opts.nLocal should be given together');
+      end
+      if isnumeric(A)
+         error('A should be a function handle if opts.mLocal is given');
+      end
+      mLocal = opts.mLocal;
+      nLocal = opts.nLocal;
+      opts.numProcs = numlabs;
+      opts.procID = labindex - 1;
+   else
+      mLocal = opts.m;
+      nLocal = opts.n;
+   end
+
    % Test whether the given matrix and preconditioner are valid
    try
-      x = opts.matrixMatvec(ones(opts.n, 1, Aclass), 'notransp');
-      x = opts.matrixMatvec(ones(opts.m, 1, Aclass), 'transp');
+      x = opts.matrixMatvec(onDevice(ones(nLocal, 1, Aclass)), 'notransp');
+      x = opts.matrixMatvec(onDevice(ones(mLocal, 1, Aclass)), 'transp');
       if isfield(opts, 'applyPreconditioner')
-         x = opts.applyPreconditioner(ones(opts.n, 1, Aclass), 'AHA');
-         x = opts.applyPreconditioner(ones(opts.m, 1, Aclass), 'AAH');
-         x = opts.applyPreconditioner(ones(opts.m+opts.n, 1, Aclass), 'aug');
+         x = opts.applyPreconditioner(onDevice(ones(nLocal, 1, Aclass)), 'AHA');
+         x = opts.applyPreconditioner(onDevice(ones(mLocal, 1, Aclass)), 'AAH');
+         x = opts.applyPreconditioner(onDevice(ones(mLocal+nLocal, 1, Aclass)), 'aug');
       end
       clear x;
    catch ME
@@ -389,7 +438,7 @@ function [varargout] = primme_svds(varargin)
       elseif isempty(init{2})
          init{2} = opts.matrixMatvec(init{1}, 'transp');
       end
-      if size(init{1}, 1) ~= opts.m || size(init{2}, 1) ~= opts.n || ...
+      if size(init{1}, 1) ~= mLocal || size(init{2}, 1) ~= nLocal || ...
          size(init{1}, 2) ~= size(init{2}, 2)
          error('Invalid matrix dimensions in opts.orthoConst');
       end
@@ -408,7 +457,7 @@ function [varargout] = primme_svds(varargin)
       elseif isempty(init{2})
          init0{2} = opts.matrixMatvec(init0{1}, 'transp');
       end
-      if size(init0{1}, 1) ~= opts.m || size(init0{2}, 1) ~= opts.n || ...
+      if size(init0{1}, 1) ~= mLocal || size(init0{2}, 1) ~= nLocal || ...
          size(init0{1}, 2) ~= size(init0{2}, 2)
          error('Invalid matrix dimensions in opts.init');
       end
@@ -465,8 +514,11 @@ function [varargout] = primme_svds(varargin)
    xprimme_svds = [type 'primme_svds'];
 
    % Call xprimme_svds
+   if useGPU
+      init = {gather(init{1}), gather(init{2})};
+   end
    [ierr, svals, norms, svecsl, svecsr] = primme_mex(xprimme_svds, init{1}, ...
-               init{2}, primme_svds); 
+               init{2}, primme_svds, useGPU); 
 
    % Process error code and return the required arguments
    if mod(ierr, -100) == -3 % if it is -3, -103 or -203
@@ -110,7 +110,23 @@ except __builtin__.Exception:
 
 
 
-__all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh', 'PrimmeError', 'PRIMME_Arnoldi', 'PRIMME_DEFAULT_METHOD', 'PRIMME_DEFAULT_MIN_MATVECS', 'PRIMME_DEFAULT_MIN_TIME', 'PRIMME_DYNAMIC', 'PRIMME_GD', 'PRIMME_GD_Olsen_plusK', 'PRIMME_GD_plusK', 'PRIMME_JDQMR', 'PRIMME_JDQMR_ETol', 'PRIMME_JDQR', 'PRIMME_JD_Olsen_plusK', 'PRIMME_LOBPCG_OrthoBasis', 'PRIMME_LOBPCG_OrthoBasis_Window', 'PRIMME_RQI', 'PRIMME_STEEPEST_DESCENT', 'primme_adaptive', 'primme_adaptive_ETolerance', 'primme_closest_abs', 'primme_closest_geq', 'primme_closest_leq', 'primme_decreasing_LTolerance', 'primme_dtr', 'primme_full_LTolerance', 'primme_init_default', 'primme_init_krylov', 'primme_init_random', 'primme_init_user', 'primme_largest', 'primme_largest_abs', 'primme_proj_RR', 'primme_proj_default', 'primme_proj_harmonic', 'primme_proj_refined', 'primme_smallest', 'primme_thick', 'PrimmeSvdsParams', 'svds', 'primme_svds_augmented', 'primme_svds_closest_abs', 'primme_svds_default', 'primme_svds_hybrid', 'primme_svds_largest', 'primme_svds_normalequations', 'primme_svds_op_AAt', 'primme_svds_op_AtA', 'primme_svds_op_augmented', 'primme_svds_op_none', 'primme_svds_smallest', 'sprimme_svds', 'cprimme_svds', 'dprimme_svds', 'zprimme_svds', 'PrimmeSvdsError']
+__all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh', 'PrimmeError', 'PRIMME_Arnoldi', 'PRIMME_DEFAULT_METHOD', 'PRIMME_DEFAULT_MIN_MATVECS', 'PRIMME_DEFAULT_MIN_TIME', 'PRIMME_DYNAMIC', 'PRIMME_GD', 'PRIMME_GD_Olsen_plusK', 'PRIMME_GD_plusK', 'PRIMME_JDQMR', 'PRIMME_JDQMR_ETol', 'PRIMME_JDQR', 'PRIMME_JD_Olsen_plusK', 'PRIMME_LOBPCG_OrthoBasis', 'PRIMME_LOBPCG_OrthoBasis_Window', 'PRIMME_RQI', 'PRIMME_STEEPEST_DESCENT', 'primme_adaptive', 'primme_adaptive_ETolerance', 'primme_closest_abs', 'primme_closest_geq', 'primme_closest_leq', 'primme_decreasing_LTolerance', 'primme_dtr', 'primme_full_LTolerance', 'primme_init_default', 'primme_init_krylov', 'primme_init_random', 'primme_init_user', 'primme_largest', 'primme_largest_abs', 'primme_proj_RR', 'primme_proj_default', 'primme_proj_harmonic', 'primme_proj_refined', 'primme_smallest', 'primme_thick', 'PrimmeSvdsParams', 'svds', 'primme_svds_augmented', 'primme_svds_closest_abs', 'primme_svds_default', 'primme_svds_hybrid', 'primme_svds_largest', 'primme_svds_normalequations', 'primme_svds_op_AAt', 'primme_svds_op_AtA', 'primme_svds_op_augmented', 'primme_svds_op_none', 'primme_svds_smallest', 'sprimme_svds', 'cprimme_svds', 'dprimme_svds', 'zprimme_svds', 'sprimme_svds_packed', 'cprimme_svds_packed', 'dprimme_svds_packed', 'zprimme_svds_packed', 'PrimmeSvdsError']
+
+def sprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds):
+    return _Primme.sprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds)
+sprimme_svds_packed = _Primme.sprimme_svds_packed
+
+def cprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds):
+    return _Primme.cprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds)
+cprimme_svds_packed = _Primme.cprimme_svds_packed
+
+def dprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds):
+    return _Primme.dprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds)
+dprimme_svds_packed = _Primme.dprimme_svds_packed
+
+def zprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds):
+    return _Primme.zprimme_svds_packed(lenSvals, lenSvecs, lenResNorms, primme_svds)
+zprimme_svds_packed = _Primme.zprimme_svds_packed
 
 primme_smallest = _Primme.primme_smallest
 primme_largest = _Primme.primme_largest
@@ -903,6 +919,11 @@ class PrimmeParams(primme_params):
     Abstract class to specify the eigenvalue problem and the options for calling
     dprimme and zprimme.
 
+    The operator is given by overriding matvec(X), which returns A*X, and
+    optionally prevec(X). Setting inplace_set = 1 calls instead
+    matvec_inplace(X, Y) and prevec_inplace(X, Y), where Y is a view of PRIMME's
+    output block to be overwritten, so no array is returned and copied back.
+
     Example
     -------
     >>> import Primme, scipy.sparse, numpy as np
@@ -948,6 +969,11 @@ class PrimmeParams(primme_params):
         Abstract class to specify the eigenvalue problem and the options for calling
         dprimme and zprimme.
 
+        The operator is given by overriding matvec(X), which returns A*X, and
+        optionally prevec(X). Setting inplace_set = 1 calls instead
+        matvec_inplace(X, Y) and prevec_inplace(X, Y), where Y is a view of PRIMME's
+        output block to be overwritten, so no array is returned and copied back.
+
         Example
         -------
         >>> import Primme, scipy.sparse, numpy as np
@@ -1001,12 +1027,31 @@ class PrimmeParams(primme_params):
     def _get_targetShifts(self):
         return _Primme.PrimmeParams__get_targetShifts(self)
 
+    def _set_native_matrix(self, *args):
+        return _Primme.PrimmeParams__set_native_matrix(self, *args)
+
+    def _set_native_diag(self, *args):
+        return _Primme.PrimmeParams__set_native_diag(self, *args)
+
+    def _set_comm(self, fcomm):
+        return _Primme.PrimmeParams__set_comm(self, fcomm)
+
     def matvec(self, *args):
         return _Primme.PrimmeParams_matvec(self, *args)
 
     def prevec(self, *args):
         return _Primme.PrimmeParams_prevec(self, *args)
 
+    def matvec_inplace(self, *args):
+        return _Primme.PrimmeParams_matvec_inplace(self, *args)
+
+    def prevec_inplace(self, *args):
+        return _Primme.PrimmeParams_prevec_inplace(self, *args)
+    __swig_setmethods__["inplace_set"] = _Primme.PrimmeParams_inplace_set_set
+    __swig_getmethods__["inplace_set"] = _Primme.PrimmeParams_inplace_set_get
+    if _newclass:
+        inplace_set = _swig_property(_Primme.PrimmeParams_inplace_set_get, _Primme.PrimmeParams_inplace_set_set)
+
     def globalSum(self, *args):
         return _Primme.PrimmeParams_globalSum(self, *args)
     __swig_setmethods__["globalSum_set"] = _Primme.PrimmeParams_globalSum_set_set
@@ -1032,6 +1077,11 @@ class PrimmeSvdsParams(primme_svds_params):
     Abstract class to specify the eigenvalue problem and the options for calling
     dprimme_svds and zprimme_svds.
 
+    The operator is given by overriding matvec(X, transpose), which returns A*X
+    or A^H*X, and optionally prevec(X, mode). Setting inplace_set = 1 calls
+    instead matvec_inplace(X, Y, transpose) and prevec_inplace(X, Y, mode), where
+    Y is a view of PRIMME's output block to be overwritten.
+
     Example
     -------
     >>> import Primme, scipy.sparse, numpy as np
@@ -1078,6 +1128,11 @@ class PrimmeSvdsParams(primme_svds_params):
         Abstract class to specify the eigenvalue problem and the options for calling
         dprimme_svds and zprimme_svds.
 
+        The operator is given by overriding matvec(X, transpose), which returns A*X
+        or A^H*X, and optionally prevec(X, mode). Setting inplace_set = 1 calls
+        instead matvec_inplace(X, Y, transpose) and prevec_inplace(X, Y, mode), where
+        Y is a view of PRIMME's output block to be overwritten.
+
         Example
         -------
         >>> import Primme, scipy.sparse, numpy as np
@@ -1132,12 +1187,28 @@ class PrimmeSvdsParams(primme_svds_params):
     def _get_targetShifts(self):
         return _Primme.PrimmeSvdsParams__get_targetShifts(self)
 
+    def _set_native_matrix(self, *args):
+        return _Primme.PrimmeSvdsParams__set_native_matrix(self, *args)
+
+    def _set_comm(self, fcomm):
+        return _Primme.PrimmeSvdsParams__set_comm(self, fcomm)
+
     def matvec(self, *args):
         return _Primme.PrimmeSvdsParams_matvec(self, *args)
 
     def prevec(self, *args):
         return _Primme.PrimmeSvdsParams_prevec(self, *args)
 
+    def matvec_inplace(self, *args):
+        return _Primme.PrimmeSvdsParams_matvec_inplace(self, *args)
+
+    def prevec_inplace(self, *args):
+        return _Primme.PrimmeSvdsParams_prevec_inplace(self, *args)
+    __swig_setmethods__["inplace_set"] = _Primme.PrimmeSvdsParams_inplace_set_set
+    __swig_getmethods__["inplace_set"] = _Primme.PrimmeSvdsParams_inplace_set_get
+    if _newclass:
+        inplace_set = _swig_property(_Primme.PrimmeSvdsParams_inplace_set_get, _Primme.PrimmeSvdsParams_inplace_set_set)
+
     def globalSum(self, *args):
         return _Primme.PrimmeSvdsParams_globalSum(self, *args)
     __swig_setmethods__["globalSum_set"] = _Primme.PrimmeSvdsParams_globalSum_set_set
@@ -1159,6 +1230,7 @@ PrimmeSvdsParams_swigregister = _Primme.PrimmeSvdsParams_swigregister
 PrimmeSvdsParams_swigregister(PrimmeSvdsParams)
 
 import numpy as np
+from scipy.sparse import issparse
 from scipy.sparse.linalg.interface import aslinearoperator
 
 __docformat__ = "restructuredtext en"
@@ -1256,11 +1328,56 @@ class PrimmeSvdsError(RuntimeError):
         RuntimeError.__init__(self, "PRIMME SVDS error %d: %s" % (err, msg))
 
 
+def _set_native_operators(pp, dtype, A, Prec=None):
+    """
+    Let PRIMME apply A, if it is a CSR or CSC sparse matrix, and Prec, if it
+    is a diagonal sparse matrix, without calling back into Python. The
+    arrays are kept in pp so that they outlive the solver call. Matrices
+    whose dimensions or number of nonzeros don't fit in a C int are still
+    applied through the Python callbacks.
+    """
+
+    intmax = np.iinfo(np.intc).max
+    arrays = []
+    if (issparse(A) and A.format in ('csr', 'csc') and A.nnz <= intmax
+            and max(A.shape) <= intmax):
+        ptr = np.ascontiguousarray(A.indptr, dtype=np.intc)
+        ind = np.ascontiguousarray(A.indices, dtype=np.intc)
+        val = np.ascontiguousarray(A.data, dtype=dtype)
+        pp._set_native_matrix(A.shape[0], A.shape[1],
+                1 if A.format == 'csc' else 0, ptr, ind, val)
+        arrays += [ptr, ind, val]
+    if issparse(Prec) and max(Prec.shape) <= intmax:
+        P = Prec.tocoo()
+        if np.all(P.row == P.col):
+            diag = np.ascontiguousarray(Prec.diagonal(), dtype=dtype)
+            pp._set_native_diag(diag)
+            arrays.append(diag)
+    pp._native_arrays = arrays
+
+def _global_size(comm, nLocal):
+    """
+    Return the sum of nLocal over the processes in comm, or nLocal if comm
+    is None.
+    """
+
+    return nLocal if comm is None else comm.allreduce(nLocal)
+
+def _copy_cols(dst, src):
+    """Copy src into dst unless src is already dst, as when the caller
+       prepared the initial guesses in the output buffer."""
+
+    if (dst.__array_interface__['data'][0] == src.__array_interface__['data'][0]
+            and dst.strides == src.strides):
+        return
+    np.copyto(dst, src)
+
 def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
           ncv=None, maxiter=None, tol=0, return_eigenvectors=True,
           Minv=None, OPinv=None, mode='normal', ortho=None,
           return_stats=False, maxBlockSize=0, minRestartSize=0,
-          maxPrevRetain=0, method=None, return_history=False, **kargs):
+          maxPrevRetain=0, method=None, return_history=False, comm=None,
+          out=None, **kargs):
     """
     Find k eigenvalues and eigenvectors of the real symmetric square matrix
     or complex Hermitian matrix A.
@@ -1351,6 +1468,19 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
     return_history: bool, optional
         If True, the function returns performance information at every iteration
         (see hist in Returns).
+    comm : mpi4py.MPI.Comm, optional
+        Communicator among the processes that share the problem. Each process
+        passes the rows of the vectors it owns: A, OPinv, v0 and ortho act on
+        the local rows (A and OPinv do the communication they need), and the
+        local rows of the eigenvectors are returned. The reductions of PRIMME
+        are done in C with MPI_Allreduce; it requires the module to be built
+        with PRIMME_WITH_MPI set.
+    out : N x (j+k) ndarray, optional
+        Buffer for the eigenvectors, where j is the number of columns of
+        ortho. PRIMME works on it in place, so it should be Fortran ordered
+        with contiguous columns, and it may be a column slice of a larger
+        array. The returned v is a view of out. If ortho or v0 are already
+        the leading columns of out, they are not copied.
 
     Returns
     -------
@@ -1397,6 +1527,15 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
     This function is a wrapper to PRIMME functions to find the eigenvalues and
     eigenvectors [1]_.
 
+    The interpreter lock is released while PRIMME runs and is taken again
+    only to call A, OPinv and the monitor, so independent calls from several
+    Python threads run concurrently.
+
+    If A is a CSR or CSC sparse matrix, and if OPinv is a diagonal sparse
+    matrix, they are applied in C (with OpenMP if the module was built with
+    it) without calling back into Python. With a communicator of several
+    processes, only a diagonal OPinv is applied that way.
+
     References
     ----------
     .. [1] PRIMME Software, https://github.com/primme/primme
@@ -1418,6 +1557,7 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
     array([ 96.,  95.,  94.])
     """
 
+    Amat, OPinvmat = A, OPinv
     A = aslinearoperator(A)
     if len(A.shape) != 2 or A.shape[0] != A.shape[1]:
         raise ValueError('A: expected square matrix (shape=%s)' % (A.shape,))
@@ -1435,6 +1575,10 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
             return A.matmat(X)
         def prevec(self, X):
             return OPinv.matmat(X)
+        def matvec_inplace(self, X, Y):
+            Y[...] = A.matmat(X)
+        def prevec_inplace(self, X, Y):
+            Y[...] = OPinv.matmat(X)
         def mon(self, basisEvals, basisFlags, iblock, basisNorms, numConverged,
                     lockedEvals, lockedFlags, lockedNorms, inner_its, LSRes, event):
             if event == 0 and len(iblock)>0: # event iteration
@@ -1446,7 +1590,11 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
 
     pp = PP()
 
-    pp.n = A.shape[0]
+    pp.inplace_set = 1
+    pp.nLocal = A.shape[0]
+    pp.n = _global_size(comm, pp.nLocal)
+    if comm is not None:
+        pp._set_comm(comm.py2f())
 
     if k <= 0 or k > pp.n:
         raise ValueError("k=%d must be between 1 and %d, the order of the "
@@ -1497,7 +1645,7 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
         pp.correctionParams.precondition = 1
 
     if ortho is not None:
-        if ortho.shape[0] != pp.n:
+        if ortho.shape[0] != pp.nLocal:
             raise ValueError('ortho: expected matrix with the same columns as A (shape=%s)' % (ortho.shape,))
         pp.numOrthoConst = min(ortho.shape[1], pp.n)
 
@@ -1526,16 +1674,29 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
         Xprimme = zprimme
         rtype = np.dtype(np.float64)
 
+    _set_native_operators(pp, dtype, Amat if pp.numProcs <= 1 else None,
+            OPinvmat)
+
     evals = np.zeros(pp.numEvals, rtype)
     norms = np.zeros(pp.numEvals, rtype)
-    evecs = np.zeros((pp.n, pp.numOrthoConst+pp.numEvals), dtype, order='F')
+    if out is None:
+        evecs = np.zeros((pp.nLocal, pp.numOrthoConst+pp.numEvals), dtype,
+                order='F')
+    else:
+        if out.dtype != dtype:
+            raise ValueError('out: expected dtype %s (dtype=%s)' % (dtype, out.dtype))
+        if (out.ndim != 2 or out.shape[0] != pp.nLocal
+                or out.shape[1] < pp.numOrthoConst+pp.numEvals):
+            raise ValueError('out: expected matrix with at least shape (%d, %d) (shape=%s)' %
+                    (pp.nLocal, pp.numOrthoConst+pp.numEvals, out.shape))
+        evecs = out
 
     if ortho is not None:
-        np.copyto(evecs[:, 0:pp.numOrthoConst], ortho[:, 0:pp.numOrthoConst])
+        _copy_cols(evecs[:, 0:pp.numOrthoConst], ortho[:, 0:pp.numOrthoConst])
 
     if v0 is not None:
         pp.initSize = min(v0.shape[1], pp.numEvals)
-        np.copyto(evecs[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize],
+        _copy_cols(evecs[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize],
             v0[:, 0:pp.initSize])
 
     if maxBlockSize:
@@ -1578,7 +1739,7 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
          u0=None, orthou0=None, orthov0=None,
          return_stats=False, maxBlockSize=0,
          method=None, methodStage1=None, methodStage2=None,
-         return_history=False, **kargs):
+         return_history=False, comm=None, out=None, **kargs):
     """
     Compute k singular values and vectors of the matrix A.
 
@@ -1636,6 +1797,24 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
         If True, the function returns extra information (see stats in Returns).
     return_history: bool, optional
         If True, the function returns performance information at every iteration
+    comm : mpi4py.MPI.Comm, optional
+        Communicator among the processes that share the problem. Each process
+        passes the rows of the left and right vectors it owns: A maps the
+        local rows of v to the local rows of u (doing the communication it
+        needs), the preconditioners act on local rows, and the local rows of
+        the singular vectors are returned. u0 and v0, and orthou0 and orthov0,
+        must be given in pairs. The reductions of PRIMME are done in C with
+        MPI_Allreduce; it requires the module to be built with
+        PRIMME_WITH_MPI set.
+    out : ndarray, optional
+        One-dimensional buffer for the singular vectors, with at least
+        (M+N)*(j+k) elements, where j is the number of columns of orthou0.
+        PRIMME works on it in place: the left vectors are stored first, as
+        an M x (j+i) Fortran ordered matrix, and the right vectors right
+        after, as an N x (j+i) matrix, where i is the number of initial
+        guesses on input and the number of returned triplets on output.
+        The returned u and vt are views of out; except vt for complex
+        matrices, as it is conjugated.
 
     Returns
     -------
@@ -1677,6 +1856,11 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
     This function is a wrapper to PRIMME functions to find singular values and
     vectors [1]_.
 
+    As in eigsh, the interpreter lock is released while PRIMME runs, so
+    independent calls from several Python threads run concurrently.
+    If A is a CSR or CSC sparse matrix it is applied in C without calling
+    back into Python, unless a communicator of several processes is given.
+
     References
     ----------
     .. [1] PRIMME Software, https://github.com/primme/primme
@@ -1707,12 +1891,14 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
     ['5.99871', '5.99057', '6.01065']
     """
 
+    Amat = A
     A = aslinearoperator(A)
 
     m, n = A.shape
+    mGlobal, nGlobal = _global_size(comm, m), _global_size(comm, n)
 
-    if k <= 0 or k > min(n, m):
-        raise ValueError("k=%d must be between 1 and min(A.shape)=%d" % (k, min(n, m)))
+    if k <= 0 or k > min(nGlobal, mGlobal):
+        raise ValueError("k=%d must be between 1 and min(A.shape)=%d" % (k, min(nGlobal, mGlobal)))
 
     if precAHA is not None:
         precAHA = aslinearoperator(precAHA)
@@ -1751,6 +1937,12 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
                 return precAug.matmat(X) 
             return X
 
+        def matvec_inplace(self, X, Y, transpose):
+            Y[...] = self.matvec(X, transpose)
+
+        def prevec_inplace(self, X, Y, mode):
+            Y[...] = self.prevec(X, mode)
+
         def mon(self, basisSvals, basisFlags, iblock, basisNorms, numConverged,
                     lockedSvals, lockedFlags, lockedNorms, inner_its, LSRes,
                     event, stage):
@@ -1763,8 +1955,11 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
 
     pp = PSP()
 
-    pp.m = A.shape[0]
-    pp.n = A.shape[1]
+    pp.inplace_set = 1
+    pp.m, pp.n = mGlobal, nGlobal
+    pp.mLocal, pp.nLocal = m, n
+    if comm is not None:
+        pp._set_comm(comm.py2f())
 
     pp.numSvals = k
 
@@ -1808,6 +2003,9 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
         if u is not None and v is not None and u.shape[1] != v.shape[1]:
             raise ValueError("%s don't have the same number of columns." % var_names)
 
+        if comm is not None and (u is None) != (v is None):
+            raise ValueError("%s must be given both with a communicator." % var_names)
+
         if u is not None and v is None:
             v, _ = np.linalg.qr(A.H.matmult(u))
 
@@ -1819,7 +2017,7 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
     orthou0, orthov0 = check_pair(orthou0, orthov0, "orthov0 or orthou0")
 
     if orthou0 is not None:
-        pp.numOrthoConst = min(orthou0.shape[1], min(m,n))
+        pp.numOrthoConst = min(orthou0.shape[1], min(mGlobal, nGlobal))
 
     if return_history and return_stats:
         pp.monitor_set = 1
@@ -1834,33 +2032,55 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
         dtype = A.dtype
 
     if dtype.type is np.complex64:
-        Xprimme_svds = cprimme_svds
+        Xprimme_svds = cprimme_svds_packed
         rtype = np.dtype(np.float32)
     elif dtype.type is np.float32:
-        Xprimme_svds = sprimme_svds
+        Xprimme_svds = sprimme_svds_packed
         rtype = np.dtype(np.float32)
     elif dtype.type is np.float64:
-        Xprimme_svds = dprimme_svds
+        Xprimme_svds = dprimme_svds_packed
         rtype = np.dtype(np.float64)
     else:
-        Xprimme_svds = zprimme_svds
+        Xprimme_svds = zprimme_svds_packed
         rtype = np.dtype(np.float64)
 
+    _set_native_operators(pp, dtype, Amat if pp.numProcs <= 1 else None)
+
     svals = np.zeros(pp.numSvals, rtype)
-    svecsl = np.zeros((pp.m, pp.numOrthoConst+pp.numSvals), dtype, order='F')
-    svecsr = np.zeros((pp.n, pp.numOrthoConst+pp.numSvals), dtype, order='F')
     norms = np.zeros(pp.numSvals, rtype)
 
-    if orthou0 is not None:
-        np.copyto(svecsl[:, 0:pp.numOrthoConst], orthou0[:, 0:pp.numOrthoConst])
-        np.copyto(svecsr[:, 0:pp.numOrthoConst], orthov0[:, 0:pp.numOrthoConst])
+# PRIMME works in place on a single buffer with the left vectors followed
+# by the right vectors; both blocks have numOrthoConst+initSize columns
+    nsvecs = (pp.mLocal+pp.nLocal)*(pp.numOrthoConst+pp.numSvals)
+    if out is None:
+        svecs = np.zeros(nsvecs, dtype)
+    else:
+        if out.dtype != dtype:
+            raise ValueError('out: expected dtype %s (dtype=%s)' % (dtype, out.dtype))
+        if out.ndim != 1 or out.shape[0] < nsvecs or not out.flags.contiguous:
+            raise ValueError('out: expected contiguous array with at least %d elements (shape=%s)' %
+                    (nsvecs, out.shape))
+        svecs = out
+
+    def svecs_views(n):
+        svecsl = svecs[0:pp.mLocal*n].reshape((pp.mLocal, n), order='F')
+        svecsr = svecs[pp.mLocal*n:(pp.mLocal+pp.nLocal)*n].reshape((pp.nLocal, n), order='F')
+        return svecsl, svecsr
 
     u0, v0 = check_pair(u0, v0, "v0 or u0")
 
     if v0 is not None:
         pp.initSize = min(v0.shape[1], pp.numSvals)
-        np.copyto(svecsl[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize], u0[:, 0:pp.initSize])
-        np.copyto(svecsr[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize], v0[:, 0:pp.initSize])
+
+    svecsl, svecsr = svecs_views(pp.numOrthoConst+pp.initSize)
+
+    if orthou0 is not None:
+        _copy_cols(svecsl[:, 0:pp.numOrthoConst], orthou0[:, 0:pp.numOrthoConst])
+        _copy_cols(svecsr[:, 0:pp.numOrthoConst], orthov0[:, 0:pp.numOrthoConst])
+
+    if v0 is not None:
+        _copy_cols(svecsl[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize], u0[:, 0:pp.initSize])
+        _copy_cols(svecsr[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize], v0[:, 0:pp.initSize])
 
 # Set method
     if method is not None or methodStage1 is not None or methodStage2 is not None:
@@ -1869,7 +2089,7 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
         if methodStage2 is None: methodStage2 = PRIMME_DEFAULT_METHOD
         pp.set_method(method, methodStage1, methodStage2)
 
-    err = Xprimme_svds(svals, svecsl, svecsr, norms, pp)
+    err = Xprimme_svds(svals, svecs, norms, pp)
 
     if err != 0:
         raise PrimmeSvdsError(err)
@@ -1887,6 +2107,7 @@ def svds(A, k=6, ncv=None, tol=0, which='LM', v0=None,
 
     svals = svals[0:pp.initSize]
     norms = norms[0:pp.initSize]
+    svecsl, svecsr = svecs_views(pp.numOrthoConst+pp.initSize)
     svecsl = svecsl[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize]
     svecsr = svecsr[:, pp.numOrthoConst:pp.numOrthoConst+pp.initSize]
 
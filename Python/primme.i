@@ -42,7 +42,7 @@ Uses PRIMME: https://github.com/primme/primme
 %module(docstring=DOCSTRING,directors="1") Primme
 
 %pythoncode %{
-__all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh', 'PrimmeError', 'PRIMME_Arnoldi', 'PRIMME_DEFAULT_METHOD', 'PRIMME_DEFAULT_MIN_MATVECS', 'PRIMME_DEFAULT_MIN_TIME', 'PRIMME_DYNAMIC', 'PRIMME_GD', 'PRIMME_GD_Olsen_plusK', 'PRIMME_GD_plusK', 'PRIMME_JDQMR', 'PRIMME_JDQMR_ETol', 'PRIMME_JDQR', 'PRIMME_JD_Olsen_plusK', 'PRIMME_LOBPCG_OrthoBasis', 'PRIMME_LOBPCG_OrthoBasis_Window', 'PRIMME_RQI', 'PRIMME_STEEPEST_DESCENT', 'primme_adaptive', 'primme_adaptive_ETolerance', 'primme_closest_abs', 'primme_closest_geq', 'primme_closest_leq', 'primme_decreasing_LTolerance', 'primme_dtr', 'primme_full_LTolerance', 'primme_init_default', 'primme_init_krylov', 'primme_init_random', 'primme_init_user', 'primme_largest', 'primme_largest_abs', 'primme_proj_RR', 'primme_proj_default', 'primme_proj_harmonic', 'primme_proj_refined', 'primme_smallest', 'primme_thick', 'PrimmeSvdsParams', 'svds', 'primme_svds_augmented', 'primme_svds_closest_abs', 'primme_svds_default', 'primme_svds_hybrid', 'primme_svds_largest', 'primme_svds_normalequations', 'primme_svds_op_AAt', 'primme_svds_op_AtA', 'primme_svds_op_augmented', 'primme_svds_op_none', 'primme_svds_smallest', 'sprimme_svds', 'cprimme_svds', 'dprimme_svds', 'zprimme_svds', 'PrimmeSvdsError']
+__all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh', 'PrimmeError', 'PRIMME_Arnoldi', 'PRIMME_DEFAULT_METHOD', 'PRIMME_DEFAULT_MIN_MATVECS', 'PRIMME_DEFAULT_MIN_TIME', 'PRIMME_DYNAMIC', 'PRIMME_GD', 'PRIMME_GD_Olsen_plusK', 'PRIMME_GD_plusK', 'PRIMME_JDQMR', 'PRIMME_JDQMR_ETol', 'PRIMME_JDQR', 'PRIMME_JD_Olsen_plusK', 'PRIMME_LOBPCG_OrthoBasis', 'PRIMME_LOBPCG_OrthoBasis_Window', 'PRIMME_RQI', 'PRIMME_STEEPEST_DESCENT', 'primme_adaptive', 'primme_adaptive_ETolerance', 'primme_closest_abs', 'primme_closest_geq', 'primme_closest_leq', 'primme_decreasing_LTolerance', 'primme_dtr', 'primme_full_LTolerance', 'primme_init_default', 'primme_init_krylov', 'primme_init_random', 'primme_init_user', 'primme_largest', 'primme_largest_abs', 'primme_proj_RR', 'primme_proj_default', 'primme_proj_harmonic', 'primme_proj_refined', 'primme_smallest', 'primme_thick', 'PrimmeSvdsParams', 'svds', 'primme_svds_augmented', 'primme_svds_closest_abs', 'primme_svds_default', 'primme_svds_hybrid', 'primme_svds_largest', 'primme_svds_normalequations', 'primme_svds_op_AAt', 'primme_svds_op_AtA', 'primme_svds_op_augmented', 'primme_svds_op_none', 'primme_svds_smallest', 'sprimme_svds', 'cprimme_svds', 'dprimme_svds', 'zprimme_svds', 'sprimme_svds_packed', 'cprimme_svds_packed', 'dprimme_svds_packed', 'zprimme_svds_packed', 'PrimmeSvdsError']
 %}
 // Support PRIMME_INT for int64_t
 %include "stdint.i"
@@ -78,6 +78,9 @@ __all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh',
 }
 %init %{
   import_array();
+#if PY_VERSION_HEX < 0x03070000
+  PyEval_InitThreads();
+#endif
 %}
 
 // Global ignores
@@ -96,6 +99,16 @@ __all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh',
 %ignore tprimme;
 %ignore tprimme_svds;
 
+%ignore NativeType;
+%ignore NativeSparse;
+%ignore NativeDiag;
+%ignore NativeComm;
+%ignore PrimmeParams::nativeA;
+%ignore PrimmeParams::nativePrec;
+%ignore PrimmeParams::nativeComm;
+%ignore PrimmeSvdsParams::nativeA;
+%ignore PrimmeSvdsParams::nativeComm;
+
 %ignore PrimmeParams::matrixMatvec;
 %ignore PrimmeParams::massMatrixMatvec;
 %ignore PrimmeParams::applyPreconditioner;
@@ -250,6 +263,43 @@ __all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh',
   }
 }
 
+/* Typemap suite for (DIM_TYPE DIM1, DIM_TYPE DIM2, DIM_TYPE LD, DATA_TYPE* INPLACE_FARRAY2D)
+   As INPLACE_FARRAY2 in numpy.i, but the columns may be strided, as in a
+   column slice of a larger Fortran ordered array; LD is the leading dimension
+ */
+%typecheck(SWIG_TYPECHECK_DOUBLE_ARRAY,
+           fragment="NumPy_Macros")
+  (DIM_TYPE DIM1, DIM_TYPE DIM2, DIM_TYPE LD, DATA_TYPE* INPLACE_FARRAY2D)
+{
+  $1 = is_array($input) && PyArray_EquivTypenums(array_type($input),
+                                                 DATA_TYPECODE);
+}
+%typemap(in,
+         fragment="NumPy_Fragments")
+  (DIM_TYPE DIM1, DIM_TYPE DIM2, DIM_TYPE LD, DATA_TYPE* INPLACE_FARRAY2D)
+  (PyArrayObject* array=NULL)
+{
+  array = obj_to_array_no_conversion($input, DATA_TYPECODE);
+  if (!array || !require_dimensions(array,2) || !require_native(array)) SWIG_fail;
+  npy_intp * strides = array_strides(array);
+  npy_intp elsize = (npy_intp)sizeof(DATA_TYPE);
+  $1 = (DIM_TYPE) array_size(array,0);
+  $2 = (DIM_TYPE) array_size(array,1);
+  if ($1 > 1 && strides[0] != elsize) {
+    PyErr_SetString(PyExc_TypeError, "Array must have contiguous columns");
+    SWIG_fail;
+  }
+  if ($2 <= 1)
+    $3 = $1;
+  else if (strides[1] % elsize != 0 || strides[1]/elsize < (npy_intp)$1) {
+    PyErr_SetString(PyExc_TypeError, "Array must be Fortran ordered");
+    SWIG_fail;
+  }
+  else
+    $3 = (DIM_TYPE) (strides[1]/elsize);
+  $4 = (DATA_TYPE*) array_data(array);
+}
+
 /* Typemap suite for (DIM_TYPE DIM, DATA_TYPE* IN_ARRAY1D)
    See description of ARGOUTVIEW_FARRAY2 in numpy.i
  */
@@ -313,22 +363,35 @@ __all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh',
    (int lenSvals, float* svals),
    (int lenResNorms, float* resNorms)};
 %apply (int DIM1, int DIM2, double* INPLACE_FARRAY2) {
-   (int len1Evecs, int len2Evecs, double* evecs),
    (int len1SvecsLeft, int len2SvecsLeft, double* svecsLeft),
    (int len1SvecsRight, int len2SvecsRight, double* svecsRight)};
 %apply (int DIM1, int DIM2, float* INPLACE_FARRAY2) {
-   (int len1Evecs, int len2Evecs, float* evecs),
    (int len1SvecsLeft, int len2SvecsLeft, float* svecsLeft),
    (int len1SvecsRight, int len2SvecsRight, float* svecsRight)};
 %apply (int DIM1, int DIM2, std::complex<double>* INPLACE_FARRAY2) {
-   (int len1Evecs, int len2Evecs, std::complex<double>* evecs),
    (int len1SvecsLeft, int len2SvecsLeft, std::complex<double>* svecsLeft),
    (int len1SvecsRight, int len2SvecsRight, std::complex<double>* svecsRight)};
 %apply (int DIM1, int DIM2, std::complex<float>* INPLACE_FARRAY2) {
-   (int len1Evecs, int len2Evecs, std::complex<float>* evecs),
    (int len1SvecsLeft, int len2SvecsLeft, std::complex<float>* svecsLeft),
    (int len1SvecsRight, int len2SvecsRight, std::complex<float>* svecsRight)};
 
+%apply (int DIM1, int DIM2, int LD, double* INPLACE_FARRAY2D) {
+   (int len1Evecs, int len2Evecs, int ldEvecs, double* evecs)};
+%apply (int DIM1, int DIM2, int LD, float* INPLACE_FARRAY2D) {
+   (int len1Evecs, int len2Evecs, int ldEvecs, float* evecs)};
+%apply (int DIM1, int DIM2, int LD, std::complex<double>* INPLACE_FARRAY2D) {
+   (int len1Evecs, int len2Evecs, int ldEvecs, std::complex<double>* evecs)};
+%apply (int DIM1, int DIM2, int LD, std::complex<float>* INPLACE_FARRAY2D) {
+   (int len1Evecs, int len2Evecs, int ldEvecs, std::complex<float>* evecs)};
+%apply (int DIM1, double* INPLACE_ARRAY1) {
+   (int lenSvecs, double* svecs)};
+%apply (int DIM1, float* INPLACE_ARRAY1) {
+   (int lenSvecs, float* svecs)};
+%apply (int DIM1, std::complex<double>* INPLACE_ARRAY1) {
+   (int lenSvecs, std::complex<double>* svecs)};
+%apply (int DIM1, std::complex<float>* INPLACE_ARRAY1) {
+   (int lenSvecs, std::complex<float>* svecs)};
+
 %apply (int DIM1, int DIM2, int LD, double* IN_FARRAY2D) {
    (int len1YD, int len2YD, int ldYD, double* yd)};
 %apply (int DIM1, int DIM2, int LD, float* IN_FARRAY2D) {
@@ -346,6 +409,34 @@ __all__ = ['PrimmeParams', 'sprimme', 'cprimme', 'dprimme', 'zprimme', 'eigsh',
 %apply (int DIM1, int DIM2, int LD, std::complex<float>* OUT_FARRAY2D) {
    (int len1XD, int len2XD, int ldXD, std::complex<float>* xd)};
 
+/* The output block of matvec_inplace and prevec_inplace is also passed as a
+   view, so the callback writes the result directly into PRIMME's memory */
+%apply (int DIM1, int DIM2, int LD, double* IN_FARRAY2D) {
+   (int len1ZD, int len2ZD, int ldZD, double* zd)};
+%apply (int DIM1, int DIM2, int LD, float* IN_FARRAY2D) {
+   (int len1ZD, int len2ZD, int ldZD, float* zd)};
+%apply (int DIM1, int DIM2, int LD, std::complex<double>* IN_FARRAY2D) {
+   (int len1ZD, int len2ZD, int ldZD, std::complex<double>* zd)};
+%apply (int DIM1, int DIM2, int LD, std::complex<float>* IN_FARRAY2D) {
+   (int len1ZD, int len2ZD, int ldZD, std::complex<float>* zd)};
+
+/* The arrays of native operators are referenced, not copied */
+%apply (int DIM1, int* INPLACE_ARRAY1) {
+   (int lenPtr, int *ptr),
+   (int lenInd, int *ind)};
+%apply (int DIM1, double* INPLACE_ARRAY1) {
+   (int lenVal, double *val),
+   (int lenDiag, double *diag)};
+%apply (int DIM1, float* INPLACE_ARRAY1) {
+   (int lenVal, float *val),
+   (int lenDiag, float *diag)};
+%apply (int DIM1, std::complex<double>* INPLACE_ARRAY1) {
+   (int lenVal, std::complex<double> *val),
+   (int lenDiag, std::complex<double> *diag)};
+%apply (int DIM1, std::complex<float>* INPLACE_ARRAY1) {
+   (int lenVal, std::complex<float> *val),
+   (int lenDiag, std::complex<float> *diag)};
+
 /* typemaps for targetShift and numTargetShifts */
  
 %apply (double* IN_ARRAY1, int DIM1) {
@@ -440,17 +531,111 @@ static int tprimme(double *evals, std::complex<double> *evecs, double *resNorms,
       return zprimme(evals, evecs, resNorms, primme);
 }
 
+/* The solvers run without the GIL, so other Python threads may progress  */
+/* while PRIMME does its dense work; every callback into Python takes the */
+/* GIL back for its duration. Both are scoped so that a Python exception, */
+/* raised as a Swig::DirectorException, leaves the GIL held on return.    */
+
+class ReleaseGIL {
+   PyThreadState *state;
+   public:
+   ReleaseGIL() { state = PyEval_SaveThread(); }
+   ~ReleaseGIL() { PyEval_RestoreThread(state); }
+};
+
+class AcquireGIL {
+   PyGILState_STATE state;
+   public:
+   AcquireGIL() { state = PyGILState_Ensure(); }
+   ~AcquireGIL() { PyGILState_Release(state); }
+};
+
+static inline float myconj(float a) { return a; }
+static inline double myconj(double a) { return a; }
+template <typename T>
+static inline std::complex<T> myconj(const std::complex<T> &a) { return std::conj(a); }
+
+/* Compute Y = op(A)*X for a native sparse matrix, where op(A) is A, or   */
+/* A^H if conjtrans is nonzero. Products with the stored matrix (A in     */
+/* CSR, A^H in CSC) are computed row by row; products with its transpose  */
+/* are computed by scattering, with one vector per thread.                */
+
+template <typename T>
+static void native_matmat(const NativeSparse &A, int conjtrans, int blockSize,
+      const T *x, PRIMME_INT ldx, T *y, PRIMME_INT ldy) {
+   const T *val = static_cast<const T*>(A.val);
+   int nr = A.csc ? A.n : A.m, nc = A.csc ? A.m : A.n;
+   if (A.csc == conjtrans) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int i=0; i<nr; i++) {
+         for (int k=0; k<blockSize; k++) y[i+ldy*k] = T(0);
+         for (int p=A.ptr[i]; p<A.ptr[i+1]; p++) {
+            T v = conjtrans ? myconj(val[p]) : val[p];
+            for (int k=0; k<blockSize; k++) y[i+ldy*k] += v*x[A.ind[p]+ldx*k];
+         }
+      }
+   }
+   else {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int k=0; k<blockSize; k++) {
+         const T *xk = &x[ldx*k];
+         T *yk = &y[ldy*k];
+         for (int j=0; j<nc; j++) yk[j] = T(0);
+         for (int i=0; i<nr; i++)
+            for (int p=A.ptr[i]; p<A.ptr[i+1]; p++)
+               yk[A.ind[p]] += (conjtrans ? myconj(val[p]) : val[p])*xk[i];
+      }
+   }
+}
+
+/* Compute Y = D*X for a native diagonal matrix D */
+
+template <typename T>
+static void native_diag(const NativeDiag &D, int blockSize, const T *x,
+      PRIMME_INT ldx, T *y, PRIMME_INT ldy) {
+   const T *val = static_cast<const T*>(D.val);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+   for (int i=0; i<D.n; i++)
+      for (int k=0; k<blockSize; k++) y[i+ldy*k] = val[i]*x[i+ldx*k];
+}
+
 template <typename T>
 static void mymatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, struct primme_params *primme, int *ierr) {
     PrimmeParams *pp = static_cast<PrimmeParams*>(primme);
-    pp->matvec((int)primme->nLocal, *blockSize, (int)*ldx, (T*)x, (int)primme->nLocal, *blockSize, (int)*ldy, (T*)y);
+    if (pp->nativeA.type == NativeType<T>::value) {
+       /* A is Hermitian, so a matrix in CSC is applied as the conjugate */
+       /* of the stored one, which is computed row by row                */
+       native_matmat(pp->nativeA, pp->nativeA.csc, *blockSize, (T*)x, *ldx, (T*)y, *ldy);
+       *ierr = 0;
+       return;
+    }
+    AcquireGIL gil;
+    if (pp->inplace_set)
+       pp->matvec_inplace((int)primme->nLocal, *blockSize, (int)*ldx, (T*)x, (int)primme->nLocal, *blockSize, (int)*ldy, (T*)y);
+    else
+       pp->matvec((int)primme->nLocal, *blockSize, (int)*ldx, (T*)x, (int)primme->nLocal, *blockSize, (int)*ldy, (T*)y);
     *ierr = 0; 
 }
 
 template <typename T>
 static void myprevec(void *x, PRIMME_INT *ldx,  void *y, PRIMME_INT *ldy, int *blockSize, struct primme_params *primme, int *ierr) {
     PrimmeParams *pp = static_cast<PrimmeParams*>(primme);
-    pp->prevec((int)primme->nLocal, *blockSize, (int)*ldx, (T*)x, (int)primme->nLocal, *blockSize, (int)*ldy, (T*)y);
+    if (pp->nativePrec.type == NativeType<T>::value) {
+       native_diag(pp->nativePrec, *blockSize, (T*)x, *ldx, (T*)y, *ldy);
+       *ierr = 0;
+       return;
+    }
+    AcquireGIL gil;
+    if (pp->inplace_set)
+       pp->prevec_inplace((int)primme->nLocal, *blockSize, (int)*ldx, (T*)x, (int)primme->nLocal, *blockSize, (int)*ldy, (T*)y);
+    else
+       pp->prevec((int)primme->nLocal, *blockSize, (int)*ldx, (T*)x, (int)primme->nLocal, *blockSize, (int)*ldy, (T*)y);
     *ierr = 0; 
 }
 
@@ -463,17 +648,70 @@ struct Real<std::complex<float> > { typedef float type;};
 
 template <typename T>
 static void myglobalSum(void *sendBuf, void *recvBuf, int *count, struct primme_params *primme, int *ierr) {
+    AcquireGIL gil;
     PrimmeParams *pp = static_cast<PrimmeParams*>(primme);
     pp->globalSum(*count, static_cast<typename Real<T>::type*>(sendBuf), *count, static_cast<typename Real<T>::type*>(recvBuf));
     *ierr = 0;
 }
 
+#ifdef PRIMME_WITH_MPI
+
+/* Reductions on the raw buffers with the communicator given to the params, */
+/* without taking the GIL                                                   */
+
+template <typename T> struct MPIType;
+template <> struct MPIType<float> { static MPI_Datatype get() { return MPI_FLOAT; } };
+template <> struct MPIType<double> { static MPI_Datatype get() { return MPI_DOUBLE; } };
+
+template <typename T>
+static int native_globalSum(void *sendBuf, void *recvBuf, int count, MPI_Comm comm) {
+    return MPI_Allreduce(sendBuf == recvBuf ? MPI_IN_PLACE : sendBuf, recvBuf,
+          count, MPIType<typename Real<T>::type>::get(), MPI_SUM, comm)
+       != MPI_SUCCESS;
+}
+
+template <typename T>
+static void myglobalSum_mpi(void *sendBuf, void *recvBuf, int *count, struct primme_params *primme, int *ierr) {
+    PrimmeParams *pp = static_cast<PrimmeParams*>(primme);
+    *ierr = native_globalSum<T>(sendBuf, recvBuf, *count, pp->nativeComm.comm);
+}
+
+template <typename T>
+static void myglobalSumStart_mpi(void *sendBuf, void *recvBuf, int *count, struct primme_params *primme, void **request, int *ierr) {
+    PrimmeParams *pp = static_cast<PrimmeParams*>(primme);
+    MPI_Request *r = new MPI_Request;
+    *ierr = MPI_Iallreduce(sendBuf == recvBuf ? MPI_IN_PLACE : sendBuf,
+          recvBuf, *count, MPIType<typename Real<T>::type>::get(), MPI_SUM,
+          pp->nativeComm.comm, r) != MPI_SUCCESS;
+    if (*ierr) {
+       delete r;
+       r = NULL;
+    }
+    *request = r;
+}
+
+static void myglobalSumWait_mpi(void *request, struct primme_params *primme, int *ierr) {
+    MPI_Request *r = static_cast<MPI_Request*>(request);
+    (void)primme;
+    *ierr = MPI_Wait(r, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+    delete r;
+}
+
+template <typename T>
+static void myglobalSum_svds_mpi(void *sendBuf, void *recvBuf, int *count, struct primme_svds_params *primme_svds, int *ierr) {
+    PrimmeSvdsParams *pp = static_cast<PrimmeSvdsParams*>(primme_svds);
+    *ierr = native_globalSum<T>(sendBuf, recvBuf, *count, pp->nativeComm.comm);
+}
+
+#endif
+
 
 template <typename T>
 static void mymonitorFun(void *basisEvals, int *basisSize, int *basisFlags, int *iblock, int *blockSize,
       void *basisNorms, int *numConverged, void *lockedEvals, int *numLocked, int *lockedFlags, void *lockedNorms,
       int *inner_its, void *LSRes, primme_event *event, struct primme_params *primme, int *ierr)
 {
+    AcquireGIL gil;
     PrimmeParams *pp = static_cast<PrimmeParams*>(primme);
     pp->mon(
             basisSize?*basisSize:0, static_cast<typename Real<T>::type*>(basisEvals),
@@ -493,7 +731,7 @@ static void mymonitorFun(void *basisEvals, int *basisSize, int *basisFlags, int
 
 template <typename T, typename R>
 int my_primme(int lenEvals, R *evals,
-            int len1Evecs, int len2Evecs, T *evecs,
+            int len1Evecs, int len2Evecs, int ldEvecs, T *evecs,
             int lenResNorms, R *resNorms, 
             PrimmeParams *primme) {
    if (lenEvals < primme->numEvals) {
@@ -504,12 +742,15 @@ int my_primme(int lenEvals, R *evals,
    }
    if (primme->nLocal == -1)
         primme->nLocal = primme->n;
-   if (len1Evecs < primme->nLocal || len2Evecs < primme->numEvals) {
+   if (len1Evecs < primme->nLocal
+         || len2Evecs < primme->numOrthoConst + primme->numEvals) {
         PyErr_Format(PyExc_ValueError,
                      "Size of `evecs' should be at least (%" PRIMME_INT_P ", %d)",
-                     primme->nLocal, primme->numEvals);
+                     primme->nLocal, primme->numOrthoConst + primme->numEvals);
         return -31;
    }
+   /* evecs is used in place; it may be a column slice of a larger array */
+   primme->ldevecs = ldEvecs;
    if (lenResNorms < primme->numEvals) {
         PyErr_Format(PyExc_ValueError,
                      "Length of `resNorms' should be at least %d",
@@ -519,11 +760,23 @@ int my_primme(int lenEvals, R *evals,
    primme->matrixMatvec = mymatvec<T>;
    if (primme->correctionParams.precondition) 
       primme->applyPreconditioner = myprevec<T>;
+#ifdef PRIMME_WITH_MPI
+   if (primme->nativeComm.set) {
+      primme->globalSumReal = myglobalSum_mpi<T>;
+      primme->globalSumRealStart = myglobalSumStart_mpi<T>;
+      primme->globalSumRealWait = myglobalSumWait_mpi;
+   }
+   else
+#endif
    if (primme->globalSum_set)
       primme->globalSumReal = myglobalSum<T>;
    if (primme->monitor_set)
       primme->monitorFun = mymonitorFun<T>;
-   int ret = tprimme(evals, evecs, resNorms, static_cast<primme_params*>(primme));
+   int ret;
+   {
+      ReleaseGIL nogil;
+      ret = tprimme(evals, evecs, resNorms, static_cast<primme_params*>(primme));
+   }
    return ret;
 }
 
@@ -542,6 +795,7 @@ static int tprimme_svds(double *svals, std::complex<double> *svecs, double *resN
 
 template <typename T>
 static void myglobalSum_svds(void *sendBuf, void *recvBuf, int *count, struct primme_svds_params *primme_svds, int *ierr) {
+    AcquireGIL gil;
     PrimmeSvdsParams *pp = static_cast<PrimmeSvdsParams*>(primme_svds);
     pp->globalSum(*count, static_cast<typename Real<T>::type*>(sendBuf), *count, static_cast<typename Real<T>::type*>(recvBuf));
     *ierr = 0;
@@ -550,6 +804,12 @@ static void myglobalSum_svds(void *sendBuf, void *recvBuf, int *count, struct pr
 template <typename T>
 static void mymatvec_svds(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, int *transpose, struct primme_svds_params *primme_svds, int *ierr) {
    PrimmeSvdsParams *pp = static_cast<PrimmeSvdsParams*>(primme_svds);
+   if (pp->nativeA.type == NativeType<T>::value) {
+      native_matmat(pp->nativeA, *transpose, *blockSize, (T*)x, *ldx, (T*)y, *ldy);
+      *ierr = 0;
+      return;
+   }
+   AcquireGIL gil;
    PRIMME_INT m, n;
    if (*transpose == 0) {
       m = primme_svds->mLocal;
@@ -559,12 +819,16 @@ static void mymatvec_svds(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, in
       n = primme_svds->mLocal;
       m = primme_svds->nLocal;
    }
-   pp->matvec((int)n, *blockSize, (int)*ldx, (T*)x, (int)m, *blockSize, (int)*ldy, (T*)y, *transpose);
+   if (pp->inplace_set)
+      pp->matvec_inplace((int)n, *blockSize, (int)*ldx, (T*)x, (int)m, *blockSize, (int)*ldy, (T*)y, *transpose);
+   else
+      pp->matvec((int)n, *blockSize, (int)*ldx, (T*)x, (int)m, *blockSize, (int)*ldy, (T*)y, *transpose);
    *ierr = 0;
 }
 
 template <typename T>
 static void myprevec_svds(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, int *mode, struct primme_svds_params *primme_svds, int *ierr) {
+   AcquireGIL gil;
    PrimmeSvdsParams *pp = static_cast<PrimmeSvdsParams*>(primme_svds);
    PRIMME_INT m=0;
    if (*mode == primme_svds_op_AtA) {
@@ -574,7 +838,10 @@ static void myprevec_svds(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, in
    } else if (*mode == primme_svds_op_augmented) {
       m = primme_svds->mLocal + primme_svds->nLocal;
    }
-   pp->prevec((int)m, *blockSize, (int)*ldx, (T*)x, (int)m, *blockSize, (int)*ldy, (T*)y, *mode);
+   if (pp->inplace_set)
+      pp->prevec_inplace((int)m, *blockSize, (int)*ldx, (T*)x, (int)m, *blockSize, (int)*ldy, (T*)y, *mode);
+   else
+      pp->prevec((int)m, *blockSize, (int)*ldx, (T*)x, (int)m, *blockSize, (int)*ldy, (T*)y, *mode);
    *ierr = 0;
 }
 
@@ -583,6 +850,7 @@ static void mymonitorFun_svds(void *basisEvals, int *basisSize, int *basisFlags,
       void *basisNorms, int *numConverged, void *lockedEvals, int *numLocked, int *lockedFlags, void *lockedNorms,
       int *inner_its, void *LSRes, primme_event *event, int *stage, struct primme_svds_params *primme_svds, int *ierr)
 {
+    AcquireGIL gil;
     PrimmeSvdsParams *pp = static_cast<PrimmeSvdsParams*>(primme_svds);
     pp->mon(
             basisSize?*basisSize:0, static_cast<typename Real<T>::type*>(basisEvals),
@@ -638,6 +906,11 @@ int my_primme_svds(int lenSvals, R *svals,
    primme_svds->matrixMatvec = mymatvec_svds<T>;
    if (primme_svds->precondition) 
       primme_svds->applyPreconditioner = myprevec_svds<T>;
+#ifdef PRIMME_WITH_MPI
+   if (primme_svds->nativeComm.set)
+      primme_svds->globalSumReal = myglobalSum_svds_mpi<T>;
+   else
+#endif
    if (primme_svds->globalSum_set)
       primme_svds->globalSumReal = myglobalSum_svds<T>;
    if (primme_svds->monitor_set)
@@ -648,7 +921,11 @@ int my_primme_svds(int lenSvals, R *svals,
    copy_matrix(svecsRight, primme_svds->nLocal, primme_svds->numOrthoConst,
          (PRIMME_INT)len1SvecsRight, &svecs[primme_svds->numOrthoConst*primme_svds->mLocal],
          primme_svds->nLocal);
-   int ret = tprimme_svds(svals, svecs, resNorms, static_cast<primme_svds_params*>(primme_svds));
+   int ret;
+   {
+      ReleaseGIL nogil;
+      ret = tprimme_svds(svals, svecs, resNorms, static_cast<primme_svds_params*>(primme_svds));
+   }
    copy_matrix(&svecs[primme_svds->mLocal*primme_svds->numOrthoConst],
          primme_svds->mLocal, primme_svds->numSvals,
          primme_svds->mLocal, &svecsLeft[len1SvecsLeft*primme_svds->numOrthoConst], (PRIMME_INT)len1SvecsLeft);
@@ -660,6 +937,60 @@ int my_primme_svds(int lenSvals, R *svals,
 
    return ret;
 }
+
+/* As my_primme_svds, but svecs is used in place with PRIMME's layout: the
+   left vectors, mLocal x (numOrthoConst+initSize), followed by the right
+   vectors, nLocal x (numOrthoConst+initSize); on return the blocks have
+   numOrthoConst+initSize columns with the updated initSize */
+
+template <typename T, typename R>
+int my_primme_svds_packed(int lenSvals, R *svals,
+            int lenSvecs, T *svecs,
+            int lenResNorms, R *resNorms, 
+            PrimmeSvdsParams *primme_svds) {
+   if (lenSvals < primme_svds->numSvals) {
+        PyErr_Format(PyExc_ValueError,
+                     "Length of `svals' should be at least %d",
+                     primme_svds->numSvals);
+        return -30;
+   }
+   if (primme_svds->mLocal == -1)
+        primme_svds->mLocal = primme_svds->m;
+   if (primme_svds->nLocal == -1)
+        primme_svds->nLocal = primme_svds->n;
+   if (lenSvecs < (primme_svds->mLocal+primme_svds->nLocal)
+            *(primme_svds->numOrthoConst+primme_svds->numSvals)) {
+        PyErr_Format(PyExc_ValueError,
+                     "Length of `svecs' should be at least %" PRIMME_INT_P,
+                     (primme_svds->mLocal+primme_svds->nLocal)
+                        *(primme_svds->numOrthoConst+primme_svds->numSvals));
+        return -31;
+   }
+   if (lenResNorms < primme_svds->numSvals) {
+        PyErr_Format(PyExc_ValueError,
+                     "Length of `resNorms' should be at least %d",
+                     primme_svds->numSvals);
+        return -32;
+   }
+   primme_svds->matrixMatvec = mymatvec_svds<T>;
+   if (primme_svds->precondition) 
+      primme_svds->applyPreconditioner = myprevec_svds<T>;
+#ifdef PRIMME_WITH_MPI
+   if (primme_svds->nativeComm.set)
+      primme_svds->globalSumReal = myglobalSum_svds_mpi<T>;
+   else
+#endif
+   if (primme_svds->globalSum_set)
+      primme_svds->globalSumReal = myglobalSum_svds<T>;
+   if (primme_svds->monitor_set)
+      primme_svds->monitorFun = mymonitorFun_svds<T>;
+   int ret;
+   {
+      ReleaseGIL nogil;
+      ret = tprimme_svds(svals, svecs, resNorms, static_cast<primme_svds_params*>(primme_svds));
+   }
+   return ret;
+}
 %}
 
 %template (sprimme) my_primme<float,float>;
@@ -670,6 +1001,10 @@ int my_primme_svds(int lenSvals, R *svals,
 %template (cprimme_svds) my_primme_svds<std::complex<float>,float>;
 %template (dprimme_svds) my_primme_svds<double,double>;
 %template (zprimme_svds) my_primme_svds<std::complex<double>,double>;
+%template (sprimme_svds_packed) my_primme_svds_packed<float,float>;
+%template (cprimme_svds_packed) my_primme_svds_packed<std::complex<float>,float>;
+%template (dprimme_svds_packed) my_primme_svds_packed<double,double>;
+%template (zprimme_svds_packed) my_primme_svds_packed<std::complex<double>,double>;
 
 
 %feature("director") PrimmeParams;
@@ -684,6 +1019,11 @@ int my_primme_svds(int lenSvals, R *svals,
 "Abstract class to specify the eigenvalue problem and the options for calling
 dprimme and zprimme.
 
+The operator is given by overriding matvec(X), which returns A*X, and
+optionally prevec(X). Setting inplace_set = 1 calls instead
+matvec_inplace(X, Y) and prevec_inplace(X, Y), where Y is a view of PRIMME's
+output block to be overwritten, so no array is returned and copied back.
+
 Example
 -------
 >>> import Primme, scipy.sparse, numpy as np
@@ -719,6 +1059,11 @@ array([ 99.,  98.,  97.])
 "Abstract class to specify the eigenvalue problem and the options for calling
 dprimme_svds and zprimme_svds.
 
+The operator is given by overriding matvec(X, transpose), which returns A*X
+or A^H*X, and optionally prevec(X, mode). Setting inplace_set = 1 calls
+instead matvec_inplace(X, Y, transpose) and prevec_inplace(X, Y, mode), where
+Y is a view of PRIMME's output block to be overwritten.
+
 Example
 -------
 >>> import Primme, scipy.sparse, numpy as np
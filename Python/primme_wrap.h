@@ -28,6 +28,14 @@ public:
     virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex< float > *yd, int len1XD, int len2XD, int ldXD, std::complex< float > *xd);
     virtual void prevec(int len1YD, int len2YD, int ldYD, double *yd, int len1XD, int len2XD, int ldXD, double *xd);
     virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex< double > *yd, int len1XD, int len2XD, int ldXD, std::complex< double > *xd);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex< float > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< float > *zd);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex< double > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< double > *zd);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex< float > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< float > *zd);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex< double > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< double > *zd);
     virtual void globalSum(int lenYD, float *yd, int lenXD, float *xd);
     virtual void globalSum(int lenYD, double *yd, int lenXD, double *xd);
     virtual void mon(int lenbasisEvals, float *basisEvals, int lenbasisFlags, int *basisFlags, int leniblock, int *iblock, int lenbasisNorms, float *basisNorms, int numConverged, int lenlockedEvals, float *lockedEvals, int lenlockedFlags, int *lockedFlags, int lenlockedNorms, float *lockedNorms, int inner_its, float LSRes, int event);
@@ -62,7 +70,7 @@ private:
       return method;
     }
 private:
-    mutable swig::SwigVar_PyObject vtable[12];
+    mutable swig::SwigVar_PyObject vtable[20];
 #endif
 
 };
@@ -81,6 +89,14 @@ public:
     virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex< float > *yd, int len1XD, int len2XD, int ldXD, std::complex< float > *xd, int mode);
     virtual void prevec(int len1YD, int len2YD, int ldYD, double *yd, int len1XD, int len2XD, int ldXD, double *xd, int mode);
     virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex< double > *yd, int len1XD, int len2XD, int ldXD, std::complex< double > *xd, int mode);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd, int transpose);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex< float > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< float > *zd, int transpose);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd, int transpose);
+    virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex< double > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< double > *zd, int transpose);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd, int mode);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex< float > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< float > *zd, int mode);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd, int mode);
+    virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex< double > *yd, int len1ZD, int len2ZD, int ldZD, std::complex< double > *zd, int mode);
     virtual void globalSum(int lenYD, float *yd, int lenXD, float *xd);
     virtual void globalSum(int lenYD, double *yd, int lenXD, double *xd);
     virtual void mon(int lenbasisSvals, float *basisSvals, int lenbasisFlags, int *basisFlags, int leniblock, int *iblock, int lenbasisNorms, float *basisNorms, int numConverged, int lenlockedSvals, float *lockedSvals, int lenlockedFlags, int *lockedFlags, int lenlockedNorms, float *lockedNorms, int inner_its, float LSRes, int event, int stage);
@@ -115,7 +131,7 @@ private:
       return method;
     }
 private:
-    mutable swig::SwigVar_PyObject vtable[12];
+    mutable swig::SwigVar_PyObject vtable[20];
 #endif
 
 };
@@ -37,9 +37,90 @@
 #include <cstring>
 #include <cassert>
 #include <complex>
+#include <stdexcept>
 
 #include "../include/primme.h"
 
+#ifdef PRIMME_WITH_MPI
+#  include <mpi.h>
+#endif
+
+/* Tag of the numerical type of a native operator */
+
+template <typename T> struct NativeType;
+template <> struct NativeType<float> { enum { value = 1 }; };
+template <> struct NativeType<std::complex<float> > { enum { value = 2 }; };
+template <> struct NativeType<double> { enum { value = 3 }; };
+template <> struct NativeType<std::complex<double> > { enum { value = 4 }; };
+
+/* Sparse matrix of size m x n stored in compressed sparse rows, or in     */
+/* compressed sparse columns if csc is nonzero. The arrays are owned by    */
+/* the caller and must outlive the solver call.                            */
+
+struct NativeSparse {
+   int m, n, csc, type;
+   int *ptr, *ind;
+   void *val;
+
+   NativeSparse() : m(0), n(0), csc(0), type(0), ptr(NULL), ind(NULL), val(NULL) {}
+
+   template <typename T>
+   void set(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind,
+         int lenVal, T *val) {
+      if (m < 0 || n < 0 || lenPtr != (csc ? n : m) + 1 || ptr[0] != 0 ||
+            lenInd < ptr[lenPtr-1] || lenVal < ptr[lenPtr-1])
+         throw std::invalid_argument("inconsistent sparse matrix arrays");
+      this->m = m; this->n = n; this->csc = csc;
+      this->ptr = ptr; this->ind = ind; this->val = val;
+      type = NativeType<T>::value;
+   }
+};
+
+/* Diagonal matrix, with the values owned by the caller */
+
+struct NativeDiag {
+   int n, type;
+   void *val;
+
+   NativeDiag() : n(0), type(0), val(NULL) {}
+
+   template <typename T>
+   void set(int lenDiag, T *val) {
+      n = lenDiag; this->val = val;
+      type = NativeType<T>::value;
+   }
+};
+
+/* MPI communicator to reduce among the processes in C, given by its       */
+/* Fortran handle (as returned by mpi4py's Comm.py2f()) so that no mpi4py   */
+/* header is needed. It sets numProcs and procID.                           */
+
+struct NativeComm {
+   int set;
+#ifdef PRIMME_WITH_MPI
+   MPI_Comm comm;
+#endif
+
+   NativeComm() : set(0) {}
+
+   void set_fortran(int fcomm, int *numProcs, int *procID) {
+#ifdef PRIMME_WITH_MPI
+      int initialized;
+      MPI_Initialized(&initialized);
+      if (!initialized)
+         throw std::invalid_argument("MPI is not initialized");
+      comm = MPI_Comm_f2c((MPI_Fint)fcomm);
+      MPI_Comm_size(comm, numProcs);
+      MPI_Comm_rank(comm, procID);
+      set = 1;
+#else
+      (void)fcomm; (void)numProcs; (void)procID;
+      throw std::invalid_argument(
+            "the module was built without MPI; set PRIMME_WITH_MPI");
+#endif
+   }
+};
+
 class PrimmeParams : public primme_params {
    public:
 
@@ -48,6 +129,7 @@ class PrimmeParams : public primme_params {
       correctionParams.precondition = 0;
       globalSum_set = 0;
       monitor_set = 0;
+      inplace_set = 0;
    }
 
    virtual ~PrimmeParams() {
@@ -79,6 +161,41 @@ class PrimmeParams : public primme_params {
       *n = this->numTargetShifts;
    }
 
+   /* If set, A and the preconditioner are applied in C++ on these arrays, */
+   /* without calling back into Python                                    */
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, float *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, std::complex<float> *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, double *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, std::complex<double> *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_diag(int lenDiag, float *diag) {
+      nativePrec.set(lenDiag, diag);
+   }
+   void _set_native_diag(int lenDiag, std::complex<float> *diag) {
+      nativePrec.set(lenDiag, diag);
+   }
+   void _set_native_diag(int lenDiag, double *diag) {
+      nativePrec.set(lenDiag, diag);
+   }
+   void _set_native_diag(int lenDiag, std::complex<double> *diag) {
+      nativePrec.set(lenDiag, diag);
+   }
+   NativeSparse nativeA;
+   NativeDiag nativePrec;
+
+   /* If set, globalSumReal is MPI_Allreduce on this communicator */
+   void _set_comm(int fcomm) {
+      nativeComm.set_fortran(fcomm, &numProcs, &procID);
+   }
+   NativeComm nativeComm;
+
    virtual void matvec(int len1YD, int len2YD, int ldYD, float *yd, int len1XD, int len2XD, int ldXD, float *xd)=0;
    virtual void matvec(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1XD, int len2XD, int ldXD, std::complex<float> *xd)=0;
    virtual void matvec(int len1YD, int len2YD, int ldYD, double *yd, int len1XD, int len2XD, int ldXD, double *xd)=0;
@@ -87,6 +204,15 @@ class PrimmeParams : public primme_params {
    virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1XD, int len2XD, int ldXD, std::complex<float> *xd)=0;
    virtual void prevec(int len1YD, int len2YD, int ldYD, double *yd, int len1XD, int len2XD, int ldXD, double *xd)=0;
    virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex<double> *yd, int len1XD, int len2XD, int ldXD, std::complex<double> *xd)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<float> *zd)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex<double> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<double> *zd)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<float> *zd)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex<double> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<double> *zd)=0;
+   int inplace_set;
    virtual void globalSum(int lenYD, float *yd, int lenXD, float *xd)=0;
    virtual void globalSum(int lenYD, double *yd, int lenXD, double *xd)=0;
    int globalSum_set;
@@ -109,6 +235,7 @@ class PrimmeSvdsParams : public primme_svds_params {
       precondition = 0;
       globalSum_set = 0;
       monitor_set = 0;
+      inplace_set = 0;
    }
 
    virtual ~PrimmeSvdsParams() {
@@ -141,6 +268,28 @@ class PrimmeSvdsParams : public primme_svds_params {
       *n = this->numTargetShifts;
    }
 
+   /* If set, A and the preconditioner are applied in C++ on these arrays, */
+   /* without calling back into Python                                    */
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, float *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, std::complex<float> *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, double *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   void _set_native_matrix(int m, int n, int csc, int lenPtr, int *ptr, int lenInd, int *ind, int lenVal, std::complex<double> *val) {
+      nativeA.set(m, n, csc, lenPtr, ptr, lenInd, ind, lenVal, val);
+   }
+   NativeSparse nativeA;
+
+   /* If set, globalSumReal is MPI_Allreduce on this communicator */
+   void _set_comm(int fcomm) {
+      nativeComm.set_fortran(fcomm, &numProcs, &procID);
+   }
+   NativeComm nativeComm;
+
    virtual void matvec(int len1YD, int len2YD, int ldYD, float *yd, int len1XD, int len2XD, int ldXD, float *xd, int transpose)=0;
    virtual void matvec(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1XD, int len2XD, int ldXD, std::complex<float> *xd, int transpose)=0;
    virtual void matvec(int len1YD, int len2YD, int ldYD, double *yd, int len1XD, int len2XD, int ldXD, double *xd, int transpose)=0;
@@ -149,6 +298,15 @@ class PrimmeSvdsParams : public primme_svds_params {
    virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1XD, int len2XD, int ldXD, std::complex<float> *xd, int mode)=0;
    virtual void prevec(int len1YD, int len2YD, int ldYD, double *yd, int len1XD, int len2XD, int ldXD, double *xd, int mode)=0;
    virtual void prevec(int len1YD, int len2YD, int ldYD, std::complex<double> *yd, int len1XD, int len2XD, int ldXD, std::complex<double> *xd, int mode)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd, int transpose)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<float> *zd, int transpose)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd, int transpose)=0;
+   virtual void matvec_inplace(int len1YD, int len2YD, int ldYD, std::complex<double> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<double> *zd, int transpose)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, float *yd, int len1ZD, int len2ZD, int ldZD, float *zd, int mode)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex<float> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<float> *zd, int mode)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, double *yd, int len1ZD, int len2ZD, int ldZD, double *zd, int mode)=0;
+   virtual void prevec_inplace(int len1YD, int len2YD, int ldYD, std::complex<double> *yd, int len1ZD, int len2ZD, int ldZD, std::complex<double> *zd, int mode)=0;
+   int inplace_set;
    virtual void globalSum(int lenYD, float *yd, int lenXD, float *xd)=0;
    virtual void globalSum(int lenYD, double *yd, int lenXD, double *xd)=0;
    int globalSum_set;
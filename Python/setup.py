@@ -1,7 +1,7 @@
 #! /usr/bin/env python
 
 from codecs import open
-from os import path
+from os import path, environ
 import sys
 
 def get_numpy_options():
@@ -49,6 +49,20 @@ def get_numpy_options():
                    extra_link_args = blaslapack_extra_link_args
    )
 
+   # Parallelize the native sparse operators if PRIMME_WITH_OPENMP is set
+   if environ.get('PRIMME_WITH_OPENMP'):
+      r['extra_compile_args'] = ['-fopenmp']
+      r['extra_link_args'] = r['extra_link_args'] + ['-fopenmp']
+
+   # Reduce with MPI in C for the communicators given to eigsh/svds if
+   # PRIMME_WITH_MPI is set; then build with the MPI compiler wrapper,
+   # given by MPICXX or mpicxx by default
+   if environ.get('PRIMME_WITH_MPI'):
+      r['define_macros'] = [('PRIMME_WITH_MPI', None)]
+      mpicxx = environ.get('MPICXX', 'mpicxx')
+      environ.setdefault('CC', mpicxx)
+      environ.setdefault('LDSHARED', mpicxx + ' -shared')
+
    # Link dynamically on Windows and statically otherwise
    if sys.platform == 'win32':
       r['libraries'] = ['primme'] + r['libraries']
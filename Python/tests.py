@@ -6,11 +6,12 @@ see https://github.com/scipy/scipy
 """
 
 import warnings
+from unittest import SkipTest
 import numpy as np
 from numpy.testing import run_module_suite, assert_allclose
 from scipy import ones, r_, diag
 from scipy.sparse.linalg import aslinearoperator
-from scipy.sparse import csr_matrix
+from scipy.sparse import csr_matrix, csc_matrix, diags
 import Primme
 from Primme import eigsh, svds
 
@@ -267,6 +268,58 @@ def test_primme_svds_matrix_types():
                       ("Lauchli_like_vert", n, dtype, k, bool(prec), which))
          yield (svds_check, svds, op(A), k, prec, which, 1e-5, sva, case_desc)
 
+def native_check(solver, A, k, kargs, case_desc):
+   """
+   Check that A (and OPinv) applied natively by PRIMME give the same
+   solution as when they are applied through the Python callbacks.
+   """
+
+   native = solver(A, k, **kargs)
+   if 'OPinv' in kargs:
+      kargs = dict(kargs, OPinv=aslinearoperator(kargs['OPinv']))
+   callback = solver(aslinearoperator(A), k, **kargs)
+   vals, vals0 = (native[0], callback[0]) if solver is eigsh else (native[1], callback[1])
+   assert_allclose(sorted(vals), sorted(vals0), rtol=1e-6, err_msg=case_desc)
+
+def test_primme_native_operators():
+   """
+   Generate test cases comparing the native CSR/CSC matrices and diagonal
+   preconditioners with the callbacks.
+   """
+
+   n = 100
+   for dtype in (np.float64, np.complex128):
+      A = toStandardProblem(MikotaPair(n, dtype=dtype))
+      evals = np.linalg.eigvalsh(A)
+      sigma = evals[0]*.51 + evals[-1]*.49
+      prec = diags(np.reciprocal(np.diag(A) - sigma))
+      B = Lauchli_like(n*2, n, dtype=dtype)
+      for op in (csr_matrix, csc_matrix):
+         case_desc = "A=%s(%d, %s)" % (op.__name__, n, dtype)
+         yield (native_check, eigsh, op(A), 5, {'which': 'LA', 'tol': 1e-8},
+                case_desc)
+         yield (native_check, eigsh, op(A), 5, {'sigma': sigma, 'which': 'SM',
+                'tol': 1e-8, 'OPinv': prec}, case_desc + ", M=diag")
+         yield (native_check, svds, op(B), 5, {'tol': 1e-8},
+                case_desc + ", svds")
+
+def test_native_operators_too_large():
+   """
+   Test that a matrix with more nonzeros than fit in a C int is left to the
+   callbacks.
+   """
+
+   class LargeCSR(csr_matrix):
+      nnz = np.iinfo(np.intc).max + 1
+
+   class Params(object):
+      def _set_native_matrix(self, *args):
+         raise AssertionError("native matrix set with %d nonzeros" % LargeCSR.nnz)
+
+   A = csr_matrix(np.eye(3))
+   A.__class__ = LargeCSR
+   Primme._set_native_operators(Params(), np.dtype('d'), A)
+
 def test_examples_from_doc():
    import doctest
    doctest.testmod(Primme, raise_on_error=True)
@@ -284,6 +337,42 @@ def test_return_stats():
             which='SM', return_stats=True, return_history=True)
     assert(stats["hist"]["numMatvecs"])
 
+def test_comm():
+    """
+    Test eigsh and svds with a communicator of a single process.
+    """
+
+    try:
+        from mpi4py import MPI
+    except ImportError:
+        raise SkipTest("mpi4py is not available")
+    comm = MPI.COMM_SELF
+
+    A, _ = diagonal(100)
+    evals, evecs = eigsh(A, 3, tol=1e-6, which='LA', comm=comm)
+    assert_allclose(evals, [100, 99, 98], rtol=1e-6)
+
+    svecs_left, svals, svecs_right = svds(A, 3, tol=1e-6, comm=comm)
+    assert_allclose(svals, [100, 99, 98], rtol=1e-6)
+
+def test_out():
+    A, _ = diagonal(100)
+
+    # Eigenvectors in a column slice of a larger array, with v0 already in place
+    buf = np.zeros((100, 8), order='F')
+    out = buf[:, 2:5]
+    out[:, 0] = 1.
+    evals, evecs = Primme.eigsh(A, 3, tol=1e-6, which='LA', v0=out[:, 0:1], out=out)
+    assert(np.shares_memory(evecs, buf))
+    assert_allclose(evals, [100, 99, 98], rtol=1e-6)
+    assert_allclose(np.abs(buf[:, 2:5]), np.abs(evecs))
+
+    out = np.zeros(200*3)
+    svecs_left, svals, svecs_right = Primme.svds(A, 3, tol=1e-6, out=out)
+    assert(np.shares_memory(svecs_left, out))
+    assert(np.shares_memory(svecs_right, out))
+    assert_allclose(svals, [100, 99, 98], rtol=1e-6)
+
 
 if __name__ == "__main__":
     run_module_suite()
@@ -186,3 +186,16 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// filebacked_matvec_rcpp
+SEXP filebacked_matvec_rcpp(SEXP desc, SEXP x, bool trans);
+RcppExport SEXP _PRIMME_filebacked_matvec_rcpp(SEXP descSEXP, SEXP xSEXP, SEXP transSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type desc(descSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< bool >::type trans(transSEXP);
+    rcpp_result_gen = Rcpp::wrap(filebacked_matvec_rcpp(desc, x, trans));
+    return rcpp_result_gen;
+END_RCPP
+}
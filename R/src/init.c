@@ -12,6 +12,7 @@
 /* .Call calls */
 extern SEXP _PRIMME_dprimme_rcpp(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP _PRIMME_dprimme_svds_rcpp(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP _PRIMME_filebacked_matvec_rcpp(SEXP, SEXP, SEXP);
 extern SEXP _PRIMME_primme_free_rcpp(SEXP);
 extern SEXP _PRIMME_primme_get_member_rcpp(SEXP, SEXP);
 extern SEXP _PRIMME_primme_initialize_rcpp();
@@ -28,6 +29,7 @@ extern SEXP _PRIMME_zprimme_svds_rcpp(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 static const R_CallMethodDef CallEntries[] = {
     {"_PRIMME_dprimme_rcpp",                (DL_FUNC) &_PRIMME_dprimme_rcpp,                7},
     {"_PRIMME_dprimme_svds_rcpp",           (DL_FUNC) &_PRIMME_dprimme_svds_rcpp,           7},
+    {"_PRIMME_filebacked_matvec_rcpp",      (DL_FUNC) &_PRIMME_filebacked_matvec_rcpp,      3},
     {"_PRIMME_primme_free_rcpp",            (DL_FUNC) &_PRIMME_primme_free_rcpp,            1},
     {"_PRIMME_primme_get_member_rcpp",      (DL_FUNC) &_PRIMME_primme_get_member_rcpp,      2},
     {"_PRIMME_primme_initialize_rcpp",      (DL_FUNC) &_PRIMME_primme_initialize_rcpp,      0},
@@ -38,9 +38,14 @@
 #include <R.h>
 #include <Rcpp.h>
 #include <algorithm>
+#include <ctime>
 #include "primme.h"
 #include "PRIMME_types.h"
 #include <R_ext/BLAS.h> // for BLAS and F77_NAME
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "Matrix.h"
 #include "Matrix_stubs.c"
@@ -223,15 +228,252 @@ void copyMatrix_SEXP(SEXP mat, T *x, PRIMME_INT m, int n, PRIMME_INT ld,
    }
 }
 
-// Check ctrl+c every second
+// Check ctrl+c at most once every second of wall-clock time; calling
+// R_CheckUserInterrupt on every matvec is expensive. NOTE: stats.elapsedTime
+// is only updated at some points of the iteration, so it isn't used here.
 
 template <typename T>
 inline void checkUserInterrupt(const T* primme) {
-   static double lastTimeCheckUserInterrupt = 0.0;
-   if (primme->stats.elapsedTime <= lastTimeCheckUserInterrupt ||
-       primme->stats.elapsedTime > lastTimeCheckUserInterrupt+1) {
+   (void)primme;
+   static time_t lastTimeCheckUserInterrupt = 0;
+   time_t now = time(NULL);
+   if (now != lastTimeCheckUserInterrupt) {
       R_CheckUserInterrupt();
-      lastTimeCheckUserInterrupt = primme->stats.elapsedTime;
+      lastTimeCheckUserInterrupt = now;
+   }
+}
+
+// Return whether the sparse matrix can be applied by spmm_CHM_SP: all
+// columns stored (not symmetric), packed, with int indices and double values
+
+static bool isSupported_CHM_SP(const_CHM_SP A) {
+   return A->stype == 0 && A->packed && A->itype == CHOLMOD_INT &&
+      A->dtype == CHOLMOD_DOUBLE &&
+      (A->xtype == CHOLMOD_REAL || A->xtype == CHOLMOD_COMPLEX);
+}
+
+static inline double conj_value(double a) { return a; }
+static inline std::complex<double> conj_value(const std::complex<double> &a) {
+   return std::conj(a);
+}
+
+// Compute Y = A*X or Y = A'*X for a sparse matrix A in CSC format, see
+// isSupported_CHM_SP, without calling CHOLMOD. For A'*X the columns of A are
+// rows of A', so the rows of Y are computed in parallel; for A*X every thread
+// computes different columns of Y.
+// Arguments:
+// - T: type of the values, double or std::complex<double>
+// - A: sparse matrix
+// - conjtrans: if true, compute A'*X
+// - n: number of columns of X and Y
+// - x, ldx, y, ldy: input and output matrices and their leading dimensions
+
+template <typename T>
+static void spmm_CHM_SP(const_CHM_SP A, bool conjtrans, int n, const T *x,
+      PRIMME_INT ldx, T *y, PRIMME_INT ldy) {
+
+   const int *p = (const int*)A->p, *ii = (const int*)A->i;
+   const T *a = (const T*)A->x;
+   int nrow = (int)A->nrow, ncol = (int)A->ncol;
+
+   if (conjtrans) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int j=0; j<ncol; j++) {
+         for (int k=0; k<n; k++) y[ldy*k+j] = T(0);
+         for (int q=p[j]; q<p[j+1]; q++) {
+            T aq = conj_value(a[q]);
+            for (int k=0; k<n; k++) y[ldy*k+j] += aq*x[ldx*k+ii[q]];
+         }
+      }
+   }
+   else {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int k=0; k<n; k++) {
+         const T *xk = &x[ldx*k];
+         T *yk = &y[ldy*k];
+         std::fill(yk, yk+nrow, T(0));
+         for (int j=0; j<ncol; j++) {
+            T xj = xk[j];
+            for (int q=p[j]; q<p[j+1]; q++) yk[ii[q]] += a[q]*xj;
+         }
+      }
+   }
+}
+
+// File-backed dense matrices, as bigmemory's file-backed big.matrix and ff's
+// ff_matrix keep them: a raw column-major array of double, float, int or short
+// values in a file. The file is mapped read-only and the products are computed
+// here, streaming the matrix from the page cache once per block matvec and
+// without calling R. See .filebacked in R/filebacked.R for the description of
+// the file that R passes.
+
+enum FileMatrixType {FM_DOUBLE, FM_FLOAT, FM_INT, FM_SHORT};
+
+struct FileMatrix {
+   void *map;           // mapping of the whole file
+   size_t mapSize;      // size of the mapping in bytes
+   const char *a;       // first element of the matrix in the mapping
+   FileMatrixType type; // type of the elements
+   PRIMME_INT nrow, ncol, ld;
+};
+
+static void closeFileMatrix(FileMatrix *A) {
+   if (!A) return;
+   if (A->map) munmap(A->map, A->mapSize);
+   delete A;
+}
+
+static FileMatrix *openFileMatrix(SEXP desc) {
+   List d(desc);
+   std::string file = as<std::string>(d["file"]);
+   std::string type = as<std::string>(d["type"]);
+   double nrow = as<double>(d["nrow"]), ncol = as<double>(d["ncol"]);
+   double ld = as<double>(d["ld"]), offset = as<double>(d["offset"]);
+
+   FileMatrixType t;
+   size_t esize;
+   if (type == "double") {
+      t = FM_DOUBLE; esize = sizeof(double);
+   } else if (type == "float" || type == "single") {
+      t = FM_FLOAT; esize = sizeof(float);
+   } else if (type == "integer") {
+      t = FM_INT; esize = sizeof(int);
+   } else if (type == "short") {
+      t = FM_SHORT; esize = sizeof(short);
+   } else {
+      stop("Unsupported type of file-backed matrix: " + type);
+   }
+   if (nrow < 0 || ncol < 0 || ld < nrow || offset < 0)
+      stop("Invalid dimensions of file-backed matrix");
+
+   int fd = open(file.c_str(), O_RDONLY);
+   if (fd < 0) stop("Could not open file-backed matrix '" + file + "'");
+   struct stat st;
+   if (fstat(fd, &st) != 0) {
+      close(fd);
+      stop("Could not stat file-backed matrix '" + file + "'");
+   }
+   double last = offset + (ncol > 0 ? ld*(ncol-1) + nrow : 0);
+   if ((double)st.st_size < last*esize) {
+      close(fd);
+      stop("File '" + file + "' is smaller than the matrix");
+   }
+
+   FileMatrix *A = new FileMatrix;
+   A->mapSize = (size_t)st.st_size;
+   A->map = A->mapSize > 0 ?
+      mmap(NULL, A->mapSize, PROT_READ, MAP_SHARED, fd, 0) : NULL;
+   close(fd);
+   if (A->map == MAP_FAILED) {
+      delete A;
+      stop("Could not map file-backed matrix '" + file + "'");
+   }
+   A->a = (const char*)A->map + (size_t)offset*esize;
+   A->type = t;
+   A->nrow = (PRIMME_INT)nrow;
+   A->ncol = (PRIMME_INT)ncol;
+   A->ld = (PRIMME_INT)ld;
+   return A;
+}
+
+// Compute Y = A*X or Y = A'*X for a dense matrix A with elements of type E.
+// The rows of A are processed in chunks that fit in cache together with the
+// corresponding rows of X or Y. For A'*X every thread computes different rows
+// of Y, reading its columns of A sequentially; for A*X every thread computes
+// different chunks of rows of Y.
+
+template <typename E, typename T>
+static void gemm_FileMatrix(const E *a, PRIMME_INT nrow, PRIMME_INT ncol,
+      PRIMME_INT lda, bool conjtrans, int n, const T *x, PRIMME_INT ldx, T *y,
+      PRIMME_INT ldy) {
+
+   const PRIMME_INT chunk = 2048;
+
+   if (conjtrans) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (PRIMME_INT j=0; j<ncol; j++) {
+         const E *aj = &a[lda*j];
+         for (int k=0; k<n; k++) y[ldy*k+j] = T(0);
+         for (PRIMME_INT i0=0; i0<nrow; i0+=chunk) {
+            PRIMME_INT i1 = std::min(i0+chunk, nrow);
+            for (int k=0; k<n; k++) {
+               // Several partial sums, so that the loop can be vectorized
+               const T *xk = &x[ldx*k];
+               T s0(0), s1(0), s2(0), s3(0);
+               PRIMME_INT i = i0;
+               for (; i+3<i1; i+=4) {
+                  s0 += (double)aj[i]*xk[i];
+                  s1 += (double)aj[i+1]*xk[i+1];
+                  s2 += (double)aj[i+2]*xk[i+2];
+                  s3 += (double)aj[i+3]*xk[i+3];
+               }
+               for (; i<i1; i++) s0 += (double)aj[i]*xk[i];
+               y[ldy*k+j] += (s0 + s1) + (s2 + s3);
+            }
+         }
+      }
+   }
+   else {
+      PRIMME_INT nchunks = (nrow + chunk - 1)/chunk;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (PRIMME_INT c=0; c<nchunks; c++) {
+         PRIMME_INT i0 = c*chunk, i1 = std::min(i0+chunk, nrow);
+         for (int k=0; k<n; k++) std::fill(&y[ldy*k+i0], &y[ldy*k+i1], T(0));
+         // Update Y with four columns of A at once to save loads and stores
+         PRIMME_INT j = 0;
+         for (; j+3<ncol; j+=4) {
+            const E *a0 = &a[lda*j], *a1 = a0+lda, *a2 = a1+lda, *a3 = a2+lda;
+            for (int k=0; k<n; k++) {
+               const T *xk = &x[ldx*k+j];
+               T x0 = xk[0], x1 = xk[1], x2 = xk[2], x3 = xk[3];
+               T *yk = &y[ldy*k];
+               for (PRIMME_INT i=i0; i<i1; i++) {
+                  yk[i] += (double)a0[i]*x0 + (double)a1[i]*x1
+                     + (double)a2[i]*x2 + (double)a3[i]*x3;
+               }
+            }
+         }
+         for (; j<ncol; j++) {
+            const E *aj = &a[lda*j];
+            for (int k=0; k<n; k++) {
+               T xjk = x[ldx*k+j];
+               T *yk = &y[ldy*k];
+               for (PRIMME_INT i=i0; i<i1; i++) yk[i] += (double)aj[i]*xjk;
+            }
+         }
+      }
+   }
+}
+
+template <typename T>
+static void gemm_FileMatrix(const FileMatrix *A, bool conjtrans, int n,
+      const T *x, PRIMME_INT ldx, T *y, PRIMME_INT ldy) {
+
+   switch(A->type) {
+   case FM_DOUBLE:
+      gemm_FileMatrix((const double*)A->a, A->nrow, A->ncol, A->ld, conjtrans,
+            n, x, ldx, y, ldy);
+      break;
+   case FM_FLOAT:
+      gemm_FileMatrix((const float*)A->a, A->nrow, A->ncol, A->ld, conjtrans,
+            n, x, ldx, y, ldy);
+      break;
+   case FM_INT:
+      gemm_FileMatrix((const int*)A->a, A->nrow, A->ncol, A->ld, conjtrans,
+            n, x, ldx, y, ldy);
+      break;
+   case FM_SHORT:
+      gemm_FileMatrix((const short*)A->a, A->nrow, A->ncol, A->ld, conjtrans,
+            n, x, ldx, y, ldy);
+      break;
    }
 }
 
@@ -307,6 +549,7 @@ SEXP primme_get_member_rcpp(std::string labelstr, PrimmeParams primme) {
       case PRIMME_matrix:
       case PRIMME_preconditioner:
       case PRIMME_convTestFun:
+      case PRIMME_convTestFunBlock:
       case PRIMME_ldevecs:
       case PRIMME_ldOPs:
       case PRIMME_massMatrixMatvec:
@@ -390,6 +633,7 @@ void primme_set_member_rcpp(std::string labelstr, SEXP value, PrimmeParams primm
       case PRIMME_matrix:
       case PRIMME_preconditioner:
       case PRIMME_convTestFun:
+      case PRIMME_convTestFunBlock:
       case PRIMME_ldevecs:
       case PRIMME_ldOPs:
       case PRIMME_massMatrixMatvec:
@@ -470,7 +714,7 @@ template <typename T, int S, typename TS, typename F>
 static void matrixMatvecEigs(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
       int *blockSize, struct primme_params *primme, int *ierr)
 {  
-   checkUserInterrupt();
+   checkUserInterrupt(primme);
 
    // Create input vector
    Matrix<S,NoProtectStorage> vx =
@@ -532,6 +776,14 @@ void matrixMatvecEigs_CHM_SP(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
    const_CHM_SP chm = (const_CHM_SP)((void**)primme->matrix)[0];
    ASSERT(chm->nrow == chm->ncol && (PRIMME_INT)chm->nrow == primme->nLocal);
 
+   // A is Hermitian, so A*X = A'*X, which is faster to compute in parallel
+
+   if (isSupported_CHM_SP(chm)) {
+      spmm_CHM_SP(chm, true, *blockSize, (const T*)x, *ldx, (T*)y, *ldy);
+      *ierr = 0;
+      return;
+   }
+
    cholmod_dense chx, chy;
    chx.nrow = primme->nLocal; 
    chx.ncol = *blockSize;
@@ -557,6 +809,21 @@ void matrixMatvecEigs_CHM_SP(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
    *ierr = 0;
 }
 
+template <typename T>
+void matrixMatvecEigs_File(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, struct primme_params *primme, int *ierr)
+{
+   checkUserInterrupt(primme);
+
+   const FileMatrix *A = (const FileMatrix*)primme->matrix;
+   ASSERT(A->nrow == A->ncol && A->nrow == primme->nLocal);
+
+   // A is symmetric, so A*X = A'*X, which reads A sequentially
+
+   gemm_FileMatrix(A, true, *blockSize, (const T*)x, *ldx, (T*)y, *ldy);
+   *ierr = 0;
+}
+
 
 // Auxiliary function for xprimme; PRIMME wrapper around convTestFun.
 // Create a Vector<S>
@@ -587,6 +854,48 @@ static void convTestFunEigs(double *eval, void *evec, double *rNorm, int *isconv
    *ierr = 0;
 }
 
+// Auxiliary function for xprimme; PRIMME wrapper around convTestFunBlock.
+// Pack the candidate pairs (the ones with isconv[i] == 0) into a vector of
+// values, a Matrix<S> of vectors and a vector of norms, call the function
+// handler returned by F(primme) once, and copy its returned logical vector
+// into isconv.
+// Arguments:
+// - T: type of PRIMME evecs
+// - S: R type
+// - TS: type of elements in Matrix<S>
+// - F: F::get(primme) return the function pointer
+// - evals, evecs, ldevecs, ...: arguments of convTestFunBlock
+
+template <typename T, int S, typename TS, typename F>
+static void convTestFunBlockEigs(void *evals, void *evecs, PRIMME_INT *ldevecs,
+      void *rNorms, int *isconv, int *blockSize, struct primme_params *primme,
+      int *ierr) {
+
+   std::vector<int> map;
+   for (int i=0; i<*blockSize; i++) if (!isconv[i]) map.push_back(i);
+   *ierr = 0;
+   if (map.size() == 0) return;
+   int n = (int)map.size();
+
+   // Pass objects to R types
+   NumericVector seval(n), srnorm(n);
+   Matrix<S> sevec(evecs?primme->nLocal:0, evecs?n:0);
+   for (int i=0; i<n; i++) {
+      seval[i] = ((double*)evals)[map[i]];
+      srnorm[i] = ((double*)rNorms)[map[i]];
+      if (evecs) {
+         TS *x = (TS*)evecs + (size_t)*ldevecs*map[i];
+         std::copy(x, x + primme->nLocal, (TS*)&sevec(0, i));
+      }
+   }
+
+   // Call the callback
+   Function *f = (Function*)F::get(primme);
+   LogicalVector r = as<LogicalVector>((*f)(seval, sevec, srnorm));
+   if (r.size() != n) stop("Invalid length of the vector returned by tol");
+   for (int i=0; i<n; i++) isconv[map[i]] = r[i] ? 1 : 0;
+}
+
 // Generic function for dprimme and zprimme
 // Arguments:
 // - T: type of PRIMME evecs
@@ -636,7 +945,11 @@ static List xprimme(Matrix<S> ortho, Matrix<S> init, SEXP A, SEXP B,
    NumericMatrix *An = NULL;
    ComplexMatrix *Ac = NULL;
    Function *Af = NULL;
-   if (is<NumericMatrix>(A)) {
+   FileMatrix *Afile = NULL;
+   if (Rf_inherits(A, "primme_filebacked")) {
+      primme->matrix = Afile = openFileMatrix(A);
+      primme->matrixMatvec = matrixMatvecEigs_File<T>;
+   } else if (is<NumericMatrix>(A)) {
       primme->matrix = REAL(A);
       primme->matrixMatvec = matrixMatvecEigs_Matrix<TS>;
    } else if (is<ComplexMatrix>(A)) {
@@ -675,6 +988,10 @@ static List xprimme(Matrix<S> ortho, Matrix<S> init, SEXP A, SEXP B,
       fconvTest = new Function(as<Function>(convTest));
       primme->convtest = fconvTest;
       primme->convTestFun = convTestFunEigs<T, S, TS, getConvTestField>;
+      if (Rf_asLogical(Rf_getAttrib(convTest, Rf_install("block"))) == TRUE) {
+         primme->convTestFunBlock =
+            convTestFunBlockEigs<T, S, TS, getConvTestField>;
+      }
    }
 
    // Call xprimme
@@ -684,6 +1001,7 @@ static List xprimme(Matrix<S> ortho, Matrix<S> init, SEXP A, SEXP B,
    if (Ac) delete Ac;
    if (An) delete An;
    if (Af) delete Af;
+   closeFileMatrix(Afile);
    if (Matrix_isclass_Csparse(A)) {
       M_cholmod_finish(&chol_c);
    }
@@ -1069,6 +1387,13 @@ static void matrixMatvecSvds_CHM_SP(void *x, PRIMME_INT *ldx, void *y, PRIMME_IN
    const_CHM_SP chm = (const_CHM_SP)((void**)primme_svds->matrix)[0];
    ASSERT((PRIMME_INT)chm->nrow == primme_svds->mLocal && (PRIMME_INT)chm->ncol == primme_svds->nLocal);
 
+   if (isSupported_CHM_SP(chm)) {
+      spmm_CHM_SP(chm, *transpose != 0, *blockSize, (const T*)x, *ldx, (T*)y,
+            *ldy);
+      *ierr = 0;
+      return;
+   }
+
    cholmod_dense chx, chy;
    chx.nrow = (*transpose ? primme_svds->mLocal : primme_svds->nLocal);
    chx.ncol = *blockSize;
@@ -1095,6 +1420,21 @@ static void matrixMatvecSvds_CHM_SP(void *x, PRIMME_INT *ldx, void *y, PRIMME_IN
    *ierr = 0;
 }
 
+template <typename T>
+static void matrixMatvecSvds_File(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, int *transpose, struct primme_svds_params *primme_svds,
+      int *ierr)
+{  
+   checkUserInterrupt(primme_svds);
+
+   const FileMatrix *A = (const FileMatrix*)primme_svds->matrix;
+   ASSERT(A->nrow == primme_svds->mLocal && A->ncol == primme_svds->nLocal);
+
+   gemm_FileMatrix(A, *transpose != 0, *blockSize, (const T*)x, *ldx, (T*)y,
+         *ldy);
+   *ierr = 0;
+}
+
 
 // Generic function for dprimme_svds and zprimme_svds
 // Arguments:
@@ -1155,7 +1495,11 @@ static List xprimme_svds(Matrix<S> orthol, Matrix<S> orthor, Matrix<S> initl,
    cholmod_common chol_c;
    Matrix<S> *Am = NULL;
    Function *Af = NULL;
-   if (is<Matrix<S> >(A)) {
+   FileMatrix *Afile = NULL;
+   if (Rf_inherits(A, "primme_filebacked")) {
+      primme_svds->matrix = Afile = openFileMatrix(A);
+      primme_svds->matrixMatvec = matrixMatvecSvds_File<T>;
+   } else if (is<Matrix<S> >(A)) {
       primme_svds->matrix = Am = new Matrix<S>(A);
       primme_svds->matrixMatvec = matrixMatvecSvds_Matrix<T, S, TS>;
    } else if (Matrix_isclass_ge_dense(A)) {
@@ -1187,6 +1531,7 @@ static List xprimme_svds(Matrix<S> orthol, Matrix<S> orthor, Matrix<S> initl,
    // Destroy auxiliary memory
    if (Am) delete Am;
    if (Af) delete Af;
+   closeFileMatrix(Afile);
    if (Matrix_isclass_Csparse(A)) {
       M_cholmod_finish(&chol_c);
    }
@@ -1214,3 +1559,31 @@ List dprimme_svds_rcpp(NumericMatrix orthol, NumericMatrix orthor, NumericMatrix
 List zprimme_svds_rcpp(ComplexMatrix orthol, ComplexMatrix orthor, ComplexMatrix initl, ComplexMatrix initr, SEXP A, SEXP prec, PrimmeSvdsParams primme_svds) {
    return xprimme_svds<PRIMME_COMPLEX_DOUBLE, CPLXSXP, Rcomplex>(orthol, orthor, initl, initr, A, prec, primme_svds);
 }
+
+// Return A*x or A'*x for a file-backed matrix A; used by svds to complete
+// u0/v0 and orthou/orthov
+// [[Rcpp::export(.filebacked_matvec)]]
+SEXP filebacked_matvec_rcpp(SEXP desc, SEXP x, bool trans) {
+   if (!is<NumericMatrix>(x) && !is<ComplexMatrix>(x))
+      stop("x should be a double or complex matrix");
+   FileMatrix *A = openFileMatrix(desc);
+   PRIMME_INT m = trans ? A->ncol : A->nrow, n = trans ? A->nrow : A->ncol;
+   if (Rf_nrows(x) != n) {
+      closeFileMatrix(A);
+      stop("x should have as many rows as columns has the matrix");
+   }
+   RObject r;
+   if (is<NumericMatrix>(x)) {
+      NumericMatrix vx(x), vy((int)m, vx.ncol());
+      gemm_FileMatrix(A, trans, vx.ncol(), vx.begin(), n, vy.begin(), m);
+      r = vy;
+   } else {
+      ComplexMatrix vx(x), vy((int)m, vx.ncol());
+      gemm_FileMatrix(A, trans, vx.ncol(),
+            (const PRIMME_COMPLEX_DOUBLE*)vx.begin(), n,
+            (PRIMME_COMPLEX_DOUBLE*)vy.begin(), m);
+      r = vy;
+   }
+   closeFileMatrix(A);
+   return r;
+}
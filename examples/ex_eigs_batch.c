@@ -0,0 +1,169 @@
+/*******************************************************************************
+ * Copyright (c) 2018, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *
+ *  Example to compute the k smallest eigenvalues of many shifted 1-D
+ *  Laplacian matrices with a single call to dprimme_batch. If PRIMME is
+ *  compiled with OpenMP, the problems are solved concurrently.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "primme.h"   /* header file is required to run primme */ 
+
+void ShiftedLaplacianMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+
+int main (int argc, char *argv[]) {
+
+   /* Solver arrays and parameters */
+   const int numProblems = 64;   /* Number of problems */
+   double **evals;   /* evals[p] has the computed eigenvalues of problem p */
+   double **rnorms;  /* rnorms[p] has the residual norms of problem p */
+   double **evecs;   /* evecs[p] has the computed eigenvectors of problem p */
+   double *shifts;   /* The matrix of problem p is the Laplacian plus shifts[p] */
+   primme_params *primme;
+                     /* PRIMME configuration structs, one for each problem */
+   int *rets;        /* Value returned by dprimme for each problem */
+
+   /* Other miscellaneous items */
+   int ret;
+   int i, p;
+   int fail = 0;
+
+   evals = (double**)malloc(numProblems*sizeof(double*));
+   rnorms = (double**)malloc(numProblems*sizeof(double*));
+   evecs = (double**)malloc(numProblems*sizeof(double*));
+   shifts = (double*)malloc(numProblems*sizeof(double));
+   primme = (primme_params*)malloc(numProblems*sizeof(primme_params));
+   rets = (int*)malloc(numProblems*sizeof(int));
+
+   for (p=0; p<numProblems; p++) {
+      /* Set default values in PRIMME configuration struct */
+      primme_initialize(&primme[p]);
+
+      /* Set problem matrix; the shift is read by the matvec from matrix */
+      shifts[p] = (double)p/numProblems;
+      primme[p].matrix = &shifts[p];
+      primme[p].matrixMatvec = ShiftedLaplacianMatrixMatvec;
+
+      /* Set problem parameters; the dimension may vary between problems */
+      primme[p].n = 200 + p;
+      primme[p].numEvals = 5;
+      primme[p].eps = 1e-9;
+      primme[p].target = primme_smallest;
+
+      /* Set method to solve the problem */
+      primme_set_method(PRIMME_DEFAULT_MIN_TIME, &primme[p]);
+
+      /* Allocate space for converged Ritz values and residual norms */
+      evals[p] = (double*)malloc(primme[p].numEvals*sizeof(double));
+      evecs[p] = (double*)malloc(primme[p].n*primme[p].numEvals*sizeof(double));
+      rnorms[p] = (double*)malloc(primme[p].numEvals*sizeof(double));
+   }
+
+   /* Call primme for all problems; each thread reuses its workspace for */
+   /* the problems it solves                                            */
+   ret = dprimme_batch(evals, evecs, rnorms, primme, numProblems, rets);
+
+   if (ret != 0) {
+      fprintf(primme[0].outputFile, 
+         "Error: primme returned with nonzero exit status: %d \n",ret);
+      return -1;
+   }
+
+   /* Compare with the exact eigenvalues, 2 + shift - 2*cos(pi*k/(n+1)) */
+   for (p=0; p<numProblems; p++) {
+      for (i=0; i < primme[p].initSize; i++) {
+         double exact = 2.0 + shifts[p]
+                        - 2.0*cos(M_PI*(i+1)/(primme[p].n+1));
+         if (fabs(evals[p][i] - exact) > 1e-6) {
+            fprintf(primme[p].outputFile, "Problem %d Eval[%d]: %-22.15E "
+                  "but exact is %-22.15E\n", p, i+1, evals[p][i], exact);
+            fail = 1;
+         }
+      }
+      if (primme[p].initSize < primme[p].numEvals) fail = 1;
+   }
+   fprintf(primme[0].outputFile, " %d problems solved\n", numProblems);
+   fprintf(primme[0].outputFile, "Problem 0 Eval[1]: %-22.15E\n",
+         evals[0][0]);
+   fprintf(primme[0].outputFile, "Problem 0 Matvecs : %-" PRIMME_INT_P "\n",
+         primme[0].stats.numMatvecs);
+
+   for (p=0; p<numProblems; p++) {
+      primme_free(&primme[p]);
+      free(evals[p]);
+      free(evecs[p]);
+      free(rnorms[p]);
+   }
+   free(evals);
+   free(evecs);
+   free(rnorms);
+   free(shifts);
+   free(primme);
+   free(rets);
+
+  return(fail);
+}
+
+/* Shifted 1-D Laplacian block matrix-vector product, Y = A * X, where
+
+   - X, input dense matrix of size primme.n x blockSize;
+   - Y, output dense matrix of size primme.n x blockSize;
+   - A, tridiagonal square matrix of dimension primme.n with this form,
+     being s = *(double*)primme->matrix:
+
+        [ 2+s -1    0    0  ... ]
+        [-1    2+s -1    0  ... ]
+        [ 0   -1    2+s -1  ... ]
+         ...
+*/
+
+void ShiftedLaplacianMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *err) {
+   
+   int i;            /* vector index, from 0 to *blockSize-1*/
+   int row;          /* Laplacian matrix row index, from 0 to matrix dimension */
+   double *xvec;     /* pointer to i-th input vector x */
+   double *yvec;     /* pointer to i-th output vector y */
+   double shift = *(double*)primme->matrix;
+   
+   for (i=0; i<*blockSize; i++) {
+      xvec = (double *)x + *ldx*i;
+      yvec = (double *)y + *ldy*i;
+      for (row=0; row<primme->n; row++) {
+         yvec[row] = 0.0;
+         if (row-1 >= 0) yvec[row] += -1.0*xvec[row-1];
+         yvec[row] += (2.0+shift)*xvec[row];
+         if (row+1 < primme->n) yvec[row] += -1.0*xvec[row+1];
+      }      
+   }
+   *err = 0;
+}
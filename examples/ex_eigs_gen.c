@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * Copyright (c) 2018, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *
+ *  Example to compute the k smallest eigenvalues of the generalized problem
+ *  A x = lambda B x, where A and B are the stiffness and the mass matrices
+ *  of the linear finite element discretization of the 1-D Laplacian.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "primme.h"   /* header file is required to run primme */ 
+
+void StiffnessMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+void MassMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+
+int main (int argc, char *argv[]) {
+
+   /* Solver arrays and parameters */
+   double *evals;    /* Array with the computed eigenvalues */
+   double *rnorms;   /* Array with the computed eigenpairs residual norms */
+   double *evecs;    /* Array with the computed eigenvectors;
+                        first vector starts in evecs[0],
+                        second vector starts in evecs[primme.n],
+                        third vector starts in evecs[primme.n*2]...  */
+   primme_params primme;
+                     /* PRIMME configuration struct */
+
+   /* Other miscellaneous items */
+   int ret;
+   int i;
+   int fail = 0;
+
+   /* Set default values in PRIMME configuration struct */
+   primme_initialize(&primme);
+
+   /* Set problem matrices */
+   primme.matrixMatvec = StiffnessMatrixMatvec;
+   primme.massMatrixMatvec = MassMatrixMatvec;
+                           /* Function that implements the matrix-vector products
+                              A*x and B*x for solving the problem A*x-l*B*x = 0 */
+   primme.massMatrixCache = 1;
+                           /* Keep B*V so B is applied once per basis vector;
+                              set it to 0 to save memory if B is cheap */
+  
+   /* Set problem parameters */
+   primme.n = 200; /* set problem dimension */
+   primme.numEvals = 6;   /* Number of wanted eigenpairs */
+   primme.eps = 1e-9;      /* ||r|| <= eps * ||matrix|| */
+   primme.target = primme_smallest;
+                           /* Wanted the smallest eigenvalues */
+
+   /* Set method to solve the problem; only the GD family of methods are */
+   /* supported for generalized problems                                 */
+   primme_set_method(PRIMME_DEFAULT_MIN_MATVECS, &primme);
+
+   /* Display PRIMME configuration struct (optional) */
+   primme_display_params(primme);
+
+   /* Allocate space for converged Ritz values and residual norms */
+   evals = (double*)malloc(primme.numEvals*sizeof(double));
+   evecs = (double*)malloc(primme.n*primme.numEvals*sizeof(double));
+   rnorms = (double*)malloc(primme.numEvals*sizeof(double));
+
+   /* Call primme; the returned eigenvectors are B-orthonormal */
+   ret = dprimme(evals, evecs, rnorms, &primme);
+
+   if (ret != 0) {
+      fprintf(primme.outputFile, 
+         "Error: primme returned with nonzero exit status: %d \n",ret);
+      return -1;
+   }
+
+   /* Reporting (optional) */
+   for (i=0; i < primme.initSize; i++) {
+      fprintf(primme.outputFile, "Eval[%d]: %-22.15E rnorm: %-22.15E\n", i+1,
+         evals[i], rnorms[i]); 
+   }
+   fprintf(primme.outputFile, " %d eigenpairs converged\n", primme.initSize);
+   fprintf(primme.outputFile, "Tolerance : %-22.15E\n", 
+                                                         primme.aNorm*primme.eps);
+   fprintf(primme.outputFile, "Iterations: %-" PRIMME_INT_P "\n", 
+                                                 primme.stats.numOuterIterations); 
+   fprintf(primme.outputFile, "Restarts  : %-" PRIMME_INT_P "\n", primme.stats.numRestarts);
+   fprintf(primme.outputFile, "Matvecs   : %-" PRIMME_INT_P "\n", primme.stats.numMatvecs);
+
+   /* Compare with the exact eigenvalues, 6*(1-cos(t))/(2+cos(t)) with */
+   /* t = pi*k/(n+1), as A and B share the eigenvectors                */
+   for (i=0; i < primme.initSize; i++) {
+      double t = M_PI*(i+1)/(primme.n+1);
+      double exact = 6.0*(1.0 - cos(t))/(2.0 + cos(t));
+      if (fabs(evals[i] - exact) > 1e-6) {
+         fprintf(primme.outputFile, "Eval[%d]: %-22.15E but exact is "
+               "%-22.15E\n", i+1, evals[i], exact);
+         fail = 1;
+      }
+   }
+   if (primme.initSize < primme.numEvals) fail = 1;
+
+   primme_free(&primme);
+   free(evals);
+   free(evecs);
+   free(rnorms);
+
+  return(fail);
+}
+
+/* Stiffness block matrix-vector product, Y = A * X, where
+
+   - X, input dense matrix of size primme.n x blockSize;
+   - Y, output dense matrix of size primme.n x blockSize;
+   - A, tridiagonal square matrix of dimension primme.n with this form:
+
+        [ 2 -1  0  0  0 ... ]
+        [-1  2 -1  0  0 ... ]
+        [ 0 -1  2 -1  0 ... ]
+         ...
+*/
+
+void StiffnessMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *err) {
+   
+   int i;            /* vector index, from 0 to *blockSize-1*/
+   int row;          /* matrix row index, from 0 to matrix dimension */
+   double *xvec;     /* pointer to i-th input vector x */
+   double *yvec;     /* pointer to i-th output vector y */
+   
+   for (i=0; i<*blockSize; i++) {
+      xvec = (double *)x + *ldx*i;
+      yvec = (double *)y + *ldy*i;
+      for (row=0; row<primme->n; row++) {
+         yvec[row] = 0.0;
+         if (row-1 >= 0) yvec[row] += -1.0*xvec[row-1];
+         yvec[row] += 2.0*xvec[row];
+         if (row+1 < primme->n) yvec[row] += -1.0*xvec[row+1];
+      }      
+   }
+   *err = 0;
+}
+
+/* Mass block matrix-vector product, Y = B * X, where
+
+   - X, input dense matrix of size primme.n x blockSize;
+   - Y, output dense matrix of size primme.n x blockSize;
+   - B, tridiagonal square matrix of dimension primme.n with this form:
+
+        [ 2/3 1/6  0   0  ... ]
+        [ 1/6 2/3 1/6  0  ... ]
+        [  0  1/6 2/3 1/6 ... ]
+         ...
+*/
+
+void MassMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *err) {
+   
+   int i;            /* vector index, from 0 to *blockSize-1*/
+   int row;          /* matrix row index, from 0 to matrix dimension */
+   double *xvec;     /* pointer to i-th input vector x */
+   double *yvec;     /* pointer to i-th output vector y */
+   
+   for (i=0; i<*blockSize; i++) {
+      xvec = (double *)x + *ldx*i;
+      yvec = (double *)y + *ldy*i;
+      for (row=0; row<primme->n; row++) {
+         yvec[row] = 0.0;
+         if (row-1 >= 0) yvec[row] += xvec[row-1]/6.0;
+         yvec[row] += 2.0*xvec[row]/3.0;
+         if (row+1 < primme->n) yvec[row] += xvec[row+1]/6.0;
+      }      
+   }
+   *err = 0;
+}
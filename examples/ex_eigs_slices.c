@@ -0,0 +1,509 @@
+/*******************************************************************************
+ * Copyright (c) 2017, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ *
+ *  Example to compute all eigenvalues in an interval of a 1-D Laplacian matrix
+ *  by spectrum slicing.
+ *
+ *  The processes are split into groups of the same size. The interval is
+ *  partitioned into more slices than groups, and every group runs independent
+ *  dprimme instances with target primme_closest_abs on the center of the next
+ *  free slice. The slices are handed out dynamically, so a group that is stuck
+ *  on an expensive slice does not delay the rest. Each slice keeps the
+ *  eigenvalues in its subinterval enlarged by a small tolerance, and a final
+ *  orthogonalization of the eigenvectors with eigenvalues close to a slice
+ *  boundary removes the eigenpairs found by two neighboring slices.
+ *
+ *  Run as, for instance,
+ *
+ *     mpirun -np 4 ./ex_eigs_slices
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <mpi.h>
+#include "primme.h"   /* header file is required to run primme */
+
+#define N            500     /* Matrix dimension */
+#define PROCS_GROUP  2       /* Number of processes in every group */
+#define NUM_SLICES   8       /* Number of slices */
+#define LOWER        0.5     /* Interval of wanted eigenvalues [LOWER, UPPER] */
+#define UPPER        1.5
+#define OVERLAP      0.02    /* Extra interval searched around every slice */
+#define EVALS_GUESS  8       /* Initial number of eigenvalues per slice */
+#define BOUNDARY_TOL 1e-6    /* Eigenvalues closer than this are considered
+                                the same in the final orthogonalization */
+
+typedef struct {
+   MPI_Comm comm;       /* communicator of the group */
+   PRIMME_INT nLocal;   /* number of local rows */
+} group_info;
+
+void LaplacianMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+static void par_GlobalSum(void *sendBuf, void *recvBuf, int *count,
+                         primme_params *primme, int *ierr);
+static int solve_slice(double a, double b, group_info *group, int *numEvals,
+      double **evals, double **evecs, PRIMME_INT *numMatvecs);
+static int next_slice(MPI_Win counterWin, MPI_Comm groupComm);
+static int orthogonalize_boundaries(double *evals, double *evecs, int *numEvals,
+      double *boundaries, int numBoundaries, group_info *group,
+      MPI_Comm crossComm);
+
+int main (int argc, char *argv[]) {
+
+   /* Solver arrays */
+   double *evals = NULL;   /* Eigenvalues kept from all slices solved by the
+                              group */
+   double *evecs = NULL;   /* Local rows of the corresponding eigenvectors */
+   int numEvals = 0;       /* Number of eigenpairs kept by the group */
+
+   /* Other miscellaneous items */
+   int i, j, worldRank, worldSize, numGroups, groupId, groupRank, slice, ret;
+   int *counter, numSlicesSolved = 0, numFound, numExpected;
+   double boundaries[NUM_SLICES+1], *allEvals = NULL;
+   PRIMME_INT numMatvecs = 0;
+   group_info group;
+   MPI_Comm crossComm;
+   MPI_Win counterWin;
+
+   MPI_Init(&argc, &argv);
+   MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+   MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+
+   if (worldSize % PROCS_GROUP != 0) {
+      if (worldRank == 0)
+         fprintf(stderr, "Error: the number of processes should be a multiple of %d\n",
+               PROCS_GROUP);
+      MPI_Finalize();
+      return -1;
+   }
+
+   /* Split the processes into groups; processes with the same rank in        */
+   /* different groups hold the same rows of the vectors, and they are joined */
+   /* in crossComm to exchange eigenvectors between groups                    */
+
+   numGroups = worldSize / PROCS_GROUP;
+   groupId = worldRank / PROCS_GROUP;
+   MPI_Comm_split(MPI_COMM_WORLD, groupId, worldRank, &group.comm);
+   MPI_Comm_rank(group.comm, &groupRank);
+   MPI_Comm_split(MPI_COMM_WORLD, groupRank, worldRank, &crossComm);
+   group.nLocal = N/PROCS_GROUP + (groupRank < N%PROCS_GROUP ? 1 : 0);
+
+   /* Slice boundaries */
+
+   for (i=0; i <= NUM_SLICES; i++) {
+      boundaries[i] = LOWER + (UPPER - LOWER)*i/NUM_SLICES;
+   }
+
+   /* Shared counter with the next slice to solve */
+
+   MPI_Win_allocate(worldRank == 0 ? sizeof(int) : 0, sizeof(int),
+         MPI_INFO_NULL, MPI_COMM_WORLD, &counter, &counterWin);
+   if (worldRank == 0) *counter = 0;
+   MPI_Barrier(MPI_COMM_WORLD);
+
+   /* Solve slices until there is none left */
+
+   while ((slice = next_slice(counterWin, group.comm)) < NUM_SLICES) {
+      PRIMME_INT sliceMatvecs;
+      double *sevals, *sevecs;
+      int sliceEvals;
+
+      ret = solve_slice(boundaries[slice], boundaries[slice+1], &group,
+            &sliceEvals, &sevals, &sevecs, &sliceMatvecs);
+      if (ret != 0) {
+         fprintf(stderr, "Error: primme returned with nonzero exit status: %d \n",
+               ret);
+         MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+      /* Keep the eigenvalues in the slice enlarged by BOUNDARY_TOL at the */
+      /* boundaries shared with other slices                               */
+
+      evals = (double*)realloc(evals, (numEvals+sliceEvals)*sizeof(double));
+      evecs = (double*)realloc(evecs,
+            (numEvals+sliceEvals)*group.nLocal*sizeof(double));
+      for (i=0; i < sliceEvals; i++) {
+         if (sevals[i] < boundaries[slice] - (slice > 0 ? BOUNDARY_TOL : 0.0)
+               || sevals[i] > boundaries[slice+1]
+                     + (slice < NUM_SLICES-1 ? BOUNDARY_TOL : 0.0)) continue;
+         evals[numEvals] = sevals[i];
+         memcpy(&evecs[group.nLocal*numEvals], &sevecs[group.nLocal*i],
+               group.nLocal*sizeof(double));
+         numEvals++;
+      }
+      free(sevals);
+      free(sevecs);
+      numMatvecs += sliceMatvecs;
+      numSlicesSolved++;
+   }
+
+   /* Remove the eigenpairs computed by two neighboring slices */
+
+   ret = orthogonalize_boundaries(evals, evecs, &numEvals, &boundaries[1],
+         NUM_SLICES-1, &group, crossComm);
+   if (ret != 0) {
+      fprintf(stderr, "Error: the boundary orthogonalization failed: %d \n", ret);
+      MPI_Abort(MPI_COMM_WORLD, -1);
+   }
+
+   /* Reporting */
+
+   if (groupRank == 0) {
+      printf("Group %d solved %d slices with %" PRIMME_INT_P " matvecs\n",
+            groupId, numSlicesSolved, numMatvecs);
+      fflush(stdout);
+   }
+   MPI_Reduce(&numEvals, &numFound, 1, MPI_INT, MPI_SUM, 0, crossComm);
+   if (groupRank == 0) {
+      int *counts = NULL, *displs = NULL;
+      if (worldRank == 0) {
+         counts = (int*)malloc(numGroups*sizeof(int));
+         displs = (int*)malloc(numGroups*sizeof(int));
+         allEvals = (double*)malloc(numFound*sizeof(double));
+      }
+      MPI_Gather(&numEvals, 1, MPI_INT, counts, 1, MPI_INT, 0, crossComm);
+      if (worldRank == 0) {
+         for (i=0, j=0; i < numGroups; j+=counts[i++]) displs[i] = j;
+      }
+      MPI_Gatherv(evals, numEvals, MPI_DOUBLE, allEvals, counts, displs,
+            MPI_DOUBLE, 0, crossComm);
+      free(counts);
+      free(displs);
+   }
+
+   ret = 0;
+   if (worldRank == 0) {
+      /* The eigenvalues of the 1-D Laplacian are 2 - 2*cos(k*pi/(N+1)) */
+      for (i=1, numExpected=0; i <= N; i++) {
+         double ev = 2.0 - 2.0*cos(M_PI*i/(N+1));
+         if (ev >= LOWER && ev <= UPPER) numExpected++;
+      }
+      for (i=0; i < numFound; i++) {
+         for (j=i; j > 0 && allEvals[j-1] > allEvals[j]; j--) {
+            double aux = allEvals[j]; allEvals[j] = allEvals[j-1];
+            allEvals[j-1] = aux;
+         }
+      }
+      for (i=0; i < numFound; i++) {
+         printf("Eval[%d]: %-22.15E\n", i+1, allEvals[i]);
+      }
+      printf(" %d eigenvalues found in [%g, %g]; expected %d\n", numFound,
+            LOWER, UPPER, numExpected);
+      if (numFound != numExpected) ret = -1;
+      free(allEvals);
+   }
+   MPI_Bcast(&ret, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+   free(evals);
+   free(evecs);
+   MPI_Win_free(&counterWin);
+   MPI_Comm_free(&crossComm);
+   MPI_Comm_free(&group.comm);
+   MPI_Finalize();
+
+   return ret;
+}
+
+/* Return the index of the next slice to solve by the group. The root of the
+   group increments the counter on process 0 and broadcasts the old value.  */
+
+static int next_slice(MPI_Win counterWin, MPI_Comm groupComm) {
+   int slice, one = 1, groupRank;
+
+   MPI_Comm_rank(groupComm, &groupRank);
+   if (groupRank == 0) {
+      MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, counterWin);
+      MPI_Fetch_and_op(&one, &slice, MPI_INT, 0, 0, MPI_SUM, counterWin);
+      MPI_Win_unlock(0, counterWin);
+   }
+   MPI_Bcast(&slice, 1, MPI_INT, 0, groupComm);
+   return slice;
+}
+
+/* Compute all eigenpairs in [a, b] with the processes in the group.
+
+   The eigenvalues closest to the center of the slice are computed until the
+   farthest one is out of [a-OVERLAP, b+OVERLAP]. If that does not happen,
+   the number of wanted eigenvalues is doubled and dprimme is called again
+   with the eigenvectors already found as initial guesses.
+
+   OUTPUT
+   ------
+   numEvals     number of returned eigenpairs
+   evals        allocated array with the eigenvalues
+   evecs        allocated array with the local rows of the eigenvectors
+   numMatvecs   matrix-vector products spent in the slice
+*/
+
+static int solve_slice(double a, double b, group_info *group, int *numEvals,
+      double **evals, double **evecs, PRIMME_INT *numMatvecs) {
+
+   primme_params primme;
+   double *rnorms = NULL, center = (a + b)/2.0, farthest;
+   int i, ret, wanted = EVALS_GUESS;
+
+   *evals = *evecs = NULL;
+   *numEvals = 0;
+   *numMatvecs = 0;
+
+   do {
+      if (wanted > N) wanted = N;
+      *evals = (double*)realloc(*evals, wanted*sizeof(double));
+      *evecs = (double*)realloc(*evecs, wanted*group->nLocal*sizeof(double));
+      rnorms = (double*)realloc(rnorms, wanted*sizeof(double));
+
+      /* Set default values in PRIMME configuration struct; the workspace
+         depends on numEvals, so it is not reused between calls */
+      primme_initialize(&primme);
+
+      /* Set problem matrix */
+      primme.matrixMatvec = LaplacianMatrixMatvec;
+      primme.n = N;
+      primme.numEvals = wanted;
+      primme.eps = 1e-9;
+      primme.targetShifts = &center;
+      primme.numTargetShifts = 1;
+      primme.target = primme_closest_abs;
+      primme.locking = 1;
+
+      /* The vectors returned by the previous call are initial guesses */
+      primme.initSize = *numEvals;
+
+      /* Set parallel parameters */
+      primme.nLocal = group->nLocal;
+      primme.commInfo = group;
+      MPI_Comm_size(group->comm, &primme.numProcs);
+      MPI_Comm_rank(group->comm, &primme.procID);
+      primme.globalSumReal = par_GlobalSum;
+
+      primme_set_method(PRIMME_DEFAULT_MIN_MATVECS, &primme);
+
+      /* Call primme  */
+      ret = dprimme(*evals, *evecs, rnorms, &primme);
+      *numMatvecs += primme.stats.numMatvecs;
+      *numEvals = primme.initSize;
+      primme_free(&primme);
+      if (ret != 0) break;
+
+      for (i=0, farthest=0.0; i < *numEvals; i++) {
+         if (fabs((*evals)[i] - center) > farthest)
+            farthest = fabs((*evals)[i] - center);
+      }
+      wanted *= 2;
+   } while (*numEvals == primme.numEvals && primme.numEvals < N
+         && farthest <= (b - a)/2.0 + OVERLAP);
+
+   free(rnorms);
+
+   return ret;
+}
+
+/* Orthogonalize the eigenvectors with eigenvalues close to the slice
+   boundaries. Those vectors from all groups are gathered in every group and
+   processed in the same order with modified Gram-Schmidt, one cluster of
+   close eigenvalues at a time. Vectors that vanish were already found by
+   another slice and they are removed.
+
+   INPUT/OUTPUT
+   ------------
+   evals, evecs, numEvals    eigenpairs kept by the group
+*/
+
+static int orthogonalize_boundaries(double *evals, double *evecs, int *numEvals,
+      double *boundaries, int numBoundaries, group_info *group,
+      MPI_Comm crossComm) {
+
+   int i, j, k, numGroups, crossRank, numBnd, totalBnd, first, *bndIdx;
+   int *counts, *displs, *countsv, *displsv, *keep;
+   double *bndEvals, *bndEvecs, *allEvals, *allEvecs;
+   PRIMME_INT nLocal = group->nLocal, l;
+
+   MPI_Comm_size(crossComm, &numGroups);
+   MPI_Comm_rank(crossComm, &crossRank);
+
+   /* Select the local eigenpairs close to a boundary */
+
+   bndIdx = (int*)malloc((*numEvals+1)*sizeof(int));
+   for (i=numBnd=0; i < *numEvals; i++) {
+      for (j=0; j < numBoundaries; j++) {
+         if (fabs(evals[i] - boundaries[j]) <= 2*BOUNDARY_TOL) {
+            bndIdx[numBnd++] = i;
+            break;
+         }
+      }
+   }
+   bndEvals = (double*)malloc((numBnd+1)*sizeof(double));
+   bndEvecs = (double*)malloc((numBnd*nLocal+1)*sizeof(double));
+   for (i=0; i < numBnd; i++) {
+      bndEvals[i] = evals[bndIdx[i]];
+      memcpy(&bndEvecs[nLocal*i], &evecs[nLocal*bndIdx[i]],
+            nLocal*sizeof(double));
+   }
+
+   /* Gather them from all groups */
+
+   counts = (int*)malloc(numGroups*4*sizeof(int));
+   displs = counts + numGroups;
+   countsv = displs + numGroups;
+   displsv = countsv + numGroups;
+   MPI_Allgather(&numBnd, 1, MPI_INT, counts, 1, MPI_INT, crossComm);
+   for (i=totalBnd=0; i < numGroups; totalBnd+=counts[i++]) {
+      displs[i] = totalBnd;
+      countsv[i] = counts[i]*nLocal;
+      displsv[i] = totalBnd*nLocal;
+   }
+   allEvals = (double*)malloc((totalBnd+1)*sizeof(double));
+   allEvecs = (double*)malloc((totalBnd*nLocal+1)*sizeof(double));
+   keep = (int*)malloc((totalBnd+1)*sizeof(int));
+   MPI_Allgatherv(bndEvals, numBnd, MPI_DOUBLE, allEvals, counts, displs,
+         MPI_DOUBLE, crossComm);
+   MPI_Allgatherv(bndEvecs, numBnd*nLocal, MPI_DOUBLE, allEvecs, countsv,
+         displsv, MPI_DOUBLE, crossComm);
+
+   /* Modified Gram-Schmidt over every cluster of close eigenvalues */
+
+   for (i=0; i < totalBnd; i++) {
+      double norm2;
+
+      keep[i] = 1;
+      first = 1;
+      for (j=0; j < i; j++) {
+         double ip;
+         if (!keep[j] || fabs(allEvals[i] - allEvals[j]) > BOUNDARY_TOL)
+            continue;
+         for (l=0, ip=0.0; l < nLocal; l++)
+            ip += allEvecs[nLocal*j+l]*allEvecs[nLocal*i+l];
+         MPI_Allreduce(MPI_IN_PLACE, &ip, 1, MPI_DOUBLE, MPI_SUM, group->comm);
+         for (l=0; l < nLocal; l++)
+            allEvecs[nLocal*i+l] -= ip*allEvecs[nLocal*j+l];
+         first = 0;
+      }
+      if (first) continue;
+      for (l=0, norm2=0.0; l < nLocal; l++)
+         norm2 += allEvecs[nLocal*i+l]*allEvecs[nLocal*i+l];
+      MPI_Allreduce(MPI_IN_PLACE, &norm2, 1, MPI_DOUBLE, MPI_SUM, group->comm);
+      if (norm2 < .25) {
+         keep[i] = 0;
+         continue;
+      }
+      for (l=0; l < nLocal; l++)
+         allEvecs[nLocal*i+l] /= sqrt(norm2);
+   }
+
+   /* Copy back the orthogonalized vectors of this group and remove the
+      duplicates */
+
+   for (i=0; i < numBnd; i++) {
+      k = displs[crossRank] + i;
+      if (keep[k]) {
+         memcpy(&evecs[nLocal*bndIdx[i]], &allEvecs[nLocal*k],
+               nLocal*sizeof(double));
+      }
+      else {
+         evals[bndIdx[i]] = HUGE_VAL;
+      }
+   }
+   for (i=j=0; i < *numEvals; i++) {
+      if (evals[i] == HUGE_VAL) continue;
+      if (i != j) {
+         evals[j] = evals[i];
+         memcpy(&evecs[nLocal*j], &evecs[nLocal*i], nLocal*sizeof(double));
+      }
+      j++;
+   }
+   *numEvals = j;
+
+   free(bndIdx);
+   free(bndEvals);
+   free(bndEvecs);
+   free(counts);
+   free(allEvals);
+   free(allEvecs);
+   free(keep);
+
+   return 0;
+}
+
+/* 1-D Laplacian block matrix-vector product, Y = A * X, where
+
+   - X, input dense matrix of size primme.n x blockSize;
+   - Y, output dense matrix of size primme.n x blockSize;
+   - A, tridiagonal square matrix of dimension primme.n with this form:
+
+        [ 2 -1  0  0  0 ... ]
+        [-1  2 -1  0  0 ... ]
+        [ 0 -1  2 -1  0 ... ]
+         ...
+
+   The rows are distributed in blocks among the processes in the group, and
+   the values at the block ends are exchanged with the neighbors.
+*/
+
+void LaplacianMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *err) {
+
+   int i, left, right;
+   PRIMME_INT row, nLocal = primme->nLocal;
+   double *xvec, *yvec, xleft, xright;
+   MPI_Comm comm = ((group_info *)primme->commInfo)->comm;
+
+   left = primme->procID > 0 ? primme->procID - 1 : MPI_PROC_NULL;
+   right = primme->procID < primme->numProcs - 1 ? primme->procID + 1
+                                                 : MPI_PROC_NULL;
+   for (i=0; i<*blockSize; i++) {
+      xvec = (double *)x + *ldx*i;
+      yvec = (double *)y + *ldy*i;
+      xleft = xright = 0.0;
+      MPI_Sendrecv(&xvec[nLocal-1], 1, MPI_DOUBLE, right, 0, &xleft, 1,
+            MPI_DOUBLE, left, 0, comm, MPI_STATUS_IGNORE);
+      MPI_Sendrecv(&xvec[0], 1, MPI_DOUBLE, left, 1, &xright, 1, MPI_DOUBLE,
+            right, 1, comm, MPI_STATUS_IGNORE);
+      for (row=0; row<nLocal; row++) {
+         yvec[row] = 2.0*xvec[row]
+            - (row > 0 ? xvec[row-1] : xleft)
+            - (row < nLocal-1 ? xvec[row+1] : xright);
+      }
+   }
+   *err = 0;
+}
+
+static void par_GlobalSum(void *sendBuf, void *recvBuf, int *count,
+                         primme_params *primme, int *ierr) {
+   MPI_Comm communicator = ((group_info *)primme->commInfo)->comm;
+
+   if (sendBuf == recvBuf) {
+     *ierr = MPI_Allreduce(MPI_IN_PLACE, recvBuf, *count, MPI_DOUBLE, MPI_SUM, communicator) != MPI_SUCCESS;
+   } else {
+     *ierr = MPI_Allreduce(sendBuf, recvBuf, *count, MPI_DOUBLE, MPI_SUM, communicator) != MPI_SUCCESS;
+   }
+}
@@ -44,6 +44,9 @@
 extern "C" {
 #endif
 
+/* Number of values in primme_params.dynamicModel */
+#define PRIMME_DYNAMIC_MODEL_SIZE 12
+
 typedef enum {
    primme_smallest,        /* leftmost eigenvalues */
    primme_largest,         /* rightmost eigenvalues */
@@ -68,6 +71,22 @@ typedef enum {         /* Initially fill up the search subspace with: */
    primme_init_user    /* c) provided vectors or a single random vector */
 } primme_init;
 
+/* orthogonalization schemes for the new vectors added to the basis */
+typedef enum {
+   primme_orth_default,
+   primme_orth_vector,    /* Gram-Schmidt vector by vector with reortho    */
+   primme_orth_block,     /* block classical Gram-Schmidt with CholQR, BCGS2 */
+   primme_orth_lowsync,   /* as vector, but norms are reduced with overlaps */
+   primme_orth_selective, /* against locked only, unless orthogonality is at risk */
+   primme_orth_adaptive   /* as vector, but skips the reorthos the measured loss allows */
+} primme_orth;
+
+/* 16-bit formats of the vectors passed to matrixMatvecHalf */
+typedef enum {
+   primme_half_fp16,      /* IEEE 754 half precision                        */
+   primme_half_bf16       /* bfloat16, the upper 16 bits of a float         */
+} primme_half;
+
 
 typedef enum {
    primme_thick,
@@ -111,6 +130,24 @@ typedef struct primme_stats {
    double estimateLargestSVal;      /* absolute value of the farthest to zero Ritz value seen */
    double maxConvTol;               /* largest norm residual of a locked eigenpair */
    double estimateResidualError;    /* accumulated error in V and W */
+   PRIMME_INT numGlobalSumMerged;   /* reductions merged into other calls to globalSumReal */
+   double timeSolveH;               /* time expend by solving the projected problem */
+   double timeRestart;              /* time expend by restarting the basis */
+   double timeUpdateVWXR;           /* time expend by updating V, W, X and R */
+   double timeConvCheck;            /* time expend by checking convergence */
+   double timeInnerSolve;           /* time expend by the inner solver */
+   double timeWorkspace;            /* time expend by allocating the workspace */
+   double orthoLossFactor;          /* observed loss of orthogonality after a Gram-Schmidt pass over machEps*s0/s1 */
+   double timeGlobalSumInterNode;   /* time expend by globalSumReal among nodes, if reported by it */
+   /* Summary across processes, set at the end if statsImbalance is set */
+   double timeMatvecMin, timeMatvecMax, timeMatvecAvg;
+   double timePrecondMin, timePrecondMax, timePrecondAvg;
+   double timeGlobalSumMin, timeGlobalSumMax, timeGlobalSumAvg;
+   double imbalanceFactor;          /* max/avg of the time out of globalSumReal */
+   double timeGlobalSumWaiting;     /* estimated time waiting on the slowest process */
+   PRIMME_INT slowestProc;          /* process with the most time out of globalSumReal */
+   double estimateRemainingMatvecs; /* expected matvecs to converge the remaining pairs */
+   double estimateRemainingTime;    /* expected wall time to converge the remaining pairs */
 } primme_stats;
 
 typedef struct JD_projectors {
@@ -201,6 +238,7 @@ typedef struct primme_params {
    void *preconditioner;
    double *ShiftsForPreconditioner;
    primme_init initBasisMode;
+   primme_orth orth;
    PRIMME_INT ldevecs;
    PRIMME_INT ldOPs;
 
@@ -218,6 +256,199 @@ typedef struct primme_params {
       int *inner_its, void *LSRes, primme_event *event,
       struct primme_params *primme, int *err);
    void *monitor;
+
+   /* Optional matrix times a multivector that also returns the local part */
+   /* of V'*y, being V(:,numCols-blockSize:numCols-1) = x and y = A*x       */
+   void (*matrixMatvecProject)
+      ( void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+        void *V, PRIMME_INT *ldV, int *numCols, void *VtY, int *ldVtY,
+        struct primme_params *primme, int *ierr);
+
+   /* Optional nonblocking version of globalSumReal: globalSumRealStart     */
+   /* starts the sum and returns a handle in request, which is passed to    */
+   /* globalSumRealWait to finish it                                        */
+   void (*globalSumRealStart)
+      ( void *sendBuf, void *recvBuf, int *count, struct primme_params *primme,
+        void **request, int *ierr);
+   void (*globalSumRealWait)
+      ( void *request, struct primme_params *primme, int *ierr);
+
+   /* Number of threads for the local kernels; 0 means OpenMP default */
+   int numThreads;
+
+   /* If nonzero, threads zero V, W, Q and evecs on the rows they update */
+   int firstTouch;
+
+   /* Number of blocks added to the basis per iteration (s-step GD+k) */
+   int sStepSize;
+
+   /* Smallest basis size solved with divide and conquer; <= 0 disables it */
+   int dcMinBasisSize;
+
+   /* If nonzero, update the Rayleigh-Ritz decomposition as the basis grows */
+   int incrementalRR;
+
+   /* If nonzero, reduce the inner products of a QMR step together, overlapped */
+   /* with the next preconditioner and matrix-vector product                   */
+   int pipelinedQMR;
+
+   /* Maximum degree of the Chebyshev filter applied to the Ritz vectors */
+   /* instead of solving the correction equations; 0 disables it         */
+   int chebyshevDegree;
+
+   /* If nonzero, tune the block size between 1 and maxBlockSize at every */
+   /* restart from the measured time per matrix-vector product            */
+   int dynamicBlockSize;
+
+   /* Optional array of PRIMME_DYNAMIC_MODEL_SIZE values with the timings of */
+   /* the dynamic method switching: if the first value is positive, it seeds */
+   /* the model; and the model is written back on exit                       */
+   double *dynamicModel;
+
+   /* If nonzero, the basis is kept in realWork on exit, and the next call   */
+   /* continues from it; warmBasisSize is the number of columns kept         */
+   int warmStart;
+   int warmBasisSize;
+
+   /* With locking, number of converged pairs accumulated before they are   */
+   /* locked, and new vectors are projected against the locked set in      */
+   /* blocks; 0 locks every converged pair as soon as possible             */
+   int lockingBatchSize;
+
+   /* If positive, the locked vectors in evecs are streamed through the     */
+   /* orthogonalization and the projectors in panels of this many columns,  */
+   /* prefetching the next panel; lockedPaging, if given, is called to      */
+   /* bring in (needed=1) or release (needed=0) each panel                  */
+   int lockedPanelSize;
+   void (*lockedPaging)(void *panel, PRIMME_INT *ldpanel, int *numCols,
+         int *needed, struct primme_params *primme, int *ierr);
+
+   /* If not NULL, the begin and end times of the matvecs, preconditioner   */
+   /* applications, global sums, orthogonalizations and projected problem   */
+   /* solutions are recorded, and the last traceSize events are written on  */
+   /* exit to this file in Chrome trace format                              */
+   char *traceFileName;
+   int traceSize;
+   void *trace;          /* internal: the tracer in use */
+
+   /* Optional nonblocking version of matrixMatvec: matrixMatvecStart starts */
+   /* y = A*x and returns a handle in request, which is passed to           */
+   /* matrixMatvecWait to finish it; meanwhile x and y are not modified      */
+   void (*matrixMatvecStart)
+      ( void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+        struct primme_params *primme, void **request, int *ierr);
+   void (*matrixMatvecWait)
+      ( void *request, struct primme_params *primme, int *ierr);
+
+   /* If nonzero, keep B*V along with V in generalized problems, so B is   */
+   /* applied once per basis vector; if zero, B is applied again when      */
+   /* needed, saving the memory of a basis                                 */
+   int massMatrixCache;
+
+   /* If nonzero, dprimme and zprimme solve the JDQMR correction equations  */
+   /* in single precision; then matrixMatvecSingle and                      */
+   /* applyPreconditionerSingle, if given, are applied instead of           */
+   /* matrixMatvec and applyPreconditioner on float (complex float) vectors */
+   int innerSinglePrecision;
+   void (*matrixMatvecSingle)
+      ( void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+        struct primme_params *primme, int *ierr);
+   void (*applyPreconditionerSingle)
+      ( void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+        struct primme_params *primme, int *ierr);
+
+   /* Optional version of convTestFun that checks blockSize pairs at once;  */
+   /* the pairs with isconv nonzero on input are not checked                */
+   void (*convTestFunBlock)
+      ( void *evals, void *evecs, PRIMME_INT *ldevecs, void *rNorms,
+        int *isconv, int *blockSize, struct primme_params *primme, int *ierr);
+
+   /* Only the events e with the bit (1 << e) set in monitorEvents are      */
+   /* reported to monitorFun; and if monitorInterval is positive, the outer */
+   /* and inner iteration events are reported only if at least that many   */
+   /* seconds have passed since the last reported event                    */
+   int monitorEvents;
+   double monitorInterval;
+
+   /* If nonzero, matrixMatvec, massMatrixMatvec and applyPreconditioner   */
+   /* take and return the blocks in row-major (interleaved) layout: the    */
+   /* element i of the vector j is at x[i*ldx+j], with ldx = blockSize     */
+   int rowMajorOPs;
+
+   /* If not NULL, checkpointFun is called with mode 0 every               */
+   /* checkpointInterval restarts to store the basis V and W = A*V; and     */
+   /* with mode 1 before the first iteration to restore them, setting      */
+   /* basisSize to the number of columns restored, or to 0 if none         */
+   void (*checkpointFun)(void *V, PRIMME_INT *ldV, void *W, PRIMME_INT *ldW,
+         int *basisSize, int *mode, struct primme_params *primme, int *ierr);
+   int checkpointInterval;
+
+   /* If not NULL, precondShiftUpdate is called before applyPreconditioner  */
+   /* when some shift in ShiftsForPreconditioner differs from the one of    */
+   /* the last call by more than precondShiftTol relatively; oldShifts is   */
+   /* NULL on the first call or if the block size changed                   */
+   void (*precondShiftUpdate)(double *newShifts, double *oldShifts,
+         int *blockSize, struct primme_params *primme, int *ierr);
+   double precondShiftTol;
+
+   /* If nonzero, dprimme and zprimme first solve the problem with sprimme  */
+   /* and cprimme up to a residual norm near single precision, and then     */
+   /* refine in double precision from the basis and the vectors found       */
+   int precisionCascade;
+
+   /* If not NULL, matrixMatvecHalf is applied instead of matrixMatvec with */
+   /* x in the 16-bit format set by matvecHalfType and y in float (complex  */
+   /* float), until the residual norms reach the error of that format;      */
+   /* then matrixMatvec is used, and V and W are recomputed with it         */
+   void (*matrixMatvecHalf)
+      ( void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+        struct primme_params *primme, int *ierr);
+   primme_half matvecHalfType;
+   int matvecHalfActive; /* internal: if matrixMatvecHalf is in use */
+
+   /* If not NULL, matrixPowers computes y = p_k(A)*x for k = degree, with  */
+   /* p_0(A) = I, p_1(A) = alpha[0]*(A - beta[0]*I) and                     */
+   /* p_{j+1}(A) = alpha[j]*(A - beta[j]*I)*p_j(A) - gamma[j]*p_{j-1}(A),    */
+   /* instead of calling matrixMatvec degree times, e.g., in the Chebyshev  */
+   /* filter                                                                */
+   void (*matrixPowers)(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+         int *blockSize, int *degree, double *alpha, double *beta,
+         double *gamma, struct primme_params *primme, int *ierr);
+
+   /* If nonzero, with the harmonic or refined projection and several      */
+   /* targetShifts, fill the rest of the block with one vector for each of */
+   /* the next shifts                                                      */
+   int multiShiftBlock;
+
+   /* If nonzero, only evals and resNorms are returned: the pairs are found  */
+   /* in windows of maxBasisSize/2, deflating only the previous window, and  */
+   /* evecs is a buffer of numOrthoConst + min(numEvals, maxBasisSize) cols  */
+   int evalsOnly;
+
+   /* If nonzero and with locking, dprimme and zprimme project out the      */
+   /* locked vectors and the constraints with a single precision copy of    */
+   /* them up to a residual norm near single precision, and then refine in  */
+   /* double precision from the basis and the vectors found                 */
+   int lockedSinglePrecision;
+   void *lockedCopy;     /* internal: single precision copy of lockedCopyOf */
+   void *lockedCopyOf;   /* internal: the evecs being copied in lockedCopy */
+   int lockedCopyCols;   /* internal: number of columns already copied */
+
+   /* If positive, the projection V'*W and the updates of V and W, as in    */
+   /* the residuals and the restarts, go over V and W in panels of this     */
+   /* many rows, prefetching the next panel; basisPaging, if given, is      */
+   /* called to bring in (needed=1) or release (needed=0) numRows rows of   */
+   /* numCols columns of V or W                                              */
+   PRIMME_INT basisPanelRows;
+   void (*basisPaging)(void *panel, PRIMME_INT *ldpanel, PRIMME_INT *numRows,
+         int *numCols, int *needed, struct primme_params *primme, int *ierr);
+
+   /* If nonzero, gather at the end the times of matvec, preconditioner and */
+   /* globalSumReal of all processes with one more reduction, and set the  */
+   /* summary in stats                                                     */
+   int statsImbalance;
+
+   double startTime;     /* internal: wall time when the solve started */
 } primme_params;
 /*---------------------------------------------------------------------------*/
 
@@ -237,7 +468,9 @@ typedef enum {
    PRIMME_JDQMR_ETol,
    PRIMME_STEEPEST_DESCENT,
    PRIMME_LOBPCG_OrthoBasis,
-   PRIMME_LOBPCG_OrthoBasis_Window
+   PRIMME_LOBPCG_OrthoBasis_Window,
+   PRIMME_GD_plusK_sStep,
+   PRIMME_Lanczos
 } primme_preset_method;
 
 typedef enum {
@@ -280,6 +513,7 @@ typedef enum {
    PRIMME_preconditioner =  30,
    PRIMME_initBasisMode =   301,
    PRIMME_projectionParams_projection =  302,
+   PRIMME_orth =  303,
    PRIMME_restartingParams_scheme =  31,
    PRIMME_restartingParams_maxPrevRetain =  32,
    PRIMME_correctionParams_precondition =  33,
@@ -300,15 +534,38 @@ typedef enum {
    PRIMME_stats_numGlobalSum =  471,
    PRIMME_stats_volumeGlobalSum =  472,
    PRIMME_stats_numOrthoInnerProds =  473,
+   PRIMME_stats_numGlobalSumMerged =  474,
+   PRIMME_stats_slowestProc =  475,
    PRIMME_stats_elapsedTime =  48,
    PRIMME_stats_timeMatvec =  4801,
    PRIMME_stats_timePrecond =  4802,
    PRIMME_stats_timeOrtho =  4803,
    PRIMME_stats_timeGlobalSum =  4804,
+   PRIMME_stats_timeSolveH =  4805,
+   PRIMME_stats_timeRestart =  4806,
+   PRIMME_stats_timeUpdateVWXR =  4807,
+   PRIMME_stats_timeConvCheck =  4808,
+   PRIMME_stats_timeInnerSolve =  4809,
+   PRIMME_stats_timeWorkspace =  4810,
+   PRIMME_stats_timeGlobalSumInterNode =  4811,
+   PRIMME_stats_timeMatvecMin =  4812,
+   PRIMME_stats_timeMatvecMax =  4813,
+   PRIMME_stats_timeMatvecAvg =  4814,
+   PRIMME_stats_timePrecondMin =  4815,
+   PRIMME_stats_timePrecondMax =  4816,
+   PRIMME_stats_timePrecondAvg =  4817,
+   PRIMME_stats_timeGlobalSumMin =  4818,
+   PRIMME_stats_timeGlobalSumMax =  4819,
+   PRIMME_stats_timeGlobalSumAvg =  4820,
+   PRIMME_stats_timeGlobalSumWaiting =  4821,
+   PRIMME_stats_estimateRemainingTime =  4822,
    PRIMME_stats_estimateMinEVal =  481,
    PRIMME_stats_estimateMaxEVal =  482,
    PRIMME_stats_estimateLargestSVal =  483,
    PRIMME_stats_maxConvTol =  484,
+   PRIMME_stats_orthoLossFactor =  485,
+   PRIMME_stats_imbalanceFactor =  486,
+   PRIMME_stats_estimateRemainingMatvecs =  487,
    PRIMME_dynamicMethodSwitch = 49,
    PRIMME_massMatrixMatvec =  50,
    PRIMME_convTestFun =  51,
@@ -316,7 +573,50 @@ typedef enum {
    PRIMME_ldevecs =  52,
    PRIMME_ldOPs =  53,
    PRIMME_monitorFun = 54,
-   PRIMME_monitor = 55
+   PRIMME_monitor = 55,
+   PRIMME_matrixMatvecProject = 56,
+   PRIMME_globalSumRealStart = 57,
+   PRIMME_globalSumRealWait = 58,
+   PRIMME_numThreads = 59,
+   PRIMME_firstTouch = 60,
+   PRIMME_sStepSize = 61,
+   PRIMME_dcMinBasisSize = 62,
+   PRIMME_incrementalRR = 63,
+   PRIMME_pipelinedQMR = 64,
+   PRIMME_chebyshevDegree = 65,
+   PRIMME_dynamicBlockSize = 66,
+   PRIMME_dynamicModel = 67,
+   PRIMME_warmStart = 68,
+   PRIMME_warmBasisSize = 69,
+   PRIMME_lockingBatchSize = 70,
+   PRIMME_lockedPanelSize = 71,
+   PRIMME_lockedPaging = 72,
+   PRIMME_traceFileName = 73,
+   PRIMME_traceSize = 74,
+   PRIMME_matrixMatvecStart = 75,
+   PRIMME_matrixMatvecWait = 76,
+   PRIMME_massMatrixCache = 77,
+   PRIMME_innerSinglePrecision = 78,
+   PRIMME_matrixMatvecSingle = 79,
+   PRIMME_applyPreconditionerSingle = 80,
+   PRIMME_convTestFunBlock = 81,
+   PRIMME_monitorEvents = 82,
+   PRIMME_monitorInterval = 83,
+   PRIMME_rowMajorOPs = 84,
+   PRIMME_checkpointFun = 85,
+   PRIMME_checkpointInterval = 86,
+   PRIMME_precondShiftUpdate = 87,
+   PRIMME_precondShiftTol = 88,
+   PRIMME_precisionCascade = 89,
+   PRIMME_matrixMatvecHalf = 90,
+   PRIMME_matvecHalfType = 91,
+   PRIMME_matrixPowers = 92,
+   PRIMME_multiShiftBlock = 93,
+   PRIMME_evalsOnly = 94,
+   PRIMME_lockedSinglePrecision = 95,
+   PRIMME_basisPanelRows = 96,
+   PRIMME_basisPaging = 97,
+   PRIMME_statsImbalance = 98
 } primme_params_label;
 
 int sprimme(float *evals, float *evecs, float *resNorms, 
@@ -327,6 +627,30 @@ int dprimme(double *evals, double *evecs, double *resNorms,
       primme_params *primme);
 int zprimme(double *evals, PRIMME_COMPLEX_DOUBLE *evecs, double *resNorms, 
       primme_params *primme);
+int sprimme_batch(float **evals, float **evecs, float **resNorms,
+      primme_params *primme, int numProblems, int *rets);
+int cprimme_batch(float **evals, PRIMME_COMPLEX_FLOAT **evecs,
+      float **resNorms, primme_params *primme, int numProblems, int *rets);
+int dprimme_batch(double **evals, double **evecs, double **resNorms,
+      primme_params *primme, int numProblems, int *rets);
+int zprimme_batch(double **evals, PRIMME_COMPLEX_DOUBLE **evecs,
+      double **resNorms, primme_params *primme, int numProblems, int *rets);
+int sprimme_plan(size_t memory, primme_preset_method method,
+      primme_params *primme);
+int cprimme_plan(size_t memory, primme_preset_method method,
+      primme_params *primme);
+int dprimme_plan(size_t memory, primme_preset_method method,
+      primme_params *primme);
+int zprimme_plan(size_t memory, primme_preset_method method,
+      primme_params *primme);
+int sprimme_dos(double *points, int numPoints, double *counts,
+      double *bounds, int degree, int numVectors, primme_params *primme);
+int cprimme_dos(double *points, int numPoints, double *counts,
+      double *bounds, int degree, int numVectors, primme_params *primme);
+int dprimme_dos(double *points, int numPoints, double *counts,
+      double *bounds, int degree, int numVectors, primme_params *primme);
+int zprimme_dos(double *points, int numPoints, double *counts,
+      double *bounds, int degree, int numVectors, primme_params *primme);
 void primme_initialize(primme_params *primme);
 int  primme_set_method(primme_preset_method method, primme_params *params);
 void primme_display_params(primme_params primme);
@@ -53,7 +53,9 @@ C-------------------------------------------------------
      : PRIMME_JDQMR_ETol,
      : PRIMME_STEEPEST_DESCENT,
      : PRIMME_LOBPCG_OrthoBasis,
-     : PRIMME_LOBPCG_OrthoBasis_Window
+     : PRIMME_LOBPCG_OrthoBasis_Window,
+     : PRIMME_GD_plusK_sStep,
+     : PRIMME_Lanczos
 
       parameter(
      : PRIMME_DEFAULT_METHOD = 0,
@@ -71,7 +73,9 @@ C-------------------------------------------------------
      : PRIMME_JDQMR_ETol = 12,
      : PRIMME_STEEPEST_DESCENT = 13,
      : PRIMME_LOBPCG_OrthoBasis = 14,
-     : PRIMME_LOBPCG_OrthoBasis_Window = 15
+     : PRIMME_LOBPCG_OrthoBasis_Window = 15,
+     : PRIMME_GD_plusK_sStep = 16,
+     : PRIMME_Lanczos = 17
      :)
 
 C-------------------------------------------------------
@@ -112,6 +116,7 @@ C-------------------------------------------------------
      : PRIMME_preconditioner,
      : PRIMME_initBasisMode,
      : PRIMME_projectionParams_projection,
+     : PRIMME_orth,
      : PRIMME_restartingParams_scheme,
      : PRIMME_restartingParams_maxPrevRetain,
      : PRIMME_correctionParams_precondition,
@@ -132,22 +137,88 @@ C-------------------------------------------------------
      : PRIMME_stats_numGlobalSum,
      : PRIMME_stats_volumeGlobalSum,
      : PRIMME_stats_numOrthoInnerProds,
+     : PRIMME_stats_numGlobalSumMerged,
      : PRIMME_stats_elapsedTime,
      : PRIMME_stats_timeMatvec,
      : PRIMME_stats_timePrecond,
      : PRIMME_stats_timeOrtho,
      : PRIMME_stats_timeGlobalSum,
+     : PRIMME_stats_timeSolveH,
+     : PRIMME_stats_timeRestart,
+     : PRIMME_stats_timeUpdateVWXR,
+     : PRIMME_stats_timeConvCheck,
+     : PRIMME_stats_timeInnerSolve,
+     : PRIMME_stats_timeWorkspace,
+     : PRIMME_stats_timeGlobalSumInterNode,
      : PRIMME_stats_estimateMinEVal,
      : PRIMME_stats_estimateMaxEVal,
      : PRIMME_stats_estimateLargestSVal,
      : PRIMME_stats_maxConvTol,
+     : PRIMME_stats_orthoLossFactor,
+     : PRIMME_stats_timeMatvecMin,
+     : PRIMME_stats_timeMatvecMax,
+     : PRIMME_stats_timeMatvecAvg,
+     : PRIMME_stats_timePrecondMin,
+     : PRIMME_stats_timePrecondMax,
+     : PRIMME_stats_timePrecondAvg,
+     : PRIMME_stats_timeGlobalSumMin,
+     : PRIMME_stats_timeGlobalSumMax,
+     : PRIMME_stats_timeGlobalSumAvg,
+     : PRIMME_stats_timeGlobalSumWaiting,
+     : PRIMME_stats_imbalanceFactor,
+     : PRIMME_stats_slowestProc,
+     : PRIMME_stats_estimateRemainingMatvecs,
+     : PRIMME_stats_estimateRemainingTime,
      : PRIMME_dynamicMethodSwitch,
      : PRIMME_massMatrixMatvec,
      : PRIMME_convTestFun,
      : PRIMME_ldevecs,
      : PRIMME_ldOPs,
      : PRIMME_monitorFun,
-     : PRIMME_monitor
+     : PRIMME_monitor,
+     : PRIMME_matrixMatvecProject,
+     : PRIMME_globalSumRealStart,
+     : PRIMME_globalSumRealWait,
+     : PRIMME_numThreads,
+     : PRIMME_firstTouch,
+     : PRIMME_sStepSize,
+     : PRIMME_dcMinBasisSize,
+     : PRIMME_incrementalRR,
+     : PRIMME_pipelinedQMR,
+     : PRIMME_chebyshevDegree,
+     : PRIMME_dynamicBlockSize,
+     : PRIMME_dynamicModel,
+     : PRIMME_warmStart,
+     : PRIMME_warmBasisSize,
+     : PRIMME_lockingBatchSize,
+     : PRIMME_lockedPanelSize,
+     : PRIMME_lockedPaging,
+     : PRIMME_traceFileName,
+     : PRIMME_traceSize,
+     : PRIMME_matrixMatvecStart,
+     : PRIMME_matrixMatvecWait,
+     : PRIMME_massMatrixCache,
+     : PRIMME_innerSinglePrecision,
+     : PRIMME_matrixMatvecSingle,
+     : PRIMME_applyPreconditionerSingle,
+     : PRIMME_convTestFunBlock,
+     : PRIMME_monitorEvents,
+     : PRIMME_monitorInterval,
+     : PRIMME_rowMajorOPs,
+     : PRIMME_checkpointFun,
+     : PRIMME_checkpointInterval,
+     : PRIMME_precondShiftUpdate,
+     : PRIMME_precondShiftTol,
+     : PRIMME_precisionCascade,
+     : PRIMME_matrixMatvecHalf,
+     : PRIMME_matvecHalfType,
+     : PRIMME_matrixPowers,
+     : PRIMME_multiShiftBlock,
+     : PRIMME_evalsOnly,
+     : PRIMME_lockedSinglePrecision,
+     : PRIMME_basisPanelRows,
+     : PRIMME_basisPaging,
+     : PRIMME_statsImbalance
 
       parameter(
      : PRIMME_n = 0,
@@ -183,6 +254,7 @@ C-------------------------------------------------------
      : PRIMME_preconditioner = 30,
      : PRIMME_initBasisMode = 301,
      : PRIMME_projectionParams_projection = 302,
+     : PRIMME_orth = 303,
      : PRIMME_restartingParams_scheme = 31,
      : PRIMME_restartingParams_maxPrevRetain = 32,
      : PRIMME_correctionParams_precondition = 33,
@@ -203,22 +275,88 @@ C-------------------------------------------------------
      : PRIMME_stats_numGlobalSum =  471,
      : PRIMME_stats_volumeGlobalSum =  472,
      : PRIMME_stats_numOrthoInnerProds =  473,
+     : PRIMME_stats_numGlobalSumMerged =  474,
      : PRIMME_stats_elapsedTime = 48,
      : PRIMME_stats_timeMatvec =  4801,
      : PRIMME_stats_timePrecond =  4802,
      : PRIMME_stats_timeOrtho =  4803,
      : PRIMME_stats_timeGlobalSum =  4804,
+     : PRIMME_stats_timeSolveH =  4805,
+     : PRIMME_stats_timeRestart =  4806,
+     : PRIMME_stats_timeUpdateVWXR =  4807,
+     : PRIMME_stats_timeConvCheck =  4808,
+     : PRIMME_stats_timeInnerSolve =  4809,
+     : PRIMME_stats_timeWorkspace =  4810,
+     : PRIMME_stats_timeGlobalSumInterNode =  4811,
      : PRIMME_stats_estimateMinEVal = 481,
      : PRIMME_stats_estimateMaxEVal = 482,
      : PRIMME_stats_estimateLargestSVal = 483,
      : PRIMME_stats_maxConvTol = 484,
+     : PRIMME_stats_orthoLossFactor = 485,
+     : PRIMME_stats_timeMatvecMin = 4812,
+     : PRIMME_stats_timeMatvecMax = 4813,
+     : PRIMME_stats_timeMatvecAvg = 4814,
+     : PRIMME_stats_timePrecondMin = 4815,
+     : PRIMME_stats_timePrecondMax = 4816,
+     : PRIMME_stats_timePrecondAvg = 4817,
+     : PRIMME_stats_timeGlobalSumMin = 4818,
+     : PRIMME_stats_timeGlobalSumMax = 4819,
+     : PRIMME_stats_timeGlobalSumAvg = 4820,
+     : PRIMME_stats_timeGlobalSumWaiting = 4821,
+     : PRIMME_stats_imbalanceFactor = 486,
+     : PRIMME_stats_slowestProc = 475,
+     : PRIMME_stats_estimateRemainingMatvecs = 487,
+     : PRIMME_stats_estimateRemainingTime = 4822,
      : PRIMME_dynamicMethodSwitch = 49,
      : PRIMME_massMatrixMatvec = 50,
      : PRIMME_convTestFun = 51,
      : PRIMME_ldevecs = 52,
      : PRIMME_ldOPs = 53,
      : PRIMME_monitorFun = 54,
-     : PRIMME_monitor = 55
+     : PRIMME_monitor = 55,
+     : PRIMME_matrixMatvecProject = 56,
+     : PRIMME_globalSumRealStart = 57,
+     : PRIMME_globalSumRealWait = 58,
+     : PRIMME_numThreads = 59,
+     : PRIMME_firstTouch = 60,
+     : PRIMME_sStepSize = 61,
+     : PRIMME_dcMinBasisSize = 62,
+     : PRIMME_incrementalRR = 63,
+     : PRIMME_pipelinedQMR = 64,
+     : PRIMME_chebyshevDegree = 65,
+     : PRIMME_dynamicBlockSize = 66,
+     : PRIMME_dynamicModel = 67,
+     : PRIMME_warmStart = 68,
+     : PRIMME_warmBasisSize = 69,
+     : PRIMME_lockingBatchSize = 70,
+     : PRIMME_lockedPanelSize = 71,
+     : PRIMME_lockedPaging = 72,
+     : PRIMME_traceFileName = 73,
+     : PRIMME_traceSize = 74,
+     : PRIMME_matrixMatvecStart = 75,
+     : PRIMME_matrixMatvecWait = 76,
+     : PRIMME_massMatrixCache = 77,
+     : PRIMME_innerSinglePrecision = 78,
+     : PRIMME_matrixMatvecSingle = 79,
+     : PRIMME_applyPreconditionerSingle = 80,
+     : PRIMME_convTestFunBlock = 81,
+     : PRIMME_monitorEvents = 82,
+     : PRIMME_monitorInterval = 83,
+     : PRIMME_rowMajorOPs = 84,
+     : PRIMME_checkpointFun = 85,
+     : PRIMME_checkpointInterval = 86,
+     : PRIMME_precondShiftUpdate = 87,
+     : PRIMME_precondShiftTol = 88,
+     : PRIMME_precisionCascade = 89,
+     : PRIMME_matrixMatvecHalf = 90,
+     : PRIMME_matvecHalfType = 91,
+     : PRIMME_matrixPowers = 92,
+     : PRIMME_multiShiftBlock = 93,
+     : PRIMME_evalsOnly = 94,
+     : PRIMME_lockedSinglePrecision = 95,
+     : PRIMME_basisPanelRows = 96,
+     : PRIMME_basisPaging = 97,
+     : PRIMME_statsImbalance = 98
      : )
 
 C-------------------------------------------------------
@@ -241,6 +379,14 @@ C-------------------------------------------------------
      : primme_init_krylov,
      : primme_init_random,
      : primme_init_user,
+     : primme_orth_default,
+     : primme_orth_vector,
+     : primme_orth_block,
+     : primme_orth_lowsync,
+     : primme_orth_selective,
+     : primme_orth_adaptive,
+     : primme_half_fp16,
+     : primme_half_bf16,
      : primme_thick,
      : primme_dtr,
      : primme_full_LTolerance,
@@ -269,6 +415,14 @@ C-------------------------------------------------------
      : primme_init_krylov = 1,
      : primme_init_random = 2,
      : primme_init_user = 3,
+     : primme_orth_default = 0,
+     : primme_orth_vector = 1,
+     : primme_orth_block = 2,
+     : primme_orth_lowsync = 3,
+     : primme_orth_selective = 4,
+     : primme_orth_adaptive = 5,
+     : primme_half_fp16 = 0,
+     : primme_half_bf16 = 1,
      : primme_thick = 0,
      : primme_dtr = 1,
      : primme_full_LTolerance = 0,
@@ -0,0 +1,321 @@
+/*******************************************************************************
+ * Copyright (c) 2018, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ **********************************************************************
+ * File: primme_mpi.h
+ *
+ * Purpose - Node-aware globalSumReal for MPI programs.
+ *
+ * The library does not depend on MPI; this header is compiled with the
+ * user's code, which includes and links MPI:
+ *
+ *    primme_mpi_sum ctx;
+ *    primme_initialize(&primme);
+ *    primme_mpi_sum_setup(&primme, &ctx, MPI_COMM_WORLD);
+ *    ... set n, nLocal, matrixMatvec, etc., and call the solver ...
+ *    primme_mpi_sum_free(&ctx);
+ *
+ * The processes on the same node first add their contributions through an
+ * MPI-3 shared window, every process reducing a slice of the vector; then
+ * one process per node does the MPI_Allreduce among nodes, and the result
+ * is read back from the window. The time spent in the inter-node stage is
+ * added to primme->stats.timeGlobalSumInterNode on the node leaders.
+ *
+ * ctx starts with the communicator, so callbacks that take commInfo as an
+ * MPI_Comm pointer keep working. By default the reductions are on doubles;
+ * define PRIMME_MPI_REAL and PRIMME_MPI_REAL_TYPE (e.g., as float and
+ * MPI_FLOAT) before including this file for single precision.
+ *
+ ******************************************************************************/
+
+#ifndef PRIMME_MPI_H
+#define PRIMME_MPI_H
+
+#include <string.h>
+#include <mpi.h>
+#include "primme.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef PRIMME_MPI_REAL
+#define PRIMME_MPI_REAL double
+#define PRIMME_MPI_REAL_TYPE MPI_DOUBLE
+#endif
+
+typedef struct {
+   MPI_Comm comm;       /* all processes; keep it first */
+   MPI_Comm node;       /* processes sharing memory with this one */
+   MPI_Comm leaders;    /* a process per node; MPI_COMM_NULL on the others */
+   int nodeSize;        /* number of processes in node */
+   int nodeRank;        /* rank in node */
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+   MPI_Win win;         /* shared window with a slot per process in node */
+#endif
+   PRIMME_MPI_REAL *buf;/* first slot of the window */
+   int capacity;        /* number of values per slot */
+} primme_mpi_sum;
+
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+
+/*******************************************************************************
+ * Function primme_mpi_sum_resize - Make the slots hold at least count values.
+ *    Every process in ctx->node calls it with the same count.
+ *
+ * Return value: an MPI error code
+ ******************************************************************************/
+
+static int primme_mpi_sum_resize(primme_mpi_sum *ctx, int count) {
+
+   MPI_Aint size;
+   int disp, ierr;
+
+   if (count <= ctx->capacity) return MPI_SUCCESS;
+
+   if (ctx->buf) {
+      MPI_Win_unlock_all(ctx->win);
+      MPI_Win_free(&ctx->win);
+      ctx->buf = NULL;
+      ctx->capacity = 0;
+   }
+
+   /* Slots are contiguous (the default of MPI_Win_allocate_shared), so */
+   /* slot i starts at buf + i*count                                     */
+
+   ierr = MPI_Win_allocate_shared((MPI_Aint)sizeof(PRIMME_MPI_REAL) * count,
+         sizeof(PRIMME_MPI_REAL), MPI_INFO_NULL, ctx->node, &ctx->buf,
+         &ctx->win);
+   if (ierr != MPI_SUCCESS) return ierr;
+   ierr = MPI_Win_shared_query(ctx->win, 0, &size, &disp, &ctx->buf);
+   if (ierr != MPI_SUCCESS) return ierr;
+   ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK, ctx->win);
+   if (ierr != MPI_SUCCESS) return ierr;
+   ctx->capacity = count;
+   return MPI_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function primme_mpi_sum_reduce - recvBuf = sum of sendBuf in ctx->comm
+ *
+ * INPUT/OUTPUT
+ * ------------
+ * timeInter   Time spent in the inter-node stage is added to it; on the node
+ *             leaders only
+ *
+ * Return value: an MPI error code
+ ******************************************************************************/
+
+static int primme_mpi_sum_reduce(primme_mpi_sum *ctx, void *sendBuf,
+      void *recvBuf, int count, double *timeInter) {
+
+   PRIMME_MPI_REAL *x = (PRIMME_MPI_REAL*)sendBuf;
+   PRIMME_MPI_REAL *y = (PRIMME_MPI_REAL*)recvBuf;
+   int i, j, i0, i1, chunk, ierr;
+   double t0;
+
+   /* With a process per node, there is nothing to combine on-node */
+
+   if (ctx->nodeSize == 1) {
+      t0 = MPI_Wtime();
+      ierr = MPI_Allreduce(x == y ? MPI_IN_PLACE : x, y, count,
+            PRIMME_MPI_REAL_TYPE, MPI_SUM, ctx->comm);
+      *timeInter += MPI_Wtime() - t0;
+      return ierr;
+   }
+
+   ierr = primme_mpi_sum_resize(ctx, count);
+   if (ierr != MPI_SUCCESS) return ierr;
+
+   /* Publish this process' contribution in its slot */
+
+   memcpy(&ctx->buf[ctx->capacity * ctx->nodeRank], x,
+         sizeof(PRIMME_MPI_REAL) * count);
+   MPI_Win_sync(ctx->win);
+   MPI_Barrier(ctx->node);
+   MPI_Win_sync(ctx->win);
+
+   /* Add up the slots into the first one; every process does a slice */
+
+   chunk = (count + ctx->nodeSize - 1) / ctx->nodeSize;
+   i0 = chunk * ctx->nodeRank;
+   i1 = i0 + chunk < count ? i0 + chunk : count;
+   for (j = 1; j < ctx->nodeSize; j++) {
+      PRIMME_MPI_REAL *s = &ctx->buf[ctx->capacity * j];
+      for (i = i0; i < i1; i++) ctx->buf[i] += s[i];
+   }
+   MPI_Win_sync(ctx->win);
+   MPI_Barrier(ctx->node);
+   MPI_Win_sync(ctx->win);
+
+   /* One allreduce per node */
+
+   if (ctx->leaders != MPI_COMM_NULL) {
+      t0 = MPI_Wtime();
+      ierr = MPI_Allreduce(MPI_IN_PLACE, ctx->buf, count,
+            PRIMME_MPI_REAL_TYPE, MPI_SUM, ctx->leaders);
+      *timeInter += MPI_Wtime() - t0;
+      MPI_Win_sync(ctx->win);
+   }
+   MPI_Barrier(ctx->node);
+   MPI_Win_sync(ctx->win);
+
+   /* Read the result back; the last barrier prevents the next call from */
+   /* overwriting the first slot before everyone has copied it           */
+
+   memcpy(y, ctx->buf, sizeof(PRIMME_MPI_REAL) * count);
+   MPI_Barrier(ctx->node);
+
+   /* Only the leaders know if the allreduce failed */
+
+   MPI_Bcast(&ierr, 1, MPI_INT, 0, ctx->node);
+   return ierr;
+}
+
+#else
+
+static int primme_mpi_sum_reduce(primme_mpi_sum *ctx, void *sendBuf,
+      void *recvBuf, int count, double *timeInter) {
+
+   double t0 = MPI_Wtime();
+   int ierr = MPI_Allreduce(sendBuf == recvBuf ? MPI_IN_PLACE : sendBuf,
+         recvBuf, count, PRIMME_MPI_REAL_TYPE, MPI_SUM, ctx->comm);
+   *timeInter += MPI_Wtime() - t0;
+   return ierr;
+}
+
+#endif /* MPI_VERSION >= 3 */
+
+/*******************************************************************************
+ * Functions primme_mpi_sum_globalsum and primme_mpi_sum_globalsum_svds -
+ *    globalSumReal for primme_params and primme_svds_params
+ ******************************************************************************/
+
+static void primme_mpi_sum_globalsum(void *sendBuf, void *recvBuf, int *count,
+      primme_params *primme, int *ierr) {
+
+   *ierr = primme_mpi_sum_reduce((primme_mpi_sum*)primme->commInfo, sendBuf,
+         recvBuf, *count, &primme->stats.timeGlobalSumInterNode) != MPI_SUCCESS;
+}
+
+static void primme_mpi_sum_globalsum_svds(void *sendBuf, void *recvBuf,
+      int *count, primme_svds_params *primme_svds, int *ierr) {
+
+   double t = 0.0;
+
+   *ierr = primme_mpi_sum_reduce((primme_mpi_sum*)primme_svds->commInfo,
+         sendBuf, recvBuf, *count, &t) != MPI_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function primme_mpi_sum_init - Split comm into nodes and node leaders.
+ *    It is collective on comm. ctx should be alive while it is used.
+ *
+ * Return value: an MPI error code
+ ******************************************************************************/
+
+static int primme_mpi_sum_init(primme_mpi_sum *ctx, MPI_Comm comm) {
+
+   int rank, ierr;
+
+   memset(ctx, 0, sizeof(*ctx));
+   ctx->comm = comm;
+   ctx->node = MPI_COMM_NULL;
+   ctx->leaders = MPI_COMM_NULL;
+   ctx->nodeSize = 1;
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+   ierr = MPI_Comm_rank(comm, &rank);
+   if (ierr != MPI_SUCCESS) return ierr;
+   ierr = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+         &ctx->node);
+   if (ierr != MPI_SUCCESS) return ierr;
+   MPI_Comm_size(ctx->node, &ctx->nodeSize);
+   MPI_Comm_rank(ctx->node, &ctx->nodeRank);
+   ierr = MPI_Comm_split(comm, ctx->nodeRank == 0 ? 0 : MPI_UNDEFINED, rank,
+         &ctx->leaders);
+#else
+   (void)rank;
+   ierr = MPI_SUCCESS;
+#endif
+   return ierr;
+}
+
+/*******************************************************************************
+ * Functions primme_mpi_sum_setup and primme_mpi_sum_svds_setup - Set the
+ *    parallel information and globalSumReal of primme or primme_svds
+ *
+ * Return value: an MPI error code
+ ******************************************************************************/
+
+static int primme_mpi_sum_setup(primme_params *primme, primme_mpi_sum *ctx,
+      MPI_Comm comm) {
+
+   int ierr = primme_mpi_sum_init(ctx, comm);
+   if (ierr != MPI_SUCCESS) return ierr;
+   MPI_Comm_size(comm, &primme->numProcs);
+   MPI_Comm_rank(comm, &primme->procID);
+   primme->commInfo = ctx;
+   primme->globalSumReal = primme_mpi_sum_globalsum;
+   return MPI_SUCCESS;
+}
+
+static int primme_mpi_sum_svds_setup(primme_svds_params *primme_svds,
+      primme_mpi_sum *ctx, MPI_Comm comm) {
+
+   int ierr = primme_mpi_sum_init(ctx, comm);
+   if (ierr != MPI_SUCCESS) return ierr;
+   MPI_Comm_size(comm, &primme_svds->numProcs);
+   MPI_Comm_rank(comm, &primme_svds->procID);
+   primme_svds->commInfo = ctx;
+   primme_svds->globalSumReal = primme_mpi_sum_globalsum_svds;
+   return MPI_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function primme_mpi_sum_free - Free the communicators and the window in ctx
+ ******************************************************************************/
+
+static void primme_mpi_sum_free(primme_mpi_sum *ctx) {
+
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+   if (ctx->buf) {
+      MPI_Win_unlock_all(ctx->win);
+      MPI_Win_free(&ctx->win);
+   }
+#endif
+   if (ctx->node != MPI_COMM_NULL) MPI_Comm_free(&ctx->node);
+   if (ctx->leaders != MPI_COMM_NULL) MPI_Comm_free(&ctx->leaders);
+   ctx->buf = NULL;
+   ctx->capacity = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIMME_MPI_H */
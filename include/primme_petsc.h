@@ -0,0 +1,276 @@
+/*******************************************************************************
+ * Copyright (c) 2018, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ **********************************************************************
+ * File: primme_petsc.h
+ *
+ * Purpose - Bind a PETSc Mat, and optionally a PC or a KSP, to the operators
+ *           and the global sums of primme_params.
+ *
+ * The library does not depend on PETSc; this header is compiled with the
+ * user's code, which includes the PETSc headers and links PETSc:
+ *
+ *    primme_petsc ctx;
+ *    primme_initialize(&primme);
+ *    primme_petsc_setup(&primme, &ctx, A, pc, NULL);
+ *    ... set numEvals, target, etc., and call the solver ...
+ *    primme_petsc_free(&ctx);
+ *
+ * The blocks of vectors given by PRIMME are wrapped by dense matrices and
+ * vectors with MatDensePlaceArray and VecPlaceArray, so no copy is done per
+ * call; the wrappers are created once for every block size and kept in ctx.
+ * The global sums use the communicator of the matrix, and they are
+ * nonblocking (globalSumRealStart/Wait) if MPI provides MPI_Iallreduce.
+ *
+ ******************************************************************************/
+
+#ifndef PRIMME_PETSC_H
+#define PRIMME_PETSC_H
+
+#include <stdlib.h>
+#include <petscksp.h>
+#include "primme.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest block size with cached dense wrappers; larger blocks are applied */
+/* by columns                                                               */
+
+#define PRIMME_PETSC_MAX_BLOCK 64
+
+typedef struct {
+   Mat A;            /* the matrix */
+   PC pc;            /* the preconditioner, or NULL */
+   KSP ksp;          /* the solver used as preconditioner, or NULL */
+   MPI_Comm comm;    /* the communicator of A */
+   Vec x, y;         /* wrappers of a single vector */
+   Mat X[PRIMME_PETSC_MAX_BLOCK+1];    /* wrappers of blocks, by block size */
+   Mat Y[PRIMME_PETSC_MAX_BLOCK+1];    /* A*X[i] */
+} primme_petsc;
+
+/*******************************************************************************
+ * Function primme_petsc_matvec - matrixMatvec: Y = A*X
+ ******************************************************************************/
+
+static void primme_petsc_matvec(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
+
+   primme_petsc *ctx = (primme_petsc*)primme->matrix;
+   PetscScalar *X = (PetscScalar*)x, *Y = (PetscScalar*)y;
+   PetscErrorCode perr = 0;
+   int i, n = *blockSize;
+
+   /* Multiply the block at once if its columns are contiguous */
+
+   if (n > 1 && n <= PRIMME_PETSC_MAX_BLOCK && *ldx == primme->nLocal
+         && *ldy == primme->nLocal) {
+      /* The first product of every block size creates Y[n] with its own */
+      /* storage; the next ones reuse it with Y placed                     */
+
+      if (!ctx->X[n]) {
+         perr = MatCreateDense(ctx->comm, (PetscInt)primme->nLocal,
+               PETSC_DECIDE, (PetscInt)primme->n, n, X, &ctx->X[n]);
+         if (!perr) perr = MatMatMult(ctx->A, ctx->X[n], MAT_INITIAL_MATRIX,
+               PETSC_DEFAULT, &ctx->Y[n]);
+      }
+      if (!perr) perr = MatDensePlaceArray(ctx->X[n], X);
+      if (!perr) perr = MatDensePlaceArray(ctx->Y[n], Y);
+      if (!perr) perr = MatMatMult(ctx->A, ctx->X[n], MAT_REUSE_MATRIX,
+            PETSC_DEFAULT, &ctx->Y[n]);
+      if (!perr) perr = MatDenseResetArray(ctx->Y[n]);
+      if (!perr) perr = MatDenseResetArray(ctx->X[n]);
+      *ierr = (int)perr;
+      return;
+   }
+
+   /* Otherwise multiply every column */
+
+   for (i=0; i<n && !perr; i++) {
+      perr = VecPlaceArray(ctx->x, &X[*ldx*i]);
+      if (!perr) perr = VecPlaceArray(ctx->y, &Y[*ldy*i]);
+      if (!perr) perr = MatMult(ctx->A, ctx->x, ctx->y);
+      if (!perr) perr = VecResetArray(ctx->x);
+      if (!perr) perr = VecResetArray(ctx->y);
+   }
+   *ierr = (int)perr;
+}
+
+/*******************************************************************************
+ * Function primme_petsc_precond - applyPreconditioner: Y = M\X, where M is
+ *    the PC or the KSP in ctx
+ ******************************************************************************/
+
+static void primme_petsc_precond(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
+
+   primme_petsc *ctx = (primme_petsc*)primme->preconditioner;
+   PetscScalar *X = (PetscScalar*)x, *Y = (PetscScalar*)y;
+   PetscErrorCode perr = 0;
+   int i;
+
+   for (i=0; i<*blockSize && !perr; i++) {
+      perr = VecPlaceArray(ctx->x, &X[*ldx*i]);
+      if (!perr) perr = VecPlaceArray(ctx->y, &Y[*ldy*i]);
+      if (!perr) {
+         perr = ctx->ksp ? KSPSolve(ctx->ksp, ctx->x, ctx->y)
+                         : PCApply(ctx->pc, ctx->x, ctx->y);
+      }
+      if (!perr) perr = VecResetArray(ctx->x);
+      if (!perr) perr = VecResetArray(ctx->y);
+   }
+   *ierr = (int)perr;
+}
+
+/*******************************************************************************
+ * Functions primme_petsc_globalsum, primme_petsc_globalsum_start and
+ *    primme_petsc_globalsum_wait - globalSumReal and its nonblocking version
+ ******************************************************************************/
+
+static void primme_petsc_globalsum(void *sendBuf, void *recvBuf, int *count,
+      primme_params *primme, int *ierr) {
+
+   primme_petsc *ctx = (primme_petsc*)primme->commInfo;
+
+   *ierr = MPI_Allreduce(sendBuf == recvBuf ? MPI_IN_PLACE : sendBuf, recvBuf,
+         *count, MPIU_REAL, MPIU_SUM, ctx->comm) != MPI_SUCCESS;
+}
+
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+static void primme_petsc_globalsum_start(void *sendBuf, void *recvBuf,
+      int *count, primme_params *primme, void **request, int *ierr) {
+
+   primme_petsc *ctx = (primme_petsc*)primme->commInfo;
+   MPI_Request *r = (MPI_Request*)malloc(sizeof(MPI_Request));
+
+   *request = r;
+   if (!r) {
+      *ierr = -1;
+      return;
+   }
+   *ierr = MPI_Iallreduce(sendBuf == recvBuf ? MPI_IN_PLACE : sendBuf,
+         recvBuf, *count, MPIU_REAL, MPIU_SUM, ctx->comm, r) != MPI_SUCCESS;
+}
+
+static void primme_petsc_globalsum_wait(void *request, primme_params *primme,
+      int *ierr) {
+
+   MPI_Request *r = (MPI_Request*)request;
+
+   (void)primme;
+   *ierr = MPI_Wait(r, MPI_STATUS_IGNORE) != MPI_SUCCESS;
+   free(r);
+}
+#endif
+
+/*******************************************************************************
+ * Function primme_petsc_setup - Set in primme the dimensions, the operators
+ *    and the parallel information of the matrix A; if pc or ksp is not NULL,
+ *    set it as the preconditioner. ctx should be alive while primme is used.
+ *
+ * Return value: a PETSc error code
+ ******************************************************************************/
+
+static PetscErrorCode primme_petsc_setup(primme_params *primme,
+      primme_petsc *ctx, Mat A, PC pc, KSP ksp) {
+
+   PetscErrorCode perr;
+   PetscInt n, nLocal;
+   PetscMPIInt np, rank;
+
+   PetscFunctionBegin;
+   perr = PetscMemzero(ctx, sizeof(*ctx)); CHKERRQ(perr);
+   ctx->A = A;
+   ctx->pc = pc;
+   ctx->ksp = ksp;
+   perr = PetscObjectGetComm((PetscObject)A, &ctx->comm); CHKERRQ(perr);
+   perr = MatGetSize(A, &n, NULL); CHKERRQ(perr);
+   perr = MatGetLocalSize(A, &nLocal, NULL); CHKERRQ(perr);
+   perr = MPI_Comm_size(ctx->comm, &np); CHKERRQ(perr);
+   perr = MPI_Comm_rank(ctx->comm, &rank); CHKERRQ(perr);
+
+   /* Create the wrappers of single vectors without an array */
+
+   perr = VecCreateMPIWithArray(ctx->comm, 1, nLocal, n, NULL, &ctx->x);
+   CHKERRQ(perr);
+   perr = VecCreateMPIWithArray(ctx->comm, 1, nLocal, n, NULL, &ctx->y);
+   CHKERRQ(perr);
+
+   primme->n = (PRIMME_INT)n;
+   primme->nLocal = (PRIMME_INT)nLocal;
+   primme->numProcs = (int)np;
+   primme->procID = (int)rank;
+   primme->matrix = ctx;
+   primme->matrixMatvec = primme_petsc_matvec;
+   if (pc || ksp) {
+      primme->preconditioner = ctx;
+      primme->applyPreconditioner = primme_petsc_precond;
+      primme->correctionParams.precondition = 1;
+   }
+   primme->commInfo = ctx;
+   primme->globalSumReal = primme_petsc_globalsum;
+#if defined(MPI_VERSION) && MPI_VERSION >= 3
+   primme->globalSumRealStart = primme_petsc_globalsum_start;
+   primme->globalSumRealWait = primme_petsc_globalsum_wait;
+#endif
+
+   /* Ask for blocks with leading dimension nLocal, so that they can be */
+   /* wrapped by a single dense matrix                                  */
+
+   primme->ldOPs = (PRIMME_INT)nLocal;
+
+   PetscFunctionReturn(0);
+}
+
+/*******************************************************************************
+ * Function primme_petsc_free - Destroy the wrappers in ctx
+ *
+ * Return value: a PETSc error code
+ ******************************************************************************/
+
+static PetscErrorCode primme_petsc_free(primme_petsc *ctx) {
+
+   PetscErrorCode perr;
+   int i;
+
+   PetscFunctionBegin;
+   perr = VecDestroy(&ctx->x); CHKERRQ(perr);
+   perr = VecDestroy(&ctx->y); CHKERRQ(perr);
+   for (i=0; i<=PRIMME_PETSC_MAX_BLOCK; i++) {
+      perr = MatDestroy(&ctx->X[i]); CHKERRQ(perr);
+      perr = MatDestroy(&ctx->Y[i]); CHKERRQ(perr);
+   }
+   PetscFunctionReturn(0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIMME_PETSC_H */
@@ -63,6 +63,11 @@ typedef enum {
    primme_svds_op_augmented
 } primme_svds_operator;
 
+typedef enum {
+   primme_svds_prec_prepare,    /* before a stage that uses the preconditioner */
+   primme_svds_prec_release     /* from primme_svds_free                       */
+} primme_svds_prec_event;
+
 typedef struct primme_svds_stats {
    PRIMME_INT numOuterIterations;
    PRIMME_INT numRestarts;
@@ -150,6 +155,36 @@ typedef struct primme_svds_params {
       int *inner_its, void *LSRes, primme_event *event, int *stage,
       struct primme_svds_params *primme_svds, int *err);
    void *monitor;
+
+   /* Optional: y = A'*A*x (transpose = 0) or y = A*A'*x (transpose = 1) */
+   void (*matrixMatvecNormal)
+      (void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+       int *transpose, struct primme_svds_params *primme_svds, int *ierr);
+
+   /* Number of power passes of the randomized range finder for initial guesses */
+   int rangeFinderPasses;
+
+   /* Budget of passes over A (calls to matrixMatvec or matrixMatvecNormal) */
+   /* and passes done so far; zero means no budget                          */
+   PRIMME_INT maxPasses;
+   PRIMME_INT numPasses;
+
+   /* If not NULL, the events of both stages are recorded as in             */
+   /* primme_params.traceFileName and written on exit to this file          */
+   char *traceFileName;
+   int traceSize;
+
+   /* If 1, choose the operators from the measured cost of the products,  */
+   /* the orthogonalization and the reductions; set by the default method */
+   int dynamicMethodSwitch;
+
+   /* Optional: called before every stage that applies the preconditioner */
+   /* with the operator and the shifts of the stage, and from             */
+   /* primme_svds_free to release it; so a preconditioner can be built    */
+   /* once and reused by both stages and by later calls                   */
+   void (*preconditionerSetup)(primme_svds_prec_event *event,
+      primme_svds_operator *method, double *shifts, int *numShifts,
+      struct primme_svds_params *primme_svds, int *ierr);
 } primme_svds_params;
 
 typedef enum {
@@ -204,7 +239,15 @@ typedef enum {
    PRIMME_SVDS_convTestFun = 405,
    PRIMME_SVDS_convtest = 406,
    PRIMME_SVDS_monitorFun = 41,
-   PRIMME_SVDS_monitor = 42
+   PRIMME_SVDS_monitor = 42,
+   PRIMME_SVDS_matrixMatvecNormal = 43,
+   PRIMME_SVDS_rangeFinderPasses = 44,
+   PRIMME_SVDS_maxPasses = 45,
+   PRIMME_SVDS_numPasses = 46,
+   PRIMME_SVDS_traceFileName = 47,
+   PRIMME_SVDS_traceSize = 48,
+   PRIMME_SVDS_dynamicMethodSwitch = 49,
+   PRIMME_SVDS_preconditionerSetup = 50
 } primme_svds_params_label;
 
 int sprimme_svds(float *svals, float *svecs, float *resNorms,
@@ -215,6 +258,18 @@ int dprimme_svds(double *svals, double *svecs, double *resNorms,
       primme_svds_params *primme_svds);
 int zprimme_svds(double *svals, PRIMME_COMPLEX_DOUBLE *svecs, double *resNorms,
       primme_svds_params *primme_svds);
+int sprimme_svds_update(float *svals, float *svecs, float *resNorms,
+      float *newRows, PRIMME_INT ldNewRows, int numNewRows,
+      primme_svds_params *primme_svds);
+int cprimme_svds_update(float *svals, PRIMME_COMPLEX_FLOAT *svecs,
+      float *resNorms, PRIMME_COMPLEX_FLOAT *newRows, PRIMME_INT ldNewRows,
+      int numNewRows, primme_svds_params *primme_svds);
+int dprimme_svds_update(double *svals, double *svecs, double *resNorms,
+      double *newRows, PRIMME_INT ldNewRows, int numNewRows,
+      primme_svds_params *primme_svds);
+int zprimme_svds_update(double *svals, PRIMME_COMPLEX_DOUBLE *svecs,
+      double *resNorms, PRIMME_COMPLEX_DOUBLE *newRows, PRIMME_INT ldNewRows,
+      int numNewRows, primme_svds_params *primme_svds);
 void primme_svds_initialize(primme_svds_params *primme_svds);
 int primme_svds_set_method(primme_svds_preset_method method,
       primme_preset_method methodStage1, primme_preset_method methodStage2,
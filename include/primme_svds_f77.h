@@ -107,7 +107,15 @@ C-------------------------------------------------------
      : PRIMME_SVDS_convTestFun,
      : PRIMME_SVDS_convtest,
      : PRIMME_SVDS_monitorFun,
-     : PRIMME_SVDS_monitor
+     : PRIMME_SVDS_monitor,
+     : PRIMME_SVDS_matrixMatvecNormal,
+     : PRIMME_SVDS_rangeFinderPasses,
+     : PRIMME_SVDS_maxPasses,
+     : PRIMME_SVDS_numPasses,
+     : PRIMME_SVDS_traceFileName,
+     : PRIMME_SVDS_traceSize,
+     : PRIMME_SVDS_dynamicMethodSwitch,
+     : PRIMME_SVDS_preconditionerSetup
 
       parameter(
      : PRIMME_SVDS_primme = 0,
@@ -161,7 +169,15 @@ C-------------------------------------------------------
      : PRIMME_SVDS_convTestFun = 405,
      : PRIMME_SVDS_convtest = 406,
      : PRIMME_SVDS_monitorFun = 41,
-     : PRIMME_SVDS_monitor = 42
+     : PRIMME_SVDS_monitor = 42,
+     : PRIMME_SVDS_matrixMatvecNormal = 43,
+     : PRIMME_SVDS_rangeFinderPasses = 44,
+     : PRIMME_SVDS_maxPasses = 45,
+     : PRIMME_SVDS_numPasses = 46,
+     : PRIMME_SVDS_traceFileName = 47,
+     : PRIMME_SVDS_traceSize = 48,
+     : PRIMME_SVDS_dynamicMethodSwitch = 49,
+     : PRIMME_SVDS_preconditionerSetup = 50
      :)
 
 C-------------------------------------------------------
@@ -176,7 +192,9 @@ C-------------------------------------------------------
      : primme_svds_op_none,
      : primme_svds_op_AtA,
      : primme_svds_op_AAt,
-     : primme_svds_op_augmented
+     : primme_svds_op_augmented,
+     : primme_svds_prec_prepare,
+     : primme_svds_prec_release
 
       parameter(
      : primme_svds_largest = 0,
@@ -185,5 +203,7 @@ C-------------------------------------------------------
      : primme_svds_op_none = 0,
      : primme_svds_op_AtA = 1,
      : primme_svds_op_AAt = 2,
-     : primme_svds_op_augmented = 3
+     : primme_svds_op_augmented = 3,
+     : primme_svds_prec_prepare = 0,
+     : primme_svds_prec_release = 1
      :)
@@ -35,11 +35,16 @@
 
 #include <assert.h>
 #include <math.h>
+#ifdef __linux__
+#  include <unistd.h>     /* sysconf */
+#  include <sys/mman.h>   /* madvise */
+#endif
 #include "const.h"
 #include "numerical.h"
 #include "globalsum.h"
 #include "auxiliary_eigs.h"
 #include "wtime.h"
+#include "trace.h"
 
 /******************************************************************************
  * Function Num_compute_residual - This subroutine performs the next operation
@@ -61,15 +66,55 @@ TEMPLATE_PLEASE
 void Num_compute_residual_Sprimme(PRIMME_INT n, SCALAR eval, SCALAR *x, 
    SCALAR *Ax, SCALAR *r) {
 
-   int k, M=min(n,PRIMME_BLOCK_SIZE);
+   PRIMME_INT k;
 
-   for (k=0; k<n; k+=M, M=min(M,n-k)) {
+   OMP_PRAGMA(omp parallel for if(n >= OMP_MIN_WORK))
+   for (k=0; k<n; k+=PRIMME_BLOCK_SIZE) {
+      int M = (int)min(PRIMME_BLOCK_SIZE, n-k);
       Num_copy_Sprimme(M, &Ax[k], 1, &r[k], 1);
       Num_axpy_Sprimme(M, -eval, &x[k], 1, &r[k], 1);
    }
 
 }
 
+/******************************************************************************
+ * Function Num_compute_residual_norm - This subroutine performs the next
+ *    operations in a single pass over x and Ax:
+ *
+ *    r = Ax - eval*x,
+ *    return r'*r
+ *
+ * PARAMETERS
+ * ---------------------------
+ * n           The number of rows of x, Ax and r
+ * eval        The value to compute the residual vector r
+ * x           The vector x
+ * Ax          The vector Ax
+ * r           On output r = Ax - eval*x (optional, may be Ax)
+ *
+ * RETURN VALUE
+ * ------------
+ * The local part of the squared norm of r; the caller reduces it among the
+ * processes.
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+REAL Num_compute_residual_norm_Sprimme(PRIMME_INT n, SCALAR eval, SCALAR *x,
+      SCALAR *Ax, SCALAR *r) {
+
+   PRIMME_INT k;
+   REAL norm2 = 0.0;
+
+   for (k=0; k<n; k++) {
+      SCALAR rk = Ax[k] - eval*x[k];
+      if (r) r[k] = rk;
+      norm2 += REAL_PART(CONJ(rk)*rk);
+   }
+
+   return norm2;
+}
+
 /******************************************************************************
  * Function Num_update_VWXR - This subroutine performs the next operations:
  *
@@ -109,8 +154,37 @@ void Num_compute_residual_Sprimme(PRIMME_INT n, SCALAR eval, SCALAR *x,
  * NOTE: n*e, n*b are zero-base indices of ranges where the first value is
  *       included and the last isn't.
  *
+ * NOTE: the outputs may be columns of V or W, as in a thick restart that
+ *       replaces V and W by V*h and W*h. Every panel of rows is computed
+ *       completely into a cache-sized buffer before it is copied back, so
+ *       no copy of V or W is needed.
+ *
+ * NOTE: if primme.basisPanelRows is positive, the threads go over V and W
+ *       together in panels of at least that many rows, and the next panel
+ *       is requested with page_basis before the current one is used.
+ *
  ******************************************************************************/
 
+/******************************************************************************
+ * Function panel_rows - return the number of rows of the panels that
+ *    Num_update_VWXR processes at once when the buffer holds ncols columns.
+ *    The result is PRIMME_BLOCK_SIZE halved until the buffer fits in
+ *    PRIMME_PANEL_CACHE_SIZE bytes, but never less than PRIMME_MIN_PANEL_SIZE
+ *    or more than m.
+ *
+ ******************************************************************************/
+
+static int panel_rows_Sprimme(PRIMME_INT m, int ncols) {
+
+   int rows = PRIMME_BLOCK_SIZE;
+
+   while (rows > PRIMME_MIN_PANEL_SIZE
+         && (size_t)rows*ncols*sizeof(SCALAR) > PRIMME_PANEL_CACHE_SIZE) {
+      rows /= 2;
+   }
+   return (int)min(rows, m);
+}
+
 TEMPLATE_PLEASE
 int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
       PRIMME_INT ldV, SCALAR *h, int nh, int ldh, REAL *hVals,
@@ -123,17 +197,28 @@ int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
       SCALAR *rwork, size_t lrwork, primme_params *primme) {
 
    PRIMME_INT i;     /* Loop variables */
-   int j;            /* Loop variables */
-   int m=min(PRIMME_BLOCK_SIZE, mV);   /* Number of rows in the cache */
-   int nXb, nXe, nYb, nYe, ldX, ldY;
-   SCALAR *X, *Y;
+   int j, t;         /* Loop variables */
+   int m;            /* Number of rows in the cache */
+   PRIMME_INT ms;    /* Number of rows in a panel of V and W, see page_basis */
+   int pageErr = 0;  /* Nonzero if page_basis failed in the parallel region */
+   int nt;           /* Number of threads */
+   int nXb, nXe, nYb, nYe, nnorms;
+   size_t ldwork;    /* Size of the workspace for each thread */
    REAL *tmp, *tmp0;
 
-   /* Return memory requirements */
+   /* Return memory requirements. The buffer has at most 2*nV columns  */
+   /* and the partial sums of at most 2*nV norms. Panels for fewer      */
+   /* columns may be taller, but they take no more than the cache size. */
+
    if (V == NULL) {
-      return 2*m*nV;
+      size_t panel = (size_t)panel_rows_Sprimme(mV, 2*nV)*2*nV;
+      panel = max(panel, PRIMME_PANEL_CACHE_SIZE/sizeof(SCALAR));
+      panel = min(panel, (size_t)max(0,mV)*2*nV);
+      return (int)((panel + 2*nV)*OMP_MAX_THREADS());
    }
 
+   double t0 = primme_get_wtime();
+
    /* R or Rnorms or rnorms imply W */
    assert(!(R || Rnorms || rnorms) || W);
 
@@ -142,66 +227,122 @@ int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
    nXe = max(max(max(X0?nX0e:0, X1?nX1e:0), R?nRe:0), rnorms?nre:0);
    nYb = min(min(Wo?nWob:INT_MAX, R?nRb:INT_MAX), rnorms?nrb:INT_MAX);
    nYe = max(max(Wo?nWoe:0, R?nRe:0), rnorms?nre:0);
+   nnorms = (Rnorms?nRe-nRb:0) + (rnorms?nre-nrb:0);
 
    assert(nXe <= nh || nXb >= nXe); /* Check dimension */
    assert(nYe <= nh || nYb >= nYe); /* Check dimension */
-   assert((size_t)(max(0,nXe-nXb)+max(0,nYe-nYb))*m <= lrwork);
-                                               /* Check workspace for X and Y */
+
+   /* Each thread works on blocks of m rows with its own copy of X and Y, */
+   /* and the partial sums of Rnorms and rnorms                           */
+
+   m = panel_rows_Sprimme(mV, max(0,nXe-nXb)+max(0,nYe-nYb));
+   nt = mV > 0 ? min(OMP_MAX_THREADS(), (int)((mV+m-1)/m)) : 1;
+   ldwork = (size_t)(max(0,nXe-nXb)+max(0,nYe-nYb))*m + nnorms;
+   assert(ldwork*nt <= lrwork);    /* Check workspace for X, Y and norms */
    assert(2u*(nRe-nRb+nre-nrb) <= lrwork); /* Check workspace for tmp and tmp0 */
 
-   X = rwork;
-   Y = rwork + m*(nXe-nXb);
-   ldX = ldY = m;
+   /* With panels of V and W, request the first one */
 
-   if (Rnorms) for (i=nRb; i<nRe; i++) Rnorms[i-nRb] = 0.0;
-   if (rnorms) for (i=nrb; i<nre; i++) rnorms[i-nrb] = 0.0;
+   ms = primme->basisPanelRows > 0 ?
+      (primme->basisPanelRows + m - 1)/m*m : max(mV, 1);
+   CHKERR(page_basis_Sprimme(V, ldV, 0, ms, nV, 1, primme), -1);
+   if (nYb < nYe) CHKERR(page_basis_Sprimme(W, ldV, 0, ms, nV, 1, primme), -1);
+
+   OMP_PRAGMA(omp parallel num_threads(nt) if(nt > 1) private(i, j))
+   {
+      SCALAR *X, *Y;
+      REAL *Rn, *rn;
+      int ldX, ldY, mi;
+      PRIMME_INT s;
+
+      X = rwork + ldwork*OMP_THREAD_NUM();
+      Y = X + m*max(0,nXe-nXb);
+      Rn = (REAL*)(Y + m*max(0,nYe-nYb));
+      rn = Rn + (Rnorms?nRe-nRb:0);
+      ldX = ldY = m;
+
+      for (j=0; j<nnorms; j++) Rn[j] = 0.0;
+
+      for (s=0; s < mV; s+=ms) {
+
+         /* Prefetch the next panel of V and W while the current one is used */
 
-   for (i=0; i < mV; i+=m, m=min(m,mV-i)) {
-      /* X = V*h(nXb:nXe-1) */
-      Num_gemm_Sprimme("N", "N", m, nXe-nXb, nV, 1.0,
-         &V[i], ldV, &h[nXb*ldh], ldh, 0.0, X, ldX);
-
-      /* X0 = X(nX0b-nXb:nX0e-nXb-1) */
-      if (X0) Num_copy_matrix_Sprimme(&X[ldX*(nX0b-nXb)], m, nX0e-nX0b,
-            ldX, &X0[i], ldX0);
-
-      /* X1 = X(nX1b-nXb:nX1e-nXb-1) */
-      if (X1) Num_copy_matrix_Sprimme(&X[ldX*(nX1b-nXb)], m, nX1e-nX1b,
-            ldX, &X1[i], ldX1);
-
-      /* X2 = X(nX2b-nXb:nX2e-nXb-1) */
-      if (X2) Num_copy_matrix_Sprimme(&X[ldX*(nX2b-nXb)], m, nX2e-nX2b,
-            ldX, &X2[i], ldX2);
-
-      /* Y = W*h(nYb:nYe-1) */
-      if (nYb < nYe) Num_gemm_Sprimme("N", "N", m, nYe-nYb, nV,
-            1.0, &W[i], ldV, &h[nYb*ldh], ldh, 0.0, Y, ldY);
-
-      /* Wo = Y(nWob-nYb:nWoe-nYb-1) */
-      if (Wo) Num_copy_matrix_Sprimme(&Y[ldY*(nWob-nYb)], m, nWoe-nWob,
-            ldY, &Wo[i], ldWo);
-
-      /* R = Y(nRb-nYb:nRe-nYb-1) - X(nRb-nYb:nRe-nYb-1)*diag(nRb:nRe-1) */
-      if (R) for (j=nRb; j<nRe; j++) {
-         Num_compute_residual_Sprimme(m, hVals[j], &X[ldX*(j-nXb)], &Y[ldY*(j-nYb)],
-               &R[i+ldR*(j-nRb)]);
-         if (Rnorms) {
-            Rnorms[j-nRb] +=
-               REAL_PART(Num_dot_Sprimme(m, &R[i+ldR*(j-nRb)], 1,
-                        &R[i+ldR*(j-nRb)], 1));
+         OMP_PRAGMA(omp single nowait)
+         {
+            if (ms < mV && (page_basis_Sprimme(V, ldV, s+ms, ms, nV, 1,
+                        primme) || (nYb < nYe && page_basis_Sprimme(W, ldV,
+                              s+ms, ms, nV, 1, primme)))) {
+               pageErr = 1;
+            }
          }
-      }
 
-      /* rnorms = Y(nrb-nYb:nre-nYb-1) - X(nrb-nYb:nre-nYb-1)*diag(nrb:nre-1) */
-      if (rnorms) for (j=nrb; j<nre; j++) {
-         Num_compute_residual_Sprimme(m, hVals[j], &X[ldX*(j-nXb)], &Y[ldY*(j-nYb)],
-               &Y[ldY*(j-nYb)]);
-         rnorms[j-nrb] += 
-            REAL_PART(Num_dot_Sprimme(m, &Y[ldY*(j-nYb)], 1,
-                     &Y[ldY*(j-nYb)], 1));
+         OMP_PRAGMA(omp for schedule(static))
+         for (i=s; i < min(s+ms, mV); i+=m) {
+            mi = (int)min(m, mV-i);
+
+            /* X = V*h(nXb:nXe-1) */
+            Num_gemm_Sprimme("N", "N", mi, nXe-nXb, nV, 1.0,
+               &V[i], ldV, &h[nXb*ldh], ldh, 0.0, X, ldX);
+
+            /* X0 = X(nX0b-nXb:nX0e-nXb-1) */
+            if (X0) Num_copy_matrix_Sprimme(&X[ldX*(nX0b-nXb)], mi, nX0e-nX0b,
+                  ldX, &X0[i], ldX0);
+
+            /* X1 = X(nX1b-nXb:nX1e-nXb-1) */
+            if (X1) Num_copy_matrix_Sprimme(&X[ldX*(nX1b-nXb)], mi, nX1e-nX1b,
+                  ldX, &X1[i], ldX1);
+
+            /* X2 = X(nX2b-nXb:nX2e-nXb-1) */
+            if (X2) Num_copy_matrix_Sprimme(&X[ldX*(nX2b-nXb)], mi, nX2e-nX2b,
+                  ldX, &X2[i], ldX2);
+
+            /* Y = W*h(nYb:nYe-1) */
+            if (nYb < nYe) Num_gemm_Sprimme("N", "N", mi, nYe-nYb, nV,
+                  1.0, &W[i], ldV, &h[nYb*ldh], ldh, 0.0, Y, ldY);
+
+            /* Wo = Y(nWob-nYb:nWoe-nYb-1) */
+            if (Wo) Num_copy_matrix_Sprimme(&Y[ldY*(nWob-nYb)], mi, nWoe-nWob,
+                  ldY, &Wo[i], ldWo);
+
+            /* R = Y(nRb-nYb:nRe-nYb-1) - X(nRb-nYb:nRe-nYb-1)*diag(nRb:nRe-1) */
+            if (R) for (j=nRb; j<nRe; j++) {
+               REAL norm2 = Num_compute_residual_norm_Sprimme(mi, hVals[j],
+                     &X[ldX*(j-nXb)], &Y[ldY*(j-nYb)], &R[i+ldR*(j-nRb)]);
+               if (Rnorms) Rn[j-nRb] += norm2;
+            }
+
+            /* rnorms = Y(nrb-nYb:nre-nYb-1) - X(nrb-nYb:nre-nYb-1)*diag(nrb:nre-1) */
+            if (rnorms) for (j=nrb; j<nre; j++) {
+               rn[j-nrb] += Num_compute_residual_norm_Sprimme(mi, hVals[j],
+                     &X[ldX*(j-nXb)], &Y[ldY*(j-nYb)], NULL);
+            }
+         }
+
+         /* Release the panel after all threads are done with it */
+
+         OMP_PRAGMA(omp single)
+         {
+            if (ms < mV && (page_basis_Sprimme(V, ldV, s, ms, nV, 0, primme)
+                     || (nYb < nYe && page_basis_Sprimme(W, ldV, s, ms, nV, 0,
+                           primme)))) {
+               pageErr = 1;
+            }
+         }
       }
    }
 
+   CHKERR(pageErr, -1);
+
+   /* Add up the partial sums of the threads in the same order every time */
+
+   if (Rnorms) for (i=nRb; i<nRe; i++) Rnorms[i-nRb] = 0.0;
+   if (rnorms) for (i=nrb; i<nre; i++) rnorms[i-nrb] = 0.0;
+   for (t=0; t<nt; t++) {
+      tmp = (REAL*)(rwork + ldwork*t + ldwork - nnorms);
+      if (Rnorms) for (i=nRb; i<nRe; i++) Rnorms[i-nRb] += *(tmp++);
+      if (rnorms) for (i=nrb; i<nre; i++) rnorms[i-nrb] += *(tmp++);
+   }
+
    /* Reduce Rnorms and rnorms and sqrt the results */
 
    if (primme->numProcs > 1) {
@@ -220,9 +361,100 @@ int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
       if (rnorms) for (i=nrb; i<nre; i++) rnorms[i-nrb] = sqrt(rnorms[i-nrb]);
    }
 
+   primme->stats.timeUpdateVWXR += primme_get_wtime() - t0;
+
    return 0; 
 }
 
+/******************************************************************************
+ * Function Num_first_touch_matrix - zero the matrix x, with every thread
+ *    zeroing the blocks of rows that it updates in Num_update_VWXR. On NUMA
+ *    systems with first-touch page placement, the pages of x then live on
+ *    the memory of the thread that works on them.
+ *
+ * PARAMETERS
+ * ---------------------------
+ * x           The matrix
+ * m           The number of rows of x
+ * n           The number of columns of x
+ * ldx         The leading dimension of x
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+void Num_first_touch_matrix_Sprimme(SCALAR *x, PRIMME_INT m, int n,
+      PRIMME_INT ldx) {
+
+   PRIMME_INT i, k;
+   int j;
+   int mb=min(PRIMME_BLOCK_SIZE, m);   /* Number of rows in each block */
+   int nt;                             /* Number of threads           */
+
+   if (m <= 0 || n <= 0) return;
+
+   /* Use the same threads and static schedule as Num_update_VWXR */
+
+   nt = min(OMP_MAX_THREADS(), (int)((m+mb-1)/mb));
+   (void)nt;
+
+   OMP_PRAGMA(omp parallel for num_threads(nt) if(nt > 1) private(j, k) schedule(static))
+   for (i=0; i < m; i+=mb) {
+      PRIMME_INT mi = min(mb, m-i);
+      for (j=0; j<n; j++)
+         for (k=0; k<mi; k++)
+            x[ldx*j+i+k] = 0.0;
+   }
+}
+
+/*******************************************************************************
+ * Subroutine apply_rowmajor - apply the user's operator op on the block V
+ *    in row-major (interleaved) layout, as asked by primme.rowMajorOPs: the
+ *    element i of the vector j is at x[i*ldx+j], with ldx = blockSize. V is
+ *    transposed into a temporary array, and the result into W, except for a
+ *    single vector, which has the same layout in both orders.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * op         The user's operator
+ * V          The input vectors
+ * nLocal     Number of rows of each vector stored on this node
+ * ldV        The leading dimension of V
+ * ldW        The leading dimension of W
+ * blockSize  The number of columns of V and W.
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * W          op(V)
+ * ierr       The error code returned by op
+ *
+ * Return value: -1 if the temporary array could not be allocated; otherwise 0
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int apply_rowmajor_Sprimme(primme_operator op, SCALAR *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW, int blockSize, int *ierr,
+      primme_params *primme) {
+
+   PRIMME_INT ld = blockSize;
+   SCALAR *X, *Y;          /* V and W in row-major layout */
+
+   if (blockSize == 1) {
+      op(V, &ld, W, &ld, &blockSize, primme, ierr);
+      return 0;
+   }
+
+   CHKERR(MALLOC_PRIMME((size_t)nLocal*blockSize*2, &X), -1);
+   Y = X + (size_t)nLocal*blockSize;
+   Num_transpose_matrix_Sprimme(V, nLocal, blockSize, ldV, X, ld);
+   op(X, &ld, Y, &ld, &blockSize, primme, ierr);
+   if (*ierr == 0) {
+      Num_transpose_matrix_Sprimme(Y, blockSize, nLocal, ld, W, ldW);
+   }
+   free(X);
+
+   return 0;
+}
+
 /*******************************************************************************
  * Subroutine applyPreconditioner - apply preconditioner to V
  *
@@ -237,6 +469,12 @@ int Num_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV, int nV,
  * INPUT/OUTPUT ARRAYS
  * -------------------
  * W          M*V
+ *
+ * The user's applyPreconditioner is called once for the whole block, with
+ * primme.ShiftsForPreconditioner[i] the shift for the i-th vector. If ldOPs
+ * is set and differs from ldV or ldW, V and W are copied into arrays with
+ * leading dimension ldOPs to keep doing a single call. If rowMajorOPs is set,
+ * the block is passed in row-major layout instead.
  ******************************************************************************/
 
 TEMPLATE_PLEASE
@@ -245,24 +483,51 @@ int applyPreconditioner_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
 
    int i, ONE=1, ierr=0;
    double t0;
+   SCALAR *X, *Y;          /* copies of V and W with leading dimension ldOPs */
 
    if (blockSize <= 0) return 0;
    assert(primme->nLocal == nLocal);
 
-   t0 = primme_wTimer(0);
+   t0 = primme_get_wtime();
 
    if (primme->correctionParams.precondition) {
-      if (primme->ldOPs == 0
+      if (primme->rowMajorOPs) {
+         CHKERR(apply_rowmajor_Sprimme(primme->applyPreconditioner, V, nLocal,
+                  ldV, W, ldW, blockSize, &ierr, primme), -1);
+         CHKERRM(ierr, -1, "Error returned by 'applyPreconditioner' %d", ierr);
+      }
+      else if (primme->ldOPs == 0
             || (ldV == primme->ldOPs && ldW == primme->ldOPs)) {
          CHKERRM((primme->applyPreconditioner(V, &ldV, W, &ldW, &blockSize,
                      primme, &ierr), ierr), -1,
                "Error returned by 'applyPreconditioner' %d", ierr);
       }
+      else if (MALLOC_PRIMME((size_t)primme->ldOPs*blockSize*2, &X) == 0) {
+         /* Copy V into X with leading dimension ldOPs, so that the whole  */
+         /* block is preconditioned in a single call                       */
+         Y = X + (size_t)primme->ldOPs*blockSize;
+         Num_copy_matrix_Sprimme(V, nLocal, blockSize, ldV, X, primme->ldOPs);
+         ierr = 0;
+         primme->applyPreconditioner(X, &primme->ldOPs, Y, &primme->ldOPs,
+               &blockSize, primme, &ierr);
+         if (ierr == 0) {
+            Num_copy_matrix_Sprimme(Y, nLocal, blockSize, primme->ldOPs, W,
+                  ldW);
+         }
+         free(X);
+         CHKERRM(ierr, -1, "Error returned by 'applyPreconditioner' %d", ierr);
+      }
       else {
+         /* Not enough memory for the copies: precondition one vector at a */
+         /* time, pointing ShiftsForPreconditioner to the vector's shift   */
+         double *shifts = primme->ShiftsForPreconditioner;
          for (i=0; i<blockSize; i++) {
-            CHKERRM((primme->applyPreconditioner(&V[ldV*i], &primme->ldOPs,
-                        &W[ldW*i], &primme->ldOPs, &ONE, primme, &ierr), ierr),
-                  -1, "Error returned by 'applyPreconditioner' %d", ierr);
+            if (shifts) primme->ShiftsForPreconditioner = &shifts[i];
+            primme->applyPreconditioner(&V[ldV*i], &primme->ldOPs,
+                  &W[ldW*i], &primme->ldOPs, &ONE, primme, &ierr);
+            primme->ShiftsForPreconditioner = shifts;
+            CHKERRM(ierr, -1, "Error returned by 'applyPreconditioner' %d",
+                  ierr);
          }
       }
       primme->stats.numPreconds += blockSize;
@@ -271,7 +536,8 @@ int applyPreconditioner_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       Num_copy_matrix_Sprimme(V, nLocal, blockSize, ldV, W, ldW);
    }
 
-   primme->stats.timePrecond += primme_wTimer(0) - t0;
+   primme->stats.timePrecond += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_PRECOND, t0);
 
    return 0;
 }
@@ -304,3 +570,312 @@ int convTestFun_Sprimme(REAL eval, SCALAR *evec, REAL rNorm, int *isconv,
 
    return 0;
 }
+
+/*******************************************************************************
+ * Subroutine convTestFunBlock - wrapper around primme.convTestFunBlock;
+ *    evaluate if the approximate eigenpairs evals, evecs with given residual
+ *    norms are considered as converged.
+ *
+ * INPUT PARAMETERS
+ * ----------------
+ * evals     the eigenvalues
+ * evecs     the eigenvectors
+ * ldevecs   the leading dimension of evecs
+ * rNorms    the residual vector norms
+ * blockSize the number of pairs
+ * 
+ * INPUT/OUTPUT
+ * ------------
+ * isconv    on input, the pairs with non-zero are not evaluated; on output,
+ *           if non-zero, the pair is considered converged.
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int convTestFunBlock_Sprimme(REAL *evals, SCALAR *evecs, PRIMME_INT ldevecs,
+      REAL *rNorms, int *isconv, int blockSize, struct primme_params *primme) {
+
+   int ierr=0;
+
+   CHKERRM((primme->convTestFunBlock(evals, evecs, &ldevecs, rNorms, isconv,
+                  &blockSize, primme, &ierr), ierr), -1,
+         "Error returned by 'convTestFunBlock' %d", ierr);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function monitor_filter - return whether the event should be reported to
+ *    primme.monitorFun: the event is not masked out in primme.monitorEvents,
+ *    and, for the outer and inner iteration events, at least
+ *    primme.monitorInterval seconds have passed since the last reported event
+ *    (primme.stats.elapsedTime is updated on every report).
+ *
+ * INPUT PARAMETERS
+ * ----------------
+ * event     the event to report
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int monitor_filter_Sprimme(primme_event event, struct primme_params *primme) {
+
+   if (!primme->monitorFun || !(primme->monitorEvents & (1 << (int)event))) {
+      return 0;
+   }
+   if ((event == primme_event_outer_iteration
+            || event == primme_event_inner_iteration)
+         && primme->monitorInterval > 0.0
+         && primme_get_wtime() - primme->startTime
+               - primme->stats.elapsedTime < primme->monitorInterval) {
+      return 0;
+   }
+   return 1;
+}
+
+/*******************************************************************************
+ * Function checkpoint - Call primme.checkpointFun to store (mode 0) or to
+ *    restore (mode 1) the basis V and W = A*V.
+ *
+ * INPUT/OUTPUT PARAMETERS
+ * -----------------------
+ * V, W       The basis and A*V
+ * basisSize  The number of columns in V and W; on restoring, the number of
+ *            columns restored, at most primme.maxBasisSize
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int checkpoint_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
+      int *basisSize, int mode, primme_params *primme) {
+
+   int ierr = 0;
+
+   CHKERRM((primme->checkpointFun(V, &ldV, W, &ldW, basisSize, &mode, primme,
+               &ierr), ierr), -1, "Error returned by 'checkpointFun' %d", ierr);
+   CHKERRM(*basisSize < 0 || *basisSize > primme->maxBasisSize, -1,
+         "Invalid basis size %d returned by 'checkpointFun'", *basisSize);
+
+   return 0;
+}
+
+/******************************************************************************
+ * Function page_locked - Announce that a panel of locked vectors is going to
+ *    be used (needed=1) or that it is not going to be used soon (needed=0).
+ *    If primme.lockedPaging is set, it is called with the panel. Otherwise the
+ *    OS is advised to read in the pages of a needed panel, which only helps
+ *    if evecs is memory-mapped; a panel that is not needed is left alone.
+ *
+ ******************************************************************************/
+
+static int page_locked_Sprimme(SCALAR *panel, PRIMME_INT ldpanel,
+      int numCols, int needed, primme_params *primme) {
+
+   if (numCols <= 0) return 0;
+
+   if (primme->lockedPaging) {
+      int ierr = 0;
+      CHKERRM((primme->lockedPaging(panel, &ldpanel, &numCols, &needed, primme,
+                  &ierr), ierr), -1, "Error returned by 'lockedPaging' %d",
+            ierr);
+   }
+#if defined(__linux__) && defined(MADV_WILLNEED)
+   else if (needed) {
+      /* This is only an advice: ignore failures */
+      uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+      uintptr_t begin = (uintptr_t)panel & ~(page - 1);
+      uintptr_t end = (uintptr_t)&panel[ldpanel*(numCols-1) + primme->nLocal];
+      madvise((void*)begin, end - begin, MADV_WILLNEED);
+   }
+#endif
+
+   return 0;
+}
+
+/******************************************************************************
+ * Function page_basis - Announce that the rows row0 to row0+numRows-1 of the
+ *    first numCols columns of V or W are going to be used (needed=1) or that
+ *    they are not going to be used soon (needed=0), as page_locked does for
+ *    the locked vectors. It does nothing unless primme.basisPanelRows is
+ *    positive.
+ *
+ * PARAMETERS
+ * ---------------------------
+ * V, ldV      The matrix and its leading dimension
+ * row0        The first row of the panel
+ * numRows     The number of rows of the panel; it is cropped to nLocal
+ * numCols     The number of columns
+ * needed      Whether the panel is going to be used
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int page_basis_Sprimme(SCALAR *V, PRIMME_INT ldV, PRIMME_INT row0,
+      PRIMME_INT numRows, int numCols, int needed, primme_params *primme) {
+
+   numRows = min(numRows, primme->nLocal - row0);
+   if (primme->basisPanelRows <= 0 || !V || numRows <= 0 || numCols <= 0) {
+      return 0;
+   }
+
+   if (primme->basisPaging) {
+      int ierr = 0;
+      CHKERRM((primme->basisPaging(&V[row0], &ldV, &numRows, &numCols,
+                  &needed, primme, &ierr), ierr), -1,
+            "Error returned by 'basisPaging' %d", ierr);
+   }
+#if defined(__linux__) && defined(MADV_WILLNEED)
+   else if (needed) {
+      /* This is only an advice: ignore failures */
+      uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+      int j;
+      for (j=0; j < numCols; j++) {
+         uintptr_t begin = (uintptr_t)&V[ldV*j+row0] & ~(page - 1);
+         uintptr_t end = (uintptr_t)&V[ldV*j+row0+numRows];
+         madvise((void*)begin, end - begin, MADV_WILLNEED);
+      }
+   }
+#endif
+
+   return 0;
+}
+
+#ifdef USE_LOWER_INNER
+#  define Num_gemm_Lprimme CONCAT(Num_gemm_,LSCALAR_SUF)
+
+/******************************************************************************
+ * Function Num_gemm_locked_lower - Compute the product of Num_gemm_locked
+ *    with the single precision copy of Q in primme.lockedCopy, if Q are
+ *    columns of primme.lockedCopyOf (see primme.lockedSinglePrecision). The
+ *    columns of the copy are rounded from evecs the first time they are used,
+ *    so they should not change after that, as it happens with the locked
+ *    vectors and the constraints. B is rounded to single precision, and the
+ *    product is accumulated into C in SCALAR.
+ *
+ * Return 1 if Q is not in lockedCopyOf, 0 if the product is done, and a
+ * negative value on error.
+ *
+ ******************************************************************************/
+
+static int Num_gemm_locked_lower(int trans, int numCols, int n, SCALAR alpha,
+      SCALAR *Q, PRIMME_INT ldQ, SCALAR *B, PRIMME_INT ldB, SCALAR beta,
+      SCALAR *C, PRIMME_INT ldC, primme_params *primme) {
+
+   PRIMME_INT nLocal = primme->nLocal, i;
+   SCALAR *evecs = (SCALAR*)primme->lockedCopyOf;
+   LSCALAR *Qf, *Bf, *Cf;
+   int q0, j, m = trans ? numCols : (int)nLocal, k = trans ? (int)nLocal :
+      numCols;
+
+   /* Find the first column of Q in evecs */
+
+   if (ldQ != primme->ldevecs || Q < evecs || (Q - evecs) % ldQ != 0) return 1;
+   q0 = (int)((Q - evecs) / ldQ);
+   if (q0 + numCols > primme->numOrthoConst + primme->numEvals) return 1;
+
+   /* Round the columns not copied yet */
+
+   Qf = (LSCALAR*)primme->lockedCopy;
+   for (j=primme->lockedCopyCols; j < q0 + numCols; j++) {
+      for (i=0; i < nLocal; i++) {
+         Qf[nLocal*j+i] = (LSCALAR)evecs[ldQ*j+i];
+      }
+   }
+   primme->lockedCopyCols = max(primme->lockedCopyCols, q0 + numCols);
+
+   CHKERR(MALLOC_PRIMME((size_t)(k + m)*n + 1, &Bf), -1);
+   Cf = Bf + (size_t)k*n;
+
+   for (j=0; j < n; j++) {
+      for (i=0; i < k; i++) Bf[(size_t)k*j+i] = (LSCALAR)B[ldB*j+i];
+   }
+   Num_gemm_Lprimme(trans ? "C" : "N", "N", m, n, k, 1.0, &Qf[nLocal*q0],
+         (int)nLocal, Bf, k, 0.0, Cf, m);
+   for (j=0; j < n; j++) {
+      for (i=0; i < m; i++) {
+         C[ldC*j+i] = alpha*(SCALAR)Cf[(size_t)m*j+i]
+            + (beta == (SCALAR)0.0 ? (SCALAR)0.0 : beta*C[ldC*j+i]);
+      }
+   }
+
+   free(Bf);
+   return 0;
+}
+#endif /* USE_LOWER_INNER */
+
+/******************************************************************************
+ * Function Num_gemm_locked - This subroutine computes one of the products
+ *    with the locked vectors Q,
+ *
+ *    C = alpha*Q'*B + beta*C, if transa is "C", or
+ *    C = alpha*Q*B + beta*C,  if transa is "N",
+ *
+ *    where Q has nLocal rows and numCols columns. If primme.lockedPanelSize is
+ *    positive, Q is read in panels of that many columns, and the next panel
+ *    is requested with page_locked before the current one is used, so that
+ *    only a few panels of Q have to be in memory at once. With
+ *    primme.lockedSinglePrecision, the products with evecs use instead its
+ *    single precision copy (see Num_gemm_locked_lower).
+ *
+ * PARAMETERS
+ * ---------------------------
+ * transa      "C" or "N"
+ * numCols     The number of columns of Q
+ * n           The number of columns of B and C
+ * Q, ldQ      The locked vectors and their leading dimension
+ * B, ldB      The matrix B and its leading dimension
+ * C, ldC      The matrix C and its leading dimension
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int Num_gemm_locked_Sprimme(const char *transa, int numCols, int n,
+      SCALAR alpha, SCALAR *Q, PRIMME_INT ldQ, SCALAR *B, PRIMME_INT ldB,
+      SCALAR beta, SCALAR *C, PRIMME_INT ldC, primme_params *primme) {
+
+   int p0;        /* first column of the current panel */
+   int panel = primme->lockedPanelSize;
+   int trans = (*transa == 'C' || *transa == 'c');
+
+#ifdef USE_LOWER_INNER
+   if (primme->lockedCopy && numCols > 0) {
+      int ret = Num_gemm_locked_lower(trans, numCols, n, alpha, Q, ldQ, B,
+            ldB, beta, C, ldC, primme);
+      if (ret <= 0) return ret;
+   }
+#endif
+
+   if (panel <= 0 || panel >= numCols) {
+      if (trans) {
+         Num_gemm_Sprimme("C", "N", numCols, n, primme->nLocal, alpha, Q, ldQ,
+               B, ldB, beta, C, ldC);
+      }
+      else {
+         Num_gemm_Sprimme("N", "N", primme->nLocal, n, numCols, alpha, Q, ldQ,
+               B, ldB, beta, C, ldC);
+      }
+      return 0;
+   }
+
+   CHKERR(page_locked_Sprimme(Q, ldQ, panel, 1, primme), -1);
+   for (p0=0; p0 < numCols; p0+=panel) {
+      int np = min(panel, numCols-p0);
+
+      /* Prefetch the next panel while the current one is used */
+
+      CHKERR(page_locked_Sprimme(&Q[ldQ*(p0+np)], ldQ,
+               min(panel, numCols-p0-np), 1, primme), -1);
+
+      if (trans) {
+         /* C(p0:p0+np-1,:) = alpha*Q(:,p0:p0+np-1)'*B + beta*C(p0:p0+np-1,:) */
+         Num_gemm_Sprimme("C", "N", np, n, primme->nLocal, alpha, &Q[ldQ*p0],
+               ldQ, B, ldB, beta, &C[p0], ldC);
+      }
+      else {
+         /* C = alpha*Q(:,p0:p0+np-1)*B(p0:p0+np-1,:) + C */
+         Num_gemm_Sprimme("N", "N", primme->nLocal, n, np, alpha, &Q[ldQ*p0],
+               ldQ, &B[p0], ldB, p0 == 0 ? beta : (SCALAR)1.0, C, ldC);
+      }
+
+      CHKERR(page_locked_Sprimme(&Q[ldQ*p0], ldQ, np, 0, primme), -1);
+   }
+
+   return 0;
+}
@@ -41,6 +41,14 @@
 #endif
 void Num_compute_residual_dprimme(PRIMME_INT n, double eval, double *x,
    double *Ax, double *r);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_compute_residual_norm_Sprimme)
+#  define Num_compute_residual_norm_Sprimme CONCAT(Num_compute_residual_norm_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_compute_residual_norm_Rprimme)
+#  define Num_compute_residual_norm_Rprimme CONCAT(Num_compute_residual_norm_,REAL_SUF)
+#endif
+double Num_compute_residual_norm_dprimme(PRIMME_INT n, double eval, double *x,
+      double *Ax, double *r);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_update_VWXR_Sprimme)
 #  define Num_update_VWXR_Sprimme CONCAT(Num_update_VWXR_,SCALAR_SUF)
 #endif
@@ -56,6 +64,23 @@ int Num_update_VWXR_dprimme(double *V, double *W, PRIMME_INT mV, int nV,
       double *R, int nRb, int nRe, PRIMME_INT ldR, double *Rnorms,
       double *rnorms, int nrb, int nre,
       double *rwork, size_t lrwork, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_first_touch_matrix_Sprimme)
+#  define Num_first_touch_matrix_Sprimme CONCAT(Num_first_touch_matrix_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_first_touch_matrix_Rprimme)
+#  define Num_first_touch_matrix_Rprimme CONCAT(Num_first_touch_matrix_,REAL_SUF)
+#endif
+void Num_first_touch_matrix_dprimme(double *x, PRIMME_INT m, int n,
+      PRIMME_INT ldx);
+#if !defined(CHECK_TEMPLATE) && !defined(apply_rowmajor_Sprimme)
+#  define apply_rowmajor_Sprimme CONCAT(apply_rowmajor_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(apply_rowmajor_Rprimme)
+#  define apply_rowmajor_Rprimme CONCAT(apply_rowmajor_,REAL_SUF)
+#endif
+int apply_rowmajor_dprimme(primme_operator op, double *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, double *W, PRIMME_INT ldW, int blockSize, int *ierr,
+      primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(applyPreconditioner_Sprimme)
 #  define applyPreconditioner_Sprimme CONCAT(applyPreconditioner_,SCALAR_SUF)
 #endif
@@ -72,8 +97,50 @@ int applyPreconditioner_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
 #endif
 int convTestFun_dprimme(double eval, double *evec, double rNorm, int *isconv,
       struct primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(convTestFunBlock_Sprimme)
+#  define convTestFunBlock_Sprimme CONCAT(convTestFunBlock_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(convTestFunBlock_Rprimme)
+#  define convTestFunBlock_Rprimme CONCAT(convTestFunBlock_,REAL_SUF)
+#endif
+int convTestFunBlock_dprimme(double *evals, double *evecs, PRIMME_INT ldevecs,
+      double *rNorms, int *isconv, int blockSize, struct primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(monitor_filter_Sprimme)
+#  define monitor_filter_Sprimme CONCAT(monitor_filter_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(monitor_filter_Rprimme)
+#  define monitor_filter_Rprimme CONCAT(monitor_filter_,REAL_SUF)
+#endif
+int monitor_filter_dprimme(primme_event event, struct primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(checkpoint_Sprimme)
+#  define checkpoint_Sprimme CONCAT(checkpoint_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(checkpoint_Rprimme)
+#  define checkpoint_Rprimme CONCAT(checkpoint_,REAL_SUF)
+#endif
+int checkpoint_dprimme(double *V, PRIMME_INT ldV, double *W, PRIMME_INT ldW,
+      int *basisSize, int mode, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(page_basis_Sprimme)
+#  define page_basis_Sprimme CONCAT(page_basis_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(page_basis_Rprimme)
+#  define page_basis_Rprimme CONCAT(page_basis_,REAL_SUF)
+#endif
+int page_basis_dprimme(double *V, PRIMME_INT ldV, PRIMME_INT row0,
+      PRIMME_INT numRows, int numCols, int needed, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_gemm_locked_Sprimme)
+#  define Num_gemm_locked_Sprimme CONCAT(Num_gemm_locked_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_gemm_locked_Rprimme)
+#  define Num_gemm_locked_Rprimme CONCAT(Num_gemm_locked_,REAL_SUF)
+#endif
+int Num_gemm_locked_dprimme(const char *transa, int numCols, int n,
+      double alpha, double *Q, PRIMME_INT ldQ, double *B, PRIMME_INT ldB,
+      double beta, double *C, PRIMME_INT ldC, primme_params *primme);
 void Num_compute_residual_zprimme(PRIMME_INT n, PRIMME_COMPLEX_DOUBLE eval, PRIMME_COMPLEX_DOUBLE *x,
    PRIMME_COMPLEX_DOUBLE *Ax, PRIMME_COMPLEX_DOUBLE *r);
+double Num_compute_residual_norm_zprimme(PRIMME_INT n, PRIMME_COMPLEX_DOUBLE eval, PRIMME_COMPLEX_DOUBLE *x,
+      PRIMME_COMPLEX_DOUBLE *Ax, PRIMME_COMPLEX_DOUBLE *r);
 int Num_update_VWXR_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT mV, int nV,
       PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *h, int nh, int ldh, double *hVals,
       PRIMME_COMPLEX_DOUBLE *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
@@ -83,12 +150,29 @@ int Num_update_VWXR_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W,
       PRIMME_COMPLEX_DOUBLE *R, int nRb, int nRe, PRIMME_INT ldR, double *Rnorms,
       double *rnorms, int nrb, int nre,
       PRIMME_COMPLEX_DOUBLE *rwork, size_t lrwork, primme_params *primme);
+void Num_first_touch_matrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m, int n,
+      PRIMME_INT ldx);
+int apply_rowmajor_zprimme(primme_operator op, PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, int blockSize, int *ierr,
+      primme_params *primme);
 int applyPreconditioner_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, int blockSize, primme_params *primme);
 int convTestFun_zprimme(double eval, PRIMME_COMPLEX_DOUBLE *evec, double rNorm, int *isconv,
       struct primme_params *primme);
+int convTestFunBlock_zprimme(double *evals, PRIMME_COMPLEX_DOUBLE *evecs, PRIMME_INT ldevecs,
+      double *rNorms, int *isconv, int blockSize, struct primme_params *primme);
+int monitor_filter_zprimme(primme_event event, struct primme_params *primme);
+int checkpoint_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW,
+      int *basisSize, int mode, primme_params *primme);
+int page_basis_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV, PRIMME_INT row0,
+      PRIMME_INT numRows, int numCols, int needed, primme_params *primme);
+int Num_gemm_locked_zprimme(const char *transa, int numCols, int n,
+      PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOUBLE *Q, PRIMME_INT ldQ, PRIMME_COMPLEX_DOUBLE *B, PRIMME_INT ldB,
+      PRIMME_COMPLEX_DOUBLE beta, PRIMME_COMPLEX_DOUBLE *C, PRIMME_INT ldC, primme_params *primme);
 void Num_compute_residual_sprimme(PRIMME_INT n, float eval, float *x,
    float *Ax, float *r);
+float Num_compute_residual_norm_sprimme(PRIMME_INT n, float eval, float *x,
+      float *Ax, float *r);
 int Num_update_VWXR_sprimme(float *V, float *W, PRIMME_INT mV, int nV,
       PRIMME_INT ldV, float *h, int nh, int ldh, float *hVals,
       float *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
@@ -98,12 +182,29 @@ int Num_update_VWXR_sprimme(float *V, float *W, PRIMME_INT mV, int nV,
       float *R, int nRb, int nRe, PRIMME_INT ldR, float *Rnorms,
       float *rnorms, int nrb, int nre,
       float *rwork, size_t lrwork, primme_params *primme);
+void Num_first_touch_matrix_sprimme(float *x, PRIMME_INT m, int n,
+      PRIMME_INT ldx);
+int apply_rowmajor_sprimme(primme_operator op, float *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, float *W, PRIMME_INT ldW, int blockSize, int *ierr,
+      primme_params *primme);
 int applyPreconditioner_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       float *W, PRIMME_INT ldW, int blockSize, primme_params *primme);
 int convTestFun_sprimme(float eval, float *evec, float rNorm, int *isconv,
       struct primme_params *primme);
+int convTestFunBlock_sprimme(float *evals, float *evecs, PRIMME_INT ldevecs,
+      float *rNorms, int *isconv, int blockSize, struct primme_params *primme);
+int monitor_filter_sprimme(primme_event event, struct primme_params *primme);
+int checkpoint_sprimme(float *V, PRIMME_INT ldV, float *W, PRIMME_INT ldW,
+      int *basisSize, int mode, primme_params *primme);
+int page_basis_sprimme(float *V, PRIMME_INT ldV, PRIMME_INT row0,
+      PRIMME_INT numRows, int numCols, int needed, primme_params *primme);
+int Num_gemm_locked_sprimme(const char *transa, int numCols, int n,
+      float alpha, float *Q, PRIMME_INT ldQ, float *B, PRIMME_INT ldB,
+      float beta, float *C, PRIMME_INT ldC, primme_params *primme);
 void Num_compute_residual_cprimme(PRIMME_INT n, PRIMME_COMPLEX_FLOAT eval, PRIMME_COMPLEX_FLOAT *x,
    PRIMME_COMPLEX_FLOAT *Ax, PRIMME_COMPLEX_FLOAT *r);
+float Num_compute_residual_norm_cprimme(PRIMME_INT n, PRIMME_COMPLEX_FLOAT eval, PRIMME_COMPLEX_FLOAT *x,
+      PRIMME_COMPLEX_FLOAT *Ax, PRIMME_COMPLEX_FLOAT *r);
 int Num_update_VWXR_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT mV, int nV,
       PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *h, int nh, int ldh, float *hVals,
       PRIMME_COMPLEX_FLOAT *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
@@ -113,8 +214,23 @@ int Num_update_VWXR_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PR
       PRIMME_COMPLEX_FLOAT *R, int nRb, int nRe, PRIMME_INT ldR, float *Rnorms,
       float *rnorms, int nrb, int nre,
       PRIMME_COMPLEX_FLOAT *rwork, size_t lrwork, primme_params *primme);
+void Num_first_touch_matrix_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, int n,
+      PRIMME_INT ldx);
+int apply_rowmajor_cprimme(primme_operator op, PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, int blockSize, int *ierr,
+      primme_params *primme);
 int applyPreconditioner_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, int blockSize, primme_params *primme);
 int convTestFun_cprimme(float eval, PRIMME_COMPLEX_FLOAT *evec, float rNorm, int *isconv,
       struct primme_params *primme);
+int convTestFunBlock_cprimme(float *evals, PRIMME_COMPLEX_FLOAT *evecs, PRIMME_INT ldevecs,
+      float *rNorms, int *isconv, int blockSize, struct primme_params *primme);
+int monitor_filter_cprimme(primme_event event, struct primme_params *primme);
+int checkpoint_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW,
+      int *basisSize, int mode, primme_params *primme);
+int page_basis_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV, PRIMME_INT row0,
+      PRIMME_INT numRows, int numCols, int needed, primme_params *primme);
+int Num_gemm_locked_cprimme(const char *transa, int numCols, int n,
+      PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOAT *Q, PRIMME_INT ldQ, PRIMME_COMPLEX_FLOAT *B, PRIMME_INT ldB,
+      PRIMME_COMPLEX_FLOAT beta, PRIMME_COMPLEX_FLOAT *C, PRIMME_INT ldC, primme_params *primme);
 #endif
@@ -36,6 +36,8 @@
 #ifndef CONST_H
 #define CONST_H
 
+#include "primme.h"        /* PRIMME_INT */
+
 #define TRUE  1
 #define FALSE 0
 
@@ -51,4 +53,82 @@ enum conv_flags {
 /* Used in kernels in auxiliary_eigs.c, ortho.c and restart.c */
 #define PRIMME_BLOCK_SIZE 512
 
+/* Num_update_VWXR streams V and W through a per-thread buffer of panels  */
+/* of rows; the panel height is reduced from PRIMME_BLOCK_SIZE, halving   */
+/* it down to PRIMME_MIN_PANEL_SIZE, until the buffer fits in this number */
+/* of bytes, so that the panel stays in cache between the GEMM and the    */
+/* copy back into the output arrays.                                      */
+#define PRIMME_PANEL_CACHE_SIZE 262144
+#define PRIMME_MIN_PANEL_SIZE 32
+
+/* Largest block size that Sprimme_plan considers if maxBlockSize is not   */
+/* larger than one                                                         */
+#define PRIMME_PLAN_MAX_BLOCK 8
+
+/* Default degree, number of random vectors and Lanczos steps of Sprimme_dos */
+#define PRIMME_DOS_DEGREE  60
+#define PRIMME_DOS_VECTORS 8
+#define PRIMME_DOS_LANCZOS 20
+
+/* While matrixMatvecHalf is in use, the residual norms below            */
+/* PRIMME_HALF_ERROR_FACTOR times the unit roundoff of its format,       */
+/* relative to aNorm, are not trusted, and the solver goes back to       */
+/* matrixMatvec                                                          */
+#define PRIMME_HALF_ERROR_FACTOR 10
+#define PRIMME_FP16_EPS 4.8828125e-4   /* 2^-11 */
+#define PRIMME_BF16_EPS 3.90625e-3     /* 2^-8 */
+
+/* With primme.precisionCascade, the single precision stage stops when the  */
+/* residual norms are below PRIMME_CASCADE_EPS_FACTOR times the single     */
+/* precision machine epsilon, relative to aNorm, or below eps if larger    */
+#define PRIMME_CASCADE_EPS_FACTOR 100
+
+/* With primme_orth_adaptive, Bortho_gen skips the reorthogonalization of */
+/* a vector when the estimated loss of orthogonality allows it; the       */
+/* estimate is checked with a second pass on one of every                 */
+/* ORTHO_SAMPLE_PERIOD candidates in a call                               */
+#define ORTHO_SAMPLE_PERIOD 8
+
+/* With primme_orth_lowsync and primme_orth_selective, the orthogonality  */
+/* of the basis is checked before one of every ORTHO_CHECK_PERIOD restarts */
+#define ORTHO_CHECK_PERIOD 4
+
+/* With V'*B*V computed explicitly, H and V'*B*V are updated from the small */
+/* matrices at restart, and recomputed from V, W and BV at one of every     */
+/* EXPLICIT_H_PERIOD restarts                                               */
+#define EXPLICIT_H_PERIOD 4
+
+/* Without locking, the columns of V and W of the converged pairs that barely */
+/* changed are kept at restart, except at one of every                        */
+/* SOFT_LOCKING_REFRESH_PERIOD restarts                                       */
+#define SOFT_LOCKING_REFRESH_PERIOD 4
+
+/* Reductions queued by globalSum_queue and summed up among the processes */
+/* together in a single call to globalSumReal by globalSum_flush, or to   */
+/* globalSumRealStart by globalSum_flush_start and globalSum_flush_wait.  */
+/* Every entry is the m x n matrix A(0:m-1,0:n-1); if i0 >= 0, only the   */
+/* upper trapezoidal part A(0:i0+j,j) of every column j is reduced.       */
+
+#define MAX_QUEUED_GLOBAL_SUMS 8
+
+typedef struct {
+   void *A[MAX_QUEUED_GLOBAL_SUMS];       /* matrices reduced in place */
+   PRIMME_INT ldA[MAX_QUEUED_GLOBAL_SUMS];/* leading dimensions */
+   int m[MAX_QUEUED_GLOBAL_SUMS];         /* number of rows */
+   int n[MAX_QUEUED_GLOBAL_SUMS];         /* number of columns */
+   int i0[MAX_QUEUED_GLOBAL_SUMS];        /* diagonal offset or -1 */
+   int newSum[MAX_QUEUED_GLOBAL_SUMS];    /* zero if part of the previous one */
+   int size;                              /* number of queued entries */
+   void *sum;        /* if not NULL, where the nonblocking sum is stored */
+   void *request;    /* handle returned by globalSumRealStart */
+} globalsum_queue;
+
+#define GLOBALSUM_QUEUE_INIT(Q) ((Q).size = 0, (Q).sum = NULL)
+
+/* Type of the user's matrixMatvec, massMatrixMatvec and applyPreconditioner */
+
+typedef void (*primme_operator)(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, struct primme_params *primme,
+      int *ierr);
+
 #endif /* CONST_H */
@@ -41,6 +41,7 @@
 #include "convergence.h"
 #include "ortho.h"
 #include "auxiliary_eigs.h"
+#include "wtime.h"
 
 
 static int check_practical_convergence(SCALAR *R, PRIMME_INT nLocal,
@@ -62,6 +63,8 @@ static int check_practical_convergence(SCALAR *R, PRIMME_INT nLocal,
  * ldevecs        The leading dimension of evecs
  * left, right    Range of vectors to be checked for convergence
  * blockNorms     Residual norms of the Ritz vectors starting from left
+ * resErrors      Bounds of the error in blockNorms (optional). If NULL, use
+ *                primme->stats.estimateResidualError for all pairs
  * hVals          The Ritz values
  * rwork          Real work array that must be of size 
  * rworkSize      The size of rwork
@@ -82,16 +85,19 @@ TEMPLATE_PLEASE
 int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       SCALAR *R, PRIMME_INT ldR, SCALAR *evecs, int numLocked,
       PRIMME_INT ldevecs, int left, int right, int *flags, REAL *blockNorms,
-      REAL *hVals, int *reset, double machEps, SCALAR *rwork,
+      REAL *resErrors, REAL *hVals, int *reset, double machEps, SCALAR *rwork,
       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme) {
 
    int i;                  /* Loop variable                                      */
    int numToProject;       /* Number of vectors with potential accuracy problem  */
    int *toProject = iwork; /* Indices from left with potential accuracy problem  */
+   int *isConvBlock = NULL;/* return of convTestFunBlock                         */
    double tol;             /* Residual tolerance                                 */
    double attainableTol=0; /* Used in locking to check near convergence problem  */
    int isConv;             /* return of convTestFun                              */
    double targetShift;     /* target shift */
+   double resError;        /* error bound of the residual norm of a pair         */
+   double halfError=0.0;   /* error of W while matrixMatvecHalf is in use        */
 
    /* -------------------------- */
    /* Return memory requirements */
@@ -100,9 +106,11 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
    if (flags == NULL) {
       CHKERR(check_practical_convergence(NULL, 0, 0, NULL, numLocked, 0, left,
             NULL, right-left, NULL, NULL, 0, NULL, rworkSize, primme), -1);
-      *iwork = max(*iwork, right-left); /* for toProject */
+      *iwork = max(*iwork, 2*(right-left)); /* for toProject and isConvBlock */
       return 0;
    }
+
+   double t0 = primme_get_wtime();
  
    /* Check enough space for toProject */
    assert(iworkSize >= right-left);
@@ -117,6 +125,15 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
    tol = max(machEps * max(primme->stats.estimateLargestSVal, primme->aNorm),
                primme->stats.maxConvTol);
 
+   /* While matrixMatvecHalf is in use, W has the error of its format */
+
+   if (primme->matvecHalfActive) {
+      halfError = PRIMME_HALF_ERROR_FACTOR
+         * (primme->matvecHalfType == primme_half_bf16 ?
+               PRIMME_BF16_EPS : PRIMME_FP16_EPS)
+         * max(primme->stats.estimateLargestSVal, primme->aNorm);
+   }
+
    /* ---------------------------------------------------------------------- */
    /* If locking, set tol beyond which we need to check for accuracy problem */
    /* ---------------------------------------------------------------------- */
@@ -128,11 +145,36 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
    /* Determine which Ritz vectors have converged < tol and flag them.  */
    /* ----------------------------------------------------------------- */
 
+   /* ----------------------------------------------------------------- */
+   /* If convTestFunBlock is given, evaluate all pairs that are not      */
+   /* decided by the next loop with a single call                        */
+   /* ----------------------------------------------------------------- */
+
+   if (X && primme->convTestFunBlock && right > left) {
+      assert(iworkSize >= 2*(right-left));
+      isConvBlock = &iwork[right-left];
+      for (i=left; i < right; i++) {
+         blockNorms[i-left] = max(blockNorms[i-left], max(halfError,
+               resErrors ? resErrors[i-left]
+                         : primme->stats.estimateResidualError));
+         isConvBlock[i-left] =
+               (primme->target == primme_closest_leq
+                && hVals[i]-blockNorms[i-left] > targetShift) ||
+               (primme->target == primme_closest_geq
+                && hVals[i]+blockNorms[i-left] < targetShift) ||
+               blockNorms[i-left] <= primme->stats.maxConvTol;
+      }
+      CHKERR(convTestFunBlock_Sprimme(&hVals[left], X, ldX, blockNorms,
+               isConvBlock, right-left, primme), -1);
+   }
+
    numToProject = 0;
    for (i=left; i < right; i++) {
        
       /* Don't trust any residual norm below estimateResidualError */
-      blockNorms[i-left] = max(blockNorms[i-left], primme->stats.estimateResidualError);
+      resError = max(halfError, resErrors ? resErrors[i-left] :
+         primme->stats.estimateResidualError);
+      blockNorms[i-left] = max(blockNorms[i-left], resError);
 
       /* Refine doesn't order the pairs considering closest_leq/gep. */
       /* Then ignore values so that value +-residual is completely   */
@@ -151,8 +193,13 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
          continue;
       }
 
-      CHKERR(convTestFun_Sprimme(hVals[i], X?&X[ldX*(i-left)]:NULL,
-               blockNorms[i-left], &isConv, primme), -1);
+      if (isConvBlock) {
+         isConv = isConvBlock[i-left];
+      }
+      else {
+         CHKERR(convTestFun_Sprimme(hVals[i], X?&X[ldX*(i-left)]:NULL,
+                  blockNorms[i-left], &isConv, primme), -1);
+      }
 
       if (isConv) {
          flags[i] = CONVERGED;
@@ -164,7 +211,7 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       /* of V and W in the next restart.                                   */
       /* ----------------------------------------------------------------- */
 
-      else if (blockNorms[i-left] <= primme->stats.estimateResidualError && reset) {
+      else if (blockNorms[i-left] <= resError && reset) {
          flags[i] = SKIP_UNTIL_RESTART;
          *reset = 1;
       }
@@ -203,6 +250,8 @@ int check_convergence_Sprimme(SCALAR *X, PRIMME_INT nLocal, PRIMME_INT ldX,
                -1);
    }
 
+   primme->stats.timeConvCheck += primme_get_wtime() - t0;
+
    return 0;
 
 }
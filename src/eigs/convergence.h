@@ -42,21 +42,21 @@
 int check_convergence_dprimme(double *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       double *R, PRIMME_INT ldR, double *evecs, int numLocked,
       PRIMME_INT ldevecs, int left, int right, int *flags, double *blockNorms,
-      double *hVals, int *reset, double machEps, double *rwork,
+      double *resErrors, double *hVals, int *reset, double machEps, double *rwork,
       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 int check_convergence_zprimme(PRIMME_COMPLEX_DOUBLE *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       PRIMME_COMPLEX_DOUBLE *R, PRIMME_INT ldR, PRIMME_COMPLEX_DOUBLE *evecs, int numLocked,
       PRIMME_INT ldevecs, int left, int right, int *flags, double *blockNorms,
-      double *hVals, int *reset, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
+      double *resErrors, double *hVals, int *reset, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 int check_convergence_sprimme(float *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       float *R, PRIMME_INT ldR, float *evecs, int numLocked,
       PRIMME_INT ldevecs, int left, int right, int *flags, float *blockNorms,
-      float *hVals, int *reset, double machEps, float *rwork,
+      float *resErrors, float *hVals, int *reset, double machEps, float *rwork,
       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 int check_convergence_cprimme(PRIMME_COMPLEX_FLOAT *X, PRIMME_INT nLocal, PRIMME_INT ldX,
       PRIMME_COMPLEX_FLOAT *R, PRIMME_INT ldR, PRIMME_COMPLEX_FLOAT *evecs, int numLocked,
       PRIMME_INT ldevecs, int left, int right, int *flags, float *blockNorms,
-      float *hVals, int *reset, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
+      float *resErrors, float *hVals, int *reset, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
 #endif
@@ -44,24 +44,35 @@
 #include "auxiliary_eigs.h"
 
 static REAL computeRobustShift(int blockIndex, double resNorm, 
-   REAL *prevRitzVals, int numPrevRitzVals, REAL *sortedRitzVals, 
-   REAL *approxOlsenShift, int numSorted, int *ilev, primme_params *primme);
+   REAL *prevLocked, int numPrevLocked, REAL *prevRitzVals,
+   int numPrevRitzVals, REAL *lockedEvals, int numLocked, REAL *ritzVals,
+   int basisSize, REAL *approxOlsenShift, int *ilev, primme_params *primme);
 
-static void mergeSort(REAL *lockedEvals, int numLocked, REAL *ritzVals, 
-   int *flags, int basisSize, REAL *sortedRitzVals, int *ilev, int blockSize,
+static REAL sortedRitzVal(int k, REAL *lockedEvals, int numLocked,
+   REAL *ritzVals, int numRitzVals, primme_params *primme);
+
+static int sortedBefore(REAL a, REAL b, primme_params *primme);
+
+static void mergeIndices(REAL *lockedEvals, int numLocked, REAL *ritzVals, 
+   int *flags, int basisSize, int *ilev, int blockSize,
    primme_params *primme);
  
 static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
       PRIMME_INT ldx, int blockSize, SCALAR *rwork, primme_params *primme);
 
-static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
-      SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *Kinvx, SCALAR *xKinvx, 
-      SCALAR **Lprojector, PRIMME_INT *ldLprojector, SCALAR **RprojectorQ,
-      PRIMME_INT *ldRprojectorQ, SCALAR **RprojectorX,
-      PRIMME_INT *ldRprojectorX,  int *sizeLprojector, int *sizeRprojectorQ,
-      int *sizeRprojectorX, int numLocked, int numConverged,
+static int update_precond_shifts(double *blockOfShifts, double *oldShifts,
+      int blockSize, REAL *precondShifts, int *numPrecondShifts,
       primme_params *primme);
 
+static int setup_JD_projectors(SCALAR *x, PRIMME_INT ldx, int blockSize,
+      SCALAR *evecs, PRIMME_INT ldevecs, SCALAR *evecsHat,
+      PRIMME_INT ldevecsHat, SCALAR *Kinvx, PRIMME_INT ldKinvx,
+      SCALAR *xKinvx, SCALAR **Lprojector, PRIMME_INT *ldLprojector,
+      SCALAR **RprojectorQ, PRIMME_INT *ldRprojectorQ, SCALAR **RprojectorX,
+      PRIMME_INT *ldRprojectorX,  int *sizeLprojector, int *sizeLprojectorX,
+      int *sizeRprojectorQ, int *sizeRprojectorX, int numLocked,
+      int numConverged, SCALAR *rwork, primme_params *primme);
+
 
 /*******************************************************************************
  * Subroutine solve_correction - This routine solves the correction equation
@@ -104,12 +115,12 @@ static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
  *
  * rwork          Real workspace of size          
  *                3*maxEvecsSize + 2*primme->maxBlockSize 
- *                + (primme->numEvals+primme->maxBasisSize)
+ *                + primme->maxBlockSize                 For x'*K^{-1}*x
  *                        *----------------------------------------------------*
- *                        | The following are optional and mutually exclusive: |
+ *                        | The following are optional:                        |
  *                        *------------------------------+                     |
- *                + 4*primme->nLocal + primme->nLocal    | For QMR work and sol|
- *                + primme->nLocal*primme->maxBlockSize  | OLSEN for Kinvx     |
+ *                + primme->ldOPs*primme->maxBlockSize   | OLSEN and JD Kinvx  |
+ *                + the workspace of inner_solve         | For QMR work        |
  *                                                       *---------------------*
  *
  * rworkSize      the size of rwork. If less than needed, func returns needed.
@@ -130,10 +141,22 @@ static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
  *                Ritz vectors (through JDQMR only).
  *
  *
- * prevRitzVals   Array of size numPrevRitzVals.  The Ritz values from the
- *                previous iteration and converged Ritz values
+ * prevRitzVals   Array of size numEvals+maxBasisSize.  The Ritz values from
+ *                the previous iteration and, with locking and extreme
+ *                targets, a copy of the locked values in the first
+ *                numPrevLocked positions, followed by the Ritz values from
+ *                position numEvals.
+ *
+ * numPrevRitzVals  The number of locked and Ritz values in prevRitzVals,
+ *                updated every outer step
  *
- * numPrevRitzVals  The of size prevRitzVals updated every outer step
+ * numPrevLocked  The number of locked values in prevRitzVals
+ *
+ * precondShifts  Array of size maxBlockSize. The shifts passed to the last
+ *                call to primme.precondShiftUpdate
+ *
+ * numPrecondShifts  The number of shifts in precondShifts, 0 before the
+ *                first call
  *
  * touch            Parameter used in inner solve stopping criteria
  *
@@ -150,32 +173,39 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       PRIMME_INT ldW, SCALAR *evecs, PRIMME_INT ldevecs, SCALAR *evecsHat,
       PRIMME_INT ldevecsHat, SCALAR *UDU, int *ipivot, REAL *lockedEvals, 
       int numLocked, int numConvergedStored, REAL *ritzVals, 
-      REAL *prevRitzVals, int *numPrevRitzVals, int *flags, int basisSize, 
-      REAL *blockNorms, int *iev, int blockSize, int *touch, double machEps,
-      SCALAR *rwork, size_t *rworkSize, int *iwork, int iworkSize,
-      primme_params *primme) {
+      REAL *prevRitzVals, int *numPrevRitzVals, int *numPrevLocked,
+      REAL *precondShifts, int *numPrecondShifts, int *flags, int basisSize, REAL *blockNorms, int *iev, int blockSize,
+      int *touch, double machEps, SCALAR *rwork, size_t *rworkSize,
+      int *iwork, int iworkSize, primme_params *primme) {
 
    int blockIndex;         /* Loop index.  Ranges from 0..blockSize-1.       */
    int ritzIndex;          /* Ritz value index blockIndex corresponds to.    */
                            /* Possible values range from 0..basisSize-1.     */
-   int sortedIndex;        /* Ritz value index in sortedRitzVals, blockIndex */
-                           /* corresponds to. Range 0..numLocked+basisSize-1 */
+   int sortedIndex;        /* Index of the Ritz value blockIndex corresponds */
+                           /* to in the sorted list of locked and current    */
+                           /* Ritz values. Range 0..numLocked+basisSize-1    */
    size_t neededRsize;     /* Needed size for rwork. If not enough return    */
    size_t linSolverRWorkSize;/* Size of the linSolverRWork array.            */
    int *ilev;              /* Array of size blockSize.  Maps the target Ritz */
-                           /* values to their positions in the sortedEvals   */
-                           /* array.                                         */
+                           /* values to their positions in the sorted list   */
+                           /* of locked and current Ritz values.             */
    int sizeLprojector;     /* Sizes of the various left/right projectors     */
-   int sizeRprojectorQ;    /* These will be 0/1/or numOrthConstr+numLocked   */
-   int sizeRprojectorX;    /* or numOrthConstr+numConvergedStored w/o locking*/
+   int sizeLprojectorX;    /* These will be 0/1/or numOrthConstr+numLocked   */
+   int sizeRprojectorQ;    /* or numOrthConstr+numConvergedStored w/o locking*/
+   int sizeRprojectorX;
 
-   SCALAR *r, *x, *sol;  /* Residual, Ritz vector, and correction.         */
+   SCALAR *r, *x;        /* Residuals and Ritz vectors.                    */
    SCALAR *linSolverRWork;/* Workspace needed by linear solver.            */
-   REAL *sortedRitzVals; /* Sorted array of current and converged Ritz     */
-                           /* values.  Size of array is numLocked+basisSize. */
+   REAL *sortedLocked;   /* Locked values sorted with the Ritz values,     */
+   int numSortedLocked;    /* if any, and its size                           */
+   REAL *prevRitz;       /* The Ritz values of the previous iteration      */
+   int numPrevRitz;        /* The number of values in prevRitz               */
    double *blockOfShifts;  /* Shifts for (A-shiftI) or (if needed) (K-shiftI)*/
+   double *oldShifts;      /* Shifts of the last precondShiftUpdate call     */
    REAL *approxOlsenEps; /* Shifts for approximate Olsen implementation    */
+   REAL *blockRitzVals;  /* The Ritz values of the block vectors           */
    SCALAR *Kinvx;         /* Workspace to store K^{-1}x                     */
+   SCALAR *xKinvx;        /* Stores x'*K^{-1}x if needed                    */
    SCALAR *Lprojector;   /* Q pointer for (I-Q*Q'). Usually points to evecs*/
    SCALAR *RprojectorQ;  /* May point to evecs/evecsHat depending on skewQ */
    SCALAR *RprojectorX;  /* May point to x/Kinvx depending on skewX        */
@@ -183,9 +213,7 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    PRIMME_INT ldRprojectorQ; /* The leading dimension of RprojectorQ    */
    PRIMME_INT ldRprojectorX; /* The leading dimension of RprojectorL    */
 
-
-   SCALAR xKinvx;                        /* Stores x'*K^{-1}x if needed    */
-   REAL eval, shift, robustShift;       /* robust shift values.           */
+   REAL eval, robustShift;              /* robust shift values.           */
 
    /*------------------------------------------------------------*/
    /* Subdivide the workspace with pointers, and figure out      */
@@ -196,43 +224,35 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    neededRsize = 0;
    Kinvx       = rwork;
    /* Kinvx will have nonzero size if precond and both RightX and SkewX */
+   /* Both OLSEN's method and JDQMR work on the whole block             */
    if (primme->correctionParams.projectors.RightX &&  
        primme->correctionParams.projectors.SkewX ) { 
-
-      /* OLSEN's method requires a block, but JDQMR is vector by vector */
-      if (primme->correctionParams.maxInnerIterations == 0) {    
-         sol = Kinvx + primme->ldOPs*blockSize;
-         neededRsize = neededRsize + primme->ldOPs*blockSize;
-      }
-      else {
-         sol = Kinvx + primme->nLocal;
-         neededRsize = neededRsize + primme->nLocal;
-      }
+      xKinvx = Kinvx + primme->ldOPs*blockSize;
+      neededRsize = neededRsize + primme->ldOPs*blockSize;
    }
    else {
-      sol = Kinvx + 0;
-   }
-   if (primme->correctionParams.maxInnerIterations == 0) {    
-      linSolverRWork = sol + 0;                   /* sol not needed for GD */
-      linSolverRWorkSize = 0;                     /* No inner solver used  */
+      xKinvx = Kinvx + 0;
    }
-   else {
-      linSolverRWork = sol + primme->nLocal;      /* sol needed in innerJD */
-      neededRsize = neededRsize + primme->nLocal;
-      linSolverRWorkSize =                        /* Inner solver worksize */
-              4*primme->nLocal + 2*(primme->numOrthoConst+primme->numEvals);
+   linSolverRWork = xKinvx + blockSize;
+   neededRsize = neededRsize + blockSize;
+   linSolverRWorkSize = 0;                     /* No inner solver for GD */
+   if (primme->correctionParams.maxInnerIterations != 0) {    
+      CHKERR(inner_solve_Sprimme(blockSize, NULL, 0, NULL, 0, NULL, NULL, 0,
+               NULL, NULL, NULL, NULL, 0, NULL, 0, NULL, 0, 0, 0, 0, 0, NULL,
+               0, NULL, NULL, NULL, 0.0, NULL, &linSolverRWorkSize, primme),
+            -1);
       neededRsize = neededRsize + linSolverRWorkSize;
    }
-   sortedRitzVals = (REAL *)(linSolverRWork + linSolverRWorkSize);
-   blockOfShifts  = ALIGN(sortedRitzVals + (numLocked+basisSize), double);
-   approxOlsenEps = ALIGN(blockOfShifts  + blockSize, REAL);
-   neededRsize = neededRsize + numLocked+basisSize
-      + blockSize*(1+sizeof(double)/sizeof(REAL)) + 2;
+   blockOfShifts  = ALIGN(linSolverRWork + linSolverRWorkSize, double);
+   oldShifts      = blockOfShifts + blockSize;
+   approxOlsenEps = ALIGN(oldShifts + blockSize, REAL);
+   blockRitzVals  = approxOlsenEps + blockSize;
+   neededRsize = neededRsize + blockSize*(2+2*sizeof(double)/sizeof(REAL)) + 2;
 
    /* Return memory requirements */
    if (V == NULL) {
       *rworkSize = max(*rworkSize, neededRsize);
-      *iwork = max(*iwork, primme->numEvals+primme->maxBasisSize);
+      *iwork = max(*iwork, blockSize);
       return 0;
    }
    assert(neededRsize <= *rworkSize);
@@ -251,21 +271,29 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
     
    if (primme->locking && 
       (primme->target == primme_smallest || primme->target == primme_largest)) {
-      /* Combine the sorted list of locked Ritz values with the sorted  */
-      /* list of current Ritz values, ritzVals.  The merging of the two */
-      /* lists lockedEvals and ritzVals is stored in sortedRitzVals.    */
-
-      assert(iworkSize >= numLocked+blockSize);
-      mergeSort(lockedEvals, numLocked, ritzVals, flags, basisSize, 
-                   sortedRitzVals, ilev, blockSize, primme);
+      /* The sorted list of Ritz values combines the locked values with  */
+      /* the current Ritz values, ritzVals, both sorted as primme.target. */
+      /* The list is not formed; its values are found by binary search   */
+      /* with sortedRitzVal, and the positions of the targeted Ritz      */
+      /* values are returned by mergeIndices.                            */
+
+      assert(iworkSize >= blockSize);
+      sortedLocked = lockedEvals;
+      numSortedLocked = numLocked;
+      mergeIndices(lockedEvals, numLocked, ritzVals, flags, basisSize, ilev,
+            blockSize, primme);
+      prevRitz = prevRitzVals + primme->numEvals;
    }
    else {
       /* In the case of soft-locking or when we look for interior ones  */
       /* the sorted evals are simply the ritzVals, targeted as iev      */
 
-      sortedRitzVals = ritzVals;
+      sortedLocked = NULL;
+      numSortedLocked = 0;
       ilev = iev;
+      prevRitz = prevRitzVals;
    }
+   numPrevRitz = *numPrevRitzVals - *numPrevLocked;
 
    /*-----------------------------------------------------------------*/
    /* For interior pairs use not the robust, but user provided shifts */
@@ -280,21 +308,21 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
          /* to the user shift as the proper shift.                                  */
 
          sortedIndex = ilev[blockIndex];
-         if (sortedRitzVals[sortedIndex] - blockNorms[blockIndex]
+         if (ritzVals[sortedIndex] - blockNorms[blockIndex]
                <  primme->targetShifts[min(primme->numTargetShifts-1,numLocked)]
              &&   primme->targetShifts[min(primme->numTargetShifts-1,numLocked)]
-               < sortedRitzVals[sortedIndex] + blockNorms[blockIndex])
+               < ritzVals[sortedIndex] + blockNorms[blockIndex])
             blockOfShifts[blockIndex] = 
                primme->targetShifts[min(primme->numTargetShifts-1, numLocked)];
          else
-            blockOfShifts[blockIndex] = sortedRitzVals[sortedIndex]
+            blockOfShifts[blockIndex] = ritzVals[sortedIndex]
                + blockNorms[blockIndex] * (
                   primme->targetShifts[min(primme->numTargetShifts-1,numLocked)]
-                     < sortedRitzVals[sortedIndex] ? -1 : 1);
+                     < ritzVals[sortedIndex] ? -1 : 1);
          
          if (sortedIndex < *numPrevRitzVals) {
             approxOlsenEps[blockIndex] = 
-            fabs(prevRitzVals[sortedIndex] - sortedRitzVals[sortedIndex]);
+            fabs(prevRitzVals[sortedIndex] - ritzVals[sortedIndex]);
          }  
          else {
             approxOlsenEps[blockIndex] = blockNorms[blockIndex];
@@ -303,7 +331,7 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
 
       /* Remember the previous ritz values*/
       *numPrevRitzVals = basisSize;
-      Num_copy_Rprimme(*numPrevRitzVals, sortedRitzVals, 1, prevRitzVals, 1);
+      Num_copy_Rprimme(*numPrevRitzVals, ritzVals, 1, prevRitzVals, 1);
 
    } /* user provided shifts */
    else {    
@@ -320,12 +348,13 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
          for (blockIndex = 0; blockIndex < blockSize; blockIndex++) {
    
             sortedIndex = ilev[blockIndex];
-            eval = sortedRitzVals[sortedIndex];
+            eval = sortedRitzVal(sortedIndex, sortedLocked, numSortedLocked,
+                  ritzVals, basisSize, primme);
    
             robustShift = computeRobustShift(blockIndex, 
-              blockNorms[blockIndex], prevRitzVals, *numPrevRitzVals, 
-              sortedRitzVals, &approxOlsenEps[blockIndex], 
-              numLocked+basisSize, ilev, primme);
+              blockNorms[blockIndex], prevRitzVals, *numPrevLocked, prevRitz,
+              numPrevRitz, sortedLocked, numSortedLocked, ritzVals, basisSize,
+              &approxOlsenEps[blockIndex], ilev, primme);
    
             /* Subtract/add the shift if looking for the smallest/largest  */
             /* eigenvalues, Do not go beyond the previous computed eigval  */
@@ -333,12 +362,16 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
             if (primme->target == primme_smallest) {
                blockOfShifts[blockIndex] = eval - robustShift;
                if (sortedIndex > 0) blockOfShifts[blockIndex] = 
-                  max(blockOfShifts[blockIndex], sortedRitzVals[sortedIndex-1]);
+                  max(blockOfShifts[blockIndex], sortedRitzVal(sortedIndex-1,
+                           sortedLocked, numSortedLocked, ritzVals, basisSize,
+                           primme));
             }
             else {
                blockOfShifts[blockIndex] = eval + robustShift;
                if (sortedIndex > 0) blockOfShifts[blockIndex] = 
-                  min(blockOfShifts[blockIndex], sortedRitzVals[sortedIndex-1]);
+                  min(blockOfShifts[blockIndex], sortedRitzVal(sortedIndex-1,
+                           sortedLocked, numSortedLocked, ritzVals, basisSize,
+                           primme));
             } /* robust shifting */
    
          }  /* for loop */
@@ -357,8 +390,11 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
             sortedIndex = ilev[blockIndex];
             blockOfShifts[blockIndex] = ritzVals[ritzIndex];
             if (sortedIndex < *numPrevRitzVals) {
-               approxOlsenEps[blockIndex] = 
-               fabs(prevRitzVals[sortedIndex] - sortedRitzVals[sortedIndex]);
+               approxOlsenEps[blockIndex] = fabs(
+                  sortedRitzVal(sortedIndex, prevRitzVals, *numPrevLocked,
+                     prevRitz, numPrevRitz, primme) -
+                  sortedRitzVal(sortedIndex, sortedLocked, numSortedLocked,
+                     ritzVals, basisSize, primme));
             }
             else {
                approxOlsenEps[blockIndex] = blockNorms[blockIndex]; 
@@ -366,9 +402,15 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
          } /* for loop */
       } /* else no robust shifts */
 
-      /* Remember the previous ritz values*/
-      *numPrevRitzVals = numLocked+basisSize;
-      Num_copy_Rprimme(*numPrevRitzVals, sortedRitzVals, 1, prevRitzVals, 1);
+      /* Remember the previous ritz values. The locked values only change */
+      /* when pairs are locked, so they are copied only then.             */
+
+      if (numSortedLocked != *numPrevLocked) {
+         Num_copy_Rprimme(numSortedLocked, sortedLocked, 1, prevRitzVals, 1);
+         *numPrevLocked = numSortedLocked;
+      }
+      Num_copy_Rprimme(basisSize, ritzVals, 1, prevRitz, 1);
+      *numPrevRitzVals = numSortedLocked+basisSize;
 
    } /* else primme_smallest or primme_largest */
 
@@ -378,6 +420,11 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
 
    primme->ShiftsForPreconditioner = blockOfShifts;
 
+   if (primme->correctionParams.precondition && primme->precondShiftUpdate) {
+      CHKERR(update_precond_shifts(blockOfShifts, oldShifts, blockSize,
+               precondShifts, numPrecondShifts, primme), -1);
+   }
+
    /*------------------------------------------------------------ */
    /*  Generalized Davidson variants -- No inner iterations       */
    /*------------------------------------------------------------ */
@@ -417,50 +464,42 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    /*  JDQMR --- JD inner-outer variants                           */
    /* ------------------------------------------------------------ */
    else {  /* maxInnerIterations > 0  We perform inner-outer JDQMR */
-      int touch0 = *touch;
 
-      /* Solve the correction for each block vector. */
+      r = &W[ldW*basisSize];    /* All the block residuals    */
+      x = &V[ldV*basisSize];    /* All the block Ritz vectors */
+
+      /* Set up the left/right/skew projectors for JDQMR.        */
+      /* The pointers Lprojector, Rprojector(Q/X) point to the   */
+      /* appropriate arrays for use in the projection step       */
 
-      for (blockIndex = 0; blockIndex < blockSize; blockIndex++) {
+      CHKERR(setup_JD_projectors(x, ldV, blockSize, evecs, ldevecs, evecsHat,
+               ldevecsHat, Kinvx, primme->ldOPs, xKinvx, &Lprojector,
+               &ldLprojector, &RprojectorQ, &ldRprojectorQ, &RprojectorX,
+               &ldRprojectorX, &sizeLprojector, &sizeLprojectorX,
+               &sizeRprojectorQ, &sizeRprojectorX, numLocked,
+               numConvergedStored, linSolverRWork, primme), -1);
 
-         r = &W[ldW*(basisSize+blockIndex)];
-         x = &V[ldV*(basisSize+blockIndex)];
+      /* Map the index of the block vectors to their corresponding */
+      /* eigenvalue indices                                        */
 
-         /* Set up the left/right/skew projectors for JDQMR.        */
-         /* The pointers Lprojector, Rprojector(Q/X) point to the   */
-         /* appropriate arrays for use in the projection step       */
+      for (blockIndex = 0; blockIndex < blockSize; blockIndex++) {
+         ritzIndex = iev[blockIndex];
+         blockRitzVals[blockIndex] = ritzVals[ritzIndex];
+      }
 
-         CHKERR(setup_JD_projectors(x, evecs, ldevecs, evecsHat, ldevecsHat,
-                  Kinvx, &xKinvx, &Lprojector, &ldLprojector, &RprojectorQ,
-                  &ldRprojectorQ, &RprojectorX, &ldRprojectorX, &sizeLprojector,
-                  &sizeRprojectorQ, &sizeRprojectorX, numLocked,
-                  numConvergedStored, primme), -1);
+      /* Solve the corrections of all block vectors together, and   */
+      /* replace the Ritz vectors with the corrections. The shifts  */
+      /* are made available to primme, in case (K-shift I)^-1 is    */
+      /* needed, and touch is updated as the maximum value that     */
+      /* takes for all equations.                                   */
 
-         /* Map the index of the block vector to its corresponding eigenvalue */
-         /* index, and the shift for the correction equation. Also make the   */
-         /* shift available to primme, in case (K-shift I)^-1 is needed       */
+      CHKERR(inner_solve_Sprimme(blockSize, x, ldV, r, ldW, blockNorms,
+               evecs, ldevecs, UDU, ipivot, xKinvx, Lprojector, ldLprojector,
+               RprojectorQ, ldRprojectorQ, RprojectorX, ldRprojectorX,
+               sizeLprojector, sizeLprojectorX, sizeRprojectorQ,
+               sizeRprojectorX, x, ldV, blockRitzVals, blockOfShifts, touch,
+               machEps, linSolverRWork, &linSolverRWorkSize, primme), -1);
 
-         ritzIndex = iev[blockIndex];
-         shift = blockOfShifts[blockIndex];
-         primme->ShiftsForPreconditioner = &blockOfShifts[blockIndex];
-
-         /* Pass the original value of touch and update touch as the maximum  */
-         /* value that takes for all inner_solve calls                        */
-         int touch1 = touch0;
-
-         CHKERR(inner_solve_Sprimme(x, r, &blockNorms[blockIndex], evecs,
-                  ldevecs, UDU, ipivot, &xKinvx,
-                  Lprojector, ldLprojector, RprojectorQ, ldRprojectorQ,
-                  RprojectorX, ldRprojectorX, sizeLprojector, sizeRprojectorQ,
-                  sizeRprojectorX, sol, ritzVals[ritzIndex], shift, &touch1,
-                  machEps, linSolverRWork, linSolverRWorkSize,
-                  primme), -1);
-         *touch = max(*touch, touch1);
-
-         Num_copy_Sprimme(primme->nLocal, sol, 1, 
-            &V[ldV*(basisSize+blockIndex)], 1);
-
-      } /* end for each block vector */
    } /* JDqmr variants */
 
    return 0;
@@ -482,20 +521,22 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
  *
  * resNorm       The residual norm of the current Ritz vector
  *
- * prevRitzVals  Sorted array of locked Ritz values and Ritz values from the 
- *               previous outer iteration.  Array size is numPrevRitzVals.
+ * prevLocked    The locked values in the previous outer iteration.
+ *               Array size is numPrevLocked.
  *
- * numPrevRitzVals The number of values in prevRitzVals
- * 
- * sortedRitzVals  Sorted array of locked Ritz values and current Ritz values.
- *                 The array is of size numLocked+basisSize
+ * prevRitzVals  The Ritz values from the previous outer iteration.
+ *               Array size is numPrevRitzVals.
  *
- * approxOlsenShift The shift to be used to modify r-shift x, for approx Olsen's
+ * lockedEvals   The locked values merged with the current Ritz values.
+ *               Array size is numLocked.
+ *
+ * ritzVals      The current Ritz values.  Array size is basisSize.
  *
- * numSorted     The size of sortedRitzVals.
+ * approxOlsenShift The shift to be used to modify r-shift x, for approx Olsen's
  *
  * ilev          Array of size blockSize that maps targeted Ritz values to
- *               their position with the array sortedRitzVals.
+ *               their position in the sorted list of locked and Ritz values
+ *               (see sortedRitzVal).
  *
  * Return Value
  * ------------
@@ -504,11 +545,15 @@ int solve_correction_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
  ******************************************************************************/
 
 static REAL computeRobustShift(int blockIndex, double resNorm, 
-   REAL *prevRitzVals, int numPrevRitzVals, REAL *sortedRitzVals, 
-   REAL *approxOlsenShift, int numSorted, int *ilev, primme_params *primme) {
+   REAL *prevLocked, int numPrevLocked, REAL *prevRitzVals,
+   int numPrevRitzVals, REAL *lockedEvals, int numLocked, REAL *ritzVals,
+   int basisSize, REAL *approxOlsenShift, int *ilev, primme_params *primme) {
 
    int sortedIndex;                 /* Index of the current Ritz value in */
-                                    /* sortedRitzVals.                    */
+                                    /* the sorted list.                   */
+   int numSorted;                   /* Size of the sorted list.           */
+   REAL val, lowerVal, upperVal;  /* Current and neighboring sorted     */
+                                    /* Ritz values.                       */
    REAL gap, lowerGap, upperGap;  /* Gaps between the current and       */
                                     /* neighboring Ritz Values.           */ 
    REAL delta;                    /* The difference between the current */
@@ -527,35 +572,44 @@ static REAL computeRobustShift(int blockIndex, double resNorm,
    }
 
    sortedIndex = ilev[blockIndex];
+   numSorted = numLocked + basisSize;
+   val = sortedRitzVal(sortedIndex, lockedEvals, numLocked, ritzVals,
+         basisSize, primme);
 
    /* Compute the gap when the first eigenvalue with respect to the */
    /* current basis is to be computed.                              */
 
    if (sortedIndex == 0 && numSorted >= 2) {
       lowerGap = HUGE_VAL;
-      gap = fabs(sortedRitzVals[1] - sortedRitzVals[0]);
+      upperVal = sortedRitzVal(1, lockedEvals, numLocked, ritzVals,
+            basisSize, primme);
+      gap = fabs(upperVal - val);
    }
    else if (sortedIndex > 0 && numSorted >= 2 && sortedIndex+1 < numSorted) {
 
       /* Take the smaller of the two gaps if an interior eigenvalue is */
       /* targeted.                                                     */
 
-      lowerGap = fabs(sortedRitzVals[sortedIndex] - 
-                      sortedRitzVals[sortedIndex-1]);
-      upperGap = fabs(sortedRitzVals[sortedIndex+1] - 
-                      sortedRitzVals[sortedIndex]);
+      lowerVal = sortedRitzVal(sortedIndex-1, lockedEvals, numLocked,
+            ritzVals, basisSize, primme);
+      upperVal = sortedRitzVal(sortedIndex+1, lockedEvals, numLocked,
+            ritzVals, basisSize, primme);
+      lowerGap = fabs(val - lowerVal);
+      upperGap = fabs(upperVal - val);
       gap = min(lowerGap, upperGap);
    }
    else {
-      lowerGap = fabs(sortedRitzVals[sortedIndex] -
-                      sortedRitzVals[sortedIndex-1]);
+      lowerVal = sortedRitzVal(sortedIndex-1, lockedEvals, numLocked,
+            ritzVals, basisSize, primme);
+      lowerGap = fabs(val - lowerVal);
       gap = lowerGap;
    }
    
    /* Compute the change in a Ritz value between successive iterations */
 
-   if (sortedIndex < numPrevRitzVals) {
-      delta = fabs(prevRitzVals[sortedIndex] - sortedRitzVals[sortedIndex]);
+   if (sortedIndex < numPrevLocked+numPrevRitzVals) {
+      delta = fabs(sortedRitzVal(sortedIndex, prevLocked, numPrevLocked,
+                  prevRitzVals, numPrevRitzVals, primme) - val);
    }
    else {
       delta = HUGE_VAL;
@@ -580,10 +634,68 @@ static REAL computeRobustShift(int blockIndex, double resNorm,
 
 }
 
+/*******************************************************************************
+ * Function sortedBefore - Return whether the value a goes before b when
+ *    sorted as primme.target, either primme_largest or primme_smallest.
+ ******************************************************************************/
+
+static int sortedBefore(REAL a, REAL b, primme_params *primme) {
+   return primme->target == primme_largest ? a > b : a < b;
+}
 
 /*******************************************************************************
- * Subroutine mergeSort -- This routine merges the sorted lockedEvals array and 
- *   the sorted ritzVals array into a single sorted array, sortedRitzVals.
+ * Function sortedRitzVal -- This function returns the k-th value of the list
+ *   that merges the locked values and the current Ritz values, both sorted as
+ *   primme.target. The list is not formed; the value is found by a binary
+ *   search on the number of locked values among the first k+1 values of the
+ *   list, so it costs O(log(numLocked)). It is only called for extreme
+ *   (largest, smallest) eigenvalues, or without locked values.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * k            The position in the merged list, 0 <= k < numLocked+numRitzVals
+ *
+ * lockedEvals  Array of size numLocked.  Ritz values that have been locked.
+ *
+ * numLocked    The size of array lockedEvals.
+ *
+ * ritzVals     Array of size numRitzVals. The current Ritz values.
+ *
+ * numRitzVals  The size of array ritzVals.
+ *
+ * primme       A structure containing various solver parameters
+ * 
+ ******************************************************************************/
+
+static REAL sortedRitzVal(int k, REAL *lockedEvals, int numLocked,
+   REAL *ritzVals, int numRitzVals, primme_params *primme) {
+
+   int i, lo, hi;  /* Number of locked values among the first k+1 values */
+
+   if (numLocked == 0) return ritzVals[k];
+
+   lo = max(0, k+1-numRitzVals);
+   hi = min(k+1, numLocked);
+   while (lo < hi) {
+      i = (lo+hi)/2;
+      if (sortedBefore(lockedEvals[i], ritzVals[k-i], primme)) lo = i+1;
+      else hi = i;
+   }
+
+   /* The k-th value is the later of the last locked value and the last */
+   /* Ritz value among the first k+1 values                             */
+
+   if (lo == 0) return ritzVals[k];
+   if (lo == k+1) return lockedEvals[k];
+   return sortedBefore(lockedEvals[lo-1], ritzVals[k-lo], primme) ?
+      ritzVals[k-lo] : lockedEvals[lo-1];
+}
+
+/*******************************************************************************
+ * Subroutine mergeIndices -- This routine returns the positions of the
+ *   first blockSize unconverged Ritz values in the list that merges the sorted
+ *   lockedEvals array and the sorted ritzVals array (see sortedRitzVal). The
+ *   position of every Ritz value is found by a binary search in lockedEvals.
  *   It is only called for extreme (largest, smallest) eigenvalues, not for 
  *   interior ones. Thus it does not cover the interior case. 
  *
@@ -601,79 +713,97 @@ static REAL computeRobustShift(int blockIndex, double resNorm,
  *
  * basisSize    The current size of the basis V.
  *
- * ilev         Maps the blockSize targeted Ritz values to their position
- *              within sortedRitzVals.
- * 
  * blockSize    The number of Ritz values targeted during the current outer
  *              iteration.
  *
  * primme       A structure containing various solver parameters
  * 
- * INPUT/OUTPUT ARRAYS AND PARAMETERS
- * ----------------------------------
- * sortedRitzVals  The array lockedEvals and ritzVals are merged into.
+ * OUTPUT ARRAYS
+ * -------------
+ * ilev         Maps the blockSize targeted Ritz values to their position
+ *              within the merged list.
  *
  ******************************************************************************/
 
-
-static void mergeSort(REAL *lockedEvals, int numLocked, REAL *ritzVals, 
-   int *flags, int basisSize, REAL *sortedRitzVals, int *ilev, int blockSize,
+static void mergeIndices(REAL *lockedEvals, int numLocked, REAL *ritzVals, 
+   int *flags, int basisSize, int *ilev, int blockSize,
    primme_params *primme) {
    
-   int count;         /* The number of Ritz values merged        */
-   int eval, ritzVal; /* The index of the next locked Ritz value */
-                      /*   and current Ritz values to be merged  */
-   int blockIndex;    /* Counter used to index ilev              */
-
-   count = 0;
-   eval = 0;
-   ritzVal = 0;
-   blockIndex = 0;
-   
-   /* Continue merging until all elements have been merged */
-
-   while (count < numLocked+basisSize) {
-
-      /* I. The list of locked eigenvalues has been completely merged, or  */
-      /* if ritzVals[ritzVal] is greater/less than lockedEvals[eval], then */
-      /* merge ritzVals[ritzVal] into the list of sorted Ritz values.      */
-      /*                                                                   */
-      /* II. If the list of current Ritz values has been completely merged,*/
-      /* or if lockedEvals[eval] greater/less than ritzVals[ritzVal], then */
-      /* merge lockedEvals[eval] into the list of sorted Ritz values.      */
-  
-      if (eval >= numLocked || (primme->target == primme_largest && 
-                               ritzVals[ritzVal] >= lockedEvals[eval])
-                           || (primme->target == primme_smallest &&
-                               ritzVals[ritzVal] <= lockedEvals[eval])
-         ) 
-      {
-         sortedRitzVals[count] = ritzVals[ritzVal];
-
-         /* If the Ritz value just merged is unconverged and there is room */
-         /* enough in the block to target it, then keep track of its index */
-         /* in the sorted list.                                            */
-
-         if (blockIndex < blockSize && flags[ritzVal] == UNCONVERGED) {
-            ilev[blockIndex] = count;
-            blockIndex++;
-         }
+   int ritzVal;       /* The index of the current Ritz value        */
+   int blockIndex;    /* Counter used to index ilev                 */
+   int lo, hi, i;     /* Bounds of the binary search                */
+
+   for (ritzVal=0, blockIndex=0; ritzVal < basisSize && blockIndex < blockSize;
+         ritzVal++) {
+      if (flags[ritzVal] != UNCONVERGED) continue;
+
+      /* Count the locked values that go before ritzVals[ritzVal]. Ritz */
+      /* values go before the locked values equal to them.              */
+
+      lo = 0;
+      hi = numLocked;
+      while (lo < hi) {
+         i = (lo+hi)/2;
+         if (sortedBefore(lockedEvals[i], ritzVals[ritzVal], primme)) lo = i+1;
+         else hi = i;
+      }
+      ilev[blockIndex++] = ritzVal + lo;
+   }
+}
 
-         ritzVal++;
+/*******************************************************************************
+ * Subroutine update_precond_shifts - Call primme.precondShiftUpdate if some
+ *    shift differs from the shift passed in the last call by more than
+ *    primme.precondShiftTol relatively, so that a shifted preconditioner
+ *    is rebuilt only then, and it is reused otherwise.
+ *
+ * Input Parameters
+ * ----------------
+ * blockOfShifts  The new shifts for the preconditioner
+ *
+ * oldShifts      Workspace of size blockSize
+ *
+ * blockSize      The number of shifts
+ *
+ * Input/Output parameters
+ * -----------------------
+ * precondShifts     The shifts passed in the last call
+ *
+ * numPrecondShifts  The number of shifts in precondShifts
+ *
+ ******************************************************************************/
+
+static int update_precond_shifts(double *blockOfShifts, double *oldShifts,
+      int blockSize, REAL *precondShifts, int *numPrecondShifts,
+      primme_params *primme) {
+
+   int i, changed, ierr=0;
+
+   /* Signal always the first time and when the block size changes */
+
+   changed = (*numPrecondShifts != blockSize);
+   for (i=0; i<blockSize && !changed; i++) {
+      if (fabs(blockOfShifts[i] - precondShifts[i])
+            > primme->precondShiftTol*fabs(precondShifts[i])) {
+         changed = 1;
       }
-      else if (ritzVal >= basisSize || (primme->target == primme_largest &&
-                                       lockedEvals[eval] >= ritzVals[ritzVal])
-                                   || (primme->target == primme_smallest &&
-                                       lockedEvals[eval] <= ritzVals[ritzVal])
-              )
-      {
-         sortedRitzVals[count] = lockedEvals[eval];
-         eval++;
-      } 
-
-      count++;
    }
+   if (!changed) return 0;
+
+   for (i=0; i<blockSize; i++) {
+      oldShifts[i] = precondShifts[i];
+   }
+   primme->precondShiftUpdate(blockOfShifts,
+         *numPrecondShifts == blockSize ? oldShifts : NULL, &blockSize, primme,
+         &ierr);
+   CHKERRM(ierr, -1, "Error returned by 'precondShiftUpdate' %d", ierr);
 
+   for (i=0; i<blockSize; i++) {
+      precondShifts[i] = (REAL)blockOfShifts[i];
+   }
+   *numPrecondShifts = blockSize;
+
+   return 0;
 }
 
 /*******************************************************************************
@@ -767,11 +897,14 @@ static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
  *
  *  INPUT
  *  -----
- *   x                The Ritz vector
+ *   x                The Ritz vectors
+ *   ldx              The leading dimension of x
+ *   blockSize        The number of Ritz vectors
  *   evecs            Converged locked eigenvectors (denoted as Q herein)
  *   evecsHat         K^{-1}*evecs
  *   numLocked        Number of locked eigenvectors (if locking)
  *   numConverged     Number of converged e-vectors copied in evecs (no locking)
+ *   rwork            Workspace of size blockSize
  *   primme           The main data structures that contains the choices for
  *
  *       primme->LeftQ  : evecs in the left projector
@@ -784,12 +917,15 @@ static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
  *  OUTPUT
  *  ------
  *  *Kinvx            The result of K^{-1}x (if needed, otherwise NULL)
- * **Lprojector       Pointer to the left projector for [Q x] (could be NULL)
+ *  *xKinvx           The values x_j'*K^{-1}*x_j (or 1 if not needed)
+ * **Lprojector       Pointer to the left projector for Q (could be NULL)
  * **RprojectorQ      Pointer to the right projector for Q (could be NULL)
- * **RprojectorX      Pointer to the right projector for X (could be NULL)
- *   sizeLprojector   Size of the left projector(numConverged/numLocked)/+1 or 0
+ * **RprojectorX      Pointer to the right projectors for x, that is, Kinvx
+ *                    or x (could be NULL)
+ *   sizeLprojector   Size of the Q left projector(numConverged/numLocked or 0)
+ *   sizeLprojectorX  Size of the X left projector for each x_j (1 or 0)
  *   sizeRprojectorQ  Size of the Q right projectr (numConverged/numLocked or 0)
- *   sizeRprojectorX  Size of the X right projectr (1 or 0)
+ *   sizeRprojectorX  Size of the X right projector for each x_j (1 or 0)
  *
  * ============================================================================
  * Functionality:
@@ -836,18 +972,19 @@ static int Olsen_preconditioner_block(SCALAR *r, PRIMME_INT ldr, SCALAR *x,
  *
  ******************************************************************************/
 
-static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
-      SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *Kinvx, SCALAR *xKinvx, 
-      SCALAR **Lprojector, PRIMME_INT *ldLprojector, SCALAR **RprojectorQ,
-      PRIMME_INT *ldRprojectorQ, SCALAR **RprojectorX,
-      PRIMME_INT *ldRprojectorX,  int *sizeLprojector, int *sizeRprojectorQ,
-      int *sizeRprojectorX, int numLocked, int numConverged,
-      primme_params *primme) {
+static int setup_JD_projectors(SCALAR *x, PRIMME_INT ldx, int blockSize,
+      SCALAR *evecs, PRIMME_INT ldevecs, SCALAR *evecsHat,
+      PRIMME_INT ldevecsHat, SCALAR *Kinvx, PRIMME_INT ldKinvx,
+      SCALAR *xKinvx, SCALAR **Lprojector, PRIMME_INT *ldLprojector,
+      SCALAR **RprojectorQ, PRIMME_INT *ldRprojectorQ, SCALAR **RprojectorX,
+      PRIMME_INT *ldRprojectorX,  int *sizeLprojector, int *sizeLprojectorX,
+      int *sizeRprojectorQ, int *sizeRprojectorX, int numLocked,
+      int numConverged, SCALAR *rwork, primme_params *primme) {
 
-   int n, sizeEvecs;
-   SCALAR xKinvx_local;
+   int i, sizeEvecs;
 
    *sizeLprojector  = 0;
+   *sizeLprojectorX = 0;
    *sizeRprojectorQ = 0;
    *sizeRprojectorX = 0;
    *ldLprojector  = 0;
@@ -857,32 +994,23 @@ static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
    *RprojectorQ = NULL;
    *RprojectorX = NULL;
 
-   n = primme->nLocal;
    if (primme->locking) 
       sizeEvecs = primme->numOrthoConst+numLocked;
    else
       sizeEvecs = primme->numOrthoConst+numConverged;
    
    /* --------------------------------------------------------*/
-   /* Set up the left projector arrays. Make x adjacent to Q. */
+   /* Set up the left projector arrays. x is applied together */
+   /* with Q by inner_solve.                                  */
    /* --------------------------------------------------------*/
    
    if (primme->correctionParams.projectors.LeftQ) {
-   
          *sizeLprojector = sizeEvecs;
          *Lprojector = evecs;
          *ldLprojector = ldevecs;
-         if (primme->correctionParams.projectors.LeftX) {
-            Num_copy_Sprimme(n, x, 1, &evecs[sizeEvecs*ldevecs], 1);
-            *sizeLprojector = *sizeLprojector + 1;
-         }
    }
-   else {
-      if (primme->correctionParams.projectors.LeftX) {
-         *Lprojector = x;
-         *ldLprojector = n;
-         *sizeLprojector = 1;
-      }
+   if (primme->correctionParams.projectors.LeftX) {
+      *sizeLprojectorX = 1;
    }
       
    /* --------------------------------------------------------*/
@@ -915,28 +1043,29 @@ static int setup_JD_projectors(SCALAR *x, SCALAR *evecs, PRIMME_INT ldevecs,
    /* ------------*/
    /* Then for x  */
    /* ------------*/
+   for (i=0; i<blockSize; i++) xKinvx[i] = 1.0;
    if (primme->correctionParams.projectors.RightX) {
    
       if (primme->correctionParams.precondition   &&
           primme->correctionParams.projectors.SkewX) {
-         CHKERR(applyPreconditioner_Sprimme(x, primme->nLocal, primme->nLocal,
-                  Kinvx, primme->nLocal, 1, primme), -1);
-         primme->stats.numPreconds += 1;
+         CHKERR(applyPreconditioner_Sprimme(x, primme->nLocal, ldx, Kinvx,
+                  ldKinvx, blockSize, primme), -1);
          *RprojectorX  = Kinvx;
-         xKinvx_local = Num_dot_Sprimme(primme->nLocal, x, 1, Kinvx, 1);
-         CHKERR(globalSum_Sprimme(&xKinvx_local, xKinvx, 1, primme), -1);
+         *ldRprojectorX  = ldKinvx;
+
+         /* Compute x_j'*Kinvx_j with a single global sum */
+
+         for (i=0; i<blockSize; i++) {
+            rwork[i] = Num_dot_Sprimme(primme->nLocal, &x[ldx*i], 1,
+                  &Kinvx[ldKinvx*i], 1);
+         }
+         CHKERR(globalSum_Sprimme(rwork, xKinvx, blockSize, primme), -1);
       }      
       else {
          *RprojectorX = x;
-         *xKinvx = 1.0;
+         *ldRprojectorX  = ldx;
       }
       *sizeRprojectorX = 1;
-      *ldRprojectorX  = n;
-   }
-   else { 
-         *RprojectorX = NULL;
-         *sizeRprojectorX = 0;
-         *xKinvx = 1.0;
    }
 
    return 0;
@@ -43,32 +43,32 @@ int solve_correction_dprimme(double *V, PRIMME_INT ldV, double *W,
       PRIMME_INT ldW, double *evecs, PRIMME_INT ldevecs, double *evecsHat,
       PRIMME_INT ldevecsHat, double *UDU, int *ipivot, double *lockedEvals,
       int numLocked, int numConvergedStored, double *ritzVals,
-      double *prevRitzVals, int *numPrevRitzVals, int *flags, int basisSize,
-      double *blockNorms, int *iev, int blockSize, int *touch, double machEps,
-      double *rwork, size_t *rworkSize, int *iwork, int iworkSize,
-      primme_params *primme);
+      double *prevRitzVals, int *numPrevRitzVals, int *numPrevLocked,
+      double *precondShifts, int *numPrecondShifts, int *flags, int basisSize, double *blockNorms, int *iev, int blockSize,
+      int *touch, double machEps, double *rwork, size_t *rworkSize,
+      int *iwork, int iworkSize, primme_params *primme);
 int solve_correction_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *W,
       PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *evecs, PRIMME_INT ldevecs, PRIMME_COMPLEX_DOUBLE *evecsHat,
       PRIMME_INT ldevecsHat, PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, double *lockedEvals,
       int numLocked, int numConvergedStored, double *ritzVals,
-      double *prevRitzVals, int *numPrevRitzVals, int *flags, int basisSize,
-      double *blockNorms, int *iev, int blockSize, int *touch, double machEps,
-      PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, int *iwork, int iworkSize,
-      primme_params *primme);
+      double *prevRitzVals, int *numPrevRitzVals, int *numPrevLocked,
+      double *precondShifts, int *numPrecondShifts, int *flags, int basisSize, double *blockNorms, int *iev, int blockSize,
+      int *touch, double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
+      int *iwork, int iworkSize, primme_params *primme);
 int solve_correction_sprimme(float *V, PRIMME_INT ldV, float *W,
       PRIMME_INT ldW, float *evecs, PRIMME_INT ldevecs, float *evecsHat,
       PRIMME_INT ldevecsHat, float *UDU, int *ipivot, float *lockedEvals,
       int numLocked, int numConvergedStored, float *ritzVals,
-      float *prevRitzVals, int *numPrevRitzVals, int *flags, int basisSize,
-      float *blockNorms, int *iev, int blockSize, int *touch, double machEps,
-      float *rwork, size_t *rworkSize, int *iwork, int iworkSize,
-      primme_params *primme);
+      float *prevRitzVals, int *numPrevRitzVals, int *numPrevLocked,
+      float *precondShifts, int *numPrecondShifts, int *flags, int basisSize, float *blockNorms, int *iev, int blockSize,
+      int *touch, double machEps, float *rwork, size_t *rworkSize,
+      int *iwork, int iworkSize, primme_params *primme);
 int solve_correction_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *W,
       PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *evecs, PRIMME_INT ldevecs, PRIMME_COMPLEX_FLOAT *evecsHat,
       PRIMME_INT ldevecsHat, PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, float *lockedEvals,
       int numLocked, int numConvergedStored, float *ritzVals,
-      float *prevRitzVals, int *numPrevRitzVals, int *flags, int basisSize,
-      float *blockNorms, int *iev, int blockSize, int *touch, double machEps,
-      PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, int *iwork, int iworkSize,
-      primme_params *primme);
+      float *prevRitzVals, int *numPrevRitzVals, int *numPrevLocked,
+      float *precondShifts, int *numPrecondShifts, int *flags, int basisSize, float *blockNorms, int *iev, int blockSize,
+      int *touch, double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
+      int *iwork, int iworkSize, primme_params *primme);
 #endif
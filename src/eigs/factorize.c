@@ -36,6 +36,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <assert.h>
 #include "numerical.h"
 #include "factorize.h"
 
@@ -100,14 +101,16 @@ int UDUDecompose_Sprimme(SCALAR *M, int ldM, SCALAR *UDU, int ldUDU,
 
    if (dimM <= 1) {
       *UDU = *M;
+      *ipivot = 1;
       info = 0;
    }
    else {
 
-      /* Copy the upper triangular portion of M into UDU */
+      /* Copy the upper triangular portion of M into UDU. The lower part is */
+      /* zeroed because UDUUpdate stores there the bordering multipliers.   */
 
       Num_copy_trimatrix_Sprimme(M, dimM, dimM, ldM, 0 /* up */, 0, UDU,
-            ldUDU, 0);
+            ldUDU, 1);
 
       /* Perform the decomposition */
       CHKERR((Num_hetrf_Sprimme("U", dimM, UDU, ldUDU, ipivot, rwork,
@@ -117,6 +120,143 @@ int UDUDecompose_Sprimme(SCALAR *M, int ldM, SCALAR *UDU, int ldUDU,
    return 0;
 }
 
+/******************************************************************************
+ * Function UDUUpdate - This function extends the factorization of the leading
+ *   dimM0 x dimM0 block of M, computed by UDUDecompose or UDUUpdate, to the
+ *   leading dimM x dimM block by bordering. Being M = [M11 M12; M12' M22] and
+ *   M11 = L1*D1*L1', then
+ *
+ *      M = [L1 0; L2 I] * [D1 0; 0 S] * [L1' L2'; 0 I],
+ *
+ *   with L2' = D1^{-1}*L1^{-1}*M12 and S = M22 - L2*D1*L2'. Only S is
+ *   factorized with LAPACK routine dsytrf, so the cost is
+ *   O(dimM0^2*(dimM-dimM0)) instead of O(dimM^3).
+ *
+ *   The diagonal blocks of D are stored as returned by dsytrf in the upper
+ *   triangular part of UDU, with the pivots shifted to rows of UDU, and the
+ *   multipliers L2 below them. Both UDUDecompose and UDUUpdate store UDU
+ *   with leading dimension the dimension of the factorized matrix.
+ *
+ *
+ * Input Parameters
+ * ----------------
+ * M      A (numOrthoConst+numEvals) x (numOrthoConst+numEvals) array that
+ *        contains the upper triangular portion of a hermitian matrix
+ *
+ * ldM    The leading dimension of M
+ *
+ * dimM0  The dimension of the block already factorized in UDU
+ *
+ * dimM   The dimension of the block of M to factorize
+ *
+ * rwork  Scalar work array
+ *
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * UDU     Array of dimension dimM x dimM with the factors of M(0:dimM0-1,
+ *         0:dimM0-1) on input and the factors of M(0:dimM-1,0:dimM-1)
+ *         on output
+ *
+ * ipivot  Integer array of length dimM containing pivot mapping
+ *
+ * rworkSize  The size of rwork; if M is NULL, the workspace required
+ *
+ *
+ * Return Value
+ * ------------
+ * int error code
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int UDUUpdate_Sprimme(SCALAR *M, int ldM, SCALAR *UDU, int *ipivot, int dimM0,
+      int dimM, SCALAR *rwork, size_t *rworkSize, primme_params *primme) {
+
+   int i, j, info;
+   int n = dimM - dimM0;   /* Number of new rows and columns */
+   SCALAR *X, *Y, *S;
+
+   /* Quick return for M with dimension 0 */
+
+   if (dimM == 0) return 0;
+
+   /* Return memory requirement */
+
+   if (M == NULL) {
+      SCALAR w;
+      Num_hetrf_Sprimme("U", dimM, UDU, dimM, ipivot, &w, -1, &info);
+      *rworkSize = max(*rworkSize, (size_t)dimM*dimM + (size_t)REAL_PART(w));
+      return 0;
+   }
+
+   /* Quick return if nothing has been appended */
+
+   if (n <= 0) return 0;
+
+#ifdef USE_ZGESV
+   /* Without dsytrf the factorization is computed from scratch */
+   dimM0 = 0;
+#endif
+
+   if (dimM0 == 0) {
+      return UDUDecompose_Sprimme(M, ldM, UDU, 0, ipivot, dimM, rwork,
+            rworkSize, primme);
+   }
+
+   /* Move the factors of M11 from leading dimension dimM0 to dimM, starting */
+   /* from the last entry, and zero the upper part of the new columns        */
+
+   for (j=dimM0-1; j>=0; j--) {
+      for (i=dimM0-1; i>=0; i--) {
+         UDU[dimM*j+i] = UDU[dimM0*j+i];
+      }
+   }
+   Num_zero_matrix_Sprimme(&UDU[dimM*dimM0], dimM0, n, dimM);
+
+   /* X = L1^{-1}*M12 and Y = D1^{-1}*X = L2' */
+
+   assert(*rworkSize >= (size_t)dimM0*n*2 + 1);
+   X = rwork;
+   Y = X + dimM0*n;
+   Num_copy_matrix_Sprimme(&M[ldM*dimM0], dimM0, n, ldM, X, dimM0);
+   Num_trsm_Sprimme("L", "L", "N", "U", dimM0, n, 1.0, UDU, dimM, X, dimM0);
+   Num_copy_matrix_Sprimme(X, dimM0, n, dimM0, Y, dimM0);
+   CHKERR((Num_hetrs_Sprimme("U", dimM0, n, UDU, dimM, ipivot, Y, dimM0,
+               &info), info), -1);
+
+   for (j=0; j<dimM0; j++) {
+      for (i=0; i<n; i++) {
+         UDU[dimM*j+dimM0+i] = CONJ(Y[dimM0*i+j]);
+      }
+   }
+
+   /* S = M22 - X'*Y */
+
+   S = &UDU[dimM*dimM0+dimM0];
+   Num_copy_trimatrix_Sprimme(&M[ldM*dimM0+dimM0], n, n, ldM, 0 /* up */, 0,
+         S, dimM, 0);
+   Num_gemm_Sprimme("C", "N", n, n, dimM0, -1.0, X, dimM0, Y, dimM0, 1.0, S,
+         dimM);
+
+   /* Factorize S, using the space of X and Y as workspace */
+
+   CHKERR((Num_hetrf_Sprimme("U", n, S, dimM, &ipivot[dimM0], rwork,
+               TO_INT(*rworkSize), &info), info), -1);
+
+   /* Shift the pivots and zero the lower part of S */
+
+   for (i=dimM0; i<dimM; i++) {
+      ipivot[i] += ipivot[i] > 0 ? dimM0 : -dimM0;
+   }
+   for (j=0; j<n; j++) {
+      for (i=j+1; i<n; i++) {
+         S[dimM*j+i] = 0.0;
+      }
+   }
+
+   return 0;
+}
+
 /******************************************************************************
  * Function UDUSolve - This function solves a dense hermitian linear system
  *   given a right hand side (rhs) and a UDU factorization.
@@ -160,8 +300,15 @@ int UDUSolve_Sprimme(SCALAR *UDU, int *ipivot, int dim, SCALAR *rhs,
    }
    else {
       Num_copy_Sprimme(dim, rhs, 1, sol, 1);
+#ifndef USE_ZGESV
+      /* Apply the inverse of the multipliers stored by UDUUpdate */
+      Num_trsm_Sprimme("L", "L", "N", "U", dim, 1, 1.0, UDU, dim, sol, dim);
+#endif
       CHKERR((Num_hetrs_Sprimme("U", dim, 1, UDU, dim, ipivot, sol, dim,
                   &info), info), -1);
+#ifndef USE_ZGESV
+      Num_trsm_Sprimme("L", "L", "C", "U", dim, 1, 1.0, UDU, dim, sol, dim);
+#endif
    }
 
    return 0;
@@ -42,6 +42,14 @@
 int UDUDecompose_dprimme(double *M, int ldM, double *UDU, int ldUDU,
       int *ipivot, int dimM, double *rwork, size_t *rworkSize,
       primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(UDUUpdate_Sprimme)
+#  define UDUUpdate_Sprimme CONCAT(UDUUpdate_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(UDUUpdate_Rprimme)
+#  define UDUUpdate_Rprimme CONCAT(UDUUpdate_,REAL_SUF)
+#endif
+int UDUUpdate_dprimme(double *M, int ldM, double *UDU, int *ipivot, int dimM0,
+      int dimM, double *rwork, size_t *rworkSize, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(UDUSolve_Sprimme)
 #  define UDUSolve_Sprimme CONCAT(UDUSolve_,SCALAR_SUF)
 #endif
@@ -53,16 +61,22 @@ int UDUSolve_dprimme(double *UDU, int *ipivot, int dim, double *rhs,
 int UDUDecompose_zprimme(PRIMME_COMPLEX_DOUBLE *M, int ldM, PRIMME_COMPLEX_DOUBLE *UDU, int ldUDU,
       int *ipivot, int dimM, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
       primme_params *primme);
+int UDUUpdate_zprimme(PRIMME_COMPLEX_DOUBLE *M, int ldM, PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, int dimM0,
+      int dimM, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, primme_params *primme);
 int UDUSolve_zprimme(PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, int dim, PRIMME_COMPLEX_DOUBLE *rhs,
    PRIMME_COMPLEX_DOUBLE *sol, primme_params *primme);
 int UDUDecompose_sprimme(float *M, int ldM, float *UDU, int ldUDU,
       int *ipivot, int dimM, float *rwork, size_t *rworkSize,
       primme_params *primme);
+int UDUUpdate_sprimme(float *M, int ldM, float *UDU, int *ipivot, int dimM0,
+      int dimM, float *rwork, size_t *rworkSize, primme_params *primme);
 int UDUSolve_sprimme(float *UDU, int *ipivot, int dim, float *rhs,
    float *sol, primme_params *primme);
 int UDUDecompose_cprimme(PRIMME_COMPLEX_FLOAT *M, int ldM, PRIMME_COMPLEX_FLOAT *UDU, int ldUDU,
       int *ipivot, int dimM, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
       primme_params *primme);
+int UDUUpdate_cprimme(PRIMME_COMPLEX_FLOAT *M, int ldM, PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, int dimM0,
+      int dimM, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, primme_params *primme);
 int UDUSolve_cprimme(PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, int dim, PRIMME_COMPLEX_FLOAT *rhs,
    PRIMME_COMPLEX_FLOAT *sol, primme_params *primme);
 #endif
@@ -33,9 +33,16 @@
  *
  ******************************************************************************/
 
+#include <assert.h>
+#include "const.h"
 #include "numerical.h"
 #include "globalsum.h"
 #include "wtime.h"
+#include "trace.h"
+
+static int entry_count(globalsum_queue *queue, int k);
+static void pack_queue(globalsum_queue *queue, int i, int j, SCALAR *buf);
+static void unpack_queue(globalsum_queue *queue, int i, int j, SCALAR *buf);
 
 TEMPLATE_PLEASE
 int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count, 
@@ -45,7 +52,7 @@ int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count,
    double t0=0.0;
 
    if (primme && primme->globalSumReal) {
-      t0 = primme_wTimer(0);
+      t0 = primme_get_wtime();
 
       /* If it is a complex type, count real and imaginary part */
 #ifdef USE_COMPLEX
@@ -56,7 +63,8 @@ int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count,
             "Error returned by 'globalSumReal' %d", ierr);
 
       primme->stats.numGlobalSum++;
-      primme->stats.timeGlobalSum += primme_wTimer(0) - t0;
+      primme->stats.timeGlobalSum += primme_get_wtime() - t0;
+      primme_trace_record(primme->trace, PRIMME_TRACE_GLOBALSUM, t0);
       primme->stats.volumeGlobalSum += count;
    }
    else {
@@ -65,3 +73,249 @@ int globalSum_Sprimme(SCALAR *sendBuf, SCALAR *recvBuf, int count,
 
    return 0;
 }
+
+/*******************************************************************************
+ * Subroutine globalSum_queue - Queue the reduction of the matrix A (or its
+ *    upper trapezoidal part if i0 >= 0), which will be summed up in place among
+ *    the processes by the next call to globalSum_flush. All entries in the
+ *    queue are reduced with a single call to globalSumReal when possible.
+ *
+ *    Until the queue is flushed, A cannot be read and the caller should not
+ *    call globalSum_Sprimme if that breaks the order of the reductions among
+ *    the processes.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * m, n, ldA   The number of rows and columns and the leading dimension of A
+ * i0          If >= 0, only A(0:i0+j,j) is reduced for every column j
+ * newSum      Zero if A is part of the reduction queued in the previous call,
+ *             as the stats only count the reductions merged
+ * rwork       Workspace used if the queue is full
+ * lrwork      Size of rwork
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * A           The matrix to reduce
+ * queue       The queue of pending reductions
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int globalSum_queue_Sprimme(SCALAR *A, int m, int n, PRIMME_INT ldA, int i0,
+      int newSum, globalsum_queue *queue, SCALAR *rwork, size_t lrwork,
+      primme_params *primme) {
+
+   int k;
+
+   /* Quick return */
+
+   if (m <= 0 || n <= 0 || !primme || primme->numProcs <= 1) return 0;
+
+   /* Finish the nonblocking sum and flush the queue if it is full */
+
+   CHKERR(globalSum_flush_wait_Sprimme(queue, primme), -1);
+   if (queue->size >= MAX_QUEUED_GLOBAL_SUMS) {
+      CHKERR(globalSum_flush_Sprimme(queue, rwork, lrwork, primme), -1);
+   }
+
+   k = queue->size++;
+   queue->A[k] = A;
+   queue->m[k] = m;
+   queue->n[k] = n;
+   queue->ldA[k] = ldA;
+   queue->i0[k] = i0;
+   queue->newSum[k] = newSum;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine globalSum_flush - Sum up among the processes all the matrices in
+ *    the queue, packing as many of them as fit in rwork in a single call to
+ *    globalSumReal, and empty the queue.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * rwork       Workspace, at least twice the size of the largest entry
+ * lrwork      Size of rwork
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * queue       The queue of pending reductions
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int globalSum_flush_Sprimme(globalsum_queue *queue, SCALAR *rwork,
+      size_t lrwork, primme_params *primme) {
+
+   int i, j, count, numSums;
+
+   /* Finish the nonblocking sum, if any */
+
+   CHKERR(globalSum_flush_wait_Sprimme(queue, primme), -1);
+
+   for (i=0; i<queue->size; i=j) {
+
+      /* Pack entries i:j-1 contiguously in rwork */
+
+      for (j=i, count=0, numSums=0; j<queue->size; j++) {
+         if ((size_t)(count + entry_count(queue, j))*2 > lrwork && j > i)
+            break;
+         count += entry_count(queue, j);
+         if (queue->newSum[j] || j == i) numSums++;
+      }
+      assert((size_t)count*2 <= lrwork);
+      pack_queue(queue, i, j, rwork);
+
+      CHKERR(globalSum_Sprimme(rwork, &rwork[count], count, primme), -1);
+      primme->stats.numGlobalSumMerged += numSums-1;
+
+      unpack_queue(queue, i, j, &rwork[count]);
+   }
+
+   queue->size = 0;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine globalSum_flush_start - Start summing up among the processes all
+ *    the matrices in the queue with globalSumRealStart. The sum is finished by
+ *    globalSum_flush_wait; meanwhile the queued matrices and buf cannot be
+ *    accessed.
+ *
+ *    If globalSumRealStart is not set or buf is too small, it does nothing;
+ *    the entries stay in the queue and they are reduced by globalSum_flush.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * buf         Workspace, at least twice the size of all entries
+ * lbuf        Size of buf
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * queue       The queue of pending reductions
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int globalSum_flush_start_Sprimme(globalsum_queue *queue, SCALAR *buf,
+      size_t lbuf, primme_params *primme) {
+
+   int k, count, numSums, ierr=0;
+   double t0;
+
+   if (!primme->globalSumRealStart || !primme->globalSumRealWait || !buf
+         || queue->size <= 0 || queue->sum) return 0;
+
+   for (k=0, count=0, numSums=0; k<queue->size; k++) {
+      count += entry_count(queue, k);
+      if (queue->newSum[k] || k == 0) numSums++;
+   }
+   if ((size_t)count*2 > lbuf) return 0;
+
+   pack_queue(queue, 0, queue->size, buf);
+   queue->sum = &buf[count];
+
+   t0 = primme_get_wtime();
+
+   /* If it is a complex type, count real and imaginary part */
+#ifdef USE_COMPLEX
+   count *= 2;
+#endif
+   CHKERRM((primme->globalSumRealStart(buf, queue->sum, &count, primme,
+               &queue->request, &ierr), ierr), -1,
+         "Error returned by 'globalSumRealStart' %d", ierr);
+
+   primme->stats.numGlobalSum++;
+   primme->stats.timeGlobalSum += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_GLOBALSUM, t0);
+   primme->stats.volumeGlobalSum += count;
+   primme->stats.numGlobalSumMerged += numSums-1;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine globalSum_flush_wait - Finish the sum started by
+ *    globalSum_flush_start, if any, copy the result back into the queued
+ *    matrices and empty the queue.
+ *
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * queue       The queue of pending reductions
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int globalSum_flush_wait_Sprimme(globalsum_queue *queue,
+      primme_params *primme) {
+
+   int ierr=0;
+   double t0;
+
+   if (!queue->sum) return 0;
+
+   t0 = primme_get_wtime();
+   CHKERRM((primme->globalSumRealWait(queue->request, primme, &ierr), ierr),
+         -1, "Error returned by 'globalSumRealWait' %d", ierr);
+   primme->stats.timeGlobalSum += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_GLOBALSUM, t0);
+
+   unpack_queue(queue, 0, queue->size, (SCALAR*)queue->sum);
+   queue->size = 0;
+   queue->sum = NULL;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Function entry_count - Return the number of elements of the entry k
+ ******************************************************************************/
+
+static int entry_count(globalsum_queue *queue, int k) {
+   return queue->i0[k] >= 0 ?
+      (queue->n[k]+1)*queue->n[k]/2 + queue->i0[k]*queue->n[k] :
+      queue->m[k]*queue->n[k];
+}
+
+/*******************************************************************************
+ * Subroutine pack_queue - Copy the entries i:j-1 contiguously into buf
+ ******************************************************************************/
+
+static void pack_queue(globalsum_queue *queue, int i, int j, SCALAR *buf) {
+
+   int k;
+
+   for (k=i; k<j; buf+=entry_count(queue, k), k++) {
+      if (queue->i0[k] >= 0) {
+         Num_copy_trimatrix_compact_Sprimme((SCALAR*)queue->A[k], queue->m[k],
+               queue->n[k], queue->ldA[k], queue->i0[k], buf, NULL);
+      }
+      else {
+         Num_copy_matrix_Sprimme((SCALAR*)queue->A[k], queue->m[k],
+               queue->n[k], queue->ldA[k], buf, queue->m[k]);
+      }
+   }
+}
+
+/*******************************************************************************
+ * Subroutine unpack_queue - Copy buf back into the entries i:j-1
+ ******************************************************************************/
+
+static void unpack_queue(globalsum_queue *queue, int i, int j, SCALAR *buf) {
+
+   int k;
+
+   for (k=i; k<j; buf+=entry_count(queue, k), k++) {
+      if (queue->i0[k] >= 0) {
+         Num_copy_compact_trimatrix_Sprimme(buf, queue->m[k], queue->n[k],
+               queue->i0[k], (SCALAR*)queue->A[k], queue->ldA[k]);
+      }
+      else {
+         Num_copy_matrix_Sprimme(buf, queue->m[k], queue->n[k], queue->m[k],
+               (SCALAR*)queue->A[k], queue->ldA[k]);
+      }
+   }
+}
@@ -41,10 +41,70 @@
 #endif
 int globalSum_dprimme(double *sendBuf, double *recvBuf, int count,
       primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_queue_Sprimme)
+#  define globalSum_queue_Sprimme CONCAT(globalSum_queue_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_queue_Rprimme)
+#  define globalSum_queue_Rprimme CONCAT(globalSum_queue_,REAL_SUF)
+#endif
+int globalSum_queue_dprimme(double *A, int m, int n, PRIMME_INT ldA, int i0,
+      int newSum, globalsum_queue *queue, double *rwork, size_t lrwork,
+      primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_flush_Sprimme)
+#  define globalSum_flush_Sprimme CONCAT(globalSum_flush_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_flush_Rprimme)
+#  define globalSum_flush_Rprimme CONCAT(globalSum_flush_,REAL_SUF)
+#endif
+int globalSum_flush_dprimme(globalsum_queue *queue, double *rwork,
+      size_t lrwork, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_flush_start_Sprimme)
+#  define globalSum_flush_start_Sprimme CONCAT(globalSum_flush_start_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_flush_start_Rprimme)
+#  define globalSum_flush_start_Rprimme CONCAT(globalSum_flush_start_,REAL_SUF)
+#endif
+int globalSum_flush_start_dprimme(globalsum_queue *queue, double *buf,
+      size_t lbuf, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_flush_wait_Sprimme)
+#  define globalSum_flush_wait_Sprimme CONCAT(globalSum_flush_wait_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(globalSum_flush_wait_Rprimme)
+#  define globalSum_flush_wait_Rprimme CONCAT(globalSum_flush_wait_,REAL_SUF)
+#endif
+int globalSum_flush_wait_dprimme(globalsum_queue *queue,
+      primme_params *primme);
 int globalSum_zprimme(PRIMME_COMPLEX_DOUBLE *sendBuf, PRIMME_COMPLEX_DOUBLE *recvBuf, int count,
       primme_params *primme);
+int globalSum_queue_zprimme(PRIMME_COMPLEX_DOUBLE *A, int m, int n, PRIMME_INT ldA, int i0,
+      int newSum, globalsum_queue *queue, PRIMME_COMPLEX_DOUBLE *rwork, size_t lrwork,
+      primme_params *primme);
+int globalSum_flush_zprimme(globalsum_queue *queue, PRIMME_COMPLEX_DOUBLE *rwork,
+      size_t lrwork, primme_params *primme);
+int globalSum_flush_start_zprimme(globalsum_queue *queue, PRIMME_COMPLEX_DOUBLE *buf,
+      size_t lbuf, primme_params *primme);
+int globalSum_flush_wait_zprimme(globalsum_queue *queue,
+      primme_params *primme);
 int globalSum_sprimme(float *sendBuf, float *recvBuf, int count,
       primme_params *primme);
+int globalSum_queue_sprimme(float *A, int m, int n, PRIMME_INT ldA, int i0,
+      int newSum, globalsum_queue *queue, float *rwork, size_t lrwork,
+      primme_params *primme);
+int globalSum_flush_sprimme(globalsum_queue *queue, float *rwork,
+      size_t lrwork, primme_params *primme);
+int globalSum_flush_start_sprimme(globalsum_queue *queue, float *buf,
+      size_t lbuf, primme_params *primme);
+int globalSum_flush_wait_sprimme(globalsum_queue *queue,
+      primme_params *primme);
 int globalSum_cprimme(PRIMME_COMPLEX_FLOAT *sendBuf, PRIMME_COMPLEX_FLOAT *recvBuf, int count,
       primme_params *primme);
+int globalSum_queue_cprimme(PRIMME_COMPLEX_FLOAT *A, int m, int n, PRIMME_INT ldA, int i0,
+      int newSum, globalsum_queue *queue, PRIMME_COMPLEX_FLOAT *rwork, size_t lrwork,
+      primme_params *primme);
+int globalSum_flush_cprimme(globalsum_queue *queue, PRIMME_COMPLEX_FLOAT *rwork,
+      size_t lrwork, primme_params *primme);
+int globalSum_flush_start_cprimme(globalsum_queue *queue, PRIMME_COMPLEX_FLOAT *buf,
+      size_t lbuf, primme_params *primme);
+int globalSum_flush_wait_cprimme(globalsum_queue *queue,
+      primme_params *primme);
 #endif
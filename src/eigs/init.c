@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include "const.h"
 #include "numerical.h"
 #include "init.h"
 #include "update_projection.h"
@@ -47,7 +48,8 @@
 #include "wtime.h"                       /* Needed for CostModel */
 
 static int init_block_krylov(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      SCALAR *W, PRIMME_INT ldW, int dv1, int dv2, SCALAR *locked,
+      SCALAR *W, PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, int dv1,
+      int dv2, SCALAR *locked,
       PRIMME_INT ldlocked, int numLocked, double machEps, SCALAR *rwork,
       size_t *rworkSize, primme_params *primme);
 
@@ -109,6 +111,9 @@ static int init_block_krylov(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
  *
  * W            A*V
  *
+ * BV           B*V, if massMatrixMatvec and massMatrixCache are set
+ *              (optional). V is B-orthonormalized in generalized problems
+ *
  * evecsHat     K^{-1}*evecs, given a preconditioner K
  *
  * M            evecs'*evecsHat.  Its dimension is as large as 
@@ -125,7 +130,8 @@ static int init_block_krylov(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
 
 TEMPLATE_PLEASE
 int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      SCALAR *W, PRIMME_INT ldW, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *W, PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, SCALAR *evecs,
+      PRIMME_INT ldevecs,
       SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *M, int ldM, SCALAR *UDU,
       int ldUDU, int *ipivot, double machEps, SCALAR *rwork, size_t *rworkSize,
       int *basisSize, int *nextGuess, int *numGuesses, primme_params *primme) {
@@ -133,12 +139,14 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
    int i;
    int initSize;
    int random=0;
+   int warmSize;
 
    /* Return memory requirement */
 
    if (V == NULL) {
       update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal,
-            0, primme->numOrthoConst, NULL, rworkSize, 1/*symmetric*/, primme);
+            0, primme->numOrthoConst, NULL, rworkSize, 1/*symmetric*/, NULL,
+            primme);
       UDUDecompose_Sprimme(NULL, 0, NULL, 0, NULL,
             primme->numOrthoConst, NULL, rworkSize, primme);
       ortho_Sprimme(NULL, 0, NULL, 0, 0, 
@@ -147,6 +155,8 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       ortho_Sprimme(NULL, 0, NULL, 0, 0, *basisSize-1, 
             NULL, 0, primme->numOrthoConst, nLocal, 
             NULL, 0.0, NULL, rworkSize, primme);
+      ortho_B_Sprimme(NULL, 0, NULL, 0, 0, *basisSize-1, nLocal, NULL, 0.0,
+            NULL, rworkSize, primme);
       return 0;
    }
 
@@ -174,7 +184,7 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
 
          CHKERR(update_projection_Sprimme(evecs, ldevecs, evecsHat,
                   ldevecsHat, M, ldM, nLocal, 0, primme->numOrthoConst, rwork,
-                  rworkSize, 1/*symmetric*/, primme), -1);
+                  rworkSize, 1/*symmetric*/, NULL, primme), -1);
 
          CHKERR(UDUDecompose_Sprimme(M, ldM, UDU, ldUDU, ipivot,
                   primme->numOrthoConst, rwork, rworkSize, primme), -1);
@@ -184,6 +194,43 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
    }  /* if numOrthoCont >0 */
 
 
+   /* If checkpointFun restores a basis, continue from it as it is; the  */
+   /* initial guesses are not used                                        */
+
+   if (primme->checkpointFun) {
+      *basisSize = 0;
+      CHKERR(checkpoint_Sprimme(V, ldV, W, ldW, basisSize, 1, primme), -1);
+      if (*basisSize > 0) {
+         *numGuesses = 0;
+         *nextGuess = primme->numOrthoConst;
+         return 0;
+      }
+   }
+
+   /* If the basis of the previous call is kept in V (see warmStart), add */
+   /* the initial guesses after it and refresh W with a single matvec     */
+
+   warmSize = primme->warmStart ?
+      max(0, min(primme->warmBasisSize, primme->maxBasisSize)) : 0;
+   if (warmSize > 0) {
+      initSize = min(primme->maxBasisSize - warmSize, primme->initSize);
+      if (primme->locking) initSize = min(primme->minRestartSize, initSize);
+      *numGuesses = primme->initSize - initSize;
+      *nextGuess = primme->numOrthoConst + initSize;
+      Num_copy_matrix_Sprimme(&evecs[primme->numOrthoConst*ldevecs],
+            nLocal, initSize, ldevecs, &V[ldV*warmSize], ldV);
+      *basisSize = warmSize + initSize;
+
+      CHKERR(ortho_Sprimme(V, ldV, NULL, 0, 0, *basisSize-1, 
+            evecs, ldevecs, primme->numOrthoConst, nLocal, 
+            primme->iseed, machEps, rwork, rworkSize, primme), -1)
+
+      CHKERR(matrixMatvec_Sprimme(V, nLocal, ldV, W, ldW, 0, *basisSize,
+               primme), -1);
+
+      return 0;
+   }
+
    /* Handle case when some or all initial guesses are provided by */ 
    /* the user                                                     */
    if (!primme->locking) {
@@ -219,15 +266,21 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
    *basisSize = initSize + random;
 
    /* Orthonormalize the guesses provided by the user */ 
-   CHKERR(ortho_Sprimme(V, ldV, NULL, 0, 0, *basisSize-1, 
-         evecs, ldevecs, primme->numOrthoConst, nLocal, 
-         primme->iseed, machEps, rwork, rworkSize, primme), -1)
+   if (primme->massMatrixMatvec) {
+      CHKERR(ortho_B_Sprimme(V, ldV, BV, ldBV, 0, *basisSize-1, nLocal,
+               primme->iseed, machEps, rwork, rworkSize, primme), -1);
+   }
+   else {
+      CHKERR(ortho_Sprimme(V, ldV, NULL, 0, 0, *basisSize-1, 
+            evecs, ldevecs, primme->numOrthoConst, nLocal, 
+            primme->iseed, machEps, rwork, rworkSize, primme), -1)
+   }
 
    CHKERR(matrixMatvec_Sprimme(V, nLocal, ldV, W, ldW, 0, *basisSize,
             primme), -1);
 
    if (primme->initBasisMode == primme_init_krylov) {
-      CHKERR(init_block_krylov(V, nLocal, ldV, W, ldW, *basisSize,
+      CHKERR(init_block_krylov(V, nLocal, ldV, W, ldW, BV, ldBV, *basisSize,
             primme->minRestartSize-1, evecs, ldevecs, primme->numOrthoConst,
             machEps, rwork, rworkSize, primme), -1); 
 
@@ -240,7 +293,8 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
 
 /*******************************************************************************
  * Subroutine init_block_krylov - Initializes the basis as an orthonormal 
- *    block Krylov subspace.  
+ *    block Krylov subspace.  Every step applies the matrix to the last block
+ *    in a single call and orthogonalizes the new block with a single ortho.
  *
  * INPUT ARRAYS AND PARAMETERS
  * ---------------------------
@@ -263,6 +317,8 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
  * 
  * W  A*V
  *
+ * BV B*V, if massMatrixMatvec is set (optional)
+ *
  * Return value
  * ------------
  * int -  0 upon success
@@ -271,23 +327,24 @@ int init_basis_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
  ******************************************************************************/
 
 static int init_block_krylov(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      SCALAR *W, PRIMME_INT ldW, int dv1, int dv2, SCALAR *locked,
+      SCALAR *W, PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, int dv1,
+      int dv2, SCALAR *locked,
       PRIMME_INT ldlocked, int numLocked, double machEps, SCALAR *rwork,
       size_t *rworkSize, primme_params *primme) {
 
    int i;               /* Loop variables */
    int numNewVectors;   /* Number of vectors to be generated */
    int blockSize;       /* blockSize used in practice */
+   int nb;              /* Number of vectors generated in a step */
    
    numNewVectors = dv2 - dv1 + 1;
 
    /*----------------------------------------------------------------------*/
-   /* Generate a single Krylov space if there are only a few vectors to be */
-   /* generated, else generate a block Krylov space with                   */
-   /* primme->maxBlockSize as the block Size.                              */ 
+   /* Generate a block Krylov space with primme->maxBlockSize as the block */
+   /* size, or a single block if there are only a few vectors to generate. */
    /*----------------------------------------------------------------------*/
 
-   blockSize = numNewVectors <= primme->maxBlockSize ? 1 : primme->maxBlockSize;
+   blockSize = min(numNewVectors, primme->maxBlockSize);
 
    /*----------------------------------------------------------------------*/
    /* Generate the initial vectors.                                        */
@@ -298,22 +355,36 @@ static int init_block_krylov(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
          Num_larnv_Sprimme(2, primme->iseed, nLocal, &V[ldV*i]);
       }
    }
-   CHKERR(ortho_Sprimme(V, ldV, NULL, 0, dv1, 
+   if (primme->massMatrixMatvec) {
+      CHKERR(ortho_B_Sprimme(V, ldV, BV, ldBV, dv1, dv1+blockSize-1, nLocal,
+               primme->iseed, machEps, rwork, rworkSize, primme), -1);
+   }
+   else {
+      CHKERR(ortho_Sprimme(V, ldV, NULL, 0, dv1, 
             dv1+blockSize-1, locked, ldlocked, numLocked, 
             nLocal, primme->iseed, machEps, rwork, rworkSize, primme), -1);
+   }
 
-   /* Generate the remaining vectors in the sequence */
+   /* Generate the remaining vectors in the sequence, a block at a time; */
+   /* the last block may be smaller                                        */
 
-   for (i = dv1+blockSize; i <= dv2; i++) {
+   for (i = dv1+blockSize; i <= dv2; i += nb) {
+      nb = min(blockSize, dv2-i+1);
       CHKERR(matrixMatvec_Sprimme(&V[ldV*(i-blockSize)], nLocal, ldV,
-               &V[ldV*i], ldV, 0, 1, primme), -1);
+               &V[ldV*i], ldV, 0, nb, primme), -1);
 
-      Num_copy_Sprimme(nLocal, &V[ldV*i], 1,
-         &W[ldW*(i-blockSize)], 1);
+      Num_copy_matrix_Sprimme(&V[ldV*i], nLocal, nb, ldV,
+            &W[ldW*(i-blockSize)], ldW);
 
-      CHKERR(ortho_Sprimme(V, ldV, NULL, 0, i, i, locked, 
-               ldlocked, numLocked, nLocal, primme->iseed, machEps,
-               rwork, rworkSize, primme), -1);
+      if (primme->massMatrixMatvec) {
+         CHKERR(ortho_B_Sprimme(V, ldV, BV, ldBV, i, i+nb-1, nLocal,
+                  primme->iseed, machEps, rwork, rworkSize, primme), -1);
+      }
+      else {
+         CHKERR(ortho_Sprimme(V, ldV, NULL, 0, i, i+nb-1, locked, 
+                  ldlocked, numLocked, nLocal, primme->iseed, machEps,
+                  rwork, rworkSize, primme), -1);
+      }
    }
 
    CHKERR(matrixMatvec_Sprimme(V, nLocal, ldV, W, ldW, dv2-blockSize+1,
@@ -40,22 +40,26 @@
 #  define init_basis_Rprimme CONCAT(init_basis_,REAL_SUF)
 #endif
 int init_basis_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      double *W, PRIMME_INT ldW, double *evecs, PRIMME_INT ldevecs,
+      double *W, PRIMME_INT ldW, double *BV, PRIMME_INT ldBV, double *evecs,
+      PRIMME_INT ldevecs,
       double *evecsHat, PRIMME_INT ldevecsHat, double *M, int ldM, double *UDU,
       int ldUDU, int *ipivot, double machEps, double *rwork, size_t *rworkSize,
       int *basisSize, int *nextGuess, int *numGuesses, primme_params *primme);
 int init_basis_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *evecs, PRIMME_INT ldevecs,
+      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *BV, PRIMME_INT ldBV, PRIMME_COMPLEX_DOUBLE *evecs,
+      PRIMME_INT ldevecs,
       PRIMME_COMPLEX_DOUBLE *evecsHat, PRIMME_INT ldevecsHat, PRIMME_COMPLEX_DOUBLE *M, int ldM, PRIMME_COMPLEX_DOUBLE *UDU,
       int ldUDU, int *ipivot, double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
       int *basisSize, int *nextGuess, int *numGuesses, primme_params *primme);
 int init_basis_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      float *W, PRIMME_INT ldW, float *evecs, PRIMME_INT ldevecs,
+      float *W, PRIMME_INT ldW, float *BV, PRIMME_INT ldBV, float *evecs,
+      PRIMME_INT ldevecs,
       float *evecsHat, PRIMME_INT ldevecsHat, float *M, int ldM, float *UDU,
       int ldUDU, int *ipivot, double machEps, float *rwork, size_t *rworkSize,
       int *basisSize, int *nextGuess, int *numGuesses, primme_params *primme);
 int init_basis_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
-      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *evecs, PRIMME_INT ldevecs,
+      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *BV, PRIMME_INT ldBV, PRIMME_COMPLEX_FLOAT *evecs,
+      PRIMME_INT ldevecs,
       PRIMME_COMPLEX_FLOAT *evecsHat, PRIMME_INT ldevecsHat, PRIMME_COMPLEX_FLOAT *M, int ldM, PRIMME_COMPLEX_FLOAT *UDU,
       int ldUDU, int *ipivot, double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
       int *basisSize, int *nextGuess, int *numGuesses, primme_params *primme);
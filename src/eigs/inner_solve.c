@@ -29,7 +29,7 @@
  *******************************************************************************
  * File: inner_solve.c
  *
- * Purpose - Solves the correction equation using hermitian simplified QMR.
+ * Purpose - Solves the correction equations using hermitian simplified QMR.
  *  
  ******************************************************************************/
 
@@ -46,36 +46,123 @@
 #include "globalsum.h"
 #include "auxiliary_eigs.h"
 
-static int apply_projected_preconditioner(SCALAR *v, SCALAR *Q, PRIMME_INT ldQ,
-      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, SCALAR *x,
-      SCALAR *RprojectorX,  PRIMME_INT ldRprojectorX, int sizeRprojectorQ,
-      int sizeRprojectorX, SCALAR *xKinvx, SCALAR *UDU, int *ipivot,
-      SCALAR *result, SCALAR *rwork, primme_params *primme);
+/* Number of QMR vectors per equation and of inner products per equation */
+/* summed up in every iteration of the pipelined variant                  */
+
+#define SIMPLIFIED_NUM_VECS 5
+#define PIPELINED_NUM_VECS 11
+#define PIPELINED_NUM_DOTS 9
+
+/* State of the simplified QMR recurrences of one correction equation */
+
+typedef struct {
+   int j;             /* Index of the equation in the block                  */
+   int numIts;        /* Number of inner iterations                          */
+   int touch;         /* Parameter used in the stopping criteria             */
+   int stop;          /* Nonzero if the equation does not iterate any more   */
+   int last;          /* Nonzero if the next step is the last one (pipelined)*/
+   REAL eval;         /* The Ritz value                                      */
+   REAL shift;        /* The shift of the correction equation                */
+   double LTolerance, ETolerance, LTolerance_factor, ETolerance_factor;
+   double sigma_prev, alpha_prev, rho_prev;
+   double Theta_prev, Theta, tau_init, tau_prev, tau;
+   double gamma, eta;
+   double Beta, Delta, Psi, Beta_prev, Delta_prev, Psi_prev;
+   double Gamma, Phi, Gamma_prev, Phi_prev;
+   double eval_prev, eval_updated, eres_prev, eres_updated;
+} qmr_state;
+
+static void set_tolerances(qmr_state *st, double aNorm, double machEps,
+      primme_params *primme);
+
+static int simplified_qmr(int blockSize, SCALAR *x, PRIMME_INT ldx, SCALAR *r,
+      PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *UDU, int *ipivot, SCALAR *xKinvx, SCALAR *Lprojector,
+      PRIMME_INT ldLprojector, SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      qmr_state *st, double *shifts, int maxIterations, int adaptive,
+      double machEps, SCALAR *V, PRIMME_INT ldw, REAL *dots, SCALAR *rwork,
+      primme_params *primme);
+
+static int pipelined_qmr(int blockSize, SCALAR *x, PRIMME_INT ldx, SCALAR *r,
+      PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *UDU, int *ipivot, SCALAR *xKinvx, SCALAR *Lprojector,
+      PRIMME_INT ldLprojector, SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      qmr_state *st, double *shifts, int maxIterations, int adaptive,
+      double machEps, SCALAR *V, PRIMME_INT ldw, SCALAR *dots, SCALAR *rwork,
+      primme_params *primme);
+
+static int compact_equations(int numActive, int blockSize, qmr_state *st,
+      double *shifts, SCALAR *V, int numVecs, PRIMME_INT ldw,
+      primme_params *primme);
+
+static void stop_exhausted_equations(int numActive, int maxIterations,
+      qmr_state *st, primme_params *primme);
+
+static int breakdown(qmr_state *st, double machEps, primme_params *primme);
+
+static void update_solution(qmr_state *st, double gnorm2, SCALAR *d,
+      SCALAR *delta, SCALAR *sol, primme_params *primme);
+
+static int check_linear_residual(qmr_state *st, primme_params *primme);
+
+static int check_eigenresidual(qmr_state *st, int adaptive, double dot_sol,
+      REAL rnorm, primme_params *primme);
+
+static void shift_recurrences(qmr_state *st);
+
+static int apply_projected_preconditioner(SCALAR *v, PRIMME_INT ldv, int n,
+      qmr_state *st, double *shifts, SCALAR *Q, PRIMME_INT ldQ,
+      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, int sizeRprojectorQ,
+      SCALAR *UDU, int *ipivot, SCALAR *x, PRIMME_INT ldx,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeRprojectorX,
+      SCALAR *xKinvx, SCALAR *result, PRIMME_INT ldresult, SCALAR *rwork,
+      primme_params *primme);
 
 static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
       PRIMME_INT ldQhat, SCALAR *UDU, int *ipivot, int numCols, SCALAR *v,
+      PRIMME_INT ldv, int n, SCALAR *rwork, primme_params *primme);
+
+static int apply_skew_projector_x(SCALAR *x, PRIMME_INT ldx, SCALAR *xhat,
+      PRIMME_INT ldxhat, SCALAR *xKinvx, qmr_state *st, SCALAR *v,
+      PRIMME_INT ldv, int n, SCALAR *rwork, primme_params *primme);
+
+static int apply_projected_matrix(SCALAR *v, PRIMME_INT ldv, int n,
+      qmr_state *st, SCALAR *Q, PRIMME_INT ldQ, int dimQ, SCALAR *x,
+      PRIMME_INT ldx, int dimX, SCALAR *result, PRIMME_INT ldresult,
       SCALAR *rwork, primme_params *primme);
 
-static int apply_projected_matrix(SCALAR *v, REAL shift, SCALAR *Q, 
-      PRIMME_INT ldQ, int dimQ, SCALAR *result, SCALAR *rwork,
-      primme_params *primme);
+static int apply_projector(SCALAR *Q, PRIMME_INT ldQ, int dimQ, SCALAR *x,
+      PRIMME_INT ldx, int dimX, qmr_state *st, SCALAR *v, PRIMME_INT ldv,
+      int n, SCALAR *rwork, primme_params *primme);
 
-static int apply_projector(SCALAR *Q, PRIMME_INT ldQ, int numCols, SCALAR *v, 
-   SCALAR *rwork, primme_params *primme);
+#ifdef USE_LOWER_INNER
+#  define inner_solve_Lprimme CONCAT(inner_solve_,LSCALAR_SUF)
 
-static int dist_dot(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, SCALAR *result);
+static int inner_solve_lower(int blockSize, SCALAR *x, PRIMME_INT ldx,
+      SCALAR *r, PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs,
+      PRIMME_INT ldevecs, SCALAR *UDU, int *ipivot, SCALAR *xKinvx,
+      SCALAR *Lprojector, PRIMME_INT ldLprojector, SCALAR *RprojectorQ,
+      PRIMME_INT ldRprojectorQ, SCALAR *RprojectorX, PRIMME_INT ldRprojectorX,
+      int sizeLprojector, int sizeLprojectorX, int sizeRprojectorQ,
+      int sizeRprojectorX, SCALAR *sol, PRIMME_INT ldsol, REAL *eval,
+      double *shift, int *touch, double machEps, primme_params *primme);
+#endif
 
-static int dist_dot_real(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, REAL *result);
+static int dist_dots_real(SCALAR *x, PRIMME_INT ldx, SCALAR *y,
+      PRIMME_INT ldy, int n, REAL *result, SCALAR *rwork,
+      primme_params *primme);
 
 
 /*******************************************************************************
- * Function inner_solve - This subroutine solves the correction equation
+ * Function inner_solve - This subroutine solves the correction equations
  *    
- *           (I-QQ')(I-xx')(A-shift*I)(I-xx')(I-QQ')sol = -r 
+ *           (I-QQ')(I-x_jx_j')(A-shift_j*I)(I-x_jx_j')(I-QQ')sol_j = -r_j 
  *
- *    with Q = evecs, using hermitian simplified QMR.
+ *    for j=0:blockSize-1 with Q = evecs, using hermitian simplified QMR.
  *    A preconditioner may be applied to this system to accelerate convergence.
  *    The preconditioner is assumed to approximate (A-shift*I)^{-1}.  The
  *    classical JD method as described in Templates for the Solution of 
@@ -85,64 +172,82 @@ static int dist_dot_real(SCALAR *x, int incx,
  *    and setup_JD_projectors(). The QMR transparently calls the resulting
  *    projected matrix and preconditioner.
  *
+ *    The equations are solved simultaneously: every inner step calls the
+ *    matvec and the preconditioner once with all equations still iterating,
+ *    and reduces their inner products in a single global sum. Every equation
+ *    keeps its own recurrences and stopping criteria, so the result is
+ *    equivalent in exact arithmetic to solving them one after another;
+ *    rounding of the block reductions may differ.
+ *
+ *    If primme.pipelinedQMR, the iterations are reorganized as
+ *    in pipelined CG, so that all inner products of an iteration are summed
+ *    up together, overlapping the application of the preconditioner and
+ *    the matrix (see pipelined_qmr).
+ *
  *
  * Input parameters
  * ----------------
- * x           The current Ritz vector for which the correction is being solved.
+ * blockSize   The number of correction equations
  *
- * r           The residual with respect to the Ritz vector.
+ * x           The current Ritz vectors for which the corrections are being
+ *             solved.
  *
- * evecs       The converged Ritz vectors
+ * r           The residuals with respect to the Ritz vectors.
  *
- * evecsHat    K^{-1}*evecs where K is a hermitian preconditioner.
+ * evecs       The converged Ritz vectors
  *
  * UDU         The factors of the hermitian projection (evecs'*evecsHat). 
  *
  * ipivot      The pivoting for the UDU factorization
  *
- * xKinvx      The value x'*Kinv*x needed if skew-X projection
+ * xKinvx      The values x_j'*Kinv*x_j needed if skew-X projection
  *
- * Lprojector  Points to an array that includes all the left projector.
- *             Can be any combination of [evecs x], [evecs], [x], NULL.
+ * Lprojector  Points to an array that includes the left projector for Q.
+ *             It can be [evecs] or NULL.
  *
  * RprojectorQ Points to an array that includes the right skew projector for Q:
  *             It can be [evecsHat] or Null
  *
  * RprojectorX Points to an array that includes the right skew projector for x:
- *             It can be [Kinvx] or Null
+ *             It can be [Kinvx], x or Null
  *
  * sizeLprojector   Number of colums of Lprojector
  *
+ * sizeLprojectorX  One if the left projector includes x_j, and zero otherwise
+ *
  * sizeRprojectorQ  Number of colums of RprojectorQ
  *
- * sizeRprojectorX  Number of colums of LprojectorX
+ * sizeRprojectorX  One if there is a right projector for x_j, and zero
+ *                  otherwise
  *
- * eval        The current Ritz value 
+ * eval        The current Ritz values
  *
- * shift       Correction eq. shift. The closer the shift is to the target 
+ * shift       Correction eq. shifts. The closer the shift is to the target 
  *             eigenvalue, the more accurate the correction will be.
  *
  * machEps     machine precision
  *
- * rwork       Real workspace of size 
- *             4*primme->nLocal + 2*(primme->numOrthoConst+primme->numEvals)
+ * rwork       Real workspace
  *
- * rworkSize   Size of the rwork array
+ * rworkSize   Size of the rwork array. If x is NULL, the function returns
+ *             the size needed in rworkSize.
  *
  * primme      Structure containing various solver parameters
  *
  *
  * Input/Output parameters
  * -----------------------
- * r       The residual with respect to the Ritz vector.  May be altered upon
+ * r       The residuals with respect to the Ritz vectors. May be altered upon
  *         return.
- * rnorm   On input, the 2 norm of r. No need to recompute it initially.
- *         On output, the estimated 2 norm of the updated eigenvalue residual
- * touch   Parameter used in inner solve stopping criteria
+ * rnorm   On input, the 2 norms of r. No need to recompute them initially.
+ *         On output, the estimated 2 norms of the updated eigenvalue residuals
+ * touch   Parameter used in inner solve stopping criteria. On output, the
+ *         largest value taken by any equation.
  * 
  * Output parameters
  * -----------------
- * sol   The solution (correction) of the correction equation
+ * sol   The solutions (corrections) of the correction equations. It is
+ *       written after the last use of x, so it may be x.
  *
  * Return Value
  * ------------
@@ -152,65 +257,606 @@ static int dist_dot_real(SCALAR *x, int incx,
  ******************************************************************************/
 
 TEMPLATE_PLEASE
-int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
-      PRIMME_INT ldevecs, SCALAR *UDU, int *ipivot, SCALAR *xKinvx,
-      SCALAR *Lprojector, PRIMME_INT ldLprojector, SCALAR *RprojectorQ,
-      PRIMME_INT ldRprojectorQ, SCALAR *RprojectorX, PRIMME_INT ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, SCALAR *sol,
-      REAL eval, REAL shift, int *touch, double machEps, SCALAR *rwork,
-      size_t rworkSize, primme_params *primme) {
+int inner_solve_Sprimme(int blockSize, SCALAR *x, PRIMME_INT ldx, SCALAR *r,
+      PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *UDU, int *ipivot, SCALAR *xKinvx, SCALAR *Lprojector,
+      PRIMME_INT ldLprojector, SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      SCALAR *sol, PRIMME_INT ldsol, REAL *eval, double *shift, int *touch,
+      double machEps, SCALAR *rwork, size_t *rworkSize,
+      primme_params *primme) {
 
-   int i;             /* loop variable                                       */
-   int numIts;        /* Number of inner iterations                          */
+   int k;             /* loop variable                                       */
    int maxIterations; /* The maximum # iterations allowed. Depends on primme */
-
-   SCALAR *workSpace; /* Workspace needed by UDU routine */
-
-   /* QMR parameters */
-
-   SCALAR *g, *d, *delta, *w, *ptmp;
-   REAL sigma_prev;
-   double alpha_prev, beta, rho_prev, rho;
-   double Theta_prev, Theta, c, tau_init, tau_prev, tau; 
-
-   /* Parameters used to dynamically update eigenpair */
-   REAL dot_sol;
-   double Beta=0.0, Delta=0.0, Psi=0.0, Beta_prev, Delta_prev, Psi_prev, eta;
-   double eval_updated, eval_prev, eres2_updated, eres_updated=0.0;
-   double eres_prev=0.0;
-   double Gamma_prev, Phi_prev;
-   double Gamma=0.0, Phi=0.0;
-   double gamma;
-
-   double LTolerance, ETolerance, LTolerance_factor, ETolerance_factor;
-   int isConv;
+   int adaptive;      /* Nonzero if stopping by the eigenresidual estimate   */
+   int numVecs;       /* Number of QMR vectors per equation                  */
+   PRIMME_INT ldw;    /* The leading dimension of the QMR vectors            */
+   size_t workSpaceSize; /* Size of workSpace                                */
+   size_t dotsSize;   /* Size of dots                                        */
    double aNorm;
 
+   SCALAR *workSpace; /* Workspace needed by the projectors                  */
+   SCALAR *dots;      /* Workspace for the inner products                    */
+   SCALAR *sol0;      /* The solutions, ordered as st                        */
+   qmr_state *st;     /* State of the equations, ordered as the columns of   */
+                      /* the QMR vectors                                     */
+   double *shifts;    /* The shifts of the equations ordered as st           */
+
+#ifdef USE_LOWER_INNER
+   /* Solve the equations in single precision; inner_solve_lower allocates */
+   /* its own workspace                                                    */
+
+   if (primme->innerSinglePrecision && !primme->massMatrixMatvec) {
+      if (x == NULL) return 0;
+      return inner_solve_lower(blockSize, x, ldx, r, ldr, rnorm, evecs,
+            ldevecs, UDU, ipivot, xKinvx, Lprojector, ldLprojector,
+            RprojectorQ, ldRprojectorQ, RprojectorX, ldRprojectorX,
+            sizeLprojector, sizeLprojectorX, sizeRprojectorQ, sizeRprojectorX,
+            sol, ldsol, eval, shift, touch, machEps, primme);
+   }
+#endif
+
    /* -------------------------------------------*/
    /* Subdivide the workspace into needed arrays */
    /* -------------------------------------------*/
 
-   g      = rwork;
-   d      = g + primme->nLocal;
-   delta  = d + primme->nLocal;
-   w      = delta + primme->nLocal;
-   workSpace = w + primme->nLocal; /* This needs at least 2*numOrth+NumEvals) */
-   assert(rworkSize >= (size_t)primme->nLocal*4
-                       + 2*(primme->numOrthoConst+primme->numEvals));
+   ldw = primme->ldOPs > 0 ? primme->ldOPs : primme->nLocal;
+   numVecs = primme->pipelinedQMR ?
+      PIPELINED_NUM_VECS : SIMPLIFIED_NUM_VECS;
+   workSpaceSize =
+      2*((size_t)primme->numOrthoConst+primme->numEvals+1)*blockSize;
+   dotsSize = (size_t)PIPELINED_NUM_DOTS*3*blockSize;
+
+   /* Return memory requirements */
+
+   if (x == NULL) {
+      *rworkSize = max(*rworkSize, (size_t)ldw*blockSize*numVecs
+            + workSpaceSize + dotsSize
+            + ((sizeof(qmr_state)+sizeof(double))*blockSize + sizeof(double))
+                  /sizeof(SCALAR) + 1);
+      return 0;
+   }
+
+   double t0 = primme_get_wtime();
+
+   sol0   = rwork + ldw*blockSize*(numVecs-1);
+   workSpace = sol0 + ldw*blockSize;
+   dots   = workSpace + workSpaceSize;
+   st     = (qmr_state*)ALIGN(dots + dotsSize, double);
+   shifts = (double*)(st + blockSize);
+   assert((size_t)((SCALAR*)(shifts + blockSize) - rwork) <= *rworkSize);
 
    /* -----------------------------------------*/
    /* Set up convergence criteria by Tolerance */
    /* -----------------------------------------*/
 
    aNorm = max(primme->stats.estimateLargestSVal, primme->aNorm);
-   tau_prev = tau_init = *rnorm;       /* Assumes zero initial guess */
+   for (k=0; k<blockSize; k++) {
+      st[k].j = k;
+      st[k].numIts = 0;
+      st[k].touch = *touch;
+      st[k].stop = 0;
+      st[k].last = 0;
+      st[k].eval = eval[k];
+      st[k].shift = shift[k];
+      shifts[k] = shift[k];
+      st[k].tau_prev = st[k].tau_init = rnorm[k]; /* Assumes zero initial guess */
+      set_tolerances(&st[k], aNorm, machEps, primme);
+
+      st[k].Theta_prev = 0.0L;
+      st[k].eval_prev = st[k].eval;
+
+      /* Initialize recurrences used to dynamically update the eigenpair */
+
+      st[k].Beta = st[k].Delta = st[k].Psi = 0.0L;
+      st[k].Gamma = st[k].Phi = 0.0L;
+      st[k].Beta_prev = st[k].Delta_prev = st[k].Psi_prev = 0.0L;
+      st[k].Gamma_prev = st[k].Phi_prev = 0.0L;
+      st[k].eres_prev = st[k].eres_updated = 0.0;
+   }
+   adaptive = blockSize > 0
+      && (st[0].ETolerance > 0.0 || st[0].ETolerance_factor > 0.0);
+
+   /* --------------------------------------------------------*/
+   /* Set up convergence criteria by max number of iterations */
+   /* --------------------------------------------------------*/
+
+   /* The number of remaining matvecs is checked in every iteration by */
+   /* stop_exhausted_equations                                         */
+
+   maxIterations = INT_MAX;
+
+   /* Perform primme.maxInnerIterations */
+   if (primme->correctionParams.maxInnerIterations > 0) {
+      maxIterations = primme->correctionParams.maxInnerIterations;
+   }
+
+   if (primme->pipelinedQMR) {
+      CHKERR(pipelined_qmr(blockSize, x, ldx, r, ldr, rnorm, evecs, ldevecs,
+               UDU, ipivot, xKinvx, Lprojector, ldLprojector, RprojectorQ,
+               ldRprojectorQ, RprojectorX, ldRprojectorX, sizeLprojector,
+               sizeLprojectorX, sizeRprojectorQ, sizeRprojectorX, st, shifts,
+               maxIterations, adaptive, machEps, rwork, ldw, dots, workSpace,
+               primme), -1);
+   }
+   else {
+      CHKERR(simplified_qmr(blockSize, x, ldx, r, ldr, rnorm, evecs, ldevecs,
+               UDU, ipivot, xKinvx, Lprojector, ldLprojector, RprojectorQ,
+               ldRprojectorQ, RprojectorX, ldRprojectorX, sizeLprojector,
+               sizeLprojectorX, sizeRprojectorQ, sizeRprojectorX, st, shifts,
+               maxIterations, adaptive, machEps, rwork, ldw, (REAL*)dots,
+               workSpace, primme), -1);
+   }
+
+   /* Return the solutions, the estimated eigenresidual norms and touch; */
+   /* from here x is not used, so sol may be x.                          */
+
+   for (k=0; k<blockSize; k++) {
+      Num_copy_Sprimme(primme->nLocal, &sol0[ldw*k], 1, &sol[ldsol*st[k].j],
+            1);
+      rnorm[st[k].j] = st[k].eres_updated;
+      *touch = max(*touch, st[k].touch);
+   }
+   primme->ShiftsForPreconditioner = shift;
+
+   primme->stats.timeInnerSolve += primme_get_wtime() - t0;
+
+   return 0;
+}
+
+
+/*******************************************************************************
+ * Subroutine pipelined_qmr - Run the simplified QMR iterations of
+ *    inner_solve reorganized as the pipelined preconditioned CG of Ghysels and
+ *    Vanroose, so that all inner products of an iteration are summed up
+ *    in a single reduction, which is overlapped with the application of the
+ *    preconditioner and the matrix.
+ *
+ *    Besides g (residual) and d (search direction), the recurrences keep
+ *    u = P*g, w = A*u, s = A*d, q = P*s and z = A*q, where A and P are the
+ *    projected matrix and preconditioner; then m = P*w and n = A*m are the
+ *    only applications of P and A per iteration. In exact arithmetic the
+ *    iterates are the ones of inner_solve, but the QMR smoothing of a step
+ *    is done in the next iteration, when the norm of its residual is known.
+ *    The norm of the updated solution needed by the adaptive stopping is
+ *    expanded from inner products of the vectors before the update.
+ *
+ *    The equations that cannot perform more matvecs (by maxIterations or
+ *    primme.maxMatvecs) are flagged as last: they skip m and n, finish their
+ *    step and stop in the next iteration. They are kept after the ones that
+ *    still apply the matrix, as compact_equations preserves the order.
+ *
+ * Input Parameters
+ * ----------------
+ * The ones of inner_solve, and
+ *
+ * st, shifts     The state of the equations set up by inner_solve
+ *
+ * maxIterations  The maximum number of inner iterations
+ *
+ * adaptive       Nonzero if stopping by the eigenresidual estimate
+ *
+ * V              The PIPELINED_NUM_VECS blocks of QMR vectors with leading
+ *                dimension ldw; the last one returns the solutions
+ *
+ * dots           Workspace of size 3*PIPELINED_NUM_DOTS*blockSize
+ *
+ * rwork          Workspace needed by the projectors
+ *
+ ******************************************************************************/
+
+static int pipelined_qmr(int blockSize, SCALAR *x, PRIMME_INT ldx, SCALAR *r,
+      PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *UDU, int *ipivot, SCALAR *xKinvx, SCALAR *Lprojector,
+      PRIMME_INT ldLprojector, SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      qmr_state *st, double *shifts, int maxIterations, int adaptive,
+      double machEps, SCALAR *V, PRIMME_INT ldw, SCALAR *dots, SCALAR *rwork,
+      primme_params *primme) {
+
+   int i, k;          /* loop variables                                      */
+   PRIMME_INT l;      /* loop variable                                       */
+   int numActive;     /* The first numActive equations in st still iterate   */
+   int numPrev;       /* The first numPrev equations were not flagged last   */
+   int numMv;         /* The first numMv equations apply P and A             */
+   int nd;            /* Number of inner products per equation               */
+   PRIMME_INT remaining; /* Number of matvecs left                           */
+   SCALAR *sumBuf;    /* Buffer for the sum of dots                          */
+   size_t sumBufSize; /* Size of sumBuf                                      */
+   globalsum_queue queue; /* Pending sum of dots                             */
+
+   /* QMR vectors */
+
+   SCALAR *g, *d, *delta, *w, *u, *s, *q, *z, *m, *n, *sol0;
+
+   g      = V;
+   d      = g + ldw*blockSize;
+   delta  = d + ldw*blockSize;
+   w      = delta + ldw*blockSize;
+   u      = w + ldw*blockSize;
+   s      = u + ldw*blockSize;
+   q      = s + ldw*blockSize;
+   z      = q + ldw*blockSize;
+   m      = z + ldw*blockSize;
+   n      = m + ldw*blockSize;
+   sol0   = n + ldw*blockSize;
+   sumBuf = dots + PIPELINED_NUM_DOTS*blockSize;
+   sumBufSize = (size_t)PIPELINED_NUM_DOTS*2*blockSize;
+   nd = adaptive ? PIPELINED_NUM_DOTS : 3;
+
+   /* --------------------------------------------------------*/
+   /* Initializations: assume zero initial guess              */
+   /* --------------------------------------------------------*/
+
+   Num_copy_matrix_Sprimme(r, primme->nLocal, blockSize, ldr, g, ldw);
+   Num_zero_matrix_Sprimme(d, primme->nLocal, blockSize, ldw);
+   Num_zero_matrix_Sprimme(delta, primme->nLocal, blockSize, ldw);
+   Num_zero_matrix_Sprimme(s, primme->nLocal, blockSize, ldw);
+   Num_zero_matrix_Sprimme(q, primme->nLocal, blockSize, ldw);
+   Num_zero_matrix_Sprimme(z, primme->nLocal, blockSize, ldw);
+   Num_zero_matrix_Sprimme(sol0, primme->nLocal, blockSize, ldw);
+
+   stop_exhausted_equations(blockSize, maxIterations, st, primme);
+   numActive = compact_equations(blockSize, blockSize, st, shifts, V,
+         PIPELINED_NUM_VECS, ldw, primme);
+
+   if (numActive > 0) {
+      CHKERR(apply_projected_preconditioner(g, ldw, numActive, st, shifts,
+               evecs, ldevecs, RprojectorQ, ldRprojectorQ, sizeRprojectorQ,
+               UDU, ipivot, x, ldx, RprojectorX, ldRprojectorX,
+               sizeRprojectorX, xKinvx, u, ldw, rwork, primme), -1);
+      CHKERR(apply_projected_matrix(u, ldw, numActive, st, Lprojector,
+               ldLprojector, sizeLprojector, x, ldx, sizeLprojectorX, w, ldw,
+               rwork, primme), -1);
+   }
+
+   /*----------------------------------------------------------------------*/
+   /*------------------------ Begin Inner Loop ----------------------------*/
+   /*----------------------------------------------------------------------*/
+
+   for (i=0; numActive > 0; i++) {
+
+      /* Flag as last the equations that cannot perform another matvec */
+
+      for (numPrev=0; numPrev<numActive && !st[numPrev].last; numPrev++);
+      remaining = primme->maxMatvecs > 0 ?
+         primme->maxMatvecs - primme->stats.numMatvecs : numPrev;
+      numMv = i+1 < maxIterations ? (int)min(numPrev, remaining) : 0;
+      numMv = max(numMv, 0);
+      for (k=numMv; k<numPrev; k++) st[k].last = 1;
+
+      /* Start summing up the inner products:                        */
+      /* g'*u, w'*u and g'*g, and for the adaptive stopping the ones */
+      /* among sol0, delta and d.                                    */
+
+      for (k=0; k<numActive; k++) {
+         SCALAR *dk = &dots[nd*k];
+         SCALAR *g_k = &g[ldw*k], *u_k = &u[ldw*k], *d_k = &d[ldw*k];
+         SCALAR *delta_k = &delta[ldw*k], *sol_k = &sol0[ldw*k];
+
+         dk[0] = Num_dot_Sprimme(primme->nLocal, g_k, 1, u_k, 1);
+         dk[1] = Num_dot_Sprimme(primme->nLocal, &w[ldw*k], 1, u_k, 1);
+         dk[2] = Num_dot_Sprimme(primme->nLocal, g_k, 1, g_k, 1);
+         if (adaptive) {
+            dk[3] = Num_dot_Sprimme(primme->nLocal, sol_k, 1, sol_k, 1);
+            dk[4] = Num_dot_Sprimme(primme->nLocal, delta_k, 1, delta_k, 1);
+            dk[5] = Num_dot_Sprimme(primme->nLocal, d_k, 1, d_k, 1);
+            dk[6] = Num_dot_Sprimme(primme->nLocal, sol_k, 1, delta_k, 1);
+            dk[7] = Num_dot_Sprimme(primme->nLocal, sol_k, 1, d_k, 1);
+            dk[8] = Num_dot_Sprimme(primme->nLocal, delta_k, 1, d_k, 1);
+         }
+      }
+      GLOBALSUM_QUEUE_INIT(queue);
+      CHKERR(globalSum_queue_Sprimme(dots, nd, numActive, nd, -1, 1, &queue,
+               sumBuf, sumBufSize, primme), -1);
+      CHKERR(globalSum_flush_start_Sprimme(&queue, sumBuf, sumBufSize,
+               primme), -1);
+
+      /* Meanwhile compute m = P*w and n = A*m */
+
+      if (numMv > 0) {
+         CHKERR(apply_projected_preconditioner(w, ldw, numMv, st, shifts,
+                  evecs, ldevecs, RprojectorQ, ldRprojectorQ, sizeRprojectorQ,
+                  UDU, ipivot, x, ldx, RprojectorX, ldRprojectorX,
+                  sizeRprojectorX, xKinvx, m, ldw, rwork, primme), -1);
+         CHKERR(apply_projected_matrix(m, ldw, numMv, st, Lprojector,
+                  ldLprojector, sizeLprojector, x, ldx, sizeLprojectorX, n,
+                  ldw, rwork, primme), -1);
+      }
+
+      CHKERR(globalSum_flush_wait_Sprimme(&queue, primme), -1);
+      CHKERR(globalSum_flush_Sprimme(&queue, sumBuf, sumBufSize, primme), -1);
+
+      for (k=0; k<numActive; k++) {
+         qmr_state *st_k = &st[k];
+         SCALAR *dk = &dots[nd*k];
+         SCALAR *g_k, *d_k, *u_k, *w_k, *s_k, *q_k, *z_k;
+         double rho, mu, beta, alpha;
+
+         /* Finish the step of the previous iteration */
+
+         if (i > 0) {
+            double dot_sol = 0.0;
+
+            update_solution(st_k, REAL_PART(dk[2]), &d[ldw*k], &delta[ldw*k],
+                  &sol0[ldw*k], primme);
+            if (check_linear_residual(st_k, primme)) {
+               st_k->stop = 1;
+               continue;
+            }
+
+            /* sol0 + gamma*delta + eta*d was the updated solution */
+
+            if (adaptive) {
+               double ga = st_k->gamma, et = st_k->eta;
+               dot_sol = REAL_PART(dk[3]) + ga*ga*REAL_PART(dk[4])
+                  + et*et*REAL_PART(dk[5]) + 2.0*ga*REAL_PART(dk[6])
+                  + 2.0*et*REAL_PART(dk[7]) + 2.0*ga*et*REAL_PART(dk[8]);
+            }
+            CHKERR(check_eigenresidual(st_k, adaptive, dot_sol,
+                     rnorm[st_k->j], primme), -1);
+            if (st_k->stop) continue;
+
+            if (k >= numPrev) {
+               st_k->stop = 1;
+               continue;
+            }
+            shift_recurrences(st_k);
+         }
+
+         /* Next step: sigma = d'*A*d is w'*u - beta*rho/alpha_prev */
+
+         rho = REAL_PART(dk[0]);
+         mu = REAL_PART(dk[1]);
+         beta = i > 0 ? rho/st_k->rho_prev : 0.0;
+         st_k->sigma_prev = i > 0 ? mu - beta*rho/st_k->alpha_prev : mu;
+         st_k->rho_prev = rho;
+         if (breakdown(st_k, machEps, primme)) {
+            /* sol = r if first iteration */
+            if (st_k->numIts == 0) {
+               Num_copy_Sprimme(primme->nLocal, &r[ldr*st_k->j], 1,
+                     &sol0[ldw*k], 1);
+            }
+            st_k->stop = 1;
+            continue;
+         }
+         alpha = st_k->alpha_prev;
+
+         /* s = w + beta*s, d = u + beta*d, g = g - alpha*s, and if P and A */
+         /* were applied, z = n + beta*z, q = m + beta*q, u = u - alpha*q   */
+         /* and w = w - alpha*z                                             */
+
+         g_k = &g[ldw*k], d_k = &d[ldw*k], u_k = &u[ldw*k], w_k = &w[ldw*k];
+         s_k = &s[ldw*k], q_k = &q[ldw*k], z_k = &z[ldw*k];
+         for (l = 0; l < primme->nLocal; l++) {
+            s_k[l] = w_k[l] + s_k[l]*(SCALAR)beta;
+            d_k[l] = u_k[l] + d_k[l]*(SCALAR)beta;
+            g_k[l] -= s_k[l]*(SCALAR)alpha;
+         }
+         if (k < numMv) {
+            SCALAR *m_k = &m[ldw*k], *n_k = &n[ldw*k];
+            for (l = 0; l < primme->nLocal; l++) {
+               z_k[l] = n_k[l] + z_k[l]*(SCALAR)beta;
+               q_k[l] = m_k[l] + q_k[l]*(SCALAR)beta;
+               u_k[l] -= q_k[l]*(SCALAR)alpha;
+               w_k[l] -= z_k[l]*(SCALAR)alpha;
+            }
+         }
+      }
+
+      numActive = compact_equations(numActive, blockSize, st, shifts, V,
+            PIPELINED_NUM_VECS, ldw, primme);
+
+     /* --------------------------------------------------------*/
+   } /* End of QMR main loop                                    */
+     /* --------------------------------------------------------*/
+
+   return 0;
+}
+
+
+/*******************************************************************************
+ * Subroutine simplified_qmr - Run the hermitian simplified QMR iterations of
+ *    inner_solve, reducing separately every group of inner products of a step
+ *    as soon as they are needed.
+ *
+ * Input Parameters
+ * ----------------
+ * The ones of inner_solve, and
+ *
+ * st, shifts     The state of the equations set up by inner_solve
+ *
+ * maxIterations  The maximum number of inner iterations
+ *
+ * adaptive       Nonzero if stopping by the eigenresidual estimate
+ *
+ * V              The SIMPLIFIED_NUM_VECS blocks of QMR vectors with leading
+ *                dimension ldw; the last one returns the solutions
+ *
+ * dots           Workspace of size blockSize
+ *
+ * rwork          Workspace needed by the projectors and dist_dots_real
+ *
+ ******************************************************************************/
+
+static int simplified_qmr(int blockSize, SCALAR *x, PRIMME_INT ldx, SCALAR *r,
+      PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs, PRIMME_INT ldevecs,
+      SCALAR *UDU, int *ipivot, SCALAR *xKinvx, SCALAR *Lprojector,
+      PRIMME_INT ldLprojector, SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      qmr_state *st, double *shifts, int maxIterations, int adaptive,
+      double machEps, SCALAR *V, PRIMME_INT ldw, REAL *dots, SCALAR *rwork,
+      primme_params *primme) {
+
+   int k;             /* loop variable                                       */
+   int numActive;     /* The first numActive equations in st still iterate   */
+
+   /* QMR vectors */
+
+   SCALAR *g, *d, *delta, *w, *sol0, *ptmp;
+
+   g      = V;
+   d      = g + ldw*blockSize;
+   delta  = d + ldw*blockSize;
+   w      = delta + ldw*blockSize;
+   sol0   = w + ldw*blockSize;
+
+   /* --------------------------------------------------------*/
+   /* Initializations                                         */
+   /* --------------------------------------------------------*/
+
+   /* Assume zero initial guess */
+   Num_copy_matrix_Sprimme(r, primme->nLocal, blockSize, ldr, g, ldw);
+
+   CHKERR(apply_projected_preconditioner(g, ldw, blockSize, st, shifts, evecs,
+            ldevecs, RprojectorQ, ldRprojectorQ, sizeRprojectorQ, UDU, ipivot,
+            x, ldx, RprojectorX, ldRprojectorX, sizeRprojectorX, xKinvx, d,
+            ldw, rwork, primme), -1);
+
+   CHKERR(dist_dots_real(g, ldw, d, ldw, blockSize, dots, rwork, primme),
+         -1);
+
+   for (k=0; k<blockSize; k++) {
+      st[k].rho_prev = dots[k];
+   }
+
+   /* other initializations */
+   Num_zero_matrix_Sprimme(delta, primme->nLocal, blockSize, ldw);
+   Num_zero_matrix_Sprimme(sol0, primme->nLocal, blockSize, ldw);
+
+   numActive = blockSize;
+
+   /*----------------------------------------------------------------------*/
+   /*------------------------ Begin Inner Loop ----------------------------*/
+   /*----------------------------------------------------------------------*/
+
+   while (1) {
+
+      stop_exhausted_equations(numActive, maxIterations, st, primme);
+      numActive = compact_equations(numActive, blockSize, st, shifts, V,
+            SIMPLIFIED_NUM_VECS, ldw, primme);
+      if (numActive <= 0) break;
+
+      CHKERR(apply_projected_matrix(d, ldw, numActive, st, Lprojector,
+               ldLprojector, sizeLprojector, x, ldx, sizeLprojectorX, w, ldw,
+               rwork, primme), -1);
+      CHKERR(dist_dots_real(d, ldw, w, ldw, numActive, dots, rwork,
+               primme), -1);
+
+      for (k=0; k<numActive; k++) {
+         qmr_state *s = &st[k];
+
+         s->sigma_prev = dots[k];
+         if (breakdown(s, machEps, primme)) {
+            /* sol = r if first iteration */
+            if (s->numIts == 0) {
+               Num_copy_Sprimme(primme->nLocal, &r[ldr*s->j], 1, &sol0[ldw*k],
+                     1);
+            }
+            s->stop = 1;
+            continue;
+         }
+
+         Num_axpy_Sprimme(primme->nLocal, -s->alpha_prev, &w[ldw*k], 1,
+               &g[ldw*k], 1);
+      }
+      numActive = compact_equations(numActive, blockSize, st, shifts, V,
+            SIMPLIFIED_NUM_VECS, ldw, primme);
+      if (numActive <= 0) break;
+
+      CHKERR(dist_dots_real(g, ldw, g, ldw, numActive, dots, rwork,
+               primme), -1);
+
+      for (k=0; k<numActive; k++) {
+         qmr_state *s = &st[k];
+
+         update_solution(s, dots[k], &d[ldw*k], &delta[ldw*k],
+               &sol0[ldw*k], primme);
+         if (check_linear_residual(s, primme)) s->stop = 1;
+      }
+      numActive = compact_equations(numActive, blockSize, st, shifts, V,
+            SIMPLIFIED_NUM_VECS, ldw, primme);
+      if (numActive <= 0) break;
+
+      if (adaptive) {
+         /* --------------------------------------------------------*/
+         /* Adaptive stopping based on dynamic monitoring of eResid */
+         /* --------------------------------------------------------*/
+
+         CHKERR(dist_dots_real(sol0, ldw, sol0, ldw, numActive, dots,
+                  rwork, primme), -1);
+      }
+
+      for (k=0; k<numActive; k++) {
+         CHKERR(check_eigenresidual(&st[k], adaptive,
+                  adaptive ? dots[k] : 0.0, rnorm[st[k].j], primme), -1);
+      }
+
+      stop_exhausted_equations(numActive, maxIterations, st, primme);
+      numActive = compact_equations(numActive, blockSize, st, shifts, V,
+            SIMPLIFIED_NUM_VECS, ldw, primme);
+      if (numActive <= 0) break;
+
+      CHKERR(apply_projected_preconditioner(g, ldw, numActive, st, shifts,
+               evecs, ldevecs, RprojectorQ, ldRprojectorQ, sizeRprojectorQ,
+               UDU, ipivot, x, ldx, RprojectorX, ldRprojectorX,
+               sizeRprojectorX, xKinvx, w, ldw, rwork, primme), -1);
+
+      CHKERR(dist_dots_real(g, ldw, w, ldw, numActive, dots, rwork,
+               primme), -1);
+
+      for (k=0; k<numActive; k++) {
+         qmr_state *s = &st[k];
+         double rho = dots[k];
+         double beta = rho/s->rho_prev;
+
+         Num_axpy_Sprimme(primme->nLocal, beta, &d[ldw*k], 1, &w[ldw*k], 1);
+
+         s->rho_prev = rho;
+         shift_recurrences(s);
+      }
+
+      /* Alternate between w and d buffers in successive iterations */
+      /* This saves a memory copy.                                  */
+      ptmp = d; d = w; w = ptmp;
+
+     /* --------------------------------------------------------*/
+   } /* End of QMR main while loop                              */
+     /* --------------------------------------------------------*/
+
+   return 0;
+}
+
+
+/*******************************************************************************
+ * Subroutine set_tolerances - Set the stopping tolerances of an equation
+ *    based on primme.correctionParams.convTest. It may increase st->touch.
+ *
+ * Input Parameters
+ * ----------------
+ * aNorm    Estimation of the norm of A
+ *
+ * machEps  machine precision
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * st       The state of the equation. On input st->touch and st->tau_init
+ *          must be set.
+ *
+ ******************************************************************************/
+
+static void set_tolerances(qmr_state *st, double aNorm, double machEps,
+      primme_params *primme) {
 
    /* NOTE: In any case stop when linear system residual is less than         */
    /*       max(machEps,eps)*aNorm.                                           */
-   LTolerance = machEps*aNorm;
-   LTolerance_factor = 1.0;
-   ETolerance = 0.0;
-   ETolerance_factor = 0.0;
+   st->LTolerance = machEps*aNorm;
+   st->LTolerance_factor = 1.0;
+   st->ETolerance = 0.0;
+   st->ETolerance_factor = 0.0;
 
    switch(primme->correctionParams.convTest) {
    case primme_full_LTolerance:
@@ -219,10 +865,10 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
        break;
    case primme_decreasing_LTolerance:
       /* stop when linear system residual norm is less than relTolBase^-its   */
-      LTolerance = max(LTolerance,
+      st->LTolerance = max(st->LTolerance,
             pow(primme->correctionParams.relTolBase, 
-               -(double)*touch));
-      (*touch)++;
+               -(double)st->touch));
+      st->touch++;
       break;
    case primme_adaptive:
       /* stop when estimate eigenvalue residual norm is less than aNorm*eps.  */
@@ -230,343 +876,467 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
       /* P(A-s)P not on (A-s). But tau reflects the residual norm on P(A-s)P. */
       /* So stop when linear system residual norm or the estimate eigenvalue  */
       /* residual norm is less than aNorm*eps/1.8.                            */
-      LTolerance_factor = pow(1.8, -(double)*touch);
-      ETolerance_factor = pow(1.8, -(double)*touch);
+      st->LTolerance_factor = pow(1.8, -(double)st->touch);
+      st->ETolerance_factor = pow(1.8, -(double)st->touch);
       break; 
    case primme_adaptive_ETolerance:
       /* Besides the primme_adaptive criteria, stop when estimate eigenvalue  */
       /* residual norm is less than tau_init*0.1                              */
-      LTolerance_factor = pow(1.8, -(double)*touch);
-      ETolerance_factor = pow(1.8, -(double)*touch);
-      ETolerance = tau_init*0.1;
-     }
-   
-   /* --------------------------------------------------------*/
-   /* Set up convergence criteria by max number of iterations */
-   /* --------------------------------------------------------*/
+      st->LTolerance_factor = pow(1.8, -(double)st->touch);
+      st->ETolerance_factor = pow(1.8, -(double)st->touch);
+      st->ETolerance = st->tau_init*0.1;
+   }
+}
+
+
+/*******************************************************************************
+ * Subroutine stop_exhausted_equations - Flag to stop the equations that
+ *    reached maxIterations, and the ones that would make the next inner step
+ *    perform more than primme.maxMatvecs matrix-vector products.
+ *
+ * Input Parameters
+ * ----------------
+ * numActive      The number of equations still iterating
+ *
+ * maxIterations  The maximum number of inner iterations
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * st             The state of the equations
+ *
+ ******************************************************************************/
+
+static void stop_exhausted_equations(int numActive, int maxIterations,
+      qmr_state *st, primme_params *primme) {
+
+   int k;
+   PRIMME_INT remaining = primme->maxMatvecs > 0 ?
+      primme->maxMatvecs - primme->stats.numMatvecs : numActive;
+
+   for (k=0; k<numActive; k++) {
+      if (st[k].numIts >= maxIterations || k >= remaining) st[k].stop = 1;
+   }
+}
+
+
+/*******************************************************************************
+ * Subroutine compact_equations - Move the equations flagged to stop after the
+ *    ones that still iterate, swapping their states and the columns of the
+ *    QMR vectors. The equations that still iterate keep their relative order.
+ *
+ * Input Parameters
+ * ----------------
+ * numActive   The number of equations that were iterating
+ *
+ * blockSize   The number of columns of every block of QMR vectors
+ *
+ * numVecs     The number of blocks of QMR vectors in V
+ *
+ * ldw         The leading dimension of V
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * st, shifts, V   The state and vectors of the equations
+ *
+ * Return Value
+ * ------------
+ * The number of equations that still iterate
+ *
+ ******************************************************************************/
+
+static int compact_equations(int numActive, int blockSize, qmr_state *st,
+      double *shifts, SCALAR *V, int numVecs, PRIMME_INT ldw,
+      primme_params *primme) {
+
+   int i, k, numKept;
+
+   for (k=0, numKept=0; k<numActive; k++) {
+      if (st[k].stop) continue;
+      if (k > numKept) {
+         qmr_state t = st[k];
+         double s = shifts[k];
+         st[k] = st[numKept];
+         st[numKept] = t;
+         shifts[k] = shifts[numKept];
+         shifts[numKept] = s;
+         for (i=0; i<numVecs; i++) {
+            SCALAR *v = &V[ldw*blockSize*i];
+            Num_swap_Sprimme(primme->nLocal, &v[ldw*k], 1, &v[ldw*numKept],
+                  1);
+         }
+      }
+      numKept++;
+   }
+
+   return numKept;
+}
+
+
+/*******************************************************************************
+ * Function breakdown - Compute the step alpha = rho/sigma of an equation and
+ *    check that neither sigma nor alpha break the iteration.
+ *
+ * Input Parameters
+ * ----------------
+ * machEps  machine precision
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * st       The state of the equation. On input st->rho_prev and
+ *          st->sigma_prev must be set; on output st->alpha_prev is set.
+ *
+ * Return Value
+ * ------------
+ * Nonzero if the equation should stop
+ *
+ ******************************************************************************/
+
+static int breakdown(qmr_state *st, double machEps, primme_params *primme) {
+
+   if (!ISFINITE(st->sigma_prev) || st->sigma_prev == 0.0L) {
+      if (primme->printLevel >= 5 && primme->procID == 0) {
+         fprintf(primme->outputFile,"Exiting because SIGMA %e\n",
+               st->sigma_prev);
+      }
+      return 1;
+   }
+
+   st->alpha_prev = st->rho_prev/st->sigma_prev;
+   if (!ISFINITE(st->alpha_prev) || fabs(st->alpha_prev) < machEps
+         || fabs(st->alpha_prev) > 1.0L/machEps){
+      if (primme->printLevel >= 5 && primme->procID == 0) {
+         fprintf(primme->outputFile,"Exiting because ALPHA %e\n",
+               st->alpha_prev);
+      }
+      return 1;
+   }
+
+   return 0;
+}
+
+
+/*******************************************************************************
+ * Subroutine update_solution - Perform the QMR smoothing of the last step of
+ *    an equation, updating delta and sol:
+ *
+ *     delta = gamma*delta + eta*d;  sol = sol + delta
+ *
+ * Input Parameters
+ * ----------------
+ * gnorm2   The square of the norm of the residual of the CG step
+ *
+ * d        The search direction of the step
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * st       The state of the equation
+ *
+ * delta, sol  The last update and the solution of the equation
+ *
+ ******************************************************************************/
+
+static void update_solution(qmr_state *st, double gnorm2, SCALAR *d,
+      SCALAR *delta, SCALAR *sol, primme_params *primme) {
+
+   PRIMME_INT i;
+   double c;
+
+   st->Theta = sqrt(gnorm2);
+   st->Theta = st->Theta/st->tau_prev;
+   c = 1.0L/sqrt(1+st->Theta*st->Theta);
+   st->tau = st->tau_prev*st->Theta*c;
+
+   st->gamma = c*c*st->Theta_prev*st->Theta_prev;
+   st->eta = st->alpha_prev*c*c;
+   for (i = 0; i < primme->nLocal; i++) {
+       delta[i] = delta[i]*(SCALAR)st->gamma + d[i]*(SCALAR)st->eta;
+       sol[i] = delta[i]+sol[i];
+   }
+   st->numIts++;
+}
 
-   /* compute first total number of remaining matvecs */
 
-   if (primme->maxMatvecs > 0) {
-      maxIterations = primme->maxMatvecs - primme->stats.numMatvecs;
-   }
-   else {
-      maxIterations = INT_MAX;
-   }
+/*******************************************************************************
+ * Function check_linear_residual - Check the stopping criteria of an equation
+ *    that only depend on the linear system residual norm tau
+ *
+ * Return Value
+ * ------------
+ * Nonzero if the equation should stop
+ *
+ ******************************************************************************/
 
-   /* Perform primme.maxInnerIterations, but do not exceed total remaining */
-   if (primme->correctionParams.maxInnerIterations > 0) {
+static int check_linear_residual(qmr_state *st, primme_params *primme) {
 
-      maxIterations = min(primme->correctionParams.maxInnerIterations, 
-                          maxIterations);
+   if (fabs(st->rho_prev) == 0.0L ) {
+      if (primme->printLevel >= 5 && primme->procID == 0) {
+         fprintf(primme->outputFile,"Exiting because abs(rho) %e\n",
+            fabs(st->rho_prev));
+      }
+      return 1;
    }
 
-   /* --------------------------------------------------------*/
-   /* Rest of initializations                                 */
-   /* --------------------------------------------------------*/
-
-   /* Assume zero initial guess */
-   Num_copy_Sprimme(primme->nLocal, r, 1, g, 1);
+   if (st->numIts > 1 && st->tau < st->LTolerance) {
+      if (primme->printLevel >= 5 && primme->procID == 0) {
+         fprintf(primme->outputFile, " tau < LTol %e %e\n",st->tau,
+               st->LTolerance);
+      }
+      return 1;
+   }
 
-   CHKERR(apply_projected_preconditioner(g, evecs, ldevecs, RprojectorQ,
-           ldRprojectorQ, x, RprojectorX, ldRprojectorX, sizeRprojectorQ,
-           sizeRprojectorX, xKinvx, UDU, ipivot, d, workSpace, primme), -1);
+   return 0;
+}
 
-   Theta_prev = 0.0L;
-   eval_prev = eval;
-   REAL rho_prev_real;
-   CHKERR(dist_dot_real(g, 1, d, 1, primme, &rho_prev_real), -1);
-   rho_prev = rho_prev_real;
 
-   /* Initialize recurrences used to dynamically update the eigenpair */
+/*******************************************************************************
+ * Subroutine check_eigenresidual - Check the stopping criteria of an equation
+ *    after a QMR step and report the inner iteration to monitorFun. If
+ *    adaptive, the Ritz value and the eigenresidual norm are estimated first
+ *    with recurrences. It sets st->stop if the equation should stop.
+ *
+ * Input Parameters
+ * ----------------
+ * adaptive The estimated eigenresidual norm is used in the stopping criteria
+ *
+ * dot_sol  The square of the norm of the solution, if adaptive
+ *
+ * rnorm    The residual norm of the Ritz vector, for the report
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * st       The state of the equation
+ *
+ ******************************************************************************/
 
-   Beta_prev = Delta_prev = Psi_prev = 0.0L;
-   Gamma_prev = Phi_prev = 0.0L;
+static int check_eigenresidual(qmr_state *st, int adaptive, double dot_sol,
+      REAL rnorm, primme_params *primme) {
 
-   /* other initializations */
-   for (i = 0; i < primme->nLocal; i++) {
-      delta[i] = 0.0;
-      sol[i] = 0.0;
-   }
+   int isConv;
 
-   numIts = 0;
-      
-   /*----------------------------------------------------------------------*/
-   /*------------------------ Begin Inner Loop ----------------------------*/
-   /*----------------------------------------------------------------------*/
+   if (adaptive) {
+      double eres2_updated;
+
+      /* Update the Ritz value and eigenresidual using the */
+      /* following recurrences.                            */
+
+      st->Delta = st->gamma*st->Delta_prev + st->eta*st->rho_prev;
+      st->Beta = st->Beta_prev - st->Delta;
+      st->Phi = st->gamma*st->gamma*st->Phi_prev
+         + st->eta*st->eta*st->sigma_prev;
+      st->Psi = st->gamma*st->Psi_prev + st->gamma*st->Phi_prev;
+      st->Gamma = st->Gamma_prev + 2.0L*st->Psi + st->Phi;
+
+      /* Perform the update: update the eigenvalue and the square of  */
+      /* the residual norm.                                           */
+
+      st->eval_updated = st->shift
+         + (st->eval - st->shift + 2*st->Beta + st->Gamma)/(1.0 + dot_sol);
+      eres2_updated = (st->tau*st->tau)/(1 + dot_sol) +
+         ((st->eval - st->shift + st->Beta)*(st->eval - st->shift + st->Beta))
+            /(1.0 + dot_sol)
+         - (st->eval_updated - st->shift)*(st->eval_updated - st->shift);
+
+      /* If numerical problems, let eres about the same as tau */
+      st->eres_prev = st->eres_updated;
+      if (eres2_updated < 0){
+         st->eres_updated = sqrt( (st->tau*st->tau)/(1.0 + dot_sol) );
+      }
+      else
+         st->eres_updated = sqrt(eres2_updated);
 
-   while (numIts < maxIterations) {
+      assert(ISFINITE(st->Delta) && ISFINITE(st->Beta) && ISFINITE(st->Phi)
+            && ISFINITE(st->Psi) && ISFINITE(st->Gamma)
+            && ISFINITE(st->eval_updated) && ISFINITE(eres2_updated)
+            && ISFINITE(st->eres_updated));
 
-      CHKERR(apply_projected_matrix(d, shift, Lprojector, ldLprojector,
-               sizeLprojector, w, workSpace, primme), -1);
-      CHKERR(dist_dot_real(d, 1, w, 1, primme, &sigma_prev), -1);
+      /* --------------------------------------------------------*/
+      /* Stopping criteria                                       */
+      /* --------------------------------------------------------*/
 
-      if (!ISFINITE(sigma_prev) || sigma_prev == 0.0L) {
+      if (st->numIts > 1 && (st->tau_prev <= st->eres_updated
+               || st->eres_prev <= st->tau)) {
          if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile,"Exiting because SIGMA %e\n",sigma_prev);
-         }
-         /* sol = r if first iteration */
-         if (numIts == 0) {
-            Num_copy_Sprimme(primme->nLocal, r, 1, sol, 1);
+            fprintf(primme->outputFile, " tau < R eres \n");
          }
-         break;
+         st->stop = 1;
+         return 0;
       }
 
-      alpha_prev = rho_prev/sigma_prev;
-      if (!ISFINITE(alpha_prev) || fabs(alpha_prev) < machEps || fabs(alpha_prev) > 1.0L/machEps){
+      if (primme->target == primme_smallest
+            && st->eval_updated > st->eval_prev) {
          if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile,"Exiting because ALPHA %e\n",alpha_prev);
+            fprintf(primme->outputFile, "eval_updated > eval_prev\n");
          }
-         /* sol = r if first iteration */
-         if (numIts == 0) {
-            Num_copy_Sprimme(primme->nLocal, r, 1, sol, 1);
-         }
-         break;
-      }
-
-      Num_axpy_Sprimme(primme->nLocal, -alpha_prev, w, 1, g, 1);
-
-      REAL Theta2;
-      CHKERR(dist_dot_real(g, 1, g, 1, primme, &Theta2), -1);
-      Theta = sqrt(Theta2);
-      Theta = Theta/tau_prev;
-      c = 1.0L/sqrt(1+Theta*Theta);
-      tau = tau_prev*Theta*c;
-
-      gamma = c*c*Theta_prev*Theta_prev;
-      eta = alpha_prev*c*c;
-      for (i = 0; i < primme->nLocal; i++) {
-          delta[i] = delta[i]*(SCALAR)gamma + d[i]*(SCALAR)eta;
-          sol[i] = delta[i]+sol[i];
+         st->stop = 1;
+         return 0;
       }
-      numIts++;
-
-      if (fabs(rho_prev) == 0.0L ) {
+      else if (primme->target == primme_largest
+            && st->eval_updated < st->eval_prev){
          if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile,"Exiting because abs(rho) %e\n",
-               fabs(rho_prev));
+            fprintf(primme->outputFile, "eval_updated < eval_prev\n");
          }
-         break;
+         st->stop = 1;
+         return 0;
       }
-      
-      if (numIts > 1 && tau < LTolerance) {
+      else if (primme->target == primme_closest_abs
+            && fabs(st->eval-st->eval_updated)
+                  > st->tau_init+st->eres_updated){
          if (primme->printLevel >= 5 && primme->procID == 0) {
-            fprintf(primme->outputFile, " tau < LTol %e %e\n",tau, LTolerance);
+            fprintf(primme->outputFile,
+                  "|eval-eval_updated| > tau0+eres\n");
          }
-         break;
+         st->stop = 1;
+         return 0;
       }
-      if (ETolerance > 0.0 || ETolerance_factor > 0.0) {
-         /* --------------------------------------------------------*/
-         /* Adaptive stopping based on dynamic monitoring of eResid */
-         /* --------------------------------------------------------*/
 
-         /* Update the Ritz value and eigenresidual using the */
-         /* following recurrences.                            */
-      
-         Delta = gamma*Delta_prev + eta*rho_prev;
-         Beta = Beta_prev - Delta;
-         Phi = gamma*gamma*Phi_prev + eta*eta*sigma_prev;
-         Psi = gamma*Psi_prev + gamma*Phi_prev;
-         Gamma = Gamma_prev + 2.0L*Psi + Phi;
-        
-         /* Perform the update: update the eigenvalue and the square of the  */
-         /* residual norm.                                                   */
-         
-         CHKERR(dist_dot_real(sol, 1, sol, 1, primme, &dot_sol), -1);
-         eval_updated = shift + (eval - shift + 2*Beta + Gamma)/(1.0 + dot_sol);
-         eres2_updated = (tau*tau)/(1 + dot_sol) + 
-            ((eval - shift + Beta)*(eval - shift + Beta))/(1.0 + dot_sol) - 
-            (eval_updated - shift)*(eval_updated - shift);
-
-         /* If numerical problems, let eres about the same as tau */
-         eres_prev = eres_updated;
-         if (eres2_updated < 0){
-            eres_updated = sqrt( (tau*tau)/(1.0 + dot_sol) );
+      if (st->numIts > 1 && st->eres_updated < st->ETolerance) {
+         if (primme->printLevel >= 5 && primme->procID == 0) {
+            fprintf(primme->outputFile, "eres < eresTol %e \n",
+                  st->eres_updated);
          }
-         else 
-            eres_updated = sqrt(eres2_updated);
+         st->stop = 1;
+         return 0;
+      }
 
-         assert(ISFINITE(Delta) && ISFINITE(Beta) && ISFINITE(Phi)
-               && ISFINITE(Psi) && ISFINITE(Gamma) && ISFINITE(eval_updated)
-               && ISFINITE(eres2_updated) && ISFINITE(eres_updated));
+      /* Check if some of the next conditions is satisfied:             */
+      /* a) estimate eigenvalue residual norm (eres_updated) is less    */
+      /*    than eps*aNorm*Etolerance_factor                            */
+      /* b) linear system residual norm is less                         */
+      /*    than eps*aNorm*LTolerance_factor                            */
+      /* The result is to check if eps*aNorm is less than               */
+      /* max(tau/LTolerance_factor, eres_updated/ETolerance_factor).    */
 
-         /* --------------------------------------------------------*/
-         /* Stopping criteria                                       */
-         /* --------------------------------------------------------*/
+      double tol = min(st->tau/st->LTolerance_factor,
+            st->eres_updated/st->ETolerance_factor);
+      CHKERR(convTestFun_Sprimme(st->eval_updated, NULL, tol, &isConv,
+               primme), -1);
 
-         if (numIts > 1 && (tau_prev <= eres_updated || eres_prev <= tau)) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, " tau < R eres \n");
-            }
-            break;
+      if (st->numIts > 1 && isConv) {
+         if (primme->printLevel >= 5 && primme->procID == 0) {
+            fprintf(primme->outputFile, " eigenvalue and residual norm "
+                  "passed convergence criterion \n");
          }
+         st->touch++;
+         st->stop = 1;
+         return 0;
+      }
 
-         if (primme->target == primme_smallest && eval_updated > eval_prev) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "eval_updated > eval_prev\n");
-            }
-            break;
-         }
-         else if (primme->target == primme_largest && eval_updated < eval_prev){
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "eval_updated < eval_prev\n");
-            }
-            break;
-         }
-         else if (primme->target == primme_closest_abs
-               && fabs(eval-eval_updated) > tau_init+eres_updated){
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "|eval-eval_updated| > tau0+eres\n");
-            }
-            break;
-         }
-          
-         if (numIts > 1 && eres_updated < ETolerance) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, "eres < eresTol %e \n",eres_updated);
-            }
-            break;
-         }
+      st->eval_prev = st->eval_updated;
+
+      /* Report inner iteration */
+      if (monitor_filter_Sprimme(primme_event_inner_iteration, primme)) {
+         int ZERO = 0, ONE = 1;
+         primme_event EVENT_INNER_ITERATION = primme_event_inner_iteration;
+         int err;
+         primme->stats.elapsedTime = primme_get_wtime() - primme->startTime;
+         REAL evalr = st->eval_updated, resr = st->eres_updated,
+              taur = st->tau;
+
+         CHKERRM((primme->monitorFun(&evalr, &ONE, NULL, &ZERO,
+                     &ONE, &resr, NULL, NULL, NULL, NULL,
+                     NULL, &st->numIts, &taur, &EVENT_INNER_ITERATION,
+                     primme, &err),
+                  err), -1, "Error returned by monitorFun: %d", err);
+      }
 
-         /* Check if some of the next conditions is satisfied:                */
-         /* a) estimate eigenvalue residual norm (eres_updated) is less       */
-         /*    than eps*aNorm*Etolerance_factor                               */
-         /* b) linear system residual norm is less                            */
-         /*    than eps*aNorm*LTolerance_factor                               */
-         /* The result is to check if eps*aNorm is less than                  */
-         /* max(tau/LTolerance_factor, eres_updated/ETolerance_factor).       */
-
-         double tol = min(tau/LTolerance_factor, eres_updated/ETolerance_factor);
-         CHKERR(convTestFun_Sprimme(eval_updated, NULL, tol, &isConv, primme),
-               -1);
-
-         if (numIts > 1 && isConv) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, " eigenvalue and residual norm "
-                     "passed convergence criterion \n");
-            }
-            (*touch)++;
-            break;
-         }
+     /* --------------------------------------------------------*/
+   } /* End of if adaptive JDQMR section                        */
+     /* --------------------------------------------------------*/
+   else {
+      /* Check if the linear system residual norm (tau) is less         */
+      /* than eps*aNorm*LTolerance_factor                               */
 
-         eval_prev = eval_updated;
-
-         /* Report inner iteration */
-         if (primme->monitorFun) {
-            int ZERO = 0, ONE = 1;
-            primme_event EVENT_INNER_ITERATION = primme_event_inner_iteration;
-            int err;
-            primme->stats.elapsedTime = primme_wTimer(0);
-            REAL evalr = eval_updated, resr = eres_updated, taur = tau;
-            
-            CHKERRM((primme->monitorFun(&evalr, &ONE, NULL, &ZERO,
-                        &ONE, &resr, NULL, NULL, NULL, NULL,
-                        NULL, &numIts, &taur, &EVENT_INNER_ITERATION, primme, &err),
-                     err), -1, "Error returned by monitorFun: %d", err);
+      CHKERR(convTestFun_Sprimme(st->eval, NULL,
+               st->tau/st->LTolerance_factor, &isConv, primme), -1);
+
+      if (st->numIts > 1 && isConv) {
+         if (primme->printLevel >= 5 && primme->procID == 0) {
+            fprintf(primme->outputFile, " eigenvalue and residual norm "
+                  "passed convergence criterion \n");
          }
+         st->stop = 1;
+         return 0;
+      }
 
-        /* --------------------------------------------------------*/
-      } /* End of if adaptive JDQMR section                        */
-        /* --------------------------------------------------------*/
-      else {
-         /* Check if the linear system residual norm (tau) is less            */
-         /* than eps*aNorm*LTolerance_factor                                  */
+      else if (monitor_filter_Sprimme(primme_event_inner_iteration, primme)) {
+         /* Report for non adaptive inner iterations */
+         int ZERO = 0, ONE = 1, UNCO = UNCONVERGED;
+         primme_event EVENT_INNER_ITERATION = primme_event_inner_iteration;
+         int err;
+         primme->stats.elapsedTime = primme_get_wtime() - primme->startTime;
+         REAL evalr = st->eval, resr = rnorm, taur = st->tau;
+         CHKERRM((primme->monitorFun(&evalr, &ONE, &UNCO, &ZERO, &ONE,
+                     &resr, NULL, NULL, NULL, NULL, NULL, &st->numIts,
+                     &taur, &EVENT_INNER_ITERATION, primme, &err),
+                  err), -1, "Error returned by monitorFun: %d", err);
+      }
+   }
 
-         CHKERR(convTestFun_Sprimme(eval, NULL, tau/LTolerance_factor, &isConv,
-                  primme), -1);
+   return 0;
+}
 
-         if (numIts > 1 && isConv) {
-            if (primme->printLevel >= 5 && primme->procID == 0) {
-               fprintf(primme->outputFile, " eigenvalue and residual norm "
-                     "passed convergence criterion \n");
-            }
-            break;
-         }
 
-         else if (primme->monitorFun) {
-            /* Report for non adaptive inner iterations */
-            int ZERO = 0, ONE = 1, UNCO = UNCONVERGED;
-            primme_event EVENT_INNER_ITERATION = primme_event_inner_iteration;
-            int err;
-            primme->stats.elapsedTime = primme_wTimer(0);
-            REAL evalr = eval, resr = *rnorm, taur = tau;
-            CHKERRM((primme->monitorFun(&evalr, &ONE, &UNCO, &ZERO, &ONE, &resr,
-                        NULL, NULL, NULL, NULL, NULL, &numIts, &taur,
-                        &EVENT_INNER_ITERATION, primme, &err),
-                     err), -1, "Error returned by monitorFun: %d", err);
-         }
-      }
+/*******************************************************************************
+ * Subroutine shift_recurrences - Make the values of the last QMR step of an
+ *    equation the previous ones for the next step
+ ******************************************************************************/
 
-      if (numIts < maxIterations) {
-
-         CHKERR(apply_projected_preconditioner(g, evecs, ldevecs, RprojectorQ, 
-            ldRprojectorQ, x, RprojectorX, ldRprojectorX, sizeRprojectorQ,
-            sizeRprojectorX, xKinvx, UDU, ipivot, w, workSpace, primme), -1);
-
-         REAL rho_real;
-         CHKERR(dist_dot_real(g, 1, w, 1, primme, &rho_real), -1);
-         rho = rho_real;
-         beta = rho/rho_prev;
-         Num_axpy_Sprimme(primme->nLocal, beta, d, 1, w, 1);
-         /* Alternate between w and d buffers in successive iterations
-          * This saves a memory copy. */
-         ptmp = d; d = w; w = ptmp;
-      
-         rho_prev = rho; 
-         tau_prev = tau;
-         Theta_prev = Theta;
-
-         Delta_prev = Delta;
-         Beta_prev = Beta;
-         Phi_prev = Phi;
-         Psi_prev = Psi;
-         Gamma_prev = Gamma;
-      }
+static void shift_recurrences(qmr_state *st) {
 
-     /* --------------------------------------------------------*/
-   } /* End of QMR main while loop                              */
-     /* --------------------------------------------------------*/
+   st->tau_prev = st->tau;
+   st->Theta_prev = st->Theta;
 
-   *rnorm = eres_updated;
-   return 0;
+   st->Delta_prev = st->Delta;
+   st->Beta_prev = st->Beta;
+   st->Phi_prev = st->Phi;
+   st->Psi_prev = st->Psi;
+   st->Gamma_prev = st->Gamma;
 }
-   
+
 
 /*******************************************************************************
  * Function apply_projected_preconditioner - This routine applies the
- *    projected preconditioner to a vector v by computing:
+ *    projected preconditioner to the vectors v by computing:
  *
- *         result = (I-Kinvx/xKinvx*x') (I - Qhat (Q'*Qhat)^{-1}Q') Kinv*v
+ *     result_k = (I-Kinvx_j/xKinvx_j*x_j') (I - Qhat (Q'*Qhat)^{-1}Q') Kinv*v_k
  *
- *    First we apply the preconditioner Kinv*v, and then the two projectors 
- *    are computed one after the other.
+ *    with j = st[k].j. First we apply the preconditioner Kinv*v to all
+ *    vectors at once, and then the two projectors are computed one after the
+ *    other.
  *    
  * Input Parameters
  * ----------------
- * v      The vector the projected preconditioner will be applied to.
+ * v      The vectors the projected preconditioner will be applied to.
+ *
+ * n      The number of vectors in v and result
+ *
+ * st     The state of the equations
+ *
+ * shifts The shifts of the equations for primme.ShiftsForPreconditioner
  *
  * Q      The matrix evecs where evecs are the locked/converged eigenvectors
  *
  * RprojectorQ     The matrix K^{-1}Q (often called Qhat), Q, or nothing,
  *                 as determined by setup_JD_projectors.
  *
- * x               The current Ritz vector.
- *
- * RprojectorX     The matrix K^{-1}x (if needed)
- *
  * sizeRprojectorQ The number of columns in RprojectorQ
  *
- * sizeRprojectorX The number of columns in RprojectorX
- *
- * xKinvx The value x^T (Kinv*x). It is computed in the setup_JD_projectors
- *
  * UDU    The UDU decomposition of (Q'*K^{-1}*Q).  See LAPACK routine dsytrf
  *        for more details
  *
  * ipivot Permutation array indicating how the rows of the UDU decomposition
  *        have been pivoted.
  *
- * rwork  Real work array of size 2*sizeRprojectorQ=(2*orthoConst+2*numEvals)
+ * x               The current Ritz vectors.
+ *
+ * RprojectorX     The matrix K^{-1}x (if needed)
+ *
+ * sizeRprojectorX One if there is a right projector for x, and zero otherwise
+ *
+ * xKinvx The values x_j^T (Kinv*x_j). They are computed in the
+ *        setup_JD_projectors
+ *
+ * rwork  Real work array of size 2*(sizeRprojectorQ+1)*n
  *
  * primme   Structure containing various solver parameters.
  *
@@ -577,36 +1347,41 @@ int inner_solve_Sprimme(SCALAR *x, SCALAR *r, REAL *rnorm, SCALAR *evecs,
  *
  ******************************************************************************/
 
-static int apply_projected_preconditioner(SCALAR *v, SCALAR *Q, PRIMME_INT ldQ,
-      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, SCALAR *x,
-      SCALAR *RprojectorX,  PRIMME_INT ldRprojectorX, int sizeRprojectorQ,
-      int sizeRprojectorX, SCALAR *xKinvx, SCALAR *UDU, int *ipivot,
-      SCALAR *result, SCALAR *rwork, primme_params *primme) {  
+static int apply_projected_preconditioner(SCALAR *v, PRIMME_INT ldv, int n,
+      qmr_state *st, double *shifts, SCALAR *Q, PRIMME_INT ldQ,
+      SCALAR *RprojectorQ, PRIMME_INT ldRprojectorQ, int sizeRprojectorQ,
+      SCALAR *UDU, int *ipivot, SCALAR *x, PRIMME_INT ldx,
+      SCALAR *RprojectorX, PRIMME_INT ldRprojectorX, int sizeRprojectorX,
+      SCALAR *xKinvx, SCALAR *result, PRIMME_INT ldresult, SCALAR *rwork,
+      primme_params *primme) {
 
    /* Place K^{-1}v in result */
-   CHKERR(applyPreconditioner_Sprimme(v, primme->nLocal, primme->nLocal, result,
-            primme->nLocal, 1, primme), -1);
+   primme->ShiftsForPreconditioner = shifts;
+   CHKERR(applyPreconditioner_Sprimme(v, primme->nLocal, ldv, result,
+            ldresult, n, primme), -1);
 
    CHKERR(apply_skew_projector(Q, ldQ, RprojectorQ, ldRprojectorQ, UDU, ipivot,
-            sizeRprojectorQ, result, rwork, primme), -1);
+            sizeRprojectorQ, result, ldresult, n, rwork, primme), -1);
 
-   CHKERR(apply_skew_projector(x, primme->nLocal, RprojectorX, ldRprojectorX,
-            xKinvx, ipivot, sizeRprojectorX, result, rwork, primme), -1);
+   if (sizeRprojectorX > 0) {
+      CHKERR(apply_skew_projector_x(x, ldx, RprojectorX, ldRprojectorX, xKinvx,
+               st, result, ldresult, n, rwork, primme), -1);
+   }
 
    return 0;
 }
 
 /*******************************************************************************
- * Subroutine apply_skew_projector - Apply the skew projector to a vector v:
+ * Subroutine apply_skew_projector - Apply the skew projector to the vectors v:
  *
  *     v = (I-Qhat*inv(Q'Qhat)*Q') v
  *
  *   The result is placed back in v.  Q is the matrix of converged Ritz 
- *   vectors or the current Ritz vector.
+ *   vectors.
  *
  * Input Parameters
  * ----------------
- * Q       The matrix of converged Ritz vectors and the current Ritz vector
+ * Q       The matrix of converged Ritz vectors
  *
  * Qhat    The matrix of K^{-1}Q
  *
@@ -616,73 +1391,115 @@ static int apply_projected_preconditioner(SCALAR *v, SCALAR *Q, PRIMME_INT ldQ,
  *
  * numCols Number of columns of Q and Qhat
  *
- * rwork   Work array of size 2*numCols
+ * n       Number of columns of v
+ *
+ * rwork   Work array of size 2*numCols*n
  *
  * Input/Output Parameters
  * -----------------------
- * v       The vector to be skewed orthogonalized 
+ * v       The vectors to be skewed orthogonalized 
  * 
  ******************************************************************************/
 
 static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
       PRIMME_INT ldQhat, SCALAR *UDU, int *ipivot, int numCols, SCALAR *v,
-      SCALAR *rwork, primme_params *primme) {
-
-   if (numCols > 0) {    /* there is a projector to be applied */
+      PRIMME_INT ldv, int n, SCALAR *rwork, primme_params *primme) {
 
-      SCALAR *overlaps;  /* overlaps of v with columns of Q   */
-      SCALAR *workSpace; /* Used for computing local overlaps */
+   int k;
+   SCALAR *overlaps;  /* overlaps of v with columns of Q   */
+   SCALAR *workSpace; /* Used for computing local overlaps */
 
-      overlaps = rwork;
-      workSpace = overlaps + numCols;
+   if (numCols <= 0 || n <= 0) return 0;
 
-      /* --------------------------------------------------------*/
-      /* Treat the one vector case with BLAS 1 calls             */
-      /* --------------------------------------------------------*/
-      if (numCols == 1) {
-         /* Compute workspace = Q'*v */
-         CHKERR(dist_dot(Q, 1, v, 1, primme, &overlaps[0]), -1);
-
-         /* Backsolve only if there is a skew projector */
-         if (UDU != NULL) {
-            CHKERRM(ABS(UDU[0]) == 0.0, -1, "Failure factorizing UDU.");
-            overlaps[0] = overlaps[0]/UDU[0];
-         }
-         /* Compute v=v-Qhat*overlaps */
-         Num_axpy_Sprimme(primme->nLocal, -overlaps[0], Qhat, 1, v, 1);
+   overlaps = rwork;
+   workSpace = overlaps + numCols*n;
+
+   /* Compute workspace = Q'*v */
+   CHKERR(Num_gemm_locked_Sprimme("C", numCols, n, 1.0, Q, ldQ, v, ldv, 0.0,
+            workSpace, numCols, primme), -1);
+
+   /* Global sum: overlaps = Q'*v */
+   CHKERR(globalSum_Sprimme(workSpace, overlaps, numCols*n, primme), -1);
+
+   /* --------------------------------------------*/
+   /* Backsolve only if there is a skew projector */
+   /* --------------------------------------------*/
+   if (UDU != NULL) {
+      /* Solve (Q'Qhat)^{-1}*workSpace = overlaps = Q'*v for alpha by */
+      /* backsolving  with the UDU decomposition.                 */
+
+      CHKERRM(numCols == 1 && ABS(UDU[0]) == 0.0, -1,
+            "Failure factorizing UDU.");
+      for (k=0; k<n; k++) {
+         CHKERR(UDUSolve_Sprimme(UDU, ipivot, numCols, &overlaps[numCols*k],
+                  &workSpace[numCols*k], primme), -1);
       }
-      else {
-         /* ------------------------------------------------------*/
-         /* More than one vectors. Use BLAS 2.                    */
-         /* ------------------------------------------------------*/
-         /* Compute workspace = Q'*v */
-         Num_gemv_Sprimme("C", primme->nLocal, numCols, 1.0, Q, ldQ, v, 1, 0.0,
-               workSpace, 1);
-
-         /* Global sum: overlaps = Q'*v */
-         CHKERR(globalSum_Sprimme(workSpace, overlaps, numCols, primme), -1);
-
-         /* --------------------------------------------*/
-         /* Backsolve only if there is a skew projector */
-         /* --------------------------------------------*/
-         if (UDU != NULL) {
-            /* Solve (Q'Qhat)^{-1}*workSpace = overlaps = Q'*v for alpha by */
-            /* backsolving  with the UDU decomposition.                 */
-   
-            CHKERR(UDUSolve_Sprimme(UDU, ipivot, numCols, overlaps,
-                     workSpace, primme), -1);
 
-            /* Compute v=v-Qhat*workspace */
-            Num_gemv_Sprimme("N", primme->nLocal, numCols, -1.0, Qhat, ldQhat,
-                  workSpace, 1, 1.0, v, 1);
-         }
-         else  {
-            /* Compute v=v-Qhat*overlaps  */
-            Num_gemv_Sprimme("N", primme->nLocal, numCols, -1.0, Qhat, ldQhat,
-                  overlaps, 1, 1.0, v, 1);
-         } /* UDU==null */
-      } /* numCols != 1 */
-   } /* numCols > 0 */
+      /* Compute v=v-Qhat*workspace */
+      CHKERR(Num_gemm_locked_Sprimme("N", numCols, n, -1.0, Qhat, ldQhat,
+               workSpace, numCols, 1.0, v, ldv, primme), -1);
+   }
+   else  {
+      /* Compute v=v-Qhat*overlaps  */
+      CHKERR(Num_gemm_locked_Sprimme("N", numCols, n, -1.0, Qhat, ldQhat,
+               overlaps, numCols, 1.0, v, ldv, primme), -1);
+   } /* UDU==null */
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine apply_skew_projector_x - Apply the skew projector with the Ritz
+ *    vector of each equation to the vectors v:
+ *
+ *     v_k = (I-xhat_j*inv(x_j'xhat_j)*x_j') v_k, with j = st[k].j
+ *
+ *   The result is placed back in v.
+ *
+ * Input Parameters
+ * ----------------
+ * x       The current Ritz vectors
+ *
+ * xhat    The vectors K^{-1}x or x
+ *
+ * xKinvx  The values x_j'*xhat_j
+ *
+ * st      The state of the equations
+ *
+ * n       Number of columns of v
+ *
+ * rwork   Work array of size 2*n
+ *
+ * Input/Output Parameters
+ * -----------------------
+ * v       The vectors to be skewed orthogonalized 
+ * 
+ ******************************************************************************/
+
+static int apply_skew_projector_x(SCALAR *x, PRIMME_INT ldx, SCALAR *xhat,
+      PRIMME_INT ldxhat, SCALAR *xKinvx, qmr_state *st, SCALAR *v,
+      PRIMME_INT ldv, int n, SCALAR *rwork, primme_params *primme) {
+
+   int k;
+   SCALAR *overlaps;  /* overlaps of v_k with x_j          */
+   SCALAR *workSpace; /* Used for computing local overlaps */
+
+   overlaps = rwork;
+   workSpace = overlaps + n;
+
+   /* Compute workspace = x_j'*v_k */
+   for (k=0; k<n; k++) {
+      workSpace[k] = Num_dot_Sprimme(primme->nLocal, &x[ldx*st[k].j], 1,
+            &v[ldv*k], 1);
+   }
+   CHKERR(globalSum_Sprimme(workSpace, overlaps, n, primme), -1);
+
+   /* Compute v_k=v_k-xhat_j*overlaps_k/xKinvx_j */
+   for (k=0; k<n; k++) {
+      CHKERRM(ABS(xKinvx[st[k].j]) == 0.0, -1, "Failure factorizing UDU.");
+      Num_axpy_Sprimme(primme->nLocal, -overlaps[k]/xKinvx[st[k].j],
+            &xhat[ldxhat*st[k].j], 1, &v[ldv*k], 1);
+   }
 
    return 0;
 }
@@ -690,20 +1507,27 @@ static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
 
 /*******************************************************************************
  * Subroutine apply_projected_matrix - This subroutine applies the 
- *    projected matrix (I-Q*Q')*(A-shift*I) to a vector v by computing 
- *    (A-shift*I)v then orthogonalizing the result with Q.
+ *    projected matrix (I-[Q x_j]*[Q x_j]')*(A-shift_j*I) to the vectors v by
+ *    computing (A-shift_j*I)v_k with a single matvec call, and then
+ *    orthogonalizing the results with [Q x_j], with j = st[k].j.
  *
  * Input Parameters
  * ----------------
- * v      The vector the projected matrix will be applied to
+ * v      The vectors the projected matrix will be applied to
  *
- * shift  The amount the matrix is shifted by.
+ * n      The number of vectors in v and result
  *
- * Q      The converged Ritz vectors and the current Ritz vector
+ * st     The state of the equations, including the shifts
+ *
+ * Q      The converged Ritz vectors
  *
  * dimQ   The number of columns of Q
  * 
- * rwork  Workspace of size 2*dimQ
+ * x      The current Ritz vectors
+ *
+ * dimX   One if x_j is in the projector, and zero otherwise
+ * 
+ * rwork  Workspace of size 2*(dimQ+1)*n
  *
  * primme   Structure containing various solver parameters
  *
@@ -714,120 +1538,441 @@ static int apply_skew_projector(SCALAR *Q, PRIMME_INT ldQ, SCALAR *Qhat,
  *
  ******************************************************************************/
 
-static int apply_projected_matrix(SCALAR *v, REAL shift, SCALAR *Q, 
-      PRIMME_INT ldQ, int dimQ, SCALAR *result, SCALAR *rwork,
-      primme_params *primme) {
+static int apply_projected_matrix(SCALAR *v, PRIMME_INT ldv, int n,
+      qmr_state *st, SCALAR *Q, PRIMME_INT ldQ, int dimQ, SCALAR *x,
+      PRIMME_INT ldx, int dimX, SCALAR *result, PRIMME_INT ldresult,
+      SCALAR *rwork, primme_params *primme) {
+
+   int k;
 
-   CHKERR(matrixMatvec_Sprimme(v, primme->nLocal, primme->nLocal, result,
-         primme->nLocal, 0, 1, primme), -1);
-   Num_axpy_Sprimme(primme->nLocal, -shift, v, 1, result, 1); 
-   if (dimQ > 0)
-      CHKERR(apply_projector(Q, ldQ, dimQ, result, rwork, primme), -1);
+   CHKERR(matrixMatvec_Sprimme(v, primme->nLocal, ldv, result, ldresult, 0, n,
+            primme), -1);
+   for (k=0; k<n; k++) {
+      Num_axpy_Sprimme(primme->nLocal, -st[k].shift, &v[ldv*k], 1,
+            &result[ldresult*k], 1); 
+   }
+   if (dimQ+dimX > 0) {
+      CHKERR(apply_projector(Q, ldQ, dimQ, x, ldx, dimX, st, result, ldresult,
+               n, rwork, primme), -1);
+   }
 
    return 0;
 }
    
 
 /*******************************************************************************
- * Subroutine apply_projector - Apply the projector (I-Q*Q') to a vector v and
- *   place the result in v.  Q is the matrix of converged Ritz vectors and the
- *   current Ritz vector.
+ * Subroutine apply_projector - Apply the projector (I-[Q x_j]*[Q x_j]') to the
+ *   vectors v_k, with j = st[k].j, and place the result in v. Q is the matrix
+ *   of converged Ritz vectors and x_j the current Ritz vector of the equation.
  *
  * Input Parameters
  * ----------------
- * Q       The matrix of converged Ritz vectors and the current Ritz vector
+ * Q       The matrix of converged Ritz vectors
  *
- * nLocal  The number of rows of Q and v the process has
- * 
- * numCols Number of columns of Q
+ * dimQ    Number of columns of Q
+ *
+ * x       The current Ritz vectors
+ *
+ * dimX    One if x_j is in the projector, and zero otherwise
+ *
+ * st      The state of the equations
  *
- * rwork   Work array of size 2*numCols
+ * n       Number of columns of v
+ *
+ * rwork   Work array of size 2*(dimQ+dimX)*n
  *
  * Input/Output Parameters
  * -----------------------
- * v       The vector to be orthogonalized against Q
+ * v       The vectors to be orthogonalized against [Q x_j]
  * 
  ******************************************************************************/
 
-static int apply_projector(SCALAR *Q, PRIMME_INT ldQ, int numCols, SCALAR *v, 
-   SCALAR *rwork, primme_params *primme) {
+static int apply_projector(SCALAR *Q, PRIMME_INT ldQ, int dimQ, SCALAR *x,
+      PRIMME_INT ldx, int dimX, qmr_state *st, SCALAR *v, PRIMME_INT ldv,
+      int n, SCALAR *rwork, primme_params *primme) {
 
-   SCALAR *overlaps;  /* overlaps of v with columns of Q   */
-   SCALAR *workSpace; /* Used for computing local overlaps */
+   int k, m = dimQ + dimX;
+   SCALAR *overlaps;  /* overlaps of v with columns of [Q x_j] */
+   SCALAR *workSpace; /* Used for computing local overlaps     */
 
    overlaps = rwork;
-   workSpace = overlaps + numCols;
+   workSpace = overlaps + m*n;
+
+   /* workSpace(:,k) = [Q x_j]'*v_k */
+   if (dimQ > 0) {
+      CHKERR(Num_gemm_locked_Sprimme("C", dimQ, n, 1.0, Q, ldQ, v, ldv, 0.0,
+               workSpace, m, primme), -1);
+   }
+   if (dimX > 0) for (k=0; k<n; k++) {
+      workSpace[m*k+dimQ] = Num_dot_Sprimme(primme->nLocal, &x[ldx*st[k].j],
+            1, &v[ldv*k], 1);
+   }
+   CHKERR(globalSum_Sprimme(workSpace, overlaps, m*n, primme), -1);
 
-   Num_gemv_Sprimme("C", primme->nLocal, numCols, 1.0, Q, ldQ, v, 1, 0.0,
-         workSpace, 1);
-   CHKERR(globalSum_Sprimme(workSpace, overlaps, numCols, primme), -1);
-   Num_gemv_Sprimme("N", primme->nLocal, numCols, -1.0, Q, ldQ, overlaps,
-         1, 1.0, v, 1);
+   /* v_k = v_k - [Q x_j]*overlaps(:,k) */
+   if (dimQ > 0) {
+      CHKERR(Num_gemm_locked_Sprimme("N", dimQ, n, -1.0, Q, ldQ, overlaps, m,
+               1.0, v, ldv, primme), -1);
+   }
+   if (dimX > 0) for (k=0; k<n; k++) {
+      Num_axpy_Sprimme(primme->nLocal, -overlaps[m*k+dimQ], &x[ldx*st[k].j],
+            1, &v[ldv*k], 1);
+   }
 
    return 0;
 }
 
 
 /*******************************************************************************
- * Function dist_dot - Computes dot products in parallel.
+ * Function dist_dots_real - Computes the real part of the inner products of
+ *    the columns of x and y in parallel, with a single global sum.
  *
  * Input Parameters
  * ----------------
- * x, y  Operands of the dot product operation
+ * x, y  Operands of the dot product operations
  *
- * incx  Array increment for x.  A value of 1 implies the elements are
- *       contiguous in memory.
+ * ldx, ldy  The leading dimensions of x and y
  *
- * incy  Array increment for y.  A value of 1 implies the elements are
- *       contiguous in memory.
+ * n     The number of columns of x and y
+ *
+ * rwork Workspace of size 2*n
  *
  * primme  Structure containing various solver parameters
  *
- * result The inner product
+ * Output Parameter
+ * ----------------
+ * result The real part of the inner products x(:,k)'*y(:,k)
  *
  ******************************************************************************/
 
-static int dist_dot(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, SCALAR *result) {
-                                                                                
-   SCALAR temp;
-                                                                                
-   temp = Num_dot_Sprimme(primme->nLocal, x, incx, y, incy);
-   CHKERR(globalSum_Sprimme(&temp, result, 1, primme), -1);
+static int dist_dots_real(SCALAR *x, PRIMME_INT ldx, SCALAR *y,
+      PRIMME_INT ldy, int n, REAL *result, SCALAR *rwork,
+      primme_params *primme) {
+
+   int k;
+
+   for (k=0; k<n; k++) {
+      rwork[k] = Num_dot_Sprimme(primme->nLocal, &x[ldx*k], 1, &y[ldy*k], 1);
+   }
+   CHKERR(globalSum_Sprimme(rwork, rwork+n, n, primme), -1);
+   for (k=0; k<n; k++) {
+      result[k] = REAL_PART(rwork[n+k]);
+   }
 
    return 0;
 }
 
+
+#ifdef USE_LOWER_INNER
+
 /*******************************************************************************
- * Function dist_dot_real - Computes dot products in parallel and return the
- *    real part.
-*
- * Input Parameters
- * ----------------
- * x, y  Operands of the dot product operation
+ * Mixed precision inner solve
  *
- * incx  Array increment for x.  A value of 1 implies the elements are
- *       contiguous in memory.
+ *    If primme.innerSinglePrecision, the double precision solvers pass x, r,
+ *    the projectors and the other inputs of inner_solve rounded to LSCALAR to
+ *    the single precision inner_solve, and the corrections are rounded back.
+ *    The single precision solver runs on a copy of primme whose callbacks
+ *    are the adapters below: they convert the vectors and call the user
+ *    callbacks with the user's primme. The copy is the first member of
+ *    lower_ctx, so the adapters get the context from the primme they are
+ *    passed.
  *
- * incy  Array increment for y.  A value of 1 implies the elements are
- *       contiguous in memory.
- *
- * primme  Structure containing various solver parameters
+ ******************************************************************************/
+
+typedef struct {
+   primme_params primme;  /* Copy of primme used by the inner solve        */
+   primme_params *orig;   /* The user's primme                             */
+   SCALAR *x, *y;         /* Buffers of ldb x blockSize for the operators  */
+   PRIMME_INT ldb;        /* Leading dimension of x and y                  */
+   int blockSize;         /* Number of columns of x and y                  */
+} lower_ctx;
+
+static void copy_to_lower(PRIMME_INT m, int n, SCALAR *a, PRIMME_INT lda,
+      LSCALAR *b, PRIMME_INT ldb) {
+
+   int j;
+   PRIMME_INT i;
+
+   for (j=0; j<n; j++) {
+      for (i=0; i<m; i++) {
+         b[ldb*j+i] = (LSCALAR)a[lda*j+i];
+      }
+   }
+}
+
+static void copy_from_lower(PRIMME_INT m, int n, LSCALAR *a, PRIMME_INT lda,
+      SCALAR *b, PRIMME_INT ldb) {
+
+   int j;
+   PRIMME_INT i;
+
+   for (j=0; j<n; j++) {
+      for (i=0; i<m; i++) {
+         b[ldb*j+i] = (SCALAR)a[lda*j+i];
+      }
+   }
+}
+
+/* Apply a double precision operator on single precision vectors */
+
+static void lower_operator(void (*op)(void *, PRIMME_INT *, void *,
+         PRIMME_INT *, int *, struct primme_params *, int *), void *x,
+      PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+      lower_ctx *ctx, int *ierr) {
+
+   PRIMME_INT nLocal = ctx->orig->nLocal, n;
+
+   if (*blockSize > ctx->blockSize) {
+      *ierr = -1;
+      return;
+   }
+
+   /* With rowMajorOPs the blocks are contiguous arrays of nLocal*blockSize */
+   /* elements with leading dimension blockSize                             */
+
+   if (ctx->orig->rowMajorOPs) {
+      n = nLocal*(*blockSize);
+      copy_from_lower(n, 1, (LSCALAR*)x, n, ctx->x, n);
+      op(ctx->x, ldx, ctx->y, ldy, blockSize, ctx->orig, ierr);
+      if (*ierr == 0) copy_to_lower(n, 1, ctx->y, n, (LSCALAR*)y, n);
+      return;
+   }
+
+   copy_from_lower(nLocal, *blockSize, (LSCALAR*)x, *ldx, ctx->x, ctx->ldb);
+   op(ctx->x, &ctx->ldb, ctx->y, &ctx->ldb, blockSize, ctx->orig, ierr);
+   if (*ierr == 0) {
+      copy_to_lower(nLocal, *blockSize, ctx->y, ctx->ldb, (LSCALAR*)y, *ldy);
+   }
+}
+
+static void lower_matvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr) {
+
+   lower_ctx *ctx = (lower_ctx*)primme;
+
+   if (ctx->orig->matrixMatvecSingle) {
+      ctx->orig->matrixMatvecSingle(x, ldx, y, ldy, blockSize, ctx->orig,
+            ierr);
+   }
+   else {
+      lower_operator(ctx->orig->matrixMatvec, x, ldx, y, ldy, blockSize, ctx,
+            ierr);
+   }
+}
+
+static void lower_precond(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr) {
+
+   lower_ctx *ctx = (lower_ctx*)primme;
+   double *shifts = ctx->orig->ShiftsForPreconditioner;
+
+   ctx->orig->ShiftsForPreconditioner = primme->ShiftsForPreconditioner;
+   if (ctx->orig->applyPreconditionerSingle) {
+      ctx->orig->applyPreconditionerSingle(x, ldx, y, ldy, blockSize,
+            ctx->orig, ierr);
+   }
+   else {
+      lower_operator(ctx->orig->applyPreconditioner, x, ldx, y, ldy,
+            blockSize, ctx, ierr);
+   }
+   ctx->orig->ShiftsForPreconditioner = shifts;
+}
+
+static void lower_globalSum(void *sendBuf, void *recvBuf, int *count,
+      primme_params *primme, int *ierr) {
+
+   lower_ctx *ctx = (lower_ctx*)primme;
+   REAL *buf;
+   int i;
+
+   if (MALLOC_PRIMME((size_t)*count*2, &buf) != 0) {
+      *ierr = -1;
+      return;
+   }
+   for (i=0; i<*count; i++) buf[i] = ((LREAL*)sendBuf)[i];
+   ctx->orig->globalSumReal(buf, buf+*count, count, ctx->orig, ierr);
+   for (i=0; i<*count; i++) ((LREAL*)recvBuf)[i] = (LREAL)buf[*count+i];
+   free(buf);
+}
+
+static void lower_convTest(double *eval, void *evec, double *rNorm,
+      int *isconv, primme_params *primme, int *ierr) {
+
+   lower_ctx *ctx = (lower_ctx*)primme;
+
+   /* The inner solve does not pass the eigenvector */
+   assert(evec == NULL);
+   ctx->orig->stats = primme->stats;
+   ctx->orig->convTestFun(eval, evec, rNorm, isconv, ctx->orig, ierr);
+}
+
+static void lower_monitor(void *basisEvals, int *basisSize, int *basisFlags,
+      int *iblock, int *blockSize, void *basisNorms, int *numConverged,
+      void *lockedEvals, int *numLocked, int *lockedFlags, void *lockedNorms,
+      int *inner_its, void *LSRes, primme_event *event, primme_params *primme,
+      int *err) {
+
+   lower_ctx *ctx = (lower_ctx*)primme;
+   REAL evalr, resr, taur;
+
+   /* The inner solve reports a single pair per event */
+   assert(*basisSize == 1 && lockedEvals == NULL);
+   evalr = *(LREAL*)basisEvals;
+   resr = *(LREAL*)basisNorms;
+   taur = *(LREAL*)LSRes;
+   ctx->orig->stats = primme->stats;
+   ctx->orig->monitorFun(&evalr, basisSize, basisFlags, iblock, blockSize,
+         &resr, numConverged, lockedEvals, numLocked, lockedFlags,
+         lockedNorms, inner_its, &taur, event, ctx->orig, err);
+}
+
+/*******************************************************************************
+ * Subroutine inner_solve_lower - Solve the correction equations as
+ *    inner_solve, rounding the inputs to LSCALAR and calling inner_solve for
+ *    LSCALAR. The memory is allocated in every call.
  *
- * Output Parameter
- * ----------------
- * result The real part of the inner product
+ * Parameters are the ones of inner_solve.
  *
  ******************************************************************************/
 
-static int dist_dot_real(SCALAR *x, int incx,
-   SCALAR *y, int incy, primme_params *primme, REAL *result) {
-                                                                                
-   SCALAR temp, product;
-                                                                                
-   temp = Num_dot_Sprimme(primme->nLocal, x, incx, y, incy);
-   CHKERR(globalSum_Sprimme(&temp, &product, 1, primme), -1);
-   *result = REAL_PART(product);
+static int inner_solve_lower(int blockSize, SCALAR *x, PRIMME_INT ldx,
+      SCALAR *r, PRIMME_INT ldr, REAL *rnorm, SCALAR *evecs,
+      PRIMME_INT ldevecs, SCALAR *UDU, int *ipivot, SCALAR *xKinvx,
+      SCALAR *Lprojector, PRIMME_INT ldLprojector, SCALAR *RprojectorQ,
+      PRIMME_INT ldRprojectorQ, SCALAR *RprojectorX, PRIMME_INT ldRprojectorX,
+      int sizeLprojector, int sizeLprojectorX, int sizeRprojectorQ,
+      int sizeRprojectorX, SCALAR *sol, PRIMME_INT ldsol, REAL *eval,
+      double *shift, int *touch, double machEps, primme_params *primme) {
+
+   int k, ret;
+   PRIMME_INT nLocal = primme->nLocal;
+   double t0 = primme_get_wtime(), timeInnerSolve;
+   lower_ctx ctx;
+   size_t lwork, lrwork, size;
+   char *work;
+   LSCALAR *lx, *lr, *lsol, *lQ, *lLprojector, *lRprojectorQ, *lRprojectorX;
+   LSCALAR *lUDU = NULL, *lxKinvx, *lrwork0;
+   LREAL *lrnorm, *leval;
+   SCALAR *rwork;
+
+   if (blockSize <= 0) return 0;
+
+   /* Set up the copy of primme for the single precision solver */
+
+   ctx.primme = *primme;
+   ctx.orig = primme;
+   ctx.ldb = primme->ldOPs > 0 ? primme->ldOPs : nLocal;
+   ctx.blockSize = blockSize;
+   ctx.primme.matrixMatvec = lower_matvec;
+   ctx.primme.applyPreconditioner = lower_precond;
+   ctx.primme.globalSumReal = primme->globalSumReal ? lower_globalSum : NULL;
+   ctx.primme.globalSumRealStart = NULL;
+   ctx.primme.globalSumRealWait = NULL;
+   ctx.primme.convTestFun = lower_convTest;
+   ctx.primme.monitorFun = primme->monitorFun ? lower_monitor : NULL;
+   ctx.primme.lockedPanelSize = 0;
+   ctx.primme.lockedPaging = NULL;
+   ctx.primme.basisPanelRows = 0;
+   ctx.primme.basisPaging = NULL;
+
+   /* Query the workspace of the single precision solver */
+
+   lrwork = 0;
+   CHKERR(inner_solve_Lprimme(blockSize, NULL, 0, NULL, 0, NULL, NULL, 0,
+            NULL, NULL, NULL, NULL, 0, NULL, 0, NULL, 0, 0, 0, 0, 0, NULL, 0,
+            NULL, NULL, NULL, 0.0, NULL, &lrwork, &ctx.primme), -1);
+
+   /* Allocate the buffers of the operators, the rounded inputs and the   */
+   /* workspace: x, r, sol, Q, Lprojector, RprojectorQ and RprojectorX    */
+   /* in LSCALAR take up to 7 blocks of nLocal rows                       */
+
+   lwork = (size_t)ctx.ldb*blockSize*2;
+   size = lwork*sizeof(SCALAR)
+      + ((size_t)nLocal*(3*blockSize + sizeLprojector + 2*sizeRprojectorQ
+            + (sizeRprojectorX ? blockSize : 0))
+         + (size_t)sizeRprojectorQ*sizeRprojectorQ + blockSize + lrwork + 8)
+           *sizeof(LSCALAR)
+      + (size_t)blockSize*2*sizeof(LREAL);
+   CHKERR(MALLOC_PRIMME(size, &work), -1);
+   rwork = (SCALAR*)work;
+   ctx.x = rwork;
+   ctx.y = rwork + (size_t)ctx.ldb*blockSize;
+   lx = (LSCALAR*)(rwork + lwork);
+   lr = lx + nLocal*blockSize;
+   lsol = lr + nLocal*blockSize;
+   lQ = lsol + nLocal*blockSize;
+   lLprojector = lQ + nLocal*sizeRprojectorQ;
+   lRprojectorQ = lLprojector + nLocal*sizeLprojector;
+   lRprojectorX = lRprojectorQ + nLocal*sizeRprojectorQ;
+   lxKinvx = lRprojectorX + (sizeRprojectorX ? nLocal*blockSize : 0);
+   lrwork0 = lxKinvx + blockSize;
+   if (UDU && sizeRprojectorQ > 0) {
+      lUDU = lrwork0;
+      lrwork0 += sizeRprojectorQ*sizeRprojectorQ;
+   }
+   lrwork0 = (LSCALAR*)ALIGN(lrwork0, double);
+   lrnorm = (LREAL*)(lrwork0 + lrwork);
+   leval = lrnorm + blockSize;
+
+   /* Round the inputs; the projectors that point to evecs or x are      */
+   /* rounded once                                                       */
+
+   copy_to_lower(nLocal, blockSize, x, ldx, lx, nLocal);
+   copy_to_lower(nLocal, blockSize, r, ldr, lr, nLocal);
+   copy_to_lower(nLocal, sizeRprojectorQ, evecs, ldevecs, lQ, nLocal);
+   if (Lprojector == evecs && sizeLprojector <= sizeRprojectorQ) {
+      lLprojector = lQ;
+   }
+   else {
+      copy_to_lower(nLocal, sizeLprojector, Lprojector, ldLprojector,
+            lLprojector, nLocal);
+   }
+   if (RprojectorQ == evecs) {
+      lRprojectorQ = lQ;
+   }
+   else {
+      copy_to_lower(nLocal, sizeRprojectorQ, RprojectorQ, ldRprojectorQ,
+            lRprojectorQ, nLocal);
+   }
+   if (sizeRprojectorX && RprojectorX == x) {
+      lRprojectorX = lx;
+   }
+   else if (sizeRprojectorX) {
+      copy_to_lower(nLocal, blockSize, RprojectorX, ldRprojectorX,
+            lRprojectorX, nLocal);
+   }
+   if (sizeRprojectorX) copy_to_lower(blockSize, 1, xKinvx, 0, lxKinvx, 0);
+   if (lUDU) {
+      copy_to_lower(sizeRprojectorQ, sizeRprojectorQ, UDU, sizeRprojectorQ,
+            lUDU, sizeRprojectorQ);
+   }
+   for (k=0; k<blockSize; k++) {
+      lrnorm[k] = (LREAL)rnorm[k];
+      leval[k] = (LREAL)eval[k];
+   }
+
+   /* Solve the equations; the attainable accuracy is the one of LSCALAR */
+
+   ret = inner_solve_Lprimme(blockSize, lx, nLocal, lr, nLocal, lrnorm, lQ,
+         nLocal, lUDU, ipivot, lxKinvx, lLprojector, nLocal, lRprojectorQ,
+         nLocal, lRprojectorX, nLocal, sizeLprojector, sizeLprojectorX,
+         sizeRprojectorQ, sizeRprojectorX, lsol, nLocal, leval, shift, touch,
+         max(machEps, (double)FLT_EPSILON), lrwork0, &lrwork, &ctx.primme);
+
+   /* Return the solutions, the norms and the statistics */
+
+   if (ret == 0) {
+      copy_from_lower(nLocal, blockSize, lsol, nLocal, sol, ldsol);
+      for (k=0; k<blockSize; k++) rnorm[k] = (REAL)lrnorm[k];
+   }
+   timeInnerSolve = primme->stats.timeInnerSolve;
+   primme->stats = ctx.primme.stats;
+   primme->stats.timeInnerSolve = timeInnerSolve + primme_get_wtime() - t0;
+   primme->ShiftsForPreconditioner = shift;
+   free(work);
+   CHKERR(ret, -1);
 
    return 0;
 }
+
+#endif /* USE_LOWER_INNER */
@@ -39,32 +39,40 @@
 #if !defined(CHECK_TEMPLATE) && !defined(inner_solve_Rprimme)
 #  define inner_solve_Rprimme CONCAT(inner_solve_,REAL_SUF)
 #endif
-int inner_solve_dprimme(double *x, double *r, double *rnorm, double *evecs,
-      PRIMME_INT ldevecs, double *UDU, int *ipivot, double *xKinvx,
-      double *Lprojector, PRIMME_INT ldLprojector, double *RprojectorQ,
-      PRIMME_INT ldRprojectorQ, double *RprojectorX, PRIMME_INT ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, double *sol,
-      double eval, double shift, int *touch, double machEps, double *rwork,
-      size_t rworkSize, primme_params *primme);
-int inner_solve_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_COMPLEX_DOUBLE *r, double *rnorm, PRIMME_COMPLEX_DOUBLE *evecs,
-      PRIMME_INT ldevecs, PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, PRIMME_COMPLEX_DOUBLE *xKinvx,
-      PRIMME_COMPLEX_DOUBLE *Lprojector, PRIMME_INT ldLprojector, PRIMME_COMPLEX_DOUBLE *RprojectorQ,
-      PRIMME_INT ldRprojectorQ, PRIMME_COMPLEX_DOUBLE *RprojectorX, PRIMME_INT ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, PRIMME_COMPLEX_DOUBLE *sol,
-      double eval, double shift, int *touch, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
-      size_t rworkSize, primme_params *primme);
-int inner_solve_sprimme(float *x, float *r, float *rnorm, float *evecs,
-      PRIMME_INT ldevecs, float *UDU, int *ipivot, float *xKinvx,
-      float *Lprojector, PRIMME_INT ldLprojector, float *RprojectorQ,
-      PRIMME_INT ldRprojectorQ, float *RprojectorX, PRIMME_INT ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, float *sol,
-      float eval, float shift, int *touch, double machEps, float *rwork,
-      size_t rworkSize, primme_params *primme);
-int inner_solve_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_COMPLEX_FLOAT *r, float *rnorm, PRIMME_COMPLEX_FLOAT *evecs,
-      PRIMME_INT ldevecs, PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, PRIMME_COMPLEX_FLOAT *xKinvx,
-      PRIMME_COMPLEX_FLOAT *Lprojector, PRIMME_INT ldLprojector, PRIMME_COMPLEX_FLOAT *RprojectorQ,
-      PRIMME_INT ldRprojectorQ, PRIMME_COMPLEX_FLOAT *RprojectorX, PRIMME_INT ldRprojectorX,
-      int sizeLprojector, int sizeRprojectorQ, int sizeRprojectorX, PRIMME_COMPLEX_FLOAT *sol,
-      float eval, float shift, int *touch, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
-      size_t rworkSize, primme_params *primme);
+int inner_solve_dprimme(int blockSize, double *x, PRIMME_INT ldx, double *r,
+      PRIMME_INT ldr, double *rnorm, double *evecs, PRIMME_INT ldevecs,
+      double *UDU, int *ipivot, double *xKinvx, double *Lprojector,
+      PRIMME_INT ldLprojector, double *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      double *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      double *sol, PRIMME_INT ldsol, double *eval, double *shift, int *touch,
+      double machEps, double *rwork, size_t *rworkSize,
+      primme_params *primme);
+int inner_solve_zprimme(int blockSize, PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT ldx, PRIMME_COMPLEX_DOUBLE *r,
+      PRIMME_INT ldr, double *rnorm, PRIMME_COMPLEX_DOUBLE *evecs, PRIMME_INT ldevecs,
+      PRIMME_COMPLEX_DOUBLE *UDU, int *ipivot, PRIMME_COMPLEX_DOUBLE *xKinvx, PRIMME_COMPLEX_DOUBLE *Lprojector,
+      PRIMME_INT ldLprojector, PRIMME_COMPLEX_DOUBLE *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      PRIMME_COMPLEX_DOUBLE *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      PRIMME_COMPLEX_DOUBLE *sol, PRIMME_INT ldsol, double *eval, double *shift, int *touch,
+      double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
+      primme_params *primme);
+int inner_solve_sprimme(int blockSize, float *x, PRIMME_INT ldx, float *r,
+      PRIMME_INT ldr, float *rnorm, float *evecs, PRIMME_INT ldevecs,
+      float *UDU, int *ipivot, float *xKinvx, float *Lprojector,
+      PRIMME_INT ldLprojector, float *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      float *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      float *sol, PRIMME_INT ldsol, float *eval, double *shift, int *touch,
+      double machEps, float *rwork, size_t *rworkSize,
+      primme_params *primme);
+int inner_solve_cprimme(int blockSize, PRIMME_COMPLEX_FLOAT *x, PRIMME_INT ldx, PRIMME_COMPLEX_FLOAT *r,
+      PRIMME_INT ldr, float *rnorm, PRIMME_COMPLEX_FLOAT *evecs, PRIMME_INT ldevecs,
+      PRIMME_COMPLEX_FLOAT *UDU, int *ipivot, PRIMME_COMPLEX_FLOAT *xKinvx, PRIMME_COMPLEX_FLOAT *Lprojector,
+      PRIMME_INT ldLprojector, PRIMME_COMPLEX_FLOAT *RprojectorQ, PRIMME_INT ldRprojectorQ,
+      PRIMME_COMPLEX_FLOAT *RprojectorX, PRIMME_INT ldRprojectorX, int sizeLprojector,
+      int sizeLprojectorX, int sizeRprojectorQ, int sizeRprojectorX,
+      PRIMME_COMPLEX_FLOAT *sol, PRIMME_INT ldsol, float *eval, double *shift, int *touch,
+      double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
+      primme_params *primme);
 #endif
@@ -54,9 +54,10 @@
 #include "auxiliary_eigs.h"
 
 static int verify_norms(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
-      REAL *hVals, int basisSize, REAL *resNorms, int *flags, int *converged,
-      double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
-      int iworkSize, primme_params *primme);
+      SCALAR *BV, REAL *hVals, int basisSize, REAL *resNorms,
+      int freshResNorms, int *flags, int *converged, double machEps,
+      SCALAR *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme);
 
 /******************************************************************************
  * Subroutine main_iter - This routine implements a more general, parallel, 
@@ -154,6 +155,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    int converged;           /* True when all required Ritz vals. converged   */
    int LockingProblem;      /* Flag==1 if practically converged pairs locked */
    int restartLimitReached; /* True when maximum restarts performed          */
+   int freshResNorms=0;     /* resNorms recomputed at the last restart       */
    int numPrevRetained;     /* Number of vectors retained using recurrence-  */
                             /* based restarting.                             */
    int numArbitraryVecs;    /* Columns in hVecs computed with RR instead of  */
@@ -162,8 +164,19 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    size_t rworkSize;        /* Size of rwork array                           */
    int iworkSize;           /* Size of iwork array                           */
    int numPrevRitzVals = 0; /* Size of the prevRitzVals updated in correction*/
+   int numPrevLocked = 0;   /* Locked values in prevRitzVals                 */
+   int numPrecondShifts = 0;/* Size of precondShifts                         */
+   int filterDegree;        /* Degree of the Chebyshev filter applied        */
    int ret;                 /* Return value                                  */
    int touch=0;             /* param used in inner solver stopping criteria  */
+   int numSteps;            /* Number of blocks added in this iteration      */
+   int numNewVecs;          /* Number of vectors added in this iteration     */
+   int selectiveOrtho;      /* Skip orthogonalizing the block against V      */
+   double orthoLoss=0.0;    /* Estimated loss of orthogonality of V          */
+   double orthoTol;         /* Loss tolerated with primme_orth_selective     */
+   globalsum_queue queue;   /* Pending reductions of H, QtV and VtBV         */
+   SCALAR *sumBuf = NULL;   /* Buffer for the nonblocking sum of H           */
+   size_t sumBufSize = 0;   /* Size of sumBuf                                */
 
    int *iwork;              /* Integer workspace pointer                     */
    int *flags;              /* Indicates which Ritz values have converged    */
@@ -175,8 +188,10 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    PRIMME_INT ldV;          /* The leading dimension of V                    */
    SCALAR *W;               /* Work space storing A*V                        */
    PRIMME_INT ldW;          /* The leading dimension of W                    */
+   SCALAR *BV = NULL;       /* B*V, if massMatrixMatvec and massMatrixCache  */
    SCALAR *H;               /* Upper triangular portion of V'*A*V            */
    SCALAR *VtBV = NULL;     /* Upper triangular portion of V'*B*V            */
+   SCALAR *VtV = NULL;      /* V'*V, to check the orthogonality of V         */
    SCALAR *M = NULL;        /* The projection Q'*K*Q, where Q = [evecs, x]   */
                             /* x is the current Ritz vector and K is a       */
                             /* hermitian preconditioner.                     */
@@ -195,18 +210,29 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    SCALAR *R = NULL;        /* projection: (A-target[i])*V = QR              */
    SCALAR *QtV = NULL;      /* Q'*V                                          */
    SCALAR *hVecsRot=NULL;   /* transformation of hVecs in arbitrary vectors  */
+   int numAux=0;            /* Vectors added to the block for the next shifts*/
+   int multiShiftIndex=-1;  /* Target shift before the ones of Q and R(1:)   */
+   int multiShiftSize=0;    /* Columns of V factorized in Q and R(1:)        */
 
    REAL *hVals;             /* Eigenvalues of H                              */
    REAL *hSVals=NULL;       /* Singular values of R                          */
    REAL *prevRitzVals;      /* Eigenvalues of H at previous outer iteration  */
                             /* by robust shifting algorithm in correction.c  */
+   REAL *precondShifts;     /* Shifts of the last call to precondShiftUpdate */
    REAL *basisNorms;        /* Residual norms of basis at pairs              */
    REAL *blockNorms;        /* Residual norms corresponding to current block */
                             /* vectors.                                      */
    double smallestResNorm;  /* the smallest residual norm in the block       */
    int reset=0;             /* Flag to reset V and W                         */
    int restartsSinceReset=0;/* Restart since last reset of V and W           */
+   REAL *restartsW=NULL;    /* Weighted restarts since each column of W was  */
+                            /* computed                                      */
+   int halfReset=0;         /* If V and W are reset to stop using            */
+                            /* matrixMatvecHalf in this restart              */
+   int partialReset=0;      /* If only the block columns of W were reset in  */
+                            /* the last restart                              */
    int wholeSpace=0;        /* search subspace reach max size                */
+   int saveModel=0;         /* Flag to write CostModel in dynamicModel       */
 
    /* Runtime measurement variables for dynamic method switching             */
    primme_CostModel CostModel; /* Structure holding the runtime estimates of */
@@ -216,7 +242,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    /* --------------------------------------------------------------------- */
    /* Observed orthogonality issues finding the largest/smallest values in  */
    /* single precision. Computing V'*B*V and solving the projected problem  */
-   /* V'AVx = V'BVxl mitigates the problem.                                 */
+   /* V'AVx = V'BVxl mitigates the problem. It is also done in generalized  */
+   /* problems, where V is B-orthonormal and V'*B*V is computed with BV,    */
+   /* unless B*V is not kept.                                               */
    /* --------------------------------------------------------------------- */
 
    enum {
@@ -224,6 +252,11 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
       primme_orth_explicit_I           /* explicitly compute V'*B*V */
    } orth;
 
+   if (primme->massMatrixMatvec && primme->massMatrixCache) {
+     orth = primme_orth_explicit_I;
+   } else if (primme->massMatrixMatvec) {
+     orth = primme_orth_implicit_I;
+   } else
 #ifdef USE_FLOAT
    if (primme->projectionParams.projection == primme_proj_RR &&
        (primme->target == primme_largest || primme->target == primme_smallest ||
@@ -239,7 +272,18 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
    maxEvecsSize = primme->numOrthoConst + primme->numEvals;
    if (primme->projectionParams.projection != primme_proj_RR) {
-      numQR = 1;
+      /* With multiShiftBlock, keep also the QR factorizations for the    */
+      /* next target shifts                                               */
+      if (primme->multiShiftBlock && primme->numTargetShifts > 1
+            && !primme->massMatrixMatvec
+            && (primme->target == primme_closest_abs
+               || primme->target == primme_closest_leq
+               || primme->target == primme_closest_geq)) {
+         numQR = min(primme->maxBlockSize, primme->numTargetShifts);
+      }
+      else {
+         numQR = 1;
+      }
    }
    else {
       numQR = 0;
@@ -251,13 +295,16 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    rwork         = (SCALAR *) realWork;
    V             = rwork; rwork += primme->ldOPs*primme->maxBasisSize;
    W             = rwork; rwork += primme->ldOPs*primme->maxBasisSize;
+   if (primme->massMatrixMatvec && primme->massMatrixCache) {
+      BV         = rwork; rwork += primme->ldOPs*primme->maxBasisSize;
+   }
    if (numQR > 0) {
       Q          = rwork; rwork += primme->ldOPs*primme->maxBasisSize*numQR;
       R          = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize*numQR;
-      hU         = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize*numQR;
+      hU         = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
    }
    if (primme->projectionParams.projection == primme_proj_harmonic) {
-      QtV        = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize*numQR;
+      QtV        = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
    }
    H             = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
    hVecs         = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
@@ -265,9 +312,18 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    if (orth == primme_orth_explicit_I) {
       VtBV       = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
    }
+   else if (primme->orth == primme_orth_lowsync
+         || primme->orth == primme_orth_selective) {
+      VtV        = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
+   }
    if (primme->projectionParams.projection == primme_proj_refined
        || primme->projectionParams.projection == primme_proj_harmonic) {
-      hVecsRot   = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize*numQR;
+      hVecsRot   = rwork; rwork += primme->maxBasisSize*primme->maxBasisSize;
+   }
+   if (numQR > 0 && primme->numProcs > 1 && primme->globalSumRealStart
+         && primme->globalSumRealWait) {
+      sumBufSize = 2*primme->maxBasisSize*primme->maxBlockSize;
+      sumBuf     = rwork; rwork += sumBufSize;
    }
 
    if (primme->correctionParams.precondition && 
@@ -291,12 +347,39 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    }
    prevRitzVals  = (REAL *)rwork; rwork += TO_REAL(primme->maxBasisSize+primme->numEvals);
    blockNorms    = (REAL *)rwork; rwork += TO_REAL(primme->maxBlockSize);
+   precondShifts = (REAL *)rwork; rwork += TO_REAL(primme->maxBlockSize);
    basisNorms    = (REAL *)rwork; rwork += TO_REAL(primme->maxBasisSize);
+   if (!Q && !VtBV && !primme->massMatrixMatvec && !primme->locking) {
+      restartsW  = (REAL *)rwork; rwork += TO_REAL(primme->maxBasisSize);
+   }
    #undef TO_REAL
 
    assert(primme->realWorkSize/sizeof(SCALAR) >= (size_t)(rwork - (SCALAR*)realWork));
    rworkSize     = primme->realWorkSize/sizeof(SCALAR) - (rwork - (SCALAR*)realWork);
 
+   /* Let the threads that update the rows of the large dimension arrays */
+   /* touch them first, so their pages are placed close to those threads  */
+
+   if (primme->firstTouch) {
+      i = primme->warmStart ? max(0, min(primme->warmBasisSize,
+               primme->maxBasisSize)) : 0;
+      Num_first_touch_matrix_Sprimme(&V[ldV*i], primme->nLocal,
+            primme->maxBasisSize-i, ldV);
+      Num_first_touch_matrix_Sprimme(W, primme->nLocal, primme->maxBasisSize,
+            ldW);
+      if (BV) Num_first_touch_matrix_Sprimme(BV, primme->nLocal,
+            primme->maxBasisSize, ldV);
+      if (Q) Num_first_touch_matrix_Sprimme(Q, primme->nLocal,
+            primme->maxBasisSize*numQR, ldQ);
+      if (evecsHat) Num_first_touch_matrix_Sprimme(evecsHat, primme->nLocal,
+            maxEvecsSize, ldevecsHat);
+      i = primme->numOrthoConst + primme->initSize;
+      if (i < maxEvecsSize) {
+         Num_first_touch_matrix_Sprimme(&evecs[ldevecs*i],
+               primme->nLocal, maxEvecsSize-i, ldevecs);
+      }
+   }
+
    /* Integer workspace */
 
    iwork = intWork; iworkSize = (int)(primme->intWorkSize/sizeof(int));
@@ -328,6 +411,17 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    primme->stats.estimateLargestSVal           = -HUGE_VAL;
    primme->stats.maxConvTol                    = 0.0;
    primme->stats.estimateResidualError         = 0.0;
+   primme->stats.numGlobalSumMerged            = 0;
+   primme->stats.timeSolveH                  = 0.0;
+   primme->stats.timeRestart                 = 0.0;
+   primme->stats.timeUpdateVWXR              = 0.0;
+   primme->stats.timeConvCheck               = 0.0;
+   primme->stats.timeInnerSolve              = 0.0;
+   primme->stats.orthoLossFactor             = 0.0;
+   primme->stats.timeGlobalSumInterNode      = 0.0;
+   primme->stats.estimateRemainingMatvecs    = -1.0;
+   primme->stats.estimateRemainingTime       = -1.0;
+   /* stats.timeWorkspace is set by Sprimme before calling main_iter */
 
    numLocked = 0;
    converged = FALSE;
@@ -357,6 +451,12 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             W, ldW, 0, 1, primme), -1);
       evals[0] = REAL_PART(W[0]);
       V[0] = 1.0;
+      if (primme->massMatrixMatvec) {
+         CHKERR(massMatrixMatvec_Sprimme(&evecs[0], primme->nLocal, ldevecs,
+                  W, ldW, 0, 1, primme), -1);
+         evals[0] /= REAL_PART(W[0]);
+         evecs[0] = V[0] = 1.0/sqrt(REAL_PART(W[0]));
+      }
 
       resNorms[0] = 0.0L;
       primme->stats.numMatvecs++;
@@ -377,10 +477,17 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    /* Initialize the basis */
    /* -------------------- */
 
-   CHKERR(init_basis_Sprimme(V, primme->nLocal, ldV, W, ldW, evecs, ldevecs,
+   CHKERR(init_basis_Sprimme(V, primme->nLocal, ldV, W, ldW, BV, ldV, evecs,
+            ldevecs,
             evecsHat, primme->nLocal, M, maxEvecsSize, UDU, 0, ipivot, machEps,
             rwork, &rworkSize, &basisSize, &nextGuess, &numGuesses, primme),
          -1);
+   if (restartsW) for (i=0; i<primme->maxBasisSize; i++) restartsW[i] = 0.0;
+
+   /* With primme_orth_selective, V is kept semi-orthogonal, but the residual */
+   /* norms cannot go below |A| times the loss of orthogonality of V          */
+
+   orthoTol = max(1e2*machEps, min(sqrt(machEps), 1e-1*primme->eps));
 
    /* Now initSize will store the number of converged pairs */
    primme->initSize = 0;
@@ -397,8 +504,41 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
       else
          primme->dynamicMethodSwitch = 3;   /* Start GD+k for 1st pair */
       primme->correctionParams.maxInnerIterations = 0; 
+      saveModel = primme->dynamicModel ? 1 : 0;
+
+      /* If the model of a previous run is given, start with the method */
+      /* it expects to be faster                                        */
+      if (primme->dynamicModel && primme->dynamicModel[0] > 0.0) {
+         REAL ratio, globalRatio;
+         load_model(&CostModel, primme->dynamicModel);
+         ratio = ratio_JDQMR_GDpk(&CostModel, 0, CostModel.JDQMR_slowdown,
+               CostModel.ratio_MV_outer);
+         if (primme->numProcs > 1) {
+            CHKERR(globalSum_Rprimme(&ratio, &globalRatio, 1, primme), -1);
+            ratio = globalRatio/primme->numProcs;
+         }
+         if (ratio < 0.95) {
+            primme->dynamicMethodSwitch++;  /* Start with JDQMR: 1->2, 3->4 */
+            primme->correctionParams.maxInnerIterations = -1;
+         }
+         if (primme->printLevel >= 3 && primme->procID == 0) 
+            fprintf(primme->outputFile, "Ratio: %e Start with %s\n", ratio,
+                  ratio < 0.95 ? "JDQMR" : "GD+k");
+      }
+   }
+
+   /* --------------------------------------------------------------- */
+   /* Dynamic block size means that the block size is chosen between */
+   /* 1 and maxBlockSize based on runtime timing measurements        */
+   /* --------------------------------------------------------------- */
+   if (primme->dynamicBlockSize) {
+      initializeBlockModel(&CostModel, primme);
    }
 
+   /* Start the estimation of the remaining work */
+
+   initializeRemainingModel(&CostModel);
+
    /* ---------------------------------------------------------------------- */
    /* Outer most loop                                                        */
    /* Without locking, restarting can cause converged Ritz values to become  */
@@ -418,21 +558,28 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
       /* Compute the initial H and solve for its eigenpairs */
 
       targetShiftIndex = 0;
+      multiShiftSize = 0;
       if (Q) CHKERR(update_Q_Sprimme(V, primme->nLocal, ldV, W, ldW, Q, ldQ, R,
                primme->maxBasisSize, primme->targetShifts[targetShiftIndex], 0,
                basisSize, rwork, &rworkSize, machEps, primme), -1);
 
+      /* Reduce H, QtV and VtBV together */
+
+      GLOBALSUM_QUEUE_INIT(queue);
+
       if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
                primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
-               &rworkSize, 1/*symmetric*/, primme), -1);
+               &rworkSize, 1/*symmetric*/, &queue, primme), -1);
 
       if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
                primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
-               &rworkSize, 0/*unsymmetric*/, primme), -1);
+               &rworkSize, 0/*unsymmetric*/, &queue, primme), -1);
 
-      if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, V, ldV, VtBV,
-               primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
-               &rworkSize, 1/*symmetric*/, primme), -1);
+      if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, BV ? BV : V, ldV,
+               VtBV, primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
+               &rworkSize, 1/*symmetric*/, &queue, primme), -1);
+
+      CHKERR(globalSum_flush_Sprimme(&queue, rwork, rworkSize, primme), -1);
 
       CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, VtBV,
                primme->maxBasisSize, R,
@@ -476,7 +623,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                maxRecentlyConverged = numConverged-numLocked+1;
             }
             else {
-               availableBlockSize = primme->maxBlockSize;
+               availableBlockSize = primme->dynamicBlockSize ?
+                  CostModel.blockSize : primme->maxBlockSize;
                maxRecentlyConverged = max(0, primme->numEvals-numConverged);
             }
 
@@ -495,7 +643,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             /* Set the block with the first unconverged pairs */
             if (availableBlockSize > 0) {
-               prepare_candidates_Sprimme(V, ldV, W, ldW, primme->nLocal, H,
+               prepare_candidates_Sprimme(V, ldV, W, ldW, BV, primme->nLocal, H,
                   primme->maxBasisSize, basisSize,
                   &V[basisSize*ldV], &W[basisSize*ldW],
                   hVecs, basisSize, hVals, hSVals, flags,
@@ -504,7 +652,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                   resNorms, targetShiftIndex, machEps, iev, &blockSize,
                   &recentlyConverged, &numArbitraryVecs, &smallestResNorm,
                   hVecsRot, primme->maxBasisSize, numConverged, basisNorms,
-                  &reset, rwork, &rworkSize, iwork, iworkSize, primme);
+                  restartsW, &reset, rwork, &rworkSize, iwork, iworkSize,
+                  primme);
                assert(recentlyConverged >= 0);
             }
             else {
@@ -515,7 +664,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             /* recentlyConverged ones, are greater than or equal to the  */
             /* target number of eigenvalues, attempt to restart, verify  */
             /* their convergence, lock them if necessary, and return.    */
-            /* For locking interior, restart and lock now any converged. */
+            /* For locking interior, restart and lock now any converged, */
+            /* or wait until lockingBatchSize pairs are converged.       */
             /* If Q, restart after an eigenpair converged to recompute   */
             /* QR with a different shift.                                */
             /* Also if it has been converged as many pairs as initial    */
@@ -524,11 +674,18 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             numConverged += recentlyConverged;
 
+            /* Update the estimation of the remaining work */
+
+            update_remaining(&CostModel, primme, recentlyConverged,
+                  numConverged, blockSize, blockSize > 0 ? blockNorms[0] : 0.0,
+                  primme->stats.estimateLargestSVal);
+
             /* Report iteration */
 
-            if (primme->monitorFun) {
+            if (monitor_filter_Sprimme(primme_event_outer_iteration, primme)) {
                primme_event EVENT_OUTER_ITERATION = primme_event_outer_iteration;
-               primme->stats.elapsedTime = primme_wTimer(0);
+               primme->stats.elapsedTime =
+                  primme_get_wtime() - primme->startTime;
                int err;
                CHKERRM((primme->monitorFun(hVals, &basisSize, flags, iev,
                            &blockSize, basisNorms, &numConverged, evals,
@@ -568,6 +725,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             if (numConverged >= primme->numEvals ||
                 (primme->locking && recentlyConverged > 0
+                  && numConverged - numLocked >= primme->lockingBatchSize
                   && primme->target != primme_smallest
                   && primme->target != primme_largest
                   && primme->projectionParams.projection == primme_proj_RR) ||
@@ -593,6 +751,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             /* We zero out the V(AvailableBlockSize), avoid any correction   */
             /* and let ortho create the random vectors.                      */
 
+            numSteps = 1;
+            numAux = 0;
+            selectiveOrtho = 0;
             if (blockSize == 0) {
                blockSize = availableBlockSize;
                Num_scal_Sprimme(blockSize*primme->nLocal, 0.0,
@@ -605,59 +766,226 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
                /* If dynamic method switching, time the inner method     */
                if (primme->dynamicMethodSwitch > 0) {
-                  tstart = primme_wTimer(0); /* accumulate correction time */
+                  tstart = primme_get_wtime(); /* accumulate correction time */
 
                }
 
-               CHKERR(solve_correction_Sprimme(V, ldV, W, ldW, evecs, ldevecs,
-                        evecsHat, ldevecsHat, UDU, ipivot, evals, numLocked,
-                        numConvergedStored, hVals, prevRitzVals,
-                        &numPrevRitzVals, flags, basisSize, blockNorms, iev,
-                        blockSize, &touch, machEps, rwork, &rworkSize, iwork, iworkSize,
-                        primme), -1);
+               /* Replace the Ritz vectors by a Chebyshev polynomial on A */
+               /* applied to them, which damps the unwanted part of the   */
+               /* spectrum. Otherwise solve the correction equations.     */
+
+               CHKERR(chebyshev_filter_Sprimme(V, primme->nLocal, ldV, W, ldW,
+                        basisSize, blockSize, hVals, iev,
+                        primme->numEvals - numLocked, &filterDegree, rwork,
+                        &rworkSize, primme), -1);
+
+               if (filterDegree == 0) {
+                  CHKERR(solve_correction_Sprimme(V, ldV, W, ldW, evecs,
+                           ldevecs, evecsHat, ldevecsHat, UDU, ipivot, evals,
+                           numLocked, numConvergedStored, hVals, prevRitzVals,
+                           &numPrevRitzVals, &numPrevLocked, precondShifts,
+                           &numPrecondShifts, flags, basisSize,
+                           blockNorms, iev, blockSize, &touch, machEps, rwork,
+                           &rworkSize, iwork, iworkSize, primme), -1);
+               }
 
                /* ------------------------------------------------------ */
                /* If dynamic method switch, accumulate inner method time */
                /* ------------------------------------------------------ */
                if (primme->dynamicMethodSwitch > 0) 
-                  CostModel.time_in_inner += primme_wTimer(0) - tstart;
+                  CostModel.time_in_inner += primme_get_wtime() - tstart;
+
+               /* With s-step expansion, add numSteps blocks generated from */
+               /* the corrections. It is not used if the basis should be    */
+               /* orthogonal to constraints, whose products with A are not  */
+               /* available, or B-orthonormal.                              */
+
+               if (primme->sStepSize > 1 && !VtBV &&
+                     primme->numOrthoConst == 0) {
+                  numSteps = min(primme->sStepSize,
+                        (primme->maxBasisSize - basisSize)/blockSize);
+                  numSteps = (int)min(numSteps,
+                        (primme->n - basisSize - numLocked - 1)/blockSize);
+                  numSteps = (int)min(numSteps, (primme->maxMatvecs
+                           - primme->stats.numMatvecs)/blockSize);
+               }
 
+               /* With multiShiftBlock, fill the block with a vector for each */
+               /* of the next target shifts, after updating their QR          */
+               /* factorizations with the new columns of V                    */
+
+               if (numQR > 1 && numSteps <= 1 && filterDegree == 0
+                     && targetShiftIndex >= 0) {
+                  numAux = min(numQR-1,
+                        primme->numTargetShifts-1-targetShiftIndex);
+                  numAux = min(numAux, primme->maxBlockSize-blockSize);
+                  numAux = min(numAux,
+                        primme->maxBasisSize-basisSize-blockSize);
+                  numAux = (int)min(numAux, primme->n - basisSize - blockSize
+                        - numLocked - primme->numOrthoConst);
+                  numAux = (int)min(numAux, primme->maxMatvecs
+                        - primme->stats.numMatvecs - blockSize);
+               }
+               if (numAux > 0) {
+                  if (multiShiftIndex != targetShiftIndex) {
+                     multiShiftIndex = targetShiftIndex;
+                     multiShiftSize = 0;
+                  }
+                  for (i=1; i<numQR
+                        && targetShiftIndex+i < primme->numTargetShifts; i++) {
+                     CHKERR(update_Q_Sprimme(V, primme->nLocal, ldV, W, ldW,
+                              &Q[ldQ*primme->maxBasisSize*i], ldQ,
+                              &R[primme->maxBasisSize*primme->maxBasisSize*i],
+                              primme->maxBasisSize,
+                              primme->targetShifts[targetShiftIndex+i],
+                              multiShiftSize, basisSize-multiShiftSize, rwork,
+                              &rworkSize, machEps, primme), -1);
+                  }
+                  multiShiftSize = basisSize;
+                  CHKERR(prepare_multishift_candidates_Sprimme(V, ldV, W,
+                           ldW, primme->nLocal, H, primme->maxBasisSize,
+                           basisSize,
+                           &R[primme->maxBasisSize*primme->maxBasisSize],
+                           primme->maxBasisSize, targetShiftIndex, numAux,
+                           &V[ldV*(basisSize+blockSize)],
+                           &W[ldW*(basisSize+blockSize)], rwork, &rworkSize,
+                           primme), -1);
+               }
+
+               /* With primme_orth_selective and the residuals as corrections, */
+               /* the part of the block along V comes from the error in V'*V  */
+               /* and the rounding in the residuals, amplified by |A|/|r|.    */
+               /* While the estimated loss stays under the one tolerated in   */
+               /* the basis, orthogonalize the block only against the locked  */
+               /* vectors and itself                                          */
+
+               if (primme->orth == primme_orth_selective && numSteps <= 1
+                     && numAux == 0 && filterDegree == 0 && !VtBV
+                     && primme->projectionParams.projection == primme_proj_RR
+                     && !primme->correctionParams.precondition
+                     && primme->correctionParams.maxInnerIterations == 0
+                     && !primme->correctionParams.projectors.RightX) {
+                  double loss = 0.0;
+                  for (i=0; i<blockSize; i++) {
+                     loss = max(loss, (orthoLoss + machEps)
+                           *max(primme->aNorm, primme->stats.estimateLargestSVal)
+                           /blockNorms[i]);
+                  }
+                  if (loss <= orthoTol) {
+                     selectiveOrtho = 1;
+                     orthoLoss = max(orthoLoss, loss);
+                  }
+               }
               
             } /* end of else blocksize=0 */
 
             /* Orthogonalize the corrections with respect to each other */
-            /* and the current basis.                                   */
-            CHKERR(ortho_Sprimme(V, ldV, NULL, 0, basisSize, 
-               basisSize+blockSize-1, evecs, ldevecs, 
-               primme->numOrthoConst+numLocked, primme->nLocal, primme->iseed, 
-               machEps, rwork, &rworkSize, primme), -1);
+            /* and the current basis, compute W = A*V for them and      */
+            /* extend H by blockSize columns and rows                   */
+
+            /* The reductions of H, QtV and VtBV are queued and done */
+            /* together before solve_H, unless H can be summed up    */
+            /* while Q and R are updated                             */
+
+            GLOBALSUM_QUEUE_INIT(queue);
+            if (numSteps > 1) {
+               CHKERR(ortho_Sprimme(V, ldV, NULL, 0, basisSize, 
+                  basisSize+blockSize-1, evecs, ldevecs, 
+                  primme->numOrthoConst+numLocked, primme->nLocal,
+                  primme->iseed, machEps, rwork, &rworkSize, primme), -1);
+               CHKERR(matrixMatvec_sstep_Sprimme(V, primme->nLocal, ldV, W,
+                        ldW, basisSize, blockSize, numSteps, hVals, iev,
+                        evecs, ldevecs, numLocked, evals, &numNewVecs, machEps,
+                        rwork, &rworkSize, primme), -1);
+               CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
+                        primme->maxBasisSize, primme->nLocal, basisSize,
+                        numNewVecs, rwork, &rworkSize, 1/*symmetric*/, &queue,
+                        primme), -1);
+            }
+            else if (selectiveOrtho) {
+               numNewVecs = blockSize;
+               CHKERR(ortho_Sprimme(&V[ldV*basisSize], ldV, NULL, 0, 0,
+                        blockSize-1, evecs, ldevecs,
+                        primme->numOrthoConst+numLocked, primme->nLocal,
+                        primme->iseed, machEps, rwork, &rworkSize, primme), -1);
+               CHKERR(matrixMatvec_project_Sprimme(V, primme->nLocal, ldV, W,
+                        ldW, H, primme->maxBasisSize, basisSize, blockSize,
+                        rwork, &rworkSize, &queue, primme), -1);
+            }
+            else {
+               numNewVecs = blockSize + numAux;
+               CHKERR(ortho_matrixMatvec_project_Sprimme(V, primme->nLocal,
+                        ldV, W, ldW, BV, ldV, H, primme->maxBasisSize,
+                        basisSize, numNewVecs, evecs, ldevecs,
+                        primme->numOrthoConst+numLocked, machEps, rwork,
+                        &rworkSize, &queue, primme), -1);
+            }
+
+            /* With primme_orth_lowsync and primme_orth_selective, V'*V is */
+            /* computed before one of every ORTHO_CHECK_PERIOD restarts    */
+            /* and reduced along with H                                    */
+
+            int checkOrtho = VtV
+                  && basisSize+numNewVecs >= primme->maxBasisSize
+                  && (restartsSinceReset+1) % ORTHO_CHECK_PERIOD == 0;
+            if (checkOrtho) {
+               Num_gemm_Sprimme("C", "N", basisSize+numNewVecs,
+                     basisSize+numNewVecs, primme->nLocal, 1.0, V, ldV, V,
+                     ldV, 0.0, VtV, primme->maxBasisSize);
+               CHKERR(globalSum_queue_Sprimme(VtV, basisSize+numNewVecs,
+                        basisSize+numNewVecs, primme->maxBasisSize, -1, 1,
+                        &queue, rwork, rworkSize, primme), -1);
+            }
 
-            /* Compute W = A*V for the orthogonalized corrections */
+            /* If possible, sum up H while Q and R are updated */
 
-            CHKERR(matrixMatvec_Sprimme(V, primme->nLocal, ldV, W, ldW,
-                     basisSize, blockSize, primme), -1);
+            if (Q) CHKERR(globalSum_flush_start_Sprimme(&queue, sumBuf,
+                     sumBufSize, primme), -1);
 
             if (Q) CHKERR(update_Q_Sprimme(V, primme->nLocal, ldV, W, ldW, Q,
                      ldQ, R, primme->maxBasisSize,
                      primme->targetShifts[targetShiftIndex], basisSize,
-                     blockSize, rwork, &rworkSize, machEps, primme), -1);
+                     numNewVecs, rwork, &rworkSize, machEps, primme), -1);
 
-            /* Extend H by blockSize columns and rows and solve the */
-            /* eigenproblem for the new H.                          */
-
-            if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
-                     primme->maxBasisSize, primme->nLocal, basisSize, blockSize,
-                     rwork, &rworkSize, 1/*symmetric*/, primme), -1);
+            CHKERR(globalSum_flush_wait_Sprimme(&queue, primme), -1);
 
             if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
-                     primme->maxBasisSize, primme->nLocal, basisSize, blockSize,
-                     rwork, &rworkSize, 0/*unsymmetric*/, primme), -1);
-
-            if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, V, ldV, VtBV,
-                     primme->maxBasisSize, primme->nLocal, basisSize, blockSize,
-                     rwork, &rworkSize, 1/*symmetric*/, primme), -1);
+                     primme->maxBasisSize, primme->nLocal, basisSize, numNewVecs,
+                     rwork, &rworkSize, 0/*unsymmetric*/, &queue, primme), -1);
+
+            if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, BV ? BV : V,
+                     ldV, VtBV, primme->maxBasisSize, primme->nLocal,
+                     basisSize, numNewVecs,
+                     rwork, &rworkSize, 1/*symmetric*/, &queue, primme), -1);
+
+            CHKERR(globalSum_flush_Sprimme(&queue, rwork, rworkSize, primme),
+                  -1);
+
+            /* Reset V and W in the coming restart if V lost orthogonality */
+
+            if (checkOrtho) {
+               int m = basisSize+numNewVecs, j;
+               REAL orthoErr = 0.0;
+               for (i=0; i < m; i++) {
+                  for (j=0; j < m; j++) {
+                     orthoErr = max(orthoErr, ABS(VtV[primme->maxBasisSize*i+j]
+                              - (i == j ? 1.0 : 0.0)));
+                  }
+               }
+               if (orthoErr > (primme->orth == primme_orth_selective ?
+                        orthoTol :
+                        max(1e2*machEps, min(primme->eps, 1e3*machEps)))) {
+                  reset = 2;
+                  if (primme->printLevel >= 5 && primme->procID == 0) {
+                     fprintf(primme->outputFile, 
+                           "Resetting V and W: |V'*V-I| = %g\n",
+                           (double)orthoErr);
+                     fflush(primme->outputFile);
+                  }
+               }
+            }
 
-            if (basisSize+blockSize >= primme->maxBasisSize) {
+            if (basisSize+numNewVecs >= primme->maxBasisSize) {
                CHKERR(retain_previous_coefficients_Sprimme(hVecs,
                         basisSize, hU, basisSize, previousHVecs,
                         primme->maxBasisSize, primme->maxBasisSize, basisSize,
@@ -666,14 +994,26 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             }
 
 
-            basisSize += blockSize;
+            basisSize += numNewVecs;
             blockSize = 0;
 
-            CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, VtBV,
-                     primme->maxBasisSize, R,
-                     primme->maxBasisSize, QtV, primme->maxBasisSize, hU,
-                     basisSize, hVecs, basisSize, hVals, hSVals, numConverged,
-                     machEps, &rworkSize, rwork, iworkSize, iwork, primme), -1);
+            /* hVecs and hVals are still the decomposition of the previous */
+            /* H, so they can be updated for the appended vectors          */
+
+            if (primme->incrementalRR && !VtBV
+                  && primme->projectionParams.projection == primme_proj_RR) {
+               CHKERR(solve_H_append_Sprimme(H, basisSize,
+                        primme->maxBasisSize, basisSize-numNewVecs, hVecs,
+                        basisSize, hVals, numConverged, &rworkSize, rwork,
+                        iworkSize, iwork, primme), -1);
+            }
+            else {
+               CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize,
+                        VtBV, primme->maxBasisSize, R, primme->maxBasisSize,
+                        QtV, primme->maxBasisSize, hU, basisSize, hVecs,
+                        basisSize, hVals, hSVals, numConverged, machEps,
+                        &rworkSize, rwork, iworkSize, iwork, primme), -1);
+            }
 
             numArbitraryVecs = 0;
 
@@ -755,7 +1095,9 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
                /* Limit blockSize to vacant vectors in the basis */
 
-               availableBlockSize = max(0, min(primme->maxBlockSize, primme->maxBasisSize-(numConverged-numLocked)));
+               availableBlockSize = max(0, min(primme->dynamicBlockSize ?
+                        CostModel.blockSize : primme->maxBlockSize,
+                     primme->maxBasisSize-(numConverged-numLocked)));
 
                /* Limit blockSize to remaining values to converge plus one */
 
@@ -783,7 +1125,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                dummySmallestResNorm = &smallestResNorm;
             }
 
-            prepare_candidates_Sprimme(V, ldV, W, ldW, primme->nLocal, H,
+            prepare_candidates_Sprimme(V, ldV, W, ldW, BV, primme->nLocal, H,
                   primme->maxBasisSize, basisSize,
                   NULL, NULL,
                   hVecs, basisSize, hVals, hSVals, flags,
@@ -792,7 +1134,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                   resNorms, targetShiftIndex, machEps, iev, &blockSize,
                   &recentlyConverged, &numArbitraryVecs, dummySmallestResNorm,
                   hVecsRot, primme->maxBasisSize, numConverged, basisNorms,
-                  &reset, rwork, &rworkSize, iwork, iworkSize, primme);
+                  restartsW, &reset, rwork, &rworkSize, iwork, iworkSize,
+                  primme);
             assert(recentlyConverged >= 0);
 
             /* When QR is computed and there are more than one target shift   */
@@ -856,10 +1199,31 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
          /* Restart the basis  */
          /* ------------------ */
 
+         /* If some residual norm reached the error in W, recompute only the */
+         /* columns of W of the next block. Reset V and W if that is asked   */
+         /* again right after.                                               */
+
+         /* If it reached the error of matrixMatvecHalf instead, go back to */
+         /* matrixMatvec and reset V and W with it                          */
+
+         halfReset = (reset > 0 && primme->matvecHalfActive);
+         if (halfReset) {
+            primme->matvecHalfActive = 0;
+            reset = 2;
+            if (primme->printLevel >= 3 && primme->procID == 0) {
+               fprintf(primme->outputFile,
+                     "Switching from matrixMatvecHalf to matrixMatvec\n");
+               fflush(primme->outputFile);
+            }
+         }
+         if (reset == 1 && restartsW && !partialReset) reset = -1;
+         partialReset = (reset < 0);
+         if (reset > 1) orthoLoss = 0.0;
+
          int oldNumLocked = numLocked;
          assert(ldV == ldW); /* this function assumes ldV == ldW */
-         restart_Sprimme(V, W, primme->nLocal, basisSize, ldV, hVals, hSVals,
-               flags, iev, &blockSize, blockNorms, evecs, ldevecs, perm,
+         restart_Sprimme(V, W, BV, primme->nLocal, basisSize, ldV, hVals,
+               hSVals, flags, iev, &blockSize, blockNorms, evecs, ldevecs, perm,
                evals, resNorms, evecsHat, primme->nLocal, M, maxEvecsSize, UDU,
                0, ipivot, &numConverged, &numLocked, lockedFlags,
                &numConvergedStored, previousHVecs, &numPrevRetained,
@@ -868,8 +1232,52 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
                primme->maxBasisSize,
                QtV, primme->maxBasisSize, hU, basisSize, 0, hVecs, basisSize, 0,
                &basisSize, &targetShiftIndex, &numArbitraryVecs, hVecsRot,
-               primme->maxBasisSize, &restartsSinceReset, &reset, machEps,
-               rwork, &rworkSize, iwork, iworkSize, primme);
+               primme->maxBasisSize, &restartsSinceReset, restartsW, &reset,
+               &freshResNorms, machEps, rwork, &rworkSize, iwork, iworkSize,
+               primme);
+         multiShiftSize = 0;
+
+         /* The restarted H, Q, QtV and VtBV kept the error of             */
+         /* matrixMatvecHalf; compute them again from the new W. Also      */
+         /* forget the pairs flagged converged with that error.            */
+
+         if (halfReset) {
+            freshResNorms = 0;
+            for (i=0; i<basisSize; i++) flags[i] = UNCONVERGED;
+            numConverged = numLocked;
+            primme->stats.maxConvTol = 0.0;
+
+            if (Q) CHKERR(update_Q_Sprimme(V, primme->nLocal, ldV, W, ldW, Q,
+                     ldQ, R, primme->maxBasisSize,
+                     primme->targetShifts[targetShiftIndex], 0, basisSize,
+                     rwork, &rworkSize, machEps, primme), -1);
+
+            GLOBALSUM_QUEUE_INIT(queue);
+
+            if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
+                     primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
+                     &rworkSize, 1/*symmetric*/, &queue, primme), -1);
+
+            if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
+                     primme->maxBasisSize, primme->nLocal, 0, basisSize, rwork,
+                     &rworkSize, 0/*unsymmetric*/, &queue, primme), -1);
+
+            if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, BV ? BV : V,
+                     ldV, VtBV, primme->maxBasisSize, primme->nLocal, 0,
+                     basisSize, rwork, &rworkSize, 1/*symmetric*/, &queue,
+                     primme), -1);
+
+            CHKERR(globalSum_flush_Sprimme(&queue, rwork, rworkSize, primme),
+                  -1);
+
+            CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, VtBV,
+                  primme->maxBasisSize, R,
+                  primme->maxBasisSize, QtV, primme->maxBasisSize, hU,
+                  basisSize, hVecs, basisSize, hVals, hSVals, numConverged,
+                  machEps, &rworkSize, rwork, iworkSize, iwork, primme), -1);
+            numArbitraryVecs = blockSize = 0;
+            smallestResNorm = HUGE_VAL;
+         }
 
          /* If there are any initial guesses remaining, then copy it */
          /* into the basis.                                          */
@@ -898,34 +1306,38 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             nextGuess += numNew;
             numGuesses -= numNew;
+            freshResNorms = 0;
 
-            CHKERR(ortho_Sprimme(V, ldV, NULL, 0, basisSize, basisSize+numNew-1,
-                     evecs, ldevecs, numLocked+primme->numOrthoConst,
-                     primme->nLocal, primme->iseed, machEps, rwork, &rworkSize,
-                     primme), -1);
+            /* Orthogonalize the guesses, compute W = A*V for them and */
+            /* extend H by numNew columns and rows                     */
 
-            /* Compute W = A*V for the orthogonalized corrections */
+            GLOBALSUM_QUEUE_INIT(queue);
+            CHKERR(ortho_matrixMatvec_project_Sprimme(V, primme->nLocal, ldV,
+                     W, ldW, BV, ldV, H, primme->maxBasisSize, basisSize,
+                     numNew, evecs, ldevecs, numLocked+primme->numOrthoConst,
+                     machEps, rwork, &rworkSize, &queue, primme), -1);
 
-            CHKERR(matrixMatvec_Sprimme(V, primme->nLocal, ldV, W, ldW,
-                     basisSize, numNew, primme), -1);
+            if (Q) CHKERR(globalSum_flush_start_Sprimme(&queue, sumBuf,
+                     sumBufSize, primme), -1);
 
             if (Q) CHKERR(update_Q_Sprimme(V, primme->nLocal, ldV, W, ldW, Q,
                      ldQ, R, primme->maxBasisSize,
                      primme->targetShifts[targetShiftIndex], basisSize, numNew,
                      rwork, &rworkSize, machEps, primme), -1);
 
-            /* Extend H by numNew columns and rows and solve the */
-            /* eigenproblem for the new H.                       */
+            CHKERR(globalSum_flush_wait_Sprimme(&queue, primme), -1);
+
+            /* Extend QtV and VtBV and solve the eigenproblem for the new H */
 
-            if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H,
-                     primme->maxBasisSize, primme->nLocal, basisSize, numNew,
-                     rwork, &rworkSize, 1/*symmetric*/, primme), -1);
             if (QtV) CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV,
                      primme->maxBasisSize, primme->nLocal, basisSize, numNew,
-                     rwork, &rworkSize, 0/*unsymmetric*/, primme), -1);
-            if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, V, ldV, VtBV,
-                     primme->maxBasisSize, primme->nLocal, basisSize, numNew,
-                     rwork, &rworkSize, 1/*symmetric*/, primme), -1);
+                     rwork, &rworkSize, 0/*unsymmetric*/, &queue, primme), -1);
+            if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, BV ? BV : V,
+                     ldV, VtBV, primme->maxBasisSize, primme->nLocal,
+                     basisSize, numNew,
+                     rwork, &rworkSize, 1/*symmetric*/, &queue, primme), -1);
+            CHKERR(globalSum_flush_Sprimme(&queue, rwork, rworkSize, primme),
+                  -1);
             basisSize += numNew;
             CHKERR(solve_H_Sprimme(H, basisSize, primme->maxBasisSize, VtBV,
                   primme->maxBasisSize, R,
@@ -939,13 +1351,27 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
          primme->initSize = numConverged;
 
+         /* Store the basis every checkpointInterval restarts */
+
+         if (primme->checkpointFun
+               && primme->stats.numRestarts % primme->checkpointInterval == 0) {
+            CHKERR(checkpoint_Sprimme(V, ldV, W, ldW, &basisSize, 0, primme),
+                  -1);
+         }
+
+         /* Update the time per matvec of the current block size and */
+         /* choose the block size until the next restart             */
+         if (primme->dynamicBlockSize) {
+            update_block_size(&CostModel, primme);
+         }
+
          /* ------------------------------------------------------------- */
          /* If dynamic method switching == 1, update model parameters and */
          /* evaluate whether to switch from GD+k to JDQMR. This is after  */
          /* restart. GD+k is also evaluated if a pair converges.          */
          /* ------------------------------------------------------------- */
          if (primme->dynamicMethodSwitch == 1 ) {
-            tstart = primme_wTimer(0);
+            tstart = primme_get_wtime();
             CostModel.MV = primme->stats.timeMatvec/primme->stats.numMatvecs;
             ret = update_statistics(&CostModel, primme, tstart, 0, 1,
                numConverged, blockNorms[0], primme->stats.estimateMaxEVal); 
@@ -980,9 +1406,14 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
       /* converged by calling verify_norms.                           */
       /* ------------------------------------------------------------ */
 
+      /* Keep the size of the basis left in V for the next call */
+
+      if (primme->warmStart) primme->warmBasisSize = basisSize;
+
       if (primme->locking) {
 
          /* if dynamic method, give method recommendation for future runs */
+         if (saveModel) save_model(&CostModel, primme->dynamicModel);
          if (primme->dynamicMethodSwitch > 0 ) {
             if (CostModel.accum_jdq_gdk < 0.96) 
                primme->dynamicMethodSwitch = -2;  /* Use JDQMR_ETol */
@@ -1019,12 +1450,14 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
          /* some converged Ritz vectors to become slightly unconverged.*/
          /* If some have become unconverged, then further iterations   */
          /* must be performed to force these approximations back to a  */
-         /* converged state.                                           */
+         /* converged state. The last restart may have computed them   */
+         /* already together with V and W.                             */
          /* ---------------------------------------------------------- */
 
-         CHKERR(verify_norms(V, ldV, W, ldW, hVals, numConverged, resNorms,
-                  flags, &converged, machEps, rwork, &rworkSize, iwork,
-                  iworkSize, primme), -1);
+         CHKERR(verify_norms(V, ldV, W, ldW, BV, hVals, numConverged, resNorms,
+                  freshResNorms && numConverged <= primme->numEvals, flags,
+                  &converged, machEps, rwork, &rworkSize, iwork, iworkSize,
+                  primme), -1);
 
          /* ---------------------------------------------------------- */
          /* If the convergence limit is reached or the target vectors  */
@@ -1049,6 +1482,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             primme->initSize = numConverged;
 
             /* if dynamic method, give method recommendation for future runs */
+            if (saveModel) save_model(&CostModel, primme->dynamicModel);
             if (primme->dynamicMethodSwitch > 0 ) {
                if (CostModel.accum_jdq_gdk < 0.96) 
                   primme->dynamicMethodSwitch = -2;  /* Use JDQMR_ETol */
@@ -1072,10 +1506,17 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
             /* Reorthogonalize the basis, recompute W=AV, and continue the  */
             /* outer while loop, resolving the epairs. Slow, but robust!    */
             /* ------------------------------------------------------------ */
-            CHKERR(ortho_Sprimme(V, ldV, NULL, 0, 0,
-                     basisSize-1, evecs, ldevecs,
-                     primme->numOrthoConst+numLocked, primme->nLocal,
-                     primme->iseed, machEps, rwork, &rworkSize, primme), -1);
+            if (primme->massMatrixMatvec) {
+               CHKERR(ortho_B_Sprimme(V, ldV, BV, ldV, 0, basisSize-1,
+                        primme->nLocal, primme->iseed, machEps, rwork,
+                        &rworkSize, primme), -1);
+            }
+            else {
+               CHKERR(ortho_Sprimme(V, ldV, NULL, 0, 0,
+                        basisSize-1, evecs, ldevecs,
+                        primme->numOrthoConst+numLocked, primme->nLocal,
+                        primme->iseed, machEps, rwork, &rworkSize, primme), -1);
+            }
             CHKERR(matrixMatvec_Sprimme(V, primme->nLocal, ldV, W, ldW, 0,
                      basisSize, primme), -1);
 
@@ -1087,7 +1528,11 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
             restartsSinceReset = 0;
             reset = 0;
+            orthoLoss = 0.0;
             primme->stats.estimateResidualError = 0.0;
+            if (restartsW) {
+               for (i=0; i<primme->maxBasisSize; i++) restartsW[i] = 0.0;
+            }
 
            /* ------------------------------------------------------------ */
          } /* End of elseif(!converged). Restart and recompute all epairs
@@ -1101,6 +1546,7 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
    } /* while (!converged)  Outer verification loop
       * -------------------------------------------------------------- */
 
+   if (saveModel) save_model(&CostModel, primme->dynamicModel);
    if (primme->aNorm <= 0.0L) primme->aNorm = primme->stats.estimateLargestSVal;
 
    return 0;
@@ -1124,6 +1570,8 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
  * basisSize      Size of the basis V and W
  * ldV            The leading dimension of V and X
  * ldW            The leading dimension of W and R
+ * BV             B*V, if massMatrixMatvec is set (optional). Then the residual
+ *                vectors are computed as W*hVecs - BV*hVecs*diag(hVals)
  * hVecs          The projected vectors
  * ldhVecs        The leading dimension of hVecs
  * hVals          The Ritz values
@@ -1136,6 +1584,10 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
  * evecsSize      The size of evecs
  * numLocked      The number of vectors currently locked (if locking)
  * numConverged   Number of converged pairs (soft+hard locked)
+ * restartsW      Weighted number of restarts since each column of W was
+ *                computed (optional). If given, bound the error of the
+ *                residual norm of each pair instead of using
+ *                primme.stats.estimateResidualError
  * rwork          Real work array, used by check_convergence and Num_update_VWXR
  * primme         Structure containing various solver parameters
  *
@@ -1158,19 +1610,21 @@ int main_iter_Sprimme(REAL *evals, int *perm, SCALAR *evecs, PRIMME_INT ldevecs,
 
 TEMPLATE_PLEASE
 int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, SCALAR *H, int ldH, int basisSize,
+      PRIMME_INT ldW, SCALAR *BV, PRIMME_INT nLocal, SCALAR *H, int ldH,
+      int basisSize,
       SCALAR *X, SCALAR *R, SCALAR *hVecs, int ldhVecs, REAL *hVals,
       REAL *hSVals, int *flags, int remainedEvals, REAL *blockNorms,
       int blockNormsSize, int maxBlockSize, SCALAR *evecs, int numLocked,
       PRIMME_INT ldevecs, REAL *evals, REAL *resNorms, int targetShiftIndex,
       double machEps, int *iev, int *blockSize, int *recentlyConverged,
       int *numArbitraryVecs, double *smallestResNorm, SCALAR *hVecsRot,
-      int ldhVecsRot, int numConverged, REAL *basisNorms, int *reset,
-      SCALAR *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      int ldhVecsRot, int numConverged, REAL *basisNorms, REAL *restartsW,
+      int *reset, SCALAR *rwork, size_t *rworkSize, int *iwork, int iworkSize,
       primme_params *primme) {
 
-   int i, blki;         /* loop variables */
+   int i, j, blki;      /* loop variables */
    REAL *hValsBlock;    /* contiguous copy of the hVals to be tested */
+   REAL *resErrors;     /* error bounds of the residual norms to be tested */
    SCALAR *hVecsBlock;  /* contiguous copy of the hVecs columns to be tested */     
    int *flagsBlock;     /* contiguous copy of the flags to be tested */
    REAL *hValsBlock0;   /* workspace for hValsBlock */
@@ -1191,7 +1645,7 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
 
       CHKERR(check_convergence_Sprimme(NULL, nLocal, 0, NULL, 0, NULL,
                numLocked, 0, 0, basisSize, NULL, NULL,
-               NULL, NULL, 0.0, NULL, &lrw, &liw, 0, primme), -1);
+               NULL, NULL, NULL, 0.0, NULL, &lrw, &liw, 0, primme), -1);
       lrw = max(lrw,
             (size_t)Num_update_VWXR_Sprimme(NULL, NULL, nLocal, basisSize,
                0, NULL, 0, 0, NULL, &t, basisSize-maxBlockSize, basisSize, 0,
@@ -1201,21 +1655,27 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
                &t, basisSize-maxBlockSize, basisSize, 0, &d,
                NULL, 0, 0,
                NULL, 0, primme));
+      if (primme->massMatrixMatvec) {
+         CHKERR(residual_B_Sprimme(NULL, NULL, 0, nLocal, basisSize, NULL, 0,
+                  NULL, maxBlockSize, NULL, 0, NULL, 0, NULL, NULL, &lrw,
+                  primme), -1);
+      }
       CHKERR(prepare_vecs_Sprimme(basisSize, 0, maxBlockSize, NULL, 0,
                NULL, NULL, NULL, 0, 0, NULL, 0.0, NULL, 0, NULL, 0, 0.0, &lrw,
                NULL, 0, &liw, primme), -1);
       *rworkSize = max(*rworkSize,
-            (size_t)maxBlockSize+(size_t)maxBlockSize*(size_t)basisSize+lrw);
+            (size_t)maxBlockSize*2+(size_t)maxBlockSize*(size_t)basisSize+lrw);
       *iwork = max(*iwork, liw + basisSize);
       return 0;
    }
 
    *blockSize = 0;
    hValsBlock0 = (REAL*)rwork;
-   hVecsBlock0 = &rwork[maxBlockSize];
-   rwork += maxBlockSize + ldhVecs*maxBlockSize;
-   assert(*rworkSize >= (size_t)(maxBlockSize + ldhVecs*maxBlockSize));
-   rworkSize0 = *rworkSize - maxBlockSize - ldhVecs*maxBlockSize;
+   resErrors = restartsW ? (REAL*)&rwork[maxBlockSize] : NULL;
+   hVecsBlock0 = &rwork[maxBlockSize*2];
+   rwork += maxBlockSize*2 + ldhVecs*maxBlockSize;
+   assert(*rworkSize >= (size_t)(maxBlockSize*2 + ldhVecs*maxBlockSize));
+   rworkSize0 = *rworkSize - maxBlockSize*2 - ldhVecs*maxBlockSize;
    flagsBlock = iwork;
    iwork += maxBlockSize;
    iworkSize -= maxBlockSize;
@@ -1243,11 +1703,30 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       /* Recompute flags in iev(*blockSize:*blockSize+blockNormsize) */
       for (i=*blockSize; i<blockNormsSize; i++)
          flagsBlock[i-*blockSize] = flags[iev[i]];
+
+      /* The error in W*hVecs(:,i) is bounded by the errors of the columns */
+      /* of W weighted by |hVecs(:,i)|^2; see restart_soft_locking. V is   */
+      /* not reorthogonalized when only some columns of W are recomputed,  */
+      /* so don't trust the bound below estimateResidualError              */
+
+      if (resErrors) {
+         double aNorm = max(primme->stats.estimateLargestSVal, primme->aNorm);
+         for (i=0; i<blockNormsSize; i++) {
+            REAL e = 0.0;
+            for (j=0; j<basisSize; j++) {
+               REAL a = ABS(hVecs[ldhVecs*iev[*blockSize+i]+j]);
+               e += a*a*restartsW[j];
+            }
+            resErrors[i] = max(2*sqrt(e)*machEps*aNorm,
+                  primme->stats.estimateResidualError);
+         }
+      }
+
       CHKERR(check_convergence_Sprimme(X?&X[(*blockSize)*ldV]:NULL, nLocal,
             ldV, R?&R[(*blockSize)*ldW]:NULL, ldW, evecs, numLocked,
             ldevecs, 0, blockNormsSize, flagsBlock,
-            &blockNorms[*blockSize], hValsBlock, reset, machEps, rwork,
-            &rworkSize0, iwork, iworkSize, primme), -1);
+            &blockNorms[*blockSize], resErrors, hValsBlock, reset, machEps,
+            rwork, &rworkSize0, iwork, iworkSize, primme), -1);
 
       /* Compact blockNorms, X and R for the unconverged pairs in    */
       /* iev(*blockSize:*blockSize+blockNormsize). Do the proper     */
@@ -1293,7 +1772,7 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
             }
 
             /* Report a pair was soft converged */
-            if (primme->monitorFun) {
+            if (monitor_filter_Sprimme(primme_event_converged, primme)) {
                int ONE = 1, numConverged0 = numConverged+*recentlyConverged;
                primme_event EVENT_CONVERGED = primme_event_converged;
                int err;
@@ -1353,16 +1832,170 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       /* R(basisSize:) = W*hVecs(*blockSize:*blockSize+blockNormsize) - X(basisSize:)*diag(hVals)  */
       /* blockNorms(basisSize:) = norms(R(basisSize:))                                             */
 
+      /* If BV, R(basisSize:) and the norms are computed with BV*hVecs and */
+      /* X(basisSize:) apart. If B*V is not kept, B is applied to           */
+      /* X(basisSize:) instead                                              */
+
       assert(ldV == ldW); /* This functions only works in this way */
-      CHKERR(Num_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
-               hVecsBlock, basisSize, ldhVecs, hValsBlock,
-               X?&X[(*blockSize)*ldV]:NULL, 0, blockNormsSize, ldV,
-               NULL, 0, 0, 0,
-               NULL, 0, 0, 0,
-               NULL, 0, 0, 0,
-               R?&R[(*blockSize)*ldV]:NULL, 0, blockNormsSize, ldV, &blockNorms[*blockSize],
-               !R?&blockNorms[*blockSize]:NULL, 0, blockNormsSize,
-               rwork, rworkSize0, primme), -1);
+      if (primme->massMatrixMatvec && !BV) {
+         CHKERR(residual_B_Sprimme(V, W, ldV, nLocal, basisSize, hVecsBlock,
+                  ldhVecs, hValsBlock, blockNormsSize,
+                  X?&X[(*blockSize)*ldV]:NULL, ldV,
+                  R?&R[(*blockSize)*ldV]:NULL, ldV, &blockNorms[*blockSize],
+                  rwork, &rworkSize0, primme), -1);
+      }
+      else {
+         CHKERR(Num_update_VWXR_Sprimme(BV ? BV : V, W, nLocal, basisSize,
+                  ldV,
+                  hVecsBlock, basisSize, ldhVecs, hValsBlock,
+                  X&&!BV?&X[(*blockSize)*ldV]:NULL, 0, blockNormsSize, ldV,
+                  NULL, 0, 0, 0,
+                  NULL, 0, 0, 0,
+                  NULL, 0, 0, 0,
+                  R?&R[(*blockSize)*ldV]:NULL, 0, blockNormsSize, ldV, &blockNorms[*blockSize],
+                  !R?&blockNorms[*blockSize]:NULL, 0, blockNormsSize,
+                  rwork, rworkSize0, primme), -1);
+         if (X && BV) CHKERR(Num_update_VWXR_Sprimme(V, NULL, nLocal, basisSize,
+                  ldV, hVecsBlock, basisSize, ldhVecs, NULL,
+                  &X[(*blockSize)*ldV], 0, blockNormsSize, ldV,
+                  NULL, 0, 0, 0,
+                  NULL, 0, 0, 0,
+                  NULL, 0, 0, 0,
+                  NULL, 0, 0, 0, NULL,
+                  NULL, 0, 0,
+                  rwork, rworkSize0, primme), -1);
+      }
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine prepare_multishift_candidates - With primme.multiShiftBlock, this
+ *    subroutine computes a new vector for each of the numAux target shifts
+ *    after the current one, which are added to the block. For the shift tau_k,
+ *    with (A - tau_k*I)*V = Q_k*R_k, it takes the refined Ritz vector x = V*u,
+ *    where u is the right singular vector of R_k with the smallest singular
+ *    value, and returns the preconditioned residual M^{-1}*(A*x - theta*x)
+ *    with theta = u'*H*u, as GD does. The preconditioner is called with the
+ *    shifts tau_k in primme.ShiftsForPreconditioner, unless
+ *    primme.precondShiftUpdate is set; then the residual is returned.
+ * 
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * V                The orthonormal basis
+ * W                A*V
+ * nLocal           Local length of vectors in the basis
+ * ldV              The leading dimension of V and X
+ * ldW              The leading dimension of W and AX
+ * H                The projection V'*A*V
+ * ldH              The leading dimension of H
+ * basisSize        Size of the basis V and W
+ * R                The R factors of the next shifts; R_k starts at R[ldR*ldR*k]
+ * ldR              The leading dimension of each R_k
+ * targetShiftIndex The index of the current target shift
+ * numAux           The number of vectors to compute
+ * rwork            Real work array
+ * rworkSize        The size of rwork
+ * primme           Structure containing various solver parameters
+ *
+ * OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------
+ * X                The new vectors, of size nLocal x numAux
+ * AX               Workspace of size nLocal x numAux
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int prepare_multishift_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, PRIMME_INT nLocal, SCALAR *H, int ldH,
+      int basisSize, SCALAR *R, int ldR, int targetShiftIndex, int numAux,
+      SCALAR *X, SCALAR *AX, SCALAR *rwork, size_t *rworkSize,
+      primme_params *primme) {
+
+   int i, k, info, m = basisSize;
+   int lwork;           /* size of the work array of gesvd */
+   SCALAR *A;           /* copy of R_k, overwritten by its right singular vecs */
+   SCALAR *u, *Hu, *work;
+   REAL *sVals, *svdrwork=NULL;
+   double *shifts, *shifts0;
+   double theta;        /* Rayleigh quotient of V*u */
+   size_t rworkSize0 = *rworkSize;
+
+   /* Return memory requirements */
+
+   if (V == NULL) {
+      SCALAR w0 = 0.0;
+#ifdef USE_COMPLEX
+      CHKERR((Num_gesvd_Sprimme("N", "O", m, m, NULL, m, NULL, NULL, 1, NULL,
+                  1, &w0, -1, NULL, &info), info), -1);
+#else
+      CHKERR((Num_gesvd_Sprimme("N", "O", m, m, NULL, m, NULL, NULL, 1, NULL,
+                  1, &w0, -1, &info), info), -1);
+#endif
+      /* A, u, Hu, work, sVals, svdrwork, shifts and the alignment of each */
+      *rworkSize = max(*rworkSize, (size_t)m*m + 2*m
+            + (size_t)REAL_PART(w0) + 6*m + 2*numAux + 16);
+      return 0;
+   }
+
+   if (numAux <= 0 || basisSize <= 0) return 0;
+
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)m*m, &A, &rwork, &rworkSize0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(m, &u, &rwork, &rworkSize0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(m, &Hu, &rwork, &rworkSize0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(m, &sVals, &rwork, &rworkSize0), -1);
+#ifdef USE_COMPLEX
+   CHKERR(WRKSP_MALLOC_PRIMME(5*m, &svdrwork, &rwork, &rworkSize0), -1);
+#endif
+   CHKERR(WRKSP_MALLOC_PRIMME(numAux, &shifts, &rwork, &rworkSize0), -1);
+   work = rwork;
+   lwork = TO_INT(rworkSize0);
+   (void)svdrwork;
+
+   for (k=0; k<numAux; k++) {
+      SCALAR *Rk = &R[(size_t)ldR*ldR*k];
+
+      /* u = right singular vector of R_k with the smallest singular value; */
+      /* gesvd returns V' with the singular values in descending order      */
+
+      Num_copy_matrix_Sprimme(Rk, m, m, ldR, A, m);
+#ifdef USE_COMPLEX
+      CHKERR((Num_gesvd_Sprimme("N", "O", m, m, A, m, sVals, NULL, 1, NULL, 1,
+                  work, lwork, svdrwork, &info), info), -1);
+#else
+      CHKERR((Num_gesvd_Sprimme("N", "O", m, m, A, m, sVals, NULL, 1, NULL, 1,
+                  work, lwork, &info), info), -1);
+#endif
+      for (i=0; i<m; i++) u[i] = CONJ(A[m*i+m-1]);
+
+      /* theta = u'*H*u */
+
+      Num_hemm_Sprimme("L", "U", m, 1, 1.0, H, ldH, u, m, 0.0, Hu, m);
+      theta = REAL_PART(Num_dot_Sprimme(m, u, 1, Hu, 1));
+
+      /* X(:,k) = V*u and AX(:,k) = W*u - theta*V*u */
+
+      Num_gemm_Sprimme("N", "N", nLocal, 1, m, 1.0, V, ldV, u, m, 0.0,
+            &X[ldV*k], ldV);
+      Num_gemm_Sprimme("N", "N", nLocal, 1, m, 1.0, W, ldW, u, m, 0.0,
+            &AX[ldW*k], ldW);
+      Num_axpy_Sprimme(nLocal, -theta, &X[ldV*k], 1, &AX[ldW*k], 1);
+
+      shifts[k] = primme->targetShifts[targetShiftIndex+k+1];
+   }
+
+   /* X = M^{-1}*AX */
+
+   if (primme->precondShiftUpdate) {
+      Num_copy_matrix_Sprimme(AX, nLocal, numAux, ldW, X, ldV);
+   }
+   else {
+      shifts0 = primme->ShiftsForPreconditioner;
+      primme->ShiftsForPreconditioner = shifts;
+      CHKERR(applyPreconditioner_Sprimme(AX, nLocal, ldW, X, ldV, numAux,
+               primme), -1);
+      primme->ShiftsForPreconditioner = shifts0;
    }
 
    return 0;
@@ -1384,15 +2017,22 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
  *
  * W            A*V
  *
+ * BV           B*V, if massMatrixMatvec is set (optional). If it is not
+ *              given in generalized problems, B is applied to V
+ *
  * hVals        The eigenvalues of V'*A*V
  *
  * basisSize    Size of the basis V
  *
+ * freshResNorms If nonzero, resNorms already has the residual norms of the
+ *              current V and W, and only the convergence is checked
+ *
  * rworkSize    Length of rwork
  *
  * INPUT/OUTPUT ARRAYS
  * -------------------
- * rwork   Must be at least 2*primme->numEvals in size
+ * rwork   Must be at least 2*primme->numEvals in size, plus
+ *         nLocal*maxBlockSize in generalized problems without BV
  *
  *
  * OUTPUT ARRAYS AND PARAMETERS
@@ -1406,29 +2046,46 @@ int prepare_candidates_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
  ******************************************************************************/
    
 static int verify_norms(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
-      REAL *hVals, int basisSize, REAL *resNorms, int *flags, int *converged,
-      double machEps, SCALAR *rwork, size_t *rworkSize, int *iwork,
-      int iworkSize, primme_params *primme) {
+      SCALAR *BV, REAL *hVals, int basisSize, REAL *resNorms,
+      int freshResNorms, int *flags, int *converged, double machEps,
+      SCALAR *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme) {
 
-   int i;         /* Loop variable                                     */
+   int i, j;      /* Loop variables                                    */
+   int nb;        /* Number of columns B is applied to at once          */
    REAL *dwork = (REAL *) rwork; /* pointer to cast rwork to REAL*/
+   SCALAR *Bv = rwork + basisSize; /* B*V(:,i:i+nb-1) if BV is not given */
+
+   /* Compute the residual vectors, applying B to blocks of columns of V */
+   /* if B*V is not kept, and reduce all their norms at once             */
+
+   if (!freshResNorms) {
+      nb = max(1, min(basisSize, primme->maxBlockSize));
+      for (i=0; i < basisSize; i+=nb) {
+         nb = min(nb, basisSize-i);
+         if (primme->massMatrixMatvec && !BV) {
+            assert(*rworkSize >= (size_t)basisSize + (size_t)primme->nLocal*nb);
+            CHKERR(massMatrixMatvec_Sprimme(&V[ldV*i], primme->nLocal, ldV,
+                     Bv, primme->nLocal, 0, nb, primme), -1);
+         }
+         for (j=i; j < i+nb; j++) {
+            Num_axpy_Sprimme(primme->nLocal, -hVals[j], BV ? &BV[ldV*j] :
+                  primme->massMatrixMatvec ? &Bv[primme->nLocal*(j-i)] :
+                  &V[ldV*j], 1, &W[ldW*j], 1);
+            dwork[j] = REAL_PART(Num_dot_Sprimme(primme->nLocal, &W[ldW*j],
+                     1, &W[ldW*j], 1));
+         }
+      }
 
-   /* Compute the residual vectors */
-
-   for (i=0; i < basisSize; i++) {
-      Num_axpy_Sprimme(primme->nLocal, -hVals[i], &V[ldV*i], 1, &W[ldW*i], 1);
-      dwork[i] = REAL_PART(Num_dot_Sprimme(primme->nLocal, &W[ldW*i],
-               1, &W[ldW*i], 1));
+      CHKERR(globalSum_Rprimme(dwork, resNorms, basisSize, primme), -1);
+      for (i=0; i < basisSize; i++)
+         resNorms[i] = sqrt(resNorms[i]);
    }
-      
-   CHKERR(globalSum_Rprimme(dwork, resNorms, basisSize, primme), -1);
-   for (i=0; i < basisSize; i++)
-      resNorms[i] = sqrt(resNorms[i]);
 
    /* Check for convergence of the residual norms. */
 
    CHKERR(check_convergence_Sprimme(V, primme->nLocal, ldV, W, ldW, NULL, 0,
-            0, 0, basisSize, flags, resNorms, hVals, NULL, machEps, rwork,
+            0, 0, basisSize, flags, resNorms, NULL, hVals, NULL, machEps, rwork,
             rworkSize, iwork, iworkSize, primme), -1);
 
    /* Set converged to 1 if the first basisSize pairs are converged */
@@ -1982,7 +2639,7 @@ static void initializeModel(primme_CostModel *model, primme_params *primme) {
 
    model->numMV_0 = primme->stats.numMatvecs;
    model->numIt_0 = primme->stats.numOuterIterations+1;
-   model->timer_0 = primme_wTimer(0);
+   model->timer_0 = primme_get_wtime();
    model->time_in_inner  = 0.0L;
    model->resid_0        = -1.0L;
 
@@ -1991,6 +2648,256 @@ static void initializeModel(primme_CostModel *model, primme_params *primme) {
    model->accum_jdq_gdk  = 1.0L;
 }
 
+/******************************************************************************
+ * Function initializeBlockModel - Start the block size tuning with block size
+ *    one and no measurements.
+ *
+ ******************************************************************************/
+static void initializeBlockModel(primme_CostModel *model, primme_params *primme) {
+   int i;
+
+   model->blockSize = 1;
+   for (i=0; i<PRIMME_BLOCK_MODEL_SIZES; i++) {
+      model->blk_time[i] = -1.0L;
+      model->blk_MV_PR[i] = -1.0L;
+   }
+   model->blk_latency = 0.0L;
+   model->blk_timer_0 = primme_get_wtime();
+   model->blk_MV_PR_0 = primme->stats.timeMatvec + primme->stats.timePrecond;
+   model->blk_sum_0 = primme->stats.timeGlobalSum;
+   model->blk_numMV_0 = primme->stats.numMatvecs;
+   model->blk_numIt_0 = primme->stats.numOuterIterations;
+}
+
+/******************************************************************************
+ * Function update_block_size - Called at every restart. Average the time per
+ *    matvec measured since the last call into the entry of the current block
+ *    size, and choose the block size until the next restart:
+ *
+ *    - the smallest size measured that is within 10% of the fastest one, as
+ *      larger blocks usually take more matvecs to converge;
+ *    - or the next size not measured yet, if the current one is that choice
+ *      and the model predicts it saves more than 10%. Doubling the block
+ *      shares the global sums of an iteration among twice the columns, and
+ *      block products are assumed to keep getting cheaper per column as they
+ *      did from the previous size. The first doubling is always tried.
+ *
+ * INPUT/OUTPUT
+ * ------------
+ * model        The CostModel (blockSize and blk_* updated)
+ *
+ * primme       The solver parameters
+ *
+ ******************************************************************************/
+static void update_block_size(primme_CostModel *model, primme_params *primme) {
+   int i, cur, best, last;
+   PRIMME_INT numMV = primme->stats.numMatvecs - model->blk_numMV_0;
+   PRIMME_INT numIt = primme->stats.numOuterIterations - model->blk_numIt_0;
+   double time, MV_PR, fastest, gain;
+
+   if (numMV <= 0 || numIt <= 0) return;
+
+   /* Measure the time per matvec of the current block size */
+
+   for (cur=0; cur<PRIMME_BLOCK_MODEL_SIZES-1
+         && (1<<cur) < model->blockSize; cur++);
+   time = (primme_get_wtime() - model->blk_timer_0)/numMV;
+   MV_PR = (primme->stats.timeMatvec + primme->stats.timePrecond
+         - model->blk_MV_PR_0)/numMV;
+   model->blk_latency = (primme->stats.timeGlobalSum - model->blk_sum_0)/numIt;
+   if (model->blk_time[cur] < 0.0L) {
+      model->blk_time[cur] = time;
+      model->blk_MV_PR[cur] = MV_PR;
+   }
+   else {
+      model->blk_time[cur] = (model->blk_time[cur] + time)/2.0L;
+      model->blk_MV_PR[cur] = (model->blk_MV_PR[cur] + MV_PR)/2.0L;
+   }
+
+   /* Choose the smallest size close to the fastest one */
+
+   for (last=0; last<PRIMME_BLOCK_MODEL_SIZES-1
+         && (1<<last) < primme->maxBlockSize; last++);
+   for (i=0, fastest=HUGE_VAL; i<=last; i++) {
+      if (model->blk_time[i] >= 0.0L) fastest = min(fastest, model->blk_time[i]);
+   }
+   for (best=0; model->blk_time[best] < 0.0L
+         || model->blk_time[best] > 1.1L*fastest; best++);
+
+   /* Try the next size if it is predicted to be faster */
+
+   if (best == cur && cur < last && model->blk_time[cur+1] < 0.0L) {
+      gain = model->blk_latency/(2*model->blockSize);
+      if (cur > 0 && model->blk_MV_PR[cur-1] > model->blk_MV_PR[cur])
+         gain += model->blk_MV_PR[cur-1] - model->blk_MV_PR[cur];
+      if (cur == 0 || gain > 0.1L*model->blk_time[cur]) best = cur+1;
+   }
+
+   if (primme->printLevel >= 3 && primme->procID == 0
+         && min(1<<best, primme->maxBlockSize) != model->blockSize) {
+      fprintf(primme->outputFile,
+            "Time per MV: %e Block size changed from %d to %d\n", time,
+            model->blockSize, min(1<<best, primme->maxBlockSize));
+   }
+   model->blockSize = min(1<<best, primme->maxBlockSize);
+
+   model->blk_timer_0 = primme_get_wtime();
+   model->blk_MV_PR_0 = primme->stats.timeMatvec + primme->stats.timePrecond;
+   model->blk_sum_0 = primme->stats.timeGlobalSum;
+   model->blk_numMV_0 = primme->stats.numMatvecs;
+   model->blk_numIt_0 = primme->stats.numOuterIterations;
+}
+
+/******************************************************************************
+ * Function initializeRemainingModel - Start the estimation of the remaining
+ *    work with no measurements.
+ *
+ ******************************************************************************/
+static void initializeRemainingModel(primme_CostModel *model) {
+   model->eta_sum_logResReductions = 0.0;
+   model->eta_sum_MV     = 0.0;
+   model->eta_resid_0    = -1.0;
+   model->eta_numMV_0    = 0;
+   model->eta_numMV_conv = 0;
+}
+
+/******************************************************************************
+ * Function update_remaining - Called at every outer iteration. Estimate the
+ *    matvecs and the wall time left to converge the remaining pairs, and set
+ *    them in stats.estimateRemainingMatvecs and stats.estimateRemainingTime.
+ *
+ *    The convergence rate per matvec is the geometric average of all residual
+ *    reductions seen, as in update_statistics; with dynamic method switching,
+ *    the rate measured by update_statistics for the current method is used
+ *    instead. The current pair takes log(tol/|r|)/log(rate) more matvecs, and
+ *    every other pair the average matvecs per converged pair so far (before
+ *    any pair converges, the matvecs of the current pair over the block
+ *    size). The time per matvec is the elapsed time over the matvecs, so it
+ *    includes all the other costs of the iteration.
+ *
+ *    The estimations are -1 while no residual reduction has been observed.
+ *
+ * INPUT
+ * -----
+ * primme           Structure containing the solver parameters
+ * recentConv       Number of converged pairs in this iteration
+ * numConverged     Total number of converged pairs
+ * blockSize        Number of pairs in the block; if zero, only the number of
+ *                  converged pairs is updated
+ * currentResNorm   Residual norm of the next unconverged pair
+ * aNormEst         Estimate of ||A||_2. Conv Tolerance = aNormEst*primme.eps
+ *
+ * INPUT/OUTPUT
+ * ------------
+ * model            The model parameters updated (eta_*)
+ *
+ ******************************************************************************/
+static void update_remaining(primme_CostModel *model, primme_params *primme,
+   int recentConv, int numConverged, int blockSize, double currentResNorm,
+   double aNormEst) {
+
+   double tol, logRate, sum_log, sum_MV, MV_cur, MV_pair;
+   PRIMME_INT numMV = primme->stats.numMatvecs;
+   int numRemaining = primme->numEvals - numConverged;
+
+   tol = primme->eps*(primme->aNorm > 0.0L ? primme->aNorm : aNormEst);
+
+   /* Account the pairs that just converged and start the next one */
+
+   if (recentConv > 0) {
+      if (tol > 0.0 && model->eta_resid_0 > tol) {
+         model->eta_sum_logResReductions += log(tol/model->eta_resid_0);
+         model->eta_sum_MV += numMV - model->eta_numMV_0;
+      }
+      model->eta_numMV_conv = numMV;
+      model->eta_resid_0 = -1.0;
+   }
+   if (blockSize <= 0) return;
+   if (model->eta_resid_0 < 0.0) {
+      model->eta_resid_0 = currentResNorm;
+      model->eta_numMV_0 = numMV;
+   }
+
+   /* Convergence rate per matvec, including the progress on the current */
+   /* pair                                                                */
+
+   sum_log = model->eta_sum_logResReductions;
+   sum_MV = model->eta_sum_MV + (numMV - model->eta_numMV_0);
+   if (currentResNorm < model->eta_resid_0)
+      sum_log += log(currentResNorm/model->eta_resid_0);
+   switch (primme->dynamicMethodSwitch) {
+      case 1: case 3:
+         if (model->gdk_sum_MV > 0.0 && model->gdk_sum_logResReductions < 0.0) {
+            sum_log = model->gdk_sum_logResReductions;
+            sum_MV = model->gdk_sum_MV;
+         }
+         break;
+      case 2: case 4:
+         if (model->jdq_sum_MV > 0.0 && model->jdq_sum_logResReductions < 0.0) {
+            sum_log = model->jdq_sum_logResReductions;
+            sum_MV = model->jdq_sum_MV;
+         }
+   }
+   if (sum_log >= 0.0 || sum_MV <= 0.0 || numMV <= 0 || tol <= 0.0) {
+      primme->stats.estimateRemainingMatvecs = -1.0;
+      primme->stats.estimateRemainingTime = -1.0;
+      return;
+   }
+   logRate = sum_log/sum_MV;
+
+   /* Matvecs for the current pair and for the others */
+
+   MV_cur = currentResNorm > tol ? log(tol/currentResNorm)/logRate : 0.0;
+   if (numConverged > 0)
+      MV_pair = (double)model->eta_numMV_conv/numConverged;
+   else
+      MV_pair = (numMV + MV_cur)/blockSize;
+
+   primme->stats.estimateRemainingMatvecs =
+      numRemaining > 0 ? MV_cur + (numRemaining - 1)*MV_pair : 0.0;
+   primme->stats.estimateRemainingTime =
+      primme->stats.estimateRemainingMatvecs
+      *(primme_get_wtime() - primme->startTime)/numMV;
+}
+
+/******************************************************************************
+ * Functions load_model and save_model - Copy the fitted timings and rates of
+ *    the model from/to an array of PRIMME_DYNAMIC_MODEL_SIZE values, in order:
+ *    MV, PR, MV_PR, qmr_only, qmr_plus_MV_PR, gdk_plus_MV_PR, gdk_plus_MV,
+ *    gdk_conv_rate, jdq_conv_rate, JDQMR_slowdown, ratio_MV_outer and
+ *    accum_jdq_gdk. The accumulated sums and counters are not copied.
+ *
+ ******************************************************************************/
+static void load_model(primme_CostModel *model, const double *values) {
+   model->MV             = values[0];
+   model->PR             = values[1];
+   model->MV_PR          = values[2];
+   model->qmr_only       = values[3];
+   model->qmr_plus_MV_PR = values[4];
+   model->gdk_plus_MV_PR = values[5];
+   model->gdk_plus_MV    = values[6];
+   model->gdk_conv_rate  = values[7];
+   model->jdq_conv_rate  = values[8];
+   model->JDQMR_slowdown = values[9];
+   model->ratio_MV_outer = values[10];
+   model->accum_jdq_gdk  = values[11];
+}
+
+static void save_model(const primme_CostModel *model, double *values) {
+   values[0]  = model->MV;
+   values[1]  = model->PR;
+   values[2]  = model->MV_PR;
+   values[3]  = model->qmr_only;
+   values[4]  = model->qmr_plus_MV_PR;
+   values[5]  = model->gdk_plus_MV_PR;
+   values[6]  = model->gdk_plus_MV;
+   values[7]  = model->gdk_conv_rate;
+   values[8]  = model->jdq_conv_rate;
+   values[9]  = model->JDQMR_slowdown;
+   values[10] = model->ratio_MV_outer;
+   values[11] = model->accum_jdq_gdk;
+}
+
 #if 0
 /******************************************************************************
  *
@@ -49,56 +49,86 @@ int main_iter_dprimme(double *evals, int *perm, double *evecs, PRIMME_INT ldevec
 #  define prepare_candidates_Rprimme CONCAT(prepare_candidates_,REAL_SUF)
 #endif
 int prepare_candidates_dprimme(double *V, PRIMME_INT ldV, double *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, double *H, int ldH, int basisSize,
+      PRIMME_INT ldW, double *BV, PRIMME_INT nLocal, double *H, int ldH,
+      int basisSize,
       double *X, double *R, double *hVecs, int ldhVecs, double *hVals,
       double *hSVals, int *flags, int remainedEvals, double *blockNorms,
       int blockNormsSize, int maxBlockSize, double *evecs, int numLocked,
       PRIMME_INT ldevecs, double *evals, double *resNorms, int targetShiftIndex,
       double machEps, int *iev, int *blockSize, int *recentlyConverged,
       int *numArbitraryVecs, double *smallestResNorm, double *hVecsRot,
-      int ldhVecsRot, int numConverged, double *basisNorms, int *reset,
-      double *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      int ldhVecsRot, int numConverged, double *basisNorms, double *restartsW,
+      int *reset, double *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(prepare_multishift_candidates_Sprimme)
+#  define prepare_multishift_candidates_Sprimme CONCAT(prepare_multishift_candidates_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(prepare_multishift_candidates_Rprimme)
+#  define prepare_multishift_candidates_Rprimme CONCAT(prepare_multishift_candidates_,REAL_SUF)
+#endif
+int prepare_multishift_candidates_dprimme(double *V, PRIMME_INT ldV,
+      double *W, PRIMME_INT ldW, PRIMME_INT nLocal, double *H, int ldH,
+      int basisSize, double *R, int ldR, int targetShiftIndex, int numAux,
+      double *X, double *AX, double *rwork, size_t *rworkSize,
       primme_params *primme);
 int main_iter_zprimme(double *evals, int *perm, PRIMME_COMPLEX_DOUBLE *evecs, PRIMME_INT ldevecs,
    double *resNorms, double machEps, int *intWork, void *realWork,
    primme_params *primme);
 int prepare_candidates_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, PRIMME_COMPLEX_DOUBLE *H, int ldH, int basisSize,
+      PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *BV, PRIMME_INT nLocal, PRIMME_COMPLEX_DOUBLE *H, int ldH,
+      int basisSize,
       PRIMME_COMPLEX_DOUBLE *X, PRIMME_COMPLEX_DOUBLE *R, PRIMME_COMPLEX_DOUBLE *hVecs, int ldhVecs, double *hVals,
       double *hSVals, int *flags, int remainedEvals, double *blockNorms,
       int blockNormsSize, int maxBlockSize, PRIMME_COMPLEX_DOUBLE *evecs, int numLocked,
       PRIMME_INT ldevecs, double *evals, double *resNorms, int targetShiftIndex,
       double machEps, int *iev, int *blockSize, int *recentlyConverged,
       int *numArbitraryVecs, double *smallestResNorm, PRIMME_COMPLEX_DOUBLE *hVecsRot,
-      int ldhVecsRot, int numConverged, double *basisNorms, int *reset,
-      PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      int ldhVecsRot, int numConverged, double *basisNorms, double *restartsW,
+      int *reset, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme);
+int prepare_multishift_candidates_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV,
+      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, PRIMME_INT nLocal, PRIMME_COMPLEX_DOUBLE *H, int ldH,
+      int basisSize, PRIMME_COMPLEX_DOUBLE *R, int ldR, int targetShiftIndex, int numAux,
+      PRIMME_COMPLEX_DOUBLE *X, PRIMME_COMPLEX_DOUBLE *AX, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
       primme_params *primme);
 int main_iter_sprimme(float *evals, int *perm, float *evecs, PRIMME_INT ldevecs,
    float *resNorms, double machEps, int *intWork, void *realWork,
    primme_params *primme);
 int prepare_candidates_sprimme(float *V, PRIMME_INT ldV, float *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, float *H, int ldH, int basisSize,
+      PRIMME_INT ldW, float *BV, PRIMME_INT nLocal, float *H, int ldH,
+      int basisSize,
       float *X, float *R, float *hVecs, int ldhVecs, float *hVals,
       float *hSVals, int *flags, int remainedEvals, float *blockNorms,
       int blockNormsSize, int maxBlockSize, float *evecs, int numLocked,
       PRIMME_INT ldevecs, float *evals, float *resNorms, int targetShiftIndex,
       double machEps, int *iev, int *blockSize, int *recentlyConverged,
       int *numArbitraryVecs, double *smallestResNorm, float *hVecsRot,
-      int ldhVecsRot, int numConverged, float *basisNorms, int *reset,
-      float *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      int ldhVecsRot, int numConverged, float *basisNorms, float *restartsW,
+      int *reset, float *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme);
+int prepare_multishift_candidates_sprimme(float *V, PRIMME_INT ldV,
+      float *W, PRIMME_INT ldW, PRIMME_INT nLocal, float *H, int ldH,
+      int basisSize, float *R, int ldR, int targetShiftIndex, int numAux,
+      float *X, float *AX, float *rwork, size_t *rworkSize,
       primme_params *primme);
 int main_iter_cprimme(float *evals, int *perm, PRIMME_COMPLEX_FLOAT *evecs, PRIMME_INT ldevecs,
    float *resNorms, double machEps, int *intWork, void *realWork,
    primme_params *primme);
 int prepare_candidates_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, PRIMME_COMPLEX_FLOAT *H, int ldH, int basisSize,
+      PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *BV, PRIMME_INT nLocal, PRIMME_COMPLEX_FLOAT *H, int ldH,
+      int basisSize,
       PRIMME_COMPLEX_FLOAT *X, PRIMME_COMPLEX_FLOAT *R, PRIMME_COMPLEX_FLOAT *hVecs, int ldhVecs, float *hVals,
       float *hSVals, int *flags, int remainedEvals, float *blockNorms,
       int blockNormsSize, int maxBlockSize, PRIMME_COMPLEX_FLOAT *evecs, int numLocked,
       PRIMME_INT ldevecs, float *evals, float *resNorms, int targetShiftIndex,
       double machEps, int *iev, int *blockSize, int *recentlyConverged,
       int *numArbitraryVecs, double *smallestResNorm, PRIMME_COMPLEX_FLOAT *hVecsRot,
-      int ldhVecsRot, int numConverged, float *basisNorms, int *reset,
-      PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      int ldhVecsRot, int numConverged, float *basisNorms, float *restartsW,
+      int *reset, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, int *iwork, int iworkSize,
+      primme_params *primme);
+int prepare_multishift_candidates_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV,
+      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, PRIMME_INT nLocal, PRIMME_COMPLEX_FLOAT *H, int ldH,
+      int basisSize, PRIMME_COMPLEX_FLOAT *R, int ldR, int targetShiftIndex, int numAux,
+      PRIMME_COMPLEX_FLOAT *X, PRIMME_COMPLEX_FLOAT *AX, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
       primme_params *primme);
 #endif
@@ -36,8 +36,12 @@
 #ifndef MAIN_ITER_PRIVATE_H
 #define MAIN_ITER_PRIVATE_H
 
+/* Number of block sizes, 1, 2, 4, ..., measured by the block size tuning */
+#define PRIMME_BLOCK_MODEL_SIZES 16
+
 /*----------------------------------------------------------------------------*
- * The following are needed for the Dynamic Method Switching
+ * The following are needed for the Dynamic Method Switching and for tuning
+ * the block size
  *----------------------------------------------------------------------------*/
 
 typedef struct {
@@ -83,9 +87,33 @@ typedef struct {
    double accum_jdq;      /* Accumulates jdq_times += ratio*(gdk+MV+PR)       */
    double accum_gdk;      /* Accumulates gdk_times += gdk+MV+PR               */
 
+   /* Block size tuning (dynamicBlockSize). Entry i is for the block size     */
+   /* min(2^i, maxBlockSize); times are per matvec, and -1 if not measured    */
+   int    blockSize;      /* Current limit on the block size                  */
+   double blk_time[PRIMME_BLOCK_MODEL_SIZES];  /* wall time of the iteration  */
+   double blk_MV_PR[PRIMME_BLOCK_MODEL_SIZES]; /* MV+PR time only             */
+   double blk_latency;    /* Time in global sums per outer iteration          */
+   double blk_timer_0;    /* Remembers time, MV+PR time, global sum time,     */
+   double blk_MV_PR_0;    /*    MVs and outer its since the block size was    */
+   double blk_sum_0;      /*    last updated                                  */
+   PRIMME_INT blk_numMV_0;
+   PRIMME_INT blk_numIt_0;
+
+   /* Estimation of the remaining work (stats.estimateRemaining*), updated  */
+   /* at every outer iteration                                              */
+   double eta_sum_logResReductions; /* Sum of log(residual reductions) and */
+   double eta_sum_MV;     /*    MVs spent on the pairs converged so far     */
+   double eta_resid_0;    /* First residual norm of the current pair and    */
+   PRIMME_INT eta_numMV_0;/*    number of MVs when it started               */
+   PRIMME_INT eta_numMV_conv;/* Number of MVs when the last pair converged  */
+
 } primme_CostModel;
 
 static void initializeModel(primme_CostModel *model, primme_params *primme);
+static void initializeRemainingModel(primme_CostModel *model);
+static void update_remaining(primme_CostModel *model, primme_params *primme,
+   int recentConv, int numConverged, int blockSize, double currentResNorm,
+   double aNormEst);
 static int switch_from_JDQMR(primme_CostModel *model, primme_params *primme);
 static int switch_from_GDpk (primme_CostModel *model, primme_params *primme);
 static int update_statistics(primme_CostModel *model, primme_params *primme,
@@ -94,6 +122,10 @@ static int update_statistics(primme_CostModel *model, primme_params *primme,
 static double ratio_JDQMR_GDpk(primme_CostModel *CostModel, int numLocked,
    double estimate_slowdown, double estimate_ratio_outer_MV);
 static void update_slowdown(primme_CostModel *model);
+static void load_model(primme_CostModel *model, const double *values);
+static void save_model(const primme_CostModel *model, double *values);
+static void initializeBlockModel(primme_CostModel *model, primme_params *primme);
+static void update_block_size(primme_CostModel *model, primme_params *primme);
 
 #if 0
 static void displayModel(primme_CostModel *model);
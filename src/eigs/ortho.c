@@ -70,7 +70,10 @@
 #include "ortho.h"
 #include "const.h"
 #include "globalsum.h"
+#include "auxiliary_eigs.h"
+#include "update_W.h"
 #include "wtime.h"
+#include "trace.h"
  
 
 /**********************************************************************
@@ -89,6 +92,8 @@
  * locked     Array that holds locked vectors if they are in-core
  * ldLocked   Leading dimension of locked
  * numLocked  Number of vectors in locked
+ * lockedDone If nonzero, V(:,b1:b2) is already orthogonal to locked, and
+ *            locked is only used for the vectors replaced by random vectors
  * nLocal     Number of rows of each vector stored on this node
  * machEps    Double machine precision
  *
@@ -116,20 +121,31 @@
 
 static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
       int b1, int b2, SCALAR *locked, PRIMME_INT ldLocked,
-      int numLocked, PRIMME_INT nLocal, int (*B)(SCALAR*,PRIMME_INT,SCALAR*,
+      int numLocked, int lockedDone, PRIMME_INT nLocal, int (*B)(SCALAR*,PRIMME_INT,SCALAR*,
          PRIMME_INT,int,void*), void *ctx,
       PRIMME_INT *iseed, double machEps, SCALAR *rwork, size_t *rworkSize,
       primme_params *primme) {
               
    int i, j;                /* Loop indices */
    int messages = 1;        /* messages = 1 prints the intermediate results */
-   /* TODO: replace by a dynamic criterion when to stop orthogonalizing local */
-   /* vectors. Observed performance improvement when maxNumOrthos increases.  */
    int maxNumOrthos = primme?3:7; /* We let 2 reorthogonalizations before randomize */
                                   /* for nLocal length vectors, and 6 orthogonalisations */
-                                  /* for the rest */
+                                  /* for the rest; with primme_orth_adaptive, up to 6 */
+                                  /* for nLocal length vectors while every pass keeps */
+                                  /* more of the vector than the previous one         */
    int maxNumRandoms = 10;  /* We do not allow more than 10 randomizations */
    double tol = sqrt(2.0L)/2.0L; /* We set Daniel et al. test to .707 */
+   int adaptive = primme && primme->orth == primme_orth_adaptive;
+                            /* skip the reorthogonalizations that the measured */
+                            /* loss of orthogonality allows                    */
+   double lossTol = adaptive ? min(primme->eps/10.0, 1e3*machEps) : 0.0;
+                            /* allowed loss of orthogonality of a vector that */
+                            /* is not reorthogonalized                        */
+   double lossFactor = 0.0; /* largest measured loss factor in this call     */
+   int numCandidates = 0;   /* vectors that may skip the reorthogonalization */
+   int lowsync = primme && primme->orth == primme_orth_lowsync;
+                            /* reduce the norm of the vector with the overlaps */
+                            /* of the next pass instead of explicitly          */
    double t0;
    size_t localrworkSize = *rworkSize; // local rworkSize
 
@@ -167,7 +183,7 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
    /* main loop to orthogonalize new vectors one by one */
    /*---------------------------------------------------*/
 
-   t0 = primme_wTimer(0);
+   t0 = primme_get_wtime();
 
    // Allocate overlaps and Bx
 
@@ -189,10 +205,16 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
       REAL s02=0.0;  // s0 squared
       REAL s1=0.0;   // B-norm of the current vector after deflating V and locked
       REAL s12=0.0;  // s1 squared
+      int maxOrthos = maxNumOrthos; // passes allowed before randomizing
+      REAL ratio_prev = 0.0;  // s1/s0 in the previous pass
+      REAL sampled = 0.0;     // s0/s1 in the first pass if it is measured
+                              // in the second pass
+      int pending = 0;        // flag if s1 is not reliable and it is checked
+                              // in the next pass
 
       for (nOrth=0, randomizations=0; reorth; ) {
 
-         if (nOrth >= maxNumOrthos) {
+         if (nOrth >= maxOrthos) {
             /* Stop updating R when replacing one of the columns of the V */
             /* with a random vector                                           */
 
@@ -211,11 +233,19 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
             Num_larnv_Sprimme(2, iseed, nLocal, &V[ldV*i]); 
             randomizations++;
             nOrth = 0;
+            maxOrthos = maxNumOrthos;
+            ratio_prev = 0.0;
+            sampled = 0.0;
+            pending = 0;
             Bx_update = 0;    // V[i] has changed, so Bx != B*V[i]
          }
 
          nOrth++;
 
+         // Skip the locked vectors if V[i] is already orthogonal to them
+
+         int nL = (lockedDone && randomizations == 0) ? 0 : numLocked;
+
          // Compute B*V[i]
 
          if (B && !Bx_update) {
@@ -226,9 +256,10 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
          }
 
          // Compute the B norm of the current vector, V[i], if it wasn't computed
-         // in previous iteration
+         // in previous iteration. With lowsync, it is always computed here
+         // and reduced with the overlaps
 
-         if (nOrth == 1) {
+         if (nOrth == 1 || lowsync) {
             s02 = REAL_PART(Num_dot_Sprimme(nLocal, &V[ldV*i], 1, Bx, 1));
             if (primme) primme->stats.numOrthoInnerProds += 1;
          }
@@ -241,25 +272,37 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
             if (primme) primme->stats.numOrthoInnerProds += i;
          }
 
-         if (numLocked > 0) {
-            Num_gemv_Sprimme("C", nLocal, numLocked, 1.0, locked, ldLocked,
+         if (nL > 0) {
+            Num_gemv_Sprimme("C", nLocal, nL, 1.0, locked, ldLocked,
                Bx, 1, 0.0, &overlaps[i], 1);
-            if (primme) primme->stats.numOrthoInnerProds += numLocked;
+            if (primme) primme->stats.numOrthoInnerProds += nL;
          }
 
-         overlaps[i+numLocked] = s02;
-         CHKERR(globalSum_Sprimme(overlaps, overlaps, i + numLocked + 1,
+         overlaps[i+nL] = s02;
+         CHKERR(globalSum_Sprimme(overlaps, overlaps, i + nL + 1,
                   primme), -1);
 
+         /* With lowsync, check now if the previous pass lost all the digits */
+         /* when the implicit norm could not tell it                         */
+
+         if (pending && REAL_PART(overlaps[i+nL]) <= machEps*machEps*s02) {
+            if (messages) {
+               fprintf(primme->outputFile, 
+                 "Vector %d lost all significant digits in ortho\n", i-b1);
+            }
+            nOrth = maxOrthos;
+            continue;
+         }
+
          if (updateR) {
              Num_axpy_Sprimme(i, 1.0, overlaps, 1, &R[ldR*i], 1);
          }
 
-         if (numLocked > 0) { /* locked array most recently accessed */
-            // Compute V[i] = V[i] - locked'*overlaps[i:i+numLocked-1]
-            Num_gemv_Sprimme("N", nLocal, numLocked, -1.0, locked, ldLocked, 
+         if (nL > 0) { /* locked array most recently accessed */
+            // Compute V[i] = V[i] - locked'*overlaps[i:i+nL-1]
+            Num_gemv_Sprimme("N", nLocal, nL, -1.0, locked, ldLocked, 
                &overlaps[i], 1, 1.0, &V[ldV*i], 1); 
-            if (primme) primme->stats.numOrthoInnerProds += numLocked;
+            if (primme) primme->stats.numOrthoInnerProds += nL;
          }
 
          if (i > 0) {
@@ -270,22 +313,55 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
 
          Bx_update = 0;    // V[i] has changed, so Bx != B*V[i]
  
-         if (nOrth == 1) {
-            s0 = sqrt(s02 = REAL_PART(overlaps[i+numLocked]));
+         if (nOrth == 1 || lowsync) {
+            s0 = sqrt(s02 = REAL_PART(overlaps[i+nL]));
          }
 
          /* Compute the norm of the resulting vector implicitly */
          
          {
-            REAL temp = REAL_PART(Num_dot_Sprimme(i+numLocked,overlaps,1,overlaps,1));
+            REAL temp = REAL_PART(Num_dot_Sprimme(i+nL,overlaps,1,overlaps,1));
             s1 = sqrt(s12 = max(0.0L, s02-temp));
+
+            /* The overlaps of the second pass are the loss of orthogonality */
+            /* left by the first one; record its ratio to machEps*s0/s1      */
+
+            if (nOrth == 2 && sampled > 0.0) {
+               lossFactor = max(max(1.0, lossFactor),
+                     sqrt(temp)/s0/(machEps*sampled));
+               primme->stats.orthoLossFactor = max(
+                     primme->stats.orthoLossFactor, lossFactor);
+            }
          }
-         
+
+         /* With primme_orth_adaptive, a pass leaves a loss of orthogonality */
+         /* of about machEps*s0/s1 times lossFactor, which also accounts for */
+         /* the loss of the basis. If Daniel et al. test asks for another    */
+         /* pass but that loss is below lossTol, the vector is accepted      */
+         /* without it. The first candidate in every call and every          */
+         /* ORTHO_SAMPLE_PERIOD after it do the second pass anyway to        */
+         /* measure the loss                                                 */
+
+         int relax = 0;          // flag to accept without reorthogonalizing
+         int sample = 0;         // flag to measure the loss in the next pass
+         if (adaptive && nOrth == 1 && s1 <= tol*s0 && s1 > machEps*s0) {
+            if (numCandidates++ % ORTHO_SAMPLE_PERIOD == 0
+                  || lossFactor <= 0.0) {
+               sample = 1;
+            }
+            else {
+               relax = (lossFactor*machEps*s0 <= lossTol*s1);
+            }
+         }
+
          /* If s1 decreased too much, its implicit computation may have       */
-         /* problem. Compute s1 explicitly in that cases                      */
+         /* problem. Compute s1 explicitly in that cases. With lowsync, do    */
+         /* another pass instead, which reduces s1 with its overlaps          */
          
          int s1_update = 0;      // flag if s1 has been computed explicitly
-         if ( s1 < s0*sqrt(machEps) || nOrth > 1 || !primme) {  
+         pending = lowsync && s1 < s0*sqrt(machEps);
+         if (!lowsync &&
+               (s1 < s0*sqrt(machEps) || nOrth > 1 || !primme || relax)) {  
             if (B) {
                CHKERR(B(&V[ldV*i], ldV, Bx, nLocal, 1, ctx), -1);
                Bx_update = 1;
@@ -295,23 +371,38 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
             CHKERR(globalSum_Rprimme(&temp, &s12, 1, primme), -1);
             s1 = sqrt(s12);
             s1_update = 1;
+            if (relax) {
+               relax = (lossFactor*machEps*s0 <= lossTol*s1);
+            }
          }
 
-         if (s1 <= machEps*s0) {
+         if (s1 <= machEps*s0 && !pending) {
             if (messages) {
                fprintf(primme->outputFile, 
                  "Vector %d lost all significant digits in ortho\n", i-b1);
             }
-            nOrth = maxNumOrthos;
+            nOrth = maxOrthos;
          }
-         else if (s1 <= tol*s0 || (!primme && nOrth < maxNumOrthos)) {
+         else if ((s1 <= tol*s0 && !relax)
+               || (!primme && nOrth < maxNumOrthos)) {
+            /* Allow another pass if this one kept more of the vector than  */
+            /* the previous one                                             */
+            if (adaptive && nOrth >= maxOrthos && maxOrthos < 7
+                  && s1 > ratio_prev*s0) {
+               maxOrthos++;
+            }
+            ratio_prev = s1/s0;
+            if (sample) sampled = s0/s1;
+
             /* No numerical benefit in normalizing the vector before reortho */
-            s0 = s1;
-            s02 = s12;
+            if (!pending) {
+               s0 = s1;
+               s02 = s12;
+            }
          }
          else {
             if (updateR) {
-               if (!s1_update) {
+               if (!s1_update && !lowsync) {
                   if (B && !Bx_update) {
                      CHKERR(B(&V[ldV*i], ldV, Bx, nLocal, 1, ctx), -1);
                   }
@@ -333,13 +424,14 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
                   fprintf(primme->outputFile, 
                         "Vector %d lost all significant digits in ortho\n", i-b1);
                }
-               nOrth = maxNumOrthos;
+               nOrth = maxOrthos;
             }
          } 
       }
    }
 
-   if (primme) primme->stats.timeOrtho += primme_wTimer(0) - t0;
+   if (primme) primme->stats.timeOrtho += primme_get_wtime() - t0;
+   if (primme) primme_trace_record(primme->trace, PRIMME_TRACE_ORTHO, t0);
 
    /* Check orthogonality */
    /*
@@ -377,16 +469,465 @@ static int Bortho_gen_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R, int ldR,
    return 0;
 }
 
+/**********************************************************************
+ * Function Bortho_block - This routine orthonormalizes the block of
+ * vectors V(:,b1:b2) against V(:,0:b1-1) and locked, and among themselves,
+ * with two passes of block classical Gram-Schmidt, each one followed by a
+ * Cholesky QR (BCGS2). Each pass computes the projections of the block on
+ * the other vectors and the Gram matrix of the block with BLAS-3 and reduces
+ * all of them with a single globalSum, so only two global reductions are
+ * performed per block.
+ *
+ * The Gram matrix of the projected block is computed implicitly as
+ * X'X - C'C, with C the projections. If the block is (numerically) rank
+ * deficient, the implicit Gram matrix is not accurate, or the Cholesky
+ * factorization fails, the remaining work is done by Bortho_gen, which
+ * reorthogonalizes vector by vector and randomizes the columns that
+ * lost all significant digits.
+ *
+ * The input and output arguments are the same as in Bortho_gen.
+ *
+ **********************************************************************/
+
+static int Bortho_block_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R,
+      int ldR, int b1, int b2, SCALAR *locked, PRIMME_INT ldLocked,
+      int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
+      SCALAR *rwork, size_t *rworkSize, primme_params *primme) {
+
+   int i, j, pass;          /* Loop indices */
+   int k = b2-b1+1;         /* block size */
+   int nQ = b1 + numLocked; /* number of vectors to orthogonalize against */
+   int ldC = nQ + k;        /* leading dimension of C */
+   double tol = sqrt(2.0L)/2.0L; /* Daniel et al. test as in Bortho_gen */
+   int fallback = 0;        /* flag to finish with Bortho_gen */
+   double t0;
+   size_t localrworkSize = *rworkSize; // local rworkSize
+
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      size_t rworkSize0 = 0;
+      CHKERR(Bortho_gen_Sprimme(NULL, ldV, NULL, ldR, b1, b2, NULL, ldLocked,
+               numLocked, 0, nLocal, NULL, NULL, iseed, machEps, NULL,
+               &rworkSize0, primme), -1);
+      *rworkSize = max(*rworkSize,
+            // C = [V(:,0:b1-1) locked X]'*X and the norms of X
+            (size_t)ldC*k + k +
+            // copy of R(0:b2,b1:b2) for the fallback
+            (size_t)(b2+1)*k +
+            // padding for the workspace allocations
+            3 + rworkSize0);
+      return 0;
+   }
+
+   /*----------------------------------*/
+   /* input and workspace verification */
+   /*----------------------------------*/
+   assert(nLocal >= 0 && numLocked >= 0 && b1 <= b2 &&
+          ldV >= nLocal && (numLocked == 0 || ldLocked >= nLocal) &&
+          (R == NULL || ldR > b2));
+
+   t0 = primme_get_wtime();
+
+   SCALAR *C, *X = &V[ldV*b1];
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)ldC*k, &C, &rwork, &localrworkSize), -1);
+   SCALAR *G = &C[nQ];      /* Gram matrix of X, G = X'*X */
+   REAL *normsX;
+   CHKERR(WRKSP_MALLOC_PRIMME(k, &normsX, &rwork, &localrworkSize), -1);
+   SCALAR *R0 = NULL;
+   CHKERR(WRKSP_MALLOC_PRIMME(R?(b2+1)*k:0, &R0, &rwork, &localrworkSize),
+         -1);
+
+   /* R(0:b1-1,b1:b2) = 0 and R(b1:b2,b1:b2) = I. Invariant along the       */
+   /* passes: input X = V(:,0:b1-1)*R(0:b1-1,b1:b2) + X*R(b1:b2,b1:b2)      */
+
+   if (R) {
+      Num_zero_matrix_Sprimme(&R[ldR*b1], b2+1, k, ldR);
+      for (i=b1; i <= b2; i++) R[ldR*i+i] = 1.0;
+   }
+
+   for (pass=0; pass < 2 && !fallback; pass++) {
+      int info;
+
+      /* C = [V(:,0:b1-1) locked X]'*X */
+
+      if (b1 > 0) {
+         Num_gemm_Sprimme("C", "N", b1, k, nLocal, 1.0, V, ldV, X, ldV, 0.0,
+               C, ldC);
+      }
+      if (numLocked > 0) {
+         CHKERR(Num_gemm_locked_Sprimme("C", numLocked, k, 1.0, locked,
+                  ldLocked, X, ldV, 0.0, &C[b1], ldC, primme), -1);
+      }
+      Num_gemm_Sprimme("C", "N", k, k, nLocal, 1.0, X, ldV, X, ldV, 0.0, G,
+            ldC);
+      primme->stats.numOrthoInnerProds += (double)ldC*k;
+      CHKERR(globalSum_Sprimme(C, C, ldC*k, primme), -1);
+
+      /* X = X - [V(:,0:b1-1) locked]*C(0:nQ-1,:) */
+
+      if (numLocked > 0) { /* locked array most recently accessed */
+         CHKERR(Num_gemm_locked_Sprimme("N", numLocked, k, -1.0, locked,
+                  ldLocked, &C[b1], ldC, 1.0, X, ldV, primme), -1);
+      }
+      if (b1 > 0) {
+         Num_gemm_Sprimme("N", "N", nLocal, k, b1, -1.0, V, ldV, C, ldC, 1.0,
+               X, ldV);
+      }
+      primme->stats.numOrthoInnerProds += (double)nQ*k;
+
+      /* R(0:b1-1,b1:b2) += C(0:b1-1,:)*R(b1:b2,b1:b2) */
+
+      if (R && b1 > 0) {
+         Num_gemm_Sprimme("N", "N", b1, k, k, 1.0, C, ldC, &R[ldR*b1+b1], ldR,
+               1.0, &R[ldR*b1], ldR);
+      }
+
+      /* G = G - C(0:nQ-1,:)'*C(0:nQ-1,:), the Gram matrix of the new X */
+
+      for (i=0; i < k; i++) normsX[i] = REAL_PART(G[ldC*i+i]);
+      Num_gemm_Sprimme("C", "N", k, k, nQ, -1.0, C, ldC, C, ldC, 1.0, G, ldC);
+
+      /* Check that the implicit computation of G is accurate enough. In the */
+      /* first pass the implicit norms should keep at least half of the      */
+      /* significant digits; in the second pass the vectors should be nearly */
+      /* orthogonal to the others, following Daniel's test.                  */
+
+      for (i=0; i < k; i++) {
+         REAL s12 = REAL_PART(G[ldC*i+i]);
+         if (!(s12 > (pass == 0 ? sqrt(machEps) : tol*tol)*normsX[i])) break;
+      }
+      if (i < k) {
+         fallback = 1;
+         break;
+      }
+
+      /* G = U'*U; X = X/U */
+
+      Num_potrf_Sprimme("U", k, G, ldC, &info);
+      if (info != 0) {
+         fallback = 1;
+         break;
+      }
+      Num_trsm_Sprimme("R", "U", "N", "N", nLocal, k, 1.0, G, ldC, X, ldV);
+
+      /* R(b1:b2,b1:b2) = U*R(b1:b2,b1:b2) */
+
+      if (R) {
+         Num_trmm_Sprimme("L", "U", "N", "N", k, k, 1.0, G, ldC,
+               &R[ldR*b1+b1], ldR);
+      }
+   }
+
+   primme->stats.timeOrtho += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_ORTHO, t0);
+
+   if (!fallback) return 0;
+
+   if (primme->procID == 0 && primme->printLevel >= 3 && primme->outputFile) {
+      fprintf(primme->outputFile,
+            "Block ortho of vectors %d:%d switched to vector by vector\n",
+            b1, b2);
+   }
+
+   /* Orthogonalize vector by vector the current X. Bortho_gen returns      */
+   /* R(0:b2,b1:b2) such that X = V(:,0:b2)*R(0:b2,b1:b2), so the final R   */
+   /* is R(0:b1-1,:) = R0(0:b1-1,:) + R(0:b1-1,:)*R0(b1:b2,:) and           */
+   /* R(b1:b2,:) = R(b1:b2,:)*R0(b1:b2,:), where R0 is the current R.       */
+
+   if (R) {
+      Num_copy_matrix_Sprimme(&R[ldR*b1], b2+1, k, ldR, R0, b2+1);
+   }
+   CHKERR(Bortho_gen_Sprimme(V, ldV, R, ldR, b1, b2, locked, ldLocked,
+            numLocked, 0, nLocal, NULL, NULL, iseed, machEps, rwork,
+            &localrworkSize, primme), -1);
+   if (R) {
+      if (b1 > 0) {
+         Num_gemm_Sprimme("N", "N", b1, k, k, 1.0, &R[ldR*b1], ldR, &R0[b1],
+               b2+1, 1.0, R0, b2+1);
+         Num_copy_matrix_Sprimme(R0, b1, k, b2+1, &R[ldR*b1], ldR);
+      }
+      for (i=b1; i <= b2; i++)
+         for (j=i+1; j <= b2; j++)
+            R[ldR*i+j] = 0.0;
+      Num_trmm_Sprimme("R", "U", "N", "N", k, k, 1.0, &R0[b1], b2+1,
+            &R[ldR*b1+b1], ldR);
+   }
+
+   return 0;
+}
+
+/**********************************************************************
+ * Function Bortho_project_locked - This routine removes from the block
+ * of vectors X the components on the locked vectors with two passes of
+ * block classical Gram-Schmidt. Each pass computes the projections and
+ * the norms of X with BLAS-3 and a single globalSum, instead of a gemv
+ * and a reduction per vector as in Bortho_gen.
+ *
+ * The output flag done is set if every vector kept enough significant
+ * digits in both passes (Daniel's test in the second one), so X is
+ * orthogonal to locked to working precision. Otherwise Bortho_gen should
+ * orthogonalize X against locked again.
+ *
+ * k is the number of columns of X; the rest of the arguments are the same
+ * as in Bortho_gen.
+ *
+ **********************************************************************/
+
+static int Bortho_project_locked_Sprimme(SCALAR *X, PRIMME_INT ldX, int k,
+      SCALAR *locked, PRIMME_INT ldLocked, int numLocked, PRIMME_INT nLocal,
+      double machEps, SCALAR *rwork, size_t *rworkSize, int *done,
+      primme_params *primme) {
+
+   int i, j, j0, pass;      /* Loop indices */
+   int ldC = numLocked + 1; /* leading dimension of C */
+   double tol = sqrt(2.0L)/2.0L; /* Daniel et al. test as in Bortho_gen */
+   double t0;
+   size_t localrworkSize = *rworkSize; // local rworkSize
+
+   /* Return memory requirement */
+
+   if (X == NULL) {
+      *rworkSize = max(*rworkSize,
+            // C = [locked X]'*X, only the diagonal of X'*X
+            (size_t)ldC*k + 2);
+      return 0;
+   }
+
+   assert(nLocal >= 0 && numLocked > 0 && ldX >= nLocal &&
+          ldLocked >= nLocal);
+
+   /* Process X in chunks of columns that fit in the workspace. If not even */
+   /* one column fits, leave the work to Bortho_gen                         */
+
+   int kc = (int)min((size_t)k,
+         localrworkSize > 2 ? (localrworkSize-2)/ldC : 0);
+   *done = 0;
+   if (kc < 1) return 0;
+
+   t0 = primme_get_wtime();
+
+   SCALAR *C;
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)ldC*kc, &C, &rwork, &localrworkSize),
+         -1);
+
+   *done = 1;
+   for (j0=0; j0 < k && *done; j0+=kc) {
+      int n = min(kc, k-j0);
+      SCALAR *Xj = &X[ldX*j0];
+
+      for (pass=0; pass < 2 && *done; pass++) {
+
+         /* C(0:numLocked-1,:) = locked'*X and C(numLocked,j) = X(:,j)'*X(:,j) */
+
+         CHKERR(Num_gemm_locked_Sprimme("C", numLocked, n, 1.0, locked,
+                  ldLocked, Xj, ldX, 0.0, C, ldC, primme), -1);
+         for (j=0; j < n; j++) {
+            C[ldC*j+numLocked] = Num_dot_Sprimme(nLocal, &Xj[ldX*j], 1,
+                  &Xj[ldX*j], 1);
+         }
+         primme->stats.numOrthoInnerProds += (double)ldC*n;
+         CHKERR(globalSum_Sprimme(C, C, ldC*n, primme), -1);
+
+         /* X = X - locked*C(0:numLocked-1,:) */
+
+         CHKERR(Num_gemm_locked_Sprimme("N", numLocked, n, -1.0, locked,
+                  ldLocked, C, ldC, 1.0, Xj, ldX, primme), -1);
+         primme->stats.numOrthoInnerProds += (double)numLocked*n;
+
+         /* Check the implicit norms of the projected vectors as in */
+         /* Bortho_block                                             */
+
+         for (i=0; i < n; i++) {
+            REAL s02 = REAL_PART(C[ldC*i+numLocked]);
+            REAL s12 = s02 - REAL_PART(Num_dot_Sprimme(numLocked, &C[ldC*i],
+                     1, &C[ldC*i], 1));
+            if (!(s12 > (pass == 0 ? sqrt(machEps) : tol*tol)*s02)) {
+               *done = 0;
+               break;
+            }
+         }
+      }
+   }
+
+   primme->stats.timeOrtho += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_ORTHO, t0);
+
+   return 0;
+}
+
 TEMPLATE_PLEASE
 int ortho_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *R,
       int ldR, int b1, int b2, SCALAR *locked, PRIMME_INT ldLocked,
       int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
       SCALAR *rwork, size_t *rworkSize, primme_params *primme) {
 
+   /* Use block Gram-Schmidt only if requested and it is a distributed      */
+   /* orthogonalization (primme is given)                                   */
+
+   if (primme && primme->orth == primme_orth_block && b2 >= b1) {
+      return Bortho_block_Sprimme(V, ldV, R, ldR, b1, b2, locked, ldLocked,
+            numLocked, nLocal, iseed, machEps, rwork, rworkSize, primme);
+   }
+
+   /* With batched locking, streamed locked vectors or a single precision */
+   /* copy of them, project the block against the locked vectors with      */
+   /* matrix-matrix products first; then Bortho_gen only uses locked for   */
+   /* the vectors that it replaces by random vectors.                      */
+
+   int lockedDone = 0;
+   if (primme && (primme->lockingBatchSize > 0 || primme->lockedPanelSize > 0
+            || primme->lockedCopy) && numLocked > 0 && b2 >= b1) {
+      if (V == NULL) {
+         CHKERR(Bortho_project_locked_Sprimme(NULL, ldV, b2-b1+1, NULL,
+                  ldLocked, numLocked, nLocal, machEps, NULL, rworkSize, NULL,
+                  primme), -1);
+      }
+      else {
+         CHKERR(Bortho_project_locked_Sprimme(&V[ldV*b1], ldV, b2-b1+1,
+                  locked, ldLocked, numLocked, nLocal, machEps, rwork,
+                  rworkSize, &lockedDone, primme), -1);
+      }
+   }
+
    return Bortho_gen_Sprimme(V, ldV, R, ldR, b1, b2, locked, ldLocked,
-         numLocked, nLocal, NULL, NULL, iseed, machEps, rwork, rworkSize,
-         primme);
+         numLocked, lockedDone, nLocal, NULL, NULL, iseed, machEps, rwork,
+         rworkSize, primme);
+
+}
 
+/**********************************************************************
+ * Function ortho_B - This routine B-orthonormalizes the vectors
+ * V(:,b1:b2) against V(:,0:b1-1) and among themselves, where B is
+ * the mass matrix given by massMatrixMatvec, and sets BV(:,b1:b2).
+ *
+ * The products BV(:,0:b1-1) must be given. The projections of the
+ * current vector are computed as BV(:,0:i-1)'*V(:,i), and BV(:,i) is
+ * updated with the same linear combination as V(:,i), so B is applied
+ * only once per vector, except for the vectors replaced by random ones.
+ *
+ * If BV is NULL, the projections are computed as V(:,0:i-1)'*B*V(:,i),
+ * and B is applied again to V(:,i) in every pass.
+ *
+ * The input and output arguments are the same as in ortho, with
+ * BV       B*V (optional)
+ * ldBV     The leading dimension of BV
+ *
+ **********************************************************************/
+
+TEMPLATE_PLEASE
+int ortho_B_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *BV, PRIMME_INT ldBV,
+      int b1, int b2, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
+      SCALAR *rwork, size_t *rworkSize, primme_params *primme) {
+
+   int i;                   /* Loop index */
+   int maxNumOrthos = 3;    /* We let 2 reorthogonalizations before randomize */
+   int maxNumRandoms = 10;  /* We do not allow more than 10 randomizations */
+   double tol = sqrt(2.0L)/2.0L; /* We set Daniel et al. test to .707 */
+   int messages;
+   double t0;
+
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      *rworkSize = max(*rworkSize, (size_t)(b2+1) +
+            (primme->massMatrixCache ? 0 : (size_t)nLocal));
+      return 0;
+   }
+
+   assert(nLocal >= 0 && ldV >= nLocal && (!BV || ldBV >= nLocal) &&
+          *rworkSize >= (size_t)(b2+1) + (BV ? 0 : (size_t)nLocal));
+
+   messages = (primme->procID == 0 && primme->printLevel >= 3
+         && primme->outputFile);
+
+   t0 = primme_get_wtime();
+
+   SCALAR *overlaps = rwork;
+   SCALAR *Bv = rwork + b2 + 1;  /* B*V(:,i) if BV is not given */
+
+   for(i=b1; i <= b2; i++) {
+
+      int nOrth, randomizations;
+      REAL s0, s02, s1, s12;
+      SCALAR *Bvi = BV ? &BV[ldBV*i] : Bv;
+
+      CHKERR(massMatrixMatvec_Sprimme(&V[ldV*i], nLocal, ldV, Bvi, nLocal, 0,
+               1, primme), -1);
+
+      for (nOrth=0, randomizations=0; ; ) {
+
+         if (nOrth >= maxNumOrthos) {
+            if (randomizations >= maxNumRandoms) {
+               return -3;
+            }
+            if (messages){
+               fprintf(primme->outputFile, "Randomizing in ortho_B: %d, vector size of %" PRIMME_INT_P "\n", i, nLocal);
+            }
+
+            Num_larnv_Sprimme(2, iseed, nLocal, &V[ldV*i]);
+            CHKERR(massMatrixMatvec_Sprimme(&V[ldV*i], nLocal, ldV, Bvi,
+                     nLocal, 0, 1, primme), -1);
+            randomizations++;
+            nOrth = 0;
+         }
+         else if (nOrth > 0 && !BV) {
+            CHKERR(massMatrixMatvec_Sprimme(&V[ldV*i], nLocal, ldV, Bvi,
+                     nLocal, 0, 1, primme), -1);
+         }
+
+         nOrth++;
+
+         // Compute overlaps = [BV[0:i-1]'*V[i]; V[i]'*BV[i]] with a single
+         // reduction, or V[0:i-1]'*BV[i] if BV is not given
+
+         if (i > 0 && BV) {
+            Num_gemv_Sprimme("C", nLocal, i, 1.0, BV, ldBV, &V[ldV*i], 1, 0.0,
+                  overlaps, 1);
+         }
+         else if (i > 0) {
+            Num_gemv_Sprimme("C", nLocal, i, 1.0, V, ldV, Bvi, 1, 0.0,
+                  overlaps, 1);
+         }
+         overlaps[i] = Num_dot_Sprimme(nLocal, &V[ldV*i], 1, Bvi, 1);
+         primme->stats.numOrthoInnerProds += i+1;
+         CHKERR(globalSum_Sprimme(overlaps, overlaps, i+1, primme), -1);
+
+         // V[i] = V[i] - V[0:i-1]*overlaps and BV[i] = BV[i] - BV[0:i-1]*overlaps
+
+         if (i > 0) {
+            Num_gemv_Sprimme("N", nLocal, i, -1.0, V, ldV, overlaps, 1, 1.0,
+                  &V[ldV*i], 1);
+            if (BV) Num_gemv_Sprimme("N", nLocal, i, -1.0, BV, ldBV, overlaps,
+                  1, 1.0, Bvi, 1);
+            primme->stats.numOrthoInnerProds += i;
+         }
+
+         // Compute the B-norm of the resulting vector implicitly
+
+         s0 = sqrt(s02 = max((REAL)0.0, REAL_PART(overlaps[i])));
+         s12 = s02 - REAL_PART(Num_dot_Sprimme(i, overlaps, 1, overlaps, 1));
+         s1 = sqrt(s12 = max((REAL)0.0, s12));
+
+         if (s1 <= machEps*s0 || !ISFINITE((REAL)(1.0/s1))) {
+            if (messages) {
+               fprintf(primme->outputFile,
+                 "Vector %d lost all significant digits in ortho_B\n", i-b1);
+            }
+            nOrth = maxNumOrthos;
+         }
+         else if (s1 > tol*s0) {
+            Num_scal_Sprimme(nLocal, 1.0/s1, &V[ldV*i], 1);
+            if (BV) Num_scal_Sprimme(nLocal, 1.0/s1, Bvi, 1);
+            break;
+         }
+      }
+   }
+
+   primme->stats.timeOrtho += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_ORTHO, t0);
+
+   return 0;
 }
 
 struct local_matvec_ctx { SCALAR *B; int n, ldB; };
@@ -409,7 +950,7 @@ int Bortho_local_Sprimme(SCALAR *V, int ldV, SCALAR *R,
    (void)primme;
    struct local_matvec_ctx ctx = {B, nLocal, ldB};
    return Bortho_gen_Sprimme(V, ldV, R, ldR, b1, b2, locked, ldLocked,
-         numLocked, nLocal, B?local_matvec:NULL, &ctx, iseed, machEps, rwork,
+         numLocked, 0, nLocal, B?local_matvec:NULL, &ctx, iseed, machEps, rwork,
          rworkSize, NULL);
 
 }
@@ -450,7 +991,7 @@ int ortho_single_iteration_Sprimme(SCALAR *Q, PRIMME_INT mQ, PRIMME_INT nQ,
       return 0;
    }
 
-   double t0 = primme_wTimer(0);
+   double t0 = primme_get_wtime();
 
    assert((size_t)nQ*nX*2 + (size_t)m*nX <= *lrwork);
 
@@ -518,7 +1059,8 @@ int ortho_single_iteration_Sprimme(SCALAR *Q, PRIMME_INT mQ, PRIMME_INT nQ,
       primme->stats.numOrthoInnerProds += nX;
    }
 
-   primme->stats.timeOrtho += primme_wTimer(0) - t0;
+   primme->stats.timeOrtho += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_ORTHO, t0);
 
    return 0;
 }
@@ -43,6 +43,15 @@ int ortho_dprimme(double *V, PRIMME_INT ldV, double *R,
       int ldR, int b1, int b2, double *locked, PRIMME_INT ldLocked,
       int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
       double *rwork, size_t *rworkSize, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(ortho_B_Sprimme)
+#  define ortho_B_Sprimme CONCAT(ortho_B_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(ortho_B_Rprimme)
+#  define ortho_B_Rprimme CONCAT(ortho_B_,REAL_SUF)
+#endif
+int ortho_B_dprimme(double *V, PRIMME_INT ldV, double *BV, PRIMME_INT ldBV,
+      int b1, int b2, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
+      double *rwork, size_t *rworkSize, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(Bortho_local_Sprimme)
 #  define Bortho_local_Sprimme CONCAT(Bortho_local_,SCALAR_SUF)
 #endif
@@ -67,6 +76,9 @@ int ortho_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV, PRIMME_COMPLEX_DOUBL
       int ldR, int b1, int b2, PRIMME_COMPLEX_DOUBLE *locked, PRIMME_INT ldLocked,
       int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
       PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, primme_params *primme);
+int ortho_B_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *BV, PRIMME_INT ldBV,
+      int b1, int b2, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
+      PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, primme_params *primme);
 int Bortho_local_zprimme(PRIMME_COMPLEX_DOUBLE *V, int ldV, PRIMME_COMPLEX_DOUBLE *R,
       int ldR, int b1, int b2, PRIMME_COMPLEX_DOUBLE *locked, int ldLocked,
       int numLocked, int nLocal, PRIMME_COMPLEX_DOUBLE *B, int ldB, PRIMME_INT *iseed,
@@ -79,6 +91,9 @@ int ortho_sprimme(float *V, PRIMME_INT ldV, float *R,
       int ldR, int b1, int b2, float *locked, PRIMME_INT ldLocked,
       int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
       float *rwork, size_t *rworkSize, primme_params *primme);
+int ortho_B_sprimme(float *V, PRIMME_INT ldV, float *BV, PRIMME_INT ldBV,
+      int b1, int b2, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
+      float *rwork, size_t *rworkSize, primme_params *primme);
 int Bortho_local_sprimme(float *V, int ldV, float *R,
       int ldR, int b1, int b2, float *locked, int ldLocked,
       int numLocked, int nLocal, float *B, int ldB, PRIMME_INT *iseed,
@@ -91,6 +106,9 @@ int ortho_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT
       int ldR, int b1, int b2, PRIMME_COMPLEX_FLOAT *locked, PRIMME_INT ldLocked,
       int numLocked, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
       PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, primme_params *primme);
+int ortho_B_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *BV, PRIMME_INT ldBV,
+      int b1, int b2, PRIMME_INT nLocal, PRIMME_INT *iseed, double machEps,
+      PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, primme_params *primme);
 int Bortho_local_cprimme(PRIMME_COMPLEX_FLOAT *V, int ldV, PRIMME_COMPLEX_FLOAT *R,
       int ldR, int b1, int b2, PRIMME_COMPLEX_FLOAT *locked, int ldLocked,
       int numLocked, int nLocal, PRIMME_COMPLEX_FLOAT *B, int ldB, PRIMME_INT *iseed,
@@ -58,6 +58,7 @@
 #include <stdio.h>    
 #include "const.h"
 #include "wtime.h"
+#include "trace.h"
 #include "numerical.h"
 #include "main_iter.h"
 #include "init.h"
@@ -66,13 +67,37 @@
 #include "restart.h"
 #include "correction.h"
 #include "update_projection.h"
+#include "update_W.h"
+#include "globalsum.h"
 #include "primme_interface.h"
 
 #define ALLOCATE_WORKSPACE_FAILURE -1
 #define MALLOC_FAILURE             -2
 #define MAIN_ITER_FAILURE          -3
 
+static int primme_solve(REAL *evals, SCALAR *evecs, REAL *resNorms, 
+            primme_params *primme);
 static int allocate_workspace(primme_params *primme, int allocate);
+static int plan_config(primme_preset_method method, primme_params *primme,
+      int maxBlockSize, int maxBasisSize, int locking, primme_params *p);
+static int plan_fits(primme_params *p, size_t memory);
+static int plan_set(primme_preset_method method, primme_params *primme,
+      primme_params *p);
+static int dos_bounds(SCALAR *Q, PRIMME_INT ldQ, int steps, double *bounds,
+      REAL *T, primme_params *primme);
+static int dos_moments(SCALAR *X, PRIMME_INT ldX, int numVectors, int degree,
+      double *bounds, REAL *mu, primme_params *primme);
+static void reset_iseed(primme_params *primme);
+static int evals_only_solve(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      primme_params *primme);
+static void add_stats(primme_stats *stats, primme_stats *stats1);
+#ifdef USE_LOWER_INNER
+static int cascade_solve(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      primme_params *primme);
+static int locked_single_solve(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      primme_params *primme);
+#endif
+static int stats_imbalance(primme_params *primme);
 static int check_input(REAL *evals, SCALAR *evecs, REAL *resNorms,
                        primme_params *primme);
 static void convTestFunAbsolute(double *eval, void *evec, double *rNorm, int *isConv,
@@ -100,7 +125,8 @@ static void default_monitor(void *basisEvals, int *basisSize, int *basisFlags,
  *        primme->numEvals.
  * 
  * evecs  The local portions of the converged Ritz vectors.  The dimension of
- *        the array is at least primme->nLocal*primme->numEvals
+ *        the array is at least primme->nLocal*primme->numEvals, or
+ *        nLocal*(numOrthoConst+min(numEvals,maxBasisSize)) with evalsOnly
  *
  * resNorms  The residual norms of the converged Ritz vectors.  Should be of 
  *           size primme->numEvals
@@ -122,15 +148,659 @@ static void default_monitor(void *basisEvals, int *basisSize, int *basisFlags,
  
 int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms, 
             primme_params *primme) {
+
+   int ret;
+
+   /* The tracer is created by primme_solve unless the caller (e.g.,     */
+   /* Sprimme_svds) has set one, which is then written out by the caller */
+
+   int ownTrace = (primme->trace == NULL);
+
+#ifdef _OPENMP
+   /* Set the number of threads for the parallel regions in PRIMME and in */
+   /* the callbacks, and restore the caller's value before returning      */
+
+   int numThreads0 = omp_get_max_threads();
+   if (primme->numThreads > 0) omp_set_num_threads(primme->numThreads);
+   ret = primme_solve(evals, evecs, resNorms, primme);
+   omp_set_num_threads(numThreads0);
+#else
+   ret = primme_solve(evals, evecs, resNorms, primme);
+#endif
+
+   if (ret == 0 && primme->statsImbalance) {
+      ret = stats_imbalance(primme);
+   }
+
+   if (ownTrace && primme->trace) {
+      if (primme_trace_dump(primme->trace, primme->traceFileName,
+               primme->procID, primme->numProcs) != 0
+            && primme->printLevel > 0 && primme->outputFile) {
+         fprintf(primme->outputFile, "PRIMME: Warning: the trace could not "
+               "be written to '%s'\n", primme->traceFileName);
+      }
+      primme_trace_free(&primme->trace);
+   }
+
+   return ret;
+}
+
+
+/*******************************************************************************
+ * Subroutine Sprimme_batch - Solves numProblems independent eigenproblems.
+ *    The problems are handed out one at a time to the OpenMP threads, so a
+ *    thread that finishes early takes the next pending problem. Every thread
+ *    keeps a real and an integer workspace that is lent to the problems it
+ *    solves and is only reallocated when a problem needs more.
+ *
+ *    Every problem is solved with primme[i].numThreads threads, or with one
+ *    if it is zero. Problems that provide their own realWork or intWork, or
+ *    that ask for warmStart, keep using their own workspace.
+ *
+ * INPUT/OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------------
+ * evals, evecs, resNorms  Arrays with the arguments of Sprimme for every
+ *                         problem
+ * primme       Array with the structures of the problems
+ * numProblems  Number of problems
+ * rets         If not NULL, the value returned by Sprimme for every problem
+ *
+ * Return Value
+ * ------------
+ *  0 - All problems were solved
+ *  Otherwise, the value returned by Sprimme for the first problem that failed
+ *
+ ******************************************************************************/
+
+int Sprimme_batch(REAL **evals, SCALAR **evecs, REAL **resNorms,
+      primme_params *primme, int numProblems, int *rets) {
+
+   int i;
+   int firstFailed = numProblems;   /* Index of the first failed problem */
+   int firstRet = 0;                /* and the value it returned         */
+
+   OMP_PRAGMA(omp parallel)
+   {
+      void *realWork = NULL;        /* This thread's workspaces */
+      void *intWork = NULL;
+      size_t realWorkSize = 0;
+      int intWorkSize = 0;
+
+      OMP_PRAGMA(omp for schedule(dynamic, 1))
+      for (i=0; i<numProblems; i++) {
+         primme_params *p = &primme[i];
+         int numThreads0 = p->numThreads;
+         int lend = !p->realWork && !p->intWork && !p->warmStart;
+         int ret;
+
+         if (p->numThreads <= 0) p->numThreads = 1;
+         if (p->numProcs <= 1) p->nLocal = p->n;
+
+         /* Lend the thread's workspace if it is large enough, or grow it */
+
+         if (lend && Sprimme(NULL, NULL, NULL, p) == 1) {
+            if (p->realWorkSize > realWorkSize) {
+               free(realWork);
+               realWorkSize = 0;
+               if (Num_malloc_workspace_primme(p->realWorkSize, &realWork)
+                     == 0) {
+                  realWorkSize = p->realWorkSize;
+               }
+               else {
+                  realWork = NULL;
+               }
+            }
+            if (p->intWorkSize > intWorkSize) {
+               free(intWork);
+               intWork = malloc(p->intWorkSize);
+               intWorkSize = intWork ? p->intWorkSize : 0;
+            }
+            if (realWork && intWork) {
+               p->realWork = realWork;
+               p->realWorkSize = realWorkSize;
+               p->intWork = intWork;
+               p->intWorkSize = intWorkSize;
+            }
+            else {
+               lend = 0;
+            }
+         }
+         else {
+            lend = 0;
+         }
+
+         ret = Sprimme(evals[i], evecs[i], resNorms[i], p);
+
+         if (lend) {
+            p->realWork = NULL;
+            p->realWorkSize = 0;
+            p->intWork = NULL;
+            p->intWorkSize = 0;
+         }
+         p->numThreads = numThreads0;
+
+         if (rets) rets[i] = ret;
+         if (ret != 0) {
+            OMP_PRAGMA(omp critical)
+            if (i < firstFailed) {
+               firstFailed = i;
+               firstRet = ret;
+            }
+         }
+      }
+
+      free(realWork);
+      free(intWork);
+   }
+
+   return firstRet;
+}
+
+
+/*******************************************************************************
+ * Subroutine Sprimme_plan - Set the method as primme_set_method does, and
+ *    choose maxBlockSize, maxBasisSize, minRestartSize and locking so that
+ *    the workspace (realWorkSize plus intWorkSize) takes at most memory bytes.
+ *
+ *    The fields set by the user are kept: maxBasisSize and minRestartSize if
+ *    they are positive, and locking if it is not negative. The block size is
+ *    chosen up to maxBlockSize if it is larger than one, or up to
+ *    min(numEvals, PRIMME_PLAN_MAX_BLOCK) otherwise.
+ *
+ *    The plan prefers, in this order, soft locking (as primme_set_defaults
+ *    does for extreme eigenvalues), the basis size that the method would
+ *    choose for the block size, and the largest block size. If no block size
+ *    fits with that basis, the largest basis that fits with a block size of
+ *    one is chosen.
+ *
+ * INPUT/OUTPUT PARAMETERS
+ * -----------------------
+ * memory  Bytes available for the workspace
+ * method  The preset method, as in primme_set_method
+ * primme  Structure with n, nLocal, numEvals and target set; on success, the
+ *         chosen fields and the method are set
+ *
+ * Return Value
+ * ------------
+ *  0 - Success
+ * -36 - No configuration fits in memory
+ *
+ ******************************************************************************/
+
+int Sprimme_plan(size_t memory, primme_preset_method method,
+      primme_params *primme) {
+
+   int l, nl, b, maxb, mb, mb0, mb1, mid;
+   int locks[2];
+   primme_params p;
+
+   /* Locking candidates */
+
+   nl = 0;
+   if (primme->locking >= 0) {
+      locks[nl++] = primme->locking;
+   }
+   else {
+      if (primme->massMatrixMatvec || primme->target == primme_smallest
+            || primme->target == primme_largest) {
+         locks[nl++] = 0;
+      }
+      if (!primme->massMatrixMatvec) locks[nl++] = 1;
+   }
+
+   /* Largest block size considered */
+
+   maxb = primme->maxBlockSize > 1 ? primme->maxBlockSize
+      : min(max(1, primme->numEvals), PRIMME_PLAN_MAX_BLOCK);
+
+   /* Take the basis size that primme_set_defaults would choose, from the */
+   /* largest block size down                                              */
+
+   for (l=0; l<nl; l++) {
+      for (b=maxb; b>=1; b--) {
+         if (plan_config(method, primme, b, primme->maxBasisSize, locks[l],
+                  &p) == 0 && plan_fits(&p, memory)) {
+            return plan_set(method, primme, &p);
+         }
+      }
+   }
+
+   /* Otherwise look for the largest basis that fits with a block size of */
+   /* one, if the user did not set it                                      */
+
+   if (primme->maxBasisSize > 0) return -36;
+   for (l=0; l<nl; l++) {
+      if (plan_config(method, primme, 1, 0, locks[l], &p) != 0) continue;
+      mb = 0;
+      mb0 = 2;
+      mb1 = p.maxBasisSize;
+      while (mb0 <= mb1) {
+         mid = mb0 + (mb1 - mb0)/2;
+         if (plan_config(method, primme, 1, mid, locks[l], &p) == 0
+               && plan_fits(&p, memory)) {
+            mb = mid;
+            mb0 = mid + 1;
+         }
+         else {
+            mb1 = mid - 1;
+         }
+      }
+      if (mb > 0) {
+         plan_config(method, primme, 1, mb, locks[l], &p);
+         return plan_set(method, primme, &p);
+      }
+   }
+
+   return -36;
+}
+
+/*******************************************************************************
+ * Subroutine plan_config - Set in p a copy of primme with the given block
+ *    size, basis size and locking, and the method. If maxBasisSize is zero,
+ *    it is chosen by primme_set_method; so is minRestartSize if primme does
+ *    not set it, but without locking it is at least numEvals.
+ *
+ * Return Value
+ * ------------
+ *  0 - Success
+ * -1 - The configuration is not valid
+ *
+ ******************************************************************************/
+
+static int plan_config(primme_preset_method method, primme_params *primme,
+      int maxBlockSize, int maxBasisSize, int locking, primme_params *p) {
+
+   *p = *primme;
+   p->maxBlockSize = maxBlockSize;
+   p->maxBasisSize = maxBasisSize;
+   p->locking = locking;
+   if (p->numProcs <= 1) p->nLocal = p->n;
+   if (primme_set_method(method, p) != 0) return -1;
+
+   /* Soft locking needs numEvals vectors to restart with */
+
+   if (!locking && primme->minRestartSize <= 0
+         && p->minRestartSize < p->numEvals) {
+      p->minRestartSize = min(p->numEvals, p->n);
+      if (maxBasisSize <= 0) {
+         p->maxBasisSize = min(p->n, max(p->maxBasisSize,
+                  p->minRestartSize + maxBlockSize
+                  + p->restartingParams.maxPrevRetain + 1));
+      }
+   }
+
+   /* Discard configurations rejected by check_input */
+
+   if (p->maxBasisSize < 2 || p->maxBasisSize > p->n
+         || p->minRestartSize < 1 || p->maxBlockSize > p->maxBasisSize
+         || (p->minRestartSize + p->restartingParams.maxPrevRetain
+            >= p->maxBasisSize && p->n > p->maxBasisSize)
+         || (!p->locking && p->minRestartSize < p->numEvals && p->n > 2)) {
+      return -1;
+   }
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine plan_fits - Return whether the workspace of p takes at most
+ *    memory bytes
+ ******************************************************************************/
+
+static int plan_fits(primme_params *p, size_t memory) {
+
+   primme_params q = *p;
+
+   q.realWork = NULL;
+   q.intWork = NULL;
+   if (primme_solve(NULL, NULL, NULL, &q) != 1) return 0;
+   return q.realWorkSize + (size_t)q.intWorkSize <= memory;
+}
+
+/*******************************************************************************
+ * Subroutine plan_set - Copy the fields chosen by the plan from p to primme
+ *    and set the method
+ ******************************************************************************/
+
+static int plan_set(primme_preset_method method, primme_params *primme,
+      primme_params *p) {
+
+   primme->maxBlockSize = p->maxBlockSize;
+   primme->maxBasisSize = p->maxBasisSize;
+   primme->minRestartSize = p->minRestartSize;
+   primme->locking = p->locking;
+   return primme_set_method(method, primme);
+}
+
+/*******************************************************************************
+ * Subroutine Sprimme_dos - Estimate the number of eigenvalues of A below
+ *    some points with the kernel polynomial method, using only block
+ *    products with A.
+ *
+ *    The bounds [a, b] of the spectrum are estimated with a few Lanczos
+ *    steps. Then the Chebyshev
+ *    moments mu_k = z'*T_k(B)*z / z'*z, B = (A - c*I)/e, c = (a+b)/2,
+ *    e = (b-a)/2, are averaged over numVectors random vectors z, and the
+ *    number of eigenvalues below x = c + e*cos(t) is
+ *
+ *       n*(g_0*mu_0*(pi-t)/pi - sum_{k=1}^degree 2*g_k*mu_k*sin(k*t)/(k*pi)),
+ *
+ *    with g_k the Jackson damping coefficients. The products with A are done
+ *    on the whole block of numVectors vectors, and the moments are added up
+ *    among processes with a single global sum.
+ *
+ * INPUT PARAMETERS
+ * ----------------
+ * points      Array of numPoints values
+ * numPoints   Number of values in points
+ * degree      Degree of the expansion; if not positive, PRIMME_DOS_DEGREE
+ * numVectors  Number of random vectors; if not positive, maxBlockSize if it
+ *             is larger than one, or PRIMME_DOS_VECTORS otherwise
+ * primme      Structure with n, matrixMatvec and, in parallel programs,
+ *             nLocal, numProcs, procID and globalSumReal set
+ *
+ * OUTPUT PARAMETERS
+ * -----------------
+ * counts      Array of numPoints values; counts[i] is the estimated number
+ *             of eigenvalues smaller than points[i]
+ * bounds      If not NULL, array of size two with the estimated smallest
+ *             and largest eigenvalues
+ *
+ * Return Value
+ * ------------
+ *  0 - Success
+ * -1 - Allocation failed, or matrixMatvec or globalSumReal returned an error
+ * -4 - primme is NULL
+ * -5 - n <= 0, nLocal < 0 or nLocal > n
+ * -7 - matrixMatvec is NULL
+ * -9 - massMatrixMatvec is set
+ *
+ ******************************************************************************/
+
+int Sprimme_dos(double *points, int numPoints, double *counts, double *bounds,
+      int degree, int numVectors, primme_params *primme) {
+
+   int i, k, steps, ret;
+   PRIMME_INT ldOPs;
+   double b[2], c, e, t, sum, g, pi = acos(-1.0);
+   PRIMME_INT ldX;
+   SCALAR *X;
+   REAL *mu;
+
+   if (primme == NULL) return -4;
+   if (primme->numProcs <= 1) {
+      primme->nLocal = primme->n;
+      primme->procID = 0;
+   }
+   if (primme->n <= 0 || primme->nLocal < 0 || primme->nLocal > primme->n)
+      return -5;
+   if (primme->matrixMatvec == NULL) return -7;
+   if (primme->massMatrixMatvec) return -9;
+   reset_iseed(primme);
+
+   if (degree <= 0) degree = PRIMME_DOS_DEGREE;
+   if (numVectors <= 0) {
+      numVectors = primme->maxBlockSize > 1 ? primme->maxBlockSize
+         : PRIMME_DOS_VECTORS;
+   }
+   steps = (int)min(primme->n, PRIMME_DOS_LANCZOS);
+
+   /* X has four blocks of numVectors columns, used first by the Lanczos */
+   /* steps; mu has the moments and the norms, also used for the         */
+   /* tridiagonal matrix                                                 */
+
+   ldX = primme->ldOPs > 0 ? primme->ldOPs : primme->nLocal;
+   if (MALLOC_PRIMME((size_t)ldX*max(4*numVectors, 3), &X) != 0) return -1;
+   if (MALLOC_PRIMME(max((size_t)(degree+2)*numVectors,
+               (size_t)steps*steps + 4*steps + 4), &mu) != 0) {
+      free(X);
+      return -1;
+   }
+
+   /* Pass the blocks to matrixMatvec with leading dimension ldX */
+
+   ldOPs = primme->ldOPs;
+   primme->ldOPs = ldX;
+   ret = dos_bounds(X, ldX, steps, b, mu, primme);
+   if (ret == 0) ret = dos_moments(X, ldX, numVectors, degree, b, mu, primme);
+   primme->ldOPs = ldOPs;
+   free(X);
+   if (ret != 0) {
+      free(mu);
+      return -1;
+   }
+
+   /* Add up the Jackson-damped series at every point */
+
+   c = (b[0] + b[1])/2.0;
+   e = (b[1] - b[0])/2.0;
+   for (i=0; i<numPoints; i++) {
+      if (points[i] <= b[0]) {
+         counts[i] = 0.0;
+         continue;
+      }
+      if (points[i] >= b[1]) {
+         counts[i] = (double)primme->n;
+         continue;
+      }
+      t = acos((points[i] - c)/e);
+      sum = mu[0]*(pi - t)/pi;
+      for (k=1; k<=degree; k++) {
+         g = ((degree-k+1)*cos(pi*k/(degree+1))
+               + sin(pi*k/(degree+1))/tan(pi/(degree+1)))/(degree+1);
+         sum -= 2.0*g*mu[k]*sin(k*t)/(k*pi);
+      }
+      counts[i] = min((double)primme->n, max(0.0, primme->n*sum));
+   }
+   if (bounds) {
+      bounds[0] = b[0];
+      bounds[1] = b[1];
+   }
+
+   free(mu);
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine dos_bounds - Estimate the smallest and largest eigenvalues
+ *    with steps Lanczos steps from a random vector, as the extreme Ritz
+ *    values enlarged by the norms of their residuals.
+ *
+ * Q       Workspace of three vectors
+ * T       Workspace of steps*steps + 4*steps + 4 elements
+ * bounds  Output array with the two bounds
+ ******************************************************************************/
+
+static int dos_bounds(SCALAR *Q, PRIMME_INT ldQ, int steps, double *bounds,
+      REAL *T, primme_params *primme) {
+
+   int i, j, m, info;
+   double e;
+   REAL *alpha, *beta, *w, dots[2], lwork;
+   SCALAR *q0, *q1, *r, *t;
+   PRIMME_INT nLocal = primme->nLocal;
+
+   alpha = T + steps*steps;
+   beta = alpha + steps;
+   w = beta + steps + 1;
+
+   q0 = Q;
+   q1 = q0 + ldQ;
+   r = q1 + ldQ;
+   Num_zero_matrix_Sprimme(q0, nLocal, 1, ldQ);
+   Num_larnv_Sprimme(2, primme->iseed, nLocal, q1);
+   dots[0] = REAL_PART(Num_dot_Sprimme(nLocal, q1, 1, q1, 1));
+   CHKERR(globalSum_Rprimme(dots, dots, 1, primme), -1);
+   Num_scal_Sprimme(nLocal, 1.0/sqrt(dots[0]), q1, 1);
+
+   beta[0] = 0.0;
+   for (m=0; m<steps; m++) {
+      /* r = A*q1 - alpha*q1 - beta*q0 */
+      CHKERR(matrixMatvec_Sprimme(q1, nLocal, ldQ, r, ldQ, 0, 1, primme), -1);
+      dots[0] = REAL_PART(Num_dot_Sprimme(nLocal, q1, 1, r, 1));
+      CHKERR(globalSum_Rprimme(dots, dots, 1, primme), -1);
+      alpha[m] = dots[0];
+      Num_axpy_Sprimme(nLocal, -alpha[m], q1, 1, r, 1);
+      Num_axpy_Sprimme(nLocal, -beta[m], q0, 1, r, 1);
+      dots[0] = REAL_PART(Num_dot_Sprimme(nLocal, r, 1, r, 1));
+      CHKERR(globalSum_Rprimme(dots, dots, 1, primme), -1);
+      beta[m+1] = sqrt(dots[0]);
+
+      /* Stop if the Krylov subspace is invariant */
+      if (beta[m+1] <= MACHINE_EPSILON*fabs(alpha[m])) {
+         m++;
+         break;
+      }
+      Num_scal_Sprimme(nLocal, 1.0/beta[m+1], r, 1);
+      t = q0; q0 = q1; q1 = r; r = t;
+   }
+
+   /* Compute the eigenvalues of the tridiagonal matrix */
+
+   for (j=0; j<m; j++) {
+      for (i=0; i<m; i++) T[m*j+i] = 0.0;
+      T[m*j+j] = alpha[j];
+      if (j > 0) T[m*j+j-1] = beta[j];
+   }
+   Num_heev_Rprimme("V", "U", m, T, m, w, &lwork, -1, &info);
+   {
+      int ldwork = (int)lwork;
+      REAL *work;
+      if (MALLOC_PRIMME(ldwork, &work) != 0) return -1;
+      Num_heev_Rprimme("V", "U", m, T, m, w, work, ldwork, &info);
+      free(work);
+   }
+   CHKERRM(info, -1, "Error in heev with info %d\n", info);
+
+   /* The residual norm of the Ritz pair j is beta_m*|T(m-1,j)| */
+
+   bounds[0] = w[0] - beta[m]*fabs(T[m-1]);
+   bounds[1] = w[m-1] + beta[m]*fabs(T[m*(m-1)+m-1]);
+
+   /* Enlarge the interval a bit, so that the spectrum mapped to [-1,1] */
+   /* does not go out of it                                             */
+
+   e = (bounds[1] - bounds[0])*0.01;
+   if (e <= 0.0) e = max(fabs(bounds[0]), 1.0)*0.01;
+   bounds[0] -= e;
+   bounds[1] += e;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine dos_moments - Compute the Chebyshev moments of the spectrum of
+ *    A mapped from bounds to [-1, 1], averaged over numVectors random
+ *    vectors.
+ *
+ * X    Workspace of 4*numVectors vectors
+ * mu   Output array of degree+1 moments; it needs (degree+2)*numVectors
+ *      elements
+ ******************************************************************************/
+
+static int dos_moments(SCALAR *X, PRIMME_INT ldX, int numVectors, int degree,
+      double *bounds, REAL *mu, primme_params *primme) {
+
+   int j, k;
+   double c, e;
+   SCALAR *Z, *X0, *X1, *AX, *t;
+   PRIMME_INT i, nLocal = primme->nLocal;
+   size_t bs = (size_t)ldX*numVectors;
+
+   c = (bounds[0] + bounds[1])/2.0;
+   e = (bounds[1] - bounds[0])/2.0;
+
+   Z = X;
+   X0 = Z + bs;
+   X1 = X0 + bs;
+   AX = X1 + bs;
+   Num_larnv_Sprimme(2, primme->iseed, bs, Z);
+
+   /* mu[k*numVectors+j] = Z(:,j)'*T_k(B)*Z(:,j), and the last */
+   /* numVectors values are Z(:,j)'*Z(:,j)                     */
+
+   Num_copy_matrix_Sprimme(Z, nLocal, numVectors, ldX, X0, ldX);
+   for (k=0; k<=degree; k++) {
+      if (k == 1) {
+         /* X1 = B*Z */
+         CHKERR(matrixMatvec_Sprimme(Z, nLocal, ldX, X1, ldX, 0, numVectors,
+                  primme), -1);
+         for (j=0; j<numVectors; j++) {
+            for (i=0; i<nLocal; i++) {
+               X1[ldX*j+i] = (X1[ldX*j+i] - c*Z[ldX*j+i])/e;
+            }
+         }
+         t = X0; X0 = X1; X1 = t;
+      }
+      else if (k > 1) {
+         /* X_k = 2*B*X_{k-1} - X_{k-2}, stored in X1 */
+         CHKERR(matrixMatvec_Sprimme(X0, nLocal, ldX, AX, ldX, 0, numVectors,
+                  primme), -1);
+         for (j=0; j<numVectors; j++) {
+            for (i=0; i<nLocal; i++) {
+               X1[ldX*j+i] = 2.0*(AX[ldX*j+i] - c*X0[ldX*j+i])/e
+                  - X1[ldX*j+i];
+            }
+         }
+         t = X0; X0 = X1; X1 = t;
+      }
+      for (j=0; j<numVectors; j++) {
+         mu[k*numVectors+j] =
+            REAL_PART(Num_dot_Sprimme(nLocal, &Z[ldX*j], 1, &X0[ldX*j], 1));
+      }
+   }
+   for (j=0; j<numVectors; j++) {
+      mu[(degree+1)*numVectors+j] =
+         REAL_PART(Num_dot_Sprimme(nLocal, &Z[ldX*j], 1, &Z[ldX*j], 1));
+   }
+   CHKERR(globalSum_Rprimme(mu, mu, (degree+2)*numVectors, primme), -1);
+
+   /* Average the moments normalized by the norms of the vectors */
+
+   for (k=0; k<=degree; k++) {
+      double s = 0.0;
+      for (j=0; j<numVectors; j++) {
+         s += mu[k*numVectors+j]/mu[(degree+1)*numVectors+j];
+      }
+      mu[k] = s/numVectors;
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine reset_iseed - Reset the random number seed if inappropriate for
+ *    DLARENV. Yields unique quadruples per proc if procID < 4096^3
+ ******************************************************************************/
+
+static void reset_iseed(primme_params *primme) {
+
+   if (primme->iseed[0]<0 || primme->iseed[0]>4095) primme->iseed[0] = 
+      primme->procID % 4096;
+   if (primme->iseed[1]<0 || primme->iseed[1]>4095) primme->iseed[1] = 
+      (int)(primme->procID/4096+1) % 4096;
+   if (primme->iseed[2]<0 || primme->iseed[2]>4095) primme->iseed[2] = 
+      (int)((primme->procID/4096)/4096+2) % 4096;
+   if (primme->iseed[3]<0 || primme->iseed[3]>4095) primme->iseed[3] = 
+      (2*(int)(((primme->procID/4096)/4096)/4096)+1) % 4096;
+}
+
+/*******************************************************************************
+ * Subroutine primme_solve - Sprimme without setting the number of threads.
+ *    See Sprimme for the description of the parameters and the return value.
+ ******************************************************************************/
+
+static int primme_solve(REAL *evals, SCALAR *evecs, REAL *resNorms, 
+            primme_params *primme) {
       
    int ret;
    int *perm;
    double machEps;
 
-   /* ------------------ */
-   /* zero out the timer */
-   /* ------------------ */
-   primme_wTimer(1);
+   /* -------------------------------------------------- */
+   /* Start the clock of this solve; elapsedTime is the  */
+   /* time from it                                       */
+   /* -------------------------------------------------- */
+   primme->startTime = primme_get_wtime();
 
    /* ----------------------- */
    /*  Find machine precision */
@@ -151,25 +821,22 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
    /* ------------------ */
    primme_set_defaults(primme);
 
+   /* ------------------------------------------------------------- */
+   /* Solve in windows if only the eigenvalues are asked; this also */
+   /* estimates the memory required by a window                     */
+   /* ------------------------------------------------------------- */
+
+   if (primme->evalsOnly) {
+      return evals_only_solve(evals, evecs, resNorms, primme);
+   }
+
    /* -------------------------------------------------------------- */
    /* If needed, we are ready to estimate required memory and return */
    /* -------------------------------------------------------------- */
    if (evals == NULL && evecs == NULL && resNorms == NULL)
        return allocate_workspace(primme, FALSE);
 
-   /* ----------------------------------------------------- */
-   /* Reset random number seed if inappropriate for DLARENV */
-   /* Yields unique quadruples per proc if procID < 4096^3  */
-   /* ----------------------------------------------------- */
-
-   if (primme->iseed[0]<0 || primme->iseed[0]>4095) primme->iseed[0] = 
-      primme->procID % 4096;
-   if (primme->iseed[1]<0 || primme->iseed[1]>4095) primme->iseed[1] = 
-      (int)(primme->procID/4096+1) % 4096;
-   if (primme->iseed[2]<0 || primme->iseed[2]>4095) primme->iseed[2] = 
-      (int)((primme->procID/4096)/4096+2) % 4096;
-   if (primme->iseed[3]<0 || primme->iseed[3]>4095) primme->iseed[3] = 
-      (2*(int)(((primme->procID/4096)/4096)/4096)+1) % 4096;
+   reset_iseed(primme);
 
    /* ----------------------- */
    /* Set default convTetFun  */
@@ -196,11 +863,42 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
 
    CHKERRNOABORT(ret = check_input(evals, evecs, resNorms, primme), ret);
 
+   /* ------------------------------------------------- */
+   /* Start recording the solver events if it is asked  */
+   /* ------------------------------------------------- */
+
+   if (primme->traceFileName && !primme->trace) {
+      CHKERRNOABORT(primme_trace_create(primme->traceSize, &primme->trace),
+            MALLOC_FAILURE);
+   }
+
+#ifdef USE_LOWER_INNER
+   /* ------------------------------------------------------------ */
+   /* Solve first in single precision if it is asked and supported */
+   /* ------------------------------------------------------------ */
+
+   if (primme->precisionCascade && !primme->massMatrixMatvec
+         && !primme->rowMajorOPs && !primme->warmStart) {
+      return cascade_solve(evals, evecs, resNorms, primme);
+   }
+
+   /* ------------------------------------------------------------------ */
+   /* Project out the locked vectors in single precision if it is asked  */
+   /* ------------------------------------------------------------------ */
+
+   if (primme->lockedSinglePrecision && primme->locking
+         && !primme->massMatrixMatvec && !primme->warmStart) {
+      return locked_single_solve(evals, evecs, resNorms, primme);
+   }
+#endif
+
    /* ----------------------------------------------------------------------- */
    /* Compute AND allocate memory requirements for main_iter and subordinates */
    /* ----------------------------------------------------------------------- */
 
+   double t0 = primme_get_wtime();
    CHKERRNOABORT(allocate_workspace(primme, TRUE), ALLOCATE_WORKSPACE_FAILURE);
+   primme->stats.timeWorkspace = primme_get_wtime() - t0;
 
    /* --------------------------------------------------------- */
    /* Allocate workspace that will be needed locally by Sprimme */
@@ -211,9 +909,12 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
    /* Call the solver                                                      */
    /*----------------------------------------------------------------------*/
 
-   CHKERRNOABORT(main_iter_Sprimme(evals, perm, evecs, primme->ldevecs,
-            resNorms, machEps, primme->intWork, primme->realWork, primme),
-         MAIN_ITER_FAILURE);
+   primme->matvecHalfActive =
+      primme->matrixMatvecHalf != NULL && !primme->rowMajorOPs;
+   ret = main_iter_Sprimme(evals, perm, evecs, primme->ldevecs, resNorms,
+         machEps, primme->intWork, primme->realWork, primme);
+   primme->matvecHalfActive = 0;
+   CHKERRNOABORT(ret, MAIN_ITER_FAILURE);
 
    /*----------------------------------------------------------------------*/
    /* If locking is engaged, the converged Ritz vectors are stored in the  */
@@ -221,19 +922,602 @@ int Sprimme(REAL *evals, SCALAR *evecs, REAL *resNorms,
    /* correspond to the sorted Ritz values in evals.                       */
    /*----------------------------------------------------------------------*/
 
-   assert(primme->realWorkSize >= sizeof(SCALAR)*primme->nLocal
+   /* Use W as workspace, so that V is kept for warmStart */
+
+   assert(primme->realWorkSize >= sizeof(SCALAR)*primme->ldOPs
+         *(primme->maxBasisSize+1)
          && primme->intWorkSize >= (int)sizeof(int)*primme->initSize);
    permute_vecs_Sprimme(&evecs[primme->numOrthoConst*primme->ldevecs],
          primme->nLocal, primme->initSize, primme->ldevecs, perm,
-         (SCALAR*)primme->realWork, (int*)primme->intWork);
+         (SCALAR*)primme->realWork + primme->ldOPs*primme->maxBasisSize,
+         (int*)primme->intWork);
 
    free(perm);
 
-   primme->stats.elapsedTime = primme_wTimer(0);
+   primme->stats.elapsedTime = primme_get_wtime() - primme->startTime;
    return(0);
 }
 
 
+/*******************************************************************************
+ * Subroutine evals_only_solve - Find the eigenvalues in windows of at most
+ *    maxBasisSize/2 pairs, keeping only the eigenvectors of the last window.
+ *    Every window is solved with locking and with the previous window as
+ *    orthogonality constraints. The first window has the user's target; the
+ *    next ones look for the closest eigenvalues beyond the last eigenvalue
+ *    found, with primme_closest_geq for primme_smallest and
+ *    primme_closest_geq, and with primme_closest_leq for primme_largest and
+ *    primme_closest_leq. The eigenvalues found in windows before the previous
+ *    one are not deflated, but they are on the other side of the shift.
+ *
+ *    evecs has the numOrthoConst constraints and the initial guesses for the
+ *    first window, and room for min(numEvals, maxBasisSize) more vectors;
+ *    on return, after the constraints, it has the eigenvectors of the last
+ *    window.
+ *
+ * Parameters are the ones of primme_solve; it returns -41 if the target is
+ * primme_largest_abs or primme_closest_abs, or if the problem is generalized.
+ *
+ ******************************************************************************/
+
+static int evals_only_solve(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      primme_params *primme) {
+
+   int ret = 0, numEvals = primme->numEvals;
+   int numOrthoConst = primme->numOrthoConst, initSize = primme->initSize;
+   int locking = primme->locking, numTargetShifts = primme->numTargetShifts;
+   int window = max(1, min(numEvals, primme->maxBasisSize/2));
+   int found = 0;      /* eigenvalues found so far */
+   int prev = 0;       /* eigenvectors of the previous window in evecs */
+   int i;
+   primme_target target = primme->target;
+   double *targetShifts = primme->targetShifts;
+   double startTime = primme->startTime, shift;
+   PRIMME_INT maxMatvecs = primme->maxMatvecs;
+   PRIMME_INT maxOuterIterations = primme->maxOuterIterations;
+   primme_stats stats;
+
+   if (target == primme_largest_abs || target == primme_closest_abs
+         || primme->massMatrixMatvec) {
+      return -41;
+   }
+
+   primme->evalsOnly = 0;
+   primme->locking = 1;
+
+   /* Report or allocate the memory of the largest window, which has the */
+   /* previous one as constraints, so that all windows share it          */
+
+   primme->numEvals = window;
+   primme->numOrthoConst = numOrthoConst + (numEvals > window ? window : 0);
+   if (evals == NULL && evecs == NULL && resNorms == NULL) {
+      ret = primme_solve(NULL, NULL, NULL, primme);
+   }
+   else if (allocate_workspace(primme, TRUE) != 0) {
+      ret = ALLOCATE_WORKSPACE_FAILURE;
+   }
+   else while (found < numEvals) {
+      primme->numEvals = min(window, numEvals - found);
+      primme->numOrthoConst = numOrthoConst + prev;
+      primme->initSize = found == 0 ? min(initSize, primme->numEvals) : 0;
+      if (found > 0) {
+         primme->target = (target == primme_smallest
+               || target == primme_closest_geq) ? primme_closest_geq
+                                                : primme_closest_leq;
+         primme->numTargetShifts = 1;
+         primme->targetShifts = &shift;
+         if (maxMatvecs > 0) {
+            primme->maxMatvecs = maxMatvecs - stats.numMatvecs;
+         }
+         if (maxOuterIterations > 0) {
+            primme->maxOuterIterations =
+               maxOuterIterations - stats.numOuterIterations;
+         }
+      }
+
+      ret = primme_solve(&evals[found], evecs, &resNorms[found], primme);
+      if (found == 0) {
+         stats = primme->stats;
+      }
+      else {
+         add_stats(&stats, &primme->stats);
+      }
+
+      /* Move the eigenvectors of this window in place of the previous ones */
+
+      for (i=0; i<primme->initSize; i++) {
+         Num_copy_Sprimme(primme->nLocal,
+               &evecs[primme->ldevecs*(numOrthoConst+prev+i)], 1,
+               &evecs[primme->ldevecs*(numOrthoConst+i)], 1);
+      }
+      prev = primme->initSize;
+      found += primme->initSize;
+      if (ret != 0 || prev == 0) break;
+
+      /* The eigenvalues are sorted from the shift; the next window starts */
+      /* at the farthest one                                               */
+
+      shift = evals[found-1];
+   }
+
+   /* Restore the user's setup */
+
+   primme->evalsOnly = 1;
+   primme->numEvals = numEvals;
+   primme->numOrthoConst = numOrthoConst;
+   primme->locking = locking;
+   primme->target = target;
+   primme->numTargetShifts = numTargetShifts;
+   primme->targetShifts = targetShifts;
+   primme->maxMatvecs = maxMatvecs;
+   primme->maxOuterIterations = maxOuterIterations;
+   if (evals == NULL && evecs == NULL && resNorms == NULL) {
+      primme->initSize = initSize;
+   }
+   else {
+      primme->initSize = found;
+      primme->stats = stats;
+      primme->startTime = startTime;
+      primme->stats.elapsedTime = primme_get_wtime() - startTime;
+   }
+
+   return ret;
+}
+
+/*******************************************************************************
+ * Subroutine stats_imbalance - Gather with a single call to globalSumReal the
+ *    times of matvec, preconditioner and globalSumReal of every process, and
+ *    set in stats their minimum, maximum and average. A slow process makes
+ *    the others wait in the reductions; the time out of globalSumReal tells
+ *    it apart, and its maximum over the average is the imbalance factor.
+ *    The time in globalSumReal of the process that waited least is taken as
+ *    the cost of the reductions, and the average excess over it as the time
+ *    lost waiting.
+ *
+ *    The summary is printed with printLevel >= 2.
+ *
+ * Return Value
+ * ------------
+ * error code
+ *
+ ******************************************************************************/
+
+static int stats_imbalance(primme_params *primme) {
+
+   primme_stats *stats = &primme->stats;
+   int numProcs = primme->numProcs, i, j, slowest;
+   REAL *times;
+   double avg[4], mn[4], mx[4];
+
+   if (numProcs <= 1 || !primme->globalSumReal) return 0;
+
+   /* Every process puts its times in its slot and the sum gathers them */
+
+   CHKERR(MALLOC_PRIMME((size_t)numProcs*4, &times), MALLOC_FAILURE);
+   for (i=0; i<numProcs*4; i++) times[i] = 0.0;
+   times[primme->procID*4+0] = stats->timeMatvec;
+   times[primme->procID*4+1] = stats->timePrecond;
+   times[primme->procID*4+2] = stats->timeGlobalSum;
+   times[primme->procID*4+3] = stats->elapsedTime - stats->timeGlobalSum;
+   if (globalSum_Rprimme(times, times, numProcs*4, primme) != 0) {
+      free(times);
+      return -1;
+   }
+
+   for (j=0; j<4; j++) {
+      avg[j] = 0.0;
+      mn[j] = mx[j] = times[j];
+   }
+   for (i=0, slowest=0; i<numProcs; i++) {
+      for (j=0; j<4; j++) {
+         avg[j] += times[i*4+j]/numProcs;
+         mn[j] = min(mn[j], times[i*4+j]);
+         mx[j] = max(mx[j], times[i*4+j]);
+      }
+      if (times[i*4+3] > times[slowest*4+3]) slowest = i;
+   }
+   free(times);
+
+   stats->timeMatvecMin = mn[0];
+   stats->timeMatvecMax = mx[0];
+   stats->timeMatvecAvg = avg[0];
+   stats->timePrecondMin = mn[1];
+   stats->timePrecondMax = mx[1];
+   stats->timePrecondAvg = avg[1];
+   stats->timeGlobalSumMin = mn[2];
+   stats->timeGlobalSumMax = mx[2];
+   stats->timeGlobalSumAvg = avg[2];
+   stats->imbalanceFactor = avg[3] > 0.0 ? mx[3]/avg[3] : 1.0;
+   stats->timeGlobalSumWaiting = avg[2] - mn[2];
+   stats->slowestProc = slowest;
+
+   if (primme->printLevel >= 2 && primme->procID == 0 && primme->outputFile) {
+      fprintf(primme->outputFile,
+            "Times over %d processes (min/avg/max): matvec %g/%g/%g "
+            "precond %g/%g/%g globalSum %g/%g/%g\n"
+            "Imbalance factor %g slowest process %d waiting in globalSum %g\n",
+            numProcs, mn[0], avg[0], mx[0], mn[1], avg[1], mx[1], mn[2],
+            avg[2], mx[2], stats->imbalanceFactor, slowest,
+            stats->timeGlobalSumWaiting);
+      fflush(primme->outputFile);
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine add_stats - Add to stats the work reported in stats1
+ ******************************************************************************/
+
+static void add_stats(primme_stats *stats, primme_stats *stats1) {
+
+   stats->numOuterIterations += stats1->numOuterIterations;
+   stats->numRestarts += stats1->numRestarts;
+   stats->numMatvecs += stats1->numMatvecs;
+   stats->numPreconds += stats1->numPreconds;
+   stats->numGlobalSum += stats1->numGlobalSum;
+   stats->volumeGlobalSum += stats1->volumeGlobalSum;
+   stats->numGlobalSumMerged += stats1->numGlobalSumMerged;
+   stats->numOrthoInnerProds += stats1->numOrthoInnerProds;
+   stats->timeMatvec += stats1->timeMatvec;
+   stats->timePrecond += stats1->timePrecond;
+   stats->timeOrtho += stats1->timeOrtho;
+   stats->timeGlobalSum += stats1->timeGlobalSum;
+   stats->timeGlobalSumInterNode += stats1->timeGlobalSumInterNode;
+   stats->timeSolveH += stats1->timeSolveH;
+   stats->timeRestart += stats1->timeRestart;
+   stats->timeUpdateVWXR += stats1->timeUpdateVWXR;
+   stats->timeConvCheck += stats1->timeConvCheck;
+   stats->timeInnerSolve += stats1->timeInnerSolve;
+   stats->timeWorkspace += stats1->timeWorkspace;
+   stats->estimateMinEVal = min(stats->estimateMinEVal, stats1->estimateMinEVal);
+   stats->estimateMaxEVal = max(stats->estimateMaxEVal, stats1->estimateMaxEVal);
+   stats->estimateLargestSVal =
+      max(stats->estimateLargestSVal, stats1->estimateLargestSVal);
+}
+
+#ifdef USE_LOWER_INNER
+
+/*******************************************************************************
+ * Precision cascade
+ *
+ *    If primme.precisionCascade, the double precision solvers call first the
+ *    single precision solver on a copy of primme whose operators are the
+ *    adapters below: they convert the vectors and call the user callbacks with
+ *    the user's primme. The copy is the first member of cascade_ctx, so the
+ *    adapters get the context from the primme they are passed.
+ *
+ ******************************************************************************/
+
+typedef struct {
+   primme_params primme;  /* Copy of primme used by the single precision stage */
+   primme_params *orig;   /* The user's primme                              */
+   SCALAR *x, *y;         /* Buffers of nLocal x blockSize for the operators */
+   int blockSize;         /* Number of columns of x and y                   */
+} cascade_ctx;
+
+static void cascade_copy(PRIMME_INT m, int n, void *a, PRIMME_INT lda,
+      int fromLower, void *b, PRIMME_INT ldb) {
+
+   int j;
+   PRIMME_INT i;
+
+   for (j=0; j<n; j++) {
+      for (i=0; i<m; i++) {
+         if (fromLower) {
+            ((SCALAR*)b)[ldb*j+i] = (SCALAR)((LSCALAR*)a)[lda*j+i];
+         }
+         else {
+            ((LSCALAR*)b)[ldb*j+i] = (LSCALAR)((SCALAR*)a)[lda*j+i];
+         }
+      }
+   }
+}
+
+/* Apply a double precision operator on single precision vectors; the      */
+/* buffers grow with the block size                                        */
+
+static void cascade_operator(void (*op)(void *, PRIMME_INT *, void *,
+         PRIMME_INT *, int *, struct primme_params *, int *), void *x,
+      PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize,
+      cascade_ctx *ctx, int *ierr) {
+
+   PRIMME_INT nLocal = ctx->orig->nLocal;
+
+   if (*blockSize > ctx->blockSize) {
+      free(ctx->x);
+      ctx->blockSize = 0;
+      if (MALLOC_PRIMME((size_t)nLocal*(*blockSize)*2 + 1, &ctx->x) != 0) {
+         *ierr = -1;
+         return;
+      }
+      ctx->y = ctx->x + (size_t)nLocal*(*blockSize);
+      ctx->blockSize = *blockSize;
+   }
+
+   cascade_copy(nLocal, *blockSize, x, *ldx, 1, ctx->x, nLocal);
+   op(ctx->x, &nLocal, ctx->y, &nLocal, blockSize, ctx->orig, ierr);
+   if (*ierr == 0) {
+      cascade_copy(nLocal, *blockSize, ctx->y, nLocal, 0, y, *ldy);
+   }
+}
+
+static void cascade_matvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr) {
+
+   cascade_ctx *ctx = (cascade_ctx*)primme;
+
+   if (ctx->orig->matrixMatvecSingle) {
+      ctx->orig->matrixMatvecSingle(x, ldx, y, ldy, blockSize, ctx->orig,
+            ierr);
+   }
+   else {
+      cascade_operator(ctx->orig->matrixMatvec, x, ldx, y, ldy, blockSize,
+            ctx, ierr);
+   }
+}
+
+static void cascade_precond(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
+
+   cascade_ctx *ctx = (cascade_ctx*)primme;
+   double *shifts = ctx->orig->ShiftsForPreconditioner;
+
+   ctx->orig->ShiftsForPreconditioner = primme->ShiftsForPreconditioner;
+   if (ctx->orig->applyPreconditionerSingle) {
+      ctx->orig->applyPreconditionerSingle(x, ldx, y, ldy, blockSize,
+            ctx->orig, ierr);
+   }
+   else {
+      cascade_operator(ctx->orig->applyPreconditioner, x, ldx, y, ldy,
+            blockSize, ctx, ierr);
+   }
+   ctx->orig->ShiftsForPreconditioner = shifts;
+}
+
+static void cascade_shiftUpdate(double *newShifts, double *oldShifts,
+      int *blockSize, primme_params *primme, int *ierr) {
+
+   cascade_ctx *ctx = (cascade_ctx*)primme;
+
+   ctx->orig->precondShiftUpdate(newShifts, oldShifts, blockSize, ctx->orig,
+         ierr);
+}
+
+static void cascade_globalSum(void *sendBuf, void *recvBuf, int *count,
+      primme_params *primme, int *ierr) {
+
+   cascade_ctx *ctx = (cascade_ctx*)primme;
+   REAL *buf;
+   int i;
+
+   if (MALLOC_PRIMME((size_t)*count*2, &buf) != 0) {
+      *ierr = -1;
+      return;
+   }
+   for (i=0; i<*count; i++) buf[i] = ((LREAL*)sendBuf)[i];
+   ctx->orig->globalSumReal(buf, buf+*count, count, ctx->orig, ierr);
+   for (i=0; i<*count; i++) ((LREAL*)recvBuf)[i] = (LREAL)buf[*count+i];
+   free(buf);
+}
+
+/*******************************************************************************
+ * Subroutine cascade_solve - Solve the problem with the single precision
+ *    solver up to a residual norm near the single precision (see
+ *    PRIMME_CASCADE_EPS_FACTOR), and refine the solution with primme_solve,
+ *    which starts from the basis of the first stage as with warmStart. If
+ *    the first stage fails, primme_solve starts from the user's inputs.
+ *
+ * Parameters are the ones of primme_solve.
+ *
+ ******************************************************************************/
+
+static int cascade_solve(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      primme_params *primme) {
+
+   int ret, ret1, initSize = primme->initSize;
+   int numVecs = primme->numOrthoConst + max(primme->numEvals, initSize);
+   PRIMME_INT nLocal = primme->nLocal;
+   PRIMME_INT maxMatvecs = primme->maxMatvecs;
+   PRIMME_INT maxOuterIterations = primme->maxOuterIterations;
+   double startTime = primme->startTime;
+   primme_stats stats1;
+   cascade_ctx ctx;
+   LSCALAR *levecs;
+   LREAL *levals, *lresNorms;
+
+   /* Set up the copy of primme for the single precision stage */
+
+   ctx.primme = *primme;
+   ctx.orig = primme;
+   ctx.x = ctx.y = NULL;
+   ctx.blockSize = 0;
+   ctx.primme.matrixMatvec = cascade_matvec;
+   ctx.primme.applyPreconditioner =
+      primme->applyPreconditioner ? cascade_precond : NULL;
+   ctx.primme.precondShiftUpdate =
+      primme->precondShiftUpdate ? cascade_shiftUpdate : NULL;
+   ctx.primme.globalSumReal = primme->globalSumReal ? cascade_globalSum : NULL;
+   ctx.primme.globalSumRealStart = NULL;
+   ctx.primme.globalSumRealWait = NULL;
+   ctx.primme.matrixMatvecProject = NULL;
+   ctx.primme.matrixMatvecStart = NULL;
+   ctx.primme.matrixMatvecWait = NULL;
+   ctx.primme.matrixMatvecSingle = NULL;
+   ctx.primme.matrixPowers = NULL;
+   ctx.primme.applyPreconditionerSingle = NULL;
+   ctx.primme.convTestFun = NULL;
+   ctx.primme.convTestFunBlock = NULL;
+   ctx.primme.monitorFun = NULL;
+   ctx.primme.checkpointFun = NULL;
+   ctx.primme.lockedPanelSize = 0;
+   ctx.primme.lockedPaging = NULL;
+   ctx.primme.basisPanelRows = 0;
+   ctx.primme.basisPaging = NULL;
+   ctx.primme.intWork = NULL;
+   ctx.primme.intWorkSize = 0;
+   ctx.primme.realWork = NULL;
+   ctx.primme.realWorkSize = 0;
+   ctx.primme.ldevecs = nLocal;
+   ctx.primme.eps = max(primme->eps, PRIMME_CASCADE_EPS_FACTOR*FLT_EPSILON);
+   ctx.primme.precisionCascade = 0;
+   ctx.primme.statsImbalance = 0;
+   ctx.primme.warmStart = 1;
+   ctx.primme.warmBasisSize = 0;
+
+   /* Round the constraints and the initial guesses */
+
+   CHKERR(MALLOC_PRIMME((size_t)nLocal*numVecs + 1, &levecs), MALLOC_FAILURE);
+   if (MALLOC_PRIMME((size_t)primme->numEvals*2 + 1, &levals) != 0) {
+      free(levecs);
+      return MALLOC_FAILURE;
+   }
+   lresNorms = levals + primme->numEvals;
+   cascade_copy(nLocal, primme->numOrthoConst + initSize, evecs,
+         primme->ldevecs, 0, levecs, nLocal);
+
+   /* Solve in single precision */
+
+   ret1 = LSCALAR_SUF(levals, levecs, lresNorms, &ctx.primme);
+   stats1 = ctx.primme.stats;
+
+   if (ret1 == 0) {
+      /* Promote the basis of the first stage to V of the double precision */
+      /* workspace and, with locking, the converged pairs to the initial   */
+      /* guesses                                                           */
+
+      CHKERRNOABORT(allocate_workspace(primme, TRUE),
+            ALLOCATE_WORKSPACE_FAILURE);
+      cascade_copy(nLocal, ctx.primme.warmBasisSize, ctx.primme.realWork,
+            ctx.primme.ldOPs, 1, primme->realWork, primme->ldOPs);
+      primme->warmStart = 1;
+      primme->warmBasisSize = ctx.primme.warmBasisSize;
+      if (primme->locking) {
+         cascade_copy(nLocal, ctx.primme.initSize,
+               &levecs[nLocal*primme->numOrthoConst], nLocal, 1,
+               &evecs[primme->ldevecs*primme->numOrthoConst],
+               primme->ldevecs);
+         primme->initSize = ctx.primme.initSize;
+      }
+      else {
+         primme->initSize = 0;
+      }
+      if (maxMatvecs > 0) primme->maxMatvecs -= stats1.numMatvecs;
+      if (maxOuterIterations > 0) {
+         primme->maxOuterIterations -= stats1.numOuterIterations;
+      }
+   }
+   else if (primme->printLevel > 0 && primme->outputFile) {
+      fprintf(primme->outputFile, "PRIMME: Warning: the single precision "
+            "stage failed with error %d; solving in double precision\n", ret1);
+   }
+
+   free(levecs);
+   free(levals);
+   free(ctx.x);
+   primme_free(&ctx.primme);
+
+   /* Refine in double precision */
+
+   primme->precisionCascade = 0;
+   ret = primme_solve(evals, evecs, resNorms, primme);
+   primme->precisionCascade = 1;
+   primme->warmStart = 0;
+   primme->warmBasisSize = 0;
+   primme->maxMatvecs = maxMatvecs;
+   primme->maxOuterIterations = maxOuterIterations;
+
+   /* Report the work of both stages */
+
+   add_stats(&primme->stats, &stats1);
+   primme->startTime = startTime;
+   primme->stats.elapsedTime = primme_get_wtime() - startTime;
+
+   return ret;
+}
+
+/*******************************************************************************
+ * Subroutine locked_single_solve - Solve the problem with primme_solve while
+ *    the products with the locked vectors and the constraints use a single
+ *    precision copy of them (see Num_gemm_locked_Sprimme), up to a residual
+ *    norm near the single precision as in cascade_solve. Then refine the
+ *    solution with primme_solve in full precision, starting from the basis of
+ *    the first stage and with the pairs found as initial guesses. The second
+ *    stage is skipped if eps is already above the tolerance of the first one
+ *    and convTestFun is the default.
+ *
+ *    The copy takes nLocal*(numOrthoConst+numEvals) single precision numbers
+ *    and is freed before the second stage. While it is in use, the locked
+ *    columns of evecs are only read once to be rounded, which also lets the
+ *    OS page them out if evecs is memory-mapped.
+ *
+ * Parameters are the ones of primme_solve.
+ *
+ ******************************************************************************/
+
+static int locked_single_solve(REAL *evals, SCALAR *evecs, REAL *resNorms,
+      primme_params *primme) {
+
+   int ret, initSize;
+   PRIMME_INT maxMatvecs = primme->maxMatvecs;
+   PRIMME_INT maxOuterIterations = primme->maxOuterIterations;
+   double eps = primme->eps, aNorm = primme->aNorm;
+   double startTime = primme->startTime;
+   void (*convTestFun)(double *, void *, double *, int *,
+         struct primme_params *, int *) = primme->convTestFun;
+   primme_stats stats1;
+   LSCALAR *copy;
+
+   CHKERR(MALLOC_PRIMME((size_t)primme->nLocal*(primme->numOrthoConst
+               + primme->numEvals) + 1, &copy), MALLOC_FAILURE);
+
+   /* Solve with the single precision copy, keeping the basis */
+
+   primme->lockedCopy = copy;
+   primme->lockedCopyOf = evecs;
+   primme->lockedCopyCols = 0;
+   primme->lockedSinglePrecision = 0;
+   primme->convTestFun = convTestFunAbsolute;
+   primme->eps = max(eps, PRIMME_CASCADE_EPS_FACTOR*FLT_EPSILON);
+   primme->warmStart = 1;
+   primme->warmBasisSize = 0;
+   ret = primme_solve(evals, evecs, resNorms, primme);
+   primme->lockedCopy = primme->lockedCopyOf = NULL;
+   primme->lockedCopyCols = 0;
+   free(copy);
+   stats1 = primme->stats;
+   initSize = primme->initSize;
+
+   primme->convTestFun = convTestFun;
+   primme->eps = eps;
+   primme->aNorm = aNorm;
+
+   /* Refine in full precision from the basis and the pairs found */
+
+   if (ret == 0 && (convTestFun != convTestFunAbsolute
+            || eps < PRIMME_CASCADE_EPS_FACTOR*FLT_EPSILON)) {
+      primme->initSize = initSize;
+      if (maxMatvecs > 0) primme->maxMatvecs -= stats1.numMatvecs;
+      if (maxOuterIterations > 0) {
+         primme->maxOuterIterations -= stats1.numOuterIterations;
+      }
+      ret = primme_solve(evals, evecs, resNorms, primme);
+      add_stats(&primme->stats, &stats1);
+   }
+
+   primme->lockedSinglePrecision = 1;
+   primme->warmStart = 0;
+   primme->warmBasisSize = 0;
+   primme->maxMatvecs = maxMatvecs;
+   primme->maxOuterIterations = maxOuterIterations;
+   primme->startTime = startTime;
+   primme->stats.elapsedTime = primme_get_wtime() - startTime;
+
+   return ret;
+}
+
+#endif /* USE_LOWER_INNER */
+
 /******************************************************************************
  * Function allocate_workspace - This function computes the amount of integer 
  *    and real workspace needed by the solver and possibly allocates the space 
@@ -289,7 +1573,14 @@ static int allocate_workspace(primme_params *primme, int allocate) {
       + primme->maxBasisSize*primme->maxBasisSize  /* Size of hVecs        */
       + primme->restartingParams.maxPrevRetain*primme->maxBasisSize
                                                    /* size of prevHVecs    */
-      + primme->maxBasisSize*primme->maxBasisSize; /* Size of VtBV */
+      + primme->maxBasisSize*primme->maxBasisSize; /* Size of VtBV or VtV */
+
+   /*----------------------------------------------------------------------*/
+   /* Add memory for B*V in generalized problems, if it is kept            */
+   /*----------------------------------------------------------------------*/
+   if (primme->massMatrixMatvec && primme->massMatrixCache) {
+      dataSize += primme->ldOPs*primme->maxBasisSize; /* Size of BV        */
+   }
 
    /*----------------------------------------------------------------------*/
    /* Add memory for Harmonic or Refined projection                        */
@@ -302,12 +1593,29 @@ static int allocate_workspace(primme_params *primme, int allocate) {
          + primme->maxBasisSize*primme->maxBasisSize     /* Size of hU     */
          + primme->maxBasisSize*primme->maxBasisSize;    /* Size of hVecsRot */
       doubleSize += primme->maxBasisSize;                /* Size of hSVals */
+
+      /* With multiShiftBlock, Q and R for the next target shifts */
+      if (primme->multiShiftBlock && primme->numTargetShifts > 1
+            && !primme->massMatrixMatvec
+            && (primme->target == primme_closest_abs
+               || primme->target == primme_closest_leq
+               || primme->target == primme_closest_geq)) {
+         dataSize += (min(primme->maxBlockSize, primme->numTargetShifts) - 1)
+            * (primme->ldOPs*primme->maxBasisSize
+                  + primme->maxBasisSize*primme->maxBasisSize);
+      }
    }
    if (primme->projectionParams.projection == primme_proj_harmonic) {
       /* Stored QtV = Q'*V */
       dataSize +=
             primme->maxBasisSize*primme->maxBasisSize;      /* Size of QtV */
    }
+   if (primme->projectionParams.projection != primme_proj_RR &&
+         primme->numProcs > 1 && primme->globalSumRealStart &&
+         primme->globalSumRealWait) {
+      /* Buffer for the nonblocking sum of H while updating Q and R */
+      dataSize += 2*primme->maxBasisSize*primme->maxBlockSize;
+   }
 
 
    /*----------------------------------------------------------------------*/
@@ -330,7 +1638,7 @@ static int allocate_workspace(primme_params *primme, int allocate) {
    /*----------------------------------------------------------------------*/
 
    CHKERR(init_basis_Sprimme(NULL, primme->nLocal, 0, NULL, 0, NULL, 0,
-            NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, &realWorkSize,
+            NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, &realWorkSize,
             &primme->maxBasisSize, NULL, NULL, primme), -1);
 
    /*----------------------------------------------------------------------*/
@@ -341,6 +1649,36 @@ static int allocate_workspace(primme_params *primme, int allocate) {
             primme->maxBasisSize+primme->maxBlockSize-1, NULL, primme->nLocal, 
             primme->locking?maxEvecsSize:primme->numOrthoConst+1, primme->nLocal,
             NULL, 0.0, NULL, &realWorkSize, primme), -1);
+   if (primme->massMatrixMatvec) {
+      CHKERR(ortho_B_Sprimme(NULL, 0, NULL, 0, primme->maxBasisSize,
+               primme->maxBasisSize+primme->maxBlockSize-1, primme->nLocal,
+               NULL, 0.0, NULL, &realWorkSize, primme), -1);
+   }
+
+   /*----------------------------------------------------------------------*/
+   /* Determine workspace required by the s-step expansion; it also calls  */
+   /* ortho on Q with up to sStepSize blocks.                              */
+   /*----------------------------------------------------------------------*/
+
+   if (primme->sStepSize > 1) {
+      int maxNewVecs = min(primme->maxBasisSize,
+            primme->maxBlockSize*primme->sStepSize);
+      CHKERR(matrixMatvec_sstep_Sprimme(NULL, primme->nLocal, 0, NULL, 0,
+               primme->maxBasisSize, maxNewVecs, 2, NULL, NULL, NULL, 0,
+               primme->locking?primme->numEvals:0, NULL, NULL, 0.0, NULL,
+               &realWorkSize, primme), -1);
+      CHKERR(ortho_Sprimme(NULL, 0, NULL, 0, primme->maxBasisSize,
+               primme->maxBasisSize+maxNewVecs-1, NULL, primme->nLocal, 0,
+               primme->nLocal, NULL, 0.0, NULL, &realWorkSize, primme), -1);
+   }
+
+   /*----------------------------------------------------------------------*/
+   /* Determine workspace required by the Chebyshev filter                 */
+   /*----------------------------------------------------------------------*/
+
+   CHKERR(chebyshev_filter_Sprimme(NULL, primme->nLocal, 0, NULL, 0, 0,
+            primme->maxBlockSize, NULL, NULL, 0, NULL, NULL, &realWorkSize, primme),
+         -1);
 
    /*----------------------------------------------------------------------*/
    /* Determine workspace required by solve_H and its children             */
@@ -355,37 +1693,44 @@ static int allocate_workspace(primme_params *primme, int allocate) {
    /*----------------------------------------------------------------------*/
 
    CHKERR(solve_correction_Sprimme(NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 
-            NULL, NULL, maxEvecsSize, 0, NULL, NULL, NULL, NULL, 
-            primme->maxBasisSize, NULL, NULL, primme->maxBlockSize, NULL,
+            NULL, NULL, maxEvecsSize, 0, NULL, NULL, NULL, NULL, NULL, NULL,
+            NULL, primme->maxBasisSize, NULL, NULL, primme->maxBlockSize, NULL,
             0.0, NULL, &realWorkSize, &intWorkSize, 0, primme), -1);
 
    /*----------------------------------------------------------------------*/
    /* Determine workspace required by restarting and its children          */
    /*----------------------------------------------------------------------*/
 
-   CHKERR(restart_Sprimme(NULL, NULL, primme->nLocal, primme->maxBasisSize,
+   CHKERR(restart_Sprimme(NULL, NULL, NULL, primme->nLocal,
+            primme->maxBasisSize,
             0, NULL, NULL, NULL, NULL, &primme->maxBlockSize, NULL, NULL, 0,
             NULL, NULL, NULL, evecsHat, 0, NULL, 0, NULL, 0, NULL,
             &primme->numEvals, &primme->numEvals, &primme->numEvals, NULL, NULL,
             &primme->restartingParams.maxPrevRetain, primme->maxBasisSize,
             primme->initSize, NULL, &primme->maxBasisSize, NULL,
             primme->maxBasisSize, &t, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0,
-            0, NULL, 0, 0, NULL, NULL, NULL, NULL, 0, NULL, NULL, 0.0, NULL,
-            &realWorkSize, &intWorkSize, 0, primme), -1);
+            0, NULL, 0, 0, NULL, NULL, NULL, NULL, 0, NULL, NULL, NULL, NULL,
+            0.0, NULL, &realWorkSize, &intWorkSize, 0, primme), -1);
 
    /*----------------------------------------------------------------------*/
    /* Determine workspace required by main_iter and its children           */
    /*----------------------------------------------------------------------*/
 
    CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, 0, 0,
-            primme->maxBasisSize, NULL, &realWorkSize, 0, primme), -1);
+            primme->maxBasisSize, NULL, &realWorkSize, 0, NULL, primme), -1);
 
-   CHKERR(prepare_candidates_Sprimme(NULL, 0, NULL, 0, primme->nLocal, NULL, 0,
+   CHKERR(prepare_candidates_Sprimme(NULL, 0, NULL, 0, NULL, primme->nLocal,
+            NULL, 0,
             primme->maxBasisSize, NULL, NULL, NULL, 0, NULL, NULL, NULL,
             primme->numEvals, NULL, 0, primme->maxBlockSize,
             NULL, primme->numEvals, 0, NULL, NULL, 0, 0.0, NULL,
             &primme->maxBlockSize, NULL, NULL, NULL, NULL, 0, 0, NULL, NULL,
-            NULL, &realWorkSize, &intWorkSize, 0, primme), -1);
+            NULL, NULL, &realWorkSize, &intWorkSize, 0, primme), -1);
+
+   CHKERR(prepare_multishift_candidates_Sprimme(NULL, 0, NULL, 0,
+            primme->nLocal, NULL, 0, primme->maxBasisSize, NULL, 0, 0,
+            primme->maxBlockSize, NULL, NULL, NULL, &realWorkSize, primme),
+            -1);
 
    CHKERR(retain_previous_coefficients_Sprimme(NULL, 0, NULL, 0, NULL, 0,
             0, 0, NULL, primme->maxBlockSize, NULL,
@@ -395,17 +1740,21 @@ static int allocate_workspace(primme_params *primme, int allocate) {
    /*----------------------------------------------------------------------*/
    /* Workspace needed by function verify_norms                            */
    /*----------------------------------------------------------------------*/
-   realWorkSize = max(realWorkSize, (size_t)2*primme->numEvals);
+   realWorkSize = max(realWorkSize, (size_t)2*primme->numEvals
+         + (primme->massMatrixMatvec && !primme->massMatrixCache ?
+            (size_t)primme->nLocal*primme->maxBlockSize : 0));
 
    /*----------------------------------------------------------------------*/
    /* The following size is always allocated as REAL                       */
    /*----------------------------------------------------------------------*/
 
-   doubleSize += 4     /* padding cause by TO_REAL aligning them to SCALAR */
+   doubleSize += 6     /* padding cause by TO_REAL aligning them to SCALAR */
       + primme->maxBasisSize                       /* Size of hVals        */
       + primme->numEvals+primme->maxBasisSize      /* Size of prevRitzVals */
       + primme->maxBlockSize                       /* Size of blockNorms   */
-      + primme->maxBasisSize;                      /* Size of basisNorms   */
+      + primme->maxBlockSize                       /* Size of precondShifts*/
+      + primme->maxBasisSize                       /* Size of basisNorms   */
+      + primme->maxBasisSize;                      /* Size of restartsW    */
 
    /*----------------------------------------------------------------------*/
    /* Determine the integer workspace needed                               */
@@ -445,8 +1794,12 @@ static int allocate_workspace(primme_params *primme, int allocate) {
       primme->realWorkSize = rworkByteSize;
       if (primme->printLevel >= 5) fprintf(primme->outputFile, 
          "Allocating real workspace: %g bytes\n", (double)primme->realWorkSize);
-      CHKERRM(MALLOC_PRIMME(rworkByteSize, (char**)&primme->realWork), MALLOC_FAILURE,
+      CHKERRM(Num_malloc_workspace_primme(rworkByteSize, &primme->realWork),
+            MALLOC_FAILURE,
             "Failed to allocate %g bytes\n", (double)rworkByteSize);
+
+      /* A new workspace has no basis from a previous call */
+      primme->warmBasisSize = 0;
    }
 
    if (primme->intWork != NULL
@@ -497,7 +1850,13 @@ static int check_input(REAL *evals, SCALAR *evecs, REAL *resNorms,
    else if (primme->applyPreconditioner == NULL && 
             primme->correctionParams.precondition > 0 ) 
       ret = -8;
-   else if (primme->massMatrixMatvec != NULL)
+   else if (primme->massMatrixMatvec != NULL && (primme->locking
+            || primme->numOrthoConst > 0
+            || primme->correctionParams.maxInnerIterations != 0
+            || primme->dynamicMethodSwitch > 0
+            || primme->projectionParams.projection != primme_proj_RR
+            || primme->sStepSize > 1 || primme->chebyshevDegree > 0
+            || primme->warmStart))
       ret = -9; 
    else if (primme->numEvals > primme->n)
       ret = -10;
@@ -566,6 +1925,11 @@ static int check_input(REAL *evals, SCALAR *evecs, REAL *resNorms,
          && (primme->target == primme_closest_leq
             || primme->target == primme_closest_geq))
       ret = -38;
+   else if (primme->traceFileName && primme->traceSize <= 0)
+      ret = -39;
+   else if (primme->checkpointFun && (primme->locking
+            || primme->massMatrixMatvec || primme->checkpointInterval < 1))
+      ret = -40;
    /* Please keep this if instruction at the end */
    else if ( primme->target == primme_largest_abs ||
              primme->target == primme_closest_geq ||
@@ -678,9 +2042,16 @@ static void default_monitor(void *basisEvals_, int *basisSize, int *basisFlags,
                fprintf(primme->outputFile, 
                      "OUT %" PRIMME_INT_P " conv %d blk %d MV %" PRIMME_INT_P " Sec %E EV %13E |r| %.3E\n",
                      primme->stats.numOuterIterations, found, i,
-                     primme->stats.numMatvecs, primme_wTimer(0),
+                     primme->stats.numMatvecs,
+                     primme_get_wtime() - primme->startTime,
                      basisEvals[iblock[i]], (double)basisNorms[iblock[i]]);
             }
+            if (primme->stats.estimateRemainingMatvecs >= 0.0) {
+               fprintf(primme->outputFile,
+                     "ETA MV %.0f Sec %E\n",
+                     primme->stats.estimateRemainingMatvecs,
+                     primme->stats.estimateRemainingTime);
+            }
          }
          break;
       case primme_event_inner_iteration:
@@ -689,7 +2060,8 @@ static void default_monitor(void *basisEvals_, int *basisSize, int *basisFlags,
          if (primme->printLevel >= 4) {
             fprintf(primme->outputFile,
                   "INN MV %" PRIMME_INT_P " Sec %e Eval %e Lin|r| %.3e EV|r| %.3e\n",
-                  primme->stats.numMatvecs, primme_wTimer(0),
+                  primme->stats.numMatvecs,
+                  primme_get_wtime() - primme->startTime,
                   (double)basisEvals[iblock[0]], (double)*LSRes,
                   (double)basisNorms[iblock[0]]);
          }
@@ -702,7 +2074,7 @@ static void default_monitor(void *basisEvals_, int *basisSize, int *basisFlags,
                   "#Converged %d eval[ %d ]= %e norm %e Mvecs %" PRIMME_INT_P " Time %g\n",
                   *numConverged, iblock[0], basisEvals[iblock[0]],
                   basisNorms[iblock[0]], primme->stats.numMatvecs,
-                  primme_wTimer(0));
+                  primme_get_wtime() - primme->startTime);
          break;
       case primme_event_locked:
          assert(numLocked && lockedEvals && lockedNorms && lockedFlags);
@@ -710,7 +2082,9 @@ static void default_monitor(void *basisEvals_, int *basisSize, int *basisFlags,
             fprintf(primme->outputFile, 
                   "Lock epair[ %d ]= %e norm %.4e Mvecs %" PRIMME_INT_P " Time %.4e Flag %d\n",
                   *numLocked-1, lockedEvals[*numLocked-1], lockedNorms[*numLocked-1], 
-                  primme->stats.numMatvecs, primme_wTimer(0), lockedFlags[*numLocked-1]);
+                  primme->stats.numMatvecs,
+                  primme_get_wtime() - primme->startTime,
+                  lockedFlags[*numLocked-1]);
          }
          break;
       default:
@@ -71,6 +71,7 @@ void primme_initialize(primme_params *primme) {
    primme->matrixMatvec            = NULL;
    primme->applyPreconditioner     = NULL;
    primme->massMatrixMatvec        = NULL;
+   primme->matrixMatvecProject     = NULL;
 
    /* Shifts for interior eigenvalues*/
    primme->numTargetShifts         = 0;
@@ -82,6 +83,53 @@ void primme_initialize(primme_params *primme) {
    primme->nLocal                  = -1;
    primme->commInfo                = NULL;
    primme->globalSumReal           = NULL;
+   primme->globalSumRealStart      = NULL;
+   primme->globalSumRealWait       = NULL;
+   primme->numThreads              = 0;
+   primme->firstTouch              = 0;
+   primme->sStepSize               = 0;
+   primme->dcMinBasisSize          = 128;
+   primme->incrementalRR           = 0;
+   primme->pipelinedQMR            = 0;
+   primme->chebyshevDegree         = 0;
+   primme->dynamicBlockSize        = 0;
+   primme->dynamicModel            = NULL;
+   primme->warmStart               = 0;
+   primme->warmBasisSize           = 0;
+   primme->lockingBatchSize        = 0;
+   primme->lockedPanelSize         = 0;
+   primme->lockedPaging            = NULL;
+   primme->traceFileName           = NULL;
+   primme->traceSize               = 65536;
+   primme->trace                   = NULL;
+   primme->matrixMatvecStart       = NULL;
+   primme->matrixMatvecWait        = NULL;
+   primme->massMatrixCache         = 1;
+   primme->innerSinglePrecision    = 0;
+   primme->matrixMatvecSingle      = NULL;
+   primme->applyPreconditionerSingle = NULL;
+   primme->convTestFunBlock        = NULL;
+   primme->monitorEvents           = -1;
+   primme->monitorInterval         = 0.0;
+   primme->rowMajorOPs             = 0;
+   primme->checkpointFun           = NULL;
+   primme->checkpointInterval      = 1;
+   primme->precondShiftUpdate      = NULL;
+   primme->precondShiftTol         = 0.0;
+   primme->precisionCascade        = 0;
+   primme->matrixMatvecHalf        = NULL;
+   primme->matvecHalfType          = primme_half_fp16;
+   primme->matvecHalfActive        = 0;
+   primme->matrixPowers            = NULL;
+   primme->multiShiftBlock         = 0;
+   primme->evalsOnly               = 0;
+   primme->lockedSinglePrecision   = 0;
+   primme->lockedCopy              = NULL;
+   primme->lockedCopyOf            = NULL;
+   primme->lockedCopyCols          = 0;
+   primme->basisPanelRows          = 0;
+   primme->basisPaging             = NULL;
+   primme->statsImbalance          = 0;
 
    /* Initial guesses/constraints */
    primme->initSize                = 0;
@@ -90,6 +138,7 @@ void primme_initialize(primme_params *primme) {
    primme->projectionParams.projection = primme_proj_default;
 
    primme->initBasisMode                       = primme_init_default;
+   primme->orth                                = primme_orth_default;
 
    /* Eigensolver parameters (outer) */
    primme->locking                             = -1;
@@ -135,6 +184,29 @@ void primme_initialize(primme_params *primme) {
    primme->stats.estimateLargestSVal           = -HUGE_VAL;
    primme->stats.maxConvTol                    = 0.0;
    primme->stats.estimateResidualError         = 0.0;
+   primme->stats.numGlobalSumMerged            = 0;
+   primme->stats.timeSolveH                  = 0.0;
+   primme->stats.timeRestart                 = 0.0;
+   primme->stats.timeUpdateVWXR              = 0.0;
+   primme->stats.timeConvCheck               = 0.0;
+   primme->stats.timeInnerSolve              = 0.0;
+   primme->stats.timeWorkspace               = 0.0;
+   primme->stats.timeGlobalSumInterNode      = 0.0;
+   primme->stats.orthoLossFactor             = 0.0;
+   primme->stats.timeMatvecMin             = 0.0;
+   primme->stats.timeMatvecMax             = 0.0;
+   primme->stats.timeMatvecAvg             = 0.0;
+   primme->stats.timePrecondMin            = 0.0;
+   primme->stats.timePrecondMax            = 0.0;
+   primme->stats.timePrecondAvg            = 0.0;
+   primme->stats.timeGlobalSumMin          = 0.0;
+   primme->stats.timeGlobalSumMax          = 0.0;
+   primme->stats.timeGlobalSumAvg          = 0.0;
+   primme->stats.timeGlobalSumWaiting      = 0.0;
+   primme->stats.imbalanceFactor           = 0.0;
+   primme->stats.slowestProc                 = 0;
+   primme->stats.estimateRemainingMatvecs    = 0.0;
+   primme->stats.estimateRemainingTime       = 0.0;
 
    /* Optional user defined structures */
    primme->matrix                  = NULL;
@@ -220,6 +292,8 @@ void primme_free(primme_params *primme) {
  *        STEEPEST_DESCENT,      : equiv. to GD(block,2*block)
  *        LOBPCG_OrthoBasis,       : equiv. to GD(nev,3*nev)+nev
  *        LOBPCG_OrthoBasis_Window : equiv. to GD(block,3*block)+block nev>block
+ *        GD_plusK_sStep           : GD+k adding several blocks per iteration
+ *        Lanczos                  : thick-restart Lanczos with selective reortho
  *
  *
  * INPUT/OUTPUT
@@ -242,6 +316,12 @@ int primme_set_method(primme_preset_method method, primme_params *primme) {
    if (method == PRIMME_DEFAULT_METHOD)
       method = PRIMME_DYNAMIC;
 
+   /* Generalized problems are only supported without inner iterations */
+   if (primme->massMatrixMatvec && (method == PRIMME_DYNAMIC
+            || method == PRIMME_DEFAULT_MIN_TIME)) {
+      method = PRIMME_DEFAULT_MIN_MATVECS;
+   }
+
    /* From our experience, these two methods yield the smallest matvecs/time */
    /* DYNAMIC will make some timings before it settles on one of the two     */
    if (method == PRIMME_DEFAULT_MIN_MATVECS) {
@@ -282,6 +362,16 @@ int primme_set_method(primme_preset_method method, primme_params *primme) {
       primme->correctionParams.precondition       = 0;
       primme->correctionParams.maxInnerIterations = 0;
    }
+   else if (method == PRIMME_Lanczos) {
+      primme->restartingParams.maxPrevRetain      = 0;
+      primme->correctionParams.precondition       = 0;
+      primme->correctionParams.maxInnerIterations = 0;
+      primme->correctionParams.projectors.RightX  = 0;
+      primme->correctionParams.projectors.SkewX   = 0;
+      if (primme->orth == primme_orth_default) {
+         primme->orth                             = primme_orth_selective;
+      }
+   }
    else if (method == PRIMME_GD) {
       primme->restartingParams.maxPrevRetain      = 0;
       primme->correctionParams.robustShifts       = 1;
@@ -302,6 +392,22 @@ int primme_set_method(primme_preset_method method, primme_params *primme) {
       primme->correctionParams.projectors.RightX  = 0;
       primme->correctionParams.projectors.SkewX   = 0;
    }
+   else if (method == PRIMME_GD_plusK_sStep) {
+      if (primme->restartingParams.maxPrevRetain <= 0) {
+         if (primme->maxBlockSize == 1 && primme->numEvals > 1) {
+            primme->restartingParams.maxPrevRetain = 2;
+         }
+         else {
+            primme->restartingParams.maxPrevRetain = primme->maxBlockSize;
+         }
+      }
+      if (primme->sStepSize <= 1) {
+         primme->sStepSize                        = 4;
+      }
+      primme->correctionParams.maxInnerIterations = 0;
+      primme->correctionParams.projectors.RightX  = 0;
+      primme->correctionParams.projectors.SkewX   = 0;
+   }
    else if (method == PRIMME_GD_Olsen_plusK) {
       if (primme->restartingParams.maxPrevRetain <= 0) {
          if (primme->maxBlockSize == 1 && primme->numEvals > 1) {
@@ -474,6 +580,8 @@ void primme_set_defaults(primme_params *primme) {
       primme->projectionParams.projection = primme_proj_RR;
    if (primme->initBasisMode == primme_init_default)
       primme->initBasisMode = primme_init_krylov;
+   if (primme->orth == primme_orth_default)
+      primme->orth = primme_orth_vector;
 
    /* If we are free to choose the leading dimension of V and W, use    */
    /* a multiple of PRIMME_BLOCK_SIZE. This may improve the performance */
@@ -527,6 +635,10 @@ void primme_set_defaults(primme_params *primme) {
    if (primme->locking >= 0) {
       /* Honor the user setup (do nothing) */
    }
+   else if (primme->massMatrixMatvec) {
+      /* Locking is not supported in generalized problems */
+      primme->locking = 0;
+   }
    else if (primme->target != primme_smallest && primme->target != primme_largest) {
        primme->locking = 1;
    }
@@ -589,6 +701,8 @@ void primme_display_params_prefix(const char* prefix, primme_params primme) {
    PRINT_PRIMME_INT(nLocal);
    PRINT(numProcs, %d);
    PRINT(procID, %d);
+   PRINT(numThreads, %d);
+   PRINT(firstTouch, %d);
 
    fprintf(outputFile, "\n// Output and reporting\n");
    PRINT(printLevel, %d);
@@ -600,6 +714,33 @@ void primme_display_params_prefix(const char* prefix, primme_params primme) {
    PRINT(maxBasisSize, %d);
    PRINT(minRestartSize, %d);
    PRINT(maxBlockSize, %d);
+   PRINT(sStepSize, %d);
+   PRINT(dcMinBasisSize, %d);
+   PRINT(incrementalRR, %d);
+   PRINT(pipelinedQMR, %d);
+   PRINT(chebyshevDegree, %d);
+   PRINT(dynamicBlockSize, %d);
+   PRINT(warmStart, %d);
+   PRINT(warmBasisSize, %d);
+   PRINT(lockingBatchSize, %d);
+   PRINT(lockedPanelSize, %d);
+   if (primme.traceFileName) PRINT(traceFileName, %s);
+   PRINT(traceSize, %d);
+   PRINT(massMatrixCache, %d);
+   PRINT(innerSinglePrecision, %d);
+   PRINT(monitorEvents, %d);
+   PRINT(monitorInterval, %e);
+   PRINT(rowMajorOPs, %d);
+   PRINT(checkpointInterval, %d);
+   PRINT(precondShiftTol, %e);
+   PRINT(precisionCascade, %d);
+   PRINT(multiShiftBlock, %d);
+   PRINT(evalsOnly, %d);
+   PRINT(lockedSinglePrecision, %d);
+   PRINT_PRIMME_INT(basisPanelRows);
+   PRINT(statsImbalance, %d);
+   PRINTIF(matvecHalfType, primme_half_fp16);
+   PRINTIF(matvecHalfType, primme_half_bf16);
    PRINT_PRIMME_INT(maxOuterIterations);
    PRINT_PRIMME_INT(maxMatvecs);
 
@@ -620,6 +761,13 @@ void primme_display_params_prefix(const char* prefix, primme_params primme) {
    PRINTIF(initBasisMode, primme_init_random);
    PRINTIF(initBasisMode, primme_init_user);
 
+   PRINTIF(orth, primme_orth_default);
+   PRINTIF(orth, primme_orth_vector);
+   PRINTIF(orth, primme_orth_block);
+   PRINTIF(orth, primme_orth_lowsync);
+   PRINTIF(orth, primme_orth_selective);
+   PRINTIF(orth, primme_orth_adaptive);
+
    PRINT(numTargetShifts, %d);
    if (primme.numTargetShifts > 0 && primme.targetShifts) {
       fprintf(outputFile, "%s.targetShifts =", prefix);
@@ -630,6 +778,13 @@ void primme_display_params_prefix(const char* prefix, primme_params primme) {
    }
 
    PRINT(dynamicMethodSwitch, %d);
+   if (primme.dynamicModel) {
+      fprintf(outputFile, "%s.dynamicModel =", prefix);
+      for (i=0; i<PRIMME_DYNAMIC_MODEL_SIZE;i++) {
+         fprintf(outputFile, " %e",primme.dynamicModel[i]);
+      }
+      fprintf(outputFile, "\n");
+   }
    PRINT(locking, %d);
    PRINT(initSize, %d);
    PRINT(numOrthoConst, %d);
@@ -705,6 +860,8 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       double double_v;
       FILE *file_v;
       primme_init init_v;
+      primme_orth orth_v;
+      primme_half half_v;
       primme_projection projection_v;
       primme_restartscheme restartscheme_v;
       primme_convergencetest convergencetest_v;
@@ -713,6 +870,26 @@ int primme_get_member(primme_params *primme, primme_params_label label,
             void *lockedEvals, int *numLocked, int *lockedFlags, void *lockedNorms,
             int *inner_its, void *LSRes, primme_event *event,
             struct primme_params *primme, int *err);
+      void (*matProjFunc_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int *,
+            void *,PRIMME_INT*,int*,void*,int*,struct primme_params *,int*);
+      void (*lockedPagingFunc_v)(void *,PRIMME_INT*,int*,int*,
+            struct primme_params *,int*);
+      void (*basisPagingFunc_v)(void *,PRIMME_INT*,PRIMME_INT*,int*,int*,
+            struct primme_params *,int*);
+      void (*globalSumRealStartFunc_v) (void *,void *,int *,
+            struct primme_params *,void **,int*);
+      void (*globalSumRealWaitFunc_v) (void *,struct primme_params *,int*);
+      void (*matStartFunc_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int *,
+            struct primme_params *,void **,int*);
+      void (*matWaitFunc_v) (void *,struct primme_params *,int*);
+      void (*convTestFunBlock_v)(void *,void *,PRIMME_INT*,void *,int*,int*,
+            struct primme_params *,int*);
+      void (*checkpointFun_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int*,
+            int*,struct primme_params *,int*);
+      void (*precondShiftUpdate_v)(double*,double*,int*,
+            struct primme_params *,int*);
+      void (*matrixPowers_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int*,
+            int*,double*,double*,double*,struct primme_params *,int*);
    } *v = (union value_t*)value;
 
    switch (label) {
@@ -725,6 +902,9 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_massMatrixMatvec:
               v->matFunc_v = primme->massMatrixMatvec;
       break;
+      case PRIMME_matrixMatvecProject:
+              v->matProjFunc_v = primme->matrixMatvecProject;
+      break;
       case PRIMME_applyPreconditioner:
               v->matFunc_v = primme->applyPreconditioner;
       break;
@@ -743,6 +923,12 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_globalSumReal:
               v->globalSumRealFunc_v = primme->globalSumReal;
       break;
+      case PRIMME_globalSumRealStart:
+              v->globalSumRealStartFunc_v = primme->globalSumRealStart;
+      break;
+      case PRIMME_globalSumRealWait:
+              v->globalSumRealWaitFunc_v = primme->globalSumRealWait;
+      break;
       case PRIMME_numEvals:
               v->int_v = primme->numEvals;
       break;
@@ -810,6 +996,128 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_printLevel:
               v->int_v = primme->printLevel;
       break;
+      case PRIMME_numThreads:
+              v->int_v = primme->numThreads;
+      break;
+      case PRIMME_firstTouch:
+              v->int_v = primme->firstTouch;
+      break;
+      case PRIMME_sStepSize:
+              v->int_v = primme->sStepSize;
+      break;
+      case PRIMME_dcMinBasisSize:
+              v->int_v = primme->dcMinBasisSize;
+      break;
+      case PRIMME_incrementalRR:
+              v->int_v = primme->incrementalRR;
+      break;
+      case PRIMME_pipelinedQMR:
+              v->int_v = primme->pipelinedQMR;
+      break;
+      case PRIMME_chebyshevDegree:
+              v->int_v = primme->chebyshevDegree;
+      break;
+      case PRIMME_dynamicBlockSize:
+              v->int_v = primme->dynamicBlockSize;
+      break;
+      case PRIMME_warmStart:
+              v->int_v = primme->warmStart;
+      break;
+      case PRIMME_warmBasisSize:
+              v->int_v = primme->warmBasisSize;
+      break;
+      case PRIMME_lockingBatchSize:
+              v->int_v = primme->lockingBatchSize;
+      break;
+      case PRIMME_lockedPanelSize:
+              v->int_v = primme->lockedPanelSize;
+      break;
+      case PRIMME_lockedPaging:
+              v->lockedPagingFunc_v = primme->lockedPaging;
+      break;
+      case PRIMME_traceFileName:
+              v->ptr_v = primme->traceFileName;
+      break;
+      case PRIMME_traceSize:
+              v->int_v = primme->traceSize;
+      break;
+      case PRIMME_matrixMatvecStart:
+              v->matStartFunc_v = primme->matrixMatvecStart;
+      break;
+      case PRIMME_matrixMatvecWait:
+              v->matWaitFunc_v = primme->matrixMatvecWait;
+      break;
+      case PRIMME_massMatrixCache:
+              v->int_v = primme->massMatrixCache;
+      break;
+      case PRIMME_innerSinglePrecision:
+              v->int_v = primme->innerSinglePrecision;
+      break;
+      case PRIMME_matrixMatvecSingle:
+              v->matFunc_v = primme->matrixMatvecSingle;
+      break;
+      case PRIMME_applyPreconditionerSingle:
+              v->matFunc_v = primme->applyPreconditionerSingle;
+      break;
+      case PRIMME_convTestFunBlock:
+              v->convTestFunBlock_v = primme->convTestFunBlock;
+      break;
+      case PRIMME_monitorEvents:
+              v->int_v = primme->monitorEvents;
+      break;
+      case PRIMME_monitorInterval:
+              v->double_v = primme->monitorInterval;
+      break;
+      case PRIMME_rowMajorOPs:
+              v->int_v = primme->rowMajorOPs;
+      break;
+      case PRIMME_checkpointFun:
+              v->checkpointFun_v = primme->checkpointFun;
+      break;
+      case PRIMME_checkpointInterval:
+              v->int_v = primme->checkpointInterval;
+      break;
+      case PRIMME_precondShiftUpdate:
+              v->precondShiftUpdate_v = primme->precondShiftUpdate;
+      break;
+      case PRIMME_precondShiftTol:
+              v->double_v = primme->precondShiftTol;
+      break;
+      case PRIMME_precisionCascade:
+              v->int_v = primme->precisionCascade;
+      break;
+      case PRIMME_matrixMatvecHalf:
+              v->matFunc_v = primme->matrixMatvecHalf;
+      break;
+      case PRIMME_matvecHalfType:
+              v->half_v = primme->matvecHalfType;
+      break;
+      case PRIMME_matrixPowers:
+              v->matrixPowers_v = primme->matrixPowers;
+      break;
+      case PRIMME_multiShiftBlock:
+              v->int_v = primme->multiShiftBlock;
+      break;
+      case PRIMME_evalsOnly:
+              v->int_v = primme->evalsOnly;
+      break;
+      case PRIMME_lockedSinglePrecision:
+              v->int_v = primme->lockedSinglePrecision;
+      break;
+      case PRIMME_basisPanelRows:
+              v->int_v = primme->basisPanelRows;
+      break;
+      case PRIMME_basisPaging:
+              v->basisPagingFunc_v = primme->basisPaging;
+      break;
+      case PRIMME_statsImbalance:
+              v->int_v = primme->statsImbalance;
+      break;
+      case PRIMME_dynamicModel:
+         for (i=0; primme->dynamicModel && i<PRIMME_DYNAMIC_MODEL_SIZE; i++) {
+             (&v->double_v)[i] = primme->dynamicModel[i];
+         }
+      break;
       case PRIMME_outputFile:
               v->file_v = primme->outputFile;
       break;
@@ -819,6 +1127,9 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_preconditioner:
               v->ptr_v = primme->preconditioner;
       break;
+      case PRIMME_orth:
+              v->orth_v = primme->orth;
+      break;
       case PRIMME_restartingParams_scheme:
               v->restartscheme_v = primme->restartingParams.scheme;
       break;
@@ -876,6 +1187,9 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_stats_volumeGlobalSum:
               v->int_v = primme->stats.volumeGlobalSum;
       break;
+      case PRIMME_stats_numGlobalSumMerged:
+              v->int_v = primme->stats.numGlobalSumMerged;
+      break;
       case PRIMME_stats_numOrthoInnerProds:
               v->double_v = primme->stats.numOrthoInnerProds;
       break;
@@ -894,6 +1208,27 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_stats_timeGlobalSum:
               v->double_v = primme->stats.timeGlobalSum;
       break;
+      case PRIMME_stats_timeSolveH:
+              v->double_v = primme->stats.timeSolveH;
+      break;
+      case PRIMME_stats_timeRestart:
+              v->double_v = primme->stats.timeRestart;
+      break;
+      case PRIMME_stats_timeUpdateVWXR:
+              v->double_v = primme->stats.timeUpdateVWXR;
+      break;
+      case PRIMME_stats_timeConvCheck:
+              v->double_v = primme->stats.timeConvCheck;
+      break;
+      case PRIMME_stats_timeInnerSolve:
+              v->double_v = primme->stats.timeInnerSolve;
+      break;
+      case PRIMME_stats_timeWorkspace:
+              v->double_v = primme->stats.timeWorkspace;
+      break;
+      case PRIMME_stats_timeGlobalSumInterNode:
+              v->double_v = primme->stats.timeGlobalSumInterNode;
+      break;
       case PRIMME_stats_estimateMinEVal:
               v->double_v = primme->stats.estimateMinEVal;
       break;
@@ -903,6 +1238,51 @@ int primme_get_member(primme_params *primme, primme_params_label label,
       case PRIMME_stats_estimateLargestSVal:
               v->double_v = primme->stats.estimateLargestSVal;
       break;
+      case PRIMME_stats_orthoLossFactor:
+              v->double_v = primme->stats.orthoLossFactor;
+      break;
+      case PRIMME_stats_timeMatvecMin:
+              v->double_v = primme->stats.timeMatvecMin;
+      break;
+      case PRIMME_stats_timeMatvecMax:
+              v->double_v = primme->stats.timeMatvecMax;
+      break;
+      case PRIMME_stats_timeMatvecAvg:
+              v->double_v = primme->stats.timeMatvecAvg;
+      break;
+      case PRIMME_stats_timePrecondMin:
+              v->double_v = primme->stats.timePrecondMin;
+      break;
+      case PRIMME_stats_timePrecondMax:
+              v->double_v = primme->stats.timePrecondMax;
+      break;
+      case PRIMME_stats_timePrecondAvg:
+              v->double_v = primme->stats.timePrecondAvg;
+      break;
+      case PRIMME_stats_timeGlobalSumMin:
+              v->double_v = primme->stats.timeGlobalSumMin;
+      break;
+      case PRIMME_stats_timeGlobalSumMax:
+              v->double_v = primme->stats.timeGlobalSumMax;
+      break;
+      case PRIMME_stats_timeGlobalSumAvg:
+              v->double_v = primme->stats.timeGlobalSumAvg;
+      break;
+      case PRIMME_stats_timeGlobalSumWaiting:
+              v->double_v = primme->stats.timeGlobalSumWaiting;
+      break;
+      case PRIMME_stats_imbalanceFactor:
+              v->double_v = primme->stats.imbalanceFactor;
+      break;
+      case PRIMME_stats_slowestProc:
+              v->int_v = primme->stats.slowestProc;
+      break;
+      case PRIMME_stats_estimateRemainingMatvecs:
+              v->double_v = primme->stats.estimateRemainingMatvecs;
+      break;
+      case PRIMME_stats_estimateRemainingTime:
+              v->double_v = primme->stats.estimateRemainingTime;
+      break;
       case PRIMME_ldevecs:
               v->int_v = primme->ldevecs;
       break;
@@ -959,6 +1339,8 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       double *double_v;
       FILE *file_v;
       primme_init *init_v;
+      primme_orth *orth_v;
+      primme_half *half_v;
       primme_projection *projection_v;
       primme_restartscheme *restartscheme_v;
       primme_convergencetest *convergencetest_v;
@@ -967,6 +1349,26 @@ int primme_set_member(primme_params *primme, primme_params_label label,
             void *lockedEvals, int *numLocked, int *lockedFlags, void *lockedNorms,
             int *inner_its, void *LSRes, primme_event *event,
             struct primme_params *primme, int *err);
+      void (*matProjFunc_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int *,
+            void *,PRIMME_INT*,int*,void*,int*,struct primme_params *,int*);
+      void (*lockedPagingFunc_v)(void *,PRIMME_INT*,int*,int*,
+            struct primme_params *,int*);
+      void (*basisPagingFunc_v)(void *,PRIMME_INT*,PRIMME_INT*,int*,int*,
+            struct primme_params *,int*);
+      void (*globalSumRealStartFunc_v) (void *,void *,int *,
+            struct primme_params *,void **,int*);
+      void (*globalSumRealWaitFunc_v) (void *,struct primme_params *,int*);
+      void (*matStartFunc_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int *,
+            struct primme_params *,void **,int*);
+      void (*matWaitFunc_v) (void *,struct primme_params *,int*);
+      void (*convTestFunBlock_v)(void *,void *,PRIMME_INT*,void *,int*,int*,
+            struct primme_params *,int*);
+      void (*checkpointFun_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int*,
+            int*,struct primme_params *,int*);
+      void (*precondShiftUpdate_v)(double*,double*,int*,
+            struct primme_params *,int*);
+      void (*matrixPowers_v)(void *,PRIMME_INT*,void *,PRIMME_INT*,int*,
+            int*,double*,double*,double*,struct primme_params *,int*);
    } v = *(union value_t*)&value;
 
    switch (label) {
@@ -979,6 +1381,9 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       case PRIMME_massMatrixMatvec:
               primme->massMatrixMatvec = v.matFunc_v;
       break;
+      case PRIMME_matrixMatvecProject:
+              primme->matrixMatvecProject = v.matProjFunc_v;
+      break;
       case PRIMME_applyPreconditioner:
               primme->applyPreconditioner = v.matFunc_v;
       break;
@@ -999,6 +1404,12 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       case PRIMME_globalSumReal:
               primme->globalSumReal = v.globalSumRealFunc_v;
       break;
+      case PRIMME_globalSumRealStart:
+              primme->globalSumRealStart = v.globalSumRealStartFunc_v;
+      break;
+      case PRIMME_globalSumRealWait:
+              primme->globalSumRealWait = v.globalSumRealWaitFunc_v;
+      break;
       case PRIMME_numEvals:
               if (*v.int_v > INT_MAX) return 1; else 
               primme->numEvals = (int)*v.int_v;
@@ -1075,6 +1486,149 @@ int primme_set_member(primme_params *primme, primme_params_label label,
               if (*v.int_v > INT_MAX) return 1; else 
               primme->printLevel = (int)*v.int_v;
       break;
+      case PRIMME_numThreads:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->numThreads = (int)*v.int_v;
+      break;
+      case PRIMME_firstTouch:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->firstTouch = (int)*v.int_v;
+      break;
+      case PRIMME_sStepSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->sStepSize = (int)*v.int_v;
+      break;
+      case PRIMME_dcMinBasisSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->dcMinBasisSize = (int)*v.int_v;
+      break;
+      case PRIMME_incrementalRR:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->incrementalRR = (int)*v.int_v;
+      break;
+      case PRIMME_pipelinedQMR:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->pipelinedQMR = (int)*v.int_v;
+      break;
+      case PRIMME_chebyshevDegree:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->chebyshevDegree = (int)*v.int_v;
+      break;
+      case PRIMME_dynamicBlockSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->dynamicBlockSize = (int)*v.int_v;
+      break;
+      case PRIMME_dynamicModel:
+              primme->dynamicModel = v.double_v;
+      break;
+      case PRIMME_warmStart:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->warmStart = (int)*v.int_v;
+      break;
+      case PRIMME_warmBasisSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->warmBasisSize = (int)*v.int_v;
+      break;
+      case PRIMME_lockingBatchSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->lockingBatchSize = (int)*v.int_v;
+      break;
+      case PRIMME_lockedPanelSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->lockedPanelSize = (int)*v.int_v;
+      break;
+      case PRIMME_lockedPaging:
+              primme->lockedPaging = v.lockedPagingFunc_v;
+      break;
+      case PRIMME_traceFileName:
+              primme->traceFileName = (char*)v.ptr_v;
+      break;
+      case PRIMME_traceSize:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->traceSize = (int)*v.int_v;
+      break;
+      case PRIMME_matrixMatvecStart:
+              primme->matrixMatvecStart = v.matStartFunc_v;
+      break;
+      case PRIMME_matrixMatvecWait:
+              primme->matrixMatvecWait = v.matWaitFunc_v;
+      break;
+      case PRIMME_massMatrixCache:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->massMatrixCache = (int)*v.int_v;
+      break;
+      case PRIMME_innerSinglePrecision:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->innerSinglePrecision = (int)*v.int_v;
+      break;
+      case PRIMME_matrixMatvecSingle:
+              primme->matrixMatvecSingle = v.matFunc_v;
+      break;
+      case PRIMME_applyPreconditionerSingle:
+              primme->applyPreconditionerSingle = v.matFunc_v;
+      break;
+      case PRIMME_convTestFunBlock:
+              primme->convTestFunBlock = v.convTestFunBlock_v;
+      break;
+      case PRIMME_monitorEvents:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->monitorEvents = (int)*v.int_v;
+      break;
+      case PRIMME_monitorInterval:
+              primme->monitorInterval = *v.double_v;
+      break;
+      case PRIMME_rowMajorOPs:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->rowMajorOPs = (int)*v.int_v;
+      break;
+      case PRIMME_checkpointFun:
+              primme->checkpointFun = v.checkpointFun_v;
+      break;
+      case PRIMME_checkpointInterval:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->checkpointInterval = (int)*v.int_v;
+      break;
+      case PRIMME_precondShiftUpdate:
+              primme->precondShiftUpdate = v.precondShiftUpdate_v;
+      break;
+      case PRIMME_precondShiftTol:
+              primme->precondShiftTol = *v.double_v;
+      break;
+      case PRIMME_precisionCascade:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->precisionCascade = (int)*v.int_v;
+      break;
+      case PRIMME_matrixMatvecHalf:
+              primme->matrixMatvecHalf = v.matFunc_v;
+      break;
+      case PRIMME_matvecHalfType:
+              primme->matvecHalfType = *v.half_v;
+      break;
+      case PRIMME_matrixPowers:
+              primme->matrixPowers = v.matrixPowers_v;
+      break;
+      case PRIMME_multiShiftBlock:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->multiShiftBlock = (int)*v.int_v;
+      break;
+      case PRIMME_evalsOnly:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->evalsOnly = (int)*v.int_v;
+      break;
+      case PRIMME_lockedSinglePrecision:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->lockedSinglePrecision = (int)*v.int_v;
+      break;
+      case PRIMME_basisPanelRows:
+              primme->basisPanelRows = *v.int_v;
+      break;
+      case PRIMME_basisPaging:
+              primme->basisPaging = v.basisPagingFunc_v;
+      break;
+      case PRIMME_statsImbalance:
+              if (*v.int_v > INT_MAX) return 1; else 
+              primme->statsImbalance = (int)*v.int_v;
+      break;
       case PRIMME_outputFile:
               primme->outputFile = v.file_v;
       break;
@@ -1090,6 +1644,9 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       case PRIMME_projectionParams_projection:
               primme->projectionParams.projection = *v.projection_v;
       break;
+      case PRIMME_orth:
+              primme->orth = *v.orth_v;
+      break;
       case PRIMME_restartingParams_scheme:
               primme->restartingParams.scheme = *v.restartscheme_v;
       break;
@@ -1154,6 +1711,9 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       case PRIMME_stats_volumeGlobalSum:
               primme->stats.volumeGlobalSum = *v.int_v;
       break;
+      case PRIMME_stats_numGlobalSumMerged:
+              primme->stats.numGlobalSumMerged = *v.int_v;
+      break;
       case PRIMME_stats_numOrthoInnerProds:
               primme->stats.numOrthoInnerProds = *v.double_v;
       break;
@@ -1172,6 +1732,27 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       case PRIMME_stats_timeGlobalSum:
               primme->stats.timeGlobalSum = *v.double_v;
       break;
+      case PRIMME_stats_timeSolveH:
+              primme->stats.timeSolveH = *v.double_v;
+      break;
+      case PRIMME_stats_timeRestart:
+              primme->stats.timeRestart = *v.double_v;
+      break;
+      case PRIMME_stats_timeUpdateVWXR:
+              primme->stats.timeUpdateVWXR = *v.double_v;
+      break;
+      case PRIMME_stats_timeConvCheck:
+              primme->stats.timeConvCheck = *v.double_v;
+      break;
+      case PRIMME_stats_timeInnerSolve:
+              primme->stats.timeInnerSolve = *v.double_v;
+      break;
+      case PRIMME_stats_timeWorkspace:
+              primme->stats.timeWorkspace = *v.double_v;
+      break;
+      case PRIMME_stats_timeGlobalSumInterNode:
+              primme->stats.timeGlobalSumInterNode = *v.double_v;
+      break;
       case PRIMME_stats_estimateMinEVal:
               primme->stats.estimateMinEVal = *v.double_v;
       break;
@@ -1184,6 +1765,51 @@ int primme_set_member(primme_params *primme, primme_params_label label,
       case PRIMME_stats_maxConvTol:
               primme->stats.maxConvTol = *v.double_v;
       break;
+      case PRIMME_stats_orthoLossFactor:
+              primme->stats.orthoLossFactor = *v.double_v;
+      break;
+      case PRIMME_stats_timeMatvecMin:
+              primme->stats.timeMatvecMin = *v.double_v;
+      break;
+      case PRIMME_stats_timeMatvecMax:
+              primme->stats.timeMatvecMax = *v.double_v;
+      break;
+      case PRIMME_stats_timeMatvecAvg:
+              primme->stats.timeMatvecAvg = *v.double_v;
+      break;
+      case PRIMME_stats_timePrecondMin:
+              primme->stats.timePrecondMin = *v.double_v;
+      break;
+      case PRIMME_stats_timePrecondMax:
+              primme->stats.timePrecondMax = *v.double_v;
+      break;
+      case PRIMME_stats_timePrecondAvg:
+              primme->stats.timePrecondAvg = *v.double_v;
+      break;
+      case PRIMME_stats_timeGlobalSumMin:
+              primme->stats.timeGlobalSumMin = *v.double_v;
+      break;
+      case PRIMME_stats_timeGlobalSumMax:
+              primme->stats.timeGlobalSumMax = *v.double_v;
+      break;
+      case PRIMME_stats_timeGlobalSumAvg:
+              primme->stats.timeGlobalSumAvg = *v.double_v;
+      break;
+      case PRIMME_stats_timeGlobalSumWaiting:
+              primme->stats.timeGlobalSumWaiting = *v.double_v;
+      break;
+      case PRIMME_stats_imbalanceFactor:
+              primme->stats.imbalanceFactor = *v.double_v;
+      break;
+      case PRIMME_stats_slowestProc:
+              primme->stats.slowestProc = *v.int_v;
+      break;
+      case PRIMME_stats_estimateRemainingMatvecs:
+              primme->stats.estimateRemainingMatvecs = *v.double_v;
+      break;
+      case PRIMME_stats_estimateRemainingTime:
+              primme->stats.estimateRemainingTime = *v.double_v;
+      break;
       case PRIMME_convTestFun:
               primme->convTestFun = v.convTestFun_v;
       break;
@@ -1251,12 +1877,55 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
    IF_IS(n                            , n);
    IF_IS(matrixMatvec                 , matrixMatvec);
    IF_IS(massMatrixMatvec             , massMatrixMatvec);
+   IF_IS(matrixMatvecProject          , matrixMatvecProject);
    IF_IS(applyPreconditioner          , applyPreconditioner);
    IF_IS(numProcs                     , numProcs);
    IF_IS(procID                       , procID);
    IF_IS(commInfo                     , commInfo);
    IF_IS(nLocal                       , nLocal);
    IF_IS(globalSumReal                , globalSumReal);
+   IF_IS(globalSumRealStart           , globalSumRealStart);
+   IF_IS(globalSumRealWait            , globalSumRealWait);
+   IF_IS(numThreads                   , numThreads);
+   IF_IS(firstTouch                   , firstTouch);
+   IF_IS(sStepSize                    , sStepSize);
+   IF_IS(dcMinBasisSize               , dcMinBasisSize);
+   IF_IS(incrementalRR                , incrementalRR);
+   IF_IS(pipelinedQMR                 , pipelinedQMR);
+   IF_IS(chebyshevDegree              , chebyshevDegree);
+   IF_IS(dynamicBlockSize             , dynamicBlockSize);
+   IF_IS(dynamicModel                 , dynamicModel);
+   IF_IS(warmStart                    , warmStart);
+   IF_IS(warmBasisSize                , warmBasisSize);
+   IF_IS(lockingBatchSize             , lockingBatchSize);
+   IF_IS(lockedPanelSize              , lockedPanelSize);
+   IF_IS(lockedPaging                 , lockedPaging);
+   IF_IS(traceFileName                , traceFileName);
+   IF_IS(traceSize                    , traceSize);
+   IF_IS(matrixMatvecStart            , matrixMatvecStart);
+   IF_IS(matrixMatvecWait             , matrixMatvecWait);
+   IF_IS(massMatrixCache              , massMatrixCache);
+   IF_IS(innerSinglePrecision         , innerSinglePrecision);
+   IF_IS(matrixMatvecSingle           , matrixMatvecSingle);
+   IF_IS(applyPreconditionerSingle    , applyPreconditionerSingle);
+   IF_IS(convTestFunBlock             , convTestFunBlock);
+   IF_IS(monitorEvents                , monitorEvents);
+   IF_IS(monitorInterval              , monitorInterval);
+   IF_IS(rowMajorOPs                  , rowMajorOPs);
+   IF_IS(checkpointFun                , checkpointFun);
+   IF_IS(checkpointInterval           , checkpointInterval);
+   IF_IS(precondShiftUpdate           , precondShiftUpdate);
+   IF_IS(precondShiftTol              , precondShiftTol);
+   IF_IS(precisionCascade             , precisionCascade);
+   IF_IS(matrixMatvecHalf             , matrixMatvecHalf);
+   IF_IS(matvecHalfType               , matvecHalfType);
+   IF_IS(matrixPowers                 , matrixPowers);
+   IF_IS(multiShiftBlock              , multiShiftBlock);
+   IF_IS(evalsOnly                    , evalsOnly);
+   IF_IS(lockedSinglePrecision        , lockedSinglePrecision);
+   IF_IS(basisPanelRows               , basisPanelRows);
+   IF_IS(basisPaging                  , basisPaging);
+   IF_IS(statsImbalance               , statsImbalance);
    IF_IS(numEvals                     , numEvals);
    IF_IS(target                       , target);
    IF_IS(numTargetShifts              , numTargetShifts);
@@ -1283,6 +1952,7 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
    IF_IS(preconditioner               , preconditioner);
    IF_IS(initBasisMode                , initBasisMode);
    IF_IS(projection_projection        , projectionParams_projection);
+   IF_IS(orth                         , orth);
    IF_IS(restarting_scheme            , restartingParams_scheme);
    IF_IS(restarting_maxPrevRetain     , restartingParams_maxPrevRetain);
    IF_IS(correction_precondition      , correctionParams_precondition);
@@ -1302,16 +1972,39 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
    IF_IS(stats_numPreconds            , stats_numPreconds);
    IF_IS(stats_numGlobalSum           , stats_numGlobalSum);
    IF_IS(stats_volumeGlobalSum        , stats_volumeGlobalSum);
+   IF_IS(stats_numGlobalSumMerged     , stats_numGlobalSumMerged);
    IF_IS(stats_numOrthoInnerProds     , stats_numOrthoInnerProds);
    IF_IS(stats_elapsedTime            , stats_elapsedTime);
    IF_IS(stats_timeMatvec             , stats_timeMatvec);
    IF_IS(stats_timePrecond            , stats_timePrecond);
    IF_IS(stats_timeOrtho              , stats_timeOrtho);
    IF_IS(stats_timeGlobalSum          , stats_timeGlobalSum);
+   IF_IS(stats_timeSolveH             , stats_timeSolveH);
+   IF_IS(stats_timeRestart            , stats_timeRestart);
+   IF_IS(stats_timeUpdateVWXR         , stats_timeUpdateVWXR);
+   IF_IS(stats_timeConvCheck          , stats_timeConvCheck);
+   IF_IS(stats_timeInnerSolve         , stats_timeInnerSolve);
+   IF_IS(stats_timeWorkspace          , stats_timeWorkspace);
+   IF_IS(stats_timeGlobalSumInterNode , stats_timeGlobalSumInterNode);
    IF_IS(stats_estimateMinEVal        , stats_estimateMinEVal);
    IF_IS(stats_estimateMaxEVal        , stats_estimateMaxEVal);
    IF_IS(stats_estimateLargestSVal    , stats_estimateLargestSVal);
    IF_IS(stats_maxConvTol             , stats_maxConvTol);
+   IF_IS(stats_orthoLossFactor        , stats_orthoLossFactor);
+   IF_IS(stats_timeMatvecMin          , stats_timeMatvecMin);
+   IF_IS(stats_timeMatvecMax          , stats_timeMatvecMax);
+   IF_IS(stats_timeMatvecAvg          , stats_timeMatvecAvg);
+   IF_IS(stats_timePrecondMin         , stats_timePrecondMin);
+   IF_IS(stats_timePrecondMax         , stats_timePrecondMax);
+   IF_IS(stats_timePrecondAvg         , stats_timePrecondAvg);
+   IF_IS(stats_timeGlobalSumMin       , stats_timeGlobalSumMin);
+   IF_IS(stats_timeGlobalSumMax       , stats_timeGlobalSumMax);
+   IF_IS(stats_timeGlobalSumAvg       , stats_timeGlobalSumAvg);
+   IF_IS(stats_timeGlobalSumWaiting   , stats_timeGlobalSumWaiting);
+   IF_IS(stats_imbalanceFactor        , stats_imbalanceFactor);
+   IF_IS(stats_slowestProc            , stats_slowestProc);
+   IF_IS(stats_estimateRemainingMatvecs, stats_estimateRemainingMatvecs);
+   IF_IS(stats_estimateRemainingTime  , stats_estimateRemainingTime);
    IF_IS(convTestFun                  , convTestFun);
    IF_IS(convtest                     , convtest);
    IF_IS(ldevecs                      , ldevecs);
@@ -1342,8 +2035,11 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
       case PRIMME_maxBlockSize:
       case PRIMME_maxMatvecs:
       case PRIMME_maxOuterIterations:
+      case PRIMME_basisPanelRows:
       case PRIMME_initBasisMode:
       case PRIMME_projectionParams_projection:
+      case PRIMME_orth:
+      case PRIMME_matvecHalfType:
       case PRIMME_restartingParams_scheme:
       case PRIMME_restartingParams_maxPrevRetain:
       case PRIMME_correctionParams_precondition:
@@ -1362,6 +2058,8 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
       case PRIMME_stats_numPreconds:
       case PRIMME_stats_numGlobalSum:
       case PRIMME_stats_volumeGlobalSum:
+      case PRIMME_stats_numGlobalSumMerged:
+      case PRIMME_stats_slowestProc:
       case PRIMME_numProcs:
       case PRIMME_procID:
       case PRIMME_nLocal:
@@ -1369,6 +2067,29 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
       case PRIMME_intWorkSize:
       case PRIMME_realWorkSize:
       case PRIMME_printLevel:
+      case PRIMME_numThreads:
+      case PRIMME_firstTouch:
+      case PRIMME_sStepSize:
+      case PRIMME_dcMinBasisSize:
+      case PRIMME_incrementalRR:
+      case PRIMME_pipelinedQMR:
+      case PRIMME_chebyshevDegree:
+      case PRIMME_dynamicBlockSize:
+      case PRIMME_warmStart:
+      case PRIMME_warmBasisSize:
+      case PRIMME_lockingBatchSize:
+      case PRIMME_lockedPanelSize:
+      case PRIMME_traceSize:
+      case PRIMME_massMatrixCache:
+      case PRIMME_innerSinglePrecision:
+      case PRIMME_precisionCascade:
+      case PRIMME_multiShiftBlock:
+      case PRIMME_evalsOnly:
+      case PRIMME_lockedSinglePrecision:
+      case PRIMME_statsImbalance:
+      case PRIMME_monitorEvents:
+      case PRIMME_rowMajorOPs:
+      case PRIMME_checkpointInterval:
       case PRIMME_ldevecs:
       case PRIMME_ldOPs:
       if (type) *type = primme_int;
@@ -1384,17 +2105,40 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
 
       case PRIMME_aNorm:
       case PRIMME_eps:
+      case PRIMME_monitorInterval:
+      case PRIMME_precondShiftTol:
       case PRIMME_correctionParams_relTolBase:
       case PRIMME_stats_numOrthoInnerProds:
       case PRIMME_stats_timeMatvec:
       case PRIMME_stats_timePrecond:
       case PRIMME_stats_timeOrtho:
       case PRIMME_stats_timeGlobalSum:
+      case PRIMME_stats_timeSolveH:
+      case PRIMME_stats_timeRestart:
+      case PRIMME_stats_timeUpdateVWXR:
+      case PRIMME_stats_timeConvCheck:
+      case PRIMME_stats_timeInnerSolve:
+      case PRIMME_stats_timeWorkspace:
+      case PRIMME_stats_timeGlobalSumInterNode:
       case PRIMME_stats_elapsedTime:
       case PRIMME_stats_estimateMinEVal:
       case PRIMME_stats_estimateMaxEVal:
       case PRIMME_stats_estimateLargestSVal:
       case PRIMME_stats_maxConvTol:
+      case PRIMME_stats_orthoLossFactor:
+      case PRIMME_stats_timeMatvecMin:
+      case PRIMME_stats_timeMatvecMax:
+      case PRIMME_stats_timeMatvecAvg:
+      case PRIMME_stats_timePrecondMin:
+      case PRIMME_stats_timePrecondMax:
+      case PRIMME_stats_timePrecondAvg:
+      case PRIMME_stats_timeGlobalSumMin:
+      case PRIMME_stats_timeGlobalSumMax:
+      case PRIMME_stats_timeGlobalSumAvg:
+      case PRIMME_stats_timeGlobalSumWaiting:
+      case PRIMME_stats_imbalanceFactor:
+      case PRIMME_stats_estimateRemainingMatvecs:
+      case PRIMME_stats_estimateRemainingTime:
       if (type) *type = primme_double;
       if (arity) *arity = 1;
       break;
@@ -1404,19 +2148,39 @@ int primme_member_info(primme_params_label *label_, const char** label_name_,
       if (arity) *arity = 0;
       break;
 
+      case PRIMME_dynamicModel:
+      if (type) *type = primme_double;
+      if (arity) *arity = PRIMME_DYNAMIC_MODEL_SIZE;
+      break;
+
       /* members with type pointer */
 
       case PRIMME_matrixMatvec:
       case PRIMME_applyPreconditioner:
       case PRIMME_commInfo:
       case PRIMME_globalSumReal:
+      case PRIMME_globalSumRealStart:
+      case PRIMME_globalSumRealWait:
       case PRIMME_intWork:
       case PRIMME_realWork:
       case PRIMME_massMatrixMatvec:
+      case PRIMME_matrixMatvecProject:
+      case PRIMME_matrixMatvecStart:
+      case PRIMME_matrixMatvecWait:
+      case PRIMME_matrixMatvecSingle:
+      case PRIMME_applyPreconditionerSingle:
+      case PRIMME_matrixMatvecHalf:
+      case PRIMME_matrixPowers:
+      case PRIMME_lockedPaging:
+      case PRIMME_basisPaging:
+      case PRIMME_traceFileName:
       case PRIMME_outputFile:
       case PRIMME_matrix:
       case PRIMME_preconditioner:
       case PRIMME_convTestFun:
+      case PRIMME_convTestFunBlock:
+      case PRIMME_checkpointFun:
+      case PRIMME_precondShiftUpdate:
       case PRIMME_convtest:
       case PRIMME_monitorFun:
       case PRIMME_monitor:
@@ -1470,6 +2234,8 @@ int primme_constant_info(const char* label_name, int *value) {
    IF_IS(PRIMME_STEEPEST_DESCENT);
    IF_IS(PRIMME_LOBPCG_OrthoBasis);
    IF_IS(PRIMME_LOBPCG_OrthoBasis_Window);
+   IF_IS(PRIMME_GD_plusK_sStep);
+   IF_IS(PRIMME_Lanczos);
    
    /* enum members for targeting; restarting and innertest */
    
@@ -1487,6 +2253,14 @@ int primme_constant_info(const char* label_name, int *value) {
    IF_IS(primme_init_krylov);
    IF_IS(primme_init_random);
    IF_IS(primme_init_user);
+   IF_IS(primme_orth_default);
+   IF_IS(primme_orth_vector);
+   IF_IS(primme_orth_block);
+   IF_IS(primme_orth_lowsync);
+   IF_IS(primme_orth_selective);
+   IF_IS(primme_orth_adaptive);
+   IF_IS(primme_half_fp16);
+   IF_IS(primme_half_bf16);
    IF_IS(primme_thick);
    IF_IS(primme_dtr);
    IF_IS(primme_full_LTolerance);
@@ -50,14 +50,16 @@
 #include "wtime.h"
 
 static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
-       SCALAR *W, PRIMME_INT nLocal, int basisSize, PRIMME_INT ldV, SCALAR **X,
+       SCALAR *W, SCALAR *BV, PRIMME_INT nLocal, int basisSize, PRIMME_INT ldV,
+       SCALAR **X,
        SCALAR **R, SCALAR *hVecs, int ldhVecs, int *restartPerm,
        REAL *hVals, int *flags, int *iev, int *ievSize, REAL *blockNorms,
        SCALAR *evecs, REAL *evals, REAL *resNorms, SCALAR *evecsHat,
        PRIMME_INT ldevecsHat, SCALAR *M, int ldM, int *numConverged,
        int *numConvergedStored, int numPrevRetained, int *indexOfPreviousVecs,
-       int *hVecsPerm, int reset, double machEps, SCALAR *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
+       int *hVecsPerm, int reset, int refresh, int *numFrozen,
+       int *freshResNorms, REAL *restartsW, double machEps, SCALAR *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme);
 
 static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W, 
       PRIMME_INT nLocal, int basisSize, PRIMME_INT ldV, SCALAR **X, SCALAR **R,
@@ -70,7 +72,8 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
       primme_params *primme);
 
 static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
-      PRIMME_INT ldW, SCALAR *H, int ldH, SCALAR *VtBV, int ldVtBV, SCALAR *Q,
+      PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, SCALAR *H, int ldH,
+      SCALAR *VtBV, int ldVtBV, SCALAR *Q,
       PRIMME_INT ldQ, PRIMME_INT nLocal, SCALAR *R, int ldR, SCALAR *QtV,
       int ldQtV, SCALAR *hU, int ldhU, int newldhU,
       int indexOfPreviousVecsBeforeRestart, SCALAR *hVecs, int ldhVecs,
@@ -78,8 +81,9 @@ static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       int *hVecsPerm, int restartSize, int basisSize, int numPrevRetained,
       int indexOfPreviousVecs, SCALAR *evecs, int *evecsSize,
       PRIMME_INT ldevecs, SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *M,
-      int ldM, SCALAR *UDU, int ldUDU, int *ipivot, int *targetShiftIndex,
-      int numConverged, int *numArbitraryVecs, SCALAR *hVecsRot, int ldhVecsRot,
+      int ldM, SCALAR *UDU, int ldUDU, int *ipivot, int sizeUDU,
+      int *targetShiftIndex, int numConverged, int *numArbitraryVecs,
+      SCALAR *hVecsRot, int ldhVecsRot, int explicitH, int numFrozen,
       size_t *rworkSize, SCALAR *rwork, int iworkSize, int *iwork,
       double machEps, primme_params *primme);
 
@@ -91,9 +95,11 @@ static int restart_RR(SCALAR *H, int ldH, SCALAR *hVecs, int ldhVecs,
       int *iwork, primme_params *primme);
 
 static int restart_RR_explicit(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, SCALAR *H, int ldH, SCALAR *VtBV,
-      int ldVtBV, SCALAR *hVecs, int ldhVecs, REAL *hVals, int restartSize,
-      int numLocked, int *targetShiftIndex, double machEps, size_t *rworkSize,
+      PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, PRIMME_INT nLocal,
+      SCALAR *H, int ldH, SCALAR *VtBV,
+      int ldVtBV, SCALAR *hVecs, int ldhVecs, int newldhVecs, REAL *hVals,
+      int restartSize, int basisSize, int explicitH, int numLocked,
+      int *targetShiftIndex, double machEps, size_t *rworkSize,
       SCALAR *rwork, int iworkSize, int *iwork, primme_params *primme);
 
 static int restart_refined(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
@@ -178,6 +184,9 @@ static int compute_residual_columns(PRIMME_INT m, REAL *evals, SCALAR *x,
  *
  * W                A*V
  *
+ * BV               B*V, if massMatrixMatvec and massMatrixCache are set
+ *                  (optional). V is B-orthonormal in generalized problems
+ *
  * hU               The left singular vectors of R or the eigenvectors of QtV/R
  *
  * ldhU             The leading dimension of the input hU
@@ -261,7 +270,15 @@ static int compute_residual_columns(PRIMME_INT m, REAL *evals, SCALAR *x,
  *
  * restartsSinceReset Number of restarts since last reset of V and W
  *
- * reset            flag to reset V and W at this restart
+ * restartsW        Weighted number of restarts since each column of W was
+ *                  computed (optional)
+ *
+ * reset            flag to reset V and W at this restart; if negative, only
+ *                  recompute the columns of W of the next block
+ *
+ * freshResNorms    Output flag; if nonzero, resNorms(0:numEvals-1) have the
+ *                  residual norms of the first numEvals columns of the
+ *                  restarted V and W (optional)
  *
  *
  * Return value
@@ -274,7 +291,8 @@ static int compute_residual_columns(PRIMME_INT m, REAL *evals, SCALAR *x,
  ******************************************************************************/
  
 TEMPLATE_PLEASE
-int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
+int restart_Sprimme(SCALAR *V, SCALAR *W, SCALAR *BV, PRIMME_INT nLocal,
+       int basisSize,
        PRIMME_INT ldV, REAL *hVals, REAL *hSVals, int *flags, int *iev,
        int *ievSize, REAL *blockNorms, SCALAR *evecs, PRIMME_INT ldevecs,
        int *evecsPerm, REAL *evals, REAL *resNorms, SCALAR *evecsHat,
@@ -287,8 +305,9 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
        SCALAR *hU, int ldhU, int newldhU, SCALAR *hVecs, int ldhVecs,
        int newldhVecs, int *restartSizeOutput, int *targetShiftIndex,
        int *numArbitraryVecs, SCALAR *hVecsRot, int ldhVecsRot,
-       int *restartsSinceReset, int *reset, double machEps, SCALAR *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme) {
+       int *restartsSinceReset, REAL *restartsW, int *reset,
+       int *freshResNorms, double machEps, SCALAR *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme) {
 
    int i;                   /* Loop indices */
    int restartSize;         /* Basis size after restarting                   */
@@ -298,6 +317,10 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
    int *restartPerm;        /* Permutation of hVecs used to restart V        */
    int *hVecsPerm;          /* Permutation of hVecs to sort as primme.target */
    int indexOfPreviousVecsBeforeRestart=0;/* descriptive enough name, isn't? */
+   int sizeUDU;             /* Dimension of M factorized in UDU              */
+   int explicitH;           /* Whether to compute H and VtBV from V and W    */
+   int numFrozen=0;         /* Leading columns of V and W kept at restart    */
+   int fresh;               /* Whether resNorms were computed at restart     */
    double aNorm = primme?max(primme->aNorm, primme->stats.estimateLargestSVal):0.0;
 
    /* Return memory requirement */
@@ -316,19 +339,22 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
                   rworkSize, &iworkSize0, 0, primme), -1);
       }
       else {
-         CHKERR(restart_soft_locking_Sprimme(&basisSize, NULL, NULL,
+         CHKERR(restart_soft_locking_Sprimme(&basisSize, NULL, NULL, NULL,
                nLocal, basisSize, 0, NULL, NULL, NULL, 0, NULL, NULL, NULL,
                NULL, ievSize, NULL, NULL, NULL, NULL, evecsHat, 0, NULL, 0,
-               numConverged, numConverged, *numPrevRetained, NULL, NULL, 0, 0.0,
-               NULL, rworkSize, &iworkSize0, 0, primme), -1);
+               numConverged, numConverged, *numPrevRetained, NULL, NULL, 0,
+               1, NULL, NULL, NULL, 0.0, NULL, rworkSize, &iworkSize0, 0,
+               primme), -1);
       }
 
-      CHKERR(restart_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, VtBV, 0,
+      CHKERR(restart_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, NULL, 0,
+               VtBV, 0,
                NULL, 0, 0, NULL, 0, NULL, 0, NULL, 0, 0, 0,
                NULL, 0, 0, NULL, NULL, NULL, NULL, basisSize, basisSize,
-               *numPrevRetained, basisSize, NULL,
-               NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, 0, NULL, NULL, 0,
-               rworkSize, NULL, 0, &iworkSize0, 0.0, primme), -1);
+               *numPrevRetained, basisSize, NULL, numConvergedStored, 0,
+               evecsHat, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, NULL, 0,
+               1, primme->locking ? 0 : 1, rworkSize, NULL, 0, &iworkSize0,
+               0.0, primme), -1);
 
       iworkSize0 += 2*basisSize; /* for restartPerm and hVecsPerm */
       *iwork = max(*iwork, iworkSize0);
@@ -336,6 +362,8 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
       return 0;
    }
 
+   double t0 = primme_get_wtime();
+
    /* ----------------------------------------------------------- */
    /* Remove the SKIP_UNTIL_RESTART flags.                        */
    /* ----------------------------------------------------------- */
@@ -406,12 +434,22 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
    /* and used by check_convergence to consider the error computing the     */
    /* residual norm. V and W are asked to be reset when the error is as     */
    /* much as the current residual norm. If using refined, only W is        */
-   /* reset: we haven't seen any benefit by resetting V also.               */
+   /* reset: we haven't seen any benefit by resetting V also. If asked,     */
+   /* only the columns of W of the next block are recomputed; restartsW     */
+   /* tracks the error of every column of W (see restart_soft_locking).     */
    /* --------------------------------------------------------------------- */
 
    if (!*reset) {
       ++*restartsSinceReset;
    }
+   else if (*reset < 0) {
+      ++*restartsSinceReset;
+      if (primme->printLevel >= 5 && primme->procID == 0) {
+         fprintf(primme->outputFile, 
+               "Resetting the columns of W of the next block.\n");
+         fflush(primme->outputFile);
+      }
+   }
    else {
       *restartsSinceReset = 0;
       if (!Q) *reset = 2; /* if Q, only reset W, not V */
@@ -483,17 +521,42 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
    iwork0 = &hVecsPerm[basisSize];
    iworkSize0 = iworkSize - 2*basisSize;
 
+   /* The dimension of the leading block of M factorized in UDU */
+
+   sizeUDU = *numConvergedStored + primme->numOrthoConst;
+
    if (!primme->locking) {
       SCALAR *X, *Res;
-      CHKERR(restart_soft_locking_Sprimme(&restartSize, V, W, nLocal,
+
+      /* The columns of the converged pairs may be kept in V and W between */
+      /* refreshes; see restart_soft_locking                               */
+
+      int refresh = *reset != 0 || VtBV || Q || BV || evecsHat
+         || primme->projectionParams.projection != primme_proj_RR
+         || *restartsSinceReset % SOFT_LOCKING_REFRESH_PERIOD == 0;
+
+      /* The residual norms of the pairs to return can be computed with V */
+      /* and W if restarting H keeps their Ritz values                    */
+
+      fresh = !VtBV && primme->projectionParams.projection == primme_proj_RR;
+
+      CHKERR(restart_soft_locking_Sprimme(&restartSize, V, W, BV, nLocal,
                basisSize, ldV, &X, &Res, hVecs, ldhVecs, restartPerm, hVals,
                flags, iev, ievSize, blockNorms, evecs, evals, resNorms,
                evecsHat, ldevecsHat, M, ldM, numConverged, numConvergedStored,
                *numPrevRetained, &indexOfPreviousVecs, hVecsPerm, *reset,
-               machEps, rwork, rworkSize, iwork0, iworkSize0, primme), -1);
+               refresh, &numFrozen, &fresh, restartsW, machEps, rwork,
+               rworkSize, iwork0, iworkSize0, primme), -1);
+
+      /* If the stored converged pairs were reordered or some were dropped, */
+      /* M has been permuted and has to be factorized from scratch          */
+
+      for (i=0; i < *numConvergedStored && restartPerm[i] == i; i++);
+      if (i + primme->numOrthoConst < sizeUDU) sizeUDU = 0;
    }
    else {
       SCALAR *X, *Res;
+      fresh = 0;
       CHKERR(restart_locking_Sprimme(&restartSize, V, W, nLocal, basisSize,
                ldV, &X, &Res, hVecs, ldhVecs, restartPerm, hVals, flags, iev,
                ievSize, blockNorms, evecs, ldevecs, evals, numConverged,
@@ -502,6 +565,10 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
                rworkSize, iwork0, iworkSize0, primme), -1);
    }
 
+   /* With VtBV, H and VtBV are computed from V, W and BV after resetting W */
+   /* and periodically; otherwise they are updated with hVecs               */
+
+   explicitH = *reset > 0 || *restartsSinceReset % EXPLICIT_H_PERIOD == 0;
    *reset = 0;
 
    /* Rearrange prevRitzVals according to restartPerm */
@@ -526,15 +593,16 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
 
    if (newldhVecs == 0) newldhVecs = restartSize;
    if (newldhU == 0) newldhU = restartSize;
-   CHKERR(restart_projection_Sprimme(V, ldV, W, ldV, H, ldH, VtBV, ldVtBV, Q,
+   CHKERR(restart_projection_Sprimme(V, ldV, W, ldV, BV, ldV, H, ldH, VtBV,
+            ldVtBV, Q,
             ldQ, nLocal, R, ldR, QtV, ldQtV, hU, ldhU, newldhU,
             indexOfPreviousVecsBeforeRestart, hVecs, ldhVecs, newldhVecs, hVals,
             hSVals, restartPerm, hVecsPerm, restartSize, basisSize,
             *numPrevRetained, indexOfPreviousVecs, evecs, numConvergedStored,
             primme->nLocal, evecsHat, ldevecsHat, M, ldM, UDU, ldUDU, ipivot,
-            targetShiftIndex, *numConverged, numArbitraryVecs, hVecsRot,
-            ldhVecsRot, rworkSize, rwork, iworkSize0, iwork0, machEps, primme),
-         -1);
+            sizeUDU, targetShiftIndex, *numConverged, numArbitraryVecs, hVecsRot,
+            ldhVecsRot, explicitH, numFrozen, rworkSize, rwork, iworkSize0,
+            iwork0, machEps, primme), -1);
 
    /* If all request eigenpairs converged, force the converged vectors at the */
    /* beginning of V                                                          */
@@ -542,7 +610,14 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
    if (*numConverged >= primme->numEvals && !primme->locking) {
       permute_vecs_Sprimme(V, nLocal, restartSize, ldV, hVecsPerm, rwork,
             iwork0);
+      if (BV) permute_vecs_Sprimme(BV, nLocal, restartSize, ldV, hVecsPerm,
+            rwork, iwork0);
+      if (restartsW) permute_vecs_Rprimme(restartsW, 1, restartSize, 1,
+            hVecsPerm, (REAL*)rwork, iwork0);
+      for (i=0; i < primme->numEvals && hVecsPerm[i] == i; i++);
+      if (i < primme->numEvals) fresh = 0;
    }
+   if (freshResNorms) *freshResNorms = fresh;
 
    *restartSizeOutput = restartSize; 
 
@@ -569,6 +644,7 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
          2 * sqrt((double)*restartsSinceReset) * machEps * aNorm;
    }
 
+   primme->stats.timeRestart += primme_get_wtime() - t0;
 
    return 0;
 }
@@ -618,6 +694,8 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
  *
  * W                A*V
  *
+ * BV               B*V, if massMatrixMatvec is set (optional)
+ *
  * X                Reference to the Ritz vectors of the eigenpairs in the block
  *
  * R                Reference to the residual vectors of the eigenpairs in the block
@@ -662,10 +740,24 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
  *
  * hVecsPerm        The permutation that orders the output hVals and hVecs as primme.target
  *
+ * restartsW        Weighted number of restarts since each column of W was
+ *                  computed (optional)
+ *
+ * refresh          If zero, the columns of V and W of the leading converged
+ *                  pairs that barely changed may be kept as they are
+ *
+ * freshResNorms    On input, whether the residual norms of the pairs to
+ *                  return may be computed when all of them converged. On
+ *                  output, whether resNorms(0:numEvals-1) were computed
+ *
  * 
  * OUTPUT ARRAYS AND PARAMETERS
  * ----------------------------
- * reset            flag to reset V and W at this restart
+ * reset            flag to reset V and W at this restart; if negative, only
+ *                  recompute the columns of W of the next block
+ *
+ * numFrozen        The number of leading columns of V and W kept; if nonzero,
+ *                  X and R are not computed and ievSize is zero
  * 
  *
  * Return value
@@ -678,14 +770,16 @@ int restart_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT nLocal, int basisSize,
  ******************************************************************************/
  
 static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
-       SCALAR *W, PRIMME_INT nLocal, int basisSize, PRIMME_INT ldV, SCALAR **X,
+       SCALAR *W, SCALAR *BV, PRIMME_INT nLocal, int basisSize, PRIMME_INT ldV,
+       SCALAR **X,
        SCALAR **R, SCALAR *hVecs, int ldhVecs, int *restartPerm,
        REAL *hVals, int *flags, int *iev, int *ievSize, REAL *blockNorms,
        SCALAR *evecs, REAL *evals, REAL *resNorms, SCALAR *evecsHat,
        PRIMME_INT ldevecsHat, SCALAR *M, int ldM, int *numConverged,
        int *numConvergedStored, int numPrevRetained, int *indexOfPreviousVecs,
-       int *hVecsPerm, int reset, double machEps, SCALAR *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme) {
+       int *hVecsPerm, int reset, int refresh, int *numFrozen,
+       int *freshResNorms, REAL *restartsW, double machEps, SCALAR *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme) {
 
    int i, j, k;               /* loop indices */
    int wholeSpace=0;          /* if all pairs in V are marked as converged */
@@ -697,15 +791,25 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
       SCALAR t;
       REAL d;
       *rworkSize = max(*rworkSize, (size_t)basisSize); /* permute_vecs for hVecs */
-      CHKERR(Num_reset_update_VWXR_Sprimme(NULL, NULL, nLocal, basisSize, 0, &t,
-            *restartSize, 0, NULL,
+      CHKERR(Num_reset_update_VWXR_Sprimme(NULL, NULL, NULL, nLocal,
+            basisSize, 0, &t, *restartSize, 0, NULL,
             &t, 0, *restartSize, 0,
             &t, *numConverged, *numConverged+*ievSize, 0,
             NULL, 0, 0, 0, 0,
             &t, 0, *restartSize, 0,
             &t, *numConverged, *numConverged+*ievSize, 0, &d,
-            NULL, 0, 0,
+            &d, 0, primme->numEvals,
             0, 0.0, NULL, rworkSize, primme), -1);
+      /* ortho and broadcast of the coefficient vectors after the frozen */
+      /* columns                                                          */
+      {
+         size_t rworkSize0 = 0;
+         CHKERR(ortho_Sprimme(NULL, basisSize, NULL, 0, 0, *restartSize-1,
+                  NULL, 0, 0, basisSize, NULL, 0.0, NULL, &rworkSize0, NULL),
+               -1);
+         *rworkSize = max(*rworkSize, max(rworkSize0,
+                  (size_t)basisSize*(size_t)*restartSize*2));
+      }
       /* if evecsHat, permutation matrix & compute_submatrix workspace */
       if (evecsHat) {
          *rworkSize = max(*rworkSize, 
@@ -797,6 +901,61 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
    permute_vecs_Sprimme(hVecs, basisSize, basisSize, ldhVecs, restartPerm, rwork,
          iwork);
 
+   /* -------------------------------------------------------------- */
+   /* Between refreshes, keep the columns of V and W of the leading  */
+   /* converged pairs whose Ritz vectors are still those columns up  */
+   /* to the convergence tolerance: the off-diagonal part of the     */
+   /* coefficient vector times |A| and the change of the Ritz value  */
+   /* since it converged are both below maxConvTol. As with locking, */
+   /* the coupling neglected is at most the residual norm of the     */
+   /* pair, and the next refresh restores the Ritz vectors.          */
+   /* -------------------------------------------------------------- */
+
+   *numFrozen = 0;
+   if (!refresh && !wholeSpace && *numConverged < primme->numEvals) {
+      for (k=0; k<*numConverged; k++) {
+         REAL s = 0.0;
+         for (j=0; j<basisSize; j++) {
+            if (j != k) s += REAL_PART(CONJ(hVecs[ldhVecs*k+j])*hVecs[ldhVecs*k+j]);
+         }
+         if (sqrt(s)*aNorm > primme->stats.maxConvTol
+               || fabs(hVals[k]-evals[restartPerm[k]])
+                     > primme->stats.maxConvTol) break;
+      }
+      *numFrozen = k;
+   }
+
+   /* -------------------------------------------------------------- */
+   /* Replace the coefficient vectors of the frozen columns by the   */
+   /* canonical ones and orthonormalize the rest against them. The   */
+   /* small work is done on process 0 and broadcast.                 */
+   /* -------------------------------------------------------------- */
+
+   if (*numFrozen > 0) {
+      int nF = *numFrozen, nR = *restartSize - *numFrozen;
+      size_t rworkSize0 = *rworkSize;
+
+      assert(*rworkSize >= (size_t)basisSize*nR*2);
+      *ievSize = 0;
+      Num_zero_matrix_Sprimme(hVecs, basisSize, nF, ldhVecs);
+      for (k=0; k<nF; k++) hVecs[ldhVecs*k+k] = 1.0;
+      Num_zero_matrix_Sprimme(&hVecs[ldhVecs*nF], nF, nR, ldhVecs);
+      if (primme->procID == 0) {
+         CHKERR(ortho_Sprimme(hVecs, ldhVecs, NULL, 0, nF, *restartSize-1,
+                  NULL, 0, 0, basisSize, primme->iseed, machEps, rwork,
+                  &rworkSize0, NULL), -1);
+         Num_copy_matrix_Sprimme(&hVecs[ldhVecs*nF], basisSize, nR, ldhVecs,
+               rwork, basisSize);
+      }
+      else {
+         Num_zero_matrix_Sprimme(rwork, basisSize, nR, basisSize);
+      }
+      CHKERR(globalSum_Sprimme(rwork, &rwork[basisSize*nR], basisSize*nR,
+               primme), -1);
+      Num_copy_matrix_Sprimme(&rwork[basisSize*nR], basisSize, nR, basisSize,
+            &hVecs[ldhVecs*nF], ldhVecs);
+   }
+
    /* -------------------------------------------------------------- */
    /* Restart V and W by replacing it with the current Ritz vectors. */
    /* Compute X, R, blockNorms for the next values in the block.     */
@@ -805,15 +964,68 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
    *X = &V[*restartSize*ldV];
    *R = &W[*restartSize*ldV];
 
-   CHKERR(Num_reset_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
-            hVecs, *restartSize, ldhVecs, hVals,
-            V, 0, *restartSize, ldV,
-            *X, *numConverged, *numConverged+*ievSize, ldV,
-            evecs, primme->numOrthoConst, 0, 0, primme->nLocal,
-            W, 0, *restartSize, ldV,
-            *R, *numConverged, *numConverged+*ievSize, ldV, blockNorms,
-            NULL, 0, 0,
-            reset, machEps, rwork, rworkSize, primme), -1);
+   if (*numFrozen > 0) {
+      int nF = *numFrozen, nR = *restartSize - *numFrozen;
+      *freshResNorms = 0;
+      CHKERR(Num_update_VWXR_Sprimme(&V[ldV*nF], &W[ldV*nF], nLocal,
+               basisSize-nF, ldV, &hVecs[ldhVecs*nF+nF], nR, ldhVecs, NULL,
+               &V[ldV*nF], 0, nR, ldV,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               &W[ldV*nF], 0, nR, ldV,
+               NULL, 0, 0, 0, NULL,
+               NULL, 0, 0,
+               rwork, *rworkSize, primme), -1);
+   }
+   else {
+      /* If all the pairs to return converged and they keep their place, */
+      /* compute also their residual norms for the final verification    */
+
+      if (*freshResNorms) {
+         *freshResNorms = !wholeSpace && *numConverged >= primme->numEvals
+               && *restartSize >= primme->numEvals;
+         for (i=0; *freshResNorms && i < primme->numEvals; i++) {
+            if (restartPerm[i] != i) *freshResNorms = 0;
+         }
+      }
+
+      CHKERR(Num_reset_update_VWXR_Sprimme(V, W, BV, nLocal, basisSize, ldV,
+               hVecs, *restartSize, ldhVecs, hVals,
+               V, 0, *restartSize, ldV,
+               *X, *numConverged, *numConverged+*ievSize, ldV,
+               evecs, primme->numOrthoConst, 0, 0, primme->nLocal,
+               W, 0, *restartSize, ldV,
+               *R, *numConverged, *numConverged+*ievSize, ldV, blockNorms,
+               *freshResNorms ? resNorms : NULL, 0, primme->numEvals,
+               reset, machEps, rwork, rworkSize, primme), -1);
+   }
+
+   /* -------------------------------------------------------------- */
+   /* The error in W*h(:,k) is bounded by the errors of the columns  */
+   /* of W weighted by |h(:,k)|^2 plus the error of this update. The */
+   /* recomputed columns and the ones to be added start without it.  */
+   /* -------------------------------------------------------------- */
+
+   if (restartsW) {
+      REAL *restartsW0 = (REAL*)rwork;
+      assert(*rworkSize >= (size_t)*restartSize);
+      for (i=0; i<*restartSize; i++) {
+         restartsW0[i] = 1.0;
+         for (j=0; j<basisSize; j++) {
+            REAL a = ABS(hVecs[ldhVecs*i+j]);
+            restartsW0[i] += a*a*restartsW[j];
+         }
+      }
+      for (i=0; i<primme->maxBasisSize; i++) {
+         if (i >= *restartSize || reset > 0 || (reset < 0
+                  && i >= *numConverged && i < *numConverged+*ievSize)) {
+            restartsW[i] = 0.0;
+         }
+         else {
+            restartsW[i] = restartsW0[i];
+         }
+      }
+   }
 
    if (!wholeSpace) {
       /* ----------------------------------------------------------------- */
@@ -834,7 +1046,7 @@ static int restart_soft_locking_Sprimme(int *restartSize, SCALAR *V,
       assert(rworkSize0 >= (size_t)*restartSize);
       rworkSize0 -= (size_t)*restartSize;
       CHKERR(check_convergence_Sprimme(V, nLocal, ldV, NULL, 0, NULL, 0, 0,
-               0, *restartSize, flags, fakeResNorms, hVals, NULL, machEps,
+               0, *restartSize, flags, fakeResNorms, NULL, hVals, NULL, machEps,
                rwork+*restartSize, &rworkSize0, iwork, iworkSize, primme), -1);
 
       *numConverged = 0;
@@ -1069,7 +1281,7 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
             compute_residual_columns(nLocal, NULL, NULL,
                basisSize, NULL, 0, NULL, 0, NULL, primme->maxBlockSize, 0, 0,
                NULL, 0, NULL, primme->maxBlockSize, NULL, 0, NULL, 0, NULL, 0));
-      CHKERR(Num_reset_update_VWXR_Sprimme(NULL, NULL, nLocal, basisSize,
+      CHKERR(Num_reset_update_VWXR_Sprimme(NULL, NULL, NULL, nLocal, basisSize,
                0, NULL, *restartSize, 0, NULL,
                &t, 0, *restartSize+*numLocked, 0,
                &t, 0, *ievSize, 0,
@@ -1080,7 +1292,7 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
                0, 0.0, NULL, rworkSize, primme), -1);
       CHKERR(check_convergence_Sprimme(NULL, nLocal, 0, NULL, 0, NULL,
                *numLocked, 0, *restartSize, *restartSize+*numLocked, NULL, NULL,
-               NULL, NULL, 0.0, NULL, rworkSize, iwork, 0, primme), -1);
+               NULL, NULL, NULL, 0.0, NULL, rworkSize, iwork, 0, primme), -1);
       /* for permute_vecs and ifailed */
       *iwork = max(*iwork, 2*basisSize);
       return 0;
@@ -1173,7 +1385,7 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
    }
    *X = &V[*restartSize*ldV];
    *R = &W[*restartSize*ldV];
-   CHKERR(Num_reset_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV,
+   CHKERR(Num_reset_update_VWXR_Sprimme(V, W, NULL, nLocal, basisSize, ldV,
             hVecs, *restartSize, ldhVecs, hVals,
             V, 0, *restartSize, ldV,
             *X, 0, sizeBlockNorms, ldV,
@@ -1194,7 +1406,7 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
    permute_vecs_iprimme(flags, basisSize, restartPerm, iwork);
    CHKERR(check_convergence_Sprimme(&V[ldV*left],
             nLocal, ldV, NULL, 0, NULL, *numLocked, 0, left,
-            left+numPacked, flags, lockedResNorms, hVals, NULL,
+            left+numPacked, flags, lockedResNorms, NULL, hVals, NULL,
             machEps, rwork, &rworkSize0, iwork, iworkSize, primme), -1);
 
    /* -------------------------------------------------------------- */
@@ -1354,11 +1566,11 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
 
          /* Report a pair was hard locked */
          /* NOTE: do this before sorting evals */
-         if (primme->monitorFun) {
+         if (monitor_filter_Sprimme(primme_event_locked, primme)) {
             primme_event EVENT_LOCKED = primme_event_locked;
             int err;
             lockedFlags[*numLocked-1] = flags[i];
-            primme->stats.elapsedTime = primme_wTimer(0);
+            primme->stats.elapsedTime = primme_get_wtime() - primme->startTime;
             CHKERRM((primme->monitorFun(NULL, NULL, NULL, NULL, NULL, NULL,
                         NULL, evals, numLocked, lockedFlags, resNorms, NULL, NULL,
                         &EVENT_LOCKED, primme, &err), err), -1,
@@ -1403,12 +1615,18 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
  *    Rnorms = norms(R),
  *    rnorms = norms(Wo(nrb+1-nWob:nre-nWob) - X0(nrb+1-nX0b:nre-nX0b)*diag(hVals(nrb+1:nre))),
  *
+ * If BV is given, the residual vectors are computed with B*X0 instead of X0,
+ * and BV(:,0:nX0e-nX0b-1) is replaced by B*X0; then there should be no
+ * columns in evecs. In generalized problems without BV, B is applied to the
+ * columns of X0 for R and rnorms.
+ *
  * NOTE: if Rnorms and rnorms are requested, nRb-nRe+nrb-nre < mV
  *
  * INPUT ARRAYS AND PARAMETERS
  * ---------------------------
  * V, W        input basis
- * mV,nV,ldV   number of rows and columns and leading dimension of V and W
+ * BV          B*V (optional)
+ * mV,nV,ldV   number of rows and columns and leading dimension of V, W and BV
  * h           input rotation matrix
  * nh          Number of columns of h
  * ldh         The leading dimension of h
@@ -1430,7 +1648,8 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
  * Rnorms      Output array with the norms of R (optional)
  * rnorms      Output array with the extra residual vector norms (optional)
  * nrb, nre    Columns of residual vector to compute the norm
- * reset       if reset>1, reothogonalize Xi; if reset>0, recompute Wo=A*X0
+ * reset       if reset>1, reothogonalize Xi; if reset>0, recompute Wo=A*X0;
+ *             if reset<0, recompute only the columns of Wo in R, Wo(nRb:nRe-1)
  * 
  * NOTE: n*e, n*b are zero-base indices of ranges where the first value is
  *       included and the last isn't.
@@ -1438,8 +1657,8 @@ static int restart_locking_Sprimme(int *restartSize, SCALAR *V, SCALAR *W,
  ******************************************************************************/
 
 TEMPLATE_PLEASE
-int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
-   int nV, PRIMME_INT ldV,
+int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, SCALAR *BV,
+   PRIMME_INT mV, int nV, PRIMME_INT ldV,
    SCALAR *h, int nh, int ldh, REAL *hVals,
    SCALAR *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
    SCALAR *X1, int nX1b, int nX1e, PRIMME_INT ldX1,
@@ -1452,6 +1671,11 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
 
    int i, j;         /* Loop variables */
    REAL *tmp, *tmp0;
+   SCALAR *BX0;      /* B*X0, or X0 in standard problems */
+   PRIMME_INT ldBX0; /* The leading dimension of BX0 */
+   int nBX0b;        /* First column of h in BX0 */
+   int nb = min(R?nRb:INT_MAX, rnorms?nrb:INT_MAX); /* Columns for R and */
+   int ne = max(R?nRe:0, rnorms?nre:0);             /* rnorms            */
 
    /* Return memory requirements */
    if (V == NULL) {
@@ -1465,11 +1689,48 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
                R, nRb, nRe, ldR, Rnorms,
                rnorms, nrb, nre,
                NULL, 0, primme));
+
+      /* B*X0 for R and rnorms if B*V is not kept */
+      if (primme->massMatrixMatvec && !primme->massMatrixCache && nb < ne) {
+         *lrwork = max(*lrwork,
+               (size_t)mV*(ne-nb) + (size_t)(nRe-nRb+nre-nrb)*2);
+      }
       return 0;
    }
 
-   /* Quick exit */
-   if (reset == 0) {
+   /* Quick exit. If BV, compute R with B*X0 and update BV before V */
+   if (reset == 0 && BV) {
+      assert(!evecs || nX2b >= nX2e);
+      CHKERR(Num_update_VWXR_Sprimme(
+               BV, W, mV, nV, ldV, h, nh, ldh, hVals,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               Wo, nWob, nWoe, ldWo,
+               R, nRb, nRe, ldR, Rnorms,
+               rnorms, nrb, nre,
+               rwork, TO_INT(*lrwork), primme), -1);
+      CHKERR(Num_update_VWXR_Sprimme(
+               BV, NULL, mV, nV, ldV, h, nh, ldh, NULL,
+               BV, nX0b, nX0e, ldV,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0, NULL,
+               NULL, 0, 0,
+               rwork, TO_INT(*lrwork), primme), -1);
+      CHKERR(Num_update_VWXR_Sprimme(
+               V, NULL, mV, nV, ldV, h, nh, ldh, NULL,
+               X0, nX0b, nX0e, ldX0,
+               X1, nX1b, nX1e, ldX1,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0, NULL,
+               NULL, 0, 0,
+               rwork, TO_INT(*lrwork), primme), -1);
+      return 0;
+   }
+   if (reset == 0 && !primme->massMatrixMatvec) {
       CHKERR(Num_update_VWXR_Sprimme(
                V, W, mV, nV, ldV, h, nh, ldh, hVals,
                X0, nX0b, nX0e, ldX0,
@@ -1488,21 +1749,43 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
 
    assert((size_t)(nre-nrb)*2 <= *lrwork); /* Check workspace for tmp and tmp0 */
 
-   /* X_i = V*h(nX_ib:nX_ie-1) */
+   /* X_i = V*h(nX_ib:nX_ie-1), and Wo = W*h(nWob:nWoe-1) if not reset */
 
    assert(!reset || !evecs || (nX0b <= nX2b && nX2e <= nX0e));
-   Num_update_VWXR_Sprimme(V, NULL, mV, nV, ldV, h, nh, ldh, NULL,
+   Num_update_VWXR_Sprimme(V, reset > 0 ? NULL : W, mV, nV, ldV, h, nh, ldh,
+         NULL,
          X0, nX0b, nX0e, ldX0,
          X1, nX1b, nX1e, ldX1,
          evecs?&evecs[ldevecs*evecsSize]:NULL, nX2b, nX2e, ldevecs,
-         NULL, 0, 0, 0,
+         reset > 0 ? NULL : Wo, nWob, nWoe, ldWo,
          NULL, 0, 0, 0, NULL,
          NULL, 0, 0,
          rwork, TO_INT(*lrwork), primme);
 
+   /* In generalized problems, B-orthonormalize X0 if asked, and set */
+   /* BV = B*X0 if BV is given                                       */
+
+   if (reset <= 0) {
+      assert(!evecs || nX2b >= nX2e);
+   }
+   else if (primme->massMatrixMatvec) {
+      assert(!evecs || nX2b >= nX2e);
+      if (reset > 1) {
+         CHKERR(ortho_B_Sprimme(X0, ldX0, BV, ldV, 0, nX0e-nX0b-1, mV,
+                  primme->iseed, machEps, rwork, lrwork, primme), -1);
+         assert(!X1 || (nX0b <= nX1b && nX1e <= nX0e));
+         if (X1) Num_copy_matrix_Sprimme(&X0[ldX0*(nX1b-nX0b)], mV,
+               nX1e-nX1b, ldX0, X1, ldX1);
+      }
+      else if (BV) {
+         CHKERR(massMatrixMatvec_Sprimme(X0, mV, ldX0, BV, ldV, 0,
+                  nX0e-nX0b, primme), -1);
+      }
+   }
+
    /* Reortho [evecs(evecSize:) X0] against evecs if asked */
 
-   if (reset > 1) {
+   else if (reset > 1) {
       CHKERR(ortho_Sprimme(evecs, ldevecs, NULL, 0, evecsSize, 
                evecsSize+nX2e-nX2b-1, NULL, 0, 0, mV, primme->iseed, 
                machEps, rwork, lrwork, primme), -1);
@@ -1522,29 +1805,41 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
    /* Compute W = A*V for the orthogonalized corrections */
 
    assert(nWob == nX0b && nWoe == nX0e);
-   CHKERR(matrixMatvec_Sprimme(X0, mV, ldX0, Wo, ldWo, 0, nWoe-nWob,
-            primme), -1);
+   if (reset > 0) {
+      CHKERR(matrixMatvec_Sprimme(X0, mV, ldX0, Wo, ldWo, 0, nWoe-nWob,
+               primme), -1);
+   }
+   else if (reset < 0 && R) {
+      CHKERR(matrixMatvec_Sprimme(&X0[ldX0*(nRb-nX0b)], mV, ldX0,
+               &Wo[ldWo*(nRb-nWob)], ldWo, 0, nRe-nRb, primme), -1);
+   }
+
+   /* BX0 is B*X0 if BV is given, B*X0(nb-nX0b:ne-nX0b-1) in rwork in */
+   /* generalized problems without BV, and X0 otherwise               */
+
+   BX0 = X0; ldBX0 = ldX0; nBX0b = nX0b;
+   if (BV) {
+      BX0 = BV; ldBX0 = ldV;
+   }
+   else if (primme->massMatrixMatvec && nb < ne) {
+      assert((size_t)mV*(ne-nb) + (size_t)(nRe-nRb+nre-nrb)*2 <= *lrwork);
+      BX0 = rwork; ldBX0 = mV; nBX0b = nb;
+      CHKERR(massMatrixMatvec_Sprimme(&X0[ldX0*(nb-nX0b)], mV, ldX0, BX0,
+               ldBX0, 0, ne-nb, primme), -1);
+      rwork += mV*(ne-nb);
+   }
  
-   /* R = Y(nRb-nYb:nRe-nYb-1) - X(nRb-nYb:nRe-nYb-1)*diag(nRb:nRe-1) */
-   for (j=nRb; j<nRe; j++) {
-      Num_compute_residual_Sprimme(mV, hVals[j], &X0[ldX0*(j-nX0b)],
-            &Wo[ldWo*(j-nWob)], &R[ldR*(j-nRb)]);
-      if (Rnorms) {
-         Rnorms[j-nRb] = REAL_PART(Num_dot_Sprimme(mV, &R[ldR*(j-nRb)], 1,
-                  &R[ldR*(j-nRb)], 1));
-      }
+   /* R = Y(nRb-nYb:nRe-nYb-1) - BX(nRb-nYb:nRe-nYb-1)*diag(nRb:nRe-1) */
+   if (R) for (j=nRb; j<nRe; j++) {
+      REAL norm2 = Num_compute_residual_norm_Sprimme(mV, hVals[j],
+            &BX0[ldBX0*(j-nBX0b)], &Wo[ldWo*(j-nWob)], &R[ldR*(j-nRb)]);
+      if (Rnorms) Rnorms[j-nRb] = norm2;
    }
 
-   /* rnorms = Y(nrb-nYb:nre-nYb-1) - X(nrb-nYb:nre-nYb-1)*diag(nrb:nre-1) */
+   /* rnorms = Y(nrb-nYb:nre-nYb-1) - BX(nrb-nYb:nre-nYb-1)*diag(nrb:nre-1) */
    if (rnorms) for (j=nrb; j<nre; j++) {
-      int m=min(PRIMME_BLOCK_SIZE, mV);   /* Number of rows in the cache */
-      rnorms[j-nrb] = 0.0;
-      for (i=0; i < mV; i+=m, m=min(m,mV-i)) {
-         Num_compute_residual_Sprimme(m, hVals[j], &X0[ldX0*(j-nX0b)],
-               &Wo[i+ldWo*(j-nWob)], rwork);
-         rnorms[j-nrb] +=
-            REAL_PART(Num_dot_Sprimme(m, rwork, 1, rwork, 1));
-      }
+      rnorms[j-nrb] = Num_compute_residual_norm_Sprimme(mV, hVals[j],
+            &BX0[ldBX0*(j-nBX0b)], &Wo[ldWo*(j-nWob)], NULL);
    }
 
    /* Reduce Rnorms and rnorms and sqrt the results */
@@ -1614,6 +1909,8 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
  *
  * ldW              The leading dimension of W
  *
+ * BV, ldBV         B*V and its leading dimension, if massMatrixMatvec is set
+ *
  * H                The projection V'*A*V
  *
  * ldH              The leading dimension of H
@@ -1672,6 +1969,16 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
  *
  * ipivot           The pivot array of the UDU factorization
  *
+ * sizeUDU          The dimension of the leading block of M factorized in UDU;
+ *                  if zero, M is factorized from scratch
+ *
+ * explicitH        If nonzero and VtBV is given, compute H and VtBV from V,
+ *                  W and BV instead of updating them with hVecs
+ *
+ * numFrozen        If nonzero, the leading columns of V were kept at restart
+ *                  and hVecs are not Ritz vectors of H (see
+ *                  restart_soft_locking)
+ *
  * targetShiftIndex The target shift used in (A - targetShift*B) = Q*R
  *
  * numArbitraryVecs On input, the number of coefficients vectors that do
@@ -1690,7 +1997,8 @@ int Num_reset_update_VWXR_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT mV,
  ******************************************************************************/
  
 static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
-      PRIMME_INT ldW, SCALAR *H, int ldH, SCALAR *VtBV, int ldVtBV, SCALAR *Q,
+      PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, SCALAR *H, int ldH,
+      SCALAR *VtBV, int ldVtBV, SCALAR *Q,
       PRIMME_INT ldQ, PRIMME_INT nLocal, SCALAR *R, int ldR, SCALAR *QtV,
       int ldQtV, SCALAR *hU, int ldhU, int newldhU,
       int indexOfPreviousVecsBeforeRestart, SCALAR *hVecs, int ldhVecs,
@@ -1698,8 +2006,9 @@ static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       int *hVecsPerm, int restartSize, int basisSize, int numPrevRetained,
       int indexOfPreviousVecs, SCALAR *evecs, int *evecsSize,
       PRIMME_INT ldevecs, SCALAR *evecsHat, PRIMME_INT ldevecsHat, SCALAR *M,
-      int ldM, SCALAR *UDU, int ldUDU, int *ipivot, int *targetShiftIndex,
-      int numConverged, int *numArbitraryVecs, SCALAR *hVecsRot, int ldhVecsRot,
+      int ldM, SCALAR *UDU, int ldUDU, int *ipivot, int sizeUDU,
+      int *targetShiftIndex, int numConverged, int *numArbitraryVecs,
+      SCALAR *hVecsRot, int ldhVecsRot, int explicitH, int numFrozen,
       size_t *rworkSize, SCALAR *rwork, int iworkSize, int *iwork,
       double machEps, primme_params *primme) {
 
@@ -1709,17 +2018,21 @@ static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
 
    switch (primme->projectionParams.projection) {
    case primme_proj_RR:
-      if (!VtBV) {
+      if (!VtBV && (!numFrozen || V == NULL)) {
          CHKERR(restart_RR(H, ldH, hVecs, ldhVecs, newldhVecs, hVals,
                   restartSize, basisSize, numConverged, numPrevRetained,
                   indexOfPreviousVecs, hVecsPerm, targetShiftIndex, machEps,
                   rworkSize, rwork, iworkSize, iwork, primme), -1);
       }
-      else {
-         CHKERR(restart_RR_explicit(V, ldV, W, ldW, nLocal, H, ldH, VtBV,
-                  ldVtBV, hVecs, newldhVecs, hVals, restartSize,
-                  numConverged, targetShiftIndex, machEps, rworkSize, rwork,
-                  iworkSize, iwork, primme), -1);
+      if (VtBV || numFrozen) {
+         /* With frozen columns hVecs are no longer Ritz vectors of H, so */
+         /* H is updated with hVecs and solved again                     */
+         CHKERR(restart_RR_explicit(V, ldV, W, ldW, BV, ldBV, nLocal, H, ldH,
+                  VtBV,
+                  ldVtBV, hVecs, ldhVecs, newldhVecs, hVals, restartSize,
+                  basisSize, VtBV ? explicitH : 0, numConverged,
+                  targetShiftIndex, machEps, rworkSize, rwork, iworkSize,
+                  iwork, primme), -1);
       }
       break;
 
@@ -1747,18 +2060,24 @@ static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    }
 
    if (evecsHat) {
-      int numRecentlyConverged = numConverged - *evecsSize;
+      int numRecentlyConverged;
 
       /* Return memory requirement */
       if (H == NULL) {
+         /* The caller may not pass the number of locked vectors; assume  */
+         /* the largest possible                                          */
+         int numLocked = evecsSize ? *evecsSize : primme->numEvals;
          CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal,
-                  *evecsSize, basisSize, NULL, rworkSize, 1/*symmetric*/,
+                  numLocked, basisSize, NULL, rworkSize, 1/*symmetric*/, NULL,
                   primme), -1);
-         CHKERR(UDUDecompose_Sprimme(NULL, 0, NULL, 0, NULL, *evecsSize,
-                  NULL, rworkSize, primme), -1);
+         CHKERR(UDUUpdate_Sprimme(NULL, 0, NULL, NULL, 0,
+                  numLocked+primme->numOrthoConst, NULL, rworkSize, primme),
+               -1);
          return 0;
       }
 
+      numRecentlyConverged = numConverged - *evecsSize;
+
       /* Compute K^{-1}x for all newly locked eigenvectors */
 
       /* TODO: primme.shiftsForPreconditioner is undefined at that point;
@@ -1777,12 +2096,23 @@ static int restart_projection_Sprimme(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
 
       CHKERR(update_projection_Sprimme(evecs, primme->nLocal, evecsHat,
                primme->nLocal, M, ldM, nLocal, *evecsSize+primme->numOrthoConst,
-               numRecentlyConverged, rwork, rworkSize, 1/*symmetric*/, primme),
-               -1);
+               numRecentlyConverged, rwork, rworkSize, 1/*symmetric*/, NULL,
+               primme), -1);
       *evecsSize = numConverged;
 
-      CHKERR(UDUDecompose_Sprimme(M, ldM, UDU, ldUDU, ipivot,
-               *evecsSize+primme->numOrthoConst, rwork, rworkSize, primme), -1);
+      /* Extend the factorization of M by the new rows and columns if the */
+      /* rest of M has not changed since the last factorization           */
+
+      if (sizeUDU == 0) {
+         CHKERR(UDUDecompose_Sprimme(M, ldM, UDU, ldUDU, ipivot,
+                  *evecsSize+primme->numOrthoConst, rwork, rworkSize, primme),
+               -1);
+      }
+      else {
+         CHKERR(UDUUpdate_Sprimme(M, ldM, UDU, ipivot, sizeUDU,
+                  *evecsSize+primme->numOrthoConst, rwork, rworkSize, primme),
+               -1);
+      }
    }
 
    return 0;
@@ -1992,7 +2322,8 @@ static int restart_RR(SCALAR *H, int ldH, SCALAR *hVecs, int ldhVecs,
 
 /*******************************************************************************
  * Function restart_RR_explicit - This routine is used to recompute H = V'*A*V
- *   VtBV = V'*B*V explcitly.
+ *   VtBV = V'*B*V explcitly, or to update them with the coefficient vectors
+ *   hVecs if explicitH is zero.
  *
  * INPUT PARAMETERS
  * ----------------
@@ -2000,6 +2331,9 @@ static int restart_RR(SCALAR *H, int ldH, SCALAR *hVecs, int ldhVecs,
  * 
  * basisSize     Maximum size of the basis V
  *
+ * explicitH     If nonzero, compute H and VtBV from V, W and BV; otherwise
+ *               replace them by hVecs'*H*hVecs and hVecs'*VtBV*hVecs
+ *
  * numLocked     The number of Ritz vectors that have been locked 
  *
  * numPrevRetained The number of vectors retained from the previous iteration
@@ -2060,23 +2394,54 @@ static int restart_RR(SCALAR *H, int ldH, SCALAR *hVecs, int ldhVecs,
  ******************************************************************************/
 
 static int restart_RR_explicit(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
-      PRIMME_INT ldW, PRIMME_INT nLocal, SCALAR *H, int ldH, SCALAR *VtBV,
-      int ldVtBV, SCALAR *hVecs, int ldhVecs, REAL *hVals, int restartSize,
-      int numLocked, int *targetShiftIndex, double machEps, size_t *rworkSize,
+      PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV, PRIMME_INT nLocal,
+      SCALAR *H, int ldH, SCALAR *VtBV,
+      int ldVtBV, SCALAR *hVecs, int ldhVecs, int newldhVecs, REAL *hVals,
+      int restartSize, int basisSize, int explicitH, int numLocked,
+      int *targetShiftIndex, double machEps, size_t *rworkSize,
       SCALAR *rwork, int iworkSize, int *iwork, primme_params *primme) {
 
-   CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H, ldH, nLocal, 0,
-            restartSize, rwork, rworkSize, 1/*symmetric*/, primme), -1);
+   globalsum_queue queue;  /* Reduce H and VtBV together */
 
-   if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, V, ldV, VtBV, ldVtBV,
-            nLocal, 0, restartSize, rwork, rworkSize, 1/*symmetric*/, primme),
-         -1);
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      CHKERR(compute_submatrix_Sprimme(NULL, basisSize, 0, NULL, basisSize,
+               0, NULL, 0, NULL, rworkSize), -1);
+   }
+
+   if (explicitH || V == NULL) {
+
+      /* Compute H = V'*W and VtBV = V'*BV */
+
+      GLOBALSUM_QUEUE_INIT(queue);
+
+      CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H, ldH, nLocal, 0,
+               restartSize, rwork, rworkSize, 1/*symmetric*/, &queue, primme),
+            -1);
+
+      if (VtBV) CHKERR(update_projection_Sprimme(V, ldV, BV ? BV : V,
+               BV ? ldBV : ldV, VtBV, ldVtBV, nLocal, 0, restartSize, rwork,
+               rworkSize, 1/*symmetric*/, &queue, primme), -1);
+
+      CHKERR(globalSum_flush_Sprimme(&queue, rwork, *rworkSize, primme), -1);
+   }
+   else {
+
+      /* V was replaced by V*hVecs, so replace H by hVecs'*H*hVecs and  */
+      /* VtBV by hVecs'*VtBV*hVecs, without passing over V, W and BV    */
+
+      CHKERR(compute_submatrix_Sprimme(hVecs, restartSize, ldhVecs, H,
+               basisSize, ldH, H, ldH, rwork, rworkSize), -1);
+      if (VtBV) CHKERR(compute_submatrix_Sprimme(hVecs, restartSize, ldhVecs,
+               VtBV, basisSize, ldVtBV, VtBV, ldVtBV, rwork, rworkSize), -1);
+   }
 
    if (primme->numTargetShifts > 0 && targetShiftIndex)
       *targetShiftIndex = min(primme->numTargetShifts-1, numLocked);
 
    CHKERR(solve_H_Sprimme(H, restartSize, ldH, VtBV, ldVtBV, NULL, 0, NULL, 0,
-            NULL, 0, hVecs, ldhVecs, hVals, NULL,
+            NULL, 0, hVecs, newldhVecs, hVals, NULL,
             targetShiftIndex?*targetShiftIndex:0, machEps,
             rworkSize, rwork, iworkSize, iwork, primme), -1);
 
@@ -2211,7 +2576,7 @@ static int restart_refined(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
       CHKERR(update_Q_Sprimme(NULL, nLocal, 0, NULL, 0, NULL, 0, NULL, 0,
                0.0, 0, basisSize, NULL, rworkSize, 0.0, primme), -1);
       CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal, 0, basisSize,
-            NULL, rworkSize, 0/*unsymmetric*/, primme), -1);
+            NULL, rworkSize, 0/*unsymmetric*/, NULL, primme), -1);
       /* Workspace for  R(indexOfPrevVecs:) = R * hVecs(indexOfPrevVecs:) */
       /* The workspace for permute_vecs(hU) is basisSize */
       *rworkSize = max(*rworkSize, (size_t)basisSize*(size_t)basisSize);
@@ -2497,7 +2862,9 @@ static int restart_refined(SCALAR *V, PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW,
 
 /*******************************************************************************
  * Function restart_harmonic - This routine is used to recompute the QR decomposition
- *    of W (=A*V), after V being replaced by V*hVecs. 
+ *    of W (=A*V), after V being replaced by V*hVecs. If the target shift has
+ *    not changed, Q and R are updated with the QR decomposition of R*hVecs
+ *    without passing over W; otherwise they are recomputed.
  *    Also H = V'*A*V and QtV = Q'*V are recomputed properly.
  *   
  * INPUT ARRAYS AND PARAMETERS
@@ -2596,6 +2963,12 @@ static int restart_harmonic(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       size_t *rworkSize, SCALAR *rwork, int iworkSize, int *iwork,
       double machEps, primme_params *primme) {
 
+   SCALAR *Z;         /* Q factor of R*hVecs                                  */
+   SCALAR *QtVhVecs;  /* QtV*hVecs                                            */
+   SCALAR *rwork0;
+   size_t rworkSize0;
+   double aNorm = primme?max(primme->aNorm, primme->stats.estimateLargestSVal):0.0;
+
    (void)ldhU; /* unused parameter */
    (void)restartPerm; /* unused parameter */
    (void)hVecsPerm; /* unused parameter */
@@ -2612,7 +2985,24 @@ static int restart_harmonic(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
       CHKERR(update_Q_Sprimme(NULL, nLocal, 0, NULL, 0, NULL, 0, NULL, 0,
                0.0, 0, basisSize, NULL, rworkSize, 0.0, primme), -1);
       CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal,
-               0, basisSize, NULL, rworkSize, 0/*unsymmetric*/, primme), -1);
+               0, basisSize, NULL, rworkSize, 0/*unsymmetric*/, NULL, primme),
+            -1);
+      /* Workspace for Z, QtVhVecs and ortho(Z) */
+      rworkSize0 = 0;
+      CHKERR(ortho_Sprimme(NULL, 0, NULL, 0, 0, basisSize-1, NULL, 0, 0,
+               basisSize, NULL, 0.0, NULL, &rworkSize0, NULL), -1);
+      *rworkSize = max(*rworkSize,
+            (size_t)basisSize*(size_t)basisSize*2 + rworkSize0);
+      *rworkSize = max(*rworkSize,
+            (size_t)Num_update_VWXR_Sprimme(NULL, NULL, nLocal, basisSize,
+               0, NULL, basisSize, 0, NULL,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0, NULL,
+               NULL, 0, 0,
+               NULL, 0, primme));
       CHKERR(solve_H_Sprimme(NULL, basisSize, 0, NULL, 0, NULL, 0, NULL, 0,
                NULL, 0, NULL, 0, NULL, NULL, numConverged, 0.0, rworkSize,
                NULL, 0, iwork, primme), -1);
@@ -2626,26 +3016,86 @@ static int restart_harmonic(SCALAR *V, PRIMME_INT ldV, SCALAR *W,
    CHKERR(compute_submatrix_Sprimme(hVecs, restartSize, ldhVecs, H,
             basisSize, ldH, H, ldH, rwork, rworkSize), -1);
 
-   /* ------------------------------- */
-   /* Update targetShiftIndex         */
-   /* ------------------------------- */
+   /* NOTE: keep the same condition here as in main_iter and restart_refined */
 
-   *targetShiftIndex = min(primme->numTargetShifts-1, numConverged);
+   if (*targetShiftIndex < 0 || fabs(primme->targetShifts[*targetShiftIndex]
+            - primme->targetShifts[min(primme->numTargetShifts-1, numConverged)])
+         > machEps*aNorm) {
 
-   /* ------------------------------- */
-   /* Compute QR                      */
-   /* ------------------------------- */
+      /* ------------------------------- */
+      /* Update targetShiftIndex         */
+      /* ------------------------------- */
 
-   CHKERR(update_Q_Sprimme(V, nLocal, ldV, W, ldW, Q, ldQ, R, ldR,
-         primme->targetShifts[*targetShiftIndex], 0,
-         restartSize, rwork, rworkSize, machEps, primme), -1);
+      *targetShiftIndex = min(primme->numTargetShifts-1, numConverged);
 
-   /* ------------------------------- */
-   /* Update QtV                      */
-   /* ------------------------------- */
+      /* ------------------------------- */
+      /* Compute QR                      */
+      /* ------------------------------- */
+
+      CHKERR(update_Q_Sprimme(V, nLocal, ldV, W, ldW, Q, ldQ, R, ldR,
+            primme->targetShifts[*targetShiftIndex], 0,
+            restartSize, rwork, rworkSize, machEps, primme), -1);
 
-   CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV, ldQtV, nLocal, 0,
-            restartSize, rwork, rworkSize, 0/*unsymmetric*/, primme), -1);
+      /* ------------------------------- */
+      /* Update QtV                      */
+      /* ------------------------------- */
+
+      CHKERR(update_projection_Sprimme(Q, ldQ, V, ldV, QtV, ldQtV, nLocal, 0,
+               restartSize, rwork, rworkSize, 0/*unsymmetric*/, NULL, primme),
+            -1);
+   }
+   else {
+
+      /* -------------------------------------------------------------------- */
+      /* In restart V is replaced by V*hVecs, and then (A-\tau I)*V*hVecs   */
+      /* = Q*R*hVecs. With the QR decomposition Z*T = R*hVecs, Q is replaced */
+      /* by Q*Z, R by T and QtV by Z'*QtV*hVecs; it only takes a pass over Q */
+      /* and no global reductions.                                           */
+      /* -------------------------------------------------------------------- */
+
+      assert(*rworkSize >= (size_t)basisSize*restartSize*2);
+      Z = rwork;
+      QtVhVecs = Z + basisSize*restartSize;
+      rwork0 = QtVhVecs + basisSize*restartSize;
+      rworkSize0 = *rworkSize - (size_t)basisSize*restartSize*2;
+
+      /* Z = R * hVecs(:,0:restartSize-1) */
+
+      Num_gemm_Sprimme("N", "N", basisSize, restartSize, basisSize, 1.0, R,
+            ldR, hVecs, ldhVecs, 0.0, Z, basisSize);
+
+      /* QtVhVecs = QtV * hVecs(:,0:restartSize-1) */
+
+      Num_gemm_Sprimme("N", "N", basisSize, restartSize, basisSize, 1.0, QtV,
+            ldQtV, hVecs, ldhVecs, 0.0, QtVhVecs, basisSize);
+
+      /* [Z, R] = ortho(Z) */
+
+      Num_zero_matrix_Sprimme(R, primme->maxBasisSize, primme->maxBasisSize,
+            ldR);
+      CHKERR(ortho_Sprimme(Z, basisSize, R, ldR, 0, restartSize-1, NULL, 0,
+               0, basisSize, primme->iseed, machEps, rwork0, &rworkSize0,
+               NULL), -1);
+
+      /* QtV = Z' * QtVhVecs */
+
+      Num_gemm_Sprimme("C", "N", restartSize, restartSize, basisSize, 1.0, Z,
+            basisSize, QtVhVecs, basisSize, 0.0, QtV, ldQtV);
+
+      /* Q = Q * Z */
+
+      rworkSize0 = *rworkSize - (size_t)basisSize*restartSize;
+      CHKERR(Num_update_VWXR_Sprimme(Q, NULL, nLocal, basisSize, ldQ, Z,
+               restartSize,
+               basisSize, NULL,
+               Q, 0, restartSize, ldQ,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0, NULL,
+               NULL, 0, 0,
+               QtVhVecs, TO_INT(rworkSize0), primme), -1);
+   }
 
    /* ------------------------------- */
    /* Solve the projected problem     */
@@ -3049,6 +3499,8 @@ int retain_previous_coefficients_Sprimme(SCALAR *hVecs, int ldhVecs,
  *   The order is ascending or descending for smallest/largest respectively.
  *   For interior, it is the order of convergence except for the same shifts.
  *   In that case, Ritz values that satisfy the criterion closer come first.
+ *   For smallest/largest the position is found by a binary search; for
+ *   interior, the scan stops at the first value with a different shift.
  *
  *
  * Input parameters
@@ -3089,17 +3541,22 @@ static void insertionSort(REAL newVal, REAL *evals, REAL newNorm,
    /* depends on how we target eigenvalues.                              */
    /* ------------------------------------------------------------------ */
 
-   if ( primme->target == primme_smallest ) {
+   if ( primme->target == primme_smallest
+         || primme->target == primme_largest ) {
+      int lo = 0, hi = numLocked, mid;
 
-      for (i = numLocked; i > 0; i--) {
-         if (newVal >= evals[i-1]) break; 
-      }
-   }
-   else if ( primme->target == primme_largest ) {
+      /* evals is sorted, so find with a binary search the position after */
+      /* the last value that goes before newVal or is equal to it         */
 
-      for (i = numLocked; i > 0; i--) {
-         if (newVal <= evals[i-1]) break; 
+      while (lo < hi) {
+         mid = (lo+hi)/2;
+         if (primme->target == primme_smallest ? newVal >= evals[mid]
+                                               : newVal <= evals[mid])
+            lo = mid+1;
+         else
+            hi = mid;
       }
+      i = lo;
    }
    else {
    /* For interior cases maintain convergence order except for the same shift *
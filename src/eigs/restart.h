@@ -39,7 +39,8 @@
 #if !defined(CHECK_TEMPLATE) && !defined(restart_Rprimme)
 #  define restart_Rprimme CONCAT(restart_,REAL_SUF)
 #endif
-int restart_dprimme(double *V, double *W, PRIMME_INT nLocal, int basisSize,
+int restart_dprimme(double *V, double *W, double *BV, PRIMME_INT nLocal,
+       int basisSize,
        PRIMME_INT ldV, double *hVals, double *hSVals, int *flags, int *iev,
        int *ievSize, double *blockNorms, double *evecs, PRIMME_INT ldevecs,
        int *evecsPerm, double *evals, double *resNorms, double *evecsHat,
@@ -52,16 +53,17 @@ int restart_dprimme(double *V, double *W, PRIMME_INT nLocal, int basisSize,
        double *hU, int ldhU, int newldhU, double *hVecs, int ldhVecs,
        int newldhVecs, int *restartSizeOutput, int *targetShiftIndex,
        int *numArbitraryVecs, double *hVecsRot, int ldhVecsRot,
-       int *restartsSinceReset, int *reset, double machEps, double *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
+       int *restartsSinceReset, double *restartsW, int *reset,
+       int *freshResNorms, double machEps, double *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_reset_update_VWXR_Sprimme)
 #  define Num_reset_update_VWXR_Sprimme CONCAT(Num_reset_update_VWXR_,SCALAR_SUF)
 #endif
 #if !defined(CHECK_TEMPLATE) && !defined(Num_reset_update_VWXR_Rprimme)
 #  define Num_reset_update_VWXR_Rprimme CONCAT(Num_reset_update_VWXR_,REAL_SUF)
 #endif
-int Num_reset_update_VWXR_dprimme(double *V, double *W, PRIMME_INT mV,
-   int nV, PRIMME_INT ldV,
+int Num_reset_update_VWXR_dprimme(double *V, double *W, double *BV,
+   PRIMME_INT mV, int nV, PRIMME_INT ldV,
    double *h, int nh, int ldh, double *hVals,
    double *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
    double *X1, int nX1b, int nX1e, PRIMME_INT ldX1,
@@ -81,7 +83,8 @@ int retain_previous_coefficients_dprimme(double *hVecs, int ldhVecs,
    double *hU, int ldhU, double *previousHVecs, int ldpreviousHVecs,
    int mprevious, int basisSize, int *iev, int blockSize, int *flags,
    int *numPrevRetained, int *iwork, int iworkSize, primme_params *primme);
-int restart_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT nLocal, int basisSize,
+int restart_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_COMPLEX_DOUBLE *BV, PRIMME_INT nLocal,
+       int basisSize,
        PRIMME_INT ldV, double *hVals, double *hSVals, int *flags, int *iev,
        int *ievSize, double *blockNorms, PRIMME_COMPLEX_DOUBLE *evecs, PRIMME_INT ldevecs,
        int *evecsPerm, double *evals, double *resNorms, PRIMME_COMPLEX_DOUBLE *evecsHat,
@@ -94,10 +97,11 @@ int restart_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_I
        PRIMME_COMPLEX_DOUBLE *hU, int ldhU, int newldhU, PRIMME_COMPLEX_DOUBLE *hVecs, int ldhVecs,
        int newldhVecs, int *restartSizeOutput, int *targetShiftIndex,
        int *numArbitraryVecs, PRIMME_COMPLEX_DOUBLE *hVecsRot, int ldhVecsRot,
-       int *restartsSinceReset, int *reset, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
-int Num_reset_update_VWXR_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT mV,
-   int nV, PRIMME_INT ldV,
+       int *restartsSinceReset, double *restartsW, int *reset,
+       int *freshResNorms, double machEps, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme);
+int Num_reset_update_VWXR_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_COMPLEX_DOUBLE *BV,
+   PRIMME_INT mV, int nV, PRIMME_INT ldV,
    PRIMME_COMPLEX_DOUBLE *h, int nh, int ldh, double *hVals,
    PRIMME_COMPLEX_DOUBLE *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
    PRIMME_COMPLEX_DOUBLE *X1, int nX1b, int nX1e, PRIMME_INT ldX1,
@@ -111,7 +115,8 @@ int retain_previous_coefficients_zprimme(PRIMME_COMPLEX_DOUBLE *hVecs, int ldhVe
    PRIMME_COMPLEX_DOUBLE *hU, int ldhU, PRIMME_COMPLEX_DOUBLE *previousHVecs, int ldpreviousHVecs,
    int mprevious, int basisSize, int *iev, int blockSize, int *flags,
    int *numPrevRetained, int *iwork, int iworkSize, primme_params *primme);
-int restart_sprimme(float *V, float *W, PRIMME_INT nLocal, int basisSize,
+int restart_sprimme(float *V, float *W, float *BV, PRIMME_INT nLocal,
+       int basisSize,
        PRIMME_INT ldV, float *hVals, float *hSVals, int *flags, int *iev,
        int *ievSize, float *blockNorms, float *evecs, PRIMME_INT ldevecs,
        int *evecsPerm, float *evals, float *resNorms, float *evecsHat,
@@ -124,10 +129,11 @@ int restart_sprimme(float *V, float *W, PRIMME_INT nLocal, int basisSize,
        float *hU, int ldhU, int newldhU, float *hVecs, int ldhVecs,
        int newldhVecs, int *restartSizeOutput, int *targetShiftIndex,
        int *numArbitraryVecs, float *hVecsRot, int ldhVecsRot,
-       int *restartsSinceReset, int *reset, double machEps, float *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
-int Num_reset_update_VWXR_sprimme(float *V, float *W, PRIMME_INT mV,
-   int nV, PRIMME_INT ldV,
+       int *restartsSinceReset, float *restartsW, int *reset,
+       int *freshResNorms, double machEps, float *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme);
+int Num_reset_update_VWXR_sprimme(float *V, float *W, float *BV,
+   PRIMME_INT mV, int nV, PRIMME_INT ldV,
    float *h, int nh, int ldh, float *hVals,
    float *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
    float *X1, int nX1b, int nX1e, PRIMME_INT ldX1,
@@ -141,7 +147,8 @@ int retain_previous_coefficients_sprimme(float *hVecs, int ldhVecs,
    float *hU, int ldhU, float *previousHVecs, int ldpreviousHVecs,
    int mprevious, int basisSize, int *iev, int blockSize, int *flags,
    int *numPrevRetained, int *iwork, int iworkSize, primme_params *primme);
-int restart_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT nLocal, int basisSize,
+int restart_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_COMPLEX_FLOAT *BV, PRIMME_INT nLocal,
+       int basisSize,
        PRIMME_INT ldV, float *hVals, float *hSVals, int *flags, int *iev,
        int *ievSize, float *blockNorms, PRIMME_COMPLEX_FLOAT *evecs, PRIMME_INT ldevecs,
        int *evecsPerm, float *evals, float *resNorms, PRIMME_COMPLEX_FLOAT *evecsHat,
@@ -154,10 +161,11 @@ int restart_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT
        PRIMME_COMPLEX_FLOAT *hU, int ldhU, int newldhU, PRIMME_COMPLEX_FLOAT *hVecs, int ldhVecs,
        int newldhVecs, int *restartSizeOutput, int *targetShiftIndex,
        int *numArbitraryVecs, PRIMME_COMPLEX_FLOAT *hVecsRot, int ldhVecsRot,
-       int *restartsSinceReset, int *reset, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
-       size_t *rworkSize, int *iwork, int iworkSize, primme_params *primme);
-int Num_reset_update_VWXR_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT mV,
-   int nV, PRIMME_INT ldV,
+       int *restartsSinceReset, float *restartsW, int *reset,
+       int *freshResNorms, double machEps, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
+       int *iwork, int iworkSize, primme_params *primme);
+int Num_reset_update_VWXR_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_COMPLEX_FLOAT *BV,
+   PRIMME_INT mV, int nV, PRIMME_INT ldV,
    PRIMME_COMPLEX_FLOAT *h, int nh, int ldh, float *hVals,
    PRIMME_COMPLEX_FLOAT *X0, int nX0b, int nX0e, PRIMME_INT ldX0,
    PRIMME_COMPLEX_FLOAT *X1, int nX1b, int nX1e, PRIMME_INT ldX1,
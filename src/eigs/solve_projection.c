@@ -40,12 +40,25 @@
 #include "solve_projection.h"
 #include "ortho.h"
 #include "globalsum.h"
+#include "wtime.h"
+#include "trace.h"
 
 static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *VtBV, int ldVtBV,
       SCALAR *hVecs, int ldhVecs, REAL *hVals, int basisSize, int numConverged,
+      int prevBasisSize, size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
+      primme_params *primme);
+
+static int solve_H_RR_append_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
+      int ldhVecs, REAL *hVals, int basisSize, int prevBasisSize,
       size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
       primme_params *primme);
 
+static void solve_arrowhead_Sprimme(int n, REAL *d, REAL *r, REAL c,
+      REAL *lambda, SCALAR *Z, int ldZ, REAL *rwork, int *iwork);
+
+static void update_estimates_Sprimme(REAL *hVals, int basisSize,
+      primme_params *primme);
+
 static int solve_H_Harm_Sprimme(SCALAR *H, int ldH, SCALAR *QtV, int ldQtV,
    SCALAR *R, int ldR, SCALAR *hVecs, int ldhVecs, SCALAR *hU, int ldhU,
    REAL *hVals, int basisSize, int numConverged, double machEps,
@@ -106,7 +119,7 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *VtBV, int ldVtBV,
    REAL *hVals, REAL *hSVals, int numConverged, double machEps, size_t *lrwork,
    SCALAR *rwork, int liwork, int *iwork, primme_params *primme) {
 
-   int i;
+   double t0 = primme_get_wtime();
 
    /* In parallel (especially with heterogeneous processors/libraries) ensure */
    /* that every process has the same hVecs and hU. Only processor 0 solves   */
@@ -116,7 +129,7 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *VtBV, int ldVtBV,
       switch (primme->projectionParams.projection) {
          case primme_proj_RR:
             CHKERR(solve_H_RR_Sprimme(H, ldH, VtBV, ldVtBV, hVecs, ldhVecs,
-                     hVals, basisSize, numConverged, lrwork, rwork, liwork,
+                     hVals, basisSize, numConverged, 0, lrwork, rwork, liwork,
                      iwork, primme), -1);
             break;
 
@@ -148,9 +161,83 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *VtBV, int ldVtBV,
       return 0;
    }
 
-   /* -------------------------------------------------------- */
-   /* Update the leftmost and rightmost Ritz values ever seen  */
-   /* -------------------------------------------------------- */
+   update_estimates_Sprimme(hVals, basisSize, primme);
+
+   primme->stats.timeSolveH += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_SOLVEH, t0);
+
+   return 0;
+}
+
+
+/*******************************************************************************
+ * Subroutine solve_H_append - This procedure updates the Rayleigh-Ritz
+ *       eigendecomposition of H after appending vectors to the basis, and
+ *       returns hVecs and hVals in the order according to primme.target.
+ *       The workspace is the one returned by solve_H for basisSize.
+ *        
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * H              The matrix V'*A*V
+ * basisSize      The dimension of H
+ * ldH            The leading dimension of H
+ * prevBasisSize  The size of the basis when hVecs and hVals were computed
+ * numConverged   Number of eigenvalues converged to determine ordering shift
+ * lrwork         Length of the work array rwork
+ * primme         Structure containing various solver parameters
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * hVecs          On input the eigenvectors of H(0:prevBasisSize-1,
+ *                0:prevBasisSize-1) with leading dimension prevBasisSize;
+ *                on output the eigenvectors of H
+ * ldhVecs        The leading dimension of hVecs on output
+ * hVals          The Ritz values
+ * rwork          Workspace
+ * iwork          Workspace in integers
+ *
+ * Return Value
+ * ------------
+ * error code
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int solve_H_append_Sprimme(SCALAR *H, int basisSize, int ldH,
+      int prevBasisSize, SCALAR *hVecs, int ldhVecs, REAL *hVals,
+      int numConverged, size_t *lrwork, SCALAR *rwork, int liwork,
+      int *iwork, primme_params *primme) {
+
+   double t0 = primme_get_wtime();
+
+   assert(primme->projectionParams.projection == primme_proj_RR);
+
+   if (primme->procID == 0) {
+      CHKERR(solve_H_RR_Sprimme(H, ldH, NULL, 0, hVecs, ldhVecs, hVals,
+               basisSize, numConverged, prevBasisSize, lrwork, rwork, liwork,
+               iwork, primme), -1);
+   }
+
+   CHKERR(solve_H_brcast_Sprimme(basisSize, NULL, 0, hVecs, ldhVecs, hVals,
+            NULL, lrwork, rwork, primme), -1);
+
+   update_estimates_Sprimme(hVals, basisSize, primme);
+
+   primme->stats.timeSolveH += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_SOLVEH, t0);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine update_estimates - Update the leftmost and rightmost Ritz values
+ *       ever seen.
+ ******************************************************************************/
+
+static void update_estimates_Sprimme(REAL *hVals, int basisSize,
+      primme_params *primme) {
+
+   int i;
+
    for (i=0; i<basisSize; i++) {
       primme->stats.estimateMinEVal = min(primme->stats.estimateMinEVal,
             hVals[i]); 
@@ -159,8 +246,6 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *VtBV, int ldVtBV,
    }
    primme->stats.estimateLargestSVal = max(fabs(primme->stats.estimateMinEVal),
                                            fabs(primme->stats.estimateMaxEVal));
-
-   return 0;
 }
 
 
@@ -176,6 +261,8 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *VtBV, int ldVtBV,
  * VtBV           The matrix V'*B*V
  * ldVtBV         The leading dimension of VtBV
  * numConverged   Number of eigenvalues converged to determine ordering shift
+ * prevBasisSize  If positive, hVecs and hVals are the eigendecomposition of
+ *                H(0:prevBasisSize-1,0:prevBasisSize-1), and it is updated
  * lrwork         Length of the work array rwork
  * primme         Structure containing various solver parameters
  * 
@@ -196,24 +283,39 @@ int solve_H_Sprimme(SCALAR *H, int basisSize, int ldH, SCALAR *VtBV, int ldVtBV,
 
 static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *VtBV, int ldVtBV,
       SCALAR *hVecs, int ldhVecs, REAL *hVals, int basisSize, int numConverged,
-      size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
+      int prevBasisSize, size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
       primme_params *primme) {
 
    int i, j; /* Loop variables    */
    int info; /* dsyev error value */
    int index;
    int *permu, *permw;
+   int useDC;     /* if nonzero, use divide and conquer */
    double targetShift;
 
    /* Some LAPACK implementations don't like zero-size matrices */
    if (basisSize == 0) return 0;
 
+   /* Divide and conquer (xheevd) is faster than xheevx for large problems. */
+   /* NOTE: the workspace query passes a dummy VtBV                         */
+   useDC = (!VtBV || H == NULL) && primme->dcMinBasisSize > 0
+      && basisSize >= primme->dcMinBasisSize;
+
    /* Return memory requirements */
    if (H == NULL) {
       SCALAR rwork0;
       CHKERR((Num_hegv_Sprimme("V", "U", basisSize, hVecs, basisSize, VtBV,
                   basisSize, hVals, &rwork0, -1, &info), info), -1);
       *lrwork = max(*lrwork, (size_t)REAL_PART(rwork0));
+      if (useDC) {
+         CHKERR((Num_heevd_Sprimme("V", "U", basisSize, hVecs, basisSize,
+                     hVals, &rwork0, -1, &info), info), -1);
+         *lrwork = max(*lrwork, (size_t)REAL_PART(rwork0));
+      }
+      if (primme->incrementalRR) {
+         CHKERR(solve_H_RR_append_Sprimme(NULL, 0, NULL, 0, NULL, basisSize,
+                  0, lrwork, NULL, 0, iwork, primme), -1);
+      }
       *iwork = max(*iwork, 2*basisSize);
       return 0;
    }
@@ -233,23 +335,37 @@ static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *VtBV, int ldVtBV,
    /* basisSize submatrix of H is copied into hvecs.                      */
    /* ------------------------------------------------------------------- */
 
-   if (primme->target != primme_largest) {
-      for (j=0; j < basisSize; j++) {
-         for (i=0; i <= j; i++) { 
-            hVecs[ldhVecs*j+i] = H[ldH*j+i];
-         }
-      }      
+   if (prevBasisSize > 0) {
+      /* Update the decomposition of H(0:prevBasisSize-1,0:prevBasisSize-1) */
+      CHKERR(solve_H_RR_append_Sprimme(H, ldH, hVecs, ldhVecs, hVals,
+               basisSize, prevBasisSize, lrwork, rwork, liwork, iwork, primme),
+            -1);
    }
-   else { /* (primme->target == primme_largest) */
-      for (j=0; j < basisSize; j++) {
-         for (i=0; i <= j; i++) { 
-            hVecs[ldhVecs*j+i] = -H[ldH*j+i];
+   else {
+      if (primme->target != primme_largest) {
+         for (j=0; j < basisSize; j++) {
+            for (i=0; i <= j; i++) { 
+               hVecs[ldhVecs*j+i] = H[ldH*j+i];
+            }
+         }      
+      }
+      else { /* (primme->target == primme_largest) */
+         for (j=0; j < basisSize; j++) {
+            for (i=0; i <= j; i++) { 
+               hVecs[ldhVecs*j+i] = -H[ldH*j+i];
+            }
          }
       }
-   }
 
-   CHKERR((Num_hegv_Sprimme("V", "U", basisSize, hVecs, ldhVecs, VtBV, ldVtBV,
-               hVals, rwork, TO_INT(*lrwork), &info), info), -1);
+      if (useDC) {
+         CHKERR((Num_heevd_Sprimme("V", "U", basisSize, hVecs, ldhVecs, hVals,
+                     rwork, TO_INT(*lrwork), &info), info), -1);
+      }
+      else {
+         CHKERR((Num_hegv_Sprimme("V", "U", basisSize, hVecs, ldhVecs, VtBV,
+                     ldVtBV, hVals, rwork, TO_INT(*lrwork), &info), info), -1);
+      }
+   }
 
    /* ---------------------------------------------------------------------- */
    /* ORDER the eigenvalues and their eigenvectors according to the desired  */
@@ -362,6 +478,334 @@ static int solve_H_RR_Sprimme(SCALAR *H, int ldH, SCALAR *VtBV, int ldVtBV,
    return 0;   
 }
 
+/*******************************************************************************
+ * Subroutine solve_H_RR_append - This procedure updates the eigendecomposition
+ *    of H(0:prevBasisSize-1,0:prevBasisSize-1) into that of H, being H the
+ *    matrix V'*A*V or -V'*A*V if the target is primme_largest. Every appended
+ *    column p changes the projected matrix into the arrowhead matrix
+ *       [diag(hVals) hVecs'*H(0:p-1,p); H(p,0:p-1)*hVecs H(p,p)],
+ *    which is solved by solve_arrowhead. The cost is dominated by the update
+ *    of hVecs, a matrix-matrix product.
+ *        
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * H              The matrix V'*A*V
+ * ldH            The leading dimension of H
+ * basisSize      The dimension of H
+ * prevBasisSize  The dimension of the decomposition in hVecs and hVals
+ * lrwork         Length of the work array rwork
+ * liwork         Length of the work array iwork
+ * primme         Structure containing various solver parameters
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * hVecs          On input the eigenvectors with leading dimension
+ *                prevBasisSize; on output the eigenvectors of H
+ * ldhVecs        The leading dimension of hVecs on output
+ * hVals          On input the Ritz values in any order; on output the
+ *                eigenvalues in ascending order
+ * rwork          Workspace
+ * iwork          Workspace in integers
+ *
+ * Return Value
+ * ------------
+ * error code
+ ******************************************************************************/
+
+static int solve_H_RR_append_Sprimme(SCALAR *H, int ldH, SCALAR *hVecs,
+      int ldhVecs, REAL *hVals, int basisSize, int prevBasisSize,
+      size_t *lrwork, SCALAR *rwork, int liwork, int *iwork,
+      primme_params *primme) {
+
+   int i, p;         /* Loop variables */
+   int n = basisSize;
+   SCALAR *Y;        /* Eigenvectors of the leading p-by-p submatrix */
+   SCALAR *T;        /* Auxiliary matrix for updating Y */
+   SCALAR *Z;        /* Eigenvectors of the arrowhead matrix */
+   SCALAR *b;        /* Last column of the arrowhead matrix */
+   REAL *d, *r, *lambda, *rwork0;
+   size_t lrwork0;
+   /* Solve for -H if the target is primme_largest */
+   double s = (primme->target == primme_largest) ? -1.0 : 1.0;
+
+   /* Return memory requirements */
+   if (H == NULL) {
+      *lrwork = max(*lrwork, (size_t)3*n*n + n
+            + (sizeof(REAL)*((size_t)(n+1)*(n+1) + 9*n + 3) + sizeof(SCALAR)-1)
+              / sizeof(SCALAR) + 16);
+      *iwork = max(*iwork, 6*n + 2);
+      return 0;
+   }
+
+   /* ------------------------ */
+   /* Divide the rwork space   */
+   /* ------------------------ */
+   lrwork0 = *lrwork;
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)n*n, &Y, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)n*n, &T, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)n*n, &Z, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(n, &b, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(n, &d, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(n, &r, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(n, &lambda, &rwork, &lrwork0), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)(n+1)*(n+1) + 6*n + 3, &rwork0, &rwork,
+            &lrwork0), -1);
+   assert(liwork >= 6*n + 2);
+
+   /* Y = [hVecs 0; 0 I] and d = s*hVals */
+
+   Num_zero_matrix_Sprimme(Y, n, n, n);
+   Num_copy_matrix_Sprimme(hVecs, prevBasisSize, prevBasisSize, prevBasisSize,
+         Y, n);
+   for (i=prevBasisSize; i<n; i++) Y[n*i+i] = 1.0;
+   for (i=0; i<prevBasisSize; i++) d[i] = s*hVals[i];
+
+   for (p=prevBasisSize; p<n; p++) {
+
+      /* b = Y(0:p-1,0:p-1)'*s*H(0:p-1,p) */
+
+      Num_gemv_Sprimme("C", p, p, s, Y, n, &H[ldH*p], 1, 0.0, b, 1);
+
+      /* Make b real and nonnegative by scaling the columns of Y */
+
+      for (i=0; i<p; i++) {
+         r[i] = ABS(b[i]);
+         if (r[i] > 0.0) Num_scal_Sprimme(p, b[i]/r[i], &Y[n*i], 1);
+      }
+
+      /* Y(0:p,0:p) = Y(0:p,0:p)*Z, where Z are the eigenvectors of the */
+      /* arrowhead matrix [diag(d) r; r' s*H(p,p)]                      */
+
+      solve_arrowhead_Sprimme(p, d, r, s*REAL_PART(H[ldH*p+p]), lambda, Z,
+            p+1, rwork0, iwork);
+      Num_gemm_Sprimme("N", "N", p+1, p+1, p+1, 1.0, Y, n, Z, p+1, 0.0, T, n);
+      Num_copy_matrix_Sprimme(T, p+1, p+1, n, Y, n);
+      for (i=0; i<=p; i++) d[i] = lambda[i];
+   }
+
+   Num_copy_matrix_Sprimme(Y, n, n, n, hVecs, ldhVecs);
+   for (i=0; i<n; i++) hVals[i] = d[i];
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine solve_arrowhead - This procedure computes the eigendecomposition
+ *    of the real symmetric arrowhead matrix
+ *       A = [diag(d) r; r' c],
+ *    being r nonnegative. Negligible r_i and pairs of close d_i are deflated.
+ *    The rest of eigenvalues are the roots of the secular equation
+ *       f(l) = c - l - sum_i r_i^2/(d_i - l),
+ *    one in every interval between consecutive d_i, which are computed by
+ *    bisection safeguarded Newton iterations relative to the closest d_i.
+ *    Finally r is recomputed from the roots as in Gu and Eisenstat, so that
+ *    the explicit eigenvectors [r_i/(d_i - l); -1] are numerically orthogonal.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * n        The dimension of d and r; A is (n+1)-by-(n+1)
+ * d        The diagonal of A except the last entry
+ * r        The last column of A except the last entry
+ * c        The last diagonal entry of A
+ * ldZ      The leading dimension of Z
+ * rwork    Workspace of size (n+1)^2+6*n+3
+ * iwork    Workspace in integers of size 6*n+2
+ *
+ * OUTPUT ARRAYS
+ * -------------
+ * lambda   The eigenvalues of A in ascending order
+ * Z        The eigenvectors of A
+ ******************************************************************************/
+
+static void solve_arrowhead_Sprimme(int n, REAL *d, REAL *r, REAL c,
+      REAL *lambda, SCALAR *Z, int ldZ, REAL *rwork, int *iwork) {
+
+   int i, j, k, t, it;  /* Loop variables */
+   int q;               /* Number of nondeflated entries */
+   int nrot;            /* Number of rotations applied in deflation */
+   REAL *ds = rwork;    /* d in ascending order */
+   REAL *rs = ds + n;   /* r in the order of ds */
+   REAL *rcs = rs + n;  /* cosines of the rotations */
+   REAL *rsn = rcs + n; /* sines of the rotations */
+   REAL *tau = rsn + n; /* roots relative to their origin */
+   REAL *lam = tau + n + 1; /* unsorted eigenvalues */
+   REAL *Zs = lam + n + 1;  /* eigenvectors in the order of ds */
+   int *idx = iwork;    /* permutation that sorts d */
+   int *K = idx + n;    /* nondeflated positions in ds */
+   int *roti = K + n, *rotj = roti + n; /* planes of the rotations */
+   int *org = rotj + n; /* position in ds of the origin of the roots */
+   int *perm = org + n + 1; /* permutation that sorts lam */
+   REAL nrm, rnrm, tol;
+
+   /* Sort d in ascending order */
+
+   for (i=0; i<n; i++) {
+      for (j=i; j>0 && d[idx[j-1]] > d[i]; j--) idx[j] = idx[j-1];
+      idx[j] = i;
+   }
+   nrm = fabs(c);
+   rnrm = 0.0;
+   for (i=0; i<n; i++) {
+      ds[i] = d[idx[i]];
+      rs[i] = r[idx[i]];
+      nrm = max(nrm, fabs(ds[i]));
+      rnrm += rs[i]*rs[i];
+   }
+   rnrm = sqrt(rnrm);
+   nrm = max(nrm, rnrm);
+   tol = 8.0*MACHINE_EPSILON*nrm;
+
+   /* Deflate the negligible r_i, and rotate pairs of close d_i so that */
+   /* only one of them has a nonzero r_i                                */
+
+   for (i=q=nrot=0; i<n; i++) {
+      if (rs[i] <= tol) continue;
+      if (q > 0 && ds[i] - ds[K[q-1]] <= tol) {
+         REAL h;
+         j = K[q-1];
+         h = sqrt(rs[i]*rs[i] + rs[j]*rs[j]);
+         rcs[nrot] = rs[i]/h;
+         rsn[nrot] = rs[j]/h;
+         roti[nrot] = j;
+         rotj[nrot++] = i;
+         rs[j] = 0.0;
+         rs[i] = h;
+         K[q-1] = i;
+      }
+      else {
+         K[q++] = i;
+      }
+   }
+
+   /* Compute the roots of the secular equation */
+
+   for (t=0; t<=q && q>0; t++) {
+      REAL a, b, x, dorg;
+      int o;
+
+      /* Bracket the root in (a,b) relative to the closest pole */
+
+      if (t == 0) {
+         o = K[0];
+         a = min(ds[o], c) - rnrm - ds[o];
+         b = 0.0;
+      }
+      else if (t == q) {
+         o = K[q-1];
+         a = 0.0;
+         b = max(ds[o], c) + rnrm - ds[o];
+      }
+      else {
+         REAL g, h = (ds[K[t]] - ds[K[t-1]])/2.0;
+         o = K[t-1];
+         g = c - ds[o] - h;
+         for (k=0; k<q; k++) {
+            g -= rs[K[k]]*rs[K[k]]/(ds[K[k]] - ds[o] - h);
+         }
+         if (g > 0.0) {
+            o = K[t];
+            a = -h;
+            b = 0.0;
+         }
+         else {
+            a = 0.0;
+            b = h;
+         }
+      }
+      dorg = ds[o];
+
+      /* f is decreasing in (a,b) */
+
+      x = (a + b)/2.0;
+      for (it=0; it<100; it++) {
+         REAL g = c - dorg - x, dg = -1.0, xn;
+         for (k=0; k<q; k++) {
+            REAL w = rs[K[k]]/(ds[K[k]] - dorg - x);
+            g -= rs[K[k]]*w;
+            dg -= w*w;
+         }
+         if (g > 0.0) a = x;
+         else if (g < 0.0) b = x;
+         else break;
+         xn = x - g/dg;
+         if (!(xn > a && xn < b)) xn = (a + b)/2.0;
+         if (fabs(xn - x) <= 2.0*MACHINE_EPSILON*fabs(xn)
+               || b - a <= 2.0*MACHINE_EPSILON*max(fabs(a), fabs(b))) {
+            x = xn;
+            break;
+         }
+         x = xn;
+      }
+      tau[t] = x;
+      org[t] = o;
+      lam[t] = dorg + x;
+   }
+   if (q == 0) {
+      tau[0] = 0.0;
+      org[0] = -1;
+      lam[0] = c;
+   }
+
+   /* Recompute r from the roots, r_k^2 = -prod_t (lam_t - d_k) /       */
+   /* prod_{j!=k} (d_j - d_k), so that the eigenvectors are orthogonal  */
+
+   for (k=0; k<q; k++) {
+      REAL dk = ds[K[k]], v = -1.0;
+      for (t=0; t<=q; t++) {
+         v *= ds[org[t]] - dk + tau[t];
+         if (t < q && t != k) v /= ds[K[t]] - dk;
+      }
+      rs[K[k]] = sqrt(max(v, 0.0));
+   }
+
+   /* Compute the eigenvectors: first the ones of the secular equation, */
+   /* and then the deflated ones, e_i                                   */
+
+   for (i=0; i<(n+1)*(n+1); i++) Zs[i] = 0.0;
+   for (t=0; t<=q; t++) {
+      REAL *z = &Zs[(n+1)*t], nz = 1.0;
+      z[n] = -1.0;
+      for (k=0; k<q; k++) {
+         z[K[k]] = rs[K[k]]/(ds[K[k]] - ds[org[t]] - tau[t]);
+         nz += z[K[k]]*z[K[k]];
+      }
+      nz = sqrt(nz);
+      for (k=0; k<q; k++) z[K[k]] /= nz;
+      z[n] /= nz;
+   }
+   for (i=0; i<n; i++) perm[i] = 0;
+   for (k=0; k<q; k++) perm[K[k]] = 1;
+   for (i=0, t=q+1; i<n; i++) {
+      if (perm[i]) continue;
+      Zs[(n+1)*t+i] = 1.0;
+      lam[t++] = ds[i];
+   }
+
+   /* Undo the rotations */
+
+   for (k=nrot-1; k>=0; k--) {
+      for (t=0; t<=n; t++) {
+         REAL *z = &Zs[(n+1)*t];
+         REAL za = z[roti[k]], zb = z[rotj[k]];
+         z[roti[k]] = rcs[k]*za + rsn[k]*zb;
+         z[rotj[k]] = -rsn[k]*za + rcs[k]*zb;
+      }
+   }
+
+   /* Sort the eigenvalues in ascending order, and undo the sorting of d */
+
+   for (i=0; i<=n; i++) {
+      for (j=i; j>0 && lam[perm[j-1]] > lam[i]; j--) perm[j] = perm[j-1];
+      perm[j] = i;
+   }
+   for (t=0; t<=n; t++) {
+      REAL *z = &Zs[(n+1)*perm[t]];
+      lambda[t] = lam[perm[t]];
+      for (i=0; i<n; i++) Z[ldZ*t+idx[i]] = z[i];
+      Z[ldZ*t+n] = z[n];
+   }
+}
+
 /*******************************************************************************
  * Subroutine solve_H_Harm - This procedure implements the harmonic extraction
  *    in a novelty way. In standard harmonic the next eigenproblem is solved:
@@ -421,7 +865,7 @@ static int solve_H_Harm_Sprimme(SCALAR *H, int ldH, SCALAR *QtV, int ldQtV,
    /* Return memory requirements */
    if (QtV == NULL) {
       CHKERR(solve_H_RR_Sprimme(QtV, ldQtV, NULL, 0, hVecs, ldhVecs, hVals,
-               basisSize, 0, lrwork, rwork, liwork, iwork, primme), -1);
+               basisSize, 0, 0, lrwork, rwork, liwork, iwork, primme), -1);
       return 0;
    }
 
@@ -450,7 +894,7 @@ static int solve_H_Harm_Sprimme(SCALAR *H, int ldH, SCALAR *QtV, int ldQtV,
          assert(0);
    }
    ret = solve_H_RR_Sprimme(hVecs, ldhVecs, NULL, 0, hVecs, ldhVecs, hVals,
-         basisSize, 0, lrwork, rwork, liwork, iwork, primme);
+         basisSize, 0, 0, lrwork, rwork, liwork, iwork, primme);
    primme->targetShifts = oldTargetShifts;
    primme->target = oldTarget;
    CHKERRM(ret, -1, "Error calling solve_H_RR_Sprimme\n");
@@ -838,7 +1282,7 @@ int prepare_vecs_Sprimme(int basisSize, int i0, int blockSize,
       CHKERR(compute_submatrix_Sprimme(NULL, basisSize, 0, NULL,
                basisSize, 0, NULL, 0, NULL, &rworkSize0), -1);
       CHKERR(solve_H_RR_Sprimme(NULL, 0, NULL, 0, NULL, 0, NULL, basisSize, 0,
-            &rworkSize0, NULL, 0, iwork, primme), -1);
+            0, &rworkSize0, NULL, 0, iwork, primme), -1);
       rworkSize0 += (size_t)basisSize*(size_t)basisSize; /* aH */
       *rworkSize = max(*rworkSize, rworkSize0);
       return 0;
@@ -859,7 +1303,8 @@ int prepare_vecs_Sprimme(int basisSize, int i0, int blockSize,
 
       /* Compute and sort eigendecomposition aH*ahVecs = ahVecs*diag(hVals(j:i-1)) */
       CHKERR(solve_H_RR_Sprimme(H, ldH, NULL, 0, hVecs, ldhVecs, hVals, basisSize,
-            targetShiftIndex, rworkSize, rwork, iworkSize, iwork, primme), -1);
+            targetShiftIndex, 0, rworkSize, rwork, iworkSize, iwork, primme),
+            -1);
 
       *arbitraryVecs = 0;
 
@@ -959,8 +1404,8 @@ int prepare_vecs_Sprimme(int basisSize, int i0, int blockSize,
 
          /* Compute and sort eigendecomposition aH*ahVecs = ahVecs*diag(hVals(j:i-1)) */
          CHKERR(solve_H_RR_Sprimme(aH, aBasisSize, NULL, 0, ahVecs, ldhVecsRot,
-               &hVals[j], aBasisSize, targetShiftIndex, &rworkSize0, rwork0,
-               iworkSize, iwork, primme), -1);
+               &hVals[j], aBasisSize, targetShiftIndex, 0, &rworkSize0,
+               rwork0, iworkSize, iwork, primme), -1);
 
          /* hVecs(:,j:i-1) = hVecs(:,j:i-1)*ahVecs */
          Num_gemm_Sprimme("N", "N", basisSize, aBasisSize, aBasisSize,
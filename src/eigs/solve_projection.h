@@ -44,6 +44,16 @@ int solve_H_dprimme(double *H, int basisSize, int ldH, double *VtBV, int ldVtBV,
    double *QtV, int ldQtV, double *hU, int ldhU, double *hVecs, int ldhVecs,
    double *hVals, double *hSVals, int numConverged, double machEps, size_t *lrwork,
    double *rwork, int liwork, int *iwork, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(solve_H_append_Sprimme)
+#  define solve_H_append_Sprimme CONCAT(solve_H_append_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(solve_H_append_Rprimme)
+#  define solve_H_append_Rprimme CONCAT(solve_H_append_,REAL_SUF)
+#endif
+int solve_H_append_dprimme(double *H, int basisSize, int ldH,
+      int prevBasisSize, double *hVecs, int ldhVecs, double *hVals,
+      int numConverged, size_t *lrwork, double *rwork, int liwork,
+      int *iwork, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(prepare_vecs_Sprimme)
 #  define prepare_vecs_Sprimme CONCAT(prepare_vecs_,SCALAR_SUF)
 #endif
@@ -61,6 +71,10 @@ int solve_H_zprimme(PRIMME_COMPLEX_DOUBLE *H, int basisSize, int ldH, PRIMME_COM
    PRIMME_COMPLEX_DOUBLE *QtV, int ldQtV, PRIMME_COMPLEX_DOUBLE *hU, int ldhU, PRIMME_COMPLEX_DOUBLE *hVecs, int ldhVecs,
    double *hVals, double *hSVals, int numConverged, double machEps, size_t *lrwork,
    PRIMME_COMPLEX_DOUBLE *rwork, int liwork, int *iwork, primme_params *primme);
+int solve_H_append_zprimme(PRIMME_COMPLEX_DOUBLE *H, int basisSize, int ldH,
+      int prevBasisSize, PRIMME_COMPLEX_DOUBLE *hVecs, int ldhVecs, double *hVals,
+      int numConverged, size_t *lrwork, PRIMME_COMPLEX_DOUBLE *rwork, int liwork,
+      int *iwork, primme_params *primme);
 int prepare_vecs_zprimme(int basisSize, int i0, int blockSize,
       PRIMME_COMPLEX_DOUBLE *H, int ldH, double *hVals, double *hSVals, PRIMME_COMPLEX_DOUBLE *hVecs,
       int ldhVecs, int targetShiftIndex, int *arbitraryVecs,
@@ -72,6 +86,10 @@ int solve_H_sprimme(float *H, int basisSize, int ldH, float *VtBV, int ldVtBV,
    float *QtV, int ldQtV, float *hU, int ldhU, float *hVecs, int ldhVecs,
    float *hVals, float *hSVals, int numConverged, double machEps, size_t *lrwork,
    float *rwork, int liwork, int *iwork, primme_params *primme);
+int solve_H_append_sprimme(float *H, int basisSize, int ldH,
+      int prevBasisSize, float *hVecs, int ldhVecs, float *hVals,
+      int numConverged, size_t *lrwork, float *rwork, int liwork,
+      int *iwork, primme_params *primme);
 int prepare_vecs_sprimme(int basisSize, int i0, int blockSize,
       float *H, int ldH, float *hVals, float *hSVals, float *hVecs,
       int ldhVecs, int targetShiftIndex, int *arbitraryVecs,
@@ -83,6 +101,10 @@ int solve_H_cprimme(PRIMME_COMPLEX_FLOAT *H, int basisSize, int ldH, PRIMME_COMP
    PRIMME_COMPLEX_FLOAT *QtV, int ldQtV, PRIMME_COMPLEX_FLOAT *hU, int ldhU, PRIMME_COMPLEX_FLOAT *hVecs, int ldhVecs,
    float *hVals, float *hSVals, int numConverged, double machEps, size_t *lrwork,
    PRIMME_COMPLEX_FLOAT *rwork, int liwork, int *iwork, primme_params *primme);
+int solve_H_append_cprimme(PRIMME_COMPLEX_FLOAT *H, int basisSize, int ldH,
+      int prevBasisSize, PRIMME_COMPLEX_FLOAT *hVecs, int ldhVecs, float *hVals,
+      int numConverged, size_t *lrwork, PRIMME_COMPLEX_FLOAT *rwork, int liwork,
+      int *iwork, primme_params *primme);
 int prepare_vecs_cprimme(int basisSize, int i0, int blockSize,
       PRIMME_COMPLEX_FLOAT *H, int ldH, float *hVals, float *hSVals, PRIMME_COMPLEX_FLOAT *hVecs,
       int ldhVecs, int targetShiftIndex, int *arbitraryVecs,
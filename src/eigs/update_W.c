@@ -34,14 +34,23 @@
  *
  ******************************************************************************/
 
+#include <stdio.h>
+#include <math.h>
 #include <assert.h>
+#include "const.h"
 #include "numerical.h"
 #include "update_W.h"
 #include "auxiliary_eigs.h"
+#include "globalsum.h"
 #include "ortho.h"
+#include "update_projection.h"
 #include "wtime.h"
+#include "trace.h"
 
 
+static int matrixMatvec_half(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, int blockSize, primme_params *primme);
+
 /*******************************************************************************
  * Subroutine matrixMatvec_ - Computes A*V(:,nv+1) through A*V(:,nv+blksze)
  *           where V(:,nv+1:nv+blksze) are the new correction vectors.
@@ -73,10 +82,20 @@ int matrixMatvec_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
    assert(ldV >= nLocal && ldW >= nLocal);
    assert(primme->ldOPs == 0 || primme->ldOPs >= nLocal);
 
-   t0 = primme_wTimer(0);
+   t0 = primme_get_wtime();
 
    /* W(:,c) = A*V(:,c) for c = basisSize:basisSize+blockSize-1 */
-   if (primme->ldOPs == 0 || (ldV == primme->ldOPs && ldW == primme->ldOPs)) {
+   if (primme->matvecHalfActive) {
+      CHKERR(matrixMatvec_half(&V[ldV*basisSize], nLocal, ldV,
+               &W[ldW*basisSize], ldW, blockSize, primme), -1);
+   }
+   else if (primme->rowMajorOPs) {
+      CHKERR(apply_rowmajor_Sprimme(primme->matrixMatvec, &V[ldV*basisSize],
+               nLocal, ldV, &W[ldW*basisSize], ldW, blockSize, &ierr, primme),
+            -1);
+      CHKERRM(ierr, -1, "Error returned by 'matrixMatvec' %d", ierr);
+   }
+   else if (primme->ldOPs == 0 || (ldV == primme->ldOPs && ldW == primme->ldOPs)) {
       CHKERRM((primme->matrixMatvec(&V[ldV*basisSize], &ldV, &W[ldW*basisSize],
                   &ldW, &blockSize, primme, &ierr), ierr), -1,
             "Error returned by 'matrixMatvec' %d", ierr);
@@ -90,13 +109,467 @@ int matrixMatvec_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       }
    }
 
-   primme->stats.timeMatvec += primme_wTimer(0) - t0;
+   primme->stats.timeMatvec += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_MATVEC, t0);
    primme->stats.numMatvecs += blockSize;
 
    return ierr;
 
 }
 
+/*******************************************************************************
+ * Functions float_to_fp16 and float_to_bf16 - Round a float to the nearest
+ *    IEEE half precision and bfloat16 number, with ties to even.
+ ******************************************************************************/
+
+static unsigned short float_to_fp16(float f) {
+
+   union { float f; unsigned int u; } v;
+   unsigned int sign, a, r, rem, half;
+   int shift;
+
+   v.f = f;
+   sign = (v.u >> 16) & 0x8000u;
+   a = v.u & 0x7fffffffu;
+
+   if (a > 0x7f800000u) return (unsigned short)(sign | 0x7e00u);  /* NaN */
+   if (a >= 0x477ff000u) return (unsigned short)(sign | 0x7c00u); /* Inf */
+   if (a < 0x38800000u) {              /* subnormal in half precision */
+      if (a < 0x33000000u) return (unsigned short)sign;
+      shift = 126 - (int)(a >> 23);
+      a = (a & 0x7fffffu) | 0x800000u;
+      r = a >> shift;
+      rem = a & ((1u << shift) - 1);
+      half = 1u << (shift - 1);
+   }
+   else {
+      r = (a - 0x38000000u) >> 13;
+      rem = a & 0x1fffu;
+      half = 0x1000u;
+   }
+   if (rem > half || (rem == half && (r & 1))) r++;
+   return (unsigned short)(sign | r);
+}
+
+static unsigned short float_to_bf16(float f) {
+
+   union { float f; unsigned int u; } v;
+
+   v.f = f;
+   if ((v.u & 0x7fffffffu) > 0x7f800000u) {  /* NaN */
+      return (unsigned short)((v.u >> 16) | 0x40u);
+   }
+   return (unsigned short)((v.u + 0x7fffu + ((v.u >> 16) & 1)) >> 16);
+}
+
+/*******************************************************************************
+ * Subroutine matrixMatvec_half - Computes W = A*V with matrixMatvecHalf, V
+ *    rounded to the format primme.matvecHalfType and W returned in float.
+ *    The parameters are the ones of matrixMatvec_ with basisSize = 0.
+ ******************************************************************************/
+
+static int matrixMatvec_half(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, int blockSize, primme_params *primme) {
+
+   int i, ierr=0;
+   const int c = (int)(sizeof(SCALAR)/sizeof(REAL)); /* reals per SCALAR */
+   PRIMME_INT j, ld = primme->ldOPs > 0 ? primme->ldOPs : nLocal;
+   char *buf;
+   unsigned short *x;
+   float *y;
+
+   CHKERR(MALLOC_PRIMME((size_t)ld*c*blockSize
+            *(sizeof(float) + sizeof(unsigned short)), &buf), -1);
+   y = (float*)buf;
+   x = (unsigned short*)&y[ld*c*blockSize];
+
+   for (i=0; i<blockSize; i++) {
+      REAL *v = (REAL*)&V[ldV*i];
+      if (primme->matvecHalfType == primme_half_bf16) {
+         for (j=0; j<nLocal*c; j++) x[ld*c*i+j] = float_to_bf16((float)v[j]);
+      }
+      else {
+         for (j=0; j<nLocal*c; j++) x[ld*c*i+j] = float_to_fp16((float)v[j]);
+      }
+   }
+
+   primme->matrixMatvecHalf(x, &ld, y, &ld, &blockSize, primme, &ierr);
+
+   if (ierr == 0) {
+      for (i=0; i<blockSize; i++) {
+         REAL *w = (REAL*)&W[ldW*i];
+         for (j=0; j<nLocal*c; j++) w[j] = (REAL)y[ld*c*i+j];
+      }
+   }
+   free(buf);
+   CHKERRM(ierr, -1, "Error returned by 'matrixMatvecHalf' %d", ierr);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine massMatrixMatvec_ - Computes B*V(:,nv+1) through B*V(:,nv+blksze)
+ *           where B is the mass matrix of the generalized problem.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * V          The basis
+ * nLocal     Number of rows of each vector stored on this node
+ * ldV        The leading dimension of V
+ * ldBV       The leading dimension of BV
+ * basisSize  Number of vectors in V
+ * blockSize  The current block size
+ *
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * BV         B*V
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int massMatrixMatvec_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *BV, PRIMME_INT ldBV, int basisSize, int blockSize,
+      primme_params *primme) {
+
+   int i, ONE=1, ierr=0;
+
+   if (blockSize <= 0) return 0;
+
+   assert(ldV >= nLocal && ldBV >= nLocal);
+   assert(primme->ldOPs == 0 || primme->ldOPs >= nLocal);
+
+   /* BV(:,c) = B*V(:,c) for c = basisSize:basisSize+blockSize-1 */
+   if (primme->rowMajorOPs) {
+      CHKERR(apply_rowmajor_Sprimme(primme->massMatrixMatvec,
+               &V[ldV*basisSize], nLocal, ldV, &BV[ldBV*basisSize], ldBV,
+               blockSize, &ierr, primme), -1);
+      CHKERRM(ierr, -1, "Error returned by 'massMatrixMatvec' %d", ierr);
+   }
+   else if (primme->ldOPs == 0 || (ldV == primme->ldOPs && ldBV == primme->ldOPs)) {
+      CHKERRM((primme->massMatrixMatvec(&V[ldV*basisSize], &ldV,
+                  &BV[ldBV*basisSize], &ldBV, &blockSize, primme, &ierr),
+               ierr), -1,
+            "Error returned by 'massMatrixMatvec' %d", ierr);
+   }
+   else {
+      for (i=0; i<blockSize; i++) {
+         CHKERRM((primme->massMatrixMatvec(&V[ldV*(basisSize+i)],
+                     &primme->ldOPs, &BV[ldBV*(basisSize+i)], &primme->ldOPs,
+                     &ONE, primme, &ierr), ierr), -1,
+               "Error returned by 'massMatrixMatvec' %d", ierr);
+      }
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine residual_B - Computes the Ritz vectors X = V*h, the residual
+ *    vectors R = W*h - B*X*diag(hVals) and their norms in generalized
+ *    problems when B*V is not kept, by applying B to X.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * V          The basis
+ * W          A*V
+ * ldV        The leading dimension of V and W
+ * nLocal     Number of rows of each vector stored on this node
+ * basisSize  Number of vectors in V
+ * h          The coefficients of the Ritz vectors
+ * ldh        The leading dimension of h
+ * hVals      The Ritz values
+ * n          Number of Ritz vectors
+ * ldX        The leading dimension of X
+ * ldR        The leading dimension of R
+ * rwork      Workspace
+ * rworkSize  Size of rwork
+ *
+ * OUTPUT ARRAYS
+ * -------------
+ * X          The Ritz vectors (optional)
+ * R          The residual vectors (optional)
+ * rnorms     The norms of R
+ *
+ * If V is NULL, rworkSize is increased to the required workspace.
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int residual_B_Sprimme(SCALAR *V, SCALAR *W, PRIMME_INT ldV, PRIMME_INT nLocal,
+      int basisSize, SCALAR *h, int ldh, REAL *hVals, int n, SCALAR *X,
+      PRIMME_INT ldX, SCALAR *R, PRIMME_INT ldR, REAL *rnorms, SCALAR *rwork,
+      size_t *rworkSize, primme_params *primme) {
+
+   int i;
+   SCALAR *BX;       /* B*X */
+   size_t rworkSize0 = *rworkSize;
+
+   /* Return memory requirement: B*X, X and R if they are not given, */
+   /* and the workspace of Num_update_VWXR                           */
+
+   if (V == NULL) {
+      SCALAR t;
+      *rworkSize = max(*rworkSize, (size_t)nLocal*n*3 +
+            (size_t)Num_update_VWXR_Sprimme(NULL, NULL, nLocal, basisSize, 0,
+               NULL, 0, 0, NULL,
+               &t, 0, n, 0,
+               NULL, 0, 0, 0,
+               NULL, 0, 0, 0,
+               &t, 0, n, 0,
+               NULL, 0, 0, 0, NULL,
+               NULL, 0, 0,
+               NULL, 0, primme));
+      return 0;
+   }
+
+   if (n <= 0) return 0;
+
+   /* Place X, R and B*X in rwork if needed */
+
+   assert(*rworkSize >= (size_t)nLocal*n*3);
+
+   if (!X) {
+      X = rwork; ldX = nLocal;
+      rwork += nLocal*n; rworkSize0 -= nLocal*n;
+   }
+   if (!R) {
+      R = rwork; ldR = nLocal;
+      rwork += nLocal*n; rworkSize0 -= nLocal*n;
+   }
+   BX = rwork;
+   rwork += nLocal*n; rworkSize0 -= nLocal*n;
+
+   /* X = V*h and R = W*h */
+
+   CHKERR(Num_update_VWXR_Sprimme(V, W, nLocal, basisSize, ldV, h, basisSize,
+            ldh, NULL,
+            X, 0, n, ldX,
+            NULL, 0, 0, 0,
+            NULL, 0, 0, 0,
+            R, 0, n, ldR,
+            NULL, 0, 0, 0, NULL,
+            NULL, 0, 0,
+            rwork, rworkSize0, primme), -1);
+
+   /* R = R - B*X*diag(hVals) */
+
+   CHKERR(massMatrixMatvec_Sprimme(X, nLocal, ldX, BX, nLocal, 0, n, primme),
+         -1);
+   for (i=0; i<n; i++) {
+      rnorms[i] = Num_compute_residual_norm_Sprimme(nLocal, hVals[i],
+            &BX[nLocal*i], &R[ldR*i], &R[ldR*i]);
+   }
+   CHKERR(globalSum_Rprimme(rnorms, rnorms, n, primme), -1);
+   for (i=0; i<n; i++) rnorms[i] = sqrt(rnorms[i]);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine matrixMatvec_project - Computes W(:,c) = A*V(:,c) and the new
+ *    columns of H = V'*W for c = basisSize:basisSize+blockSize-1.
+ *
+ *    If the user provides matrixMatvecProject, both are computed by the same
+ *    call, so W is not read back from memory to update H. Otherwise it calls
+ *    matrixMatvec_Sprimme and update_projection_Sprimme.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * V          The orthonormal basis
+ * nLocal     Number of rows of each vector stored on this node
+ * ldV        The leading dimension of V
+ * ldW        The leading dimension of W
+ * ldH        The leading dimension of H
+ * basisSize  Number of vectors in V
+ * blockSize  The current block size
+ * rwork      Workspace
+ * rworkSize  Size of rwork
+ * queue      If not NULL, the reduction of H is queued there
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * W          A*V
+ * H          V'*A*V, only the upper triangular part is updated
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int matrixMatvec_project_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, SCALAR *H, int ldH, int basisSize,
+      int blockSize, SCALAR *rwork, size_t *rworkSize, globalsum_queue *queue,
+      primme_params *primme) {
+
+   int ierr=0;
+   double t0;
+
+   /* Return memory requirement */
+   if (V == NULL) {
+      CHKERR(update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal,
+               basisSize, blockSize, NULL, rworkSize, 1/*symmetric*/, NULL,
+               primme), -1);
+      return 0;
+   }
+
+   if (blockSize <= 0) return 0;
+
+   /* Use matrixMatvec and update_projection if the fused callback is not */
+   /* given or the leading dimensions are not supported                   */
+
+   if (!H || !primme->matrixMatvecProject || primme->rowMajorOPs ||
+         !(primme->ldOPs == 0 || (ldV == primme->ldOPs &&
+               ldW == primme->ldOPs))) {
+      CHKERR(matrixMatvec_Sprimme(V, nLocal, ldV, W, ldW, basisSize,
+               blockSize, primme), -1);
+      if (H) CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H, ldH, nLocal,
+               basisSize, blockSize, rwork, rworkSize, 1/*symmetric*/, queue,
+               primme), -1);
+      return 0;
+   }
+
+   assert(ldV >= nLocal && ldW >= nLocal && ldH >= basisSize+blockSize);
+
+   t0 = primme_get_wtime();
+
+   /* W(:,c) = A*V(:,c) and H(:,c) = V'*W(:,c) locally */
+
+   int numCols = basisSize + blockSize;
+   CHKERRM((primme->matrixMatvecProject(&V[ldV*basisSize], &ldV,
+               &W[ldW*basisSize], &ldW, &blockSize, V, &ldV, &numCols,
+               &H[ldH*basisSize], &ldH, primme, &ierr), ierr), -1,
+         "Error returned by 'matrixMatvecProject' %d", ierr);
+
+   primme->stats.timeMatvec += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_MATVEC, t0);
+   primme->stats.numMatvecs += blockSize;
+
+   /* Reduce the new columns of H */
+
+   CHKERR(update_projection_reduce_Sprimme(H, ldH, basisSize, blockSize,
+            rwork, rworkSize, 1/*symmetric*/, queue, primme), -1);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine ortho_matrixMatvec_project - Orthogonalizes the new vectors
+ *    V(:,c), computes W(:,c) = A*V(:,c) and the new columns of H = V'*W for
+ *    c = basisSize:basisSize+blockSize-1.
+ *
+ *    If the user provides matrixMatvecStart and matrixMatvecWait, the block
+ *    is split in two halves. The product of the first half is started before
+ *    orthogonalizing the second half, and the columns of H for the first half
+ *    are computed while the product of the second half is in flight.
+ *    Otherwise it calls ortho_Sprimme and matrixMatvec_project_Sprimme.
+ *
+ *    In generalized problems, the new vectors are B-orthonormalized with
+ *    ortho_B_Sprimme instead, which also computes their columns of BV if
+ *    BV is given.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * nLocal     Number of rows of each vector stored on this node
+ * ldV        The leading dimension of V
+ * ldW        The leading dimension of W
+ * ldBV       The leading dimension of BV
+ * ldH        The leading dimension of H
+ * basisSize  Number of vectors in V
+ * blockSize  The current block size
+ * locked     The locked vectors and constraints
+ * ldLocked   The leading dimension of locked
+ * numLocked  Number of vectors in locked
+ * machEps    Machine precision
+ * rwork      Workspace
+ * rworkSize  Size of rwork
+ * queue      If not NULL, the reduction of H is queued there
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * V          The orthonormal basis; the new vectors are orthonormalized
+ * W          A*V
+ * BV         B*V (optional)
+ * H          V'*A*V, only the upper triangular part is updated
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int ortho_matrixMatvec_project_Sprimme(SCALAR *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, SCALAR *W, PRIMME_INT ldW, SCALAR *BV, PRIMME_INT ldBV,
+      SCALAR *H, int ldH, int basisSize, int blockSize, SCALAR *locked,
+      PRIMME_INT ldLocked, int numLocked, double machEps, SCALAR *rwork,
+      size_t *rworkSize, globalsum_queue *queue, primme_params *primme) {
+
+   int i, n, ierr=0;
+   int b[3];               /* The halves are V(:,b[i]:b[i+1]-1) */
+   void *request[2];       /* Handles of the products in flight */
+   double t0[2], t1;       /* Times when the products were started */
+
+   if (blockSize <= 0) return 0;
+
+   /* B-orthonormalize the new vectors against the basis; constraints and */
+   /* locked vectors are not supported with a mass matrix                 */
+
+   if (primme->massMatrixMatvec) {
+      assert(numLocked == 0);
+      CHKERR(ortho_B_Sprimme(V, ldV, BV, ldBV, basisSize,
+               basisSize+blockSize-1, nLocal, primme->iseed, machEps, rwork,
+               rworkSize, primme), -1);
+      CHKERR(matrixMatvec_project_Sprimme(V, nLocal, ldV, W, ldW, H, ldH,
+               basisSize, blockSize, rwork, rworkSize, queue, primme), -1);
+      return 0;
+   }
+
+   /* Orthogonalize and compute the products of the whole block if the */
+   /* nonblocking callbacks are not given or there is nothing to split  */
+
+   if (!H || blockSize < 2 || !primme->matrixMatvecStart ||
+         !primme->matrixMatvecWait || primme->rowMajorOPs ||
+         !(primme->ldOPs == 0 ||
+            (ldV == primme->ldOPs && ldW == primme->ldOPs))) {
+      CHKERR(ortho_Sprimme(V, ldV, NULL, 0, basisSize,
+               basisSize+blockSize-1, locked, ldLocked, numLocked, nLocal,
+               primme->iseed, machEps, rwork, rworkSize, primme), -1);
+      CHKERR(matrixMatvec_project_Sprimme(V, nLocal, ldV, W, ldW, H, ldH,
+               basisSize, blockSize, rwork, rworkSize, queue, primme), -1);
+      return 0;
+   }
+
+   assert(ldV >= nLocal && ldW >= nLocal && ldH >= basisSize+blockSize);
+
+   b[0] = basisSize;
+   b[1] = basisSize + blockSize/2;
+   b[2] = basisSize + blockSize;
+
+   /* Orthogonalize each half and start W(:,c) = A*V(:,c); the second */
+   /* half is orthogonalized while the product of the first one runs  */
+
+   for (i=0; i<2; i++) {
+      CHKERR(ortho_Sprimme(V, ldV, NULL, 0, b[i], b[i+1]-1, locked, ldLocked,
+               numLocked, nLocal, primme->iseed, machEps, rwork, rworkSize,
+               primme), -1);
+
+      n = b[i+1] - b[i];
+      t0[i] = primme_get_wtime();
+      CHKERRM((primme->matrixMatvecStart(&V[ldV*b[i]], &ldV, &W[ldW*b[i]],
+                  &ldW, &n, primme, &request[i], &ierr), ierr), -1,
+            "Error returned by 'matrixMatvecStart' %d", ierr);
+      primme->stats.timeMatvec += primme_get_wtime() - t0[i];
+      primme->stats.numMatvecs += n;
+   }
+
+   /* Finish the products and compute H(:,c) = V'*W(:,c); the columns of */
+   /* the first half are computed while the product of the second runs   */
+
+   for (i=0; i<2; i++) {
+      t1 = primme_get_wtime();
+      CHKERRM((primme->matrixMatvecWait(request[i], primme, &ierr), ierr), -1,
+            "Error returned by 'matrixMatvecWait' %d", ierr);
+      primme->stats.timeMatvec += primme_get_wtime() - t1;
+      primme_trace_record(primme->trace, PRIMME_TRACE_MATVEC, t0[i]);
+
+      CHKERR(update_projection_Sprimme(V, ldV, W, ldW, H, ldH, nLocal, b[i],
+               b[i+1]-b[i], rwork, rworkSize, 1/*symmetric*/, queue, primme),
+            -1);
+   }
+
+   return 0;
+}
+
 /*******************************************************************************
  * Subroutine update_QR - Computes the QR factorization (A-targetShift*I)*V
  *    updating only the columns nv:nv+blockSize-1 of Q and R.
@@ -158,3 +631,461 @@ int update_Q_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
 
    return 0;
 }
+
+/*******************************************************************************
+ * Subroutine matrixMatvec_sstep - Expands the basis with numSteps blocks of
+ *    blockSize vectors from the block of corrections V(:,b:b+blockSize-1),
+ *    b = basisSize, which must be already orthonormal with respect to
+ *    V(:,0:b-1) and the locked vectors. The blocks form a Newton basis,
+ *
+ *       X_0 = V(:,b:b+blockSize-1),  X_j = (A - diag(shifts))*X_{j-1}*scale,
+ *
+ *    where the shifts are the Ritz values of the block and scale is 1/|A|.
+ *    Computing W = A*X_j provides X_{j+1} for free, so no extra matvecs are
+ *    done. Then X_1,...,X_{numSteps-1} are orthonormalized against
+ *    V(:,0:b+blockSize-1), the locked vectors and among themselves with two
+ *    passes of block classical Gram-Schmidt followed by Cholesky QR, as in
+ *    Bortho_block, and W is updated with the same transformations. That is,
+ *    numSteps blocks are added with two global reductions instead of
+ *    numSteps-1 orthogonalizations. If the Newton basis is too
+ *    ill-conditioned for W to be updated accurately, only X_0 is added.
+ *
+ *    The products of A with the locked vectors are approximated by
+ *    locked*diag(lockedEvals). As X_0 is orthogonal to the locked vectors,
+ *    the components of X_j on them are of the order of their residual
+ *    norms, and so the error in W is of the order of the residual norms
+ *    squared.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * nLocal      Number of rows of each vector stored on this node
+ * ldV         The leading dimension of V
+ * ldW         The leading dimension of W
+ * basisSize   Number of vectors in V before the corrections
+ * blockSize   The number of corrections
+ * numSteps    Number of blocks to add, including the corrections
+ * hVals       The Ritz values
+ * iev         Index of the Ritz value of each correction
+ * locked      The locked vectors
+ * ldLocked    The leading dimension of locked
+ * numLocked   The number of locked vectors
+ * lockedEvals The eigenvalues of the locked vectors
+ * machEps     Machine precision
+ * rwork       Workspace
+ * rworkSize   Size of rwork
+ *
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * V           The basis, V(:,b:b+numSteps*blockSize-1) is updated
+ * W           A*V, W(:,b:b+numSteps*blockSize-1) is updated
+ *
+ * OUTPUT PARAMETERS
+ * -----------------
+ * numNew      Number of vectors added to V and W: numSteps*blockSize, or
+ *             blockSize if the new blocks were discarded
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int matrixMatvec_sstep_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, int basisSize, int blockSize, int numSteps,
+      REAL *hVals, int *iev, SCALAR *locked, PRIMME_INT ldLocked,
+      int numLocked, REAL *lockedEvals, int *numNew, double machEps,
+      SCALAR *rwork, size_t *rworkSize, primme_params *primme) {
+
+   int i, j, pass;
+   int nV = basisSize + blockSize;  /* columns of V to ortho against      */
+   int nQ = nV + numLocked;         /* number of vectors to ortho against */
+   int k = (numSteps-1)*blockSize;  /* number of vectors generated        */
+   int ldC = nQ + k;                /* leading dimension of C             */
+   double tol = sqrt(2.0L)/2.0L;    /* Daniel et al. test as in Bortho    */
+   double minRatio = 1e-3;          /* Minimum norm ratio in first pass   */
+   double aNorm, t0;
+   size_t localrworkSize = *rworkSize;
+
+   (void)machEps; /* unused parameter */
+
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      *rworkSize = max(*rworkSize, (size_t)ldC*k + k + 2);
+      return 0;
+   }
+
+   assert(ldV >= nLocal && ldW >= nLocal && numSteps >= 1);
+   assert(numLocked == 0 || ldLocked >= nLocal);
+
+   *numNew = blockSize;
+   if (blockSize <= 0) return 0;
+
+   /* X_{j+1} = (W_j - X_j*diag(shifts))*scale, W_{j+1} = A*X_{j+1} */
+
+   aNorm = max(primme->aNorm, primme->stats.estimateLargestSVal);
+   for (j=0; j<numSteps; j++) {
+      SCALAR *X = &V[ldV*(basisSize+j*blockSize)];
+      SCALAR *WX = &W[ldW*(basisSize+j*blockSize)];
+
+      CHKERR(matrixMatvec_Sprimme(V, nLocal, ldV, W, ldW,
+               basisSize+j*blockSize, blockSize, primme), -1);
+      if (j == numSteps-1) break;
+      for (i=0; i<blockSize; i++) {
+         Num_compute_residual_Sprimme(nLocal, hVals[iev[i]], &X[ldV*i],
+               &WX[ldW*i], &X[ldV*(blockSize+i)]);
+         if (aNorm > 0.0) {
+            Num_scal_Sprimme(nLocal, 1.0/aNorm, &X[ldV*(blockSize+i)], 1);
+         }
+      }
+   }
+
+   if (k <= 0) return 0;
+
+   t0 = primme_get_wtime();
+
+   SCALAR *C, *X = &V[ldV*nV], *WX = &W[ldW*nV];
+   CHKERR(WRKSP_MALLOC_PRIMME((size_t)ldC*k, &C, &rwork, &localrworkSize), -1);
+   SCALAR *Cl = &C[nV];     /* Components on the locked vectors */
+   SCALAR *G = &C[nQ];      /* Gram matrix of X, G = X'*X */
+   REAL *normsX;
+   CHKERR(WRKSP_MALLOC_PRIMME(k, &normsX, &rwork, &localrworkSize), -1);
+
+   for (pass=0; pass < 2; pass++) {
+      int info;
+
+      /* C = [V(:,0:nV-1) locked X]'*X */
+
+      Num_gemm_Sprimme("C", "N", nV, k, nLocal, 1.0, V, ldV, X, ldV, 0.0,
+            C, ldC);
+      if (numLocked > 0) {
+         Num_gemm_Sprimme("C", "N", numLocked, k, nLocal, 1.0, locked,
+               ldLocked, X, ldV, 0.0, Cl, ldC);
+      }
+      Num_gemm_Sprimme("C", "N", k, k, nLocal, 1.0, X, ldV, X, ldV, 0.0, G,
+            ldC);
+      primme->stats.numOrthoInnerProds += (double)ldC*k;
+      CHKERR(globalSum_Sprimme(C, C, ldC*k, primme), -1);
+
+      /* X = X - [V(:,0:nV-1) locked]*C(0:nQ-1,:) and                    */
+      /* W = W - [W(:,0:nV-1) locked*diag(lockedEvals)]*C(0:nQ-1,:)      */
+
+      Num_gemm_Sprimme("N", "N", nLocal, k, nV, -1.0, V, ldV, C, ldC, 1.0,
+            X, ldV);
+      Num_gemm_Sprimme("N", "N", nLocal, k, nV, -1.0, W, ldW, C, ldC, 1.0,
+            WX, ldW);
+      if (numLocked > 0) {
+         Num_gemm_Sprimme("N", "N", nLocal, k, numLocked, -1.0, locked,
+               ldLocked, Cl, ldC, 1.0, X, ldV);
+      }
+      primme->stats.numOrthoInnerProds += (double)nQ*k;
+
+      /* G = G - C(0:nQ-1,:)'*C(0:nQ-1,:), the Gram matrix of the new X */
+
+      for (i=0; i < k; i++) normsX[i] = REAL_PART(G[ldC*i+i]);
+      Num_gemm_Sprimme("C", "N", k, k, nQ, -1.0, C, ldC, C, ldC, 1.0, G, ldC);
+
+      if (numLocked > 0) {
+         for (j=0; j < k; j++)
+            for (i=0; i < numLocked; i++)
+               Cl[ldC*j+i] *= lockedEvals[i];
+         Num_gemm_Sprimme("N", "N", nLocal, k, numLocked, -1.0, locked,
+               ldLocked, Cl, ldC, 1.0, WX, ldW);
+      }
+
+      /* W is updated with the transformations applied to X, so the error  */
+      /* in W is amplified by the conditioning of X. In the first pass, ask */
+      /* for keeping most of the norm of every vector after removing the    */
+      /* components on V and on the previous vectors. In the second pass,   */
+      /* the vectors should be nearly orthogonal following Daniel's test.   */
+      /* The vectors after the first one failing are discarded.             */
+
+      for (i=0; i < k; i++) {
+         REAL s12 = REAL_PART(G[ldC*i+i]);
+         if (!(s12 > (pass == 0 ? minRatio : tol*tol)*normsX[i])) break;
+         normsX[i] = s12;
+      }
+      k = i;
+      if (k == 0) break;
+
+      /* G = U'*U; X = X/U and W = W/U */
+
+      Num_potrf_Sprimme("U", k, G, ldC, &info);
+      if (info != 0) {
+         k = 0;
+         break;
+      }
+      for (i=0; i < k; i++) {
+         REAL u = REAL_PART(G[ldC*i+i]);
+         if (!(u*u > (pass == 0 ? minRatio : tol*tol)*normsX[i])) break;
+      }
+      k = i;
+      if (k == 0) break;
+      Num_trsm_Sprimme("R", "U", "N", "N", nLocal, k, 1.0, G, ldC, X, ldV);
+      Num_trsm_Sprimme("R", "U", "N", "N", nLocal, k, 1.0, G, ldC, WX, ldW);
+   }
+
+   primme->stats.timeOrtho += primme_get_wtime() - t0;
+   primme_trace_record(primme->trace, PRIMME_TRACE_ORTHO, t0);
+
+   if (k < (numSteps-1)*blockSize && primme->procID == 0
+         && primme->printLevel >= 3) {
+      fprintf(primme->outputFile,
+            "s-step basis is ill-conditioned; added %d of %d vectors\n",
+            blockSize + k, numSteps*blockSize);
+   }
+
+   *numNew = blockSize + k;
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine matrixPowers - Replaces the block X = V(:,0:blockSize-1) by
+ *    p_k(A)*X, where k = degree and p_k is given by the three-term recurrence
+ *
+ *       p_0(A) = I,  p_1(A) = alpha[0]*(A - beta[0]*I),
+ *       p_{j+1}(A) = alpha[j]*(A - beta[j]*I)*p_j(A) - gamma[j]*p_{j-1}(A).
+ *
+ *    If primme.matrixPowers is set, it computes the polynomial in one call;
+ *    for instance, with a matrix-powers kernel that does a single halo
+ *    exchange for all the steps. Otherwise the recurrence is done with k
+ *    calls to matrixMatvec.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * nLocal      Number of rows of each vector stored on this node
+ * ldV         The leading dimension of V
+ * ldW         The leading dimension of W
+ * blockSize   The number of vectors in the block
+ * degree      The degree of the polynomial, k
+ * alpha, beta, gamma  The coefficients of the recurrence, of size k
+ * rwork       Workspace
+ * rworkSize   Size of rwork
+ *
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * V           V(:,0:blockSize-1) is replaced by p_k(A)*V(:,0:blockSize-1)
+ * W           W(:,0:blockSize-1) is overwritten
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int matrixPowers_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, int blockSize, int degree, double *alpha,
+      double *beta, double *gamma, SCALAR *rwork, size_t *rworkSize,
+      primme_params *primme) {
+
+   int i, j, ierr=0;
+   double t0;
+   SCALAR *X[3];        /* X[0] = p_{j-2}(A)X, X[1] = p_{j-1}(A)X, X[2] work */
+   PRIMME_INT ldX[3];
+
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      *rworkSize = max(*rworkSize, (size_t)nLocal*blockSize);
+      return 0;
+   }
+
+   if (blockSize <= 0 || degree <= 0) return 0;
+
+   /* Call matrixPowers if it takes the blocks as they are */
+
+   if (primme->matrixPowers && !primme->matvecHalfActive
+         && !primme->rowMajorOPs && (primme->ldOPs == 0
+            || (ldV == primme->ldOPs && ldW == primme->ldOPs))) {
+      t0 = primme_get_wtime();
+      CHKERRM((primme->matrixPowers(V, &ldV, W, &ldW, &blockSize, &degree,
+                  alpha, beta, gamma, primme, &ierr), ierr), -1,
+            "Error returned by 'matrixPowers' %d", ierr);
+      primme->stats.timeMatvec += primme_get_wtime() - t0;
+      primme_trace_record(primme->trace, PRIMME_TRACE_MATVEC, t0);
+      primme->stats.numMatvecs += (PRIMME_INT)degree*blockSize;
+      Num_copy_matrix_Sprimme(W, nLocal, blockSize, ldW, V, ldV);
+      return 0;
+   }
+
+   assert(*rworkSize >= (size_t)nLocal*blockSize);
+
+   /* X[1] = (A - beta[0]*I)*X*alpha[0] */
+
+   X[0] = V;      ldX[0] = ldV;
+   X[1] = W;      ldX[1] = ldW;
+   X[2] = rwork;  ldX[2] = nLocal;
+   CHKERR(matrixMatvec_Sprimme(X[0], nLocal, ldX[0], X[1], ldX[1], 0,
+            blockSize, primme), -1);
+   for (i=0; i<blockSize; i++) {
+      Num_axpy_Sprimme(nLocal, -beta[0], &X[0][ldX[0]*i], 1,
+            &X[1][ldX[1]*i], 1);
+      Num_scal_Sprimme(nLocal, alpha[0], &X[1][ldX[1]*i], 1);
+   }
+
+   /* X[2] = (A - beta[j]*I)*X[1]*alpha[j] - X[0]*gamma[j] */
+
+   for (j=1; j<degree; j++) {
+      SCALAR *aux;
+      PRIMME_INT ldaux;
+
+      CHKERR(matrixMatvec_Sprimme(X[1], nLocal, ldX[1], X[2], ldX[2], 0,
+               blockSize, primme), -1);
+      for (i=0; i<blockSize; i++) {
+         Num_axpy_Sprimme(nLocal, -beta[j], &X[1][ldX[1]*i], 1,
+               &X[2][ldX[2]*i], 1);
+         Num_scal_Sprimme(nLocal, alpha[j], &X[2][ldX[2]*i], 1);
+         Num_axpy_Sprimme(nLocal, -gamma[j], &X[0][ldX[0]*i], 1,
+               &X[2][ldX[2]*i], 1);
+      }
+      aux = X[0]; ldaux = ldX[0];
+      X[0] = X[1]; ldX[0] = ldX[1];
+      X[1] = X[2]; ldX[1] = ldX[2];
+      X[2] = aux; ldX[2] = ldaux;
+   }
+
+   /* V(:,0:blockSize-1) = X[1] */
+
+   if (X[1] != V) {
+      Num_copy_matrix_Sprimme(X[1], nLocal, blockSize, ldX[1], V, ldV);
+   }
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine chebyshev_filter - Replaces the block of Ritz vectors X =
+ *    V(:,b:b+blockSize-1), b = basisSize, by p(A)*X, where p is the Chebyshev
+ *    polynomial of the first kind mapped to the interval [l, u] that is
+ *    damped, and scaled so that p(a0) = 1,
+ *
+ *       p(x) = T_k((x - c)/e) / T_k((a0 - c)/e),  c = (l + u)/2, e = (u - l)/2.
+ *
+ *    This is the expansion of the Chebyshev-Davidson method by Zhou and Saad,
+ *    and it is used instead of the correction equations.
+ *
+ *    For primme_smallest, [l, u] goes from the median of the unwanted Ritz
+ *    values to the estimate of the largest eigenvalue enlarged by a tenth of
+ *    the spread of the spectrum (or aNorm if that is larger), and a0 is the
+ *    first Ritz value. For primme_largest it is the other way around.
+ *
+ *    The degree k is the smallest that amplifies the Ritz values of the block
+ *    by a factor 100 with respect to the damped interval, up to
+ *    primme.chebyshevDegree and the matrix-vector products left. The
+ *    polynomial is applied by matrixPowers with the scaled three-term
+ *    recurrence, which performs k block matrix-vector products and no global
+ *    reduction.
+ *
+ *    The block is not changed and the returned degree is zero if the filter
+ *    is disabled, the target is not primme_smallest or primme_largest, there
+ *    are not enough unwanted Ritz values, or some Ritz value of the block is
+ *    in the damped interval.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * nLocal      Number of rows of each vector stored on this node
+ * ldV         The leading dimension of V
+ * ldW         The leading dimension of W
+ * basisSize   Number of vectors in V before the block
+ * blockSize   The number of vectors in the block
+ * hVals       The Ritz values
+ * iev         Index of the Ritz value of each vector in the block
+ * numWanted   Number of Ritz values in the basis still wanted
+ * rwork       Workspace
+ * rworkSize   Size of rwork
+ *
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * V           The basis, V(:,b:b+blockSize-1) is updated
+ * W           W(:,b:b+blockSize-1) is overwritten
+ *
+ * OUTPUT PARAMETERS
+ * -----------------
+ * degree      The degree of the polynomial applied, or zero
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int chebyshev_filter_Sprimme(SCALAR *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      SCALAR *W, PRIMME_INT ldW, int basisSize, int blockSize, REAL *hVals,
+      int *iev, int numWanted, int *degree, SCALAR *rwork, size_t *rworkSize,
+      primme_params *primme) {
+
+   int i, j, k, m;
+   double l, u, c, e, a0, x, spread, sigma, sigma1, sigma2;
+   double *alpha, *beta, *gamma;   /* coefficients of the recurrence */
+   size_t localrworkSize = *rworkSize;
+
+   /* Return memory requirement */
+
+   if (V == NULL) {
+      if (primme->chebyshevDegree > 0) {
+         size_t rworkSize0 = 0;
+         CHKERR(matrixPowers_Sprimme(NULL, nLocal, 0, NULL, 0, blockSize, 0,
+                  NULL, NULL, NULL, NULL, &rworkSize0, primme), -1);
+         *rworkSize = max(*rworkSize, rworkSize0
+               + 3*(((size_t)primme->chebyshevDegree+1)*sizeof(double)
+                  /sizeof(SCALAR) + 1));
+      }
+      return 0;
+   }
+
+   *degree = 0;
+   if (primme->chebyshevDegree <= 0 || blockSize <= 0
+         || (primme->target != primme_smallest
+            && primme->target != primme_largest)) {
+      return 0;
+   }
+
+   /* Set the damped interval [l, u] and the scaling point a0 */
+
+   m = numWanted + (basisSize - numWanted)/2;
+   if (numWanted < 0 || m >= basisSize || m <= numWanted) return 0;
+   spread = primme->stats.estimateMaxEVal - primme->stats.estimateMinEVal;
+   if (!(spread > 0.0)) return 0;
+   a0 = hVals[0];
+   if (primme->target == primme_smallest) {
+      l = hVals[m];
+      u = max(primme->stats.estimateMaxEVal + spread/10.0, primme->aNorm);
+   }
+   else {
+      l = min(primme->stats.estimateMinEVal - spread/10.0, -primme->aNorm);
+      u = hVals[m];
+   }
+   c = (l + u)/2.0;
+   e = (u - l)/2.0;
+
+   /* Choose the degree from the Ritz value of the block closest to [l, u] */
+
+   for (i=0, x=HUGE_VAL; i<blockSize; i++) {
+      x = min(x, fabs(hVals[iev[i]] - c)/e);
+   }
+   if (!(x > 1.0)) return 0;
+   k = primme->chebyshevDegree;
+   if (acosh(100.0)/acosh(x) < k) k = (int)ceil(acosh(100.0)/acosh(x));
+   k = (int)min(k, (primme->maxMatvecs - primme->stats.numMatvecs)/blockSize
+         - 1);
+   if (k <= 0) return 0;
+   *degree = k;
+
+   /* p_1(A) = (A - c*I)*sigma1/e and                                   */
+   /* p_{j+1}(A) = (A - c*I)*p_j(A)*2*sigma2/e - p_{j-1}(A)*sigma*sigma2 */
+
+   CHKERR(WRKSP_MALLOC_PRIMME(k, &alpha, &rwork, &localrworkSize), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(k, &beta, &rwork, &localrworkSize), -1);
+   CHKERR(WRKSP_MALLOC_PRIMME(k, &gamma, &rwork, &localrworkSize), -1);
+   sigma = sigma1 = e/(a0 - c);
+   alpha[0] = sigma1/e;
+   beta[0] = c;
+   gamma[0] = 0.0;
+   for (j=1; j<k; j++) {
+      sigma2 = 1.0/(2.0/sigma1 - sigma);
+      alpha[j] = 2.0*sigma2/e;
+      beta[j] = c;
+      gamma[j] = sigma*sigma2;
+      sigma = sigma2;
+   }
+
+   CHKERR(matrixPowers_Sprimme(&V[ldV*basisSize], nLocal, ldV,
+            &W[ldW*basisSize], ldW, blockSize, k, alpha, beta, gamma, rwork,
+            &localrworkSize, primme), -1);
+
+   if (primme->procID == 0 && primme->printLevel >= 5) {
+      fprintf(primme->outputFile,
+            "Chebyshev filter of degree %d on [%g, %g]\n", k, l, u);
+   }
+
+   return 0;
+}
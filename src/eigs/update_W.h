@@ -42,6 +42,46 @@
 int matrixMatvec_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       double *W, PRIMME_INT ldW, int basisSize, int blockSize,
       primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(massMatrixMatvec_Sprimme)
+#  define massMatrixMatvec_Sprimme CONCAT(massMatrixMatvec_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(massMatrixMatvec_Rprimme)
+#  define massMatrixMatvec_Rprimme CONCAT(massMatrixMatvec_,REAL_SUF)
+#endif
+int massMatrixMatvec_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      double *BV, PRIMME_INT ldBV, int basisSize, int blockSize,
+      primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(residual_B_Sprimme)
+#  define residual_B_Sprimme CONCAT(residual_B_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(residual_B_Rprimme)
+#  define residual_B_Rprimme CONCAT(residual_B_,REAL_SUF)
+#endif
+int residual_B_dprimme(double *V, double *W, PRIMME_INT ldV, PRIMME_INT nLocal,
+      int basisSize, double *h, int ldh, double *hVals, int n, double *X,
+      PRIMME_INT ldX, double *R, PRIMME_INT ldR, double *rnorms, double *rwork,
+      size_t *rworkSize, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(matrixMatvec_project_Sprimme)
+#  define matrixMatvec_project_Sprimme CONCAT(matrixMatvec_project_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(matrixMatvec_project_Rprimme)
+#  define matrixMatvec_project_Rprimme CONCAT(matrixMatvec_project_,REAL_SUF)
+#endif
+int matrixMatvec_project_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      double *W, PRIMME_INT ldW, double *H, int ldH, int basisSize,
+      int blockSize, double *rwork, size_t *rworkSize, globalsum_queue *queue,
+      primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(ortho_matrixMatvec_project_Sprimme)
+#  define ortho_matrixMatvec_project_Sprimme CONCAT(ortho_matrixMatvec_project_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(ortho_matrixMatvec_project_Rprimme)
+#  define ortho_matrixMatvec_project_Rprimme CONCAT(ortho_matrixMatvec_project_,REAL_SUF)
+#endif
+int ortho_matrixMatvec_project_dprimme(double *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, double *W, PRIMME_INT ldW, double *BV, PRIMME_INT ldBV,
+      double *H, int ldH, int basisSize, int blockSize, double *locked,
+      PRIMME_INT ldLocked, int numLocked, double machEps, double *rwork,
+      size_t *rworkSize, globalsum_queue *queue, primme_params *primme);
 #if !defined(CHECK_TEMPLATE) && !defined(update_Q_Sprimme)
 #  define update_Q_Sprimme CONCAT(update_Q_,SCALAR_SUF)
 #endif
@@ -52,25 +92,143 @@ int update_Q_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       double *W, PRIMME_INT ldW, double *Q, PRIMME_INT ldQ, double *R, int ldR,
       double targetShift, int basisSize, int blockSize, double *rwork,
       size_t *rworkSize, double machEps, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(matrixMatvec_sstep_Sprimme)
+#  define matrixMatvec_sstep_Sprimme CONCAT(matrixMatvec_sstep_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(matrixMatvec_sstep_Rprimme)
+#  define matrixMatvec_sstep_Rprimme CONCAT(matrixMatvec_sstep_,REAL_SUF)
+#endif
+int matrixMatvec_sstep_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      double *W, PRIMME_INT ldW, int basisSize, int blockSize, int numSteps,
+      double *hVals, int *iev, double *locked, PRIMME_INT ldLocked,
+      int numLocked, double *lockedEvals, int *numNew, double machEps,
+      double *rwork, size_t *rworkSize, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(matrixPowers_Sprimme)
+#  define matrixPowers_Sprimme CONCAT(matrixPowers_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(matrixPowers_Rprimme)
+#  define matrixPowers_Rprimme CONCAT(matrixPowers_,REAL_SUF)
+#endif
+int matrixPowers_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      double *W, PRIMME_INT ldW, int blockSize, int degree, double *alpha,
+      double *beta, double *gamma, double *rwork, size_t *rworkSize,
+      primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(chebyshev_filter_Sprimme)
+#  define chebyshev_filter_Sprimme CONCAT(chebyshev_filter_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(chebyshev_filter_Rprimme)
+#  define chebyshev_filter_Rprimme CONCAT(chebyshev_filter_,REAL_SUF)
+#endif
+int chebyshev_filter_dprimme(double *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      double *W, PRIMME_INT ldW, int basisSize, int blockSize, double *hVals,
+      int *iev, int numWanted, int *degree, double *rwork, size_t *rworkSize,
+      primme_params *primme);
 int matrixMatvec_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, int basisSize, int blockSize,
       primme_params *primme);
+int massMatrixMatvec_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_DOUBLE *BV, PRIMME_INT ldBV, int basisSize, int blockSize,
+      primme_params *primme);
+int residual_B_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldV, PRIMME_INT nLocal,
+      int basisSize, PRIMME_COMPLEX_DOUBLE *h, int ldh, double *hVals, int n, PRIMME_COMPLEX_DOUBLE *X,
+      PRIMME_INT ldX, PRIMME_COMPLEX_DOUBLE *R, PRIMME_INT ldR, double *rnorms, PRIMME_COMPLEX_DOUBLE *rwork,
+      size_t *rworkSize, primme_params *primme);
+int matrixMatvec_project_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *H, int ldH, int basisSize,
+      int blockSize, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, globalsum_queue *queue,
+      primme_params *primme);
+int ortho_matrixMatvec_project_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *BV, PRIMME_INT ldBV,
+      PRIMME_COMPLEX_DOUBLE *H, int ldH, int basisSize, int blockSize, PRIMME_COMPLEX_DOUBLE *locked,
+      PRIMME_INT ldLocked, int numLocked, double machEps, PRIMME_COMPLEX_DOUBLE *rwork,
+      size_t *rworkSize, globalsum_queue *queue, primme_params *primme);
 int update_Q_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, PRIMME_COMPLEX_DOUBLE *Q, PRIMME_INT ldQ, PRIMME_COMPLEX_DOUBLE *R, int ldR,
       double targetShift, int basisSize, int blockSize, PRIMME_COMPLEX_DOUBLE *rwork,
       size_t *rworkSize, double machEps, primme_params *primme);
+int matrixMatvec_sstep_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, int basisSize, int blockSize, int numSteps,
+      double *hVals, int *iev, PRIMME_COMPLEX_DOUBLE *locked, PRIMME_INT ldLocked,
+      int numLocked, double *lockedEvals, int *numNew, double machEps,
+      PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize, primme_params *primme);
+int matrixPowers_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, int blockSize, int degree, double *alpha,
+      double *beta, double *gamma, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
+      primme_params *primme);
+int chebyshev_filter_zprimme(PRIMME_COMPLEX_DOUBLE *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_DOUBLE *W, PRIMME_INT ldW, int basisSize, int blockSize, double *hVals,
+      int *iev, int numWanted, int *degree, PRIMME_COMPLEX_DOUBLE *rwork, size_t *rworkSize,
+      primme_params *primme);
 int matrixMatvec_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       float *W, PRIMME_INT ldW, int basisSize, int blockSize,
       primme_params *primme);
+int massMatrixMatvec_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      float *BV, PRIMME_INT ldBV, int basisSize, int blockSize,
+      primme_params *primme);
+int residual_B_sprimme(float *V, float *W, PRIMME_INT ldV, PRIMME_INT nLocal,
+      int basisSize, float *h, int ldh, float *hVals, int n, float *X,
+      PRIMME_INT ldX, float *R, PRIMME_INT ldR, float *rnorms, float *rwork,
+      size_t *rworkSize, primme_params *primme);
+int matrixMatvec_project_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      float *W, PRIMME_INT ldW, float *H, int ldH, int basisSize,
+      int blockSize, float *rwork, size_t *rworkSize, globalsum_queue *queue,
+      primme_params *primme);
+int ortho_matrixMatvec_project_sprimme(float *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, float *W, PRIMME_INT ldW, float *BV, PRIMME_INT ldBV,
+      float *H, int ldH, int basisSize, int blockSize, float *locked,
+      PRIMME_INT ldLocked, int numLocked, double machEps, float *rwork,
+      size_t *rworkSize, globalsum_queue *queue, primme_params *primme);
 int update_Q_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       float *W, PRIMME_INT ldW, float *Q, PRIMME_INT ldQ, float *R, int ldR,
       double targetShift, int basisSize, int blockSize, float *rwork,
       size_t *rworkSize, double machEps, primme_params *primme);
+int matrixMatvec_sstep_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      float *W, PRIMME_INT ldW, int basisSize, int blockSize, int numSteps,
+      float *hVals, int *iev, float *locked, PRIMME_INT ldLocked,
+      int numLocked, float *lockedEvals, int *numNew, double machEps,
+      float *rwork, size_t *rworkSize, primme_params *primme);
+int matrixPowers_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      float *W, PRIMME_INT ldW, int blockSize, int degree, double *alpha,
+      double *beta, double *gamma, float *rwork, size_t *rworkSize,
+      primme_params *primme);
+int chebyshev_filter_sprimme(float *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      float *W, PRIMME_INT ldW, int basisSize, int blockSize, float *hVals,
+      int *iev, int numWanted, int *degree, float *rwork, size_t *rworkSize,
+      primme_params *primme);
 int matrixMatvec_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, int basisSize, int blockSize,
       primme_params *primme);
+int massMatrixMatvec_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_FLOAT *BV, PRIMME_INT ldBV, int basisSize, int blockSize,
+      primme_params *primme);
+int residual_B_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldV, PRIMME_INT nLocal,
+      int basisSize, PRIMME_COMPLEX_FLOAT *h, int ldh, float *hVals, int n, PRIMME_COMPLEX_FLOAT *X,
+      PRIMME_INT ldX, PRIMME_COMPLEX_FLOAT *R, PRIMME_INT ldR, float *rnorms, PRIMME_COMPLEX_FLOAT *rwork,
+      size_t *rworkSize, primme_params *primme);
+int matrixMatvec_project_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *H, int ldH, int basisSize,
+      int blockSize, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, globalsum_queue *queue,
+      primme_params *primme);
+int ortho_matrixMatvec_project_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal,
+      PRIMME_INT ldV, PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *BV, PRIMME_INT ldBV,
+      PRIMME_COMPLEX_FLOAT *H, int ldH, int basisSize, int blockSize, PRIMME_COMPLEX_FLOAT *locked,
+      PRIMME_INT ldLocked, int numLocked, double machEps, PRIMME_COMPLEX_FLOAT *rwork,
+      size_t *rworkSize, globalsum_queue *queue, primme_params *primme);
 int update_Q_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
       PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, PRIMME_COMPLEX_FLOAT *Q, PRIMME_INT ldQ, PRIMME_COMPLEX_FLOAT *R, int ldR,
       double targetShift, int basisSize, int blockSize, PRIMME_COMPLEX_FLOAT *rwork,
       size_t *rworkSize, double machEps, primme_params *primme);
+int matrixMatvec_sstep_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, int basisSize, int blockSize, int numSteps,
+      float *hVals, int *iev, PRIMME_COMPLEX_FLOAT *locked, PRIMME_INT ldLocked,
+      int numLocked, float *lockedEvals, int *numNew, double machEps,
+      PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize, primme_params *primme);
+int matrixPowers_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, int blockSize, int degree, double *alpha,
+      double *beta, double *gamma, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
+      primme_params *primme);
+int chebyshev_filter_cprimme(PRIMME_COMPLEX_FLOAT *V, PRIMME_INT nLocal, PRIMME_INT ldV,
+      PRIMME_COMPLEX_FLOAT *W, PRIMME_INT ldW, int basisSize, int blockSize, float *hVals,
+      int *iev, int numWanted, int *degree, PRIMME_COMPLEX_FLOAT *rwork, size_t *rworkSize,
+      primme_params *primme);
 #endif
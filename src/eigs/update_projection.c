@@ -38,6 +38,7 @@
 #include "const.h"
 #include "numerical.h"
 #include "update_projection.h"
+#include "auxiliary_eigs.h"
 #include "globalsum.h"
 
 /*******************************************************************************
@@ -58,6 +59,12 @@
  * rwork       Workspace
  * lrwork      Size of rwork
  * isSymmetric Nonzero if Z is symmetric/Hermitian
+ * queue       If not NULL, the reduction of Z is queued there instead, see
+ *             globalSum_queue
+ *
+ * If primme.basisPanelRows is positive, X and Y are read in panels of that
+ * many rows, and the next panel is requested with page_basis before the
+ * current one is used.
  * 
  * INPUT/OUTPUT ARRAYS
  * -------------------
@@ -71,9 +78,10 @@ TEMPLATE_PLEASE
 int update_projection_Sprimme(SCALAR *X, PRIMME_INT ldX, SCALAR *Y,
       PRIMME_INT ldY, SCALAR *Z, PRIMME_INT ldZ, PRIMME_INT nLocal, int numCols,
       int blockSize, SCALAR *rwork, size_t *lrwork, int isSymmetric,
-      primme_params *primme) {
+      globalsum_queue *queue, primme_params *primme) {
 
-   int count, m;
+   int m;
+   PRIMME_INT p0, np = primme->basisPanelRows;
 
    /* -------------------------- */
    /* Return memory requirements */
@@ -99,6 +107,42 @@ int update_projection_Sprimme(SCALAR *X, PRIMME_INT ldX, SCALAR *Y,
    /* --------------------------------------------------------------------- */
 
    m = numCols+blockSize;
+   if (np > 0 && np < nLocal) {
+      /* Y(:,numCols:m-1) is used, and also Y(:,0:numCols-1) if Z is not */
+      /* symmetric                                                       */
+      int y0 = isSymmetric ? numCols : 0;
+
+      CHKERR(page_basis_Sprimme(X, ldX, 0, np, m, 1, primme), -1);
+      CHKERR(page_basis_Sprimme(&Y[ldY*y0], ldY, 0, np, m-y0, 1, primme),
+            -1);
+      for (p0=0; p0 < nLocal; p0+=np) {
+         int mp = (int)min(np, nLocal-p0);
+
+         /* Prefetch the next panel while the current one is used */
+
+         CHKERR(page_basis_Sprimme(X, ldX, p0+np, np, m, 1, primme), -1);
+         CHKERR(page_basis_Sprimme(&Y[ldY*y0], ldY, p0+np, np, m-y0, 1,
+                  primme), -1);
+
+         Num_gemm_Sprimme("C", "N", m, blockSize, mp, 1.0, &X[p0], ldX,
+               &Y[ldY*numCols+p0], ldY, p0 == 0 ? 0.0 : 1.0,
+               &Z[ldZ*numCols], ldZ);
+         if (!isSymmetric) {
+            Num_gemm_Sprimme("C", "N", blockSize, numCols, mp, 1.0,
+                  &X[ldX*numCols+p0], ldX, &Y[p0], ldY, p0 == 0 ? 0.0 : 1.0,
+                  &Z[numCols], ldZ);
+         }
+
+         CHKERR(page_basis_Sprimme(X, ldX, p0, mp, m, 0, primme), -1);
+         CHKERR(page_basis_Sprimme(&Y[ldY*y0], ldY, p0, mp, m-y0, 0,
+                  primme), -1);
+      }
+
+      CHKERR(update_projection_reduce_Sprimme(Z, ldZ, numCols, blockSize,
+               rwork, lrwork, isSymmetric, queue, primme), -1);
+      return 0;
+   }
+
    Num_gemm_Sprimme("C", "N", m, blockSize, nLocal, 1.0, 
       X, ldX, &Y[ldY*numCols], ldY, 0.0, &Z[ldZ*numCols], ldZ);
 
@@ -121,38 +165,73 @@ int update_projection_Sprimme(SCALAR *X, PRIMME_INT ldX, SCALAR *Y,
             &X[ldX*numCols], ldX, Y, ldY, 0.0, &Z[numCols], ldZ);
    }
 
-   if (primme->numProcs > 1 && isSymmetric) {
+   CHKERR(update_projection_reduce_Sprimme(Z, ldZ, numCols, blockSize, rwork,
+            lrwork, isSymmetric, queue, primme), -1);
+
+   return 0;
+}
+
+/*******************************************************************************
+ * Subroutine update_projection_reduce - Sum up among the processes the new
+ *    columns and rows of Z computed locally, Z(:,numCols:numCols+blockSize-1)
+ *    and Z(numCols:numCols+blockSize-1,:) if Z is not symmetric.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * numCols     The number of columns that haven't changed
+ * blockSize   The number of columns that have changed
+ * rwork       Workspace
+ * lrwork      Size of rwork
+ * isSymmetric Nonzero if Z is symmetric/Hermitian
+ * queue       If not NULL, the reduction is queued there instead of done here
+ * 
+ * INPUT/OUTPUT ARRAYS
+ * -------------------
+ * Z           Matrix with size numCols+blockSize; if it's symmetric only
+ *             the upper triangular part of Z(:,numCols:numCols+blockSize) is
+ *             reduced
+ * ldZ         The leading dimension of Z
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+int update_projection_reduce_Sprimme(SCALAR *Z, PRIMME_INT ldZ, int numCols,
+      int blockSize, SCALAR *rwork, size_t *lrwork, int isSymmetric,
+      globalsum_queue *queue, primme_params *primme) {
+
+   int m = numCols+blockSize;
+   globalsum_queue localQueue, *q = queue;
+
+   if (blockSize <= 0 || primme->numProcs <= 1) return 0;
+
+   /* If no queue is given, reduce Z before returning */
+
+   if (!queue) {
+      GLOBALSUM_QUEUE_INIT(localQueue);
+      q = &localQueue;
+   }
+
+   if (isSymmetric) {
       /* --------------------------------------------------------------------- */
       /* Reduce the upper triangular part of the new columns in Z.             */
       /* --------------------------------------------------------------------- */
 
-      Num_copy_trimatrix_compact_Sprimme(&Z[ldZ*numCols], m, blockSize, ldZ,
-            numCols, rwork, &count);
-      assert((size_t)count*2 <= *lrwork);
-
-      CHKERR(globalSum_Sprimme(rwork, &rwork[count], count, primme), -1);
-
-      Num_copy_compact_trimatrix_Sprimme(&rwork[count], m, blockSize, numCols,
-            &Z[ldZ*numCols], ldZ);
+      CHKERR(globalSum_queue_Sprimme(&Z[ldZ*numCols], m, blockSize, ldZ,
+               numCols, 1, q, rwork, *lrwork, primme), -1);
    }
-   else if (primme->numProcs > 1 && !isSymmetric) {
+   else {
       /* --------------------------------------------------------------------- */
       /* Reduce Z(:,numCols:end) and Z(numCols:end,:).                         */
       /* --------------------------------------------------------------------- */
 
-      Num_copy_matrix_Sprimme(&Z[ldZ*numCols], m, blockSize, ldZ,
-            rwork, m);
-      Num_copy_matrix_Sprimme(&Z[numCols], blockSize, numCols, ldZ,
-            &rwork[m*blockSize], blockSize);
-      count = m*blockSize+blockSize*numCols;
-      assert((size_t)count*2 <= *lrwork);
-
-      CHKERR(globalSum_Sprimme(rwork, &rwork[count], count, primme), -1);
+      CHKERR(globalSum_queue_Sprimme(&Z[ldZ*numCols], m, blockSize, ldZ, -1,
+               1, q, rwork, *lrwork, primme), -1);
+      CHKERR(globalSum_queue_Sprimme(&Z[numCols], blockSize, numCols, ldZ, -1,
+               0, q, rwork, *lrwork, primme), -1);
+   }
 
-      Num_copy_matrix_Sprimme(&rwork[count], m, blockSize, m, &Z[ldZ*numCols],
-            ldZ);
-      Num_copy_matrix_Sprimme(&rwork[count+m*blockSize], blockSize, numCols,
-            blockSize, &Z[numCols], ldZ);
+   if (!queue) {
+      CHKERR(globalSum_flush_Sprimme(q, rwork, *lrwork, primme), -1);
    }
 
    return 0;
@@ -42,17 +42,35 @@
 int update_projection_dprimme(double *X, PRIMME_INT ldX, double *Y,
       PRIMME_INT ldY, double *Z, PRIMME_INT ldZ, PRIMME_INT nLocal, int numCols,
       int blockSize, double *rwork, size_t *lrwork, int isSymmetric,
-      primme_params *primme);
+      globalsum_queue *queue, primme_params *primme);
+#if !defined(CHECK_TEMPLATE) && !defined(update_projection_reduce_Sprimme)
+#  define update_projection_reduce_Sprimme CONCAT(update_projection_reduce_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(update_projection_reduce_Rprimme)
+#  define update_projection_reduce_Rprimme CONCAT(update_projection_reduce_,REAL_SUF)
+#endif
+int update_projection_reduce_dprimme(double *Z, PRIMME_INT ldZ, int numCols,
+      int blockSize, double *rwork, size_t *lrwork, int isSymmetric,
+      globalsum_queue *queue, primme_params *primme);
 int update_projection_zprimme(PRIMME_COMPLEX_DOUBLE *X, PRIMME_INT ldX, PRIMME_COMPLEX_DOUBLE *Y,
       PRIMME_INT ldY, PRIMME_COMPLEX_DOUBLE *Z, PRIMME_INT ldZ, PRIMME_INT nLocal, int numCols,
       int blockSize, PRIMME_COMPLEX_DOUBLE *rwork, size_t *lrwork, int isSymmetric,
-      primme_params *primme);
+      globalsum_queue *queue, primme_params *primme);
+int update_projection_reduce_zprimme(PRIMME_COMPLEX_DOUBLE *Z, PRIMME_INT ldZ, int numCols,
+      int blockSize, PRIMME_COMPLEX_DOUBLE *rwork, size_t *lrwork, int isSymmetric,
+      globalsum_queue *queue, primme_params *primme);
 int update_projection_sprimme(float *X, PRIMME_INT ldX, float *Y,
       PRIMME_INT ldY, float *Z, PRIMME_INT ldZ, PRIMME_INT nLocal, int numCols,
       int blockSize, float *rwork, size_t *lrwork, int isSymmetric,
-      primme_params *primme);
+      globalsum_queue *queue, primme_params *primme);
+int update_projection_reduce_sprimme(float *Z, PRIMME_INT ldZ, int numCols,
+      int blockSize, float *rwork, size_t *lrwork, int isSymmetric,
+      globalsum_queue *queue, primme_params *primme);
 int update_projection_cprimme(PRIMME_COMPLEX_FLOAT *X, PRIMME_INT ldX, PRIMME_COMPLEX_FLOAT *Y,
       PRIMME_INT ldY, PRIMME_COMPLEX_FLOAT *Z, PRIMME_INT ldZ, PRIMME_INT nLocal, int numCols,
       int blockSize, PRIMME_COMPLEX_FLOAT *rwork, size_t *lrwork, int isSymmetric,
-      primme_params *primme);
+      globalsum_queue *queue, primme_params *primme);
+int update_projection_reduce_cprimme(PRIMME_COMPLEX_FLOAT *Z, PRIMME_INT ldZ, int numCols,
+      int blockSize, PRIMME_COMPLEX_FLOAT *rwork, size_t *lrwork, int isSymmetric,
+      globalsum_queue *queue, primme_params *primme);
 #endif
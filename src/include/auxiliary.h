@@ -49,6 +49,14 @@ void Num_copy_matrix_dprimme(double *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
 #endif
 void Num_copy_matrix_columns_dprimme(double *x, PRIMME_INT m, int *xin, int n,
       PRIMME_INT ldx, double *y, int *yin, PRIMME_INT ldy);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_transpose_matrix_Sprimme)
+#  define Num_transpose_matrix_Sprimme CONCAT(Num_transpose_matrix_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_transpose_matrix_Rprimme)
+#  define Num_transpose_matrix_Rprimme CONCAT(Num_transpose_matrix_,REAL_SUF)
+#endif
+void Num_transpose_matrix_dprimme(double *x, PRIMME_INT m, PRIMME_INT n,
+      PRIMME_INT ldx, double *y, PRIMME_INT ldy);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_zero_matrix_Sprimme)
 #  define Num_zero_matrix_Sprimme CONCAT(Num_zero_matrix_,SCALAR_SUF)
 #endif
@@ -88,7 +96,7 @@ void Num_copy_compact_trimatrix_dprimme(double *x, PRIMME_INT m, int n, int i0,
 #  define permute_vecs_Rprimme CONCAT(permute_vecs_,REAL_SUF)
 #endif
 void permute_vecs_dprimme(double *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
-      int *perm_, double *rwork, int *iwork);
+      int *perm, double *rwork, int *iwork);
 #if !defined(CHECK_TEMPLATE) && !defined(permute_vecs_iprimmeSprimme)
 #  define permute_vecs_iprimmeSprimme CONCAT(permute_vecs_iprimme,SCALAR_SUF)
 #endif
@@ -96,6 +104,13 @@ void permute_vecs_dprimme(double *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
 #  define permute_vecs_iprimmeRprimme CONCAT(permute_vecs_iprimme,REAL_SUF)
 #endif
 void permute_vecs_iprimme(int *vecs, int n, int *perm_, int *iwork);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_malloc_workspace_primmeSprimme)
+#  define Num_malloc_workspace_primmeSprimme CONCAT(Num_malloc_workspace_primme,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_malloc_workspace_primmeRprimme)
+#  define Num_malloc_workspace_primmeRprimme CONCAT(Num_malloc_workspace_primme,REAL_SUF)
+#endif
+int Num_malloc_workspace_primme(size_t size, void **x);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_compact_vecs_Sprimme)
 #  define Num_compact_vecs_Sprimme CONCAT(Num_compact_vecs_,SCALAR_SUF)
 #endif
@@ -118,6 +133,8 @@ void Num_copy_matrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m, PRIMME_INT
       ldx, PRIMME_COMPLEX_DOUBLE *y, PRIMME_INT ldy);
 void Num_copy_matrix_columns_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m, int *xin, int n,
       PRIMME_INT ldx, PRIMME_COMPLEX_DOUBLE *y, int *yin, PRIMME_INT ldy);
+void Num_transpose_matrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m, PRIMME_INT n,
+      PRIMME_INT ldx, PRIMME_COMPLEX_DOUBLE *y, PRIMME_INT ldy);
 void Num_zero_matrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m, PRIMME_INT n,
       PRIMME_INT ldx);
 void Num_copy_trimatrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, int m, int n, int ldx, int ul,
@@ -127,7 +144,7 @@ void Num_copy_trimatrix_compact_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m,
 void Num_copy_compact_trimatrix_zprimme(PRIMME_COMPLEX_DOUBLE *x, PRIMME_INT m, int n, int i0,
       PRIMME_COMPLEX_DOUBLE *y, int ldy);
 void permute_vecs_zprimme(PRIMME_COMPLEX_DOUBLE *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
-      int *perm_, PRIMME_COMPLEX_DOUBLE *rwork, int *iwork);
+      int *perm, PRIMME_COMPLEX_DOUBLE *rwork, int *iwork);
 PRIMME_COMPLEX_DOUBLE* Num_compact_vecs_zprimme(PRIMME_COMPLEX_DOUBLE *vecs, PRIMME_INT m, int n,
       PRIMME_INT ld, int *perm, PRIMME_COMPLEX_DOUBLE *work, PRIMME_INT ldwork,
       int avoidCopy);
@@ -138,6 +155,8 @@ void Num_copy_matrix_sprimme(float *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
       ldx, float *y, PRIMME_INT ldy);
 void Num_copy_matrix_columns_sprimme(float *x, PRIMME_INT m, int *xin, int n,
       PRIMME_INT ldx, float *y, int *yin, PRIMME_INT ldy);
+void Num_transpose_matrix_sprimme(float *x, PRIMME_INT m, PRIMME_INT n,
+      PRIMME_INT ldx, float *y, PRIMME_INT ldy);
 void Num_zero_matrix_sprimme(float *x, PRIMME_INT m, PRIMME_INT n,
       PRIMME_INT ldx);
 void Num_copy_trimatrix_sprimme(float *x, int m, int n, int ldx, int ul,
@@ -147,7 +166,7 @@ void Num_copy_trimatrix_compact_sprimme(float *x, PRIMME_INT m, int n,
 void Num_copy_compact_trimatrix_sprimme(float *x, PRIMME_INT m, int n, int i0,
       float *y, int ldy);
 void permute_vecs_sprimme(float *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
-      int *perm_, float *rwork, int *iwork);
+      int *perm, float *rwork, int *iwork);
 float* Num_compact_vecs_sprimme(float *vecs, PRIMME_INT m, int n,
       PRIMME_INT ld, int *perm, float *work, PRIMME_INT ldwork,
       int avoidCopy);
@@ -158,6 +177,8 @@ void Num_copy_matrix_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, PRIMME_INT n
       ldx, PRIMME_COMPLEX_FLOAT *y, PRIMME_INT ldy);
 void Num_copy_matrix_columns_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, int *xin, int n,
       PRIMME_INT ldx, PRIMME_COMPLEX_FLOAT *y, int *yin, PRIMME_INT ldy);
+void Num_transpose_matrix_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, PRIMME_INT n,
+      PRIMME_INT ldx, PRIMME_COMPLEX_FLOAT *y, PRIMME_INT ldy);
 void Num_zero_matrix_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, PRIMME_INT n,
       PRIMME_INT ldx);
 void Num_copy_trimatrix_cprimme(PRIMME_COMPLEX_FLOAT *x, int m, int n, int ldx, int ul,
@@ -167,7 +188,7 @@ void Num_copy_trimatrix_compact_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, i
 void Num_copy_compact_trimatrix_cprimme(PRIMME_COMPLEX_FLOAT *x, PRIMME_INT m, int n, int i0,
       PRIMME_COMPLEX_FLOAT *y, int ldy);
 void permute_vecs_cprimme(PRIMME_COMPLEX_FLOAT *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
-      int *perm_, PRIMME_COMPLEX_FLOAT *rwork, int *iwork);
+      int *perm, PRIMME_COMPLEX_FLOAT *rwork, int *iwork);
 PRIMME_COMPLEX_FLOAT* Num_compact_vecs_cprimme(PRIMME_COMPLEX_FLOAT *vecs, PRIMME_INT m, int n,
       PRIMME_INT ld, int *perm, PRIMME_COMPLEX_FLOAT *work, PRIMME_INT ldwork,
       int avoidCopy);
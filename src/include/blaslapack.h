@@ -130,6 +130,14 @@ void Num_swap_dprimme(PRIMME_INT n, double *x, int incx, double *y, int incy);
 #endif
 void Num_heev_dprimme(const char *jobz, const char *uplo, int n, double *a,
       int lda, double *w, double *work, int ldwork, int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_heevd_Sprimme)
+#  define Num_heevd_Sprimme CONCAT(Num_heevd_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_heevd_Rprimme)
+#  define Num_heevd_Rprimme CONCAT(Num_heevd_,REAL_SUF)
+#endif
+void Num_heevd_dprimme(const char *jobz, const char *uplo, int n, double *a,
+      int lda, double *w, double *work, int ldwork, int *info);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_hegv_Sprimme)
 #  define Num_hegv_Sprimme CONCAT(Num_hegv_,SCALAR_SUF)
 #endif
@@ -164,6 +172,14 @@ void Num_hetrf_dprimme(const char *uplo, int n, double *a, int lda, int *ipivot,
 #endif
 void Num_hetrs_dprimme(const char *uplo, int n, int nrhs, double *a,
       int lda, int *ipivot, double *b, int ldb, int *info);
+#if !defined(CHECK_TEMPLATE) && !defined(Num_potrf_Sprimme)
+#  define Num_potrf_Sprimme CONCAT(Num_potrf_,SCALAR_SUF)
+#endif
+#if !defined(CHECK_TEMPLATE) && !defined(Num_potrf_Rprimme)
+#  define Num_potrf_Rprimme CONCAT(Num_potrf_,REAL_SUF)
+#endif
+void Num_potrf_dprimme(const char *uplo, int n, double *a, int lda,
+      int *info);
 #if !defined(CHECK_TEMPLATE) && !defined(Num_trsm_Sprimme)
 #  define Num_trsm_Sprimme CONCAT(Num_trsm_,SCALAR_SUF)
 #endif
@@ -198,6 +214,8 @@ void Num_scal_zprimme(PRIMME_INT n, PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_
 void Num_swap_zprimme(PRIMME_INT n, PRIMME_COMPLEX_DOUBLE *x, int incx, PRIMME_COMPLEX_DOUBLE *y, int incy);
 void Num_heev_zprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a,
       int lda, double *w, PRIMME_COMPLEX_DOUBLE *work, int ldwork, int *info);
+void Num_heevd_zprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a,
+      int lda, double *w, PRIMME_COMPLEX_DOUBLE *work, int ldwork, int *info);
 void Num_hegv_zprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a,
       int lda, PRIMME_COMPLEX_DOUBLE *b0, int ldb0, double *w, PRIMME_COMPLEX_DOUBLE *work, int ldwork,
       int *info);
@@ -208,6 +226,8 @@ void Num_hetrf_zprimme(const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a, int ld
    PRIMME_COMPLEX_DOUBLE *work, int ldwork, int *info);
 void Num_hetrs_zprimme(const char *uplo, int n, int nrhs, PRIMME_COMPLEX_DOUBLE *a,
       int lda, int *ipivot, PRIMME_COMPLEX_DOUBLE *b, int ldb, int *info);
+void Num_potrf_zprimme(const char *uplo, int n, PRIMME_COMPLEX_DOUBLE *a, int lda,
+      int *info);
 void Num_trsm_zprimme(const char *side, const char *uplo, const char *transa,
       const char *diag, int m, int n, PRIMME_COMPLEX_DOUBLE alpha, PRIMME_COMPLEX_DOUBLE *a, int lda,
       PRIMME_COMPLEX_DOUBLE *b, int ldb);
@@ -236,6 +256,8 @@ void Num_scal_sprimme(PRIMME_INT n, float alpha, float *x, int incx);
 void Num_swap_sprimme(PRIMME_INT n, float *x, int incx, float *y, int incy);
 void Num_heev_sprimme(const char *jobz, const char *uplo, int n, float *a,
       int lda, float *w, float *work, int ldwork, int *info);
+void Num_heevd_sprimme(const char *jobz, const char *uplo, int n, float *a,
+      int lda, float *w, float *work, int ldwork, int *info);
 void Num_hegv_sprimme(const char *jobz, const char *uplo, int n, float *a,
       int lda, float *b0, int ldb0, float *w, float *work, int ldwork,
       int *info);
@@ -246,6 +268,8 @@ void Num_hetrf_sprimme(const char *uplo, int n, float *a, int lda, int *ipivot,
    float *work, int ldwork, int *info);
 void Num_hetrs_sprimme(const char *uplo, int n, int nrhs, float *a,
       int lda, int *ipivot, float *b, int ldb, int *info);
+void Num_potrf_sprimme(const char *uplo, int n, float *a, int lda,
+      int *info);
 void Num_trsm_sprimme(const char *side, const char *uplo, const char *transa,
       const char *diag, int m, int n, float alpha, float *a, int lda,
       float *b, int ldb);
@@ -274,6 +298,8 @@ void Num_scal_cprimme(PRIMME_INT n, PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_F
 void Num_swap_cprimme(PRIMME_INT n, PRIMME_COMPLEX_FLOAT *x, int incx, PRIMME_COMPLEX_FLOAT *y, int incy);
 void Num_heev_cprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a,
       int lda, float *w, PRIMME_COMPLEX_FLOAT *work, int ldwork, int *info);
+void Num_heevd_cprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a,
+      int lda, float *w, PRIMME_COMPLEX_FLOAT *work, int ldwork, int *info);
 void Num_hegv_cprimme(const char *jobz, const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a,
       int lda, PRIMME_COMPLEX_FLOAT *b0, int ldb0, float *w, PRIMME_COMPLEX_FLOAT *work, int ldwork,
       int *info);
@@ -284,6 +310,8 @@ void Num_hetrf_cprimme(const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a, int lda
    PRIMME_COMPLEX_FLOAT *work, int ldwork, int *info);
 void Num_hetrs_cprimme(const char *uplo, int n, int nrhs, PRIMME_COMPLEX_FLOAT *a,
       int lda, int *ipivot, PRIMME_COMPLEX_FLOAT *b, int ldb, int *info);
+void Num_potrf_cprimme(const char *uplo, int n, PRIMME_COMPLEX_FLOAT *a, int lda,
+      int *info);
 void Num_trsm_cprimme(const char *side, const char *uplo, const char *transa,
       const char *diag, int m, int n, PRIMME_COMPLEX_FLOAT alpha, PRIMME_COMPLEX_FLOAT *a, int lda,
       PRIMME_COMPLEX_FLOAT *b, int ldb);
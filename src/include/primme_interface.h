@@ -39,5 +39,8 @@
 void primme_set_defaults(primme_params *params);
 void primme_display_params_prefix(const char* prefix, primme_params primme);
 #define Sprimme CONCAT(SCALAR_PRE,primme)
+#define Sprimme_batch CONCAT(SCALAR_PRE,primme_batch)
+#define Sprimme_plan CONCAT(SCALAR_PRE,primme_plan)
+#define Sprimme_dos CONCAT(SCALAR_PRE,primme_dos)
 
 #endif
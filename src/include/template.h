@@ -107,6 +107,32 @@
 #  error "An arithmetic should be selected, please define one of USE_DOUBLE, USE_DOUBLECOMPLEX, USE_FLOAT or USE_FLOATCOMPLEX."
 #endif
 
+/**********************************************************************
+ * Macros LSCALAR, LREAL and LSCALAR_SUF - type of the correction equations
+ *    while they are being solved in single precision (see
+ *    primme.innerSinglePrecision), and of the single precision stage of the
+ *    solver (see primme.precisionCascade); the type of their norms, and the
+ *    suffix of the functions for that type.
+ *
+ * Macro USE_LOWER_INNER - only defined when LSCALAR is not SCALAR.
+ **********************************************************************/
+
+#if defined(USE_DOUBLE)
+#  define USE_LOWER_INNER
+#  define LSCALAR float
+#  define LREAL float
+#  define LSCALAR_SUF sprimme
+#elif defined(USE_DOUBLECOMPLEX)
+#  define USE_LOWER_INNER
+#  define LSCALAR PRIMME_COMPLEX_FLOAT
+#  define LREAL float
+#  define LSCALAR_SUF cprimme
+#else
+#  define LSCALAR SCALAR
+#  define LREAL REAL
+#  define LSCALAR_SUF SCALAR_SUF
+#endif
+
 /* A C99 code with complex type is not a valid C++ code. However C++          */
 /* compilers usually can take it. Nevertheless in order to avoid the warnings */
 /* while compiling in pedantic mode, we use the proper complex type for C99   */
@@ -393,6 +419,16 @@
 
 #define MALLOC_PRIMME(NELEM, X) (*((void**)X) = malloc((NELEM)*sizeof(**(X))), *(X) == NULL)
 
+/* Alignment in bytes of the workspaces allocated by PRIMME (see           */
+/* Num_malloc_workspace_primme); 64 covers a cache line and AVX-512 loads  */
+
+#define PRIMME_WORKSPACE_ALIGN 64
+
+/* Workspaces of at least this many bytes are aligned to this size and     */
+/* advised to use transparent huge pages                                   */
+
+#define PRIMME_HUGEPAGE_SIZE (2*1024*1024)
+
 
 /**********************************************************************
  * Macro WRKSP_MALLOC_PRIMME - borrow NELEM of type **X from workspace *rwork;
@@ -437,6 +473,49 @@
 #define ALIGN(ptr, T) (T*) ALIGN_BY_SIZE(ptr, sizeof(T))
 
 
+/*****************************************************************************/
+/* Threading                                                                 */
+/*****************************************************************************/
+
+/**********************************************************************
+ * Macro OMP_PRAGMA - emit an OpenMP pragma if PRIMME is compiled with
+ *    OpenMP support (e.g., CFLAGS += -fopenmp); otherwise do nothing.
+ *
+ * Macro OMP_MAX_THREADS - maximum number of threads that the next
+ *    parallel region may use; 1 without OpenMP.
+ *
+ * Macro OMP_THREAD_NUM - index of the calling thread in the current
+ *    parallel region; 0 without OpenMP.
+ *
+ * Macro OMP_MIN_WORK - minimum number of elements that a loop should
+ *    touch to be worth running in parallel.
+ *
+ * EXAMPLE
+ * -------
+ *   OMP_PRAGMA(omp parallel for if(n >= OMP_MIN_WORK))
+ *   for (i=0; i<n; i++) x[i] = 0.0;
+ *
+ **********************************************************************/
+
+#ifdef _OPENMP
+#  include <omp.h>
+#  define OMP_PRAGMA(...) _Pragma(#__VA_ARGS__)
+#  define OMP_MAX_THREADS() omp_get_max_threads()
+#  define OMP_THREAD_NUM() omp_get_thread_num()
+#else
+#  define OMP_PRAGMA(...)
+#  define OMP_MAX_THREADS() 1
+#  define OMP_THREAD_NUM() 0
+#endif
+#define OMP_MIN_WORK 32768
+
+/* permute_vecs and Num_compact_vecs move the columns by panels of rows    */
+/* that take about this number of bytes, so that every panel stays in      */
+/* cache while all its columns are moved; panels are spread among threads  */
+#define PRIMME_PERMUTE_PANEL_BYTES 262144
+#define PRIMME_PERMUTE_MIN_PANEL 64
+
+
 /*****************************************************************************/
 /* Miscellanea                                                               */
 /*****************************************************************************/
@@ -34,10 +34,13 @@
  ******************************************************************************/
 
 
-#include <stdlib.h>   /* free */
+#include <stdlib.h>   /* free, posix_memalign */
 #include <string.h>   /* memmove */
 #include <assert.h>
 #include <math.h>
+#ifdef __linux__
+#  include <sys/mman.h>   /* madvise */
+#endif
 #include "template.h"
 #include "auxiliary.h"
 #include "blaslapack.h"
@@ -69,6 +72,17 @@ void Num_copy_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
    /* Do nothing if x and y are the same matrix */
    if (x == y && ldx == ldy) return;
 
+#ifdef _OPENMP
+   /* Copy a large contiguous memory region that doesn't overlap */
+   if (ldx == ldy && ldx == m && m*n >= OMP_MIN_WORK
+         && (x+m*n <= y || y+m*n <= x)) {
+      OMP_PRAGMA(omp parallel for)
+      for (i=0; i<m*n; i++)
+         y[i] = x[i];
+   }
+   else
+#endif
+
    /* Copy a contiguous memory region */
    if (ldx == ldy && ldx == m) {
       memmove(y, x, sizeof(SCALAR)*m*n);
@@ -87,9 +101,12 @@ void Num_copy_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n, PRIMME_INT
             y[i*ldy+j] = x[i*ldx+j];
    }
 
-   /* Copy the matrix some columns backward, and other cases */
+   /* Copy the matrix some columns backward, and other cases. Only the     */
+   /* copies between matrices that don't overlap run in parallel; the      */
+   /* others are done in column order, which is safe for backward copies. */
    else {
-      /* TODO: assert x and y don't overlap */
+      OMP_PRAGMA(omp parallel for collapse(2) if(m*n >= OMP_MIN_WORK
+               && (x+(n-1)*ldx+m <= y || y+(n-1)*ldy+m <= x)))
       for (i=0; i<n; i++)
          for (j=0; j<m; j++)
             y[i*ldy+j] = x[i*ldx+j];
@@ -125,11 +142,48 @@ void Num_copy_matrix_columns_Sprimme(SCALAR *x, PRIMME_INT m, int *xin, int n,
    PRIMME_INT j;
 
    /* TODO: assert x and y don't overlap */
+   OMP_PRAGMA(omp parallel for collapse(2) if(m*n >= OMP_MIN_WORK))
    for (i=0; i<n; i++)
       for (j=0; j<m; j++)
          y[(yin?yin[i]:i)*ldy+j] = x[(xin?xin[i]:i)*ldx+j];
 }
 
+/******************************************************************************
+ * Function Num_transpose_matrix - Copy the transpose (not conjugate) of the
+ *    matrix x into y; the copy is done by tiles of rows of x, so that the
+ *    writes on y are contiguous in the common case of n small
+ *
+ * PARAMETERS
+ * ---------------------------
+ * x           The source matrix
+ * m           The number of rows of x
+ * n           The number of columns of x
+ * ldx         The leading dimension of x
+ * y           On output y = x.', a n x m matrix
+ * ldy         The leading dimension of y
+ *
+ * NOTE: x and y *cannot* overlap
+ *
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+void Num_transpose_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n,
+      PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy) {
+
+   const PRIMME_INT tile = 64;
+   PRIMME_INT i0;
+
+   assert(m == 0 || n == 0 || (ldx >= m && ldy >= n));
+
+   OMP_PRAGMA(omp parallel for if(m*n >= OMP_MIN_WORK))
+   for (i0=0; i0<m; i0+=tile) {
+      PRIMME_INT i, j, i1 = min(i0+tile, m);
+      for (j=0; j<n; j++)
+         for (i=i0; i<i1; i++)
+            y[i*ldy+j] = x[j*ldx+i];
+   }
+}
+
 /******************************************************************************
  * Function Num_zero_matrix - Zero the matrix
  *
@@ -148,6 +202,7 @@ void Num_zero_matrix_Sprimme(SCALAR *x, PRIMME_INT m, PRIMME_INT n,
 
    PRIMME_INT i,j;
 
+   OMP_PRAGMA(omp parallel for collapse(2) if(m*n >= OMP_MIN_WORK))
    for (i=0; i<n; i++)
       for (j=0; j<m; j++)
          x[i*ldx+j] = 0.0;
@@ -293,7 +348,8 @@ void Num_copy_compact_trimatrix_Sprimme(SCALAR *x, PRIMME_INT m, int n, int i0,
 
 /******************************************************************************
  * Subroutine permute_vecs - This routine permutes a set of vectors according
- *            to a permutation array perm.
+ *            to a permutation array perm, vecs = vecs(:,perm). The cycles of
+ *            perm are followed on panels of rows that fit in cache.
  *
  * INPUT ARRAYS AND PARAMETERS
  * ---------------------------
@@ -310,76 +366,70 @@ void Num_copy_compact_trimatrix_Sprimme(SCALAR *x, PRIMME_INT m, int n, int i0,
 
 TEMPLATE_PLEASE
 void permute_vecs_Sprimme(SCALAR *vecs, PRIMME_INT m, int n, PRIMME_INT ld,
-      int *perm_, SCALAR *rwork, int *iwork) {
+      int *perm, SCALAR *rwork, int *iwork) {
 
-   int currentIndex;     /* Index of vector in sorted order                   */
-   int sourceIndex;      /* Position of out-of-order vector in original order */
-   int destinationIndex; /* Position of out-of-order vector in sorted order   */
-   int tempIndex;        /* Used to swap                                      */
-   int *perm=iwork;      /* A copy of perm_                                   */
+   int i;                /* Loop variable                                     */
+   int *leader=iwork;    /* leader[i] is nonzero if column i starts a cycle   */
+   PRIMME_INT mb;        /* Number of rows in a panel                         */
+   PRIMME_INT numPanels; /* Number of panels of rows                          */
+   PRIMME_INT p;         /* Panel index                                       */
 
-   /* Check that perm_ and iwork do not overlap */
+   /* Check that perm and iwork do not overlap */
 
-   assert((perm_>iwork?perm_-iwork:iwork-perm_) >= n);
+   assert((perm>iwork?perm-iwork:iwork-perm) >= n);
 
-   /* Check perm_ is a permutation */
+   /* Check perm is a permutation */
 
 #ifndef NDEBUG
-   for (tempIndex=0; tempIndex<n; tempIndex++) perm[tempIndex] = 0;
-   for (tempIndex=0; tempIndex<n; tempIndex++) {
-      assert(0 <= perm_[tempIndex] && perm_[tempIndex] < n);
-      perm[perm_[tempIndex]] = 1;
+   for (i=0; i<n; i++) leader[i] = 0;
+   for (i=0; i<n; i++) {
+      assert(0 <= perm[i] && perm[i] < n);
+      leader[perm[i]] = 1;
    }
-   for (tempIndex=0; tempIndex<n; tempIndex++) assert(perm[tempIndex] == 1);
+   for (i=0; i<n; i++) assert(leader[i] == 1);
 #endif
 
-   /* Copy of perm_ into perm, to avoid to modify the input permutation */
-
-   for (tempIndex=0; tempIndex<n; tempIndex++)
-      perm[tempIndex] = perm_[tempIndex];
-
-   /* Continue until all vectors are in the sorted order */
-
-   currentIndex = 0;
-   while (1) {
+   /* Mark the smallest index of every nontrivial cycle of perm as the    */
+   /* leader of the cycle (1), and the rest of the cycle with 2           */
 
-      /* Find a vector that does not belong in its original position */
-      while ((currentIndex < n) && (perm[currentIndex] == currentIndex)) {
-         currentIndex++;
-      }
-
-      /* Return if they are in the sorted order */
-      if (currentIndex >= n) {
-         return;
+   for (i=0; i<n; i++) leader[i] = 0;
+   for (i=0; i<n; i++) {
+      if (leader[i] == 0 && perm[i] != i) {
+         int j;
+         for (j=perm[i]; j!=i; j=perm[j]) leader[j] = 2;
+         leader[i] = 1;
       }
+   }
 
-      /* Copy the vector to a buffer for swapping */
-      Num_copy_Sprimme(m, &vecs[currentIndex*ld], 1, rwork, 1);
-
-      destinationIndex = currentIndex;
-      /* Copy vector perm[destinationIndex] into position destinationIndex */
-
-      while (perm[destinationIndex] != currentIndex) {
+   /* Follow the cycles on panels of rows, so that the columns of a panel */
+   /* stay in cache. The buffer of a panel is the same rows of rwork, so  */
+   /* the panels are independent.                                         */
+
+   mb = max(PRIMME_PERMUTE_MIN_PANEL,
+         PRIMME_PERMUTE_PANEL_BYTES/((PRIMME_INT)sizeof(SCALAR)*(n+1)));
+   numPanels = (m + mb - 1)/mb;
+
+   OMP_PRAGMA(omp parallel for if(m*n >= OMP_MIN_WORK && numPanels > 1))
+   for (p=0; p<numPanels; p++) {
+      PRIMME_INT r0 = p*mb, mp = min(mb, m - r0);
+      int c;
+      for (c=0; c<n; c++) {
+         int dst, src;
+         if (leader[c] != 1) continue;
+
+         /* Copy the vector to a buffer for swapping */
+         Num_copy_matrix_Sprimme(&vecs[c*ld+r0], mp, 1, mp, &rwork[r0], mp);
+
+         /* Copy vector perm[dst] into position dst along the cycle */
+         for (dst=c; (src=perm[dst]) != c; dst=src) {
+            Num_copy_matrix_Sprimme(&vecs[src*ld+r0], mp, 1, mp,
+                  &vecs[dst*ld+r0], mp);
+         }
 
-         sourceIndex = perm[destinationIndex];
-         Num_copy_Sprimme(m, &vecs[sourceIndex*ld], 1, 
-            &vecs[destinationIndex*ld], 1);
-         tempIndex = perm[destinationIndex];
-         perm[destinationIndex] = destinationIndex;
-         destinationIndex = tempIndex;
+         /* Copy the vector from the buffer to where it belongs */
+         Num_copy_matrix_Sprimme(&rwork[r0], mp, 1, mp, &vecs[dst*ld+r0], mp);
       }
-
-      /* Copy the vector from the buffer to where it belongs */
-      Num_copy_Sprimme(m, rwork, 1, &vecs[destinationIndex*ld], 1);
-      perm[destinationIndex] = destinationIndex;
-
-      currentIndex++;
    }
-
-   /* Check permutation */
-   for (currentIndex=0; currentIndex < n; currentIndex++)
-      assert(perm[currentIndex] == currentIndex);
-
 }
 
 #ifdef USE_DOUBLE
@@ -457,6 +507,52 @@ void permute_vecs_iprimme(int *vecs, int n, int *perm_, int *iwork) {
 }
 #endif
 
+/******************************************************************************
+ * Function Num_malloc_workspace_primme - allocate a workspace that can be
+ *    released with free(). The space is aligned to PRIMME_WORKSPACE_ALIGN
+ *    bytes, so that the vectors carved from it start on cache-line and SIMD
+ *    boundaries. Spaces of at least PRIMME_HUGEPAGE_SIZE bytes are aligned to
+ *    that size and advised to be backed by transparent huge pages, reducing
+ *    the TLB misses on the large V and W bases.
+ *
+ * INPUT PARAMETERS
+ * ----------------
+ * size        The number of bytes to allocate
+ *
+ * OUTPUT PARAMETERS
+ * -----------------
+ * x           On output, a pointer to the allocated space or NULL
+ *
+ * RETURN VALUE
+ * ------------
+ * error code: nonzero if the allocation failed
+ *
+ ******************************************************************************/
+
+#ifdef USE_DOUBLE
+TEMPLATE_PLEASE
+int Num_malloc_workspace_primme(size_t size, void **x) {
+
+#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L
+   size_t align = size >= PRIMME_HUGEPAGE_SIZE ? PRIMME_HUGEPAGE_SIZE
+                                               : PRIMME_WORKSPACE_ALIGN;
+   if (posix_memalign(x, align, size > 0 ? size : 1) != 0) {
+      *x = NULL;
+      return 1;
+   }
+#  ifdef MADV_HUGEPAGE
+   if (align == PRIMME_HUGEPAGE_SIZE) {
+      /* This is only an advice: ignore failures, e.g., THP disabled */
+      madvise(*x, size - size % PRIMME_HUGEPAGE_SIZE, MADV_HUGEPAGE);
+   }
+#  endif
+#else
+   *x = malloc(size > 0 ? size : 1);
+#endif
+   return *x == NULL;
+}
+#endif
+
 
 /******************************************************************************
  * Subroutine Num_compact_vecs - copy certain columns of matrix into another
@@ -486,14 +582,31 @@ SCALAR* Num_compact_vecs_Sprimme(SCALAR *vecs, PRIMME_INT m, int n,
       int avoidCopy) {
 
    int i;
+   PRIMME_INT mb;        /* Number of rows in a panel                         */
+   PRIMME_INT numPanels; /* Number of panels of rows                          */
+   PRIMME_INT p;         /* Panel index                                       */
 
    if (avoidCopy) {
       for (i=0; i<n-1 && perm[i]+1 == perm[i+1]; i++);
       if (i >= n-1) return &vecs[ld*perm[0]];
    }
 
-   for (i=0; i < n; i++) {
-      Num_copy_matrix_Sprimme(&vecs[perm[i]*ld], m, 1, ld, &work[i*ldwork], ld);
+   if (n <= 0) return work;
+
+   /* Copy the columns by panels of rows, as in permute_vecs */
+
+   mb = max(PRIMME_PERMUTE_MIN_PANEL,
+         PRIMME_PERMUTE_PANEL_BYTES/((PRIMME_INT)sizeof(SCALAR)*n));
+   numPanels = (m + mb - 1)/mb;
+
+   OMP_PRAGMA(omp parallel for if(m*n >= OMP_MIN_WORK && numPanels > 1))
+   for (p=0; p<numPanels; p++) {
+      PRIMME_INT r0 = p*mb, mp = min(mb, m - r0);
+      int c;
+      for (c=0; c < n; c++) {
+         Num_copy_matrix_Sprimme(&vecs[perm[c]*ld+r0], mp, 1, ld,
+               &work[c*ldwork+r0], ldwork);
+      }
    }
    return work;
 }
@@ -550,6 +550,95 @@ void Num_heev_Sprimme(const char *jobz, const char *uplo, int n, SCALAR *a,
 }
 
 
+/*******************************************************************************
+ * Subroutine for dense eigenvalue decomposition by divide and conquer
+ * NOTE: xheevd is faster than xheevx for large matrices when all the
+ *       eigenvectors are wanted, but it needs more workspace
+ ******************************************************************************/
+ 
+TEMPLATE_PLEASE
+void Num_heevd_Sprimme(const char *jobz, const char *uplo, int n, SCALAR *a,
+      int lda, REAL *w, SCALAR *work, int ldwork, int *info) {
+
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT lldwork = ldwork;
+   PRIMME_BLASINT linfo = 0;
+   PRIMME_BLASINT *iwork, liwork;
+#ifdef USE_COMPLEX
+   REAL *rwork;
+   PRIMME_BLASINT lrwork;
+#endif
+   SCALAR dummys=0;
+   REAL   dummyr=0;
+   PRIMME_BLASINT dummyi=0;
+
+   /* Zero dimension matrix may cause problems */
+   if (n == 0) {*info = 0; return;}
+
+   /* NULL matrices and zero leading dimension may cause problems */
+   if (a == NULL) a = &dummys;
+   if (llda < 1) llda = 1;
+   if (w == NULL) w = &dummyr;
+
+   /* Borrow space from work for rwork and iwork or set dummy values. The */
+   /* sizes are the minimum required by LAPACK when jobz is "V".          */
+   liwork = 3 + 5*ln;
+#ifdef USE_COMPLEX
+   lrwork = 1 + 5*ln + 2*ln*ln;
+#endif
+   if (ldwork != -1) {
+      if (
+#ifdef USE_COMPLEX
+               WRKSP_MALLOC_PRIMME(lrwork, &rwork, &work, &lldwork) ||
+#endif
+               WRKSP_MALLOC_PRIMME(liwork, &iwork, &work, &lldwork)
+         ) {
+         *info = -1;
+         return;
+      }
+   }
+   else {
+#ifdef USE_COMPLEX
+      rwork = &dummyr;
+      lrwork = -1;
+#endif
+      iwork = &dummyi;
+      liwork = -1;
+   }
+
+#ifdef NUM_CRAY
+   _fcd jobz_fcd, uplo_fcd;
+
+   jobz_fcd = _cptofcd(jobz, strlen(jobz));
+   uplo_fcd = _cptofcd(uplo, strlen(uplo));
+
+   XHEEVD(jobz_fcd, uplo_fcd, &ln, a, &llda, w, work, &lldwork,
+#  ifdef USE_COMPLEX
+         rwork, &lrwork,
+#  endif
+         iwork, &liwork, &linfo);
+#else
+   XHEEVD(jobz, uplo, &ln, a, &llda, w, work, &lldwork,
+#  ifdef USE_COMPLEX
+         rwork, &lrwork,
+#  endif
+         iwork, &liwork, &linfo);
+#endif
+
+   /* Add the extra space for rwork and iwork */
+   if (ldwork == -1) {
+      work[0] += (REAL)sizeof(PRIMME_BLASINT)*(3.0 + 5.0*n)/sizeof(SCALAR)
+         + 2.0;
+#ifdef USE_COMPLEX
+      work[0] += (REAL)sizeof(REAL)*(1.0 + 5.0*n + 2.0*n*n)/sizeof(SCALAR)
+         + 2.0;
+#endif
+   }
+   *info = (int)linfo;
+}
+
+
 /*******************************************************************************
  * Subroutines for dense generalize eigenvalue decomposition
  * NOTE: xhegvx is used instead of xhegv because xhegv is not in ESSL
@@ -917,6 +1006,33 @@ void Num_hetrs_Sprimme(const char *uplo, int n, int nrhs, SCALAR *a,
    *info = (int)linfo;
 }
 
+/*******************************************************************************
+ * Subroutine Num_potrf_Sprimme - Cholesky factorization, A = U^H*U or L*L^H
+ ******************************************************************************/
+
+TEMPLATE_PLEASE
+void Num_potrf_Sprimme(const char *uplo, int n, SCALAR *a, int lda,
+      int *info) {
+
+   PRIMME_BLASINT ln = n;
+   PRIMME_BLASINT llda = lda;
+   PRIMME_BLASINT linfo = 0;
+
+   /* Zero dimension matrix may cause problems */
+   if (n == 0) {*info = 0; return;}
+
+#ifdef NUM_CRAY
+   _fcd uplo_fcd;
+
+   uplo_fcd = _cptofcd(uplo, strlen(uplo));
+   XPOTRF(uplo_fcd, &ln, a, &llda, &linfo);
+#else
+   XPOTRF(uplo, &ln, a, &llda, &linfo);
+#endif
+
+   *info = (int)linfo;
+}
+
 /*******************************************************************************
  * Subroutine Num_trsm_Sprimme - b = op(A)\b, where A is triangular
  ******************************************************************************/
@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * Copyright (c) 2018, College of William & Mary
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the College of William & Mary nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COLLEGE OF WILLIAM & MARY BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * PRIMME: https://github.com/primme/primme
+ * Contact: Andreas Stathopoulos, a n d r e a s _at_ c s . w m . e d u
+ *******************************************************************************
+ * File: trace.c
+ *
+ * Purpose - Record the begin and end times of the solver events in a ring
+ *           buffer and write them in Chrome trace format (JSON), which can be
+ *           loaded in chrome://tracing or in Perfetto.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "wtime.h"
+#include "trace.h"
+
+/* Only define these functions once */
+#ifdef USE_DOUBLE
+
+typedef struct {
+   double begin, end;   /* Wall-clock times in seconds */
+   int event;           /* One of PRIMME_TRACE_* */
+} trace_record;
+
+typedef struct {
+   trace_record *records;  /* Ring buffer */
+   int size;               /* Capacity of the ring buffer */
+   long int count;         /* Number of events recorded so far */
+} trace_buffer;
+
+static const char *trace_event_names[] = {"matvec", "precond", "globalSum",
+   "ortho", "solve_H"};
+
+/*******************************************************************************
+ * Function primme_trace_create - Allocate a tracer that keeps the last size
+ *    events.
+ *
+ * Return value: 0 on success, -1 if the allocation failed
+ ******************************************************************************/
+
+int primme_trace_create(int size, void **trace) {
+
+   trace_buffer *t;
+
+   *trace = NULL;
+   if (size <= 0) return -1;
+   t = (trace_buffer*)malloc(sizeof(trace_buffer));
+   if (!t) return -1;
+   t->records = (trace_record*)malloc(sizeof(trace_record)*(size_t)size);
+   if (!t->records) {
+      free(t);
+      return -1;
+   }
+   t->size = size;
+   t->count = 0;
+   *trace = t;
+   return 0;
+}
+
+/*******************************************************************************
+ * Function primme_trace_record - Record an event that started at t0, as
+ *    returned by primme_get_wtime, and ends now. Nothing is done if trace is
+ *    NULL.
+ ******************************************************************************/
+
+void primme_trace_record(void *trace, int event, double t0) {
+
+   trace_buffer *t = (trace_buffer*)trace;
+   trace_record *r;
+
+   if (!t) return;
+   r = &t->records[t->count++ % t->size];
+   r->end = primme_get_wtime();
+   r->begin = t0;
+   r->event = event;
+}
+
+/*******************************************************************************
+ * Function primme_trace_dump - Write the recorded events, oldest first, in
+ *    Chrome trace format. With several processes, every process writes its
+ *    own file, named fileName followed by a dot and procID, and the events
+ *    of each process are shown under its own pid.
+ *
+ * Return value: 0 on success, -1 if the file could not be written
+ ******************************************************************************/
+
+int primme_trace_dump(void *trace, const char *fileName, int procID,
+      int numProcs) {
+
+   trace_buffer *t = (trace_buffer*)trace;
+   char *name;
+   FILE *f;
+   long int i, first;
+   int ret;
+
+   if (!t || !fileName) return 0;
+
+   name = (char*)malloc(strlen(fileName) + 16);
+   if (!name) return -1;
+   if (numProcs > 1) {
+      sprintf(name, "%s.%d", fileName, procID);
+   }
+   else {
+      sprintf(name, "%s", fileName);
+   }
+   f = fopen(name, "w");
+   free(name);
+   if (!f) return -1;
+
+   fprintf(f, "{\"traceEvents\":[\n");
+   fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+         "\"args\":{\"name\":\"rank %d\"}}", procID, procID);
+   first = t->count > t->size ? t->count - t->size : 0;
+   for (i=first; i<t->count; i++) {
+      trace_record *r = &t->records[i % t->size];
+      fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"primme\",\"ph\":\"X\","
+            "\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+            trace_event_names[r->event], procID, r->begin*1e6,
+            (r->end - r->begin)*1e6);
+   }
+   fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+   ret = ferror(f) ? -1 : 0;
+   if (fclose(f) != 0) ret = -1;
+   return ret;
+}
+
+/*******************************************************************************
+ * Function primme_trace_free - Free the tracer and set it to NULL.
+ ******************************************************************************/
+
+void primme_trace_free(void **trace) {
+
+   trace_buffer *t = (trace_buffer*)*trace;
+
+   if (!t) return;
+   free(t->records);
+   free(t);
+   *trace = NULL;
+}
+
+#endif /* USE_DOUBLE */
@@ -48,53 +48,15 @@
 /* Only define these functions ones */
 #ifdef USE_DOUBLE
 
-#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
-double primme_wTimer(int zeroTimer) {
-   static struct timeval tv;
-   static double StartingTime;
-   
-   if (zeroTimer) {
-      gettimeofday(&tv, NULL); 
-      StartingTime = ((double) tv.tv_sec) + ((double) tv.tv_usec )/(double) 1E6;
-      return StartingTime;
-   }
-   else {
-      gettimeofday(&tv, NULL); 
-      return ((double) tv.tv_sec) + ((double) tv.tv_usec ) / (double) 1E6
-           - StartingTime;
-   }
-}
-
-/* In the unlikely event that gettimeofday() is not available, but POSIX is, 
- * we can use the following alternative definition for primme_wTimer, 
- * after including time.h at the top.
- */
-/*
-#include <time.h>
-double primme_wTimer(int zeroTimer) {
-   static struct timespec ts;
-   static double StartingTime;
-   
-   if (zeroTimer) {
-      clock_gettime(CLOCK_REALTIME, &ts);
-      StartingTime = ((double) ts.tv_sec) + ((double) ts.tv_nsec )/(double) 1E9;
-      return StartingTime;
-   }
-   else {
-      clock_gettime(CLOCK_REALTIME, &ts);
-      return ((double) ts.tv_sec) + ((double) ts.tv_nsec ) / (double) 1E9;
-           - StartingTime;
-   }
-}
-*/
+/* The timers keep no state: every solve keeps its own starting time in  */
+/* primme_params.startTime, so concurrent solvers (see Sprimme_batch, or  */
+/* several threads calling PRIMME) do not interfere with each other       */
 
-/* 
- * Other timers that may be of use -------------------------------------------
- */
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
 
-/* Simply return the microseconds time of day */
+/* Return the time of day in seconds, with microsecond resolution */
 double primme_get_wtime(void) {
-   static struct timeval tv;
+   struct timeval tv;
 
    gettimeofday(&tv, NULL); 
    return ((double) tv.tv_sec) + ((double) tv.tv_usec ) / (double) 1E6;
@@ -103,7 +65,7 @@ double primme_get_wtime(void) {
 /* Return user/system times */
 double primme_get_time(double *utime, double *stime) {
    struct rusage usage;
-   static struct timeval utv,stv;
+   struct timeval utv,stv;
 
    getrusage(RUSAGE_SELF, &usage);
    utv = usage.ru_utime;
@@ -116,16 +78,10 @@ double primme_get_time(double *utime, double *stime) {
 }
 #else
 #include <Windows.h>
-double primme_wTimer(int zeroTimer) {
-   static DWORD StartingTime;
 
-   if (zeroTimer) {
-      StartingTime = GetTickCount();
-      return StartingTime;
-   }
-   else {
-      return GetTickCount() - StartingTime;
-   }
+/* Return the time of day in seconds */
+double primme_get_wtime(void) {
+   return GetTickCount64() / 1000.0;
 }
 
 #endif
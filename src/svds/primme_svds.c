@@ -39,15 +39,19 @@
 #include <math.h>  
 #include <assert.h>  
 #include "numerical.h"
-#include "../eigs/ortho.h"
 #include "../eigs/const.h"
+#include "../eigs/ortho.h"
+#include "../eigs/auxiliary_eigs.h"
 #include "wtime.h"
+#include "trace.h"
 #include "primme_interface.h"
 #include "primme_svds_interface.h"
 
 #define ALLOCATE_WORKSPACE_FAILURE -1
 #define MALLOC_FAILURE             -3
 
+static int primme_svds_solve(REAL *svals, SCALAR *svecs, REAL *resNorms,
+      primme_svds_params *primme_svds);
 static int primme_svds_check_input(REAL *svals, SCALAR *svecs, 
         REAL *resNorms, primme_svds_params *primme_svds);
 static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int stage,
@@ -56,19 +60,36 @@ static int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
       REAL *svals, SCALAR *svecs, REAL *rnorms, int allocatedTargetShifts);
 static void applyPreconditionerSVDS(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+static int prepare_preconditioner_svds(primme_svds_params *primme_svds,
+      int stage);
 static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
       PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
 static void Num_scalInv_Smatrix(SCALAR *x, PRIMME_INT m, int n, PRIMME_INT ldx, REAL *factors,
                                        primme_svds_params *primme_svds);
 static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate);
+static SCALAR* shuffle_buffer_svds(primme_svds_params *primme_svds, size_t n);
+static int matvec_buffer_cols_svds(primme_svds_params *primme_svds,
+      primme_params *primme);
+static void count_passes_svds(primme_svds_params *primme_svds,
+      primme_params *primme, int passes, int blockSize);
+static int dynamic_method_svds(primme_svds_params *primme_svds);
+static int workspace_dynamic_svds(primme_svds_params *primme_svds);
+static int choose_method_svds(primme_svds_params *primme_svds);
+static int range_finder_svds(REAL *svals, SCALAR *svecs, REAL *rnorms,
+      primme_svds_params *primme_svds);
 static int globalSum_Rprimme_svds(REAL *sendBuf, REAL *recvBuf, int count, 
       primme_svds_params *primme_svds);
-static void compute_resNorm(SCALAR *leftsvec, SCALAR *rightsvec, REAL *rNorm,
-      primme_svds_params *primme_svds, int *ierr);
+static size_t resNorm_buffer_size_svds(primme_svds_params *primme_svds,
+      primme_params *primme);
+static void compute_resNorm(SCALAR *leftsvecs, PRIMME_INT ldleftsvecs,
+      SCALAR *rightsvecs, PRIMME_INT ldrightsvecs, int n, REAL *rNorms,
+      SCALAR *rwork, primme_svds_params *primme_svds, int *ierr);
 static void default_convTestFun(double *sval, void *leftsvec, void *rightsvec,
       double *rNorm, int *isConv, primme_svds_params *primme_svds, int *ierr);
 static void convTestFunAug(double *eval, void *evec, double *rNorm, int *isConv,
    primme_params *primme, int *ierr);
+static void convTestFunAugBlock(void *evals, void *evecs, PRIMME_INT *ldevecs,
+   void *rNorms, int *isConv, int *blockSize, primme_params *primme, int *ierr);
 static void convTestFunATA(double *eval, void *evec, double *rNorm, int *isConv,
    primme_params *primme, int *ierr);
 static void default_monitor(void *basisSvals_, int *basisSize, int *basisFlags,
@@ -150,6 +171,271 @@ static void monitor_stage2(void *basisEvals_, int *basisSize, int *basisFlags,
 int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms, 
       primme_svds_params *primme_svds) {
 
+   int ret;
+
+   ret = primme_svds_solve(svals, svecs, resNorms, primme_svds);
+
+   /* Write the events recorded in both stages */
+
+   if (primme_svds->primme.trace) {
+      if (primme_trace_dump(primme_svds->primme.trace,
+               primme_svds->traceFileName, primme_svds->procID,
+               primme_svds->numProcs) != 0
+            && primme_svds->printLevel > 0 && primme_svds->outputFile) {
+         fprintf(primme_svds->outputFile, "PRIMME: Warning: the trace could "
+               "not be written to '%s'\n", primme_svds->traceFileName);
+      }
+      primme_trace_free(&primme_svds->primme.trace);
+      primme_svds->primmeStage2.trace = NULL;
+   }
+
+   return ret;
+}
+
+/*******************************************************************************
+ * Subroutine Sprimme_svds_update - Update the numSvals singular triplets of A
+ *    to the triplets of [A; R] after appending the p = numNewRows rows R,
+ *    without products with A.
+ *
+ *    With A ~ U*S*V' and the component of the new rows orthogonal to V,
+ *    R*(I - V*V') = K'*J', with J orthonormal, it holds
+ *
+ *       [A; R] ~ [U 0; 0 I] * M * [V J]',   M = [S 0; R*V K'],
+ *
+ *    and the triplets are updated from the largest singular triplets of the
+ *    small matrix M, computed from the eigenpairs of M'*M. J and K come
+ *    from two passes of a Gram (Cholesky QR-like) orthonormalization, and
+ *    the directions of R*(I - V*V') below machine precision relative to R
+ *    are dropped. The cost is linear in the local rows of U and V, and in
+ *    p. If matrixMatvec is set, the updated triplets are refined by
+ *    Sprimme_svds as initial guesses.
+ *
+ *    The left vectors take the new rows at the end of the local rows of the
+ *    last process; m and mLocal count the new rows.
+ *
+ * INPUT PARAMETERS
+ * ----------------
+ * newRows      The new rows, the local columns of the row j starting at
+ *              newRows[ldNewRows*j]
+ * ldNewRows    The leading dimension of newRows
+ * numNewRows   The number of new rows, p
+ *
+ * INPUT/OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------------
+ * svals        On input the singular values of A; on output of [A; R]
+ * svecs        On input the left vectors of A, in the rows that are not new,
+ *              followed by the right vectors; on output the updated ones
+ * resNorms     The residual norms if refined, or HUGE_VAL otherwise
+ * primme_svds  Structure containing various solver parameters
+ *
+ * Return Value
+ * ------------
+ *  0 - Success
+ * -1 - Failure to allocate workspace or to reduce, or error from a callback
+ * -4 ...-19 - Invalid input, as in Sprimme_svds
+ * -23 - Invalid numNewRows or ldNewRows, or numOrthoConst > 0
+ * Otherwise, the error code of Sprimme_svds refining the triplets
+ *
+ ******************************************************************************/
+
+int Sprimme_svds_update(REAL *svals, SCALAR *svecs, REAL *resNorms,
+      SCALAR *newRows, PRIMME_INT ldNewRows, int numNewRows,
+      primme_svds_params *primme_svds) {
+
+   PRIMME_INT mLocal, nLocal, mOld, i;
+   int k, p, r, l, j, pass, info, ret;
+   SCALAR *U, *V, *C, *J, *Lh, *Lh0, *G, *G0, *K, *K0, *M, *Z, *work, work0;
+   REAL *evals, normR, normR0, tol;
+   size_t workSize;
+   const double machEps = MACHINE_EPSILON;
+   const int ratio = (int)(sizeof(SCALAR)/sizeof(REAL));
+
+   /* Check the input */
+
+   if (primme_svds == NULL) return -4;
+   if (primme_svds->numProcs <= 1) {
+      primme_svds->mLocal = primme_svds->m;
+      primme_svds->nLocal = primme_svds->n;
+      primme_svds->procID = 0;
+      primme_svds->numProcs = 1;
+   }
+   if (primme_svds->m <= 0 || primme_svds->n <= 0 || primme_svds->mLocal < 0
+         || primme_svds->nLocal < 0 || primme_svds->mLocal > primme_svds->m
+         || primme_svds->nLocal > primme_svds->n) return -5;
+   if (primme_svds->numProcs > 1 && primme_svds->globalSumReal == NULL)
+      return -9;
+   if (primme_svds->numSvals > min(primme_svds->m, primme_svds->n))
+      return -10;
+   if (primme_svds->numSvals < 1) return -11;
+   if (svals == NULL) return -17;
+   if (svecs == NULL) return -18;
+   if (resNorms == NULL) return -19;
+
+   mLocal = primme_svds->mLocal;
+   nLocal = primme_svds->nLocal;
+   k = primme_svds->numSvals;
+   p = numNewRows;
+   mOld = mLocal;
+   if (primme_svds->procID == primme_svds->numProcs-1) mOld -= p;
+   if (p < 0 || mOld < 0 || ldNewRows < nLocal || (p > 0 && newRows == NULL)
+         || primme_svds->numOrthoConst > 0) return -23;
+   U = svecs;
+   V = &svecs[mLocal*k];
+
+   /* Allocate C, J, U and V updated, and the small matrices: Lh and Lh0    */
+   /* of p columns; K0 of k+p columns; G, G0 and K of p columns; M and     */
+   /* M'*M of k+p columns; and Z of k columns                              */
+
+   l = k + p;
+   Num_heev_Sprimme("V", "U", l, NULL, l, NULL, &work0, -1, &info);
+   CHKERRS(info, -1);
+   workSize = (size_t)REAL_PART(work0);
+   CHKERRS(MALLOC_PRIMME(nLocal*p*2 + (mLocal+nLocal)*k + (size_t)l*p*2
+            + (size_t)l*l*3 + (size_t)p*p*3 + (size_t)l*k + workSize + l,
+            &C), -1);
+   J = C + nLocal*p;
+   Z = J + nLocal*p;               /* U and V updated, later */
+   Lh = Z + (mLocal+nLocal)*k;
+   Lh0 = Lh + l*p;
+   K0 = Lh0 + l*p;
+   G = K0 + l*l;
+   G0 = G + p*p;
+   K = G0 + p*p;
+   M = K + p*p;
+   work = M + l*l*2 + l*k;
+   evals = (REAL*)(work + workSize);
+
+   /* C = R', and normR = |R|_F^2 */
+
+   for (j=0; j<p; j++) {
+      for (i=0; i<nLocal; i++) {
+         C[nLocal*j+i] = CONJ(newRows[ldNewRows*j+i]);
+      }
+   }
+   normR0 = 0.0;
+   for (j=0; j<p; j++) {
+      normR0 += REAL_PART(Num_dot_Sprimme(nLocal, &C[nLocal*j], 1,
+               &C[nLocal*j], 1));
+   }
+   CHKERRS(globalSum_Rprimme_svds(&normR0, &normR, 1, primme_svds), -1);
+
+   /* Lh = V'*C, C = (I - V*V')*C; twice to keep C orthogonal to V */
+
+   Num_zero_matrix_Sprimme(Lh, k, p, k);
+   for (pass=0; pass<2; pass++) {
+      Num_gemm_Sprimme("C", "N", k, p, nLocal, 1.0, V, nLocal, C, nLocal, 0.0,
+            Lh0, k);
+      CHKERRS(globalSum_Rprimme_svds((REAL*)Lh0, (REAL*)K0, k*p*ratio,
+               primme_svds), -1);
+      Num_gemm_Sprimme("N", "N", nLocal, p, k, -1.0, V, nLocal, K0, k, 1.0, C,
+            nLocal);
+      for (i=0; i<k*p; i++) Lh[i] += K0[i];
+   }
+
+   /* C = J*K with J orthonormal, from C'*C = W*D*W': first J = C*W*D^{-1/2}  */
+   /* and K = D^{1/2}*W', dropping the small D, then the same on J            */
+
+   r = p;
+   for (pass=0; pass<2; pass++) {
+      SCALAR *X = pass == 0 ? C : J, *Y = pass == 0 ? J : C;
+      int r0 = r;
+      tol = pass == 0 ? machEps*normR : machEps;
+
+      Num_gemm_Sprimme("C", "N", r0, r0, nLocal, 1.0, X, nLocal, X, nLocal,
+            0.0, G0, r0);
+      CHKERRS(globalSum_Rprimme_svds((REAL*)G0, (REAL*)G, r0*r0*ratio,
+               primme_svds), -1);
+      Num_heev_Sprimme("V", "U", r0, G, r0, evals, work, (int)workSize, &info);
+      CHKERRS(info, -1);
+
+      /* Keep the r largest eigenvalues above tol, in the last columns */
+
+      for (r=0; r<r0 && evals[r0-1-r] > tol; r++);
+      for (j=0; j<r; j++) {
+         REAL s = sqrt(evals[r0-r+j]);
+         for (i=0; i<r0; i++) {
+            K0[r*i+j] = CONJ(G[r0*(r0-r+j)+i])*s;
+            G[r0*(r0-r+j)+i] /= s;
+         }
+      }
+      Num_gemm_Sprimme("N", "N", nLocal, r, r0, 1.0, X, nLocal, &G[r0*(r0-r)],
+            r0, 0.0, Y, nLocal);
+      if (pass == 0) {
+         Num_copy_matrix_Sprimme(K0, r, p, r, K, r);
+      }
+      else {
+         Num_gemm_Sprimme("N", "N", r, p, r0, 1.0, K0, r, K, r0, 0.0, G0, r);
+         Num_copy_matrix_Sprimme(G0, r, p, r, K, r);
+      }
+   }
+
+   /* The second pass left J in C */
+
+   J = C;
+
+   /* M = [S 0; Lh' K'], of size (k+p) x (k+r) */
+
+   Num_zero_matrix_Sprimme(M, l, k+r, l);
+   for (j=0; j<k; j++) {
+      M[l*j+j] = svals[j];
+      for (i=0; i<p; i++) M[l*j+k+i] = CONJ(Lh[k*i+j]);
+   }
+   for (j=0; j<r; j++) {
+      for (i=0; i<p; i++) M[l*(k+j)+k+i] = CONJ(K[r*i+j]);
+   }
+
+   /* M'*M = Y*E*Y'; svals = sqrt(E), and Z = M*Y*E^{-1/2} for the k largest */
+
+   G = M + l*l;
+   Num_gemm_Sprimme("C", "N", k+r, k+r, l, 1.0, M, l, M, l, 0.0, G, k+r);
+   Num_heev_Sprimme("V", "U", k+r, G, k+r, evals, work, (int)workSize, &info);
+   CHKERRS(info, -1);
+   for (j=0; j<k; j++) {
+      svals[j] = sqrt(max(0.0, evals[k+r-1-j]));
+      Num_copy_Sprimme(k+r, &G[(k+r)*(k+r-1-j)], 1, &K0[(k+r)*j], 1);
+   }
+   Num_gemm_Sprimme("N", "N", l, k, k+r, 1.0, M, l, K0, k+r, 0.0,
+         M + l*l*2, l);
+   for (j=0; j<k; j++) {
+      if (svals[j] > 0.0) {
+         Num_scal_Sprimme(l, 1.0/svals[j], &M[l*l*2+l*j], 1);
+      }
+   }
+
+   /* V = [V J]*Y(:,0:k-1); U = [U 0; 0 I]*Z */
+
+   Num_gemm_Sprimme("N", "N", nLocal, k, k, 1.0, V, nLocal, K0, k+r, 0.0,
+         &Z[mLocal*k], nLocal);
+   Num_gemm_Sprimme("N", "N", nLocal, k, r, 1.0, J, nLocal, &K0[k], k+r, 1.0,
+         &Z[mLocal*k], nLocal);
+   Num_gemm_Sprimme("N", "N", mOld, k, k, 1.0, U, mLocal, M + l*l*2, l, 0.0,
+         Z, mLocal);
+   for (j=0; j<k; j++) {
+      for (i=mOld; i<mLocal; i++) {
+         Z[mLocal*j+i] = M[l*l*2+l*j+k+i-mOld];
+      }
+   }
+   Num_copy_Sprimme((mLocal+nLocal)*k, Z, 1, svecs, 1);
+   free(C);
+
+   /* Refine the triplets with the solver, if the operator is given */
+
+   for (j=0; j<k; j++) resNorms[j] = HUGE_VAL;
+   if (primme_svds->matrixMatvec == NULL) return 0;
+   primme_svds->initSize = k;
+   ret = Sprimme_svds(svals, svecs, resNorms, primme_svds);
+   return ret;
+}
+
+/*******************************************************************************
+ * Subroutine primme_svds_solve - Sprimme_svds without writing the trace.
+ *    See Sprimme_svds for the description of the parameters and the return
+ *    value.
+ ******************************************************************************/
+
+static int primme_svds_solve(REAL *svals, SCALAR *svecs, REAL *resNorms, 
+      primme_svds_params *primme_svds) {
+
    int ret, allocatedTargetShifts;
    SCALAR *svecs0;
 
@@ -174,8 +460,11 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
    /* -------------------------------------------------------------- */
    /* If needed, we are ready to estimate required memory and return */
    /* -------------------------------------------------------------- */
-    if (svals == NULL && svecs == NULL && resNorms == NULL)
+    if (svals == NULL && svecs == NULL && resNorms == NULL) {
+       if (dynamic_method_svds(primme_svds))
+          return workspace_dynamic_svds(primme_svds);
        return allocate_workspace_svds(primme_svds, 0 /* don't allocate */);
+    }
 
    /* ----------------------------------------------------------- */
    /* Primme_svds_initialize must be called by users unless users */  
@@ -187,6 +476,32 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
       return(ret);
    }
 
+   /* ----------------------- */
+   /* Reset stats             */
+   /* ----------------------- */
+
+   primme_svds->stats.numOuterIterations            = 0; 
+   primme_svds->stats.numRestarts                   = 0;
+   primme_svds->stats.numMatvecs                    = 0;
+   primme_svds->numPasses                           = 0;
+   primme_svds->stats.numPreconds                   = 0;
+   primme_svds->stats.numGlobalSum                  = 0;
+   primme_svds->stats.volumeGlobalSum               = 0;
+   primme_svds->stats.numOrthoInnerProds            = 0.0;
+   primme_svds->stats.elapsedTime                   = 0.0;
+   primme_svds->stats.timeMatvec                    = 0.0;
+   primme_svds->stats.timePrecond                   = 0.0;
+   primme_svds->stats.timeOrtho                     = 0.0;
+   primme_svds->stats.timeGlobalSum                 = 0.0;
+
+   /* ------------------------------------------------------------ */
+   /* Choose the operators from the measured costs, if it is asked */
+   /* ------------------------------------------------------------ */
+
+   if (dynamic_method_svds(primme_svds)) {
+      CHKERRS(choose_method_svds(primme_svds), ALLOCATE_WORKSPACE_FAILURE);
+   }
+
    /* ----------------------------------------------------------------------- */
    /* Compute AND allocate memory requirements for main_iter and subordinates */
    /* ----------------------------------------------------------------------- */
@@ -195,6 +510,16 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
       return ALLOCATE_WORKSPACE_FAILURE;
    }
 
+   /* ---------------------------------------------------------- */
+   /* Start recording the events of both stages if it is asked   */
+   /* ---------------------------------------------------------- */
+
+   if (primme_svds->traceFileName) {
+      CHKERRS(primme_trace_create(primme_svds->traceSize,
+               &primme_svds->primme.trace), MALLOC_FAILURE);
+      primme_svds->primmeStage2.trace = primme_svds->primme.trace;
+   }
+
    /* ----------------------------------------- */
    /* Set default monitor and convergence test  */
    /* ----------------------------------------- */
@@ -207,22 +532,15 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
       primme_svds->monitorFun = default_monitor;
    }
 
-   /* ----------------------- */
-   /* Reset stats             */
-   /* ----------------------- */
+   /* ------------------------------------------------------------ */
+   /* Compute initial guesses with the randomized range finder     */
+   /* ------------------------------------------------------------ */
 
-   primme_svds->stats.numOuterIterations            = 0; 
-   primme_svds->stats.numRestarts                   = 0;
-   primme_svds->stats.numMatvecs                    = 0;
-   primme_svds->stats.numPreconds                   = 0;
-   primme_svds->stats.numGlobalSum                  = 0;
-   primme_svds->stats.volumeGlobalSum               = 0;
-   primme_svds->stats.numOrthoInnerProds            = 0.0;
-   primme_svds->stats.elapsedTime                   = 0.0;
-   primme_svds->stats.timeMatvec                    = 0.0;
-   primme_svds->stats.timePrecond                   = 0.0;
-   primme_svds->stats.timeOrtho                     = 0.0;
-   primme_svds->stats.timeGlobalSum                 = 0.0;
+   if (primme_svds->rangeFinderPasses > 0 && primme_svds->initSize == 0 &&
+         primme_svds->target == primme_svds_largest) {
+      CHKERRS(range_finder_svds(svals, svecs, resNorms, primme_svds),
+            ALLOCATE_WORKSPACE_FAILURE);
+   }
 
    /* --------------- */
    /* Execute stage 1 */
@@ -236,7 +554,10 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
                NULL, &allocatedTargetShifts)) == NULL,
          ALLOCATE_WORKSPACE_FAILURE);
 
-   ret = Sprimme(svals, svecs0, resNorms, &primme_svds->primme); 
+   ret = prepare_preconditioner_svds(primme_svds, 0);
+   if (ret == 0) {
+      ret = Sprimme(svals, svecs0, resNorms, &primme_svds->primme); 
+   }
 
    CHKERRS(copy_last_params_to_svds(primme_svds, 0, svals, svecs, resNorms,
             allocatedTargetShifts), ALLOCATE_WORKSPACE_FAILURE);
@@ -260,7 +581,11 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
    /* are already converged. So shift svals and resnorms that much */
    int nconv = primme_svds->numSvals - primme_svds->primmeStage2.numEvals;
 
-   ret = Sprimme(svals+nconv, svecs0, resNorms+nconv, &primme_svds->primmeStage2);
+   ret = prepare_preconditioner_svds(primme_svds, 1);
+   if (ret == 0) {
+      ret = Sprimme(svals+nconv, svecs0, resNorms+nconv,
+            &primme_svds->primmeStage2);
+   }
 
    CHKERRS(copy_last_params_to_svds(primme_svds, 1, svals, svecs, resNorms,
          allocatedTargetShifts), ALLOCATE_WORKSPACE_FAILURE);
@@ -271,6 +596,361 @@ int Sprimme_svds(REAL *svals, SCALAR *svecs, REAL *resNorms,
    return 0;
 }
 
+/******************************************************************************
+ * Function dynamic_method_svds - return whether choose_method_svds may change
+ *    the operators: dynamicMethodSwitch is set, the operators are still the
+ *    ones of primme_svds_hybrid, and there is no budget of passes to spend
+ *    on timings.
+ ******************************************************************************/
+
+static int dynamic_method_svds(primme_svds_params *primme_svds) {
+
+   return primme_svds->dynamicMethodSwitch > 0
+      && primme_svds->maxPasses <= 0
+      && primme_svds->matrixMatvec != NULL
+      && (primme_svds->method == primme_svds_op_AtA
+            || primme_svds->method == primme_svds_op_AAt)
+      && primme_svds->methodStage2 == primme_svds_op_augmented;
+}
+
+/******************************************************************************
+ * Function set_operators_svds - set the operators of both stages and copy
+ *    again the options to the underneath eigensolvers.
+ ******************************************************************************/
+
+static void set_operators_svds(primme_svds_params *primme_svds,
+      primme_svds_operator method, primme_svds_operator methodStage2) {
+
+   /* The dimensions of the first stage are set again for the operator */
+
+   if (primme_svds->method != method) {
+      primme_svds->primme.nLocal = -1;
+      primme_svds->primme.ldevecs = -1;
+      primme_svds->primme.ldOPs = -1;
+   }
+   primme_svds->method = method;
+   primme_svds->methodStage2 = methodStage2;
+   primme_svds_set_defaults(primme_svds);
+}
+
+/******************************************************************************
+ * Function workspace_dynamic_svds - return in intWorkSize and realWorkSize
+ *    the largest workspace among the operators that choose_method_svds may
+ *    pick.
+ ******************************************************************************/
+
+static int workspace_dynamic_svds(primme_svds_params *primme_svds) {
+
+   primme_svds_operator method = primme_svds->method;
+   primme_svds_operator ops[3][2] = {
+      {primme_svds_op_AtA, primme_svds_op_augmented},
+      {primme_svds_op_AAt, primme_svds_op_augmented},
+      {primme_svds_op_augmented, primme_svds_op_none}};
+   int i, intWorkSize = 0;
+   size_t realWorkSize = 0;
+
+   for (i=0; i<3; i++) {
+      set_operators_svds(primme_svds, ops[i][0], ops[i][1]);
+      allocate_workspace_svds(primme_svds, 0 /* don't allocate */);
+      intWorkSize = max(intWorkSize, primme_svds->intWorkSize);
+      realWorkSize = max(realWorkSize, primme_svds->realWorkSize);
+   }
+   set_operators_svds(primme_svds, method, primme_svds_op_augmented);
+   primme_svds->intWorkSize = intWorkSize;
+   primme_svds->realWorkSize = realWorkSize;
+   return 1;
+}
+
+/******************************************************************************
+ * Function choose_method_svds - choose the operators from the measured costs,
+ *    as the DYNAMIC method does for GD+k and JDQMR in main_iter.
+ *
+ *    Every operator takes a product with A and another with A' per vector,
+ *    unless matrixMatvecNormal is set; but the orthogonalization works on
+ *    vectors of n, m or m+n rows. The time of an outer iteration with a block
+ *    of b vectors and a basis of B vectors is modeled as
+ *
+ *       products + 4*B/b * (time of a b x b Gram on those rows) + 4 reductions,
+ *
+ *    from the timings of a block of products, a Gram on vectors of nLocal and
+ *    mLocal rows, and a reduction of b x b values. The first stage switches
+ *    between A'*A and A*A' if the other one is cheaper by more than 5%, as
+ *    long as A is square or the largest values are sought. For the largest
+ *    values, the normal equations need about half the iterations of the
+ *    augmented problem; if
+ *    the augmented iteration is still cheaper, the first stage is skipped.
+ *
+ *    The timings are summed over all processes, so that every process takes
+ *    the same choice.
+ ******************************************************************************/
+
+static int choose_method_svds(primme_svds_params *primme_svds) {
+
+   primme_params *primme = &primme_svds->primme;
+   PRIMME_INT mLocal = primme_svds->mLocal, nLocal = primme_svds->nLocal;
+   PRIMME_INT iseed[4] = {primme_svds->procID % 4096, 1, 2, 3};
+   int b = max(1, min(primme->maxBlockSize, primme_svds->numSvals));
+   int notrans = 0, trans = 1, ierr = 0, i;
+   SCALAR *x, *y, *w, *G;
+   REAL t0[7], t[7], cAtA, cAAt, cAug, o;
+   double t1;
+
+   CHKERRS(MALLOC_PRIMME(nLocal*b + mLocal*b + max(mLocal, nLocal)*b
+            + (size_t)b*b, &x), -1);
+   y = x + nLocal*b;
+   w = y + mLocal*b;
+   G = w + max(mLocal, nLocal)*b;
+   Num_larnv_Sprimme(2, iseed, nLocal*b, x);
+
+   /* t0[0] = A*x; t0[1] = A'*y */
+
+   t1 = primme_get_wtime();
+   CHKERRMS((primme_svds->matrixMatvec(x, &nLocal, y, &mLocal, &b, &notrans,
+               primme_svds, &ierr), ierr), -1,
+         "Error returned by 'matrixMatvec' %d", ierr);
+   t0[0] = primme_get_wtime() - t1;
+   t1 = primme_get_wtime();
+   CHKERRMS((primme_svds->matrixMatvec(y, &mLocal, x, &nLocal, &b, &trans,
+               primme_svds, &ierr), ierr), -1,
+         "Error returned by 'matrixMatvec' %d", ierr);
+   t0[1] = primme_get_wtime() - t1;
+   primme_svds->stats.timeMatvec += t0[0] + t0[1];
+   primme_svds->stats.numMatvecs += 2*b;
+   primme_svds->numPasses += 2;
+
+   /* t0[2] = A'*A*x and t0[3] = A*A'*y, if they are done in a single call */
+
+   if (primme_svds->matrixMatvecNormal) {
+      t1 = primme_get_wtime();
+      CHKERRMS((primme_svds->matrixMatvecNormal(x, &nLocal, w, &nLocal, &b,
+                  &notrans, primme_svds, &ierr), ierr), -1,
+            "Error returned by 'matrixMatvecNormal' %d", ierr);
+      t0[2] = primme_get_wtime() - t1;
+      t1 = primme_get_wtime();
+      CHKERRMS((primme_svds->matrixMatvecNormal(y, &mLocal, w, &mLocal, &b,
+                  &trans, primme_svds, &ierr), ierr), -1,
+            "Error returned by 'matrixMatvecNormal' %d", ierr);
+      t0[3] = primme_get_wtime() - t1;
+      primme_svds->stats.timeMatvec += t0[2] + t0[3];
+      primme_svds->stats.numMatvecs += 4*b;
+      primme_svds->numPasses += 2;
+   }
+   else {
+      t0[2] = t0[3] = t0[0] + t0[1];
+   }
+
+   /* t0[4] and t0[5], the orthogonalization of an iteration, o Grams on  */
+   /* nLocal and mLocal rows, after a first Gram that warms up the caches */
+
+   o = ceil(4.0*max(primme->maxBasisSize, b)/b);
+   Num_gemm_Sprimme("C", "N", b, b, nLocal, 1.0, x, nLocal, x, nLocal, 0.0, G,
+         b);
+   t1 = primme_get_wtime();
+   for (i=0; i<(int)o; i++) {
+      Num_gemm_Sprimme("C", "N", b, b, nLocal, 1.0, x, nLocal, x, nLocal, 0.0,
+            G, b);
+   }
+   t0[4] = primme_get_wtime() - t1;
+   Num_gemm_Sprimme("C", "N", b, b, mLocal, 1.0, y, mLocal, y, mLocal, 0.0, G,
+         b);
+   t1 = primme_get_wtime();
+   for (i=0; i<(int)o; i++) {
+      Num_gemm_Sprimme("C", "N", b, b, mLocal, 1.0, y, mLocal, y, mLocal, 0.0,
+            G, b);
+   }
+   t0[5] = primme_get_wtime() - t1;
+
+   /* t0[6], the reduction of the Gram */
+
+   t0[6] = 0.0;
+   if (primme_svds->numProcs > 1) {
+      t1 = primme_get_wtime();
+      CHKERRS(globalSum_Rprimme_svds((REAL*)G, (REAL*)w,
+               b*b*(int)(sizeof(SCALAR)/sizeof(REAL)), primme_svds), -1);
+      t0[6] = primme_get_wtime() - t1;
+   }
+   free(x);
+   CHKERRS(globalSum_Rprimme_svds(t0, t, 7, primme_svds), -1);
+
+   /* Model the cost of an outer iteration with each operator */
+
+   cAtA = t[2] + t[4] + 4.0*t[6];
+   cAAt = t[3] + t[5] + 4.0*t[6];
+   cAug = t[0] + t[1] + t[4] + t[5] + 4.0*t[6];
+
+   /* Keep the operators set by primme_svds_set_method unless the others */
+   /* are clearly cheaper, as the timings of a single call are noisy     */
+
+   if (primme_svds->target == primme_svds_largest
+         && 2.0*cAug*1.05 < min(cAtA, cAAt)) {
+      set_operators_svds(primme_svds, primme_svds_op_augmented,
+            primme_svds_op_none);
+   }
+   /* The normal equations on the larger side have m-n extra zero        */
+   /* eigenvalues that are not singular values, so switch to them only    */
+   /* when seeking the largest values                                     */
+
+   else if ((primme_svds->m == primme_svds->n
+            || primme_svds->target == primme_svds_largest)
+         && (primme_svds->method == primme_svds_op_AtA ? cAAt*1.05 < cAtA
+            : cAtA*1.05 < cAAt)) {
+      set_operators_svds(primme_svds,
+            primme_svds->method == primme_svds_op_AtA ?
+               primme_svds_op_AAt : primme_svds_op_AtA,
+            primme_svds_op_augmented);
+   }
+
+   if (primme_svds->printLevel >= 3 && primme_svds->procID == 0) {
+      fprintf(primme_svds->outputFile,
+            "Cost per iteration: A'A %e AA' %e augmented %e; using %s\n",
+            cAtA, cAAt, cAug,
+            primme_svds->method == primme_svds_op_AtA ? "A'A" :
+            primme_svds->method == primme_svds_op_AAt ? "AA'" : "augmented");
+   }
+
+   return 0;
+}
+
+/******************************************************************************
+ * Function range_finder_svds - compute numSvals initial guesses for the
+ *    largest singular triplets with a randomized block range finder, and set
+ *    them in svecs as if the user had provided them with initSize.
+ *
+ *    Starting from a random V with l = min(2*numSvals, maxBasisSize) columns
+ *    orthogonal to the right constraints, every pass computes U = orth(A*V)
+ *    and V = orth(A'*U) with block products of l columns. Finally the
+ *    Rayleigh-Ritz on A'*A, (AV)'(AV) = Y*L*Y', returns the numSvals largest
+ *    V*Y and A*V*Y*L^{-1/2}, with svals = sqrt(L).
+ *
+ * INPUT/OUTPUT ARRAYS AND PARAMETERS
+ * ----------------------------------
+ * svals        The approximate singular values
+ * svecs        On input [Uc Vc]; on output [Uc U Vc V] (see Sprimme_svds)
+ * rnorms       The residual norms, set to HUGE_VAL
+ * primme_svds  Structure containing various solver parameters
+ *
+ ******************************************************************************/
+
+static int range_finder_svds(REAL *svals, SCALAR *svecs, REAL *rnorms,
+      primme_svds_params *primme_svds) {
+
+   primme_params *primme = &primme_svds->primme;
+   PRIMME_INT mLocal = primme_svds->mLocal, nLocal = primme_svds->nLocal;
+   int k = primme_svds->numSvals, nc = primme_svds->numOrthoConst;
+   int l, i, pass, info, ierr = 0, notrans = 0, trans = 1;
+   SCALAR *U, *V, *Uc, *Vc, *Ul, *Vl, *G, *G0, *rwork, rwork0;
+   REAL *evals;
+   size_t rworkSize = 0;
+   double t0;
+   const double machEps = MACHINE_EPSILON;
+
+   /* Oversample the range, but don't take more columns than there are */
+   /* singular triplets left or the eigensolver would keep             */
+
+   l = min(2*k, min(primme_svds->m, primme_svds->n) - nc);
+   l = max(k, min(l, primme->maxBasisSize));
+
+   /* Make room for U between Uc and Vc, so svecs = [Uc U Vc V] */
+
+   Uc = svecs;
+   U = &svecs[mLocal*nc];
+   Vc = &svecs[mLocal*(nc+k)];
+   V = &Vc[nLocal*nc];
+   memmove(Vc, U, sizeof(SCALAR)*nLocal*nc);
+
+   /* Allocate Ul, Vl, and workspace for ortho, heev, V*Y and G */
+
+   CHKERRS(ortho_Sprimme(NULL, 0, NULL, 0, 0, l-1, NULL, 0, nc,
+            max(mLocal, nLocal), NULL, machEps, NULL, &rworkSize, primme), -1);
+   rworkSize = max(rworkSize, (size_t)Num_update_VWXR_Sprimme(NULL, NULL,
+            max(mLocal, nLocal), l, 0, NULL, l, 0, NULL,
+            NULL, 0, k, 0, NULL, 0, 0, 0, NULL, 0, 0, 0, NULL, 0, 0, 0,
+            NULL, 0, 0, 0, NULL, NULL, 0, 0, NULL, 0, primme));
+   Num_heev_Sprimme("V", "U", l, NULL, l, NULL, &rwork0, -1, &info);
+   CHKERRS(info, -1);
+   rworkSize = max(rworkSize, (size_t)REAL_PART(rwork0));
+   CHKERRS(MALLOC_PRIMME((mLocal+nLocal)*l + rworkSize + (size_t)l*l*2 + l,
+            &Ul), -1);
+   Vl = Ul + mLocal*l;
+   rwork = Vl + nLocal*l;
+   G = rwork + rworkSize;
+   G0 = G + l*l;
+   evals = (REAL*)(G0 + l*l);
+
+   /* Vl = orth(rand) */
+
+   Num_larnv_Sprimme(2, primme_svds->iseed, nLocal*l, Vl);
+   CHKERRS(ortho_Sprimme(Vl, nLocal, NULL, 0, 0, l-1, Vc, nLocal, nc, nLocal,
+            primme_svds->iseed, machEps, rwork, &rworkSize, primme), -1);
+
+   for (pass=0; pass<=primme_svds->rangeFinderPasses; pass++) {
+
+      /* Ul = A*Vl; in the last pass stop here */
+
+      t0 = primme_get_wtime();
+      CHKERRMS((primme_svds->matrixMatvec(Vl, &nLocal, Ul, &mLocal, &l,
+                  &notrans, primme_svds, &ierr), ierr), -1,
+            "Error returned by 'matrixMatvec' %d", ierr);
+      primme_svds->stats.timeMatvec += primme_get_wtime() - t0;
+      primme_svds->stats.numMatvecs += l;
+      primme_svds->numPasses++;
+      if (pass == primme_svds->rangeFinderPasses) break;
+
+      /* Ul = orth(Ul); Vl = orth(A'*Ul) */
+
+      CHKERRS(ortho_Sprimme(Ul, mLocal, NULL, 0, 0, l-1, Uc, mLocal, nc,
+               mLocal, primme_svds->iseed, machEps, rwork, &rworkSize, primme),
+            -1);
+      t0 = primme_get_wtime();
+      CHKERRMS((primme_svds->matrixMatvec(Ul, &mLocal, Vl, &nLocal, &l,
+                  &trans, primme_svds, &ierr), ierr), -1,
+            "Error returned by 'matrixMatvec' %d", ierr);
+      primme_svds->stats.timeMatvec += primme_get_wtime() - t0;
+      primme_svds->stats.numMatvecs += l;
+      primme_svds->numPasses++;
+      CHKERRS(ortho_Sprimme(Vl, nLocal, NULL, 0, 0, l-1, Vc, nLocal, nc,
+               nLocal, primme_svds->iseed, machEps, rwork, &rworkSize, primme),
+            -1);
+   }
+
+   /* G = Ul'*Ul = Vl'*A'*A*Vl = Y*L*Y' */
+
+   Num_gemm_Sprimme("C", "N", l, l, mLocal, 1.0, Ul, mLocal, Ul, mLocal, 0.0,
+         G0, l);
+   CHKERRS(globalSum_Rprimme_svds((REAL*)G0, (REAL*)G,
+            l*l*(int)(sizeof(SCALAR)/sizeof(REAL)), primme_svds), -1);
+   Num_heev_Sprimme("V", "U", l, G, l, evals, rwork, (int)rworkSize, &info);
+   CHKERRS(info, -1);
+
+   /* Sort the Ritz values in descending order */
+
+   for (i=0; i<l/2; i++) {
+      REAL e = evals[i];
+      evals[i] = evals[l-1-i];
+      evals[l-1-i] = e;
+      Num_swap_Sprimme(l, &G[l*i], 1, &G[l*(l-1-i)], 1);
+   }
+   for (i=0; i<k; i++) {
+      svals[i] = sqrt(max(0.0, evals[i]));
+      rnorms[i] = HUGE_VAL;
+   }
+
+   /* V = Vl*Y(:,0:k-1); U = Ul*Y(:,0:k-1)/sqrt(L) */
+
+   CHKERRS(Num_update_VWXR_Sprimme(Vl, NULL, nLocal, l, nLocal, G, l, l, NULL,
+            V, 0, k, nLocal, NULL, 0, 0, 0, NULL, 0, 0, 0, NULL, 0, 0, 0,
+            NULL, 0, 0, 0, NULL, NULL, 0, 0, rwork, rworkSize, primme), -1);
+   CHKERRS(Num_update_VWXR_Sprimme(Ul, NULL, mLocal, l, mLocal, G, l, l, NULL,
+            U, 0, k, mLocal, NULL, 0, 0, 0, NULL, 0, 0, 0, NULL, 0, 0, 0,
+            NULL, 0, 0, 0, NULL, NULL, 0, 0, rwork, rworkSize, primme), -1);
+   Num_scalInv_Smatrix(U, mLocal, k, mLocal, svals, primme_svds);
+
+   free(Ul);
+   primme_svds->initSize = k;
+
+   return 0;
+}
+
 static int comp_double(const void *a, const void *b)
 {
    return *(double*)a <= *(double*)b ? -1 : 1;
@@ -322,9 +1002,14 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
    case primme_svds_op_AtA:
    case primme_svds_op_AAt:
       primme->convTestFun = convTestFunATA;
+      primme->convTestFunBlock = NULL;
       break;
    case primme_svds_op_augmented:
       primme->convTestFun = convTestFunAug;
+      /* Check the candidates of the default criterion in blocks */
+      primme->convTestFunBlock =
+         primme_svds->convTestFun == default_convTestFun ?
+         convTestFunAugBlock : NULL;
       break;
    case primme_svds_op_none:
       break;
@@ -354,13 +1039,14 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
    case primme_svds_op_augmented:
       /* Shuffle svecs so that svecs = [V; U] */
       assert(primme->nLocal == primme_svds->mLocal+primme_svds->nLocal);
-      CHKERRS(MALLOC_PRIMME(primme->nLocal*n, &aux), NULL);
+      CHKERRS((aux = shuffle_buffer_svds(primme_svds, primme->nLocal*n))
+            == NULL, NULL);
       Num_copy_Sprimme(primme->nLocal*n, svecs, 1, aux, 1);
       Num_copy_matrix_Sprimme(&aux[primme_svds->mLocal*n], primme_svds->nLocal,
          n, primme_svds->nLocal, svecs, primme->nLocal);
       Num_copy_matrix_Sprimme(aux, primme_svds->mLocal, n, primme_svds->mLocal,
          &svecs[primme_svds->nLocal], primme->nLocal);
-      free(aux);
+      if (aux != primme_svds->realWork) free(aux);
 
       /* Normalize the orthogonal constrains */
       Num_scal_Sprimme(primme->nLocal*primme_svds->numOrthoConst, 1./sqrt(2.),
@@ -379,15 +1065,27 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
    else {
       primme->maxMatvecs = primme_svds->maxMatvecs/2 - primme_svds->primme.stats.numMatvecs;
    }
+   if (primme_svds->maxPasses > 0
+         && primme_svds->numPasses >= primme_svds->maxPasses) {
+      primme->maxMatvecs = 0;
+   }
 
    primme->intWork = primme_svds->intWork;
    primme->intWorkSize = primme_svds->intWorkSize;
    /* If matrixMatvecSVDS is used, it needs extra space to compute A*A' or A'*A */
+   /* unless the user provides matrixMatvecNormal                           */
    if ((primme->matrixMatvec == matrixMatvecSVDS) &&
+       !primme_svds->matrixMatvecNormal &&
        (method == primme_svds_op_AtA || method == primme_svds_op_AAt)) {
-      cut = primme->maxBlockSize * (method == primme_svds_op_AtA ?
+      cut = matvec_buffer_cols_svds(primme_svds, primme) *
+                     (method == primme_svds_op_AtA ?
                      primme_svds->mLocal : primme_svds->nLocal);
    }
+   /* The residual norms of the augmented problem are checked in the */
+   /* buffer at the beginning of the workspace                       */
+   else if (method == primme_svds_op_augmented) {
+      cut = resNorm_buffer_size_svds(primme_svds, primme);
+   }
    else {
       cut = 0;
    }
@@ -505,7 +1203,8 @@ static SCALAR* copy_last_params_from_svds(primme_svds_params *primme_svds, int s
          /*       divided by sqrt(2).                                         */
          double ev = (double)svals[i], resnorm = rnorms[i]/sqrt(2.0);
          int isConv=0, ierr=0;
-         primme_svds->stats.elapsedTime = primme_wTimer(0);
+         primme_svds->stats.elapsedTime =
+            primme_get_wtime() - primme_svds->primme.startTime;
          CHKERRMS((primme->convTestFun(&ev, NULL, &resnorm, &isConv, primme,
                      &ierr), ierr), NULL,
                "Error code returned by 'convTestFun' %d", ierr);
@@ -588,11 +1287,18 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
       intWorkSize = primme.intWorkSize;
       realWorkSize = primme.realWorkSize;
       /* If matrixMatvecSVDS is used, it needs extra space to compute A*A' or A'*A */
+      /* unless the user provides matrixMatvecNormal                           */
       if ((primme.matrixMatvec == NULL || primme.matrixMatvec == matrixMatvecSVDS) &&
+          !primme_svds->matrixMatvecNormal &&
           (primme_svds->method == primme_svds_op_AtA || primme_svds->method == primme_svds_op_AAt))
-         realWorkSize += primme.maxBlockSize * sizeof(SCALAR) *
+         realWorkSize += matvec_buffer_cols_svds(primme_svds, &primme) *
+                           sizeof(SCALAR) *
                            (primme_svds->method == primme_svds_op_AtA ?
                               primme_svds->mLocal : primme_svds->nLocal);
+      /* Buffer to check the residual norms of the augmented problem */
+      if (primme_svds->method == primme_svds_op_augmented)
+         realWorkSize += resNorm_buffer_size_svds(primme_svds, &primme) *
+                           sizeof(SCALAR);
    }
 
    /* Require workspace for 2st stage */
@@ -605,7 +1311,8 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
       primme.numOrthoConst += primme.numEvals;
       Sprimme(NULL, NULL, NULL, &primme);
       intWorkSize = max(intWorkSize, primme.intWorkSize);
-      realWorkSize = max(realWorkSize, primme.realWorkSize);
+      realWorkSize = max(realWorkSize, primme.realWorkSize +
+            resNorm_buffer_size_svds(primme_svds, &primme) * sizeof(SCALAR));
    }
 
    if (!allocate) {
@@ -625,7 +1332,7 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
       primme_svds->realWorkSize = realWorkSize;
       if (primme_svds->printLevel >= 5) fprintf(primme_svds->outputFile, 
          "Allocating real workspace: %g bytes\n", (double)primme_svds->realWorkSize);
-      CHKERRMS(MALLOC_PRIMME(realWorkSize, (char**)&primme_svds->realWork),
+      CHKERRMS(Num_malloc_workspace_primme(realWorkSize, &primme_svds->realWork),
             MALLOC_FAILURE, "Failed to allocate %g bytes\n", (double)realWorkSize);
    }
 
@@ -644,6 +1351,25 @@ static int allocate_workspace_svds(primme_svds_params *primme_svds, int allocate
    return 0;
 }
  
+/******************************************************************************
+ * Function shuffle_buffer_svds - return a buffer of n SCALARs to reorder the
+ *    vectors before and after an augmented solve. The shared workspace is
+ *    not in use while svecs is reordered between stages, so it is borrowed
+ *    if it is large enough; otherwise a new buffer is allocated, and the
+ *    caller should free it if it is different from primme_svds->realWork.
+ *
+ ******************************************************************************/
+
+static SCALAR* shuffle_buffer_svds(primme_svds_params *primme_svds, size_t n) {
+   SCALAR *aux;
+
+   if (primme_svds->realWork && primme_svds->realWorkSize >= n*sizeof(SCALAR)) {
+      return (SCALAR*)primme_svds->realWork;
+   }
+   CHKERRS(MALLOC_PRIMME(n, &aux), NULL);
+   return aux;
+}
+
 int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
       REAL *svals, SCALAR *svecs, REAL *rnorms, int allocatedTargetShifts) {
 
@@ -735,13 +1461,14 @@ int copy_last_params_to_svds(primme_svds_params *primme_svds, int stage,
             svecs, 1);
 
       /* Shuffle svecs from [Vc V; Uc U] to [Uc U Vc V] */
-      CHKERRS(MALLOC_PRIMME(primme->nLocal*n, &aux), -1);
+      CHKERRS((aux = shuffle_buffer_svds(primme_svds, primme->nLocal*n))
+            == NULL, -1);
       Num_copy_Sprimme(primme->nLocal*n, svecs, 1, aux, 1);
       Num_copy_matrix_Sprimme(aux, primme_svds->nLocal, n, primme->nLocal,
          &svecs[primme_svds->mLocal*n], primme_svds->nLocal);
       Num_copy_matrix_Sprimme(&aux[primme_svds->nLocal], primme_svds->mLocal, n,
          primme->nLocal, svecs, primme_svds->mLocal);
-      free(aux);
+      if (aux != primme_svds->realWork) free(aux);
 
       /* Normalize every column in U and V */
       CHKERRS(MALLOC_PRIMME(4*n, &norms2_), -1);
@@ -870,6 +1597,8 @@ static int primme_svds_check_input(REAL *svals, SCALAR *svecs, REAL *resNorms,
    else if (resNorms == NULL)
       ret = -19;
    /* Booked -20 and -21*/
+   else if (primme_svds->traceFileName && primme_svds->traceSize <= 0)
+      ret = -22;
 
    return ret;
    /***************************************************************************/
@@ -887,12 +1616,23 @@ static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
    SCALAR *x = (SCALAR*)x_, *y = (SCALAR*)y_;
    primme_svds_operator method = &primme_svds->primme == primme ?
       primme_svds->method : primme_svds->methodStage2;
-   int i, bs;
+   int i, bs, cols = matvec_buffer_cols_svds(primme_svds, primme);
+
+   /* If provided, use the product with A'*A or A*A' in a single call */
+
+   if (primme_svds->matrixMatvecNormal &&
+         (method == primme_svds_op_AtA || method == primme_svds_op_AAt)) {
+      primme_svds->matrixMatvecNormal(x, ldx, y, ldy, blockSize,
+            method == primme_svds_op_AtA ? &notrans : &trans, primme_svds,
+            ierr);
+      count_passes_svds(primme_svds, primme, 1, *blockSize);
+      return;
+   }
 
    switch(method) {
    case primme_svds_op_AtA:
-      for (i=0, bs=min((*blockSize-i), primme->maxBlockSize); bs>0;
-               i+= bs, bs=min((*blockSize-i), primme->maxBlockSize))
+      for (i=0, bs=min((*blockSize-i), cols); bs>0;
+               i+= bs, bs=min((*blockSize-i), cols))
       {
          primme_svds->matrixMatvec(&x[*ldx*i], ldx, primme_svds->realWork,
                &primme_svds->mLocal, &bs, &notrans, primme_svds, ierr);
@@ -900,11 +1640,12 @@ static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
          primme_svds->matrixMatvec(primme_svds->realWork, &primme_svds->mLocal,
             &y[*ldy*i], ldy, &bs, &trans, primme_svds, ierr);
          if (*ierr != 0) return;
+         count_passes_svds(primme_svds, primme, 2, bs);
       }
       break;
    case primme_svds_op_AAt:
-      for (i=0, bs=min((*blockSize-i), primme->maxBlockSize); bs>0;
-               i+= bs, bs=min((*blockSize-i), primme->maxBlockSize))
+      for (i=0, bs=min((*blockSize-i), cols); bs>0;
+               i+= bs, bs=min((*blockSize-i), cols))
       {
          primme_svds->matrixMatvec(&x[*ldx*i], ldx, primme_svds->realWork,
                &primme_svds->nLocal, &bs, &trans, primme_svds, ierr);
@@ -912,21 +1653,109 @@ static void matrixMatvecSVDS(void *x_, PRIMME_INT *ldx, void *y_,
          primme_svds->matrixMatvec(primme_svds->realWork, &primme_svds->nLocal,
             &y[*ldy*i], ldy, &bs, &notrans, primme_svds, ierr);
          if (*ierr != 0) return;
+         count_passes_svds(primme_svds, primme, 2, bs);
       }
       break;
    case primme_svds_op_augmented:
+      /* y = [A'u; Av] for x = [v; u]; every product reads and writes one of */
+      /* the halves, with nLocal and mLocal rows, through the same ldx/ldy   */
       primme_svds->matrixMatvec(&x[primme_svds->nLocal], ldx, y, ldy, blockSize,
             &trans, primme_svds, ierr);
          if (*ierr != 0) return;
       primme_svds->matrixMatvec(x, ldx, &y[primme_svds->nLocal],
          ldy, blockSize, &notrans, primme_svds, ierr);
          if (*ierr != 0) return;
+      count_passes_svds(primme_svds, primme, 2, *blockSize);
       break;
    case primme_svds_op_none:
       break;
    }
 }
 
+/*******************************************************************************
+ * Subroutine matvec_buffer_cols_svds - return the number of columns of the
+ *    buffer that holds A*x or A'*x in matrixMatvecSVDS. With a budget of passes
+ *    over A, the buffer fits a whole basis, so that every product with A'*A
+ *    or A*A' requested by the eigensolver costs only two passes.
+ ******************************************************************************/
+
+static int matvec_buffer_cols_svds(primme_svds_params *primme_svds,
+      primme_params *primme) {
+
+   return primme_svds->maxPasses > 0 ?
+      max(primme->maxBasisSize, primme->maxBlockSize) : primme->maxBlockSize;
+}
+
+/*******************************************************************************
+ * Subroutine resNorm_buffer_size_svds - return the number of SCALARs at the
+ *    beginning of the workspace used by convTestFunAugBlock to check the
+ *    residual norms of up to primme.maxBlockSize triplets at once: a copy of
+ *    the vectors, A'*u and A*v for each one, and the inner products.
+ ******************************************************************************/
+
+static size_t resNorm_buffer_size_svds(primme_svds_params *primme_svds,
+      primme_params *primme) {
+
+   return (size_t)max(1, primme->maxBlockSize) *
+      (2*(size_t)(primme_svds->mLocal + primme_svds->nLocal) + 8);
+}
+
+/*******************************************************************************
+ * Subroutine count_passes_svds - add the passes over A done by a product of
+ *    blockSize vectors. Once the budget is spent, the eigensolver stops at its
+ *    next check of maxMatvecs, as if that limit was reached.
+ ******************************************************************************/
+
+static void count_passes_svds(primme_svds_params *primme_svds,
+      primme_params *primme, int passes, int blockSize) {
+
+   primme_svds->numPasses += passes;
+   if (primme_svds->maxPasses > 0
+         && primme_svds->numPasses >= primme_svds->maxPasses) {
+      primme->maxMatvecs = primme->stats.numMatvecs + blockSize;
+   }
+}
+
+/******************************************************************************
+ * Function prepare_preconditioner_svds - if the stage applies the user
+ *    preconditioner, call preconditionerSetup with the operator of the stage
+ *    and its shifts as singular values (the shifts of A'*A and A*A' in
+ *    primme are squared). Return -1 if preconditionerSetup fails, so the
+ *    stage returns the error code of a failed callback.
+ ******************************************************************************/
+
+static int prepare_preconditioner_svds(primme_svds_params *primme_svds,
+      int stage) {
+
+   primme_params *primme =
+      stage == 0 ? &primme_svds->primme : &primme_svds->primmeStage2;
+   primme_svds_operator method =
+      stage == 0 ? primme_svds->method : primme_svds->methodStage2;
+   primme_svds_prec_event event = primme_svds_prec_prepare;
+   double *shifts;
+   int numShifts, ierr = 0;
+
+   if (!primme_svds->preconditionerSetup
+         || !primme->correctionParams.precondition
+         || primme->applyPreconditioner != applyPreconditionerSVDS
+         || primme->maxMatvecs <= 0) {
+      return 0;
+   }
+
+   if (stage == 0) {
+      shifts = primme_svds->targetShifts;
+      numShifts = primme_svds->numTargetShifts;
+   }
+   else {
+      shifts = primme->targetShifts;
+      numShifts = primme->numTargetShifts;
+   }
+   primme_svds->preconditionerSetup(&event, &method, shifts, &numShifts,
+         primme_svds, &ierr);
+   CHKERRMS(ierr, -1, "Error returned by 'preconditionerSetup' %d", ierr);
+   return 0;
+}
+
 static void applyPreconditionerSVDS(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
 
@@ -976,92 +1805,107 @@ static int globalSum_Rprimme_svds(REAL *sendBuf, REAL *recvBuf, int count,
 }
 
 /*******************************************************************************
- * Subroutine compute_resNorm - This routine computes the residual norm of a
- *    given triplet (u,s,v):
+ * Subroutine compute_resNorm - This routine computes the residual norm of n
+ *    given triplets (u_i,s_i,v_i):
  *
- *    sqrt(||A*v - s*u||^2 + ||A'*u - s*v||^2)
+ *    sqrt(||A*v_i - s_i*u_i||^2 + ||A'*u_i - s_i*v_i||^2)
  *
  * NOTE:
- *    - The given u and v may not have norm one.
- *    - The computation requires two matvecs.
+ *    - The given u_i and v_i may not have norm one.
+ *    - The computation requires a block product with A and another with A',
+ *      and two global sums for all triplets.
  * 
  * INPUT ARRAYS AND PARAMETERS
  * ---------------------------
- * leftsvec     The approximate left singular vector
- * rightsvec    The approximate right singular vector
+ * leftsvecs    The approximate left singular vectors
+ * ldleftsvecs  The leading dimension of leftsvecs
+ * rightsvecs   The approximate right singular vectors
+ * ldrightsvecs The leading dimension of rightsvecs
+ * n            The number of triplets
+ * rwork        Workspace of size n*(mLocal+nLocal+7) SCALARs
  * primme_svds  Structure containing various solver parameters
  *
  * OUTPUT PARAMETERS
  * ----------------------------------
- * rNorm        The norm of the residual vector
+ * rNorms       The norms of the residual vectors
  * ierr         Error code
  ******************************************************************************/
 
-static void compute_resNorm(SCALAR *leftsvec, SCALAR *rightsvec, REAL *rNorm,
-      primme_svds_params *primme_svds, int *ierr) {
+static void compute_resNorm(SCALAR *leftsvecs, PRIMME_INT ldleftsvecs,
+      SCALAR *rightsvecs, PRIMME_INT ldrightsvecs, int n, REAL *rNorms,
+      SCALAR *rwork, primme_svds_params *primme_svds, int *ierr) {
 
-   int one = 1, notrans = 0, trans = 1;
-   PRIMME_INT nLocal = primme_svds->mLocal+primme_svds->nLocal;
-   SCALAR *Atu = (SCALAR*)malloc( sizeof(SCALAR)*nLocal);
-   if (Atu == NULL) {*ierr = 1; return;}
-   SCALAR *Av = &Atu[primme_svds->nLocal];
+   int i, notrans = 0, trans = 1;
+   PRIMME_INT mLocal = primme_svds->mLocal, nLocal = primme_svds->nLocal;
+   SCALAR *Atu = rwork;                   /* nLocal x n */
+   SCALAR *Av = &Atu[nLocal*n];           /* mLocal x n */
+   REAL *ip0 = (REAL*)&Av[mLocal*n];      /* 3 x n */
+   REAL *ip = &ip0[3*n];                  /* 3 x n */
+   REAL *normr0 = &ip[3*n];               /* n */
+   SCALAR *u, *v;
 
    /* Av = A * v; Atu = A'u */
 
-   primme_svds->matrixMatvec(leftsvec, &primme_svds->mLocal, Atu,
-         &primme_svds->mLocal, &one, &trans, primme_svds, ierr);
-   if (*ierr != 0) {free(Atu); return;}
-   primme_svds->stats.numMatvecs++;
-   primme_svds->matrixMatvec(rightsvec, &primme_svds->nLocal, Av,
-         &primme_svds->nLocal, &one, &notrans, primme_svds, ierr);
-   if (*ierr != 0) {free(Atu); return;}
-   primme_svds->stats.numMatvecs++;
-
-   /* ip[0] = ||v|| */
-   /* ip[1] = ||u|| */
-   /* ip[2] = u'*A*v = u'*Av */
-
-   REAL ip0[3], ip[3];
-   ip0[0] = REAL_PART(Num_dot_Sprimme(primme_svds->nLocal, rightsvec, 1,
-            rightsvec, 1));
-   ip0[1] = REAL_PART(Num_dot_Sprimme(primme_svds->mLocal, leftsvec, 1,
-            leftsvec, 1));
-   ip0[2] = REAL_PART(Num_dot_Sprimme(primme_svds->mLocal, leftsvec, 1, Av, 1));
-   *ierr = globalSum_Rprimme_svds(ip0, ip, 3, primme_svds);
-   if (*ierr != 0) {free(Atu); return;}
-
-   ip[0] = sqrt(ip[0]);
-   ip[1] = sqrt(ip[1]);
-   REAL sval = ip[2]/ip[0]/ip[1];
-
-   /* If u'*A*v is negative, set rNorm as a large number */
-
-   if (sval < -0.0) {
-      *rNorm = HUGE_VAL;
-      free(Atu);
-      *ierr = 0;
-      return;
+   primme_svds->matrixMatvec(leftsvecs, &ldleftsvecs, Atu, &nLocal, &n,
+         &trans, primme_svds, ierr);
+   if (*ierr != 0) return;
+   primme_svds->stats.numMatvecs += n;
+   primme_svds->matrixMatvec(rightsvecs, &ldrightsvecs, Av, &mLocal, &n,
+         &notrans, primme_svds, ierr);
+   if (*ierr != 0) return;
+   primme_svds->stats.numMatvecs += n;
+
+   /* ip[i*3+0] = ||v_i|| */
+   /* ip[i*3+1] = ||u_i|| */
+   /* ip[i*3+2] = u_i'*A*v_i = u_i'*Av_i */
+
+   for (i=0; i < n; i++) {
+      u = &leftsvecs[ldleftsvecs*i];
+      v = &rightsvecs[ldrightsvecs*i];
+      ip0[i*3+0] = REAL_PART(Num_dot_Sprimme(nLocal, v, 1, v, 1));
+      ip0[i*3+1] = REAL_PART(Num_dot_Sprimme(mLocal, u, 1, u, 1));
+      ip0[i*3+2] = REAL_PART(Num_dot_Sprimme(mLocal, u, 1, &Av[mLocal*i], 1));
    }
+   *ierr = globalSum_Rprimme_svds(ip0, ip, 3*n, primme_svds);
+   if (*ierr != 0) return;
 
-   /* Atu = A'*u/||u|| - sval*v/||v|| */
+   for (i=0; i < n; i++) {
+      u = &leftsvecs[ldleftsvecs*i];
+      v = &rightsvecs[ldrightsvecs*i];
+      REAL nv = sqrt(ip[i*3+0]), nu = sqrt(ip[i*3+1]);
+      REAL sval = ip[i*3+2]/nv/nu;
 
-   Num_scal_Sprimme(primme_svds->nLocal, 1.0/ip[1], Atu, 1);
-   Num_axpy_Sprimme(primme_svds->nLocal, -sval/ip[0], rightsvec, 1, Atu, 1);
+      /* If u'*A*v is negative, set rNorm as a large number */
 
-   /* Av = A*v/||v|| - sval*u/||u|| */
+      if (sval < -0.0) {
+         normr0[i] = 0.0;
+         continue;
+      }
 
-   Num_scal_Sprimme(primme_svds->mLocal, 1.0/ip[0], Av, 1);
-   Num_axpy_Sprimme(primme_svds->mLocal, -sval/ip[1], leftsvec, 1, Av, 1);
+      /* Atu = A'*u/||u|| - sval*v/||v|| */
 
-   /* resNorm = sqrt(||A*v - s*u||^2 + ||A'*u - s*v||^2) = norm([Atu; Av]) */
+      Num_scal_Sprimme(nLocal, 1.0/nu, &Atu[nLocal*i], 1);
+      Num_axpy_Sprimme(nLocal, -sval/nv, v, 1, &Atu[nLocal*i], 1);
 
-   REAL normr0;
-   normr0 = REAL_PART(Num_dot_Sprimme(nLocal, Atu, 1, Atu, 1));
-   *ierr = globalSum_Rprimme_svds(&normr0, rNorm, 1, primme_svds);
-   if (*ierr != 0) {free(Atu); return;}
-   *rNorm = sqrt(*rNorm);
+      /* Av = A*v/||v|| - sval*u/||u|| */
+
+      Num_scal_Sprimme(mLocal, 1.0/nv, &Av[mLocal*i], 1);
+      Num_axpy_Sprimme(mLocal, -sval/nu, u, 1, &Av[mLocal*i], 1);
+
+      /* resNorm = sqrt(||A*v - s*u||^2 + ||A'*u - s*v||^2) */
+
+      normr0[i] = REAL_PART(Num_dot_Sprimme(nLocal, &Atu[nLocal*i], 1,
+                  &Atu[nLocal*i], 1))
+         + REAL_PART(Num_dot_Sprimme(mLocal, &Av[mLocal*i], 1,
+                  &Av[mLocal*i], 1));
+   }
+   *ierr = globalSum_Rprimme_svds(normr0, rNorms, n, primme_svds);
+   if (*ierr != 0) return;
+
+   for (i=0; i < n; i++) {
+      rNorms[i] = ip[i*3+2] < -0.0 ? HUGE_VAL : sqrt(rNorms[i]);
+   }
 
-   free(Atu);
    *ierr = 0;
 }
 
@@ -1105,7 +1949,9 @@ static void default_convTestFun(double *sval, void *leftsvec_, void *rightsvec_,
             || primme_svds->methodStage2 == primme_svds_op_augmented)) {
 
       REAL rnorm;
-      compute_resNorm(leftsvec, rightsvec, &rnorm, primme_svds, ierr);
+      compute_resNorm(leftsvec, primme_svds->mLocal, rightsvec,
+            primme_svds->nLocal, 1, &rnorm, (SCALAR*)primme_svds->realWork,
+            primme_svds, ierr);
       if (*ierr != 0) return;
 
       *isConv = rnorm < max(primme_svds->eps, machEps * 3.16) * aNorm;
@@ -1223,6 +2069,77 @@ static void convTestFunAug(double *eval, void *evec, double *rNorm, int *isConv,
 }
 
 
+/*******************************************************************************
+ * Subroutine convTestFunAugBlock - This routine implements primme_params.
+ *    convTestFunBlock when solving augmented problem with the default
+ *    convergence criterion. The triplets that pass the criterion with the
+ *    residual norm of the augmented problem are rechecked together with
+ *    the actual residual norms, as default_convTestFun does for one triplet.
+ *
+ * INPUT ARRAYS AND PARAMETERS
+ * ---------------------------
+ * evals        The approximate eigenvalues
+ * evecs        The approximate eigenvectors
+ * ldevecs      The leading dimension of evecs
+ * rNorms       The norms of the residual vectors
+ * blockSize    The number of pairs
+ * primme       Structure containing various solver parameters
+ *
+ * INPUT/OUTPUT PARAMETERS
+ * ----------------------------------
+ * isConv      on input, the pairs with nonzero are skipped; on output, if it
+ *             isn't zero the approximate pair is marked as converged
+ ******************************************************************************/
+
+static void convTestFunAugBlock(void *evals, void *evecs_, PRIMME_INT *ldevecs,
+   void *rNorms_, int *isConv, int *blockSize, primme_params *primme,
+   int *ierr) {
+
+   (void)evals; /* unused parameter */
+   primme_svds_params *primme_svds = (primme_svds_params *) primme->matrix;
+   SCALAR *evecs = (SCALAR*)evecs_;
+   REAL *rNorms = (REAL*)rNorms_;
+   double aNorm = primme_svds->aNorm > 0.0 ? primme_svds->aNorm :
+      (primme->aNorm > 0.0 ? primme->aNorm : primme->stats.estimateLargestSVal);
+   double tol = max(primme_svds->eps, MACHINE_EPSILON * 3.16) * aNorm;
+   PRIMME_INT nLocal = primme_svds->nLocal;
+   PRIMME_INT ldX = primme_svds->mLocal + nLocal;
+   int maxCols = max(1, primme->maxBlockSize);
+   SCALAR *X = (SCALAR*)primme_svds->realWork;     /* [v; u] copies */
+   SCALAR *rwork = &X[ldX*maxCols];
+   REAL *rnorms = (REAL*)&rwork[(ldX+7)*maxCols];
+   int i, j, k;
+
+   /* Copy the candidates into X in chunks of maxCols and check them with */
+   /* block products with A and A'                                        */
+
+   for (i=0; i < *blockSize; ) {
+      int i0 = i;
+      for (k=0; i < *blockSize && k < maxCols; i++) {
+         if (isConv[i]) {
+            isConv[i] = -1;
+            continue;
+         }
+         isConv[i] = rNorms[i]/sqrt(2.0) < tol;
+         if (isConv[i]) {
+            Num_copy_Sprimme(ldX, &evecs[*ldevecs*i], 1, &X[ldX*k++], 1);
+         }
+      }
+      if (k > 0) {
+         compute_resNorm(&X[nLocal], ldX, X, ldX, k, rnorms, rwork,
+               primme_svds, ierr);
+         if (*ierr != 0) return;
+      }
+      for (j=i0, k=0; j < i; j++) {
+         if (isConv[j] == 1) isConv[j] = rnorms[k++] < tol;
+         else if (isConv[j] == -1) isConv[j] = 1;
+      }
+   }
+
+   *ierr = 0;
+}
+
+
 /*******************************************************************************
  * Subroutine default_monitor - report iterations, #MV, residual norm,
  *    singular values, etc. at every inner/outer iteration and when some triplet
@@ -130,6 +130,14 @@ void primme_svds_initialize(primme_svds_params *primme_svds) {
    primme_svds->convtest                = NULL;
    primme_svds->monitorFun              = NULL;
    primme_svds->monitor                 = NULL;
+   primme_svds->matrixMatvecNormal      = NULL;
+   primme_svds->preconditionerSetup     = NULL;
+   primme_svds->rangeFinderPasses       = 0;
+   primme_svds->maxPasses               = 0;
+   primme_svds->numPasses               = 0;
+   primme_svds->traceFileName           = NULL;
+   primme_svds->traceSize               = 65536;
+   primme_svds->dynamicMethodSwitch     = 0;
 
    primme_initialize(&primme_svds->primme);
    primme_initialize(&primme_svds->primmeStage2);
@@ -144,7 +152,8 @@ void primme_svds_initialize(primme_svds_params *primme_svds) {
  * ----------------
  *    method   singular value method, one of:
  *
- *       primme_svds_default, currently set as primme_svds_hybrid.
+ *       primme_svds_default, primme_svds_hybrid choosing A'*A or A*A', or
+ *          primme_svds_augmented, from the costs measured by Sprimme_svds.
  *       primme_svds_normalequations, compute the eigenvectors of A'*A or A*A'.
  *       primme_svds_augmented|, compute the eigenvectors of the augmented
  *          matrix, [zeros() A'; A zeros()].
@@ -168,6 +177,7 @@ int primme_svds_set_method(primme_svds_preset_method method,
       primme_svds_params *primme_svds) {
 
    /* Set method and methodStage2 in primme_svds_params */
+   primme_svds->dynamicMethodSwitch = (method == primme_svds_default);
    switch(method) {
    case primme_svds_default:
    case primme_svds_hybrid:
@@ -275,6 +285,9 @@ static void copy_params_from_svds(primme_svds_params *primme_svds, int stage) {
       primme->maxBasisSize = primme_svds->maxBasisSize;
    if (primme_svds->maxBlockSize > 0)
       primme->maxBlockSize = primme_svds->maxBlockSize;
+   else if (primme_svds->maxPasses > 0)
+      /* Passes over A are expensive; expand for all wanted values at once */
+      primme->maxBlockSize = max(primme->maxBlockSize, primme_svds->numSvals);
    primme->maxMatvecs = primme_svds->maxMatvecs;
    primme->printLevel = primme_svds->printLevel;
    primme->outputFile = primme_svds->outputFile;
@@ -394,6 +407,7 @@ fprintf(outputFile, "// ---------------------------------------------------\n"
    PRINT(maxBasisSize, %d);
    PRINT(maxBlockSize, %d);
    PRINT_PRIMME_INT(maxMatvecs);
+   PRINT_PRIMME_INT(maxPasses);
 
    PRINTIF(target, primme_svds_smallest);
    PRINTIF(target, primme_svds_largest);
@@ -411,6 +425,10 @@ fprintf(outputFile, "// ---------------------------------------------------\n"
    PRINT(locking, %d);
    PRINT(initSize, %d);
    PRINT(numOrthoConst, %d);
+   PRINT(rangeFinderPasses, %d);
+   if (primme_svds.traceFileName) PRINT(traceFileName, %s);
+   PRINT(traceSize, %d);
+   PRINT(dynamicMethodSwitch, %d);
    fprintf(outputFile, "primme_svds.iseed =");
    for (i=0; i<4;i++) {
       fprintf(outputFile, " %" PRIMME_INT_P, primme_svds.iseed[i]);
@@ -462,6 +480,16 @@ fprintf(outputFile, "// ---------------------------------------------------\n"
 
 void primme_svds_free(primme_svds_params *primme) {
     
+   /* Let the user release the preconditioner built by preconditionerSetup */
+
+   if (primme->preconditionerSetup) {
+      primme_svds_prec_event event = primme_svds_prec_release;
+      primme_svds_operator method = primme_svds_op_none;
+      int numShifts = 0, ierr = 0;
+      primme->preconditionerSetup(&event, &method, NULL, &numShifts, primme,
+            &ierr);
+   }
+
    free(primme->intWork);
    free(primme->realWork);
    primme->intWorkSize  = 0;
@@ -520,6 +548,9 @@ int primme_svds_get_member(primme_svds_params *primme_svds,
             void *lockedSvals, int *numLocked, int *lockedFlags, void *lockedNorms,
             int *inner_its, void *LSRes, primme_event *event, int *stage,
             struct primme_svds_params *primme_svds, int *err);
+      void (*preconditionerSetup_v)(primme_svds_prec_event *event,
+            primme_svds_operator *method, double *shifts, int *numShifts,
+            struct primme_svds_params *primme_svds, int *ierr);
    } *v = (union value_t*)value;
 
    switch(label) {
@@ -683,6 +714,30 @@ int primme_svds_get_member(primme_svds_params *primme_svds,
       case PRIMME_SVDS_monitor:
          v->ptr_v = primme_svds->monitor;
          break;
+      case PRIMME_SVDS_matrixMatvecNormal:
+         v->matFunc_v = primme_svds->matrixMatvecNormal;
+         break;
+      case PRIMME_SVDS_preconditionerSetup:
+         v->preconditionerSetup_v = primme_svds->preconditionerSetup;
+         break;
+      case PRIMME_SVDS_rangeFinderPasses:
+         v->int_v = primme_svds->rangeFinderPasses;
+         break;
+      case PRIMME_SVDS_maxPasses:
+         v->int_v = primme_svds->maxPasses;
+         break;
+      case PRIMME_SVDS_numPasses:
+         v->int_v = primme_svds->numPasses;
+         break;
+      case PRIMME_SVDS_traceFileName:
+         v->ptr_v = primme_svds->traceFileName;
+         break;
+      case PRIMME_SVDS_traceSize:
+         v->int_v = primme_svds->traceSize;
+         break;
+      case PRIMME_SVDS_dynamicMethodSwitch:
+         v->int_v = primme_svds->dynamicMethodSwitch;
+         break;
       default:
          return 1;
    }
@@ -728,6 +783,9 @@ int primme_svds_set_member(primme_svds_params *primme_svds,
             void *lockedSvals, int *numLocked, int *lockedFlags, void *lockedNorms,
             int *inner_its, void *LSRes, primme_event *event, int *stage,
             struct primme_svds_params *primme_svds, int *err);
+      void (*preconditionerSetup_v)(primme_svds_prec_event *event,
+            primme_svds_operator *method, double *shifts, int *numShifts,
+            struct primme_svds_params *primme_svds, int *ierr);
 
    } v = *(union value_t*)&value;
 
@@ -899,6 +957,33 @@ int primme_svds_set_member(primme_svds_params *primme_svds,
       case PRIMME_SVDS_monitor:
          primme_svds->monitor = v.ptr_v;
          break;
+      case PRIMME_SVDS_matrixMatvecNormal:
+         primme_svds->matrixMatvecNormal = v.matFunc_v;
+         break;
+      case PRIMME_SVDS_preconditionerSetup:
+         primme_svds->preconditionerSetup = v.preconditionerSetup_v;
+         break;
+      case PRIMME_SVDS_rangeFinderPasses:
+         if (*v.int_v > INT_MAX) return 1; else 
+         primme_svds->rangeFinderPasses = (int)*v.int_v;
+         break;
+      case PRIMME_SVDS_maxPasses:
+         primme_svds->maxPasses = *v.int_v;
+         break;
+      case PRIMME_SVDS_numPasses:
+         primme_svds->numPasses = *v.int_v;
+         break;
+      case PRIMME_SVDS_traceFileName:
+         primme_svds->traceFileName = (char*)v.ptr_v;
+         break;
+      case PRIMME_SVDS_traceSize:
+         if (*v.int_v > INT_MAX) return 1; else 
+         primme_svds->traceSize = (int)*v.int_v;
+         break;
+      case PRIMME_SVDS_dynamicMethodSwitch:
+         if (*v.int_v > INT_MAX) return 1; else 
+         primme_svds->dynamicMethodSwitch = (int)*v.int_v;
+         break;
       default:
          return 1;
    }
@@ -997,6 +1082,14 @@ int primme_svds_member_info(primme_svds_params_label *label_,
    IF_IS(convtest);
    IF_IS(monitorFun);
    IF_IS(monitor);
+   IF_IS(matrixMatvecNormal);
+   IF_IS(rangeFinderPasses);
+   IF_IS(maxPasses);
+   IF_IS(numPasses);
+   IF_IS(traceFileName);
+   IF_IS(traceSize);
+   IF_IS(dynamicMethodSwitch);
+   IF_IS(preconditionerSetup);
 #undef IF_IS
 
    /* Return label/label_name */
@@ -1023,6 +1116,11 @@ int primme_svds_member_info(primme_svds_params_label *label_,
       case PRIMME_SVDS_maxBlockSize:
       case PRIMME_SVDS_maxMatvecs:
       case PRIMME_SVDS_printLevel:
+      case PRIMME_SVDS_rangeFinderPasses:
+      case PRIMME_SVDS_maxPasses:
+      case PRIMME_SVDS_numPasses:
+      case PRIMME_SVDS_traceSize:
+      case PRIMME_SVDS_dynamicMethodSwitch:
       case PRIMME_SVDS_stats_numOuterIterations:
       case PRIMME_SVDS_stats_numRestarts:
       case PRIMME_SVDS_stats_numMatvecs:
@@ -1077,6 +1175,9 @@ int primme_svds_member_info(primme_svds_params_label *label_,
       case PRIMME_SVDS_convtest:
       case PRIMME_SVDS_monitorFun:
       case PRIMME_SVDS_monitor:
+      case PRIMME_SVDS_matrixMatvecNormal:
+      case PRIMME_SVDS_traceFileName:
+      case PRIMME_SVDS_preconditionerSetup:
       if (type) *type = primme_pointer;
       if (arity) *arity = 1;
       break;
@@ -1126,6 +1227,11 @@ int primme_svds_constant_info(const char* label_name, int *value) {
    IF_IS(primme_svds_op_AtA);
    IF_IS(primme_svds_op_AAt);
    IF_IS(primme_svds_op_augmented);
+
+   /* enum members for preconditionerSetup */
+
+   IF_IS(primme_svds_prec_prepare);
+   IF_IS(primme_svds_prec_release);
 #undef IF_IS
 
    /* return error if label not found */
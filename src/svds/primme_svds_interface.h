@@ -41,5 +41,6 @@
 
 void primme_svds_set_defaults(primme_svds_params *primme_svds);
 #define Sprimme_svds CONCAT(SCALAR_PRE,primme_svds)
+#define Sprimme_svds_update CONCAT(SCALAR_PRE,primme_svds_update)
 
 #endif
@@ -32,11 +32,17 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "mmio.h"
 #include "primme.h"
 #include "csr.h"
 
 static int readfullMTX(const char *mtfile, SCALAR **A, int **JA, int **IA, int *m, int *n, int *nnz);
+static int mapCSRCache(const char *mtfile, CSRMatrix *matrix);
+static void writeCSRCache(const char *mtfile, const CSRMatrix *matrix);
+static int generateMatrix(const char *spec, SCALAR **AA, int **JA, int **IA, int *n, int *nnz);
 #ifndef USE_DOUBLECOMPLEX
 static int readUpperMTX(const char *mtfile, double **A, int **JA, int **IA, int *n, int *nnz);
 int ssrcsr(int *job, int *value2, int *nrow, double *a, int *ja, int *ia, 
@@ -47,15 +53,28 @@ int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fn
    int ret;
    CSRMatrix *matrix;
 
-   matrix = (CSRMatrix*)primme_calloc(1, sizeof(CSRMatrix), "CSRMatrix");
-   if (!strcmp("mtx", &matrixFileName[strlen(matrixFileName)-3])) {  
-      /* coordinate format storing both lower and upper triangular parts */
-      ret = readfullMTX(matrixFileName, &matrix->AElts, &matrix->JA, 
-         &matrix->IA, &matrix->m, &matrix->n, &matrix->nnz);
+   matrix = (CSRMatrix*)calloc(1, sizeof(CSRMatrix));
+   if (!strncmp("gen:", matrixFileName, 4)) {
+      /* matrix generated in memory */
+      ret = generateMatrix(&matrixFileName[4], &matrix->AElts, &matrix->JA,
+         &matrix->IA, &matrix->n, &matrix->nnz);
       if (ret < 0) {
-         fprintf(stderr, "ERROR: Could not read matrix file\n");
+         fprintf(stderr, "ERROR: Could not generate matrix '%s'\n", matrixFileName);
          return(-1);
       }
+      matrix->m = matrix->n;
+   }
+   else if (!strcmp("mtx", &matrixFileName[strlen(matrixFileName)-3])) {  
+      /* coordinate format storing both lower and upper triangular parts */
+      if (mapCSRCache(matrixFileName, matrix) != 0) {
+         ret = readfullMTX(matrixFileName, &matrix->AElts, &matrix->JA, 
+            &matrix->IA, &matrix->m, &matrix->n, &matrix->nnz);
+         if (ret < 0) {
+            fprintf(stderr, "ERROR: Could not read matrix file\n");
+            return(-1);
+         }
+         writeCSRCache(matrixFileName, matrix);
+      }
    }
    else if (matrixFileName[strlen(matrixFileName)-1] == 'U') {
       /* coordinate format storing only upper triangular part */
@@ -87,19 +106,118 @@ int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fn
    return 0;
 }
 
-static int *my_comp_ctx[2];
-static int my_comp(const void *a, const void *b)
-{
-   const int ia = *(int*)a, ib = *(int*)b;
-   int **p = my_comp_ctx;
-   return p[0][ia] != p[0][ib] ? p[0][ia] - p[0][ib] : p[1][ia] - p[1][ib];
+/******************************************************************************
+ * Reads a Matrix Market coordinate file into CSR. The file is mapped in memory
+ * and split in chunks at line boundaries; the lines of all chunks are counted
+ * and then parsed in parallel, every chunk writing its entries at its own
+ * offset. The COO entries are sorted by rows with a counting sort, and every
+ * row is sorted by columns independently. The loops run with OpenMP threads
+ * if the driver is compiled with USE_OPENMP=yes.
+ *
+******************************************************************************/
+
+#define MTX_CHUNK_SIZE (1<<22)
+
+static const char *nextLine(const char *p, const char *end) {
+   while (p < end && *p != '\n') p++;
+   return p < end ? p+1 : end;
+}
+
+static int isEntryLine(const char *p, const char *end) {
+   while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+   return p < end && *p != '\n' && *p != '%';
+}
+
+/* Copy the next word in the line into buf; return the position after it */
+
+static const char *nextWord(const char *p, const char *end, char *buf,
+      int size) {
+   int l = 0;
+   while (p < end && (*p == ' ' || *p == '\t')) p++;
+   while (p < end && l < size-1 && *p != ' ' && *p != '\t' && *p != '\r'
+         && *p != '\n') {
+      buf[l++] = *p++;
+   }
+   buf[l] = '\0';
+   return p;
+}
+
+static int parseMTXEntry(const char *p, const char *end, MM_typecode type,
+      int m, int n, int *I, int *J, SCALAR *A) {
+   char buf[64], *e;
+   double re, im = 0.0;
+
+   p = nextWord(p, end, buf, 64);
+   *I = (int)strtol(buf, &e, 10);
+   if (e == buf || *I < 1 || *I > m) return -1;
+   p = nextWord(p, end, buf, 64);
+   *J = (int)strtol(buf, &e, 10);
+   if (e == buf || *J < 1 || *J > n) return -1;
+   if (mm_is_pattern(type)) {
+      *A = 1.0;
+      return 0;
+   }
+   p = nextWord(p, end, buf, 64);
+   re = strtod(buf, &e);
+   if (e == buf) return -1;
+   if (mm_is_complex(type)) {
+      p = nextWord(p, end, buf, 64);
+      im = strtod(buf, &e);
+      if (e == buf) return -1;
+   }
+   if (mm_is_real(type) || mm_is_integer(type)) *A = re;
+   else *A = re + IMAGINARY*im;
+   return 0;
+}
+
+static void sortRow(int *JA, SCALAR *A, int len) {
+   int i, j, ja;
+   SCALAR a;
+
+   for (i=1; i<len; i++) {
+      ja = JA[i];
+      a = A[i];
+      for (j=i; j>0 && JA[j-1] > ja; j--) {
+         JA[j] = JA[j-1];
+         A[j] = A[j-1];
+      }
+      JA[j] = ja;
+      A[j] = a;
+   }
+}
+
+typedef struct {
+   int j;
+   SCALAR a;
+} RowEntry;
+
+static int compareRowEntries(const void *a, const void *b) {
+   return ((const RowEntry*)a)->j - ((const RowEntry*)b)->j;
+}
+
+static void sortLongRow(int *JA, SCALAR *A, int len) {
+   int i;
+   RowEntry *row = (RowEntry *)malloc(sizeof(RowEntry)*len);
+
+   for (i=0; i<len; i++) {
+      row[i].j = JA[i];
+      row[i].a = A[i];
+   }
+   qsort(row, len, sizeof(RowEntry), compareRowEntries);
+   for (i=0; i<len; i++) {
+      JA[i] = row[i].j;
+      A[i] = row[i].a;
+   }
+   free(row);
 }
 
 static int readfullMTX(const char *mtfile, SCALAR **AA, int **JA, int **IA, int *m, int *n, int *nnz) { 
-   int i,j, k, nzmax;
-   int *I, *J, *perm;
+   int i, c, nchunks, err = 0, *I, *J, *pos;
+   size_t k, nzmax, mapSize, offset;
+   size_t *chunkNnz;
+   const char **chunkBegin, *data, *end;
+   void *map;
    SCALAR *A;
-   double re, im;
    FILE *matrixFile;
    MM_typecode type;
 
@@ -123,54 +241,329 @@ static int readfullMTX(const char *mtfile, SCALAR **AA, int **JA, int **IA, int
 
    if (mm_read_mtx_crd_size(matrixFile, m, n, nnz) != 0) return -1;
 
-   nzmax = *nnz;
+   /* Map the entries */
+   offset = (size_t)ftell(matrixFile);
+   fseek(matrixFile, 0, SEEK_END);
+   mapSize = (size_t)ftell(matrixFile);
+   map = mapSize > offset ? mmap(NULL, mapSize, PROT_READ, MAP_PRIVATE,
+         fileno(matrixFile), 0) : NULL;
+   fclose(matrixFile);
+   if (map == MAP_FAILED) return -1;
+   data = map ? (const char*)map + offset : NULL;
+   end = map ? (const char*)map + mapSize : NULL;
+
+   nzmax = (size_t)*nnz;
    if (mm_is_symmetric(type) || mm_is_hermitian(type) || mm_is_skew(type)) nzmax *= 2;
    A = (SCALAR *)primme_calloc(nzmax, sizeof(SCALAR), "A");
    J = (int *)primme_calloc(nzmax, sizeof(int), "J");
    I = (int *)primme_calloc(nzmax, sizeof(int), "I");
 
+   /* Split the entries in chunks starting at the beginning of a line */
+   nchunks = (int)((end - data)/MTX_CHUNK_SIZE + 1);
+   chunkBegin = (const char **)primme_calloc(nchunks+1, sizeof(char*), "chunks");
+   chunkNnz = (size_t *)calloc(nchunks+1, sizeof(size_t));
+   chunkBegin[0] = data;
+   for (c=1; c<nchunks; c++) {
+      chunkBegin[c] = nextLine(data + (end-data)/nchunks*c - 1, end);
+   }
+   chunkBegin[nchunks] = end;
+
+   /* Count the entries in every chunk */
+   OMP_PRAGMA(omp parallel for schedule(dynamic))
+   for (c=0; c<nchunks; c++) {
+      const char *p;
+      size_t l = 0;
+      for (p=chunkBegin[c]; p<chunkBegin[c+1]; p=nextLine(p, end)) {
+         if (isEntryLine(p, end)) l++;
+      }
+      chunkNnz[c+1] = l;
+   }
+   for (c=0; c<nchunks; c++) chunkNnz[c+1] += chunkNnz[c];
+   if (chunkNnz[nchunks] != (size_t)*nnz) err = 1;
+
    /* Read matrix in COO */
-   im = 0.0;
-   for (k=0, i=0; k<*nnz; k++, i++) {
-      if (mm_read_mtx_crd_entry(matrixFile, &I[i], &J[i], &re, &im, type)!=0) return -1;
-      if (mm_is_pattern(type)) A[i] = 1;
-      else if (mm_is_real(type)) A[i] = re;
-      else A[i] = re + IMAGINARY*im;
-      if (I[i] != J[i]) {
-         if ((mm_is_symmetric(type) || mm_is_hermitian(type))) {
-            I[i+1] = J[i]; J[i+1] = I[i]; A[i+1] = CONJ(A[i]); i++;
-         }
-         else if (mm_is_skew(type)) {
-            I[i+1] = J[i]; J[i+1] = I[i]; A[i+1] = -A[i]; i++;
+   if (!err) {
+      OMP_PRAGMA(omp parallel for schedule(dynamic) reduction(+:err))
+      for (c=0; c<nchunks; c++) {
+         const char *p;
+         size_t l = chunkNnz[c];
+         for (p=chunkBegin[c]; p<chunkBegin[c+1]; p=nextLine(p, end)) {
+            if (!isEntryLine(p, end)) continue;
+            if (parseMTXEntry(p, end, type, *m, *n, &I[l], &J[l], &A[l]) != 0) {
+               err++;
+               break;
+            }
+            l++;
          }
       }
    }
-   nzmax = *nnz = i;
+   free(chunkBegin);
+   free(chunkNnz);
+   if (map) munmap(map, mapSize);
+   if (err) {
+      free(A); free(J); free(I);
+      return -1;
+   }
 
-   /* Sort COO by columns */
-   perm = (int *)primme_calloc(nzmax, sizeof(int), "perm");
-   for (i=0; i<nzmax; i++) perm[i] = i;
-   my_comp_ctx[0] = I;
-   my_comp_ctx[1] = J;
-   qsort(perm, nzmax, sizeof(int), my_comp);
+   /* Add the entries of the other triangular part */
+   if (mm_is_symmetric(type) || mm_is_hermitian(type) || mm_is_skew(type)) {
+      for (k=0, nzmax=(size_t)*nnz; k<(size_t)*nnz; k++) {
+         if (I[k] == J[k]) continue;
+         I[nzmax] = J[k];
+         J[nzmax] = I[k];
+         A[nzmax] = mm_is_skew(type) ? -A[k] : CONJ(A[k]);
+         nzmax++;
+      }
+   }
+   else {
+      nzmax = (size_t)*nnz;
+   }
+   if (nzmax > 2147483647) {
+      free(A); free(J); free(I);
+      return -1;
+   }
+   *nnz = (int)nzmax;
 
-   /* Collapse columns */
-   *IA = (int *)primme_calloc(*m+1, sizeof(int), "IA");
+   /* Sort COO by rows */
+   *IA = (int *)calloc(*m+1, sizeof(int));
+   for (k=0; k<nzmax; k++) (*IA)[I[k]]++;
    (*IA)[0] = 1;
-   for (i=0, j=1; i<nzmax; i++)
-      while (j < I[perm[i]]) (*IA)[j++] = i+1;
-   while (j <= *m) (*IA)[j++] = nzmax+1;
-
-   /* Copy rows and values sorted */
-   *JA = I;
-   for (i=0; i<nzmax; i++) (*JA)[i] = J[perm[i]];
-   free(J);
+   for (i=0; i<*m; i++) (*IA)[i+1] += (*IA)[i];
+   pos = (int *)primme_calloc(*m, sizeof(int), "pos");
+   for (i=0; i<*m; i++) pos[i] = (*IA)[i]-1;
+   *JA = (int *)primme_calloc(nzmax, sizeof(int), "JA");
    *AA = (SCALAR *)primme_calloc(nzmax, sizeof(SCALAR), "AA");
-   for (i=0; i<nzmax; i++) (*AA)[i] = A[perm[i]];
+   for (k=0; k<nzmax; k++) {
+      int p = pos[I[k]-1]++;
+      (*JA)[p] = J[k];
+      (*AA)[p] = A[k];
+   }
+   free(pos);
+   free(I);
+   free(J);
    free(A);
-   free(perm);
 
-   fclose(matrixFile);
+   /* Sort every row by columns */
+   OMP_PRAGMA(omp parallel for schedule(dynamic, 1024))
+   for (i=0; i<*m; i++) {
+      int k0 = (*IA)[i]-1, len = (*IA)[i+1]-(*IA)[i];
+      if (len <= 32) sortRow(&(*JA)[k0], &(*AA)[k0], len);
+      else sortLongRow(&(*JA)[k0], &(*AA)[k0], len);
+   }
+
+   return 0;
+}
+
+/******************************************************************************
+ * Binary cache of a matrix read from a Matrix Market file, stored in the file
+ * name followed by ".dcsr" (".zcsr" in complex). It has a header and then IA,
+ * JA and AElts as in CSRMatrix, with AElts aligned to 16 bytes. If the cache
+ * corresponds to the current MTX file, it is mapped in memory (copy on
+ * write, so the matrix may still be shifted) instead of reading the file;
+ * otherwise it is written after reading the file. The cache is written in a
+ * temporary file that is renamed at the end, so that concurrent runs never
+ * see it partially written. Failing to write the cache is not an error.
+ *
+******************************************************************************/
+
+typedef struct {
+   char magic[8];          /* "PRIMMECS" */
+   int scalarSize;         /* sizeof(SCALAR) */
+   int m, n, nnz;
+   long long mtxSize;      /* size in bytes of the MTX file */
+   long long mtxTime;      /* modification time of the MTX file in ns */
+} CSRCacheHeader;
+
+static void cacheFileName(const char *mtfile, char *cacheFile, size_t size) {
+#ifndef USE_DOUBLECOMPLEX
+   snprintf(cacheFile, size, "%s.dcsr", mtfile);
+#else
+   snprintf(cacheFile, size, "%s.zcsr", mtfile);
+#endif
+}
+
+static size_t cacheOffsetAElts(int m, int nnz) {
+   size_t offset = sizeof(CSRCacheHeader) + sizeof(int)*((size_t)m+1+nnz);
+   return (offset + 15)/16*16;
+}
+
+static void setCacheHeader(const struct stat *st, CSRCacheHeader *h) {
+   memset(h, 0, sizeof(*h));
+   memcpy(h->magic, "PRIMMECS", 8);
+   h->scalarSize = (int)sizeof(SCALAR);
+   h->mtxSize = (long long)st->st_size;
+   h->mtxTime = (long long)st->st_mtim.tv_sec*1000000000LL
+      + st->st_mtim.tv_nsec;
+}
+
+static int mapCSRCache(const char *mtfile, CSRMatrix *matrix) {
+   char cacheFile[1024];
+   struct stat st, stCache;
+   CSRCacheHeader h, expected;
+   size_t mapSize;
+   void *map;
+   int fd;
+
+   cacheFileName(mtfile, cacheFile, sizeof(cacheFile));
+   if (stat(mtfile, &st) != 0) return -1;
+   fd = open(cacheFile, O_RDONLY);
+   if (fd < 0) return -1;
+   setCacheHeader(&st, &expected);
+   if (fstat(fd, &stCache) != 0
+         || read(fd, &h, sizeof(h)) != (ssize_t)sizeof(h)
+         || memcmp(h.magic, expected.magic, 8) != 0
+         || h.scalarSize != expected.scalarSize
+         || h.mtxSize != expected.mtxSize || h.mtxTime != expected.mtxTime
+         || h.m < 0 || h.n < 0 || h.nnz < 0) {
+      close(fd);
+      return -1;
+   }
+   mapSize = cacheOffsetAElts(h.m, h.nnz) + sizeof(SCALAR)*(size_t)h.nnz;
+   if ((size_t)stCache.st_size != mapSize) {
+      close(fd);
+      return -1;
+   }
+   map = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED) return -1;
+
+   matrix->m = h.m;
+   matrix->n = h.n;
+   matrix->nnz = h.nnz;
+   matrix->IA = (int *)((char*)map + sizeof(CSRCacheHeader));
+   matrix->JA = matrix->IA + h.m + 1;
+   matrix->AElts = (SCALAR *)((char*)map + cacheOffsetAElts(h.m, h.nnz));
+   matrix->map = map;
+   matrix->mapSize = mapSize;
+   return 0;
+}
+
+static void writeCSRCache(const char *mtfile, const CSRMatrix *matrix) {
+   char cacheFile[1024], tmpFile[1040];
+   static const char zeros[16] = {0};
+   struct stat st;
+   CSRCacheHeader h;
+   size_t offset;
+   FILE *f;
+   int fd, ok;
+
+   cacheFileName(mtfile, cacheFile, sizeof(cacheFile));
+   snprintf(tmpFile, sizeof(tmpFile), "%s.XXXXXX", cacheFile);
+   if (stat(mtfile, &st) != 0) return;
+   fd = mkstemp(tmpFile);
+   if (fd < 0) return;
+   fchmod(fd, st.st_mode & 0666);
+   f = fdopen(fd, "wb");
+   if (!f) {
+      close(fd);
+      unlink(tmpFile);
+      return;
+   }
+
+   setCacheHeader(&st, &h);
+   h.m = matrix->m;
+   h.n = matrix->n;
+   h.nnz = matrix->nnz;
+   offset = sizeof(h) + sizeof(int)*((size_t)matrix->m+1+matrix->nnz);
+   ok = fwrite(&h, sizeof(h), 1, f) == 1
+      && fwrite(matrix->IA, sizeof(int), matrix->m+1, f) == (size_t)matrix->m+1
+      && fwrite(matrix->JA, sizeof(int), matrix->nnz, f) == (size_t)matrix->nnz
+      && fwrite(zeros, 1, cacheOffsetAElts(matrix->m, matrix->nnz) - offset, f)
+            == cacheOffsetAElts(matrix->m, matrix->nnz) - offset
+      && fwrite(matrix->AElts, sizeof(SCALAR), matrix->nnz, f)
+            == (size_t)matrix->nnz;
+   if (fclose(f) != 0) ok = 0;
+   if (!ok || rename(tmpFile, cacheFile) != 0) unlink(tmpFile);
+}
+
+/******************************************************************************
+ * Generate in memory one of the following scalable symmetric matrices, given
+ * by spec (the matrix name without the prefix "gen:"):
+ *
+ *    laplace3d:n          7-point Laplacian on a k x k x k grid, with k the
+ *                         nearest integer to the cube root of n
+ *    banded:n[:b]         random entries in [-1,1] with half bandwidth b
+ *                         (default 5) and diagonal 2*b+2, so the spectrum
+ *                         is in [1, 4*b+3]
+ *    clustered:n[:c[:w]]  diagonal with c clusters (default 10) of relative
+ *                         width w (default 1e-3) around 1, 2, ..., c
+ *
+ * The random entries depend only on their position, so the matrices are the
+ * same in every run.
+ ******************************************************************************/
+
+static double hashUnit(unsigned long long i, unsigned long long j) {
+   /* splitmix64 of the position, scaled to [-1,1) */
+   unsigned long long z = i*0x9E3779B97F4A7C15ULL + j + 0x632BE59BD9B4E019ULL;
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   z = z ^ (z >> 31);
+   return (double)(z >> 11) / 4503599627370496.0 - 1.0;
+}
+
+static int generateMatrix(const char *spec, SCALAR **AA, int **JA, int **IA, int *n, int *nnz) {
+   char name[64];
+   double p1 = -1, p2 = -1, nr;
+   long int nnzmax, k;
+   int i, j, b, c, nx, x, y, z;
+   SCALAR *A;
+
+   i = sscanf(spec, "%63[^:]:%lf:%lf:%lf", name, &nr, &p1, &p2);
+   if (i < 2 || nr < 1 || nr > 2147483647.0) return -1;
+   *n = (int)nr;
+
+   if (!strcmp(name, "laplace3d")) {
+      nx = (int)floor(cbrt(nr) + 0.5);
+      if (nx < 1 || (double)nx*nx*nx > 2147483647.0/7) return -1;
+      *n = nx*nx*nx;
+      nnzmax = 7L*(*n);
+   }
+   else if (!strcmp(name, "banded")) {
+      b = p1 >= 0 ? (int)p1 : 5;
+      if (b >= *n) b = *n-1;
+      nnzmax = (2L*b+1)*(*n);
+      nx = 0;
+   }
+   else if (!strcmp(name, "clustered")) {
+      nnzmax = *n;
+      nx = b = 0;
+   }
+   else {
+      return -1;
+   }
+   if (nnzmax > 2147483647L) return -1;
+
+   *IA = (int *)primme_calloc(*n+1, sizeof(int), "IA");
+   *JA = (int *)primme_calloc(nnzmax, sizeof(int), "JA");
+   A = *AA = (SCALAR *)primme_calloc(nnzmax, sizeof(SCALAR), "AA");
+
+#define ADD(J,V) {(*JA)[k] = (J)+1; A[k++] = (V);}
+   for (i=0, k=0; i<*n; i++) {
+      (*IA)[i] = k+1;
+      if (!strcmp(name, "laplace3d")) {
+         x = i%nx; y = (i/nx)%nx; z = i/nx/nx;
+         if (z > 0)    ADD(i-nx*nx, -1.0);
+         if (y > 0)    ADD(i-nx, -1.0);
+         if (x > 0)    ADD(i-1, -1.0);
+         ADD(i, 6.0);
+         if (x < nx-1) ADD(i+1, -1.0);
+         if (y < nx-1) ADD(i+nx, -1.0);
+         if (z < nx-1) ADD(i+nx*nx, -1.0);
+      }
+      else if (!strcmp(name, "banded")) {
+         for (j=max(0, i-b); j<=min(*n-1, i+b); j++) {
+            if (j == i) ADD(i, 2.0*b+2.0 + hashUnit(i, i))
+            else        ADD(j, hashUnit(min(i,j), max(i,j)))
+         }
+      }
+      else {
+         c = p1 > 0 ? (int)p1 : 10;
+         ADD(i, (double)(i%c+1)*(1.0 + (p2 >= 0 ? p2 : 1e-3)*hashUnit(i, i)));
+      }
+   }
+#undef ADD
+   (*IA)[*n] = k+1;
+   *nnz = (int)k;
 
    return 0;
 }
@@ -285,8 +678,13 @@ void shiftCSRMatrix(double shift, CSRMatrix *matrix) {
 
 void freeCSRMatrix(CSRMatrix *matrix) {
    if (!matrix) return;
-   free(matrix->AElts);
-   free(matrix->IA);
-   free(matrix->JA);
+   if (matrix->map) {
+      munmap(matrix->map, matrix->mapSize);
+   }
+   else {
+      free(matrix->AElts);
+      free(matrix->IA);
+      free(matrix->JA);
+   }
    free(matrix);
 }
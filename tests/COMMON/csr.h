@@ -37,6 +37,8 @@ typedef struct {
    int m; /* number of rows */
    int n; /* number of columns */
    int nnz;
+   void *map;      /* binary cache with IA, JA and AElts mapped, or NULL */
+   size_t mapSize;
 } CSRMatrix;
 
 int readMatrixNative(const char* matrixFileName, CSRMatrix **matrix_, double *fnorm);
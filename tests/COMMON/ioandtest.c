@@ -28,6 +28,7 @@
  ******************************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <assert.h>
 #include "primme.h"
@@ -126,6 +127,43 @@ int check_solution(const char *checkXFileName, primme_params *primme, double *ev
    Ax = (SCALAR *)primme_calloc(primme->nLocal, sizeof(SCALAR), "Ax");
    r = (SCALAR *)primme_calloc(primme->nLocal, sizeof(SCALAR), "r");
 
+   /* With evalsOnly, check that every eigenvalue is close to the Rayleigh */
+   /* quotient of a different vector in X                                   */
+   if (primme->evalsOnly) {
+      int *used = (int *)calloc(cols, sizeof(int));
+      double *evalsX = (double *)malloc(sizeof(double)*max(cols, 1));
+
+      /* Rayleigh quotients of the vectors in X */
+      for (j=0; j < cols; j++) {
+         primme->matrixMatvec(&X[primme->nLocal*j], &primme->nLocal, Ax, &primme->nLocal, &one, primme, &ierr);
+         evalsX[j] = primme_dot_real(&X[primme->nLocal*j], Ax, primme);
+      }
+
+      for (i=0; i < primme->initSize; i++) {
+         int closest = -1;
+         double dist = HUGE_VAL;
+         for (j=0; j < cols; j++) {
+            if (!used[j] && fabs(evals[i] - evalsX[j]) < dist) {
+               dist = fabs(evals[i] - evalsX[j]);
+               closest = j;
+            }
+         }
+         if (closest < 0 || dist > max(rnorms[i], primme->aNorm*primme->eps)) {
+            if (primme->procID == 0)
+               fprintf(stderr, "Warning: Eval[%d] = %-22.15E not found on X\n", i+1, evals[i]);
+            retX = 1;
+         }
+         else used[closest] = 1;
+      }
+      free(used);
+      free(evalsX);
+      free(h);
+      free(X);
+      free(r);
+      free(Ax);
+      return retX;
+   }
+
    /* Estimate the separation between eigenvalues */
    delta = primme->aNorm > 0.0 ? primme->aNorm : HUGE_VAL;
    for (i=1; i < primme->initSize; i++) {
@@ -241,8 +279,16 @@ int readBinaryEvecsAndPrimmeParams(const char *fileName, SCALAR *X, SCALAR **Xou
    /* Read primme_params */
    if (primme_out) {
       FREAD(&d, sizeof(d), 1, f);
-      if ((int)REAL_PART(d) == (int)sizeof(*primme_out)) {
-         FREAD(primme_out, sizeof(*primme_out), 1, f);
+      /* NOTE: a stored primme_params from an older version is read as a  */
+      /*       prefix, but that is not a prefix of the current layout:    */
+      /*       primme_stats is embedded in the middle of primme_params    */
+      /*       and gains members at its end, shifting everything after.  */
+      /*       This works only because every field that check_solution  */
+      /*       compares, up to stats.numMatvecs, precedes the grown tail. */
+      if ((int)REAL_PART(d) > 0 &&
+            (int)REAL_PART(d) <= (int)sizeof(*primme_out)) {
+         memset(primme_out, 0, sizeof(*primme_out));
+         FREAD(primme_out, (int)REAL_PART(d), 1, f);
       }
       else
          primme_out->n = 0;
@@ -32,6 +32,8 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include "native.h"
 
 static void getDiagonal(const CSRMatrix *matrix, double *diag);
@@ -41,49 +43,250 @@ extern "C" {
 #endif
 
 #ifndef USE_DOUBLECOMPLEX
-void FORTRAN_FUNCTION(amux)(int*, double*, double*, double*, int*, int*);
 void FORTRAN_FUNCTION(atmuxr)(int*, int*, double*, double*, double*, int*, int*);
 void FORTRAN_FUNCTION(ilut)(int*, double*, int*, int*, int*, double*, double*, int*, int*, int*,
                             double*, double*, int*, int*, int*, int*);
-void FORTRAN_FUNCTION(lusol0)(int*, double*, double*, double*, int*, int*);
 #else
-void FORTRAN_FUNCTION(zamux)(int*, SCALAR*, SCALAR*, SCALAR*, int*, int*);
 void FORTRAN_FUNCTION(zatmuxr)(int*, int*, SCALAR*, SCALAR*, SCALAR*, int*, int*);
 void FORTRAN_FUNCTION(zilut)(int*, SCALAR*, int*, int*, int*, double*, SCALAR*, int*, int*, int*,
                              SCALAR*, int*, int*);
-void FORTRAN_FUNCTION(zlusol)(int*, SCALAR*, SCALAR*, SCALAR*, int*, int*);
 #endif
 
 #ifdef __cplusplus
 }
 #endif
 
+/******************************************************************************
+ * Computes rows i0 to i1-1 of y = A*x for a block of vectors. Every row of A
+ * is read once for every four vectors of the block, with the four sums kept
+ * in registers; the remaining vectors are done one by one while the row is
+ * still in cache. The rows are split among the OpenMP threads if the driver
+ * is compiled with USE_OPENMP=yes.
+ *
+******************************************************************************/
+
+static void CSRMatrixBlockMatvec(const CSRMatrix *matrix, int i0, int i1,
+      SCALAR *x, PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy, int blockSize) {
+
+   int i;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) \
+      if((double)(matrix->IA[i1]-matrix->IA[i0])*blockSize >= 32768)
+#endif
+   for (i=i0; i<i1; i++) {
+      const int k0 = matrix->IA[i]-1, nk = matrix->IA[i+1]-1-k0;
+      const SCALAR *a = &matrix->AElts[k0];
+      const int *ja = &matrix->JA[k0];
+      const SCALAR *x0, *x1, *x2, *x3;
+      SCALAR s0, s1, s2, s3;
+      int j, k;
+
+      for (j=0; j+4<=blockSize; j+=4) {
+         x0 = &x[ldx*j-1]; x1 = x0+ldx; x2 = x1+ldx; x3 = x2+ldx;
+         s0 = s1 = s2 = s3 = 0.0;
+         for (k=0; k<nk; k++) {
+            s0 += a[k]*x0[ja[k]];
+            s1 += a[k]*x1[ja[k]];
+            s2 += a[k]*x2[ja[k]];
+            s3 += a[k]*x3[ja[k]];
+         }
+         y[ldy*j+i] = s0;
+         y[ldy*(j+1)+i] = s1;
+         y[ldy*(j+2)+i] = s2;
+         y[ldy*(j+3)+i] = s3;
+      }
+      for (; j<blockSize; j++) {
+         x0 = &x[ldx*j-1];
+         s0 = 0.0;
+         for (k=0; k<nk; k++) s0 += a[k]*x0[ja[k]];
+         y[ldy*j+i] = s0;
+      }
+   }
+}
+
 /******************************************************************************
  * Applies the matrix vector multiplication on a block of vectors.
- * Because a block function is not available, we call blockSize times
- * the SPARSKIT function amux(). Note the (void *) parameters x, y that must 
- * be cast as doubles for use in amux()
  *
 ******************************************************************************/
 void CSRMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
    
-   int i;
+   CSRMatrix *matrix = (CSRMatrix *)primme->matrix;
+
+   CSRMatrixBlockMatvec(matrix, 0, (int)primme->n, (SCALAR*)x, *ldx,
+         (SCALAR*)y, *ldy, *blockSize);
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Nonblocking matrix vector multiplication: CSRMatrixMatvecStart only records
+ * the product in request, and CSRMatrixMatvecWait computes it. This defers
+ * the product as late as possible, like a remote or device operator would,
+ * so it catches any access to y before the wait.
+ *
+******************************************************************************/
+typedef struct {
+   void *x, *y;
+   PRIMME_INT ldx, ldy;
+   int blockSize;
+} MatvecRequest;
+
+void CSRMatrixMatvecStart(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, void **request, int *ierr) {
+
+   MatvecRequest *r = (MatvecRequest *)malloc(sizeof(MatvecRequest));
+
+   (void)primme;
+   if (!r) {
+      *ierr = 1;
+      return;
+   }
+   r->x = x;
+   r->ldx = *ldx;
+   r->y = y;
+   r->ldy = *ldy;
+   r->blockSize = *blockSize;
+   *request = r;
+   *ierr = 0;
+}
+
+void CSRMatrixMatvecWait(void *request, primme_params *primme, int *ierr) {
+
+   MatvecRequest *r = (MatvecRequest *)request;
+
+   CSRMatrixMatvec(r->x, &r->ldx, r->y, &r->ldy, &r->blockSize, primme, ierr);
+   free(r);
+}
+
+/******************************************************************************
+ * Matrix vector multiplication on 16-bit vectors, as an operator on a device
+ * with reduced precision products would do: x is in the format
+ * primme.matvecHalfType, and y is returned in float (complex float).
+ *
+******************************************************************************/
+static float halfToFloat(unsigned short h, primme_half type) {
+   union { float f; unsigned int u; } v;
+   unsigned int sign = (unsigned int)(h & 0x8000u) << 16;
+   unsigned int e = (h >> 10) & 0x1fu, m = h & 0x3ffu;
+
+   if (type == primme_half_bf16) {
+      v.u = (unsigned int)h << 16;
+   }
+   else if (e == 0) {
+      v.f = ldexpf((float)m, -24);
+      v.u |= sign;
+   }
+   else {
+      v.u = sign | (e == 31 ? 0x7f800000u : (e + 112) << 23) | (m << 13);
+   }
+   return v.f;
+}
+
+void CSRMatrixMatvecHalf(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr) {
+
+   const int c = (int)(sizeof(SCALAR)/sizeof(REAL));
+   PRIMME_INT n = primme->nLocal, i;
+   int j;
+   SCALAR *x0, *y0;
+
+   x0 = (SCALAR*)malloc(sizeof(SCALAR)*n*(*blockSize)*2);
+   if (!x0) {
+      *ierr = 1;
+      return;
+   }
+   y0 = x0 + n*(*blockSize);
+   for (j=0; j<*blockSize; j++) {
+      for (i=0; i<n*c; i++) {
+         ((REAL*)&x0[n*j])[i] = halfToFloat(
+               ((unsigned short*)x)[(*ldx)*c*j+i], primme->matvecHalfType);
+      }
+   }
+   CSRMatrixMatvec(x0, &n, y0, &n, blockSize, primme, ierr);
+   for (j=0; j<*blockSize; j++) {
+      for (i=0; i<n*c; i++) {
+         ((float*)y)[(*ldy)*c*j+i] = (float)((REAL*)&y0[n*j])[i];
+      }
+   }
+   free(x0);
+}
+
+/******************************************************************************
+ * Applies the polynomial of the matrix given by the three-term recurrence in
+ * primme.matrixPowers, y = p_k(A)*x, with k = degree.
+ *
+******************************************************************************/
+void CSRMatrixPowers(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, int *degree, double *alpha, double *beta, double *gamma,
+      primme_params *primme, int *ierr) {
+
+   PRIMME_INT n = primme->nLocal, i;
+   int j, k;
+   SCALAR *buf, *X[3], *aux; /* X[0] = p_{k-2}(A)x, X[1] = p_{k-1}(A)x */
+
+   buf = (SCALAR*)malloc(sizeof(SCALAR)*n*(*blockSize)*3);
+   if (!buf) {
+      *ierr = 1;
+      return;
+   }
+   X[0] = buf;
+   X[1] = X[0] + n*(*blockSize);
+   X[2] = X[1] + n*(*blockSize);
+   for (j=0; j<*blockSize; j++) {
+      for (i=0; i<n; i++) {
+         X[1][n*j+i] = ((SCALAR*)x)[(*ldx)*j+i];
+      }
+   }
+   *ierr = 0;
+   for (k=0; k<*degree && *ierr == 0; k++) {
+      CSRMatrixMatvec(X[1], &n, X[2], &n, blockSize, primme, ierr);
+      for (i=0; i<n*(*blockSize); i++) {
+         X[2][i] = alpha[k]*(X[2][i] - beta[k]*X[1][i])
+            - (k > 0 ? gamma[k]*X[0][i] : 0.0);
+      }
+      aux = X[0]; X[0] = X[1]; X[1] = X[2]; X[2] = aux;
+   }
+   for (j=0; j<*blockSize; j++) {
+      for (i=0; i<n; i++) {
+         ((SCALAR*)y)[(*ldy)*j+i] = X[1][n*j+i];
+      }
+   }
+   free(buf);
+}
+
+/******************************************************************************
+ * Applies the matrix vector multiplication on a block of vectors, y = A*x, and
+ * computes VtY = V'*y. The rows of y are computed by chunks, and every chunk
+ * is multiplied by V while it is still in cache.
+ *
+******************************************************************************/
+void CSRMatrixMatvecProject(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, void *V, PRIMME_INT *ldV, int *numCols, void *VtY,
+      int *ldVtY, primme_params *primme, int *ierr) {
+
+   int i, j, i0, m;
    int n = (int)primme->n;
-   SCALAR *xvec, *yvec;
+   const int M = 512;   /* rows per chunk */
+   SCALAR *xvec, *yvec, *Vvec;
    CSRMatrix *matrix;
-   
+
    matrix = (CSRMatrix *)primme->matrix;
    xvec = (SCALAR *)x;
    yvec = (SCALAR *)y;
+   Vvec = (SCALAR *)V;
 
-   for (i=0;i<*blockSize;i++) {
-#ifndef USE_DOUBLECOMPLEX
-      FORTRAN_FUNCTION(amux)
-#else
-      FORTRAN_FUNCTION(zamux)
-#endif
-            (&n, &xvec[*ldx*i], &yvec[*ldy*i], 
-             matrix->AElts, matrix->JA, matrix->IA);
+   for (i0=0; i0 < n; i0+=M) {
+      m = min(M, n-i0);
+      CSRMatrixBlockMatvec(matrix, i0, i0+m, xvec, *ldx, yvec, *ldy,
+            *blockSize);
+      Num_gemm_Sprimme("C", "N", *numCols, *blockSize, m, 1.0, &Vvec[i0],
+            *ldV, &yvec[i0], *ldy, i0 == 0 ? 0.0 : 1.0, (SCALAR*)VtY,
+            *ldVtY);
+   }
+   if (n == 0) {
+      for (j=0; j<*blockSize; j++)
+         for (i=0; i<*numCols; i++)
+            ((SCALAR*)VtY)[*ldVtY*j+i] = 0.0;
    }
    *ierr = 0;
 }
@@ -102,15 +305,7 @@ void CSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
    yvec = (SCALAR *)y;
 
    if (*trans == 0) {
-      for (i=0;i<*blockSize;i++) {
-#ifndef USE_DOUBLECOMPLEX
-         FORTRAN_FUNCTION(amux)
-#else
-         FORTRAN_FUNCTION(zamux)
-#endif
-              (&m, &xvec[(*ldx)*i], &yvec[(*ldy)*i], 
-               matrix->AElts, matrix->JA, matrix->IA);
-      }
+      CSRMatrixBlockMatvec(matrix, 0, m, xvec, *ldx, yvec, *ldy, *blockSize);
    } else {
       for (i=0;i<*blockSize;i++) {
 #ifndef USE_DOUBLECOMPLEX
@@ -126,6 +321,196 @@ void CSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
 }
 
 
+/******************************************************************************
+ * Applies the normal equations on a block of vectors, y = A'*A*x if trans is
+ * zero, and y = A*A'*x otherwise. The transpose is taken as in atmuxr.
+ *
+ * For y = A'*A*x, every row a_i of A is read once for all vectors in the
+ * block: t_j = a_i*x_j is computed while a_i is in cache and then added up
+ * as y_j += a_i'*t_j, so the m x blockSize product A*x is not stored.
+ * With rows, A*A'*x needs A'*x complete before any row of y, so it is
+ * computed with two calls to CSRMatrixMatvecSVD.
+ *
+******************************************************************************/
+void CSRMatrixMatvecNormalSVD(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *trans,
+      primme_svds_params *primme_svds, int *ierr) {
+
+   int i, j, j0, k, bs, notrans = 0, transpose = 1;
+   const int B = 16;   /* vectors per block */
+   SCALAR *xvec, *yvec, t[16];
+   CSRMatrix *matrix;
+
+   matrix = (CSRMatrix *)primme_svds->matrix;
+   xvec = (SCALAR *)x;
+   yvec = (SCALAR *)y;
+
+   if (*trans != 0) {
+      PRIMME_INT n = primme_svds->n;
+      SCALAR *aux = (SCALAR*)malloc(sizeof(SCALAR)*n*(*blockSize));
+      CSRMatrixMatvecSVD(x, ldx, aux, &n, blockSize, &transpose, primme_svds,
+            ierr);
+      if (*ierr == 0) {
+         CSRMatrixMatvecSVD(aux, &n, y, ldy, blockSize, &notrans,
+               primme_svds, ierr);
+      }
+      free(aux);
+      return;
+   }
+
+   for (j=0; j<*blockSize; j++) {
+      for (i=0; i<matrix->n; i++) {
+         yvec[*ldy*j+i] = 0.0;
+      }
+   }
+
+   for (j0=0; j0<*blockSize; j0+=B) {
+      bs = min(B, *blockSize-j0);
+      for (i=0; i<matrix->m; i++) {
+         for (j=0; j<bs; j++) {
+            SCALAR s = 0.0;
+            for (k=matrix->IA[i]-1; k<matrix->IA[i+1]-1; k++) {
+               s += matrix->AElts[k]*xvec[*ldx*(j0+j)+matrix->JA[k]-1];
+            }
+            t[j] = s;
+         }
+         for (j=0; j<bs; j++) {
+            for (k=matrix->IA[i]-1; k<matrix->IA[i+1]-1; k++) {
+               yvec[*ldy*(j0+j)+matrix->JA[k]-1] += matrix->AElts[k]*t[j];
+            }
+         }
+      }
+   }
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Reference reader for matrices that do not fit in memory. The arrays JA and
+ * AElts of a CSR matrix are written to an unlinked temporary file that is
+ * mapped read-only; only IA stays in memory. Products are computed by blocks
+ * of rowsPerBlock rows, each block read once for all vectors, so every call
+ * is one pass over the matrix. Before computing a block the reader asks the
+ * kernel to start reading the next one (MADV_WILLNEED), and releases the
+ * pages of the block when done (MADV_DONTNEED): at most two blocks are
+ * resident, and the reading of one overlaps the computation on the other.
+ *
+******************************************************************************/
+
+static void adviseStreamRange(StreamCSRMatrix *stream, int r0, int r1,
+      int advice) {
+
+   long page = sysconf(_SC_PAGESIZE);
+   size_t k0 = (size_t)(stream->IA[r0]-1), k1 = (size_t)(stream->IA[r1]-1);
+   size_t ranges[2][2], i;
+
+   if (k0 >= k1) return;
+   ranges[0][0] = sizeof(int)*k0;
+   ranges[0][1] = sizeof(int)*k1;
+   ranges[1][0] = stream->offsetAElts + sizeof(SCALAR)*k0;
+   ranges[1][1] = stream->offsetAElts + sizeof(SCALAR)*k1;
+   for (i=0; i<2; i++) {
+      size_t start = ranges[i][0]/page*page;
+      madvise((char*)stream->map + start, ranges[i][1] - start, advice);
+   }
+}
+
+int createStreamCSRMatrix(const CSRMatrix *matrix, int rowsPerBlock,
+      StreamCSRMatrix **stream_) {
+
+   StreamCSRMatrix *stream;
+   char fileName[] = "/tmp/primme_streamXXXXXX";
+   size_t nnz = (size_t)matrix->nnz;
+   int fd;
+
+   fd = mkstemp(fileName);
+   if (fd < 0) return -1;
+   unlink(fileName);
+   if (write(fd, matrix->JA, sizeof(int)*nnz) != (ssize_t)(sizeof(int)*nnz)
+         || write(fd, matrix->AElts, sizeof(SCALAR)*nnz)
+               != (ssize_t)(sizeof(SCALAR)*nnz)) {
+      close(fd);
+      return -1;
+   }
+
+   stream = (StreamCSRMatrix *)malloc(sizeof(StreamCSRMatrix));
+   stream->m = matrix->m;
+   stream->n = matrix->n;
+   stream->rowsPerBlock = rowsPerBlock > 0 ? rowsPerBlock : matrix->m;
+   stream->IA = (int *)malloc(sizeof(int)*(matrix->m+1));
+   memcpy(stream->IA, matrix->IA, sizeof(int)*(matrix->m+1));
+   stream->fd = fd;
+   stream->offsetAElts = sizeof(int)*nnz;
+   stream->mapSize = (sizeof(int)+sizeof(SCALAR))*nnz;
+   stream->map = nnz > 0 ? mmap(NULL, stream->mapSize, PROT_READ, MAP_SHARED,
+         fd, 0) : NULL;
+   if (stream->map == MAP_FAILED) {
+      close(fd);
+      free(stream->IA);
+      free(stream);
+      return -1;
+   }
+
+   *stream_ = stream;
+   return 0;
+}
+
+void freeStreamCSRMatrix(StreamCSRMatrix *stream) {
+
+   if (stream->map) munmap(stream->map, stream->mapSize);
+   close(stream->fd);
+   free(stream->IA);
+   free(stream);
+}
+
+void StreamCSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *trans,
+      primme_svds_params *primme_svds, int *ierr) {
+
+   int i, j, k, r0, r1;
+   StreamCSRMatrix *stream = (StreamCSRMatrix *)primme_svds->matrix;
+   const int *JA = (const int *)stream->map;
+   const SCALAR *AElts = (const SCALAR *)((char*)stream->map + stream->offsetAElts);
+   SCALAR *xvec = (SCALAR *)x, *yvec = (SCALAR *)y;
+
+   if (*trans != 0) {
+      for (j=0; j<*blockSize; j++) {
+         for (i=0; i<stream->n; i++) {
+            yvec[*ldy*j+i] = 0.0;
+         }
+      }
+   }
+
+   r1 = min(stream->rowsPerBlock, stream->m);
+   adviseStreamRange(stream, 0, r1, MADV_WILLNEED);
+   for (r0=0; r0<stream->m; r0=r1) {
+      r1 = min(r0+stream->rowsPerBlock, stream->m);
+      adviseStreamRange(stream, r1, min(r1+stream->rowsPerBlock, stream->m),
+            MADV_WILLNEED);
+
+      /* The transpose is taken as in atmuxr */
+
+      for (i=r0; i<r1; i++) {
+         for (j=0; j<*blockSize; j++) {
+            if (*trans == 0) {
+               SCALAR s = 0.0;
+               for (k=stream->IA[i]-1; k<stream->IA[i+1]-1; k++) {
+                  s += AElts[k]*xvec[*ldx*j+JA[k]-1];
+               }
+               yvec[*ldy*j+i] = s;
+            }
+            else {
+               for (k=stream->IA[i]-1; k<stream->IA[i+1]-1; k++) {
+                  yvec[*ldy*j+JA[k]-1] += AElts[k]*xvec[*ldx*j+i];
+               }
+            }
+         }
+      }
+
+      adviseStreamRange(stream, r0, r1, MADV_DONTNEED);
+   }
+   *ierr = 0;
+}
+
 /******************************************************************************
  * Applies the (already inverted) diagonal preconditioner
  *
@@ -192,18 +577,88 @@ void ApplyInvDavidsonDiagPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_IN
    *ierr = 0;
 }
 
+/******************************************************************************
+ * Groups the rows of the ILUT factors by levels. The level of a row of L is
+ * one more than the largest level of the rows it depends on, processing the
+ * rows from the first one; for U the rows are processed from the last one.
+ * The rows of every level are stored consecutively in rows, in increasing
+ * order for L and decreasing order for U.
+ *
+******************************************************************************/
+
+static void levelSchedule(const CSRMatrix *factors, int n, int lower,
+      int **rows_, int **levels_, int *numLevels) {
+
+   const int *jlu = factors->JA, *ju = factors->IA;
+   int *level = (int *)malloc(sizeof(int)*(n+1));
+   int *levels, *rows, i, ii, k, l, nl = 0;
+
+   for (ii=0; ii<n; ii++) {
+      i = lower ? ii : n-1-ii;
+      l = 0;
+      if (lower) {
+         for (k=jlu[i]-1; k<ju[i]-1; k++) l = max(l, level[jlu[k]-1]+1);
+      }
+      else {
+         for (k=ju[i]-1; k<jlu[i+1]-1; k++) l = max(l, level[jlu[k]-1]+1);
+      }
+      level[i] = l;
+      nl = max(nl, l+1);
+   }
+
+   levels = (int *)calloc(nl+1, sizeof(int));
+   rows = (int *)malloc(sizeof(int)*(n+1));
+   for (i=0; i<n; i++) levels[level[i]+1]++;
+   for (l=0; l<nl; l++) levels[l+1] += levels[l];
+   for (ii=0; ii<n; ii++) {
+      i = lower ? ii : n-1-ii;
+      rows[levels[level[i]]++] = i;
+   }
+   for (l=nl; l>0; l--) levels[l] = levels[l-1];
+   levels[0] = 0;
+   free(level);
+
+   *rows_ = rows;
+   *levels_ = levels;
+   *numLevels = nl;
+}
+
+static int createILUTLevels(CSRMatrix *factors, int n, ILUTPrecNative **prec) {
+   ILUTPrecNative *p = (ILUTPrecNative *)calloc(1, sizeof(ILUTPrecNative));
+
+   p->factors = factors;
+   p->n = n;
+   levelSchedule(factors, n, 1, &p->rowsL, &p->levelsL, &p->numLevelsL);
+   levelSchedule(factors, n, 0, &p->rowsU, &p->levelsU, &p->numLevelsU);
+   *prec = p;
+   return 0;
+}
+
+void freeILUTPrecNative(ILUTPrecNative *prec) {
+   if (!prec) return;
+   freeCSRMatrix(prec->factors);
+   free(prec->rowsL);
+   free(prec->levelsL);
+   free(prec->rowsU);
+   free(prec->levelsU);
+   free(prec);
+}
+
 /******************************************************************************
  * Applies the ILUT preconditioner 
  *
  *    y(i) = U^(-1)*( L^(-1)*x(i)), i=1:blockSize, 
  *    with L,U = ilut(A-shift) 
  * 
- * It calls the SPARSKIT lusol0 function for each block vector.
+ * The triangular solves do the same operations as SPARSKIT lusol0, but every
+ * row of the factors is applied to all vectors of the block while it is in
+ * cache. With several OpenMP threads, the rows in every level are solved in
+ * parallel; otherwise rows are solved in their natural order.
  *
 ******************************************************************************/
 
 int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
-                         double threshold, double filter, CSRMatrix **prec) {
+                         double threshold, double filter, ILUTPrecNative **prec) {
 #ifdef USE_DOUBLECOMPLEX
    int ierr;
    int lenFactors;
@@ -222,7 +677,7 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
    /* Max size of factorization */
    lenFactors = 9*matrix->nnz;
 
-   factors = (CSRMatrix *)primme_calloc(1,  sizeof(CSRMatrix), "factors");
+   factors = (CSRMatrix *)calloc(1, sizeof(CSRMatrix));
    factors->AElts = (SCALAR *)primme_calloc(lenFactors,
                                 sizeof(SCALAR), "iluElts");
    factors->JA = (int *)primme_calloc(lenFactors, sizeof(int), "Jilu");
@@ -247,8 +702,7 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
    /* free workspace */
    free(W); free(iW);
 
-   *prec = factors;
-   return 0;
+   return createILUTLevels(factors, (int)matrix->n, prec);
 #else
    int ierr;
    int lenFactors;
@@ -268,7 +722,7 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
    iW3 = (int *)primme_calloc( matrix->n,  sizeof(int), "iW2");
    /* Max size of factorization */
    lenFactors = 9*matrix->nnz;
-   factors = (CSRMatrix *)primme_calloc(1,  sizeof(CSRMatrix), "factors");
+   factors = (CSRMatrix *)calloc(1, sizeof(CSRMatrix));
    factors->AElts = (double *)primme_calloc(lenFactors,
                                 sizeof(double), "iluElts");
    factors->JA = (int *)primme_calloc(lenFactors, sizeof(int), "Jilu");
@@ -294,29 +748,56 @@ int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
    /* free workspace */
    free(W1); free(W2); free(iW1); free(iW2); free(iW3);
 
-   *prec = factors;
-   return 0;
+   return createILUTLevels(factors, (int)matrix->n, prec);
 #endif
 }
 
+static void ILUTSolveRow(const ILUTPrecNative *prec, int i, int lower,
+      SCALAR *y, PRIMME_INT ldy, int blockSize) {
+
+   const SCALAR *alu = prec->factors->AElts;
+   const int *jlu = prec->factors->JA, *ju = prec->factors->IA;
+   int j, k, k0, k1;
+   SCALAR s;
+
+   k0 = lower ? jlu[i]-1 : ju[i]-1;
+   k1 = lower ? ju[i]-1 : jlu[i+1]-1;
+   for (j=0; j<blockSize; j++) {
+      SCALAR *yj = &y[ldy*j-1];
+      s = yj[i+1];
+      for (k=k0; k<k1; k++) s -= alu[k]*yj[jlu[k]];
+      yj[i+1] = lower ? s : alu[i]*s;
+   }
+}
+
 void ApplyILUTPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr) {
-   int i;
-   int n = (int)primme->n;
-   SCALAR *xvec, *yvec;
-   CSRMatrix *prec;
-   
-   prec = (CSRMatrix *)primme->preconditioner;
-   xvec = (SCALAR *)x;
-   yvec = (SCALAR *)y;
+   ILUTPrecNative *prec = (ILUTPrecNative *)primme->preconditioner;
+   SCALAR *xvec = (SCALAR *)x, *yvec = (SCALAR *)y;
+   int i, j, l, n = prec->n, bs = *blockSize;
 
-   for (i=0; i<*blockSize; i++) {
-#ifdef USE_DOUBLECOMPLEX
-      FORTRAN_FUNCTION(zlusol)
-#else
-      FORTRAN_FUNCTION(lusol0)
-#endif
-             (&n, &xvec[*ldx*i], &yvec[*ldy*i],
-              prec->AElts, prec->JA, prec->IA);
+   for (j=0; j<bs; j++) {
+      for (i=0; i<n; i++) yvec[*ldy*j+i] = xvec[*ldx*j+i];
+   }
+
+   if (OMP_MAX_THREADS() <= 1) {
+      for (i=0; i<n; i++) ILUTSolveRow(prec, i, 1, yvec, *ldy, bs);
+      for (i=n-1; i>=0; i--) ILUTSolveRow(prec, i, 0, yvec, *ldy, bs);
+   }
+   else {
+      for (l=0; l<prec->numLevelsL; l++) {
+         int l0 = prec->levelsL[l], l1 = prec->levelsL[l+1];
+         OMP_PRAGMA(omp parallel for if((l1-l0)*bs >= 256))
+         for (i=l0; i<l1; i++) {
+            ILUTSolveRow(prec, prec->rowsL[i], 1, yvec, *ldy, bs);
+         }
+      }
+      for (l=0; l<prec->numLevelsU; l++) {
+         int l0 = prec->levelsU[l], l1 = prec->levelsU[l+1];
+         OMP_PRAGMA(omp parallel for if((l1-l0)*bs >= 256))
+         for (i=l0; i<l1; i++) {
+            ILUTSolveRow(prec, prec->rowsU[i], 0, yvec, *ldy, bs);
+         }
+      }
    }
    *ierr = 0;
 }
@@ -436,3 +917,398 @@ void ApplyInvDavidsonNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
       primme->ShiftsForPreconditioner);
    *ierr = 0;
 }
+
+/******************************************************************************
+ * Incomplete Cholesky preconditioners for the normal equations of the SVD,
+ * A'*A - shift^2*I and A*A' - shift^2*I, without forming the products.
+ *
+ * The factor L of G = B'*B - shift^2*I, with B = A or B = A', is computed by
+ * columns with a left-looking IC: column j of G is computed as B'*B(:,j)
+ * from B by columns and by rows; then the previous columns of L with nonzero
+ * in row j are subtracted, and the entries smaller than threshold times the
+ * norm of the column are dropped, keeping at most the maxFill largest ones.
+ * The columns of L with a nonzero in row j are found with a linked list per
+ * row, as in the ICFS of Lin and More.
+ *
+ * With blockSize > 0 only the entries in the diagonal blocks of G are kept,
+ * which is block Jacobi on G if the threshold and maxFill are zero.
+ *
+ * The dropped entries are compensated on the diagonal as Jennings and Ajiz
+ * do: dropping g_ij adds |g_ij|*sqrt(g_ii/g_jj) to g_ii and |g_ij|*sqrt(g_jj/
+ * g_ii) to g_jj, which keeps the approximation positive definite when G is.
+ * Otherwise dense rows in B, which make G dense, spoil the factorization.
+ *
+ * If a pivot is smaller than 1e-8 times the diagonal of B'*B, which may
+ * happen with the shift or if G is (nearly) singular, the factorization
+ * restarts on
+ * G + alpha*diag(B'*B) with alpha = 1e-3, 2e-3, 4e-3, ..., as ICFS does. After
+ * 30 restarts, small pivots are replaced by their absolute value, but not
+ * smaller than 1e-12 times the diagonal of B'*B.
+ *
+******************************************************************************/
+
+typedef struct {
+   double mag;
+   int i;
+} ICEntry;
+
+static int compareICEntryMag(const void *a, const void *b) {
+   double x = ((const ICEntry*)a)->mag, y = ((const ICEntry*)b)->mag;
+   return x > y ? -1 : (x < y ? 1 : 0);
+}
+
+static int compareInt(const void *a, const void *b) {
+   int x = *(const int*)a, y = *(const int*)b;
+   return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void freeNormalCholFactor(NormalCholFactor *L) {
+   if (!L) return;
+   free(L->colPtr);
+   free(L->rowInd);
+   free(L->vals);
+   free(L);
+}
+
+/* B'*B for B with nB columns given by columns (cPtr, cInd, cVal) and by rows */
+/* (rPtr, rInd, rVal); if conjB, B is the conjugate of the given values       */
+
+static int normalCholesky(int nB, const int *cPtr, const int *cInd,
+      const SCALAR *cVal, const int *rPtr, const int *rInd, const SCALAR *rVal,
+      int conjB, double shift, int blockSize, int maxFill, double threshold,
+      NormalCholFactor **L_) {
+
+   NormalCholFactor *L;
+   SCALAR *w;
+   int *mark, *list, *head, *next, *ptr, *kept;
+   ICEntry *ent;
+   int i, j, k, p, q, nw, nk, ne, cap, jb1, tries = 0;
+   double *gdiag, *comp, diag0, d, ljj, colNorm, alpha = 0.0;
+
+   L = (NormalCholFactor *)calloc(1, sizeof(NormalCholFactor));
+   w = (SCALAR *)calloc(nB, sizeof(SCALAR));
+   mark = (int *)malloc(sizeof(int)*nB*6);
+   ent = (ICEntry *)malloc(sizeof(ICEntry)*nB);
+   gdiag = (double *)malloc(sizeof(double)*nB*2);
+   if (!L || !w || !mark || !ent || !gdiag) {
+      free(L); free(w); free(mark); free(ent); free(gdiag);
+      return -1;
+   }
+   comp = gdiag + nB;
+   for (j=0; j<nB; j++) {
+      for (p=cPtr[j], gdiag[j]=0.0; p<cPtr[j+1]; p++) {
+         gdiag[j] += REAL_PART(cVal[p]*CONJ(cVal[p]));
+      }
+   }
+   list = mark + nB;
+   head = list + nB;
+   next = head + nB;
+   ptr = next + nB;
+   kept = ptr + nB;
+
+   L->n = nB;
+   cap = cPtr[nB] + nB;
+   L->colPtr = (int *)malloc(sizeof(int)*(nB+1));
+   L->rowInd = (int *)malloc(sizeof(int)*cap);
+   L->vals = (SCALAR *)malloc(sizeof(SCALAR)*cap);
+   if (!L->colPtr || !L->rowInd || !L->vals) goto failed;
+
+restart:
+   for (i=0; i<nB; i++) {
+      mark[i] = head[i] = -1;
+      w[i] = 0.0;
+      comp[i] = 0.0;
+   }
+   L->colPtr[0] = 0;
+
+#define ADD_TO_W(I) if (mark[I] != j) {mark[I] = j; list[nw++] = (I);}
+
+   for (j=0; j<nB; j++) {
+      nw = 0;
+      jb1 = blockSize > 0 ? min((j/blockSize+1)*blockSize, nB) : nB;
+
+      /* w = G(j:jb1-1, j) */
+
+      ADD_TO_W(j);
+      for (p=cPtr[j]; p<cPtr[j+1]; p++) {
+         int r = cInd[p];
+         SCALAR v = conjB ? CONJ(cVal[p]) : cVal[p];
+         for (q=rPtr[r]; q<rPtr[r+1]; q++) {
+            i = rInd[q];
+            if (i < j || i >= jb1) continue;
+            ADD_TO_W(i);
+            w[i] += (conjB ? rVal[q] : CONJ(rVal[q]))*v;
+         }
+      }
+      diag0 = REAL_PART(w[j]);
+      w[j] += alpha*diag0 - shift*shift + comp[j];
+
+      /* w -= L(j:n-1, k)*L(j,k)' for the columns k with L(j,k) != 0 */
+
+      for (k=head[j]; k>=0; ) {
+         int kn = next[k];
+         SCALAR ljk = CONJ(L->vals[ptr[k]]);
+         for (q=ptr[k]; q<L->colPtr[k+1]; q++) {
+            i = L->rowInd[q];
+            ADD_TO_W(i);
+            w[i] -= L->vals[q]*ljk;
+         }
+         if (++ptr[k] < L->colPtr[k+1]) {
+            i = L->rowInd[ptr[k]];
+            next[k] = head[i];
+            head[i] = k;
+         }
+         k = kn;
+      }
+
+      /* Drop the small entries and keep the largest maxFill; the first nk */
+      /* entries in ent are kept and the rest are compensated on the diagonal */
+
+      d = REAL_PART(w[j]);
+      for (p=0, colNorm=fabs(d); p<nw; p++) {
+         if (list[p] != j) colNorm += REAL_PART(w[list[p]]*CONJ(w[list[p]]));
+      }
+      colNorm = sqrt(colNorm);
+      for (p=ne=0; p<nw; p++) {
+         i = list[p];
+         if (i != j && w[i] != 0.0) {
+            ent[ne].mag = ABS(w[i]);
+            ent[ne++].i = i;
+         }
+      }
+      qsort(ent, ne, sizeof(ICEntry), compareICEntryMag);
+      for (nk=0; nk<ne && ent[nk].mag >= threshold*colNorm
+            && (maxFill <= 0 || nk < maxFill); nk++);
+      for (p=nk; p<ne; p++) {
+         i = ent[p].i;
+         if (gdiag[i] > 0.0 && gdiag[j] > 0.0) {
+            d += ent[p].mag*sqrt(gdiag[j]/gdiag[i]);
+            comp[i] += ent[p].mag*sqrt(gdiag[i]/gdiag[j]);
+         }
+      }
+      for (p=0; p<nk; p++) kept[p] = ent[p].i;
+      qsort(kept, nk, sizeof(int), compareInt);
+
+      /* Pivot */
+
+      if (d <= 1e-8*diag0 && tries < 30) {
+         alpha = max(2.0*alpha, 1e-3);
+         tries++;
+         goto restart;
+      }
+      if (d <= 1e-12*diag0) d = max(fabs(d), 1e-12*diag0);
+      if (d <= 0.0) d = 1.0;
+      ljj = sqrt(d);
+
+      /* Store the column */
+
+      q = L->colPtr[j];
+      if (q + nk + 1 > cap) {
+         int *rowInd;
+         SCALAR *vals;
+         cap = max(cap*2, q + nk + 1);
+         rowInd = (int *)realloc(L->rowInd, sizeof(int)*cap);
+         if (rowInd) L->rowInd = rowInd;
+         vals = (SCALAR *)realloc(L->vals, sizeof(SCALAR)*cap);
+         if (vals) L->vals = vals;
+         if (!rowInd || !vals) goto failed;
+      }
+      L->rowInd[q] = j;
+      L->vals[q++] = ljj;
+      for (p=0; p<nk; p++, q++) {
+         L->rowInd[q] = kept[p];
+         L->vals[q] = w[kept[p]]/ljj;
+      }
+      L->colPtr[j+1] = q;
+      if (nk > 0) {
+         ptr[j] = L->colPtr[j] + 1;
+         next[j] = head[kept[0]];
+         head[kept[0]] = j;
+      }
+
+      for (p=0; p<nw; p++) w[list[p]] = 0.0;
+   }
+
+#undef ADD_TO_W
+
+   free(w);
+   free(mark);
+   free(ent);
+   free(gdiag);
+   *L_ = L;
+   return 0;
+
+failed:
+   free(w);
+   free(mark);
+   free(ent);
+   free(gdiag);
+   freeNormalCholFactor(L);
+   return -1;
+}
+
+int createNormalPrecNative(const CSRMatrix *matrix, double shift,
+      int blockSize, int level, double threshold, NormalPrecNative **prec) {
+
+   NormalPrecNative *P;
+   int i, j, p, m = matrix->m, n = matrix->n, nnz = matrix->IA[m]-1;
+
+   P = (NormalPrecNative *)calloc(1, sizeof(NormalPrecNative));
+   if (!P) return -1;
+   P->m = m;
+   P->n = n;
+   P->shift = shift;
+   P->blockSize = blockSize;
+   P->maxFill = level > 0 ? level*(nnz/max(1, min(m, n)) + 1) : 0;
+   P->threshold = threshold;
+
+   /* A by rows and by columns, with indices from zero */
+
+   P->rowPtr = (int *)malloc(sizeof(int)*(m+1));
+   P->colInd = (int *)malloc(sizeof(int)*max(nnz, 1));
+   P->rowVal = (SCALAR *)malloc(sizeof(SCALAR)*max(nnz, 1));
+   P->colPtr = (int *)calloc(n+2, sizeof(int));
+   P->rowInd = (int *)malloc(sizeof(int)*max(nnz, 1));
+   P->colVal = (SCALAR *)malloc(sizeof(SCALAR)*max(nnz, 1));
+   if (!P->rowPtr || !P->colInd || !P->rowVal || !P->colPtr || !P->rowInd
+         || !P->colVal) {
+      freeNormalPrecNative(P);
+      return -1;
+   }
+   for (i=0; i<=m; i++) P->rowPtr[i] = matrix->IA[i]-1;
+   for (p=0; p<nnz; p++) {
+      P->colInd[p] = matrix->JA[p]-1;
+      P->rowVal[p] = matrix->AElts[p];
+      P->colPtr[P->colInd[p]+2]++;
+   }
+   for (j=0; j<n; j++) P->colPtr[j+2] += P->colPtr[j+1];
+   for (i=0; i<m; i++) {
+      for (p=P->rowPtr[i]; p<P->rowPtr[i+1]; p++) {
+         int q = P->colPtr[P->colInd[p]+1]++;
+         P->rowInd[q] = i;
+         P->colVal[q] = P->rowVal[p];
+      }
+   }
+
+   *prec = P;
+   return 0;
+}
+
+void freeNormalPrecNative(NormalPrecNative *prec) {
+   if (!prec) return;
+   free(prec->rowPtr);
+   free(prec->colInd);
+   free(prec->rowVal);
+   free(prec->colPtr);
+   free(prec->rowInd);
+   free(prec->colVal);
+   freeNormalCholFactor(prec->AtA);
+   freeNormalCholFactor(prec->AAt);
+   free(prec);
+}
+
+/* y = (L*L')^(-1)*x for a block of vectors */
+
+static void NormalCholSolve(const NormalCholFactor *L, const SCALAR *x,
+      PRIMME_INT ldx, SCALAR *y, PRIMME_INT ldy, int bs) {
+
+   int i, j, b, q;
+
+   for (b=0; b<bs; b++) {
+      SCALAR *yb = &y[ldy*b];
+      for (i=0; i<L->n; i++) yb[i] = x[ldx*b+i];
+      for (j=0; j<L->n; j++) {
+         SCALAR yj = yb[j] /= L->vals[L->colPtr[j]];
+         for (q=L->colPtr[j]+1; q<L->colPtr[j+1]; q++) {
+            yb[L->rowInd[q]] -= L->vals[q]*yj;
+         }
+      }
+      for (j=L->n-1; j>=0; j--) {
+         SCALAR s = yb[j];
+         for (q=L->colPtr[j]+1; q<L->colPtr[j+1]; q++) {
+            s -= CONJ(L->vals[q])*yb[L->rowInd[q]];
+         }
+         yb[j] = s/L->vals[L->colPtr[j]];
+      }
+   }
+}
+
+/******************************************************************************
+ * Applies the inverse of the incomplete Cholesky of A'A - shift^2*I (mode
+ * AtA), of A*A' - shift^2*I (mode AAt), or both on the corresponding parts
+ * of the vectors (mode augmented), as ApplyInvNormalPrecNative does with the
+ * diagonals. Every factor is computed the first time it is needed.
+ *
+******************************************************************************/
+
+/* Build the factors that mode needs and that aren't built yet */
+
+static int buildNormalPrecNative(NormalPrecNative *P, int mode) {
+
+   int needAtA = mode == primme_svds_op_AtA || mode == primme_svds_op_augmented;
+   int needAAt = mode == primme_svds_op_AAt || mode == primme_svds_op_augmented;
+
+   if (needAtA && !P->AtA && normalCholesky(P->n, P->colPtr, P->rowInd,
+            P->colVal, P->rowPtr, P->colInd, P->rowVal, 0, P->shift,
+            P->blockSize, P->maxFill, P->threshold, &P->AtA) != 0) {
+      return -1;
+   }
+   if (needAAt && !P->AAt && normalCholesky(P->m, P->rowPtr, P->colInd,
+            P->rowVal, P->colPtr, P->rowInd, P->colVal, 1, P->shift,
+            P->blockSize, P->maxFill, P->threshold, &P->AAt) != 0) {
+      return -1;
+   }
+   return 0;
+}
+
+/******************************************************************************
+ * primme_svds.preconditionerSetup for ApplyNormalPrecNative: the factors are
+ * built before the stage that needs them, and kept for the next stage and
+ * later calls, because the shift is the fixed driver.shift. The
+ * preconditioner is freed on release.
+ *
+******************************************************************************/
+
+void SetupNormalPrecNative(primme_svds_prec_event *event,
+      primme_svds_operator *method, double *shifts, int *numShifts,
+      primme_svds_params *primme_svds, int *ierr) {
+
+   NormalPrecNative *P = (NormalPrecNative *)primme_svds->preconditioner;
+
+   (void)shifts;
+   (void)numShifts;
+   *ierr = 0;
+   if (*event == primme_svds_prec_prepare) {
+      if (buildNormalPrecNative(P, *method) != 0) *ierr = 1;
+   }
+   else if (*event == primme_svds_prec_release) {
+      freeNormalPrecNative(P);
+      primme_svds->preconditioner = NULL;
+   }
+}
+
+void ApplyNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *mode,
+      primme_svds_params *primme_svds, int *ierr) {
+
+   NormalPrecNative *P = (NormalPrecNative *)primme_svds->preconditioner;
+   SCALAR *xvec = (SCALAR *)x, *yvec = (SCALAR *)y;
+
+   *ierr = 0;
+   if (buildNormalPrecNative(P, *mode) != 0) {
+      *ierr = 1;
+      return;
+   }
+
+   if (*mode == primme_svds_op_AtA) {
+      NormalCholSolve(P->AtA, xvec, *ldx, yvec, *ldy, *blockSize);
+   }
+   else if (*mode == primme_svds_op_AAt) {
+      NormalCholSolve(P->AAt, xvec, *ldx, yvec, *ldy, *blockSize);
+   }
+   else if (*mode == primme_svds_op_augmented) {
+      NormalCholSolve(P->AtA, xvec, *ldx, yvec, *ldy, *blockSize);
+      NormalCholSolve(P->AAt, xvec+primme_svds->nLocal, *ldx,
+            yvec+primme_svds->nLocal, *ldy, *blockSize);
+   }
+}
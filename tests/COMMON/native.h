@@ -32,17 +32,83 @@
 #include "csr.h"
 #include "primme_svds.h"
 
+/* CSR matrix with JA and AElts read from a mapped file by blocks of rows */
+typedef struct {
+   int *IA;
+   int m, n;
+   int rowsPerBlock;
+   int fd;
+   void *map;           /* JA followed by AElts */
+   size_t mapSize;
+   size_t offsetAElts;
+} StreamCSRMatrix;
+
+/* ILUT factors in the modified sparse row format of SPARSKIT, with the rows */
+/* of L and U grouped by levels: rows in a level only depend on rows in      */
+/* previous levels, so they can be solved in parallel                        */
+typedef struct {
+   CSRMatrix *factors;  /* AElts, JA and IA are alu, jlu and ju */
+   int n;
+   int *rowsL, *levelsL, numLevelsL; /* rowsL[levelsL[l]:levelsL[l+1]-1] */
+   int *rowsU, *levelsU, numLevelsU; /* are the rows in level l           */
+} ILUTPrecNative;
+
+/* Incomplete Cholesky factor L of A'*A - shift^2*I or A*A' - shift^2*I,  */
+/* stored by columns with the diagonal first and increasing row indices     */
+typedef struct {
+   int n;
+   int *colPtr, *rowInd;
+   SCALAR *vals;
+} NormalCholFactor;
+
+/* Preconditioner (L*L')^(-1) for the normal equations of the SVD. A is     */
+/* kept by rows and by columns with indices from zero; the factors of A'*A  */
+/* and A*A' are computed the first time they are needed                    */
+typedef struct {
+   int m, n;
+   int *rowPtr, *colInd;      /* A by rows    */
+   int *colPtr, *rowInd;      /* A by columns */
+   SCALAR *rowVal, *colVal;
+   double shift;
+   int blockSize;       /* if > 0, keep only diagonal blocks of this size */
+   int maxFill;         /* if > 0, most off-diagonal entries per column   */
+   double threshold;    /* drop entries smaller than this times the norm  */
+                        /* of the column                                  */
+   NormalCholFactor *AtA, *AAt;
+} NormalPrecNative;
+
 void CSRMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
+void CSRMatrixMatvecProject(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, void *V, PRIMME_INT *ldV, int *numCols, void *VtY,
+      int *ldVtY, primme_params *primme, int *ierr);
+void CSRMatrixMatvecStart(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, void **request, int *ierr);
+void CSRMatrixMatvecWait(void *request, primme_params *primme, int *ierr);
+void CSRMatrixMatvecHalf(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr);
+void CSRMatrixPowers(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+      int *blockSize, int *degree, double *alpha, double *beta, double *gamma,
+      primme_params *primme, int *ierr);
 int createInvDiagPrecNative(const CSRMatrix *matrix, double shift, double **prec);
 void ApplyInvDiagPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, 
                                         primme_params *primme, int *ierr);
 void ApplyInvDavidsonDiagPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, 
                                         primme_params *primme, int *ierr);
 int createILUTPrecNative(const CSRMatrix *matrix, double shift, int level,
-                         double threshold, double filter, CSRMatrix **prec);
+                         double threshold, double filter, ILUTPrecNative **prec);
+void freeILUTPrecNative(ILUTPrecNative *prec);
 void ApplyILUTPrecNative(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy, int *blockSize, primme_params *primme, int *ierr);
 void CSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
       int *blockSize, int *trans, primme_svds_params *primme_svds, int *ierr);
+void CSRMatrixMatvecNormalSVD(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *trans,
+      primme_svds_params *primme_svds, int *ierr);
+int createStreamCSRMatrix(const CSRMatrix *matrix, int rowsPerBlock,
+      StreamCSRMatrix **stream);
+void freeStreamCSRMatrix(StreamCSRMatrix *stream);
+void StreamCSRMatrixMatvecSVD(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *trans,
+      primme_svds_params *primme_svds, int *ierr);
 int createInvNormalPrecNative(const CSRMatrix *matrix, double shift, double **prec);
 void ApplyInvNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, int *mode,
@@ -50,6 +116,15 @@ void ApplyInvNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
 void ApplyInvDavidsonNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
       PRIMME_INT *ldy, int *blockSize, int *mode,
       primme_svds_params *primme_svds, int *ierr);
+int createNormalPrecNative(const CSRMatrix *matrix, double shift,
+      int blockSize, int level, double threshold, NormalPrecNative **prec);
+void freeNormalPrecNative(NormalPrecNative *prec);
+void SetupNormalPrecNative(primme_svds_prec_event *event,
+      primme_svds_operator *method, double *shifts, int *numShifts,
+      primme_svds_params *primme_svds, int *ierr);
+void ApplyNormalPrecNative(void *x, PRIMME_INT *ldx, void *y,
+      PRIMME_INT *ldy, int *blockSize, int *mode,
+      primme_svds_params *primme_svds, int *ierr);
 
 #endif
 
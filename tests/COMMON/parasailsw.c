@@ -28,6 +28,7 @@
 
 #include "csr.h"
 #include "ParaSails.h"
+#include "Numbering.h"
 #include <mpi.h>
 #include "parasailsw.h"
 
@@ -122,7 +123,7 @@ int readMatrixAndPrecondParaSails(const char* matrixFileName, double shift,
    /* * * * * * * * * * * * * * * * * * * * * * * */
    /* Simplistic assignment of processors to rows */
    /* * * * * * * * * * * * * * * * * * * * * * * */
-   mLocal = matrix->m / numProcs;
+   nLocal = matrix->m / numProcs;
    modulo = matrix->m % numProcs;
    rangeStart = 0;
    for (i=0; i<numProcs; i++) {
@@ -136,10 +137,11 @@ int readMatrixAndPrecondParaSails(const char* matrixFileName, double shift,
    generatePermutations(matrix->n, numProcs, mask, or2fg, fg2or, map);
    rangeStart = map[procID];
    rangeEnd = map[procID+1]-1;
+   *m = matrix->m;
    *n = matrix->n;
    *numProcs_ = numProcs;
    *procID_ = procID;
-   *nLocal_ = rangeEnd - rangeStart+1;
+   *mLocal_ = *nLocal_ = rangeEnd - rangeStart+1;
    *pmatrix = csrToParaSails(procID, map, fg2or, or2fg, 
                              matrix->IA, matrix->JA, matrix->AElts, comm);
 
@@ -270,7 +272,7 @@ static ParaSails* generate_precond(CSRMatrix *matrix, double shift, int n, int p
    t1 = MPI_Wtime();
 
    // Compute A = A-shift
-   shiftCSRMatrix(-shift, matrix->n, matrix->IA, matrix->JA, matrix->AElts);
+   shiftCSRMatrix(-shift, matrix);
 
    // Change A to Parasails format
    shiftedMatrix = csrToParaSails(procID, map, fg2or, or2fg, 
@@ -297,42 +299,291 @@ static ParaSails* generate_precond(CSRMatrix *matrix, double shift, int n, int p
 }
 
 /******************************************************************************
- * Applies the PARALLEL matrix vector mulitplication of a block of vectors.
- * Because a block function is not available, we call blockSize times
- * the Parasails function MatrixMatvec()
+ * Block communication pattern of a Parasails matrix. Parasails' persistent
+ * requests exchange a single vector, so the pattern is rebuilt from the
+ * numbering of the external indices and kept for the matrix, together with
+ * the workspace for the largest block seen.
  *
 ******************************************************************************/
-void ParaSailsMatrixMatvec(void *x, void *y, int *blockSize, 
-   primme_params *primme) {
-   
-   int i;
-   double *xvec, *yvec;
-   xvec = (double *)x;
-   yvec = (double *)y;
+typedef struct ParaSailsBlock {
+   Matrix *mat;
+   int num_recv, *recvprocs, *recvptr, *recvind; /* external indices by owner */
+   int num_send, *sendprocs, *sendptr, *sendind; /* local rows by destination */
+   int maxBlockSize;                             /* size of the workspace */
+   double *X, *sbuf, *rbuf, *row;
+   MPI_Request *reqs;
+   struct ParaSailsBlock *next;
+} ParaSailsBlock;
+
+static ParaSailsBlock *blockComms = NULL;
+
+static int ownerParaSails(Matrix *mat, int numProcs, int g) {
+   int l = 0, r = numProcs-1;
+   while (l < r) {
+      int p = (l + r)/2;
+      if (g > mat->end_rows[p]) l = p+1; else r = p;
+   }
+   return l;
+}
+
+static ParaSailsBlock* getBlockParaSails(Matrix *mat, int blockSize) {
+
+   ParaSailsBlock *b;
+   int numProcs, nLocal, nExt, i, p;
+   int *rcount, *scount, *rdispl, *sdispl, *rglob, *sglob;
+
+   for (b=blockComms; b && b->mat != mat; b=b->next);
+
+   if (!b) {
+      MPI_Comm_size(mat->comm, &numProcs);
+      nLocal = mat->end_row - mat->beg_row + 1;
+      nExt = mat->numb->num_ind - mat->numb->num_loc;
+
+      rcount = (int *)calloc(numProcs*4, sizeof(int));
+      scount = rcount + numProcs;
+      rdispl = scount + numProcs;
+      sdispl = rdispl + numProcs;
+
+      /* Count the external indices owned by each process */
+
+      for (i=0; i<nExt; i++) {
+         rcount[ownerParaSails(mat, numProcs,
+                  mat->numb->local_to_global[nLocal+i])]++;
+      }
+      MPI_Alltoall(rcount, 1, MPI_INT, scount, 1, MPI_INT, mat->comm);
+      for (p=0, rdispl[0]=sdispl[0]=0; p<numProcs-1; p++) {
+         rdispl[p+1] = rdispl[p] + rcount[p];
+         sdispl[p+1] = sdispl[p] + scount[p];
+      }
+
+      b = (ParaSailsBlock *)calloc(1, sizeof(ParaSailsBlock));
+      b->mat = mat;
+      b->recvind = (int *)primme_calloc(nExt+1, sizeof(int), "recvind");
+      b->sendind = (int *)primme_calloc(sdispl[numProcs-1]+scount[numProcs-1]+1,
+            sizeof(int), "sendind");
+      b->recvprocs = (int *)primme_calloc(numProcs*2+2, sizeof(int), "recvprocs");
+      b->recvptr = b->recvprocs + numProcs;
+      b->sendprocs = (int *)primme_calloc(numProcs*2+2, sizeof(int), "sendprocs");
+      b->sendptr = b->sendprocs + numProcs;
+
+      /* Sort the external indices by owner and send the global indices */
+      /* to their owners, which return them as the rows to be sent      */
+
+      rglob = (int *)primme_calloc(nExt+1, sizeof(int), "rglob");
+      for (i=0; i<nExt; i++) {
+         int g = mat->numb->local_to_global[nLocal+i];
+         int j = rdispl[ownerParaSails(mat, numProcs, g)]++;
+         b->recvind[j] = nLocal+i;
+         rglob[j] = g;
+      }
+      for (p=numProcs-1; p>0; p--) rdispl[p] = rdispl[p-1];
+      rdispl[0] = 0;
+      sglob = b->sendind;
+      MPI_Alltoallv(rglob, rcount, rdispl, MPI_INT, sglob, scount, sdispl,
+            MPI_INT, mat->comm);
+      for (i=0; i<sdispl[numProcs-1]+scount[numProcs-1]; i++) {
+         b->sendind[i] = sglob[i] - mat->beg_row;
+      }
+
+      /* Keep only the neighbors */
+
+      for (p=0; p<numProcs; p++) {
+         if (rcount[p] > 0) {
+            b->recvprocs[b->num_recv] = p;
+            b->recvptr[b->num_recv++] = rdispl[p];
+         }
+         if (scount[p] > 0) {
+            b->sendprocs[b->num_send] = p;
+            b->sendptr[b->num_send++] = sdispl[p];
+         }
+      }
+      b->recvptr[b->num_recv] = nExt;
+      b->sendptr[b->num_send] = sdispl[numProcs-1] + scount[numProcs-1];
+
+      free(rglob);
+      free(rcount);
+      b->next = blockComms;
+      blockComms = b;
+   }
 
-   for (i=0;i<*blockSize;i++) {
-      MatrixMatvec(primme->matrix, &xvec[primme->nLocal*i], 
-                                         &yvec[primme->nLocal*i]);
+   /* Grow the workspace */
+
+   if (blockSize > b->maxBlockSize) {
+      nLocal = mat->end_row - mat->beg_row + 1;
+      free(b->X); free(b->sbuf); free(b->rbuf); free(b->row); free(b->reqs);
+      b->X = (double *)primme_calloc((size_t)(nLocal+b->recvptr[b->num_recv])
+            *blockSize, sizeof(double), "X");
+      b->sbuf = (double *)primme_calloc((size_t)b->sendptr[b->num_send]
+            *blockSize+1, sizeof(double), "sbuf");
+      b->rbuf = (double *)primme_calloc((size_t)b->recvptr[b->num_recv]
+            *blockSize+1, sizeof(double), "rbuf");
+      b->row = (double *)primme_calloc(blockSize, sizeof(double), "row");
+      b->reqs = (MPI_Request *)primme_calloc(b->num_recv+b->num_send+1,
+            sizeof(MPI_Request), "reqs");
+      b->maxBlockSize = blockSize;
    }
 
+   return b;
 }
 
 /******************************************************************************
- * Apply the PARALLEL Parasails preconditioner to a block of vectors.
- * Because Parasails is not block, we apply the preconditioner for each
- * block vector.
+ * Start the exchange of the interleaved blocks sbuf and rbuf with all
+ * neighbors. With reverse, the external contributions in rbuf are sent back
+ * to their owners, which receive them in sbuf.
  *
 ******************************************************************************/
-void ApplyPrecParaSails(void *x, void *y, int *blockSize,
-   primme_params *primme) {
+static void startExchangeParaSails(ParaSailsBlock *b, int blockSize,
+      int reverse) {
 
-   int i;
-   double *xvec, *yvec;
-   xvec = (double *)x;
-   yvec = (double *)y;
+   int i, n = 0;
+   MPI_Comm comm = b->mat->comm;
+
+   for (i=0; i<b->num_recv; i++) {
+      int len = (b->recvptr[i+1] - b->recvptr[i])*blockSize;
+      double *buf = &b->rbuf[(size_t)b->recvptr[i]*blockSize];
+      if (!reverse) {
+         MPI_Irecv(buf, len, MPI_DOUBLE, b->recvprocs[i], 0, comm, &b->reqs[n++]);
+      }
+      else {
+         MPI_Isend(buf, len, MPI_DOUBLE, b->recvprocs[i], 0, comm, &b->reqs[n++]);
+      }
+   }
+   for (i=0; i<b->num_send; i++) {
+      int len = (b->sendptr[i+1] - b->sendptr[i])*blockSize;
+      double *buf = &b->sbuf[(size_t)b->sendptr[i]*blockSize];
+      if (!reverse) {
+         MPI_Isend(buf, len, MPI_DOUBLE, b->sendprocs[i], 0, comm, &b->reqs[n++]);
+      }
+      else {
+         MPI_Irecv(buf, len, MPI_DOUBLE, b->sendprocs[i], 0, comm, &b->reqs[n++]);
+      }
+   }
+}
+
+static void waitExchangeParaSails(ParaSailsBlock *b) {
+   MPI_Waitall(b->num_recv+b->num_send, b->reqs, MPI_STATUSES_IGNORE);
+}
+
+/******************************************************************************
+ * y = A*x for a block of vectors, with a single exchange of the halo for
+ * all columns and a single traversal of the rows of A
+ *
+******************************************************************************/
+static void MatrixMatvecBlock(Matrix *mat, double *x, PRIMME_INT ldx,
+      double *y, PRIMME_INT ldy, int blockSize) {
+
+   ParaSailsBlock *b = getBlockParaSails(mat, blockSize);
+   int nLocal = mat->end_row - mat->beg_row + 1;
+   int row, i, j, c, len, *ind;
+   double *val;
+
+   /* Pack the outgoing rows and start the exchange */
+
+   for (i=0; i<b->sendptr[b->num_send]; i++) {
+      for (c=0; c<blockSize; c++) {
+         b->sbuf[(size_t)i*blockSize+c] = x[b->sendind[i]+ldx*c];
+      }
+   }
+   startExchangeParaSails(b, blockSize, 0);
+
+   /* Interleave the local part of x while the messages arrive */
+
+   for (row=0; row<nLocal; row++) {
+      for (c=0; c<blockSize; c++) {
+         b->X[(size_t)row*blockSize+c] = x[row+ldx*c];
+      }
+   }
+   waitExchangeParaSails(b);
+   for (i=0; i<b->recvptr[b->num_recv]; i++) {
+      for (c=0; c<blockSize; c++) {
+         b->X[(size_t)b->recvind[i]*blockSize+c] = b->rbuf[(size_t)i*blockSize+c];
+      }
+   }
+
+   /* Do the multiply */
+
+   for (row=0; row<nLocal; row++) {
+      MatrixGetRow(mat, row, &len, &ind, &val);
+      for (c=0; c<blockSize; c++) b->row[c] = 0.0;
+      for (j=0; j<len; j++) {
+         double *xj = &b->X[(size_t)ind[j]*blockSize];
+         for (c=0; c<blockSize; c++) b->row[c] += val[j]*xj[c];
+      }
+      for (c=0; c<blockSize; c++) y[row+ldy*c] = b->row[c];
+   }
+}
+
+/******************************************************************************
+ * y = A'*x for a block of vectors; x and y may be the same
+ *
+******************************************************************************/
+static void MatrixMatvecTransBlock(Matrix *mat, double *x, PRIMME_INT ldx,
+      double *y, PRIMME_INT ldy, int blockSize) {
+
+   ParaSailsBlock *b = getBlockParaSails(mat, blockSize);
+   int nLocal = mat->end_row - mat->beg_row + 1;
+   int row, i, j, c, len, *ind;
+   double *val;
+
+   /* Do the multiply, accumulating the contributions to external rows */
+
+   for (i=0; i<(nLocal+b->recvptr[b->num_recv])*blockSize; i++) b->X[i] = 0.0;
+   for (row=0; row<nLocal; row++) {
+      MatrixGetRow(mat, row, &len, &ind, &val);
+      for (c=0; c<blockSize; c++) b->row[c] = x[row+ldx*c];
+      for (j=0; j<len; j++) {
+         double *Xj = &b->X[(size_t)ind[j]*blockSize];
+         for (c=0; c<blockSize; c++) Xj[c] += val[j]*b->row[c];
+      }
+   }
+
+   /* Send the external contributions back to their owners */
+
+   for (i=0; i<b->recvptr[b->num_recv]; i++) {
+      for (c=0; c<blockSize; c++) {
+         b->rbuf[(size_t)i*blockSize+c] = b->X[(size_t)b->recvind[i]*blockSize+c];
+      }
+   }
+   startExchangeParaSails(b, blockSize, 1);
+   for (row=0; row<nLocal; row++) {
+      for (c=0; c<blockSize; c++) {
+         y[row+ldy*c] = b->X[(size_t)row*blockSize+c];
+      }
+   }
+   waitExchangeParaSails(b);
+   for (i=0; i<b->sendptr[b->num_send]; i++) {
+      for (c=0; c<blockSize; c++) {
+         y[b->sendind[i]+ldy*c] += b->sbuf[(size_t)i*blockSize+c];
+      }
+   }
+}
+
+/******************************************************************************
+ * Applies the PARALLEL matrix vector mulitplication of a block of vectors.
+ *
+******************************************************************************/
+void ParaSailsMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+   int *blockSize, primme_params *primme, int *ierr) {
+
+   MatrixMatvecBlock((Matrix *)primme->matrix, (double *)x, *ldx, (double *)y,
+         *ldy, *blockSize);
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Apply the PARALLEL Parasails preconditioner to a block of vectors, the
+ * same as ParaSailsApply() does for a single vector.
+ *
+******************************************************************************/
+void ApplyPrecParaSails(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+   int *blockSize, primme_params *primme, int *ierr) {
+
+   ParaSails *ps = (ParaSails *)primme->preconditioner;
 
-   for (i=0;i<*blockSize;i++) {
-     ParaSailsApply(primme->preconditioner, &xvec[primme->nLocal*i], 
-                                                 &yvec[primme->nLocal*i]);
+   MatrixMatvecBlock(ps->M, (double *)x, *ldx, (double *)y, *ldy, *blockSize);
+   if (ps->symmetric) {
+      MatrixMatvecTransBlock(ps->M, (double *)y, *ldy, (double *)y, *ldy,
+            *blockSize);
    }
+   *ierr = 0;
 }
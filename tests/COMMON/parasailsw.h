@@ -36,12 +36,13 @@
 int readMatrixAndPrecondParaSails(const char* matrixFileName, double shift,
                                   int level, double threshold, double filter,
                                   int isymm, MPI_Comm comm, double *fnorm,
-                                  int *n, int *nLocal_, int *numProc_, int *procID_,
+                                  int *m, int *n, int *mLocal_, int *nLocal_,
+                                  int *numProcs_, int *procID_,
                                   Matrix **pmatrix, ParaSails **pfactor);
-void ParaSailsMatrixMatvec(void *x, void *y, int *blockSize, 
-                           primme_params *primme);
-void ApplyPrecParaSails(void *x, void *y, int *blockSize,
-   primme_params *primme);
+void ParaSailsMatrixMatvec(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+   int *blockSize, primme_params *primme, int *ierr);
+void ApplyPrecParaSails(void *x, PRIMME_INT *ldx, void *y, PRIMME_INT *ldy,
+   int *blockSize, primme_params *primme, int *ierr);
 
 #define PARASAILS_H
 #endif
@@ -97,6 +97,8 @@ int read_solver_params(char *configFileName, char *outputFileName,
                READ_METHOD(PRIMME_STEEPEST_DESCENT);
                READ_METHOD(PRIMME_LOBPCG_OrthoBasis);
                READ_METHOD(PRIMME_LOBPCG_OrthoBasis_Window);
+               READ_METHOD(PRIMME_GD_plusK_sStep);
+               READ_METHOD(PRIMME_Lanczos);
                #undef READ_METHOD
             }
             if (ret == 0) {
@@ -133,6 +135,30 @@ int read_solver_params(char *configFileName, char *outputFileName,
          #define OPTIONParams(S, F, V) if (strcmp(stringValue, #V) == 0) { primme-> S ## Params . F = V; ret = 1; }
   
          READ_FIELD(printLevel, "%d");
+         READ_FIELD(numThreads, "%d");
+         READ_FIELD(firstTouch, "%d");
+         READ_FIELD(sStepSize, "%d");
+         READ_FIELD(dcMinBasisSize, "%d");
+         READ_FIELD(incrementalRR, "%d");
+         READ_FIELD(pipelinedQMR, "%d");
+         READ_FIELD(innerSinglePrecision, "%d");
+         READ_FIELD(chebyshevDegree, "%d");
+         READ_FIELD(dynamicBlockSize, "%d");
+         READ_FIELD(warmStart, "%d");
+         READ_FIELD(lockingBatchSize, "%d");
+         READ_FIELD(lockedPanelSize, "%d");
+         READ_FIELD(traceSize, "%d");
+         READ_FIELD(monitorEvents, "%d");
+         READ_FIELD(monitorInterval, "%le");
+         READ_FIELD(rowMajorOPs, "%d");
+         READ_FIELD(checkpointInterval, "%d");
+         READ_FIELD(precondShiftTol, "%le");
+         READ_FIELD(precisionCascade, "%d");
+         READ_FIELD(multiShiftBlock, "%d");
+         READ_FIELD(evalsOnly, "%d");
+         READ_FIELD(lockedSinglePrecision, "%d");
+         READ_FIELD(basisPanelRows, "%" PRIMME_INT_P);
+         READ_FIELD(statsImbalance, "%d");
          READ_FIELD(numEvals, "%d");
          READ_FIELD(aNorm, "%le");
          READ_FIELD(eps, "%le");
@@ -162,6 +188,20 @@ int read_solver_params(char *configFileName, char *outputFileName,
             OPTION(initBasisMode, primme_init_user)
          );
 
+         READ_FIELD_OP(orth,
+            OPTION(orth, primme_orth_default)
+            OPTION(orth, primme_orth_vector)
+            OPTION(orth, primme_orth_block)
+            OPTION(orth, primme_orth_lowsync)
+            OPTION(orth, primme_orth_selective)
+            OPTION(orth, primme_orth_adaptive)
+         );
+
+         READ_FIELD_OP(matvecHalfType,
+            OPTION(matvecHalfType, primme_half_fp16)
+            OPTION(matvecHalfType, primme_half_bf16)
+         );
+
          READ_FIELD(numTargetShifts, "%d");
          if (strcmp(field, "targetShifts") == 0) {
             ret = 1;
@@ -338,9 +378,48 @@ int read_driver_params(char *configFileName, driver_params *driver) {
          else if (strcmp(ident, "driver.checkXFile") == 0) {
             ret = fscanf(configFile, "%s", driver->checkXFileName);
          }
+         else if (strcmp(ident, "driver.traceFile") == 0) {
+            ret = fscanf(configFile, "%s", driver->traceFileName);
+         }
+         else if (strcmp(ident, "driver.statsFile") == 0) {
+            ret = fscanf(configFile, "%s", driver->statsFileName);
+         }
+         else if (strcmp(ident, "driver.tuneFile") == 0) {
+            ret = fscanf(configFile, "%s", driver->tuneFileName);
+         }
+         else if (strcmp(ident, "driver.tuneMaxMatvecs") == 0) {
+            ret = fscanf(configFile, "%" PRIMME_INT_P, &driver->tuneMaxMatvecs);
+         }
+         else if (strcmp(ident, "driver.tuneMatvecCost") == 0) {
+            ret = fscanf(configFile, "%le", &driver->tuneMatvecCost);
+         }
          else if (strcmp(ident, "driver.checkInterface") == 0) {
             ret = fscanf(configFile, "%d", &driver->checkInterface);
          }
+         else if (strcmp(ident, "driver.matvecProject") == 0) {
+            ret = fscanf(configFile, "%d", &driver->matvecProject);
+         }
+         else if (strcmp(ident, "driver.matvecNormal") == 0) {
+            ret = fscanf(configFile, "%d", &driver->matvecNormal);
+         }
+         else if (strcmp(ident, "driver.matvecStream") == 0) {
+            ret = fscanf(configFile, "%d", &driver->matvecStream);
+         }
+         else if (strcmp(ident, "driver.mapEvecs") == 0) {
+            ret = fscanf(configFile, "%d", &driver->mapEvecs);
+         }
+         else if (strcmp(ident, "driver.mapBasis") == 0) {
+            ret = fscanf(configFile, "%d", &driver->mapBasis);
+         }
+         else if (strcmp(ident, "driver.matvecAsync") == 0) {
+            ret = fscanf(configFile, "%d", &driver->matvecAsync);
+         }
+         else if (strcmp(ident, "driver.matvecHalf") == 0) {
+            ret = fscanf(configFile, "%d", &driver->matvecHalf);
+         }
+         else if (strcmp(ident, "driver.matrixPowers") == 0) {
+            ret = fscanf(configFile, "%d", &driver->matrixPowers);
+         }
          else if (strcmp(ident, "driver.matrixChoice") == 0) {
             ret = fscanf(configFile, "%s", stringValue);
             if (ret == 1) {
@@ -408,6 +487,9 @@ int read_driver_params(char *configFileName, driver_params *driver) {
          else if (strcmp(ident, "driver.filter") == 0) {
             ret = fscanf(configFile, "%lf", &driver->filter);
          }
+         else if (strcmp(ident, "driver.precBlockSize") == 0) {
+            ret = fscanf(configFile, "%d", &driver->precBlockSize);
+         }
          else if (strncmp(ident, "driver.", 7) == 0) {
             fprintf(stderr, 
               "ERROR(read_driver_params): Invalid parameter '%s'\n", ident);
@@ -454,19 +536,39 @@ fprintf(outputFile, "driver.initialGuessesFile = %s\n", driver.initialGuessesFil
 fprintf(outputFile, "driver.initialGuessesPert = %e\n", driver.initialGuessesPert);
 fprintf(outputFile, "driver.saveXFile     = %s\n", driver.saveXFileName);
 fprintf(outputFile, "driver.checkXFile    = %s\n", driver.checkXFileName);
+fprintf(outputFile, "driver.traceFile     = %s\n", driver.traceFileName);
+fprintf(outputFile, "driver.statsFile     = %s\n", driver.statsFileName);
+fprintf(outputFile, "driver.tuneFile      = %s\n", driver.tuneFileName);
+fprintf(outputFile, "driver.tuneMaxMatvecs = %" PRIMME_INT_P "\n", driver.tuneMaxMatvecs);
+fprintf(outputFile, "driver.tuneMatvecCost = %e\n", driver.tuneMatvecCost);
 fprintf(outputFile, "driver.checkInterface = %d\n", driver.checkInterface);
+fprintf(outputFile, "driver.matvecProject = %d\n", driver.matvecProject);
+fprintf(outputFile, "driver.matvecNormal  = %d\n", driver.matvecNormal);
+fprintf(outputFile, "driver.matvecStream  = %d\n", driver.matvecStream);
+fprintf(outputFile, "driver.mapEvecs      = %d\n", driver.mapEvecs);
+fprintf(outputFile, "driver.mapBasis      = %d\n", driver.mapBasis);
+fprintf(outputFile, "driver.matvecAsync   = %d\n", driver.matvecAsync);
+fprintf(outputFile, "driver.matvecHalf    = %d\n", driver.matvecHalf);
+fprintf(outputFile, "driver.matrixPowers  = %d\n", driver.matrixPowers);
 fprintf(outputFile, "driver.PrecChoice    = %s\n", strPrecChoice[driver.PrecChoice]);
 fprintf(outputFile, "driver.shift         = %e\n", driver.shift);
 fprintf(outputFile, "driver.isymm         = %d\n", driver.isymm);
 fprintf(outputFile, "driver.level         = %d\n", driver.level);
 fprintf(outputFile, "driver.threshold     = %f\n", driver.threshold);
-fprintf(outputFile, "driver.filter        = %f\n\n", driver.filter);
+fprintf(outputFile, "driver.filter        = %f\n", driver.filter);
+fprintf(outputFile, "driver.precBlockSize = %d\n\n", driver.precBlockSize);
 
 }
 
 void driver_display_method(primme_preset_method method, const char* methodstr, FILE *outputFile) {
 
-   const char *strMethod[] = {
+   fprintf(outputFile, "%s               = %s\n", methodstr, driver_method_name(method));
+
+}
+
+const char *driver_method_name(primme_preset_method method) {
+
+   static const char *strMethod[] = {
       "PRIMME_DEFAULT_METHOD",
       "PRIMME_DYNAMIC",
       "PRIMME_DEFAULT_MIN_TIME",
@@ -482,9 +584,11 @@ void driver_display_method(primme_preset_method method, const char* methodstr, F
       "PRIMME_JDQMR_ETol",
       "PRIMME_STEEPEST_DESCENT",
       "PRIMME_LOBPCG_OrthoBasis",
-      "PRIMME_LOBPCG_OrthoBasis_Window"};
+      "PRIMME_LOBPCG_OrthoBasis_Window",
+      "PRIMME_GD_plusK_sStep",
+      "PRIMME_Lanczos"};
 
-   fprintf(outputFile, "%s               = %s\n", methodstr, strMethod[method]);
+   return strMethod[method];
 
 }
 
@@ -581,6 +685,7 @@ int read_solver_params_svds(char *configFileName, char *outputFileName,
          READ_FIELD(maxBasisSize, "%d");
          READ_FIELD(maxBlockSize, "%d");
          READ_FIELD(maxMatvecs, "%" PRIMME_INT_P);
+         READ_FIELD(maxPasses, "%" PRIMME_INT_P);
 
          READ_FIELD_OP(target,
             OPTION(target, primme_svds_smallest)
@@ -609,6 +714,9 @@ int read_solver_params_svds(char *configFileName, char *outputFileName,
          READ_FIELD(locking, "%d");
          READ_FIELD(initSize, "%d");
          READ_FIELD(numOrthoConst, "%d");
+         READ_FIELD(rangeFinderPasses, "%d");
+         READ_FIELD(traceSize, "%d");
+         READ_FIELD(dynamicMethodSwitch, "%d");
 
          if (strcmp(field, "iseed") == 0) {
             ret = 1;
@@ -692,7 +800,8 @@ int read_solver_params_svds(char *configFileName, char *outputFileName,
 #ifdef USE_MPI
 
 /******************************************************************************
- * Function to broadcast the primme data structure to all processors
+ * Function to broadcast the primme data structure to all processors;
+ * method is not sent if it is NULL
  *
  * EXCEPTIONS: procID and seed[] are not copied from processor 0. 
  *             Each process creates their own.
@@ -708,13 +817,26 @@ void broadCast(primme_params *primme, primme_preset_method *method,
       MPI_Bcast(driver->initialGuessesFileName, 1024, MPI_CHAR, 0, comm);
       MPI_Bcast(driver->saveXFileName, 1024, MPI_CHAR, 0, comm);
       MPI_Bcast(driver->checkXFileName, 1024, MPI_CHAR, 0, comm);
+      MPI_Bcast(driver->traceFileName, 1024, MPI_CHAR, 0, comm);
+      MPI_Bcast(driver->tuneFileName, 1024, MPI_CHAR, 0, comm);
+      MPI_Bcast(&driver->tuneMaxMatvecs, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->tuneMatvecCost, 1, MPI_DOUBLE, 0, comm);
       MPI_Bcast(&driver->initialGuessesPert, 1, MPI_DOUBLE, 0, comm);
       MPI_Bcast(&driver->matrixChoice, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->PrecChoice, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->matvecProject, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->matvecNormal, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->matvecStream, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->mapEvecs, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->mapBasis, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->matvecAsync, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->matvecHalf, 1, MPI_INT, 0, comm);
+      MPI_Bcast(&driver->matrixPowers, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->isymm, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->level, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->threshold, 1, MPI_DOUBLE, 0, comm);
       MPI_Bcast(&driver->filter, 1, MPI_DOUBLE, 0, comm);
+      MPI_Bcast(&driver->precBlockSize, 1, MPI_INT, 0, comm);
       MPI_Bcast(&driver->shift, 1, MPI_DOUBLE, 0, comm);
    }
 
@@ -760,7 +882,7 @@ void broadCast(primme_params *primme, primme_preset_method *method,
    MPI_Bcast(&(primme->correctionParams.projectors.SkewX),  1, MPI_INT, 0,comm);
    MPI_Bcast(&(primme->correctionParams.projectors.SkewX),  1, MPI_INT, 0,comm);
 
-   MPI_Bcast(method, 1, MPI_INT, 0, comm);
+   if (method) MPI_Bcast(method, 1, MPI_INT, 0, comm);
 }
 
 /******************************************************************************
@@ -778,6 +900,7 @@ void broadCast_svds(primme_svds_params *primme_svds, primme_svds_preset_method *
    MPI_Bcast(driver->initialGuessesFileName, 1024, MPI_CHAR, 0, comm);
    MPI_Bcast(driver->saveXFileName, 1024, MPI_CHAR, 0, comm);
    MPI_Bcast(driver->checkXFileName, 1024, MPI_CHAR, 0, comm);
+   MPI_Bcast(driver->traceFileName, 1024, MPI_CHAR, 0, comm);
    MPI_Bcast(&driver->initialGuessesPert, 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&driver->matrixChoice, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->PrecChoice, 1, MPI_INT, 0, comm);
@@ -785,6 +908,7 @@ void broadCast_svds(primme_svds_params *primme_svds, primme_svds_preset_method *
    MPI_Bcast(&driver->level, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->threshold, 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&driver->filter, 1, MPI_DOUBLE, 0, comm);
+   MPI_Bcast(&driver->precBlockSize, 1, MPI_INT, 0, comm);
    MPI_Bcast(&driver->shift, 1, MPI_DOUBLE, 0, comm);
 
    MPI_Bcast(&(primme_svds->numSvals), 1, MPI_INT, 0, comm);
@@ -800,9 +924,12 @@ void broadCast_svds(primme_svds_params *primme_svds, primme_svds_preset_method *
    MPI_Bcast(&(primme_svds->locking), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->initSize), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->numOrthoConst), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme_svds->rangeFinderPasses), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme_svds->dynamicMethodSwitch), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->maxBasisSize), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->maxBlockSize), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->maxMatvecs), 1, MPI_INT, 0, comm);
+   MPI_Bcast(&(primme_svds->maxPasses), 1, MPI_INT, 0, comm);
    MPI_Bcast(&(primme_svds->aNorm), 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&(primme_svds->eps), 1, MPI_DOUBLE, 0, comm);
    MPI_Bcast(&(primme_svds->printLevel), 1, MPI_INT, 0, comm);
@@ -837,6 +964,23 @@ void par_GlobalSumDouble(void *sendBuf, void *recvBuf, int *count,
 #endif
 }
 
+#if MPI_VERSION >= 3
+void par_GlobalSumDoubleStart(void *sendBuf, void *recvBuf, int *count, 
+                         primme_params *primme, void **request, int *ierr) {
+   MPI_Comm communicator = *(MPI_Comm *) primme->commInfo;
+   MPI_Request *r = (MPI_Request *) malloc(sizeof(MPI_Request));
+
+   *request = r;
+   *ierr = MPI_Iallreduce(sendBuf, recvBuf, *count, MPI_DOUBLE, MPI_SUM,
+         communicator, r);
+}
+
+void par_GlobalSumDoubleWait(void *request, primme_params *primme, int *ierr) {
+   *ierr = MPI_Wait((MPI_Request *) request, MPI_STATUS_IGNORE);
+   free(request);
+}
+#endif
+
 void par_GlobalSumDoubleSvds(void *sendBuf, void *recvBuf, int *count, 
                          primme_svds_params *primme_svds, int *ierr) {
    MPI_Comm communicator = *(MPI_Comm *) primme_svds->commInfo;
@@ -64,7 +64,20 @@ typedef struct driver_params {
    char saveXFileName[1024];
    double initialGuessesPert;
    char checkXFileName[1024];
+   char traceFileName[1024];  /* write a trace of the solver events */
+   char statsFileName[1024];  /* append a CSV line with the stats of every run */
+   char tuneFileName[1024];   /* write the best configuration of a tuning sweep */
+   PRIMME_INT tuneMaxMatvecs; /* cap on the matvecs of every tuning trial */
+   double tuneMatvecCost;     /* seconds per matvec in the tuning cost model */
    int checkInterface;
+   int matvecProject;   /* use the fused matvec-and-project callback */
+   int matvecNormal;    /* use the fused product with A'*A or A*A' (svds) */
+   int matvecStream;    /* rows per block read from a mapped file (svds) */
+   int mapEvecs;        /* keep evecs in a mapped file */
+   int mapBasis;        /* keep the workspace with V and W in a mapped file */
+   int matvecAsync;     /* use the nonblocking matvec callbacks */
+   int matvecHalf;      /* use the matvec on 16-bit vectors */
+   int matrixPowers;    /* use the matrix-powers callback */
 
    driver_mat matrixChoice;
 
@@ -77,6 +90,7 @@ typedef struct driver_params {
    double threshold;
    double filter;
    double shift;
+   int precBlockSize;   /* block size of bjacobi with native (svds) */
    
 } driver_params;
 
@@ -92,11 +106,17 @@ int read_solver_params_svds(char *configFileName, char *outputFileName,
 int read_driver_params(char *configFileName, driver_params *driver);
 void driver_display_params(driver_params driver, FILE *outputFile);
 void driver_display_method(primme_preset_method method, const char *methodstr, FILE *outputFile);
+const char *driver_method_name(primme_preset_method method);
 void driver_display_methodsvd(primme_svds_preset_method method, const char *methodstr, FILE *outputFile);
 #ifdef USE_MPI
 #include <mpi.h>
 void par_GlobalSumDouble(void *sendBuf, void *recvBuf, int *count, 
                          primme_params *primme, int *ierr);
+#if MPI_VERSION >= 3
+void par_GlobalSumDoubleStart(void *sendBuf, void *recvBuf, int *count, 
+                         primme_params *primme, void **request, int *ierr);
+void par_GlobalSumDoubleWait(void *request, primme_params *primme, int *ierr);
+#endif
 void par_GlobalSumDoubleSvds(void *sendBuf, void *recvBuf, int *count, 
                          primme_svds_params *primme, int *ierr);
 void broadCast_svds(primme_svds_params *primme_svds, primme_svds_preset_method *method,
@@ -27,7 +27,7 @@
  *
  *  Parallel driver for PRIMME. Calling format:
  *
- *             primme DriverConfigFileName SolverConfigFileName
+ *             primme DriverConfigFileName [SolverConfigFileName ...]
  *
  *  DriverConfigFileName  includes the path and filename of the matrix
  *                            as well as preconditioning information (eg., 
@@ -45,6 +45,17 @@
  *                            LeanConf  Use a preset method and some customization
  *                            MinConf   Provide ONLY a preset method and numEvals.
  *
+ *                            If several are given, the matrix and the
+ *                            preconditioner are set up once and every file
+ *                            is solved in turn; with driver.statsFile, a CSV
+ *                            line with the stats of every run is appended.
+ *
+ *                            With driver.tuneFile, the first file is instead
+ *                            the base of short trial solves over presets,
+ *                            block and basis sizes; the fastest one is written
+ *                            to driver.tuneFile as a solver config file,
+ *                            which is then solved in full.
+ *
  ******************************************************************************/
 
 #include <stdlib.h>
@@ -53,6 +64,8 @@
 #include <unistd.h>
 #include <math.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 #ifdef USE_MPI
 #  include <mpi.h>
@@ -78,9 +91,33 @@ PetscLogEvent PRIMME_GLOBAL_SUM;
 /* wtime.h header file is included so primme's timimg functions can be used */
 #include "../../src/include/wtime.h"
 
+/* Parameters tried in a tuning trial, and its projected cost */
+typedef struct tuneTrial {
+   primme_preset_method method;
+   int maxBlockSize, maxBasisSize, minRestartSize;
+   int converged;
+   double cost;
+} tuneTrial;
+
 static int real_main (int argc, char *argv[]);
+static int runSolver(char *SolverConfigFileName, driver_params *driver,
+      primme_params *opers, int *permutation, FILE **outputFile,
+      FILE *statsFile, tuneTrial *trial);
+static int tuneSolver(char *SolverConfigFileName, driver_params *driver,
+      primme_params *opers, int *permutation, FILE **outputFile,
+      FILE *statsFile);
 static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int **permutation);
+static void shareMatrixAndPrecond(primme_params *opers, primme_params *primme);
 static int destroyMatrixAndPrecond(driver_params *driver, primme_params *primme, int *permutation);
+static SCALAR *mapArray(size_t size);
+static void pageLockedEvecs(void *panel, PRIMME_INT *ldpanel, int *numCols,
+      int *needed, primme_params *primme, int *ierr);
+static void pageBasis(void *panel, PRIMME_INT *ldpanel, PRIMME_INT *numRows,
+      int *numCols, int *needed, primme_params *primme, int *ierr);
+
+/* The workspace mapped with driver.mapBasis; pageBasis only drops pages */
+/* in it                                                                 */
+static char *mappedWork = NULL, *mappedWorkEnd = NULL;
 
 
 
@@ -124,22 +161,147 @@ int main (int argc, char *argv[]) {
 #define __FUNCT__ "real_main"
 static int real_main (int argc, char *argv[]) {
 
+   /* Files */
+   char *DriverConfigFileName=NULL, **SolverConfigFileNames=NULL;
+   int numSolverConfigs;
+   FILE *outputFile=NULL, *statsFile=NULL;
+   
+   /* Driver parameters, and matrix and preconditioner shared by all runs */
+   driver_params driver;
+   primme_params opers;
+   int *permutation = NULL;
+
+   /* Other miscellaneous items */
+   int ret=0, run;
+   int master = 1;
+
+#ifdef USE_MPI
+   int procID;
+   MPI_Comm_rank(MPI_COMM_WORLD, &procID);
+   master = (procID == 0);
+#endif
+
+   /* ------------------------------------------------------------------ */
+   /* Get from command line the names for the driver config file and the */
+   /* solver config files; the driver config file is also the solver     */
+   /* config file if no other is given. Every solver config file is run  */
+   /* on the same matrix and preconditioner.                             */
+   /* NOTE: PETSc arguments starts with '-' and they shouldn't be        */
+   /*       considered as configuration files.                           */
+   /* ------------------------------------------------------------------ */
+
+   if (argc < 2) {
+      if (master) fprintf(stderr, "Invalid number of arguments.\n");
+      return(-1);
+   }
+   DriverConfigFileName = argv[1];
+   for (numSolverConfigs=0; numSolverConfigs+2 < argc
+         && argv[numSolverConfigs+2][0] != '-'; numSolverConfigs++);
+   if (numSolverConfigs == 0) {
+      SolverConfigFileNames = &argv[1];
+      numSolverConfigs = 1;
+   }
+   else {
+      SolverConfigFileNames = &argv[2];
+   }
+
+   primme_initialize(&opers);
+   opers.aNorm = -1.0;
+
+   if (master) {
+      /* ----------------------------- */
+      /* Read in the driver parameters */
+      /* ----------------------------- */
+      if (read_driver_params(DriverConfigFileName, &driver) < 0) {
+         fprintf(stderr, "Reading driver parameters failed\n");
+         fflush(stderr);
+         return(-1);
+      }
+
+      /* Append the stats of every run to statsFile, with a header if new */
+      if (driver.statsFileName[0]) {
+         if ((statsFile = fopen(driver.statsFileName, "a")) == NULL) {
+            fprintf(stderr, "Could not open stats file '%s'\n",
+                  driver.statsFileName);
+            return(-1);
+         }
+         if (ftell(statsFile) == 0) {
+            fprintf(statsFile, "matrix,config,n,method,maxBlockSize,"
+                  "maxBasisSize,minRestartSize,numEvals,converged,error,"
+                  "iterations,restarts,matvecs,preconds,orthoInnerProds,"
+                  "globalSums,wallclock,timeMatvec,timePrecond,timeOrtho,"
+                  "timeSolveH,timeRestart,timeUpdateVWXR,timeConvCheck,"
+                  "timeInnerSolve\n");
+         }
+      }
+   }
+
+#ifdef USE_MPI
+   /* ------------------------------------------ */
+   /* Send the driver parameters to all processes */
+   /* ------------------------------------------ */
+   broadCast(&opers, NULL, &driver, master, MPI_COMM_WORLD);
+#endif
+
+   /* ------------------------------------------------------ */
+   /* Set up matrix vector and preconditioner, once for all  */
+   /* ------------------------------------------------------ */
+   if (setMatrixAndPrecond(&driver, &opers, &permutation) != 0) return -1;
+
+   /* --------------------------------------------------------------------- */
+   /*                Run the d/zprimme solver on every config               */
+   /* --------------------------------------------------------------------- */
+
+   if (driver.tuneFileName[0]) {
+      if (tuneSolver(SolverConfigFileNames[0], &driver, &opers, permutation,
+               &outputFile, statsFile) != 0
+            || runSolver(driver.tuneFileName, &driver, &opers, permutation,
+               &outputFile, statsFile, NULL) != 0) {
+         ret = -1;
+      }
+   }
+   else for (run=0; run<numSolverConfigs; run++) {
+      if (runSolver(SolverConfigFileNames[run], &driver, &opers, permutation,
+               &outputFile, statsFile, NULL) != 0) {
+         ret = -1;
+      }
+   }
+
+   if (outputFile) fclose(outputFile);
+   if (statsFile) fclose(statsFile);
+   destroyMatrixAndPrecond(&driver, &opers, permutation);
+
+   return(ret);
+}
+
+/******************************************************************************
+ * Reads the solver config file, solves with the matrix and preconditioner in
+ * opers, and reports the results in outputFile and statsFile. The output
+ * file is opened in the first run and kept open for the next ones.
+ *
+ * If trial is given, its method, maxBlockSize and maxBasisSize (if nonzero)
+ * replace the ones in the file, the solve stops after driver->tuneMaxMatvecs
+ * matvecs, and the parameters used and the projected cost are returned in
+ * trial.
+ *
+******************************************************************************/
+
+static int runSolver(char *SolverConfigFileName, driver_params *driver,
+      primme_params *opers, int *permutation, FILE **outputFile,
+      FILE *statsFile, tuneTrial *trial) {
+
    /* Timing vars */
    double wt1,wt2;
 #if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
    double ut1,ut2,st1,st2;
 #endif
 
-   /* Files */
-   char *DriverConfigFileName=NULL, *SolverConfigFileName=NULL;
-   
    /* Driver and solver I/O arrays and parameters */
    double *evals, *rnorms;
    SCALAR *evecs;
-   driver_params driver;
+   int evecsCols;
    primme_params primme;
    primme_preset_method method=PRIMME_DEFAULT_METHOD;
-   int *permutation = NULL;
 
    /* Other miscellaneous items */
    int ret, retX=0;
@@ -160,40 +322,21 @@ static int real_main (int argc, char *argv[]) {
    primme_initialize(&primme);
 
    if (master) {
-      /* ------------------------------------------------------------ */
-      /* Get from command line the names for the 1 or 2 config files  */
-      /* NOTE: PETSc arguments starts with '-' and they shouldn't be  */
-      /*       considered as configuration files.                     */
-      /* ------------------------------------------------------------ */
-   
-      if (argc == 2 || (argc > 2 && argv[2][0] == '-')) {
-         DriverConfigFileName = argv[1];
-         SolverConfigFileName = argv[1];
-      } else if (argc >= 3) {
-         DriverConfigFileName = argv[1];
-         SolverConfigFileName = argv[2];
-      } else {
-         fprintf(stderr, "Invalid number of arguments.\n");
-         return(-1);
-      }
-   
-      /* ----------------------------- */
-      /* Read in the driver parameters */
-      /* ----------------------------- */
-      if (read_driver_params(DriverConfigFileName, &driver) < 0) {
-         fprintf(stderr, "Reading driver parameters failed\n");
-         fflush(stderr);
-         return(-1);
-      }
-   
       /* --------------------------------------- */
       /* Read in the PRIMME configuration file   */
       /* --------------------------------------- */
-      if (read_solver_params(SolverConfigFileName, driver.outputFileName, 
-                           &primme, "primme.", &method, "method") < 0) {
+      if (read_solver_params(SolverConfigFileName,
+               *outputFile ? "" : driver->outputFileName, &primme, "primme.",
+               &method, "method") < 0) {
          fprintf(stderr, "Reading solver parameters failed\n");
          return(-1);
       }
+      if (*outputFile) {
+         primme.outputFile = *outputFile;
+      }
+      else {
+         *outputFile = primme.outputFile;
+      }
    }
 
 #ifdef USE_MPI
@@ -201,13 +344,29 @@ static int real_main (int argc, char *argv[]) {
    /* Send read common primme members to all processors */ 
    /* Setup the primme members local to this processor  */ 
    /* ------------------------------------------------- */
-   broadCast(&primme, &method, &driver, master, comm);
+   broadCast(&primme, &method, NULL, master, comm);
 #endif
 
    /* --------------------------------------- */
    /* Set up matrix vector and preconditioner */
    /* --------------------------------------- */
-   if (setMatrixAndPrecond(&driver, &primme, &permutation) != 0) return -1;
+   shareMatrixAndPrecond(opers, &primme);
+
+   /* --------------------------------------- */
+   /* Replace the parameters under tuning     */
+   /* --------------------------------------- */
+   if (trial) {
+      method = trial->method;
+      primme.maxBlockSize = trial->maxBlockSize;
+      if (trial->maxBasisSize > 0) {
+         primme.maxBasisSize = trial->maxBasisSize;
+         primme.minRestartSize = 0;
+      }
+      if (driver->tuneMaxMatvecs > 0 && (primme.maxMatvecs <= 0
+               || primme.maxMatvecs > driver->tuneMaxMatvecs)) {
+         primme.maxMatvecs = driver->tuneMaxMatvecs;
+      }
+   }
 
    /* --------------------------------------- */
    /* Pick one of the default methods(if set) */
@@ -227,6 +386,17 @@ static int real_main (int argc, char *argv[]) {
                                       procID, primme.intWorkSize);
    }
 
+   if (driver->mapBasis) {
+      /* Keep the workspace, with V and W, in a mapped file and release */
+      /* the panels of rows that PRIMME is done with                    */
+      primme.realWork = mapArray(primme.realWorkSize/sizeof(SCALAR) + 1);
+      ASSERT_MSG(primme.realWork != NULL, -1,
+            "Error mapping the workspace to a file\n");
+      mappedWork = (char *)primme.realWork;
+      mappedWorkEnd = mappedWork + primme.realWorkSize;
+      primme.basisPaging = pageBasis;
+   }
+
    /* --------------------------------------- */
    /* Display given parameter configuration   */
    /* Place this after the dprimme() to see   */
@@ -234,7 +404,7 @@ static int real_main (int argc, char *argv[]) {
    /* --------------------------------------- */
 
    if (master) {
-      driver_display_params(driver, primme.outputFile); 
+      driver_display_params(*driver, primme.outputFile); 
       primme_display_params(primme);
       driver_display_method(method, "method", primme.outputFile);
    }
@@ -243,11 +413,27 @@ static int real_main (int argc, char *argv[]) {
    /*                            Run the d/zprimme solver                   */
    /* --------------------------------------------------------------------- */
 
-   /* Allocate space for converged Ritz values and residual norms */
+   /* Write a trace of the solver events if asked */
+
+   if (driver->traceFileName[0]) primme.traceFileName = driver->traceFileName;
+
+   /* Allocate space for converged Ritz values and residual norms; with */
+   /* evalsOnly, evecs holds only a window of eigenvectors              */
 
    evals = (double *)primme_calloc(primme.numEvals, sizeof(double), "evals");
-   evecs = (SCALAR *)primme_calloc(primme.nLocal*primme.numEvals, 
-                                sizeof(SCALAR), "evecs");
+   evecsCols = primme.evalsOnly ? min(primme.numEvals, primme.maxBasisSize)
+                                : primme.numEvals;
+   if (driver->mapEvecs) {
+      /* Keep evecs in a mapped file and release the panels of locked */
+      /* vectors that PRIMME is done with                             */
+      evecs = mapArray(primme.nLocal*evecsCols);
+      ASSERT_MSG(evecs != NULL, -1, "Error mapping evecs to a file\n");
+      primme.lockedPaging = pageLockedEvecs;
+   }
+   else {
+      evecs = (SCALAR *)primme_calloc(primme.nLocal*evecsCols, 
+                                   sizeof(SCALAR), "evecs");
+   }
    rnorms = (double *)primme_calloc(primme.numEvals, sizeof(double), "rnorms");
 
    /* ------------------------ */
@@ -255,15 +441,15 @@ static int real_main (int argc, char *argv[]) {
    /* ------------------------ */
 
    /* Read initial guess from a file */
-   if (driver.initialGuessesFileName[0] && primme.initSize+primme.numOrthoConst > 0) {
+   if (driver->initialGuessesFileName[0] && primme.initSize+primme.numOrthoConst > 0) {
       int cols, i=0;
-      ASSERT_MSG(readBinaryEvecsAndPrimmeParams(driver.initialGuessesFileName, evecs, NULL, primme.n,
-                                                min(primme.initSize+primme.numOrthoConst, primme.numEvals),
+      ASSERT_MSG(readBinaryEvecsAndPrimmeParams(driver->initialGuessesFileName, evecs, NULL, primme.n,
+                                                min(primme.initSize+primme.numOrthoConst, evecsCols),
                                                 &cols, primme.nLocal, permutation, &primme) != 0, 1, "");
       primme.numOrthoConst = min(primme.numOrthoConst, cols);
 
       /* Perturb the initial guesses by a vector with some norm  */
-      if (driver.initialGuessesPert > 0) {
+      if (driver->initialGuessesPert > 0) {
          SCALAR *r = (SCALAR *)primme_calloc(primme.nLocal,sizeof(SCALAR), "random");
          double norm;
          int j;
@@ -271,7 +457,7 @@ static int real_main (int argc, char *argv[]) {
             Num_larnv_Sprimme(2, primme.iseed, primme.nLocal, r);
             norm = sqrt(REAL_PART(Num_dot_Sprimme(primme.nLocal, r, 1, r, 1)));
             for (j=0; j<primme.nLocal; j++)
-               evecs[primme.nLocal*i+j] += r[j]/norm*driver.initialGuessesPert;
+               evecs[primme.nLocal*i+j] += r[j]/norm*driver->initialGuessesPert;
          }
          free(r);
       }
@@ -300,15 +486,15 @@ static int real_main (int argc, char *argv[]) {
    primme_get_time(&ut2,&st2);
 #endif
 
-   if (driver.checkXFileName[0]) {
-      retX = check_solution(driver.checkXFileName, &primme, evals, evecs, rnorms, permutation, driver.checkInterface);
+   if (driver->checkXFileName[0]) {
+      retX = check_solution(driver->checkXFileName, &primme, evals, evecs, rnorms, permutation, driver->checkInterface);
    }
 
    /* --------------------------------------------------------------------- */
    /* Save evecs and primme params  (optional)                              */
    /* --------------------------------------------------------------------- */
-   if (driver.saveXFileName[0]) {
-      ASSERT_MSG(writeBinaryEvecsAndPrimmeParams(driver.saveXFileName, evecs, permutation, &primme) == 0, 1, "");
+   if (driver->saveXFileName[0]) {
+      ASSERT_MSG(writeBinaryEvecsAndPrimmeParams(driver->saveXFileName, evecs, permutation, &primme) == 0, 1, "");
    }
 
    /* --------------------------------------------------------------------- */
@@ -335,9 +521,17 @@ static int real_main (int argc, char *argv[]) {
       fprintf(primme.outputFile, "Restarts   : %-" PRIMME_INT_P "\n", primme.stats.numRestarts);
       fprintf(primme.outputFile, "Matvecs    : %-" PRIMME_INT_P "\n", primme.stats.numMatvecs);
       fprintf(primme.outputFile, "Preconds   : %-" PRIMME_INT_P "\n", primme.stats.numPreconds);
+      fprintf(primme.outputFile, "Ortho inner prods : %.0f\n", primme.stats.numOrthoInnerProds);
+      fprintf(primme.outputFile, "Global sums : %-" PRIMME_INT_P "\n", primme.stats.numGlobalSum);
       fprintf(primme.outputFile, "Time matvecs  : %f\n",  primme.stats.timeMatvec);
       fprintf(primme.outputFile, "Time precond  : %f\n",  primme.stats.timePrecond);
       fprintf(primme.outputFile, "Time ortho  : %f\n",  primme.stats.timeOrtho);
+      fprintf(primme.outputFile, "Time solve H  : %f\n",  primme.stats.timeSolveH);
+      fprintf(primme.outputFile, "Time restart  : %f\n",  primme.stats.timeRestart);
+      fprintf(primme.outputFile, "Time update VWXR : %f\n",  primme.stats.timeUpdateVWXR);
+      fprintf(primme.outputFile, "Time conv check  : %f\n",  primme.stats.timeConvCheck);
+      fprintf(primme.outputFile, "Time inner solve : %f\n",  primme.stats.timeInnerSolve);
+      fprintf(primme.outputFile, "Time workspace   : %f\n",  primme.stats.timeWorkspace);
       if (primme.locking && primme.intWork && primme.intWork[0] == 1) {
          fprintf(primme.outputFile, "\nA locking problem has occurred.\n");
          fprintf(primme.outputFile,
@@ -357,29 +551,175 @@ static int real_main (int argc, char *argv[]) {
          case -3: fprintf(primme.outputFile,
                "Recommended method for next run: DYNAMIC (close call)\n"); break;
       }
+
+      if (statsFile) {
+         fprintf(statsFile, "%s,%s,%" PRIMME_INT_P ",%s,%d,%d,%d,%d,%d,%d,"
+               "%" PRIMME_INT_P ",%" PRIMME_INT_P ",%" PRIMME_INT_P ","
+               "%" PRIMME_INT_P ",%.0f,%" PRIMME_INT_P ",%f,%f,%f,%f,%f,%f,"
+               "%f,%f,%f\n",
+               driver->matrixFileName, SolverConfigFileName, primme.n,
+               driver_method_name(method), primme.maxBlockSize,
+               primme.maxBasisSize, primme.minRestartSize, primme.numEvals,
+               primme.initSize, ret, primme.stats.numOuterIterations,
+               primme.stats.numRestarts, primme.stats.numMatvecs,
+               primme.stats.numPreconds, primme.stats.numOrthoInnerProds,
+               primme.stats.numGlobalSum, wt2-wt1, primme.stats.timeMatvec,
+               primme.stats.timePrecond, primme.stats.timeOrtho,
+               primme.stats.timeSolveH, primme.stats.timeRestart,
+               primme.stats.timeUpdateVWXR, primme.stats.timeConvCheck,
+               primme.stats.timeInnerSolve);
+         fflush(statsFile);
+      }
+
+      /* Project the time to converge all pairs from the trial: the time */
+      /* out of the matvecs plus the matvecs at driver->tuneMatvecCost, */
+      /* if given, scaled by the fraction of pairs that converged        */
+      if (trial) {
+         trial->maxBlockSize = primme.maxBlockSize;
+         trial->maxBasisSize = primme.maxBasisSize;
+         trial->minRestartSize = primme.minRestartSize;
+         trial->converged = primme.initSize;
+         trial->cost = wt2-wt1;
+         if (driver->tuneMatvecCost > 0.0) {
+            trial->cost += primme.stats.numMatvecs*driver->tuneMatvecCost
+               - primme.stats.timeMatvec;
+         }
+         if (primme.initSize <= 0 || (ret != 0 && ret != -3)) {
+            trial->cost = HUGE_VAL;
+         }
+         else {
+            trial->cost *= (double)primme.numEvals/primme.initSize;
+         }
+         if (ret == -3) ret = 0;
+      }
+
+      if (ret != 0) {
+         fprintf(primme.outputFile, 
+            "Error: dprimme returned with nonzero exit status: %d \n",ret);
+      }
+
+      if (retX != 0) {
+         fprintf(primme.outputFile, 
+            "Error: found some issues in the solution return by dprimme\n");
+      }
+      fflush(primme.outputFile);
    }
 
-   fclose(primme.outputFile);
-   destroyMatrixAndPrecond(&driver, &primme, permutation);
+   if (driver->mapBasis) {
+      munmap(mappedWork, sizeof(SCALAR)*(primme.realWorkSize/sizeof(SCALAR)
+               + 1));
+      mappedWork = mappedWorkEnd = NULL;
+      primme.realWork = NULL;
+   }
    primme_free(&primme);
+   if (primme.targetShifts) free(primme.targetShifts);
    free(evals);
-   free(evecs);
+   if (driver->mapEvecs) {
+      munmap(evecs, sizeof(SCALAR)*primme.nLocal*evecsCols);
+   }
+   else {
+      free(evecs);
+   }
    free(rnorms);
 
-   if (ret != 0 && master) {
-      fprintf(primme.outputFile, 
-         "Error: dprimme returned with nonzero exit status: %d \n",ret);
-      return -1;
+   if (ret != 0 || retX != 0) return -1;
+
+  return(0);
+}
+
+/******************************************************************************
+ * Runs short trials of the solver config file over several presets, block
+ * and basis sizes, and writes the config file with the parameters of the
+ * trial with the least projected cost to driver->tuneFileName. The trials are
+ * capped by driver->tuneMaxMatvecs. The tuned file is a copy of the given one
+ * followed by the tuned method and sizes, which override the previous ones
+ * when it is read by read_solver_params.
+ *
+******************************************************************************/
+
+static int tuneSolver(char *SolverConfigFileName, driver_params *driver,
+      primme_params *opers, int *permutation, FILE **outputFile,
+      FILE *statsFile) {
+
+   static const primme_preset_method methods[] = {PRIMME_DEFAULT_MIN_TIME,
+      PRIMME_DEFAULT_MIN_MATVECS, PRIMME_DYNAMIC, PRIMME_JDQMR,
+      PRIMME_GD_plusK, PRIMME_LOBPCG_OrthoBasis_Window};
+   static const int blockSizes[] = {1, 2, 4};
+   static const int basisSizes[] = {0, 16, 32, 64}; /* 0 is the preset's */
+   const int numMethods = sizeof(methods)/sizeof(methods[0]);
+   const int numBlockSizes = sizeof(blockSizes)/sizeof(blockSizes[0]);
+   const int numBasisSizes = sizeof(basisSizes)/sizeof(basisSizes[0]);
+
+   tuneTrial trial, best = {0};
+   int i, j, k, c, ret=0;
+   int master = 1;
+   FILE *in, *out;
+
+#ifdef USE_MPI
+   int procID;
+   MPI_Comm_rank(MPI_COMM_WORLD, &procID);
+   master = (procID == 0);
+#endif
+
+   best.cost = HUGE_VAL;
+   for (i=0; i<numMethods; i++) {
+      for (j=0; j<numBlockSizes; j++) {
+         for (k=0; k<numBasisSizes; k++) {
+            if (basisSizes[k] > 0 && basisSizes[k] < 4*blockSizes[j]) continue;
+            trial.method = methods[i];
+            trial.maxBlockSize = blockSizes[j];
+            trial.maxBasisSize = basisSizes[k];
+            trial.converged = 0;
+            trial.cost = HUGE_VAL;
+            runSolver(SolverConfigFileName, driver, opers, permutation,
+                  outputFile, statsFile, &trial);
+            if (master) {
+               fprintf(*outputFile, "Tuning: %s maxBlockSize %d maxBasisSize "
+                     "%d converged %d projected time %g\n",
+                     driver_method_name(trial.method), trial.maxBlockSize,
+                     trial.maxBasisSize, trial.converged, trial.cost);
+               if (trial.cost < best.cost) best = trial;
+            }
+         }
+      }
    }
 
-   if (retX != 0 && master) {
-      fprintf(primme.outputFile, 
-         "Error: found some issues in the solution return by dprimme\n");
-      return -1;
+   /* Write the base config file followed by the best parameters */
+   if (master && best.cost == HUGE_VAL) {
+      fprintf(stderr, "Tuning: no trial converged any pair; "
+            "increase driver.tuneMaxMatvecs\n");
+      ret = -1;
+   }
+   else if (master) {
+      in = fopen(SolverConfigFileName, "r");
+      out = in ? fopen(driver->tuneFileName, "w") : NULL;
+      if (out == NULL) {
+         fprintf(stderr, "Could not write tuned config file '%s'\n",
+               driver->tuneFileName);
+         if (in) fclose(in);
+         ret = -1;
+      }
+      else {
+         while ((c = fgetc(in)) != EOF) fputc(c, out);
+         fclose(in);
+         fprintf(out, "\n// Tuned on %s with trials of at most %"
+               PRIMME_INT_P " matvecs;\n// projected time %g\n",
+               driver->matrixFileName, driver->tuneMaxMatvecs, best.cost);
+         fprintf(out, "primme.maxBlockSize = %d\n", best.maxBlockSize);
+         fprintf(out, "primme.maxBasisSize = %d\n", best.maxBasisSize);
+         fprintf(out, "primme.minRestartSize = %d\n", best.minRestartSize);
+         driver_display_method(best.method, "method", out);
+         fclose(out);
+      }
    }
 
-  return(0);
+#ifdef USE_MPI
+   MPI_Bcast(&ret, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+
+   return ret;
 }
+
 /******************************************************************************/
 /* END OF MAIN DRIVER FUNCTION                                                */
 /******************************************************************************/
@@ -389,10 +729,6 @@ static int real_main (int argc, char *argv[]) {
 
 /******************************************************************************/
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int **permutation) {
    int numProcs=1;
    double aNorm;
@@ -435,17 +771,23 @@ static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int
       *(MPI_Comm*)primme->commInfo = MPI_COMM_WORLD;
 #  endif
       {
-         CSRMatrix *matrix, *prec;
+         CSRMatrix *matrix;
+         ILUTPrecNative *prec;
          double *diag;
-         /* Fix to use a single thread */
-         #ifdef _OPENMP
-         omp_set_num_threads(1);
-         #endif
-          
          if (readMatrixNative(driver->matrixFileName, &matrix, &aNorm) !=0 )
             return -1;
          primme->matrix = matrix;
          primme->matrixMatvec = CSRMatrixMatvec;
+         if (driver->matvecProject)
+            primme->matrixMatvecProject = CSRMatrixMatvecProject;
+         if (driver->matvecAsync) {
+            primme->matrixMatvecStart = CSRMatrixMatvecStart;
+            primme->matrixMatvecWait = CSRMatrixMatvecWait;
+         }
+         if (driver->matvecHalf)
+            primme->matrixMatvecHalf = CSRMatrixMatvecHalf;
+         if (driver->matrixPowers)
+            primme->matrixPowers = CSRMatrixPowers;
          primme->n = primme->nLocal = matrix->n;
          switch(driver->PrecChoice) {
          case driver_noprecond:
@@ -612,6 +954,10 @@ static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int
 
 #if defined(USE_MPI)
    primme->globalSumReal = par_GlobalSumDouble;
+#  if MPI_VERSION >= 3
+   primme->globalSumRealStart = par_GlobalSumDoubleStart;
+   primme->globalSumRealWait = par_GlobalSumDoubleWait;
+#  endif
 #endif
 
 #ifdef NOT_USE_ALIGNMENT
@@ -620,6 +966,35 @@ static int setMatrixAndPrecond(driver_params *driver, primme_params *primme, int
    return 0;
 }
 
+/******************************************************************************
+ * Copies into primme the matrix, the preconditioner and the distribution set
+ * up in opers by setMatrixAndPrecond, so that several solver configurations
+ * can run on them without reading the matrix again
+ *
+******************************************************************************/
+
+static void shareMatrixAndPrecond(primme_params *opers, primme_params *primme) {
+   primme->n = opers->n;
+   primme->nLocal = opers->nLocal;
+   primme->numProcs = opers->numProcs;
+   primme->procID = opers->procID;
+   primme->commInfo = opers->commInfo;
+   primme->matrix = opers->matrix;
+   primme->matrixMatvec = opers->matrixMatvec;
+   primme->matrixMatvecProject = opers->matrixMatvecProject;
+   primme->matrixMatvecStart = opers->matrixMatvecStart;
+   primme->matrixMatvecWait = opers->matrixMatvecWait;
+   primme->matrixMatvecHalf = opers->matrixMatvecHalf;
+   primme->matrixPowers = opers->matrixPowers;
+   primme->preconditioner = opers->preconditioner;
+   primme->applyPreconditioner = opers->applyPreconditioner;
+   primme->globalSumReal = opers->globalSumReal;
+   primme->globalSumRealStart = opers->globalSumRealStart;
+   primme->globalSumRealWait = opers->globalSumRealWait;
+   primme->ldOPs = opers->ldOPs;
+   if (primme->aNorm < 0) primme->aNorm = opers->aNorm;
+}
+
 static int destroyMatrixAndPrecond(driver_params *driver, primme_params *primme, int *permutation) {
    switch(driver->matrixChoice) {
    case driver_default:
@@ -641,7 +1016,7 @@ static int destroyMatrixAndPrecond(driver_params *driver, primme_params *primme,
          break;
       case driver_ilut:
          if (primme->preconditioner) {
-            freeCSRMatrix((CSRMatrix*)primme->preconditioner);
+            freeILUTPrecNative((ILUTPrecNative*)primme->preconditioner);
          }
          break;
       default:
@@ -720,3 +1095,86 @@ static int destroyMatrixAndPrecond(driver_params *driver, primme_params *primme,
    if (permutation) free(permutation);
    return 0;
 }
+
+/******************************************************************************
+ * Allocates an array of size elements backed by a temporary file, to test
+ * evecs or a workspace larger than the memory (see primme.lockedPanelSize
+ * and primme.basisPanelRows)
+ *
+******************************************************************************/
+
+static SCALAR *mapArray(size_t size) {
+   char fileName[] = "/tmp/primme_evecsXXXXXX";
+   size_t bytes = sizeof(SCALAR)*(size > 0 ? size : 1);
+   void *map;
+   int fd;
+
+   fd = mkstemp(fileName);
+   if (fd < 0) return NULL;
+   unlink(fileName);
+   if (ftruncate(fd, (off_t)bytes) != 0) {
+      close(fd);
+      return NULL;
+   }
+   map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   return map == MAP_FAILED ? NULL : (SCALAR *)map;
+}
+
+/******************************************************************************
+ * Reads in the panels of evecs that PRIMME asks for, and drops from memory
+ * the ones it has finished with; the changes are kept in the mapped file
+ *
+******************************************************************************/
+
+static void pageLockedEvecs(void *panel, PRIMME_INT *ldpanel, int *numCols,
+      int *needed, primme_params *primme, int *ierr) {
+
+   size_t page = (size_t)sysconf(_SC_PAGESIZE);
+   char *begin = (char *)((size_t)panel & ~(page - 1));
+   char *end = (char *)&((SCALAR *)panel)[*ldpanel*(*numCols-1)
+      + primme->nLocal];
+
+   /* Only drop the pages that are completely inside the panel */
+   if (!*needed) {
+      begin += ((size_t)panel & (page - 1)) ? page : 0;
+      end = (char *)((size_t)end & ~(page - 1));
+   }
+   if (end > begin) {
+      madvise(begin, end - begin, *needed ? MADV_WILLNEED : MADV_DONTNEED);
+   }
+   *ierr = 0;
+}
+
+/******************************************************************************
+ * Reads in the rows of V or W that PRIMME asks for, and drops from memory the
+ * ones it has finished with if they are in the mapped workspace; the changes
+ * are kept in the mapped file
+ *
+******************************************************************************/
+
+static void pageBasis(void *panel, PRIMME_INT *ldpanel, PRIMME_INT *numRows,
+      int *numCols, int *needed, primme_params *primme, int *ierr) {
+
+   size_t page = (size_t)sysconf(_SC_PAGESIZE);
+   int j;
+
+   (void)primme; /* unused parameter */
+
+   for (j=0; j < *numCols; j++) {
+      char *col = (char *)&((SCALAR *)panel)[*ldpanel*j];
+      char *begin = (char *)((size_t)col & ~(page - 1));
+      char *end = col + sizeof(SCALAR)*(*numRows);
+
+      /* Only drop the pages that are completely inside the panel */
+      if (!*needed) {
+         if (col < mappedWork || end > mappedWorkEnd) continue;
+         begin += ((size_t)col & (page - 1)) ? page : 0;
+         end = (char *)((size_t)end & ~(page - 1));
+      }
+      if (end > begin) {
+         madvise(begin, end - begin, *needed ? MADV_WILLNEED : MADV_DONTNEED);
+      }
+   }
+   *ierr = 0;
+}
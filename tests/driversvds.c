@@ -265,6 +265,10 @@ static int real_main (int argc, char *argv[]) {
    /*                            Run the d/zprimme_svds solver                   */
    /* --------------------------------------------------------------------- */
 
+   /* Write a trace of the solver events if asked */
+
+   if (driver.traceFileName[0]) primme_svds.traceFileName = driver.traceFileName;
+
    /* Allocate space for converged Ritz values and residual norms */
 
    svals = (double *)primme_calloc(primme_svds.numSvals, sizeof(double), "svals");
@@ -379,6 +383,7 @@ static int real_main (int argc, char *argv[]) {
          PRINT_STATS(primme_svds.primmeStage2.stats, "2sd ");
       }
       PRINT_STATS(primme_svds.stats, "");
+      fprintf(primme_svds.outputFile, "Passes      : %-" PRIMME_INT_P "\n", primme_svds.numPasses);
       if (primme_svds.locking && primme_svds.intWork && primme_svds.intWork[0] == 1) {
          fprintf(primme_svds.outputFile, "\nA locking problem has occurred.\n");
          fprintf(primme_svds.outputFile,
@@ -421,10 +426,6 @@ static int real_main (int argc, char *argv[]) {
 
 /******************************************************************************/
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 static int setMatrixAndPrecond(driver_params *driver,
       primme_svds_params *primme_svds, int **permutation) {
    int numProcs=1;
@@ -470,15 +471,12 @@ static int setMatrixAndPrecond(driver_params *driver,
       {
          CSRMatrix *matrix;
          double *diag;
-         /* Fix to use a single thread */
-         #ifdef _OPENMP
-         omp_set_num_threads(1);
-         #endif
-          
          if (readMatrixNative(driver->matrixFileName, &matrix, &aNorm) !=0 )
             return -1;
          primme_svds->matrix = matrix;
          primme_svds->matrixMatvec = CSRMatrixMatvecSVD;
+         if (driver->matvecNormal)
+            primme_svds->matrixMatvecNormal = CSRMatrixMatvecNormalSVD;
          primme_svds->m = primme_svds->mLocal = matrix->m;
          primme_svds->n = primme_svds->nLocal = matrix->n;
          switch(driver->PrecChoice) {
@@ -496,6 +494,26 @@ static int setMatrixAndPrecond(driver_params *driver,
             primme_svds->preconditioner = diag;
             primme_svds->applyPreconditioner = ApplyInvDavidsonNormalPrecNative;
             break;
+         case driver_normal:
+         case driver_bjacobi:
+            {
+               /* Incomplete Cholesky of A'A or AA' (normal), or */
+               /* Cholesky of its diagonal blocks (bjacobi)      */
+               NormalPrecNative *prec;
+               int bjacobi = driver->PrecChoice == driver_bjacobi;
+               if (createNormalPrecNative(matrix, driver->shift,
+                        bjacobi ? (driver->precBlockSize > 0 ?
+                           driver->precBlockSize : 16) : 0,
+                        bjacobi ? 0 : driver->level,
+                        bjacobi ? 0.0 : driver->threshold, &prec) != 0) {
+                  fprintf(stderr, "ERROR: failed to create the preconditioner!\n");
+                  return -1;
+               }
+               primme_svds->preconditioner = prec;
+               primme_svds->applyPreconditioner = ApplyNormalPrecNative;
+               primme_svds->preconditionerSetup = SetupNormalPrecNative;
+            }
+            break;
          case driver_ilut:
             fprintf(stderr, "ERROR: ilut preconditioner is not supported with NATIVE, use other!\n");
             return -1;
@@ -503,6 +521,17 @@ static int setMatrixAndPrecond(driver_params *driver,
             fprintf(stderr, "ERROR: preconditioner is not supported with NATIVE, use other!\n");
             return -1;
          }
+         if (driver->matvecStream) {
+            StreamCSRMatrix *stream;
+            if (createStreamCSRMatrix(matrix, driver->matvecStream, &stream) != 0) {
+               fprintf(stderr, "ERROR: failed to map the matrix on a file!\n");
+               return -1;
+            }
+            freeCSRMatrix(matrix);
+            primme_svds->matrix = stream;
+            primme_svds->matrixMatvec = StreamCSRMatrixMatvecSVD;
+            primme_svds->matrixMatvecNormal = NULL;
+         }
       }
 #endif
       break;
@@ -751,7 +780,10 @@ static int destroyMatrixAndPrecond(driver_params *driver, primme_svds_params *pr
       fprintf(stderr, "ERROR: NATIVE is needed!\n");
       return -1;
 #else
-      freeCSRMatrix((CSRMatrix*)primme_svds->matrix);
+      if (driver->matvecStream)
+         freeStreamCSRMatrix((StreamCSRMatrix*)primme_svds->matrix);
+      else
+         freeCSRMatrix((CSRMatrix*)primme_svds->matrix);
 
       switch(driver->PrecChoice) {
       case driver_noprecond:
@@ -760,6 +792,10 @@ static int destroyMatrixAndPrecond(driver_params *driver, primme_svds_params *pr
       case driver_jacobi_i:
          free(primme_svds->preconditioner);
          break;
+      case driver_normal:
+      case driver_bjacobi:
+         /* Freed by primme_svds_free through preconditionerSetup */
+         break;
       case driver_ilut:
          break;
       default:
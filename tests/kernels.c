@@ -0,0 +1,300 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2018 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: kernels.c
+ *
+ * Purpose - benchmark of the dense kernels that the eigensolver does every
+ *           iteration, called directly on random bases, apart from the
+ *           matrix-vector products:
+ *
+ *    ortho        orthogonalize blockSize vectors against a basis of
+ *                 basisSize vectors (ortho_Sprimme)
+ *    update_proj  new columns of H = V'*W (update_projection_Sprimme)
+ *    update_VWXR  Ritz vectors X = V*h, W*h and residuals R = W*h - X*diag(l),
+ *                 and their norms (Num_update_VWXR_Sprimme)
+ *    solve_H      eigendecomposition of the projected matrix (solve_H_Sprimme)
+ *    restart      thick restart V = V*h and W = W*h with basisSize/2 columns,
+ *                 the dense part of restart_Sprimme
+ *
+ *  For every kernel it reports the time, GFLOP/s, GB/s, the arithmetic
+ *  intensity of the model of flops and bytes of the kernel, and the fraction
+ *  of the roofline attained. The roofs are measured at the beginning: the
+ *  compute roof with a square matrix-matrix product, and the memory roof
+ *  with a copy of vectors larger than the cache.
+ *
+ *  Calling format:
+ *
+ *          primme_kernels_double [nLocal [basisSize [blockSize [reps]]]]
+ *
+ *  The defaults are 100000 rows, 32 basis vectors, block size 4 and 10
+ *  repetitions of every kernel.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "const.h"
+#include "numerical.h"
+#include "primme_interface.h"
+#include "wtime.h"
+#include "ortho.h"
+#include "update_projection.h"
+#include "solve_projection.h"
+#include "auxiliary_eigs.h"
+
+#ifdef USE_COMPLEX
+#  define FLOPS_PER_FMA 8.0
+#else
+#  define FLOPS_PER_FMA 2.0
+#endif
+
+static double peakFlops, peakBytes;
+
+static void report(const char *name, double time, double flops, double bytes) {
+   double intensity = flops/bytes;
+   double roof = min(peakFlops, intensity*peakBytes);
+
+   printf("%-12s %10.6f %10.2f %10.2f %10.3f %7.1f%%\n", name, time,
+         flops/time*1e-9, bytes/time*1e-9, intensity,
+         flops/time/roof*100.0);
+}
+
+static void measure_roofs(PRIMME_INT nLocal) {
+   int i, k = 512, reps = 5;
+   PRIMME_INT iseed[4] = {1, 2, 3, 5};
+   PRIMME_INT m = max(nLocal, 4000000);
+   SCALAR *A, *B, *C, *x, *y;
+   double t;
+
+   A = (SCALAR*)malloc(sizeof(SCALAR)*k*k*3);
+   B = A + k*k;
+   C = B + k*k;
+   Num_larnv_Sprimme(2, iseed, (PRIMME_INT)k*k*2, A);
+   Num_gemm_Sprimme("N", "N", k, k, k, 1.0, A, k, B, k, 0.0, C, k);
+   t = primme_get_wtime();
+   for (i=0; i<reps; i++) {
+      Num_gemm_Sprimme("N", "N", k, k, k, 1.0, A, k, B, k, 0.0, C, k);
+   }
+   peakFlops = FLOPS_PER_FMA*k*k*k*reps/(primme_get_wtime() - t);
+   free(A);
+
+   x = (SCALAR*)malloc(sizeof(SCALAR)*m*2);
+   y = x + m;
+   Num_larnv_Sprimme(2, iseed, m, x);
+   Num_copy_Sprimme(m, x, 1, y, 1);
+   t = primme_get_wtime();
+   for (i=0; i<reps; i++) {
+      Num_copy_Sprimme(m, x, 1, y, 1);
+   }
+   peakBytes = 2.0*sizeof(SCALAR)*m*reps/(primme_get_wtime() - t);
+   free(x);
+}
+
+int main(int argc, char *argv[]) {
+   PRIMME_INT nLocal = argc > 1 ? atol(argv[1]) : 100000;
+   int basisSize = argc > 2 ? atoi(argv[2]) : 32;
+   int blockSize = argc > 3 ? atoi(argv[3]) : 4;
+   int reps = argc > 4 ? atoi(argv[4]) : 10;
+   int m = basisSize + blockSize;    /* columns of V and W */
+   int restartSize = basisSize/2;
+   PRIMME_INT iseed[4] = {1, 2, 3, 5};
+   double machEps = MACHINE_EPSILON;
+   double s = sizeof(SCALAR), t;
+   primme_params primme;
+   SCALAR *V, *W, *V0, *W0, *H, *hVecs, *X, *Wo, *R, *rwork;
+   REAL *hVals, *Rnorms;
+   int *iwork, i, j, r;
+   size_t rworkSize = 0, lrwork;
+   int iworkSize = 0;
+
+   if (nLocal <= 0 || basisSize <= 0 || blockSize <= 0 || reps <= 0
+         || blockSize > basisSize) {
+      fprintf(stderr, "Usage: %s [nLocal [basisSize [blockSize [reps]]]]\n",
+            argv[0]);
+      return -1;
+   }
+
+   primme_initialize(&primme);
+   primme.n = primme.nLocal = nLocal;
+   primme.numEvals = blockSize;
+   primme.maxBasisSize = m;
+   primme.maxBlockSize = blockSize;
+   primme_set_method(PRIMME_DEFAULT_METHOD, &primme);
+   primme_set_defaults(&primme);
+   primme.iseed[0] = 1; primme.iseed[1] = 2; primme.iseed[2] = 3;
+   primme.iseed[3] = 5;
+
+   /* Workspace for all the kernels */
+
+   ortho_Sprimme(NULL, nLocal, NULL, 0, basisSize, m-1, NULL, 0, 0, nLocal,
+         iseed, machEps, NULL, &rworkSize, &primme);
+   update_projection_Sprimme(NULL, 0, NULL, 0, NULL, 0, nLocal, basisSize,
+         blockSize, NULL, &rworkSize, 1, NULL, &primme);
+   solve_H_Sprimme(NULL, basisSize, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0,
+         NULL, 0, NULL, NULL, 0, machEps, &rworkSize, NULL, 0, &iworkSize,
+         &primme);
+   rworkSize = max(rworkSize, (size_t)Num_update_VWXR_Sprimme(NULL, NULL,
+            nLocal, basisSize, 0, NULL, 0, 0, NULL,
+            NULL, 0, 0, 0, NULL, 0, 0, 0, NULL, 0, 0, 0,
+            NULL, 0, 0, 0, NULL, 0, 0, 0, NULL, NULL, 0, 0,
+            NULL, 0, &primme));
+   rworkSize += 2*m;    /* padding for WRKSP_MALLOC_PRIMME */
+   iworkSize = max(iworkSize, 2*m);
+
+   V = (SCALAR*)malloc(sizeof(SCALAR)*nLocal*m*4);
+   W = V + nLocal*m;
+   V0 = W + nLocal*m;
+   W0 = V0 + nLocal*m;
+   X = (SCALAR*)malloc(sizeof(SCALAR)*nLocal*blockSize*3);
+   Wo = X + nLocal*blockSize;
+   R = Wo + nLocal*blockSize;
+   H = (SCALAR*)malloc(sizeof(SCALAR)*m*m*2);
+   hVecs = H + m*m;
+   hVals = (REAL*)malloc(sizeof(REAL)*(m + blockSize));
+   Rnorms = hVals + m;
+   rwork = (SCALAR*)malloc(sizeof(SCALAR)*rworkSize);
+   iwork = (int*)malloc(sizeof(int)*iworkSize);
+   if (!V || !X || !H || !hVals || !rwork || !iwork) {
+      fprintf(stderr, "Not enough memory\n");
+      return -1;
+   }
+
+   /* Orthonormal V and random W; H random Hermitian */
+
+   Num_larnv_Sprimme(2, iseed, nLocal*m, V);
+   Num_larnv_Sprimme(2, iseed, nLocal*m, W);
+   lrwork = rworkSize;
+   ortho_Sprimme(V, nLocal, NULL, 0, 0, basisSize-1, NULL, 0, 0, nLocal,
+         iseed, machEps, rwork, &lrwork, &primme);
+   Num_copy_matrix_Sprimme(V, nLocal, m, nLocal, V0, nLocal);
+   Num_copy_matrix_Sprimme(W, nLocal, m, nLocal, W0, nLocal);
+   Num_larnv_Sprimme(2, iseed, m*m, H);
+   for (j=0; j<m; j++) {
+      for (i=0; i<j; i++) H[j*m+i] = CONJ(H[i*m+j]);
+      H[j*m+j] = REAL_PART(H[j*m+j]);
+   }
+
+   measure_roofs(nLocal);
+   printf("nLocal = %" PRIMME_INT_P ", basisSize = %d, blockSize = %d, "
+         "repetitions = %d\n", nLocal, basisSize, blockSize, reps);
+   printf("Roofs: %.2f GFLOP/s, %.2f GB/s\n\n", peakFlops*1e-9,
+         peakBytes*1e-9);
+   printf("%-12s %10s %10s %10s %10s %8s\n", "kernel", "time(s)", "GFLOP/s",
+         "GB/s", "flop/byte", "roof");
+
+   /* ortho: two passes of Gram-Schmidt of blockSize vectors against */
+   /* basisSize and the previous vectors of the block                */
+
+   for (r=0, t=0.0; r<reps; r++) {
+      double t0;
+      Num_copy_matrix_Sprimme(&V0[nLocal*basisSize], nLocal, blockSize,
+            nLocal, &V[nLocal*basisSize], nLocal);
+      lrwork = rworkSize;
+      t0 = primme_get_wtime();
+      ortho_Sprimme(V, nLocal, NULL, 0, basisSize, m-1, NULL, 0, 0, nLocal,
+            iseed, machEps, rwork, &lrwork, &primme);
+      t += primme_get_wtime() - t0;
+   }
+   report("ortho", t/reps,
+         2*2*FLOPS_PER_FMA*nLocal*((double)basisSize+blockSize/2.0)*blockSize,
+         2*2*s*nLocal*((double)basisSize+blockSize));
+
+   /* update_proj: Z(:,basisSize:m-1) = V(:,0:m-1)'*W(:,basisSize:m-1) */
+
+   for (r=0, t=0.0; r<reps; r++) {
+      double t0;
+      lrwork = rworkSize;
+      t0 = primme_get_wtime();
+      update_projection_Sprimme(V, nLocal, W, nLocal, hVecs, m, nLocal,
+            basisSize, blockSize, rwork, &lrwork, 1, NULL, &primme);
+      t += primme_get_wtime() - t0;
+   }
+   report("update_proj", t/reps, FLOPS_PER_FMA*nLocal*m*blockSize,
+         s*nLocal*(m + blockSize));
+
+   /* solve_H: Rayleigh-Ritz on the basisSize x basisSize matrix H */
+
+   for (r=0, t=0.0; r<reps; r++) {
+      double t0;
+      lrwork = rworkSize;
+      t0 = primme_get_wtime();
+      solve_H_Sprimme(H, basisSize, m, NULL, 0, NULL, 0, NULL, 0, NULL, 0,
+            hVecs, m, hVals, NULL, 0, machEps, &lrwork, rwork, iworkSize,
+            iwork, &primme);
+      t += primme_get_wtime() - t0;
+   }
+   report("solve_H", t/reps, 9.0*FLOPS_PER_FMA/2*basisSize*basisSize*basisSize,
+         2*s*basisSize*basisSize);
+
+   /* update_VWXR: X = V*h, Wo = W*h, R = Wo - X*diag(hVals) and norms */
+
+   for (r=0, t=0.0; r<reps; r++) {
+      double t0 = primme_get_wtime();
+      Num_update_VWXR_Sprimme(V, W, nLocal, basisSize, nLocal, hVecs,
+            basisSize, m, hVals,
+            X, 0, blockSize, nLocal,
+            NULL, 0, 0, 0,
+            NULL, 0, 0, 0,
+            Wo, 0, blockSize, nLocal,
+            R, 0, blockSize, nLocal, Rnorms,
+            NULL, 0, 0,
+            rwork, rworkSize, &primme);
+      t += primme_get_wtime() - t0;
+   }
+   report("update_VWXR", t/reps,
+         2*FLOPS_PER_FMA*nLocal*basisSize*blockSize
+         + 2*FLOPS_PER_FMA*nLocal*blockSize,
+         s*nLocal*(2.0*basisSize + 3*blockSize));
+
+   /* restart: V(:,0:restartSize-1) = V*h and W(:,0:restartSize-1) = W*h */
+   /* in place                                                          */
+
+   for (r=0, t=0.0; r<reps; r++) {
+      double t0;
+      Num_copy_matrix_Sprimme(V0, nLocal, basisSize, nLocal, V, nLocal);
+      Num_copy_matrix_Sprimme(W0, nLocal, basisSize, nLocal, W, nLocal);
+      t0 = primme_get_wtime();
+      Num_update_VWXR_Sprimme(V, W, nLocal, basisSize, nLocal, hVecs,
+            basisSize, m, hVals,
+            V, 0, restartSize, nLocal,
+            NULL, 0, 0, 0,
+            NULL, 0, 0, 0,
+            W, 0, restartSize, nLocal,
+            NULL, 0, 0, 0, NULL,
+            NULL, 0, 0,
+            rwork, rworkSize, &primme);
+      t += primme_get_wtime() - t0;
+   }
+   report("restart", t/reps, 2*FLOPS_PER_FMA*nLocal*basisSize*restartSize,
+         s*nLocal*(2.0*basisSize + 2*restartSize));
+
+   free(V);
+   free(X);
+   free(H);
+   free(hVals);
+   free(rwork);
+   free(iwork);
+   primme_free(&primme);
+
+   return 0;
+}
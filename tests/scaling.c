@@ -0,0 +1,314 @@
+/*******************************************************************************
+ *   PRIMME PReconditioned Iterative MultiMethod Eigensolver
+ *   Copyright (C) 2018 College of William & Mary,
+ *   James R. McCombs, Eloy Romero Alcalde, Andreas Stathopoulos, Lingfei Wu
+ *
+ *   This file is part of PRIMME.
+ *
+ *   PRIMME is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ *   PRIMME is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with this library; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *******************************************************************************
+ * File: scaling.c
+ *
+ * Purpose - strong and weak scaling benchmark of dprimme with MPI on the
+ *           7-point 3D Laplacian with Dirichlet boundary conditions, generated
+ *           in memory and partitioned by slabs of xy-planes. Every process
+ *           keeps its planes, and the matvec exchanges the first and the last
+ *           plane with the neighbor processes.
+ *
+ *  The benchmark runs the same solver configuration on the first 1, 2, 4, ...
+ *  processes of MPI_COMM_WORLD, and on all of them, with:
+ *
+ *    strong   a fixed grid of n x n x n points
+ *    weak     a grid of n x n x (n*procs) points, n planes per process
+ *
+ *  For every number of processes it reports the iterations, matvecs and
+ *  wall clock time of the solve, the time of the phases in primme_stats
+ *  (the largest among the processes), the number and the volume of the
+ *  reductions (numGlobalSum and volumeGlobalSum) and the parallel efficiency
+ *  relative to one process: T1/(procs*Tp) for strong scaling, and T1/Tp for
+ *  weak scaling. As the number of matvecs may change with the number of
+ *  processes, the efficiency of the time per matvec is also reported. Every
+ *  solve is repeated reps times and the fastest one is reported.
+ *
+ *  Calling format:
+ *
+ *          mpirun -np P primme_scaling_double [strong|weak [n [numEvals
+ *                                    [method [blockSize [eps [reps]]]]]]]
+ *
+ *  The defaults are strong scaling, n = 64, 10 eigenvalues, the method
+ *  PRIMME_DEFAULT_MIN_TIME, block size 1, tolerance 1e-6 and 1 repetition.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include "primme.h"
+
+typedef struct {
+   MPI_Comm comm;
+   int nx, ny, nzLocal;     /* points per plane and planes in this process */
+   int procID, numProcs;
+   double *buf;             /* planes sent to and received from neighbors  */
+   int bufCols;             /* columns that buf can hold                   */
+} Laplacian3D;
+
+static void scaling_GlobalSum(void *sendBuf, void *recvBuf, int *count,
+      primme_params *primme, int *ierr) {
+   Laplacian3D *A = (Laplacian3D *)primme->commInfo;
+
+   if (sendBuf == recvBuf) {
+      *ierr = MPI_Allreduce(MPI_IN_PLACE, recvBuf, *count, MPI_DOUBLE, MPI_SUM,
+            A->comm) != MPI_SUCCESS;
+   } else {
+      *ierr = MPI_Allreduce(sendBuf, recvBuf, *count, MPI_DOUBLE, MPI_SUM,
+            A->comm) != MPI_SUCCESS;
+   }
+}
+
+/******************************************************************************
+ * y = A*x for the block of vectors; the planes below the first one and above
+ * the last one of this process are received from the neighbors
+ *
+******************************************************************************/
+
+static void scaling_Matvec(void *x_, PRIMME_INT *ldx, void *y_, PRIMME_INT *ldy,
+      int *blockSize, primme_params *primme, int *ierr) {
+   Laplacian3D *A = (Laplacian3D *)primme->matrix;
+   int nx = A->nx, ny = A->ny, nz = A->nzLocal, nb = *blockSize;
+   PRIMME_INT np = (PRIMME_INT)nx*ny;
+   int up = A->procID+1 < A->numProcs ? A->procID+1 : MPI_PROC_NULL;
+   int down = A->procID > 0 ? A->procID-1 : MPI_PROC_NULL;
+   double *x, *y, *sendDown, *sendUp, *recvDown, *recvUp;
+   int i, j, k, b;
+
+   *ierr = 0;
+
+   if (A->bufCols < nb) {
+      free(A->buf);
+      A->buf = (double*)malloc(sizeof(double)*np*nb*4);
+      if (!A->buf) { A->bufCols = 0; *ierr = 1; return; }
+      A->bufCols = nb;
+   }
+   sendDown = A->buf;
+   sendUp = sendDown + np*nb;
+   recvDown = sendUp + np*nb;
+   recvUp = recvDown + np*nb;
+
+   /* Exchange the boundary planes of all vectors at once */
+
+   for (b=0; b<nb; b++) {
+      x = (double*)x_ + *ldx*b;
+      memcpy(&sendDown[np*b], x, sizeof(double)*np);
+      memcpy(&sendUp[np*b], &x[np*(nz-1)], sizeof(double)*np);
+   }
+   if (MPI_Sendrecv(sendDown, (int)(np*nb), MPI_DOUBLE, down, 0, recvUp,
+            (int)(np*nb), MPI_DOUBLE, up, 0, A->comm, MPI_STATUS_IGNORE)
+         != MPI_SUCCESS
+         || MPI_Sendrecv(sendUp, (int)(np*nb), MPI_DOUBLE, up, 1, recvDown,
+            (int)(np*nb), MPI_DOUBLE, down, 1, A->comm, MPI_STATUS_IGNORE)
+         != MPI_SUCCESS) {
+      *ierr = 1;
+      return;
+   }
+   if (down == MPI_PROC_NULL) memset(recvDown, 0, sizeof(double)*np*nb);
+   if (up == MPI_PROC_NULL) memset(recvUp, 0, sizeof(double)*np*nb);
+
+   for (b=0; b<nb; b++) {
+      x = (double*)x_ + *ldx*b;
+      y = (double*)y_ + *ldy*b;
+      for (k=0; k<nz; k++) {
+         double *xk = &x[np*k], *yk = &y[np*k];
+         double *xd = k > 0 ? &x[np*(k-1)] : &recvDown[np*b];
+         double *xu = k < nz-1 ? &x[np*(k+1)] : &recvUp[np*b];
+         for (j=0; j<ny; j++) {
+            for (i=0; i<nx; i++) {
+               PRIMME_INT p = (PRIMME_INT)j*nx + i;
+               double s = 6.0*xk[p] - xd[p] - xu[p];
+               if (i > 0) s -= xk[p-1];
+               if (i < nx-1) s -= xk[p+1];
+               if (j > 0) s -= xk[p-nx];
+               if (j < ny-1) s -= xk[p+nx];
+               yk[p] = s;
+            }
+         }
+      }
+   }
+}
+
+/******************************************************************************
+ * Solve on the processes of comm and return in times the phases of the
+ * solve, in the order of the report, the largest among the processes
+ *
+******************************************************************************/
+
+#define NUM_TIMES 9
+
+static int solve(MPI_Comm comm, int weak, int n, int numEvals, int method,
+      int blockSize, double eps, primme_params *stats, double *times) {
+   Laplacian3D A;
+   primme_params primme;
+   double *evals, *evecs, *rnorms, t[NUM_TIMES];
+   int nz, ret;
+
+   MPI_Comm_rank(comm, &A.procID);
+   MPI_Comm_size(comm, &A.numProcs);
+   A.comm = comm;
+   A.nx = A.ny = n;
+   nz = weak ? n*A.numProcs : n;
+   A.nzLocal = nz/A.numProcs + (A.procID < nz%A.numProcs ? 1 : 0);
+   A.buf = NULL;
+   A.bufCols = 0;
+
+   primme_initialize(&primme);
+   primme.n = (PRIMME_INT)n*n*nz;
+   primme.nLocal = (PRIMME_INT)n*n*A.nzLocal;
+   primme.numProcs = A.numProcs;
+   primme.procID = A.procID;
+   primme.commInfo = &A;
+   primme.matrix = &A;
+   primme.matrixMatvec = scaling_Matvec;
+   primme.globalSumReal = scaling_GlobalSum;
+   primme.numEvals = numEvals;
+   primme.target = primme_smallest;
+   primme.eps = eps;
+   primme.maxBlockSize = blockSize;
+   primme.aNorm = 12.0;
+   primme.printLevel = 1;
+   primme_set_method((primme_preset_method)method, &primme);
+
+   evals = (double*)malloc(sizeof(double)*numEvals*2);
+   rnorms = evals + numEvals;
+   evecs = (double*)malloc(sizeof(double)*primme.nLocal*numEvals);
+   if (!evals || !evecs) {
+      fprintf(stderr, "Not enough memory\n");
+      MPI_Abort(MPI_COMM_WORLD, -1);
+   }
+
+   MPI_Barrier(comm);
+   ret = dprimme(evals, evecs, rnorms, &primme);
+
+   t[0] = primme.stats.elapsedTime;
+   t[1] = primme.stats.timeMatvec;
+   t[2] = primme.stats.timeOrtho;
+   t[3] = primme.stats.timeGlobalSum;
+   t[4] = primme.stats.timeSolveH;
+   t[5] = primme.stats.timeRestart;
+   t[6] = primme.stats.timeUpdateVWXR;
+   t[7] = primme.stats.timeConvCheck;
+   t[8] = primme.stats.timeInnerSolve;
+   MPI_Allreduce(t, times, NUM_TIMES, MPI_DOUBLE, MPI_MAX, comm);
+   *stats = primme;
+
+   primme_free(&primme);
+   free(evals);
+   free(evecs);
+   free(A.buf);
+   return ret;
+}
+
+int main(int argc, char *argv[]) {
+   int weak, n, numEvals, method, blockSize, reps;
+   double eps, T1 = 0.0, T1mv = 0.0;
+   int procID, numProcs, p, r;
+
+   MPI_Init(&argc, &argv);
+   MPI_Comm_rank(MPI_COMM_WORLD, &procID);
+   MPI_Comm_size(MPI_COMM_WORLD, &numProcs);
+
+   weak = argc > 1 && strcmp(argv[1], "weak") == 0;
+   n = argc > 2 ? atoi(argv[2]) : 64;
+   numEvals = argc > 3 ? atoi(argv[3]) : 10;
+   method = PRIMME_DEFAULT_MIN_TIME;
+   blockSize = argc > 5 ? atoi(argv[5]) : 1;
+   eps = argc > 6 ? atof(argv[6]) : 1e-6;
+   reps = argc > 7 ? atoi(argv[7]) : 1;
+
+   if ((argc > 1 && !weak && strcmp(argv[1], "strong") != 0)
+         || (argc > 4 && primme_constant_info(argv[4], &method) != 0)
+         || n <= 0 || numEvals <= 0 || blockSize <= 0 || eps <= 0.0
+         || reps <= 0 || (!weak && n < numProcs)
+         || (PRIMME_INT)n*n*(weak ? n*numProcs : n) < numEvals) {
+      if (procID == 0) {
+         fprintf(stderr, "Usage: %s [strong|weak [n [numEvals [method "
+               "[blockSize [eps [reps]]]]]]]\n"
+               "  strong scaling needs n >= number of processes\n", argv[0]);
+      }
+      MPI_Finalize();
+      return -1;
+   }
+
+   if (procID == 0) {
+      if (weak) {
+         printf("Weak scaling of the 3D Laplacian: %d x %d x (%d*procs)",
+               n, n, n);
+      } else {
+         printf("Strong scaling of the 3D Laplacian: %d x %d x %d", n, n, n);
+      }
+      printf(", numEvals = %d, method = %s, blockSize = %d, eps = %g\n\n",
+            numEvals, argc > 4 ? argv[4] : "PRIMME_DEFAULT_MIN_TIME",
+            blockSize, eps);
+      printf("%5s %12s %7s %7s %10s %9s %9s %9s %9s %9s %9s %9s %9s %8s "
+            "%11s %6s %6s\n", "procs", "n", "its", "MV", "time", "matvec",
+            "ortho", "globalSum", "solveH", "restart", "updVWXR", "convChk",
+            "inner", "numGSum", "volGSum", "eff", "effMV");
+   }
+
+   /* Sweep 1, 2, 4, ... processes, and all of them */
+
+   for (p=1; ; p = (p*2 < numProcs ? p*2 : numProcs)) {
+      MPI_Comm comm;
+      primme_params best;
+      double times[NUM_TIMES], bestTimes[NUM_TIMES];
+      int ret = 0;
+
+      MPI_Comm_split(MPI_COMM_WORLD, procID < p ? 0 : MPI_UNDEFINED, procID,
+            &comm);
+      if (comm != MPI_COMM_NULL) {
+         for (r=0; r<reps; r++) {
+            primme_params stats;
+            ret |= solve(comm, weak, n, numEvals, method, blockSize, eps,
+                  &stats, times);
+            if (r == 0 || times[0] < bestTimes[0]) {
+               best = stats;
+               memcpy(bestTimes, times, sizeof(double)*NUM_TIMES);
+            }
+         }
+         MPI_Comm_free(&comm);
+      }
+
+      if (procID == 0) {
+         double Tp = bestTimes[0], Tpmv = Tp/best.stats.numMatvecs;
+         if (p == 1) { T1 = Tp; T1mv = Tpmv; }
+         printf("%5d %12" PRIMME_INT_P " %7" PRIMME_INT_P " %7" PRIMME_INT_P
+               " %10.4f %9.4f %9.4f %9.4f %9.4f %9.4f %9.4f %9.4f %9.4f %8"
+               PRIMME_INT_P " %11" PRIMME_INT_P " %6.2f %6.2f%s\n", p,
+               best.n, best.stats.numOuterIterations, best.stats.numMatvecs,
+               Tp, bestTimes[1], bestTimes[2], bestTimes[3], bestTimes[4],
+               bestTimes[5], bestTimes[6], bestTimes[7], bestTimes[8],
+               best.stats.numGlobalSum, best.stats.volumeGlobalSum,
+               weak ? T1/Tp : T1/(p*Tp), weak ? T1mv/Tpmv : T1mv/(p*Tpmv),
+               ret ? " (failed)" : "");
+         fflush(stdout);
+      }
+      MPI_Barrier(MPI_COMM_WORLD);
+      if (p == numProcs) break;
+   }
+
+   MPI_Finalize();
+   return 0;
+}